@@ -303,7 +303,7 @@ static const char* scCmapFooter = "endcmap CMapName currentdict /CMap definereso
 void ANSIFontWriter::WriteToUnicodeMap(ObjectIDType inToUnicodeMap)
 {
 	mObjectsContext->StartNewIndirectObject(inToUnicodeMap);
-	PDFStream* pdfStream = mObjectsContext->StartPDFStream();
+	PDFStream* pdfStream = mObjectsContext->StartPDFStream(NULL,false,eStreamCategoryFont);
 	IByteWriter* cmapWriteContext = pdfStream->GetWriteStream();
 	PrimitiveObjectsWriter primitiveWriter(cmapWriteContext);
 	unsigned long i = 1;
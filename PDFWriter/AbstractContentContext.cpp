@@ -30,6 +30,7 @@
 #include "OutputStreamTraits.h"
 #include "IContentContextListener.h"
 #include "DocumentContext.h"
+#include "ObjectsContext.h"
 #include <ctype.h>
 #include <algorithm>
 
@@ -239,6 +240,12 @@ unsigned long AbstractContentContext::ColorValueForName(const std::string& inCol
 AbstractContentContext::AbstractContentContext(PDFHummus::DocumentContext* inDocumentContext)
 {
 	mDocumentContext = inDocumentContext;
+	// content uses the same numbers precision and serialization as the rest of the document
+	if(mDocumentContext && mDocumentContext->GetObjectsContext())
+	{
+		mPrimitiveWriter.SetDoublePrecision(mDocumentContext->GetObjectsContext()->GetDoublePrecision());
+		mPrimitiveWriter.SetCompactSerialization(mDocumentContext->GetObjectsContext()->IsCompactSerialization());
+	}
 }
 
 AbstractContentContext::~AbstractContentContext(void)
@@ -250,6 +257,11 @@ void AbstractContentContext::SetPDFStreamForWrite(PDFStream* inStream)
 	mPrimitiveWriter.SetStreamForWriting(inStream->GetWriteStream());	
 }
 
+void AbstractContentContext::SetStreamForWrite(IByteWriter* inStream)
+{
+	mPrimitiveWriter.SetStreamForWriting(inStream);
+}
+
 void AbstractContentContext::AssertProcsetAvailable(const std::string& inProcsetName)
 {
 	GetResourcesDictionary()->AddProcsetResource(inProcsetName);	
@@ -981,7 +993,9 @@ EStatusCode AbstractContentContext::WriteTextCommandWithEncoding(const std::stri
 	}
 
 	GlyphUnicodeMappingList glyphsAndUnicode;
+	LockSharedResources();
 	EStatusCode encodingStatus = currentFont->TranslateStringToGlyphs(inUnicodeText,glyphsAndUnicode);
+	UnlockSharedResources();
 
 	// encoding returns false if was unable to encode some of the glyphs. will display as missing characters
 	if(encodingStatus != PDFHummus::eSuccess)
@@ -1068,7 +1082,9 @@ EStatusCode AbstractContentContext::TJ(const StringOrDoubleList& inStringsAndSpa
 		else
 		{
 			GlyphUnicodeMappingList glyphsAndUnicode;
+			LockSharedResources();
 			encodingStatus = currentFont->TranslateStringToGlyphs(it->SomeValue,glyphsAndUnicode);
+			UnlockSharedResources();
 
 			// encoding returns false if was unable to encode some of the glyphs. will display as missing characters
 			if(encodingStatus != PDFHummus::eSuccess)
@@ -1099,7 +1115,11 @@ EStatusCode AbstractContentContext::WriteTextCommandWithDirectGlyphSelection(con
 	UShortList encodedCharactersList;
 	bool writeAsCID;	
 
-	if(currentFont->EncodeStringForShowing(inText,fontObjectID,encodedCharactersList,writeAsCID) != PDFHummus::eSuccess)
+	LockSharedResources();
+	EStatusCode encodeStatus = currentFont->EncodeStringForShowing(inText,fontObjectID,encodedCharactersList,writeAsCID);
+	UnlockSharedResources();
+
+	if(encodeStatus != PDFHummus::eSuccess)
 	{
 		TRACE_LOG("AbstractcontextContext::WriteTextCommandWithDirectGlyphSelection, Unexepcted failure, Cannot encode characters");
 		return PDFHummus::eFailure;
@@ -1180,7 +1200,11 @@ EStatusCode AbstractContentContext::TJ(const GlyphUnicodeMappingListOrDoubleList
 	UShortListList encodedCharachtersListsList;
 	bool writeAsCID;	
 
-	if(currentFont->EncodeStringsForShowing(stringsList,fontObjectID,encodedCharachtersListsList,writeAsCID)!= PDFHummus::eSuccess)
+	LockSharedResources();
+	EStatusCode encodeStatus = currentFont->EncodeStringsForShowing(stringsList,fontObjectID,encodedCharachtersListsList,writeAsCID);
+	UnlockSharedResources();
+
+	if(encodeStatus != PDFHummus::eSuccess)
 	{
 		TRACE_LOG("AbstractContentContext::TJ, Unexepcted failure, cannot include characters for writing final representation");
 		return PDFHummus::eFailure;
@@ -1439,7 +1463,9 @@ void AbstractContentContext::DrawImage(double inX,double inY,const std::string&
 	}
 	else if(inOptions.transformationMethod == eFit)
 	{
+		LockSharedResources();
 		DoubleAndDoublePair imageDimensions = mDocumentContext->GetImageDimensions(inImagePath,inOptions.imageIndex,inOptions.pdfParsingOptions);
+		UnlockSharedResources();
 
         double scaleX = 1;
         double scaleY = 1;
@@ -1471,12 +1497,14 @@ void AbstractContentContext::DrawImage(double inX,double inY,const std::string&
 	transformation[5]+=inY;
 
     // registering the images at pdfwriter to allow optimization on image writes
+    LockSharedResources();
     ObjectIDTypeAndBool result = mDocumentContext->RegisterImageForDrawing(inImagePath,inOptions.imageIndex);
     if(result.second)
     {
         // if first usage, write the image
         ScheduleImageWrite(inImagePath,inOptions.imageIndex,result.first,inOptions.pdfParsingOptions);
     }
+    UnlockSharedResources();
     
     q();
     cm(transformation[0],transformation[1],transformation[2],transformation[3],transformation[4],transformation[5]);
@@ -29,6 +29,7 @@
 	use SetPDFStreamForWrite to setup the stream for write (may be using multiple times)
 	Implement GetResourcesDictionary to return the relevant resources dictionary for the content
 	Optionally Implement RenewStreamConnection, which is called before any operator is written, in order to make sure there's a stream there to write to
+	Optionally Implement LockSharedResources/UnlockSharedResources, if content may be written concurrently with other content contexts of the same document
 
 */
 
@@ -54,6 +55,7 @@ class ResourcesDictionary;
 class PDFImageXObject;
 class ITextCommand;
 class IByteReader;
+class IByteWriter;
 class IContentContextListener;
 
 template <typename T>
@@ -348,6 +350,8 @@ protected:
 
 	// Derived classes should use this method to update the stream for writing
 	void SetPDFStreamForWrite(PDFStream* inStream);
+	// same, for derived classes that write the content to a stream of their own, rather than to a PDF stream
+	void SetStreamForWrite(IByteWriter* inStream);
 
 private:
 	// Derived classes should use this method to retrive the content resource dictionary, for updating procsets 'n such
@@ -356,6 +360,10 @@ private:
 	virtual void RenewStreamConnection() {};
 	// Derived classes should implement this method for registering image writes
 	virtual void ScheduleImageWrite(const std::string& inImagePath,unsigned long inImageIndex,ObjectIDType inObjectID,const PDFParsingOptions& inParsingOptions) = 0;
+	// Derived classes may implement these to guard access to document level shared resources (used fonts, image registry, page end tasks),
+	// for when content is written from multiple threads. called around any high level operator call that touches such resources
+	virtual void LockSharedResources() {};
+	virtual void UnlockSharedResources() {};
 	PrimitiveObjectsWriter mPrimitiveWriter;
 
 	// graphic stack to monitor high-level graphic usage (now - fonts)
@@ -19,6 +19,8 @@
    
 */
 #include "CFFEmbeddedFontWriter.h"
+#include "ParallelFontSubsetter.h"
+#include "FontProgramsCache.h"
 #include "ObjectsContext.h"
 #include "InputStringBufferStream.h"
 #include "OutputStreamTraits.h"
@@ -46,6 +48,7 @@ CFFEmbeddedFontWriter::~CFFEmbeddedFontWriter(void)
 }
 
 static const std::string scSubtype = "Subtype";
+static const std::string scCFFProgramType = "CFF";
 
 EStatusCode CFFEmbeddedFontWriter::WriteEmbeddedFont(	
 								FreeTypeFaceWrapper& inFontInfo,
@@ -68,21 +71,58 @@ EStatusCode CFFEmbeddedFontWriter::WriteEmbeddedFont(
 	ObjectIDType& outEmbeddedFontObjectID)
 {
 	MyStringBuf rawFontProgram; 
+	MyStringBuf* fontProgram = NULL;
 	bool notEmbedded;
 		// as oppose to true type, the reason for using a memory stream here is mainly peformance - i don't want to start
 		// setting file pointers and move in a file stream
-	EStatusCode status;
+	EStatusCode status = PDFHummus::eSuccess;
+	FontProgramsCache* fontProgramsCache = FontProgramsCache::GetCacheForFont(inFontInfo,inObjectsContext);
+	std::string cacheKey;
+	CachedFontProgram cachedProgram;
+	bool useCachedProgram = false;
 
 	do
 	{
-		status = CreateCFFSubset(inFontInfo,inSubsetGlyphIDs,inCIDMapping,inSubsetFontName,notEmbedded,rawFontProgram);
-		if(status != PDFHummus::eSuccess)
+		// another document may have already embedded this subset, in which case the finished program can be copied as is
+		if(fontProgramsCache)
 		{
-			TRACE_LOG("CFFEmbeddedFontWriter::WriteEmbeddedFont, failed to write embedded font program");
-			break;
-		}	
+			cacheKey = FontProgramsCache::CreateKey(inFontInfo,inObjectsContext,scCFFProgramType + inFontFile3SubType,inSubsetGlyphIDs,inCIDMapping,inSubsetFontName);
+			useCachedProgram = fontProgramsCache->GetFontProgram(cacheKey,cachedProgram);
+		}
 
-		if(notEmbedded)
+		if(!useCachedProgram)
+		{
+			// use the font program if it was already created in parallel with the other fonts
+			if(inFontInfo.GetParallelFontSubsetter())
+				fontProgram = inFontInfo.GetParallelFontSubsetter()->GetCFFSubset(&inFontInfo,inSubsetGlyphIDs,inCIDMapping,inSubsetFontName,notEmbedded);
+
+			if(!fontProgram)
+			{
+				status = CreateCFFSubset(inFontInfo,inSubsetGlyphIDs,inCIDMapping,inSubsetFontName,notEmbedded,rawFontProgram);
+				if(status != PDFHummus::eSuccess)
+				{
+					TRACE_LOG("CFFEmbeddedFontWriter::WriteEmbeddedFont, failed to write embedded font program");
+					break;
+				}	
+				fontProgram = &rawFontProgram;
+			}
+
+			if(fontProgramsCache)
+			{
+				if(notEmbedded)
+					cachedProgram.NotEmbedded = true;
+				else
+				{
+					status = FontProgramsCache::CreateCachedFontProgram(*fontProgram,inObjectsContext,cachedProgram);
+					if(status != PDFHummus::eSuccess)
+						break;
+				}
+				fontProgramsCache->AddFontProgram(cacheKey,cachedProgram);
+				useCachedProgram = true;
+			}
+		}
+
+		if(useCachedProgram ? cachedProgram.NotEmbedded : notEmbedded)
 		{
 			// can't embed. mark succesful, and go back empty
 			outEmbeddedFontObjectID = 0;
@@ -91,18 +131,25 @@ EStatusCode CFFEmbeddedFontWriter::WriteEmbeddedFont(
 		}
 
 		outEmbeddedFontObjectID = inObjectsContext->StartNewIndirectObject();
+		++inObjectsContext->GetMetrics().GetCounters().FontsSubset;
+		inObjectsContext->GetMetrics().GetCounters().GlyphsEmbedded += inSubsetGlyphIDs.size();
 		
 		DictionaryContext* fontProgramDictionaryContext = inObjectsContext->StartDictionary();
 
-		rawFontProgram.pubseekoff(0,std::ios_base::beg);
-
 		fontProgramDictionaryContext->WriteKey(scSubtype);
 		fontProgramDictionaryContext->WriteNameValue(inFontFile3SubType);
-		PDFStream* pdfStream = inObjectsContext->StartPDFStream(fontProgramDictionaryContext);
+		if(useCachedProgram)
+		{
+			status = FontProgramsCache::WriteCachedFontProgram(cachedProgram,inObjectsContext,fontProgramDictionaryContext);
+			break;
+		}
+
+		fontProgram->pubseekoff(0,std::ios_base::beg);
+		PDFStream* pdfStream = inObjectsContext->StartPDFStream(fontProgramDictionaryContext,false,eStreamCategoryFont);
 
 
 		// now copy the created font program to the output stream
-		InputStringBufferStream fontProgramStream(&rawFontProgram);
+		InputStringBufferStream fontProgramStream(fontProgram);
 		OutputStreamTraits streamCopier(pdfStream->GetWriteStream());
 		status = streamCopier.CopyToOutputStream(&fontProgramStream);
 		if(status != PDFHummus::eSuccess)
@@ -72,6 +72,14 @@ public:
 									UShortVector* inCIDMapping,
 									ObjectIDType& outEmbeddedFontObjectID);
 
+	// create the font program only. uses the font file path and index of inFontInfo, so may run on a worker thread. see ParallelFontSubsetter.h
+	PDFHummus::EStatusCode CreateCFFSubset(	
+					FreeTypeFaceWrapper& inFontInfo,
+					const UIntVector& inSubsetGlyphIDs,
+					UShortVector* inCIDMapping,
+					const std::string& inSubsetFontName,
+					bool& outNotEmbedded,
+					MyStringBuf& outFontProgram);
 
 private:
 	OpenTypeFileInput mOpenTypeInput;
@@ -97,13 +105,6 @@ private:
 	LongFilePositionType mFDArrayPosition;
 	LongFilePositionType mFDSelectPosition;
 
-	PDFHummus::EStatusCode CreateCFFSubset(	
-					FreeTypeFaceWrapper& inFontInfo,
-					const UIntVector& inSubsetGlyphIDs,
-					UShortVector* inCIDMapping,
-					const std::string& inSubsetFontName,
-					bool& outNotEmbedded,
-					MyStringBuf& outFontProgram);
 	PDFHummus::EStatusCode AddDependentGlyphs(UIntVector& ioSubsetGlyphIDs);
 	PDFHummus::EStatusCode AddComponentGlyphs(unsigned int inGlyphID,UIntSet& ioComponents,bool &outFoundComponents);
 	PDFHummus::EStatusCode WriteCFFHeader();
@@ -0,0 +1,73 @@
+/*
+   Source File : CopiedObjectsRegistry.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "CopiedObjectsRegistry.h"
+
+CopiedObjectsRegistry::CopiedObjectsRegistry(void)
+{
+	mEnabled = false;
+}
+
+CopiedObjectsRegistry::~CopiedObjectsRegistry(void)
+{
+}
+
+void CopiedObjectsRegistry::SetEnabled(bool inEnabled)
+{
+	mEnabled = inEnabled;
+}
+
+bool CopiedObjectsRegistry::IsEnabled() const
+{
+	return mEnabled;
+}
+
+bool CopiedObjectsRegistry::FindObject(const std::string& inDigest,ObjectIDType& outTargetObjectID) const
+{
+	StringToObjectIDTypeMap::const_iterator it = mDigestToTargetObject.find(inDigest);
+	if(it == mDigestToTargetObject.end())
+		return false;
+
+	outTargetObjectID = it->second;
+	return true;
+}
+
+void CopiedObjectsRegistry::RegisterObject(const std::string& inDigest,ObjectIDType inTargetObjectID)
+{
+	if(mDigestToTargetObject.insert(StringToObjectIDTypeMap::value_type(inDigest,inTargetObjectID)).second)
+		++mStatistics.RegisteredObjects;
+}
+
+void CopiedObjectsRegistry::RecordDeduplication(IOBasicTypes::LongFilePositionType inSavedStreamBytes)
+{
+	++mStatistics.DeduplicatedObjects;
+	mStatistics.SavedStreamBytes += inSavedStreamBytes;
+}
+
+const CopiedObjectsDeduplicationStatistics& CopiedObjectsRegistry::GetStatistics() const
+{
+	return mStatistics;
+}
+
+void CopiedObjectsRegistry::Reset()
+{
+	mDigestToTargetObject.clear();
+	mStatistics = CopiedObjectsDeduplicationStatistics();
+}
@@ -0,0 +1,78 @@
+/*
+   Source File : CopiedObjectsRegistry.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "ObjectsBasicTypes.h"
+#include "IOBasicTypes.h"
+
+#include <string>
+#include <map>
+
+/*
+	Registry of objects copied from source PDFs into the document, keyed by a digest of their content.
+	When enabled, copying contexts consult it before writing a copied object, and reuse the target object
+	of an equivalent object that was already copied, possibly from a different source document.
+	The registry belongs to the document context, so it spans all copying contexts of a document.
+
+	Digests are computed by PDFDocumentHandler. The registry only holds them, and counts what was saved.
+*/
+
+struct CopiedObjectsDeduplicationStatistics
+{
+	// number of distinct objects registered for deduplication
+	unsigned long RegisteredObjects;
+	// number of copied objects that reused an already written object instead of being written again
+	unsigned long DeduplicatedObjects;
+	// stream bytes that were not written due to deduplication (stream data of the deduplicated objects and what they refer to)
+	IOBasicTypes::LongFilePositionType SavedStreamBytes;
+
+	CopiedObjectsDeduplicationStatistics(){RegisteredObjects = 0;DeduplicatedObjects = 0;SavedStreamBytes = 0;}
+};
+
+typedef std::map<std::string,ObjectIDType> StringToObjectIDTypeMap;
+
+class CopiedObjectsRegistry
+{
+public:
+	CopiedObjectsRegistry(void);
+	~CopiedObjectsRegistry(void);
+
+	// deduplication is off by default
+	void SetEnabled(bool inEnabled);
+	bool IsEnabled() const;
+
+	// look for an already registered object with the input digest. returns false if none was registered
+	bool FindObject(const std::string& inDigest,ObjectIDType& outTargetObjectID) const;
+	// register a target object for a digest, once it is written
+	void RegisterObject(const std::string& inDigest,ObjectIDType inTargetObjectID);
+	// count a reuse of a registered object, and the stream bytes it saved
+	void RecordDeduplication(IOBasicTypes::LongFilePositionType inSavedStreamBytes);
+
+	const CopiedObjectsDeduplicationStatistics& GetStatistics() const;
+
+	// clears registered objects and statistics. does not change the enabled state
+	void Reset();
+
+private:
+	bool mEnabled;
+	StringToObjectIDTypeMap mDigestToTargetObject;
+	CopiedObjectsDeduplicationStatistics mStatistics;
+};
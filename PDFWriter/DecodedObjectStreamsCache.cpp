@@ -0,0 +1,102 @@
+/*
+   Source File : DecodedObjectStreamsCache.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "DecodedObjectStreamsCache.h"
+
+using namespace IOBasicTypes;
+
+DecodedObjectStreamsCache::DecodedObjectStreamsCache(void)
+{
+	mMaximumSize = 0;
+	mCurrentSize = 0;
+}
+
+DecodedObjectStreamsCache::~DecodedObjectStreamsCache(void)
+{
+	Reset();
+}
+
+void DecodedObjectStreamsCache::SetMaximumSize(LongBufferSizeType inMaximumSize)
+{
+	mMaximumSize = inMaximumSize;
+	while(mCurrentSize > mMaximumSize)
+		DropLeastRecentlyUsed();
+}
+
+LongBufferSizeType DecodedObjectStreamsCache::GetMaximumSize()
+{
+	return mMaximumSize;
+}
+
+LongBufferSizeType DecodedObjectStreamsCache::GetCurrentSize()
+{
+	return mCurrentSize;
+}
+
+DecodedObjectStream* DecodedObjectStreamsCache::Get(ObjectIDType inObjectStreamID)
+{
+	ObjectIDTypeToDecodedObjectStreamAndUsePositionMap::iterator it = mObjectStreams.find(inObjectStreamID);
+	if(it == mObjectStreams.end())
+		return NULL;
+
+	// move to front of use order
+	if(it->second.second != mUseOrder.begin())
+		mUseOrder.splice(mUseOrder.begin(),mUseOrder,it->second.second);
+	return it->second.first;
+}
+
+bool DecodedObjectStreamsCache::Add(ObjectIDType inObjectStreamID,DecodedObjectStream* inObjectStream)
+{
+	LongBufferSizeType streamSize = inObjectStream->mData.size();
+
+	if(streamSize > mMaximumSize || mObjectStreams.find(inObjectStreamID) != mObjectStreams.end())
+		return false;
+
+	while(mCurrentSize + streamSize > mMaximumSize)
+		DropLeastRecentlyUsed();
+
+	mUseOrder.push_front(inObjectStreamID);
+	mObjectStreams.insert(ObjectIDTypeToDecodedObjectStreamAndUsePositionMap::value_type(
+								inObjectStreamID,DecodedObjectStreamAndUsePosition(inObjectStream,mUseOrder.begin())));
+	mCurrentSize += streamSize;
+	return true;
+}
+
+void DecodedObjectStreamsCache::DropLeastRecentlyUsed()
+{
+	if(mUseOrder.size() == 0)
+		return;
+
+	ObjectIDTypeToDecodedObjectStreamAndUsePositionMap::iterator it = mObjectStreams.find(mUseOrder.back());
+	mCurrentSize -= it->second.first->mData.size();
+	delete it->second.first;
+	mObjectStreams.erase(it);
+	mUseOrder.pop_back();
+}
+
+void DecodedObjectStreamsCache::Reset()
+{
+	ObjectIDTypeToDecodedObjectStreamAndUsePositionMap::iterator it = mObjectStreams.begin();
+	for(; it != mObjectStreams.end(); ++it)
+		delete it->second.first;
+	mObjectStreams.clear();
+	mUseOrder.clear();
+	mCurrentSize = 0;
+}
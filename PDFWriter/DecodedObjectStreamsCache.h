@@ -0,0 +1,81 @@
+/*
+   Source File : DecodedObjectStreamsCache.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "IOBasicTypes.h"
+#include "ObjectsBasicTypes.h"
+
+#include <string>
+#include <map>
+#include <list>
+#include <utility>
+
+/*
+	Decoded object stream, as held by DecodedObjectStreamsCache. keeps the stream N and First values
+	along with the fully decoded (defiltered and decrypted) stream data, so objects can be parsed from it
+	without going through the stream filters again.
+*/
+struct DecodedObjectStream
+{
+	DecodedObjectStream(){mObjectsCount = 0;mFirstObjectPosition = 0;}
+
+	ObjectIDType mObjectsCount;
+	IOBasicTypes::LongFilePositionType mFirstObjectPosition;
+	std::string mData;
+};
+
+typedef std::list<ObjectIDType> ObjectIDTypeList;
+typedef std::pair<DecodedObjectStream*,ObjectIDTypeList::iterator> DecodedObjectStreamAndUsePosition;
+typedef std::map<ObjectIDType,DecodedObjectStreamAndUsePosition> ObjectIDTypeToDecodedObjectStreamAndUsePositionMap;
+
+/*
+	LRU cache of decoded object streams, bounded by the total size of the decoded data.
+	when adding a stream would exceed the maximum size, least recently used streams are dropped.
+*/
+class DecodedObjectStreamsCache
+{
+public:
+	DecodedObjectStreamsCache(void);
+	~DecodedObjectStreamsCache(void);
+
+	// maximum total size of decoded data, in bytes. 0 means no caching
+	void SetMaximumSize(IOBasicTypes::LongBufferSizeType inMaximumSize);
+	IOBasicTypes::LongBufferSizeType GetMaximumSize();
+	IOBasicTypes::LongBufferSizeType GetCurrentSize();
+
+	// get a cached stream, marking it as most recently used. returns NULL if not in cache
+	DecodedObjectStream* Get(ObjectIDType inObjectStreamID);
+
+	// add a stream to the cache, which then takes ownership of it. 
+	// returns false if the stream is larger than the maximum size. in which case it is not added, and ownership remains with the caller
+	bool Add(ObjectIDType inObjectStreamID,DecodedObjectStream* inObjectStream);
+
+	// drop all cached streams
+	void Reset();
+
+private:
+	IOBasicTypes::LongBufferSizeType mMaximumSize;
+	IOBasicTypes::LongBufferSizeType mCurrentSize;
+	ObjectIDTypeToDecodedObjectStreamAndUsePositionMap mObjectStreams;
+	ObjectIDTypeList mUseOrder; // most recently used first
+
+	void DropLeastRecentlyUsed();
+};
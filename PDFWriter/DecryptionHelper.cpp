@@ -34,6 +34,7 @@ limitations under the License.
 #include "RefCountPtr.h"
 #include "OutputStringBufferStream.h"
 #include "InputRC4XcodeStream.h"
+#include "InputAESDecodeStream.h"
 #include "Trace.h"
 
 using namespace std;
@@ -50,6 +51,8 @@ DecryptionHelper::~DecryptionHelper(void)
 }
 
 void DecryptionHelper::Reset() {
+	mStreamsXCryptionMethod = eXCryptionMethodRC4;
+	mStringsXCryptionMethod = eXCryptionMethodRC4;
 	mSupportsDecryption = false;
 	mFailedPasswordVerification = false;
 	mDidSucceedOwnerPasswordVerification = false;
@@ -89,15 +92,28 @@ EStatusCode DecryptionHelper::Setup(PDFParser* inParser, const std::string& inPa
 			mV = (unsigned int)vHelper.GetAsInteger();
 		}
 
-		// supporting only  versions 1 and 2 (no crypt filters and nothing unpublished)
-		if (mV != 1 && mV != 2) {
-			TRACE_LOG1("DecryptionHelper::Setup, Only 1 and 2 are supported values for V. Unsupported filter encountered - %d", mV);
+		// supporting versions 1 and 2 (RC4), and 4 and 5 (crypt filters, for RC4 or AES). nothing unpublished
+		if (mV != 1 && mV != 2 && mV != 4 && mV != 5) {
+			TRACE_LOG1("DecryptionHelper::Setup, Only 1, 2, 4 and 5 are supported values for V. Unsupported filter encountered - %d", mV);
 			break;
 		}
 
+		if (mV >= 4) {
+			if (!ReadXCryptionMethod(inParser, encryptionDictionary.GetPtr(), "StmF", mStreamsXCryptionMethod) ||
+				!ReadXCryptionMethod(inParser, encryptionDictionary.GetPtr(), "StrF", mStringsXCryptionMethod))
+				break;
+		}
+		else {
+			mStreamsXCryptionMethod = eXCryptionMethodRC4;
+			mStringsXCryptionMethod = eXCryptionMethodRC4;
+		}
+
 		RefCountPtr<PDFObject> length(inParser->QueryDictionaryObject(encryptionDictionary.GetPtr(), "Length"));
-		if (!length) {
-			mLength = 40/8;
+		if (mV == 5) {
+			mLength = 256/8; // AES-256 is the only option
+		}
+		else if (!length) {
+			mLength = (mV == 4 ? 128 : 40)/8;
 		}
 		else {
 			ParsedPrimitiveHelper lengthHelper(length.GetPtr());
@@ -165,24 +181,48 @@ EStatusCode DecryptionHelper::Setup(PDFParser* inParser, const std::string& inPa
 			}
 		}
 
-		mXcryption.Setup(false);
-		if (!mXcryption.CanXCrypt()) 
-			break;
+		if (mRevision >= 5) {
+			// revisions 5 and 6 keep the file key encrypted with the passwords
+			RefCountPtr<PDFObject> oe(inParser->QueryDictionaryObject(encryptionDictionary.GetPtr(), "OE"));
+			RefCountPtr<PDFObject> ue(inParser->QueryDictionaryObject(encryptionDictionary.GetPtr(), "UE"));
+			if (!oe || !ue) {
+				TRACE_LOG("DecryptionHelper::Setup, missing OE or UE for revision 5 or 6 encryption");
+				break;
+			}
+			mOE = mXcryption.stringToByteList(ParsedPrimitiveHelper(oe.GetPtr()).ToString());
+			mUE = mXcryption.stringToByteList(ParsedPrimitiveHelper(ue.GetPtr()).ToString());
+		}
 
-		mXcryption.SetupInitialEncryptionKey(
-			inPassword,
-			mRevision,
-			mLength,
-			mO,
-			mP,
-			mFileIDPart1,
-			mEncryptMetaData);
+		mXcryption.Setup(mStreamsXCryptionMethod);
+		mXcryptionStrings.Setup(mStringsXCryptionMethod);
+		if (!mXcryption.CanXCrypt() || !mXcryptionStrings.CanXCrypt()) 
+			break;
 
 		// authenticate password, try to determine if user or owner
 		ByteList password = mXcryption.stringToByteList(inPassword);
 
-		mDidSucceedOwnerPasswordVerification = AuthenticateOwnerPassword(password);
-		mFailedPasswordVerification = !mDidSucceedOwnerPasswordVerification && !AuthenticateUserPassword(password);
+		if (mRevision >= 5) {
+			// the file key is retrieved as part of the authentication
+			ByteList encryptionKey;
+			mDidSucceedOwnerPasswordVerification = mXcryption.algorithm2_A(mRevision, password, mO, mU, mOE, mUE, true, encryptionKey);
+			mFailedPasswordVerification = !mDidSucceedOwnerPasswordVerification && 
+											!mXcryption.algorithm2_A(mRevision, password, mO, mU, mOE, mUE, false, encryptionKey);
+			mXcryption.SetupInitialEncryptionKey(encryptionKey);
+		}
+		else {
+			mXcryption.SetupInitialEncryptionKey(
+				inPassword,
+				mRevision,
+				mLength,
+				mO,
+				mP,
+				mFileIDPart1,
+				mEncryptMetaData);
+
+			mDidSucceedOwnerPasswordVerification = AuthenticateOwnerPassword(password);
+			mFailedPasswordVerification = !mDidSucceedOwnerPasswordVerification && !AuthenticateUserPassword(password);
+		}
+		mXcryptionStrings.SetupInitialEncryptionKey(mXcryption.GetInitialEncryptionKey());
 
 
 		mSupportsDecryption = true;
@@ -214,26 +254,33 @@ bool DecryptionHelper::DidSucceedOwnerPasswordVerification() const {
 static const string scEcnryptionKeyMetadataKey = "DecryptionHelper.EncryptionKey";
 
 IByteReader* DecryptionHelper::CreateDecryptionFilterForStream(PDFStreamInput* inStream, IByteReader* inToWrapStream) {
-	if (!IsEncrypted() || !CanDecryptDocument())
+	if (!IsEncrypted() || !CanDecryptDocument() || eXCryptionMethodNone == mStreamsXCryptionMethod)
 		return NULL;
 	
+	// xref streams are never encrypted, and metadata streams may be left unencrypted
+	RefCountPtr<PDFDictionary> streamDictionary(inStream->QueryStreamDictionary());
+	PDFObjectCastPtr<PDFName> type(streamDictionary->QueryDirectObject("Type"));
+	if (!!type && (type->GetValue() == "XRef" || (type->GetValue() == "Metadata" && !mEncryptMetaData)))
+		return NULL;
+
 	void* savedEcnryptionKey = inStream->GetMetadata(scEcnryptionKeyMetadataKey);
 	if (savedEcnryptionKey) {
-		return CreateDecryptionReader(inToWrapStream, *((ByteList*)savedEcnryptionKey));
+		return CreateDecryptionReader(inToWrapStream, *((ByteList*)savedEcnryptionKey), mStreamsXCryptionMethod);
 	}
 	else 
 		return NULL;
 }
 
 std::string DecryptionHelper::DecryptString(const std::string& inStringToDecrypt) {
-	if (!IsEncrypted() || !CanDecryptDocument())
+	if (!IsEncrypted() || !CanDecryptDocument() || eXCryptionMethodNone == mStringsXCryptionMethod)
 		return inStringToDecrypt;
 
-	IByteReader* decryptStream = CreateDecryptionReader(new InputStringStream(inStringToDecrypt), mXcryption.GetCurrentObjectKey());
+	IByteReader* decryptStream = CreateDecryptionReader(new InputStringStream(inStringToDecrypt), mXcryptionStrings.GetCurrentObjectKey(), mStringsXCryptionMethod);
 	if (decryptStream) {
 		OutputStringBufferStream outputStream;
 		OutputStreamTraits traits(&outputStream);
 		traits.CopyToOutputStream(decryptStream);
+		delete decryptStream;
 
 		return outputStream.ToString();
 	}
@@ -246,6 +293,7 @@ void DecryptionHelper::OnObjectStart(long long inObjectID, long long inGeneratio
 		return;
 
 	mXcryption.OnObjectStart(inObjectID,inGenerationNumber);
+	mXcryptionStrings.OnObjectStart(inObjectID,inGenerationNumber);
 }
 void DecryptionHelper::OnObjectEnd(PDFObject* inObject) {
 	if (!IsEncrypted() || !CanDecryptDocument())
@@ -257,10 +305,50 @@ void DecryptionHelper::OnObjectEnd(PDFObject* inObject) {
 		inObject->SetMetadata(scEcnryptionKeyMetadataKey, savedKey);
 	}
 	mXcryption.OnObjectEnd();
+	mXcryptionStrings.OnObjectEnd();
+}
+
+IByteReader* DecryptionHelper::CreateDecryptionReader(IByteReader* inSourceStream, const ByteList& inEncryptionKey, EXCryptionMethod inMethod) {
+	switch (inMethod) {
+		case eXCryptionMethodRC4:
+			return new InputRC4XcodeStream(inSourceStream, inEncryptionKey);
+		case eXCryptionMethodAESV2:
+		case eXCryptionMethodAESV3:
+			return new InputAESDecodeStream(inSourceStream, inEncryptionKey);
+		default:
+			return NULL;
+	}
 }
 
-IByteReader* DecryptionHelper::CreateDecryptionReader(IByteReader* inSourceStream, const ByteList& inEncryptionKey) {
-	return new InputRC4XcodeStream(inSourceStream, inEncryptionKey);
+bool DecryptionHelper::ReadXCryptionMethod(PDFParser* inParser, PDFDictionary* inEncryptionDictionary, const std::string& inFilterKey, EXCryptionMethod& outMethod) {
+	// StmF/StrF name a crypt filter in CF. Identity (the default) means no encryption
+	PDFObjectCastPtr<PDFName> filterName(inParser->QueryDictionaryObject(inEncryptionDictionary, inFilterKey));
+	if (!filterName || filterName->GetValue() == "Identity") {
+		outMethod = eXCryptionMethodNone;
+		return true;
+	}
+
+	PDFObjectCastPtr<PDFDictionary> cryptFilters(inParser->QueryDictionaryObject(inEncryptionDictionary, "CF"));
+	PDFObjectCastPtr<PDFDictionary> cryptFilter(!cryptFilters ? NULL : inParser->QueryDictionaryObject(cryptFilters.GetPtr(), filterName->GetValue()));
+	if (!cryptFilter) {
+		TRACE_LOG1("DecryptionHelper::ReadXCryptionMethod, crypt filter %s is not defined", filterName->GetValue().c_str());
+		return false;
+	}
+
+	PDFObjectCastPtr<PDFName> cfm(inParser->QueryDictionaryObject(cryptFilter.GetPtr(), "CFM"));
+	if (!cfm || cfm->GetValue() == "None")
+		outMethod = eXCryptionMethodNone;
+	else if (cfm->GetValue() == "V2")
+		outMethod = eXCryptionMethodRC4;
+	else if (cfm->GetValue() == "AESV2")
+		outMethod = eXCryptionMethodAESV2;
+	else if (cfm->GetValue() == "AESV3")
+		outMethod = eXCryptionMethodAESV3;
+	else {
+		TRACE_LOG1("DecryptionHelper::ReadXCryptionMethod, unsupported crypt filter method %s", cfm->GetValue().c_str());
+		return false;
+	}
+	return true;
 }
 
 
@@ -329,4 +417,13 @@ const ByteList& DecryptionHelper::GetU() const
 const ByteList& DecryptionHelper::GetInitialEncryptionKey() const
 {
 	return mXcryption.GetInitialEncryptionKey();
-}
\ No newline at end of file
+}
+EXCryptionMethod DecryptionHelper::GetStreamsXCryptionMethod() const
+{
+	return mStreamsXCryptionMethod;
+}
+
+EXCryptionMethod DecryptionHelper::GetStringsXCryptionMethod() const
+{
+	return mStringsXCryptionMethod;
+}
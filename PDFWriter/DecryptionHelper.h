@@ -29,6 +29,7 @@ class PDFParser;
 class IByteReader;
 class PDFStreamInput;
 class PDFObject;
+class PDFDictionary;
 
 class DecryptionHelper {
 
@@ -72,11 +73,16 @@ public:
 	const ByteList& GetO() const;
 	const ByteList& GetU() const;
 	const ByteList& GetInitialEncryptionKey() const;
+	// methods used for streams and strings. for V 1 and 2 this is always RC4, for V 4 and 5 it's per the StmF and StrF crypt filters
+	EXCryptionMethod GetStreamsXCryptionMethod() const;
+	EXCryptionMethod GetStringsXCryptionMethod() const;
 
 	// Reset after or before usage
 	void Reset();
 private:
-	XCryptionCommon mXcryption;
+	// per object keys are computed differently for RC4 and AES, so keep separate computation for streams and strings (normally they are the same)
+	XCryptionCommon mXcryption; // streams
+	XCryptionCommon mXcryptionStrings;
 
 	bool mIsEncrypted;
 	bool mSupportsDecryption;
@@ -84,8 +90,11 @@ private:
 	// Generic encryption
 	unsigned int mV;
 	unsigned int mLength; // mLength is in bytes!
+	EXCryptionMethod mStreamsXCryptionMethod;
+	EXCryptionMethod mStringsXCryptionMethod;
 	
-	IByteReader* CreateDecryptionReader(IByteReader* inSourceStream,const ByteList& inEncryptionKey);
+	IByteReader* CreateDecryptionReader(IByteReader* inSourceStream,const ByteList& inEncryptionKey,EXCryptionMethod inMethod);
+	bool ReadXCryptionMethod(PDFParser* inParser,PDFDictionary* inEncryptionDictionary,const std::string& inFilterKey,EXCryptionMethod& outMethod);
 
 	// Standard filter specific
 	bool mFailedPasswordVerification;
@@ -97,6 +106,9 @@ private:
 	long long mP;
 	bool mEncryptMetaData;
 	ByteList mFileIDPart1;
+	// revision 5 and 6 only
+	ByteList mOE;
+	ByteList mUE;
 
 	bool AuthenticateUserPassword(const ByteList& inPassword);
 	bool AuthenticateOwnerPassword(const ByteList& inPassword);
@@ -0,0 +1,136 @@
+/*
+   Source File : DeferredFormXObjectContentContext.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "DeferredFormXObjectContentContext.h"
+#include "ISharedResourcesLock.h"
+#include "FormImageWritingTask.h"
+
+using namespace PDFHummus;
+
+DeferredFormXObjectContentContext::DeferredFormXObjectContentContext(PDFHummus::DocumentContext* inDocumentContext,
+																	 ObjectIDType inFormXObjectID,
+																	 const PDFRectangle& inBoundingBox,
+																	 const double* inMatrix,
+																	 bool inCompressContent,
+																	 ISharedResourcesLock* inSharedResourcesLock,
+																	 const FlateCompressionParameters& inCompressionParameters):AbstractContentContext(inDocumentContext)
+{
+	mFormXObjectID = inFormXObjectID;
+	mBoundingBox = inBoundingBox;
+	mHasMatrix = (inMatrix != NULL);
+	for(int i=0;i<6;++i)
+		mMatrix[i] = mHasMatrix ? inMatrix[i] : ((0 == i || 3 == i) ? 1 : 0);
+	mSharedResourcesLock = inSharedResourcesLock;
+	mCompressContent = inCompressContent;
+	mContentFinalized = false;
+
+	if(mCompressContent)
+	{
+		mFlateEncodingStream.SetCompressionParameters(inCompressionParameters);
+		mFlateEncodingStream.Assign(&mContentBuffer);
+		SetStreamForWrite(&mFlateEncodingStream);
+	}
+	else
+	{
+		SetStreamForWrite(&mContentBuffer);
+	}
+}
+
+DeferredFormXObjectContentContext::~DeferredFormXObjectContentContext(void)
+{
+	// flate stream owns its target, so release the buffer before destruction
+	mFlateEncodingStream.Assign(NULL);
+
+	// tasks that were not detached on commit belong to a form that was never written
+	IFormEndWritingTaskList::iterator it = mEndWritingTasks.begin();
+	for(; it != mEndWritingTasks.end(); ++it)
+		delete *it;
+}
+
+void DeferredFormXObjectContentContext::FinalizeContent()
+{
+	if(mContentFinalized)
+		return;
+
+	if(mCompressContent)
+		mFlateEncodingStream.Assign(NULL);
+	mContentFinalized = true;
+}
+
+ObjectIDType DeferredFormXObjectContentContext::GetObjectID()
+{
+	return mFormXObjectID;
+}
+
+ResourcesDictionary& DeferredFormXObjectContentContext::GetFormResourcesDictionary()
+{
+	return mResources;
+}
+
+const PDFRectangle& DeferredFormXObjectContentContext::GetBoundingBox()
+{
+	return mBoundingBox;
+}
+
+const double* DeferredFormXObjectContentContext::GetMatrix()
+{
+	return mHasMatrix ? mMatrix : NULL;
+}
+
+bool DeferredFormXObjectContentContext::IsContentCompressed()
+{
+	return mCompressContent;
+}
+
+std::string DeferredFormXObjectContentContext::GetContent()
+{
+	FinalizeContent();
+	return mContentBuffer.ToString();
+}
+
+IFormEndWritingTaskList DeferredFormXObjectContentContext::DetachEndWritingTasks()
+{
+	IFormEndWritingTaskList result;
+	result.swap(mEndWritingTasks);
+	return result;
+}
+
+ResourcesDictionary* DeferredFormXObjectContentContext::GetResourcesDictionary()
+{
+	return &mResources;
+}
+
+void DeferredFormXObjectContentContext::ScheduleImageWrite(const std::string& inImagePath,unsigned long inImageIndex,ObjectIDType inObjectID, const PDFParsingOptions& inParsingOptions)
+{
+	// the form object is only created on commit, so keep the task with the context till then
+	mEndWritingTasks.push_back(new FormImageWritingTask(inImagePath,inImageIndex,inObjectID,inParsingOptions));
+}
+
+void DeferredFormXObjectContentContext::LockSharedResources()
+{
+	if(mSharedResourcesLock)
+		mSharedResourcesLock->Lock();
+}
+
+void DeferredFormXObjectContentContext::UnlockSharedResources()
+{
+	if(mSharedResourcesLock)
+		mSharedResourcesLock->Unlock();
+}
@@ -0,0 +1,92 @@
+/*
+   Source File : DeferredFormXObjectContentContext.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+/*
+	Form XObject content context that writes to a private memory buffer, the form counterpart of DeferredPageContentContext.
+	The form object ID is allocated when the context is started, so pages and other forms may place the form right away,
+	while its content is written, possibly from another thread. Commit it with PDFWriter::WriteDeferredFormXObjectAndRelease,
+	from the thread that owns the PDFWriter, to write the form and its resources dictionary. 
+	The resources dictionary is kept with the context until commit, so it is allocated and written only then.
+
+	The threading contract is the same as for deferred pages (see DeferredPageContentContext.h). 
+*/
+
+#include "AbstractContentContext.h"
+#include "ResourcesDictionary.h"
+#include "PDFRectangle.h"
+#include "OutputStringBufferStream.h"
+#include "OutputFlateEncodeStream.h"
+#include "DocumentContext.h"
+
+#include <string>
+
+class ISharedResourcesLock;
+
+class DeferredFormXObjectContentContext : public AbstractContentContext
+{
+public:
+	DeferredFormXObjectContentContext(PDFHummus::DocumentContext* inDocumentContext,
+										ObjectIDType inFormXObjectID,
+										const PDFRectangle& inBoundingBox,
+										const double* inMatrix,
+										bool inCompressContent,
+										ISharedResourcesLock* inSharedResourcesLock,
+										const FlateCompressionParameters& inCompressionParameters = FlateCompressionParameters());
+	virtual ~DeferredFormXObjectContentContext(void);
+
+	// Finish writing the content. Call when done writing, from the writing thread, to complete compressing the content.
+	// writing to the context after this call is not allowed. Calling it is optional - the content is finalized on commit anyways.
+	void FinalizeContent();
+
+	// the form object ID, for placing the form (see ResourcesDictionary::AddFormXObjectMapping)
+	ObjectIDType GetObjectID();
+	// the resources of the form, written with the form on commit
+	ResourcesDictionary& GetFormResourcesDictionary();
+
+	// commit time accessors
+	const PDFRectangle& GetBoundingBox();
+	// NULL if the form has no matrix
+	const double* GetMatrix();
+	bool IsContentCompressed();
+	std::string GetContent();
+	// end writing tasks for images drawn on the form. ownership passes to the caller
+	IFormEndWritingTaskList DetachEndWritingTasks();
+
+private:
+	ObjectIDType mFormXObjectID;
+	PDFRectangle mBoundingBox;
+	double mMatrix[6];
+	bool mHasMatrix;
+	ResourcesDictionary mResources;
+	IFormEndWritingTaskList mEndWritingTasks;
+	ISharedResourcesLock* mSharedResourcesLock;
+	bool mCompressContent;
+	bool mContentFinalized;
+	OutputStringBufferStream mContentBuffer;
+	OutputFlateEncodeStream mFlateEncodingStream;
+
+	// AbstractContentContext implementation
+	virtual ResourcesDictionary* GetResourcesDictionary();
+	virtual void ScheduleImageWrite(const std::string& inImagePath,unsigned long inImageIndex,ObjectIDType inObjectID, const PDFParsingOptions& inParsingOptions);
+	virtual void LockSharedResources();
+	virtual void UnlockSharedResources();
+};
@@ -0,0 +1,106 @@
+/*
+   Source File : DeferredPageContentContext.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "DeferredPageContentContext.h"
+#include "PDFPage.h"
+#include "ISharedResourcesLock.h"
+#include "PageImageWritingTask.h"
+#include "DocumentContext.h"
+
+using namespace PDFHummus;
+
+DeferredPageContentContext::DeferredPageContentContext(PDFHummus::DocumentContext* inDocumentContext,
+													   PDFPage* inPageOfContext,
+													   bool inCompressContent,
+													   ISharedResourcesLock* inSharedResourcesLock,
+													   const FlateCompressionParameters& inCompressionParameters):AbstractContentContext(inDocumentContext)
+{
+	mPageOfContext = inPageOfContext;
+	mSharedResourcesLock = inSharedResourcesLock;
+	mCompressContent = inCompressContent;
+	mContentFinalized = false;
+
+	if(mCompressContent)
+	{
+		mFlateEncodingStream.SetCompressionParameters(inCompressionParameters);
+		mFlateEncodingStream.Assign(&mContentBuffer);
+		SetStreamForWrite(&mFlateEncodingStream);
+	}
+	else
+	{
+		SetStreamForWrite(&mContentBuffer);
+	}
+}
+
+DeferredPageContentContext::~DeferredPageContentContext(void)
+{
+	// flate stream owns its target, so release the buffer before destruction
+	mFlateEncodingStream.Assign(NULL);
+}
+
+void DeferredPageContentContext::FinalizeContent()
+{
+	if(mContentFinalized)
+		return;
+
+	if(mCompressContent)
+		mFlateEncodingStream.Assign(NULL);
+	mContentFinalized = true;
+}
+
+PDFPage* DeferredPageContentContext::GetAssociatedPage()
+{
+	return mPageOfContext;
+}
+
+bool DeferredPageContentContext::IsContentCompressed()
+{
+	return mCompressContent;
+}
+
+std::string DeferredPageContentContext::GetContent()
+{
+	FinalizeContent();
+	return mContentBuffer.ToString();
+}
+
+ResourcesDictionary* DeferredPageContentContext::GetResourcesDictionary()
+{
+	return &(mPageOfContext->GetResourcesDictionary());
+}
+
+void DeferredPageContentContext::ScheduleImageWrite(const std::string& inImagePath,unsigned long inImageIndex,ObjectIDType inObjectID, const PDFParsingOptions& inParsingOptions)
+{
+	// called while holding the shared resources lock
+    mDocumentContext->RegisterPageEndWritingTask(GetAssociatedPage(),
+                                                 new PageImageWritingTask(inImagePath,inImageIndex,inObjectID,inParsingOptions));
+}
+
+void DeferredPageContentContext::LockSharedResources()
+{
+	if(mSharedResourcesLock)
+		mSharedResourcesLock->Lock();
+}
+
+void DeferredPageContentContext::UnlockSharedResources()
+{
+	if(mSharedResourcesLock)
+		mSharedResourcesLock->Unlock();
+}
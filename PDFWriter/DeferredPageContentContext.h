@@ -0,0 +1,83 @@
+/*
+   Source File : DeferredPageContentContext.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+/*
+	Page content context that writes to a private memory buffer instead of the PDF output stream.
+	Being detached from the objects context, multiple deferred contexts can be written at the same time, each from its own thread,
+	and later committed to the PDF - in page order - with PDFWriter::WriteDeferredPageAndRelease, from the thread that owns the PDFWriter.
+	The content stream object, and the page object, are only allocated at commit time, so the PDF objects are written in commit order.
+
+	Thread safety:
+	1. a deferred context (and its page) should be used by one thread at a time.
+	2. fonts and images used in the content are shared document resources. If writing from multiple threads, set a lock with
+	   PDFWriter::SetSharedResourcesLock prior to creating the contexts, and the context will lock it when touching them. 
+	   Getting the fonts (PDFWriter::GetFontForFile) should be done either prior to starting the threads, or while holding the lock.
+	3. Other than committing deferred pages, don't write to the PDF while deferred contexts are being written from other threads.
+
+	If the document compresses streams, the content is compressed on the writing thread, as it is written, with flate.
+	Form xobjects have a deferred counterpart - DeferredFormXObjectContentContext - committed the same way, in between the pages.
+*/
+
+#include "AbstractContentContext.h"
+#include "OutputStringBufferStream.h"
+#include "OutputFlateEncodeStream.h"
+
+#include <string>
+
+class PDFPage;
+class ISharedResourcesLock;
+
+class DeferredPageContentContext : public AbstractContentContext
+{
+public:
+	DeferredPageContentContext(PDFHummus::DocumentContext* inDocumentContext,
+								PDFPage* inPageOfContext,
+								bool inCompressContent,
+								ISharedResourcesLock* inSharedResourcesLock,
+								const FlateCompressionParameters& inCompressionParameters = FlateCompressionParameters());
+	virtual ~DeferredPageContentContext(void);
+
+	// Finish writing the content. Call when done writing, from the writing thread, to complete compressing the content.
+	// writing to the context after this call is not allowed. Calling it is optional - the content is finalized on commit anyways.
+	void FinalizeContent();
+
+	// get the page to which this content is associated
+	PDFPage* GetAssociatedPage();
+
+	// commit time accessors
+	bool IsContentCompressed();
+	std::string GetContent();
+	
+private:
+	PDFPage* mPageOfContext;
+	ISharedResourcesLock* mSharedResourcesLock;
+	bool mCompressContent;
+	bool mContentFinalized;
+	OutputStringBufferStream mContentBuffer;
+	OutputFlateEncodeStream mFlateEncodingStream;
+
+	// AbstractContentContext implementation
+	virtual ResourcesDictionary* GetResourcesDictionary();
+	virtual void ScheduleImageWrite(const std::string& inImagePath,unsigned long inImageIndex,ObjectIDType inObjectID, const PDFParsingOptions& inParsingOptions);
+	virtual void LockSharedResources();
+	virtual void UnlockSharedResources();
+};
@@ -267,7 +267,7 @@ void DescendentFontWriter::WriteCharSet(	DictionaryContext* inDescriptorContext,
 void DescendentFontWriter::WriteCIDSet(const UIntAndGlyphEncodingInfoVector& inEncodedGlyphs)
 {
 	mObjectsContext->StartNewIndirectObject(mCIDSetObjectID);
-	PDFStream* pdfStream = mObjectsContext->StartPDFStream();	
+	PDFStream* pdfStream = mObjectsContext->StartPDFStream(NULL,false,eStreamCategoryFont);	
 	IByteWriter* cidSetWritingContext = pdfStream->GetWriteStream();
 	Byte buffer;
 	UIntAndGlyphEncodingInfoVector::const_iterator it = inEncodedGlyphs.begin();
@@ -28,12 +28,16 @@ using namespace PDFHummus;
 
 static const std::string scStartDictionary = "<<";
 static const std::string scEndDictionary = ">>";
+// keys count from which written keys are kept in a set
+static const size_t scKeysSetThreshold = 16;
 
 
 DictionaryContext::DictionaryContext(ObjectsContext* inObjectsContext,size_t inIndentLevel)
 {
 	mObjectsContext = inObjectsContext;
 	mIndentLevel= inIndentLevel;
+	mKeysCount = 0;
+	mWriteIndents = !mObjectsContext->IsCompactSerialization();
 
 	mObjectsContext->WriteKeyword(scStartDictionary);
 }
@@ -50,11 +54,11 @@ DictionaryContext::~DictionaryContext(void)
 
 EStatusCode DictionaryContext::WriteKey(const std::string& inKey)
 {
-	if(mKeys.find(inKey) == mKeys.end())
+	if(!HasKey(inKey))
 	{
 		WriteIndents();
 		mObjectsContext->WriteName(inKey);
-		mKeys.insert(inKey);
+		AddKey(inKey);
 		return PDFHummus::eSuccess;
 	}
 	else
@@ -64,13 +68,53 @@ EStatusCode DictionaryContext::WriteKey(const std::string& inKey)
 	}
 }
 
+void DictionaryContext::AddKey(const std::string& inKey)
+{
+	++mKeysCount;
+	if(mKeysCount < scKeysSetThreshold)
+	{
+		mKeys.append(inKey);
+		mKeys.push_back('\0');
+		return;
+	}
+
+	if(mKeysCount == scKeysSetThreshold)
+	{
+		// move the keys written so far to the set
+		size_t keyStart = 0;
+		while(keyStart < mKeys.size())
+		{
+			size_t keyEnd = mKeys.find('\0',keyStart);
+			mKeysSet.insert(mKeys.substr(keyStart,keyEnd - keyStart));
+			keyStart = keyEnd + 1;
+		}
+		mKeys.clear();
+	}
+	mKeysSet.insert(inKey);
+}
+
 bool DictionaryContext::HasKey(const std::string& inKey) {
-	return mKeys.find(inKey) != mKeys.end();
+	if(mKeysCount >= scKeysSetThreshold)
+		return mKeysSet.find(inKey) != mKeysSet.end();
+
+	size_t keyStart = 0;
+
+	while(keyStart < mKeys.size())
+	{
+		size_t keyEnd = mKeys.find('\0',keyStart);
+		if(keyEnd - keyStart == inKey.size() && mKeys.compare(keyStart,inKey.size(),inKey) == 0)
+			return true;
+		keyStart = keyEnd + 1;
+	}
+	return false;
 }
 
 static const Byte scTab[1] = {'\t'};
 void DictionaryContext::WriteIndents()
 {
+	if(!mWriteIndents)
+		return;
+
 	IByteWriterWithPosition* outputStream = mObjectsContext->StartFreeContext();
 	for(size_t i=0;i<=mIndentLevel;++i)
 		outputStream->Write(scTab,1);
@@ -131,8 +175,7 @@ void DictionaryContext::WriteRectangleValue(const PDFRectangle& inRectangle)
 	mObjectsContext->WriteDouble(inRectangle.LowerLeftY);
 	mObjectsContext->WriteDouble(inRectangle.UpperRightX);
 	mObjectsContext->WriteDouble(inRectangle.UpperRightY);
-	mObjectsContext->EndArray();
-	mObjectsContext->EndLine();
+	mObjectsContext->EndArray(eTokenSeparatorEndLine);
 }
 
 void DictionaryContext::WriteDoubleValue(double inValue)
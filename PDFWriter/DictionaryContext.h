@@ -64,8 +64,15 @@ public:
 private:
 
 	ObjectsContext* mObjectsContext;
-	StringSet mKeys;
+	// written keys, each followed by a 0 [names can't have 0 characters in them]. most dictionaries are small, so a flat buffer
+	// scanned for duplicates is quicker than a set, and has no allocation per key. past a few keys they move to mKeysSet,
+	// so large dictionaries don't pay a linear scan per key
+	std::string mKeys;
+	size_t mKeysCount;
+	StringSet mKeysSet;
 	size_t mIndentLevel;
+	bool mWriteIndents;
 
+	void AddKey(const std::string& inKey);
 
 };
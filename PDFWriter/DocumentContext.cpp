@@ -31,6 +31,10 @@
 #include "Trace.h"
 #include "IDocumentContextExtender.h"
 #include "PageContentContext.h"
+#include "DeferredPageContentContext.h"
+#include "DeferredFormXObjectContentContext.h"
+#include "ISharedResourcesLock.h"
+#include "PDFStream.h"
 #include "PDFFormXObject.h"
 #include "PDFTiledPattern.h"
 #include "PDFParser.h"
@@ -59,6 +63,7 @@ DocumentContext::DocumentContext()
 	mObjectsContext = NULL;
 	mParserExtender = NULL;
     mModifiedDocumentIDExists = false;
+	mSharedResourcesLock = NULL;
 }
 
 DocumentContext::~DocumentContext(void)
@@ -77,6 +82,11 @@ void DocumentContext::SetObjectsContext(ObjectsContext* inObjectsContext)
 #endif
 }
 
+ObjectsContext* DocumentContext::GetObjectsContext()
+{
+	return mObjectsContext;
+}
+
 void DocumentContext::SetOutputFileInformation(OutputFile* inOutputFile)
 {
 	// just save the output file path for the ID generation in the end
@@ -207,13 +217,23 @@ EStatusCode	DocumentContext::FinalizeNewPDF(bool inEmbedFonts)
 		// write encryption dictionary, if encrypting
 		WriteEncryptionDictionary();
 
-		status = mObjectsContext->WriteXrefTable(xrefTablePosition);
-		if(status != 0)
-			break;
+		// object streams are referenced from an xref stream
+		if(mObjectsContext->IsWritingObjectStreams())
+		{
+			status = WriteXrefStream(xrefTablePosition);
+			if(status != 0)
+				break;
+		}
+		else
+		{
+			status = mObjectsContext->WriteXrefTable(xrefTablePosition);
+			if(status != 0)
+				break;
 
-		status = WriteTrailerDictionary();
-		if(status != 0)
-			break;
+			status = WriteTrailerDictionary();
+			if(status != 0)
+				break;
+		}
 
 		WriteXrefReference(xrefTablePosition);
 		WriteFinalEOF();
@@ -228,7 +248,9 @@ static const std::string scStartXref = "startxref";
 void DocumentContext::WriteXrefReference(LongFilePositionType inXrefTablePosition)
 {
 	mObjectsContext->WriteKeyword(scStartXref);
-	mObjectsContext->WriteInteger(inXrefTablePosition,eTokenSeparatorEndLine);
+	// the position and the EOF marker that follows are on lines of their own, also with compact serialization
+	mObjectsContext->WriteInteger(inXrefTablePosition,eTokenSepratorNone);
+	mObjectsContext->EndLine();
 }
 
 static const IOBasicTypes::Byte scEOF[] = {'%','%','E','O','F'}; 
@@ -774,6 +796,149 @@ EStatusCodeAndObjectIDType DocumentContext::WritePageAndRelease(PDFPage* inPage)
 	return status;
 }
 
+DeferredPageContentContext* DocumentContext::StartDeferredPageContentContext(PDFPage* inPage)
+{
+	return new DeferredPageContentContext(this,
+										inPage,
+										mObjectsContext->IsCompressingStreams(),
+										mSharedResourcesLock,
+										mObjectsContext->GetCompressionPolicy().GetParameters(eStreamCategoryPageContent));
+}
+
+static const std::string scFilter = "Filter";
+static const std::string scFlateDecode = "FlateDecode";
+EStatusCodeAndObjectIDType DocumentContext::WriteDeferredPageAndRelease(DeferredPageContentContext* inPageContext)
+{
+	PDFPage* page = inPageContext->GetAssociatedPage();
+	EStatusCodeAndObjectIDType result;
+
+	// compression (if any) already happened on the writing thread, so get the content first, and only then lock for writing
+	std::string content = inPageContext->GetContent();
+
+	if(mSharedResourcesLock)
+		mSharedResourcesLock->Lock();
+
+	do
+	{
+		ObjectIDType streamObjectID = mObjectsContext->StartNewIndirectObject();
+		page->AddContentStreamReference(streamObjectID);
+
+		DictionaryContext* streamDictionary = mObjectsContext->StartDictionary();
+		if(inPageContext->IsContentCompressed())
+		{
+			streamDictionary->WriteKey(scFilter);
+			streamDictionary->WriteNameValue(scFlateDecode);
+		}
+
+		// content is already encoded, so write it as is. encryption, if required, is applied by the PDF stream
+		PDFStream* contentStream = mObjectsContext->StartUnfilteredPDFStream(streamDictionary);
+		LongBufferSizeType writtenBytes = contentStream->GetWriteStream()->Write((const Byte*)content.c_str(),content.size());
+		mObjectsContext->EndPDFStream(contentStream);
+		delete contentStream;
+
+		if(writtenBytes != content.size())
+		{
+			TRACE_LOG2("DocumentContext::WriteDeferredPageAndRelease, failed to write page content. expected to write %ld bytes, wrote %ld",content.size(),writtenBytes);
+			result.first = eFailure;
+			result.second = 0;
+			break;
+		}
+
+		result = WritePage(page);
+	}while(false);
+
+	if(mSharedResourcesLock)
+		mSharedResourcesLock->Unlock();
+
+	delete inPageContext;
+	delete page;
+	return result;
+}
+
+DeferredFormXObjectContentContext* DocumentContext::StartDeferredFormXObjectContentContext(const PDFRectangle& inBoundingBox,const double* inMatrix)
+{
+	return StartDeferredFormXObjectContentContext(inBoundingBox,
+												  mObjectsContext->GetInDirectObjectsRegistry().AllocateNewObjectID(),
+												  inMatrix);
+}
+
+DeferredFormXObjectContentContext* DocumentContext::StartDeferredFormXObjectContentContext(const PDFRectangle& inBoundingBox,ObjectIDType inFormXObjectID,const double* inMatrix)
+{
+	return new DeferredFormXObjectContentContext(this,
+												 inFormXObjectID,
+												 inBoundingBox,
+												 inMatrix,
+												 mObjectsContext->IsCompressingStreams(),
+												 mSharedResourcesLock,
+												 mObjectsContext->GetCompressionPolicy().GetParameters(eStreamCategoryFormXObject));
+}
+
+EStatusCode DocumentContext::WriteDeferredFormXObjectAndRelease(DeferredFormXObjectContentContext* inFormContext)
+{
+	EStatusCode status = eSuccess;
+
+	// compression (if any) already happened on the writing thread, so get the content first, and only then lock for writing
+	std::string content = inFormContext->GetContent();
+
+	if(mSharedResourcesLock)
+		mSharedResourcesLock->Lock();
+
+	do
+	{
+		ObjectIDType formXObjectResourcesDictionaryID;
+		DictionaryContext* xobjectContext = StartFormXObjectDictionary(inFormContext->GetBoundingBox(),
+																		inFormContext->GetObjectID(),
+																		inFormContext->GetMatrix(),
+																		formXObjectResourcesDictionaryID);
+		if(!xobjectContext)
+		{
+			status = eFailure;
+			break;
+		}
+
+		if(inFormContext->IsContentCompressed())
+		{
+			xobjectContext->WriteKey(scFilter);
+			xobjectContext->WriteNameValue(scFlateDecode);
+		}
+
+		// content is already encoded, so write it as is. encryption, if required, is applied by the PDF stream
+		PDFFormXObject* formXObject = new PDFFormXObject(this,
+														 inFormContext->GetObjectID(),
+														 mObjectsContext->StartUnfilteredPDFStream(xobjectContext),
+														 formXObjectResourcesDictionaryID);
+		formXObject->GetResourcesDictionary() = inFormContext->GetFormResourcesDictionary();
+
+		LongBufferSizeType writtenBytes = formXObject->GetContentStream()->GetWriteStream()->Write((const Byte*)content.c_str(),content.size());
+		if(writtenBytes != content.size())
+		{
+			TRACE_LOG2("DocumentContext::WriteDeferredFormXObjectAndRelease, failed to write form content. expected to write %ld bytes, wrote %ld",content.size(),writtenBytes);
+			status = eFailure;
+		}
+
+		// image end tasks were kept with the context till the form existed. hand them over, to be run as the form ends
+		IFormEndWritingTaskList tasks = inFormContext->DetachEndWritingTasks();
+		IFormEndWritingTaskList::iterator it = tasks.begin();
+		for(; it != tasks.end(); ++it)
+			RegisterFormEndWritingTask(formXObject,*it);
+
+		EStatusCode endStatus = EndFormXObjectAndRelease(formXObject);
+		if(eSuccess == status)
+			status = endStatus;
+	}while(false);
+
+	if(mSharedResourcesLock)
+		mSharedResourcesLock->Unlock();
+
+	delete inFormContext;
+	return status;
+}
+
+void DocumentContext::SetSharedResourcesLock(ISharedResourcesLock* inSharedResourcesLock)
+{
+	mSharedResourcesLock = inSharedResourcesLock;
+}
+
 static const std::string scUnknown = "Unknown";
 std::string DocumentContext::GenerateMD5IDForFile()
 {
@@ -938,65 +1103,65 @@ static const std::string scXObject = "XObject";
 static const std::string scSubType = "Subtype";
 static const std::string scForm = "Form";
 static const std::string scFormType = "FormType";
-PDFFormXObject* DocumentContext::StartFormXObject(const PDFRectangle& inBoundingBox,ObjectIDType inFormXObjectID,const double* inMatrix)
+DictionaryContext* DocumentContext::StartFormXObjectDictionary(const PDFRectangle& inBoundingBox,ObjectIDType inFormXObjectID,const double* inMatrix,ObjectIDType& outResourcesDictionaryID)
 {
-	PDFFormXObject* aFormXObject = NULL;
-	do
-	{
-		mObjectsContext->StartNewIndirectObject(inFormXObjectID);
-		DictionaryContext* xobjectContext = mObjectsContext->StartDictionary();
+	mObjectsContext->StartNewIndirectObject(inFormXObjectID);
+	DictionaryContext* xobjectContext = mObjectsContext->StartDictionary();
 
-		// type
-		xobjectContext->WriteKey(scType);
-		xobjectContext->WriteNameValue(scXObject);
+	// type
+	xobjectContext->WriteKey(scType);
+	xobjectContext->WriteNameValue(scXObject);
 
-		// subtype
-		xobjectContext->WriteKey(scSubType);
-		xobjectContext->WriteNameValue(scForm);
+	// subtype
+	xobjectContext->WriteKey(scSubType);
+	xobjectContext->WriteNameValue(scForm);
 
-		// form type
-		xobjectContext->WriteKey(scFormType);
-		xobjectContext->WriteIntegerValue(1);
+	// form type
+	xobjectContext->WriteKey(scFormType);
+	xobjectContext->WriteIntegerValue(1);
 
-		// bbox
-		xobjectContext->WriteKey(scBBox);
-		xobjectContext->WriteRectangleValue(inBoundingBox);
+	// bbox
+	xobjectContext->WriteKey(scBBox);
+	xobjectContext->WriteRectangleValue(inBoundingBox);
 
-		// matrix
-		if(inMatrix && !IsIdentityMatrix(inMatrix))
-		{
-			xobjectContext->WriteKey(scMatrix);
-			mObjectsContext->StartArray();
-			for(int i=0;i<6;++i)
-				mObjectsContext->WriteDouble(inMatrix[i]);
-			mObjectsContext->EndArray(eTokenSeparatorEndLine);
-		}
+	// matrix
+	if(inMatrix && !IsIdentityMatrix(inMatrix))
+	{
+		xobjectContext->WriteKey(scMatrix);
+		mObjectsContext->StartArray();
+		for(int i=0;i<6;++i)
+			mObjectsContext->WriteDouble(inMatrix[i]);
+		mObjectsContext->EndArray(eTokenSeparatorEndLine);
+	}
 
-		// Resource dict 
-		xobjectContext->WriteKey(scResources);	
-		// put a resources dictionary place holder
-		ObjectIDType formXObjectResourcesDictionaryID = mObjectsContext->GetInDirectObjectsRegistry().AllocateNewObjectID();
-		xobjectContext->WriteNewObjectReferenceValue(formXObjectResourcesDictionaryID);
+	// Resource dict 
+	xobjectContext->WriteKey(scResources);	
+	// put a resources dictionary place holder
+	outResourcesDictionaryID = mObjectsContext->GetInDirectObjectsRegistry().AllocateNewObjectID();
+	xobjectContext->WriteNewObjectReferenceValue(outResourcesDictionaryID);
 
-		IDocumentContextExtenderSet::iterator it = mExtenders.begin();
-		EStatusCode status = PDFHummus::eSuccess;
-		for(; it != mExtenders.end() && PDFHummus::eSuccess == status; ++it)
+	IDocumentContextExtenderSet::iterator it = mExtenders.begin();
+	for(; it != mExtenders.end(); ++it)
+	{
+		if((*it)->OnFormXObjectWrite(inFormXObjectID,outResourcesDictionaryID,xobjectContext,mObjectsContext,this) != PDFHummus::eSuccess)
 		{
-			if((*it)->OnFormXObjectWrite(inFormXObjectID,formXObjectResourcesDictionaryID,xobjectContext,mObjectsContext,this) != PDFHummus::eSuccess)
-			{
-				TRACE_LOG("DocumentContext::StartFormXObject, unexpected failure. extender declared failure when writing form xobject.");
-				status = PDFHummus::eFailure;
-				break;
-			}
+			TRACE_LOG("DocumentContext::StartFormXObjectDictionary, unexpected failure. extender declared failure when writing form xobject.");
+			return NULL;
 		}
-		if(status != PDFHummus::eSuccess)
-			break;
+	}
 
-		// Now start the stream and the form XObject state
-		aFormXObject =  new PDFFormXObject(this,inFormXObjectID,mObjectsContext->StartPDFStream(xobjectContext),formXObjectResourcesDictionaryID);
-	} while(false);
+	return xobjectContext;
+}
+
+PDFFormXObject* DocumentContext::StartFormXObject(const PDFRectangle& inBoundingBox,ObjectIDType inFormXObjectID,const double* inMatrix)
+{
+	ObjectIDType formXObjectResourcesDictionaryID;
+	DictionaryContext* xobjectContext = StartFormXObjectDictionary(inBoundingBox,inFormXObjectID,inMatrix,formXObjectResourcesDictionaryID);
+	if(!xobjectContext)
+		return NULL;
 
-	return aFormXObject;	
+	// Now start the stream and the form XObject state
+	return new PDFFormXObject(this,inFormXObjectID,mObjectsContext->StartPDFStream(xobjectContext,false,eStreamCategoryFormXObject),formXObjectResourcesDictionaryID);
 }
 
 
@@ -1318,6 +1483,7 @@ PDFUsedFont* DocumentContext::GetFontForFile(const std::string& inFontFilePath,l
 
 EStatusCode DocumentContext::WriteUsedFontsDefinitions(bool inEmbedFonts)
 {
+	PDFMetricsPhaseScope phaseScope(mObjectsContext->GetMetrics(),ePDFMetricsPhaseFontEmbedding);
 	return mUsedFontsRepository.WriteUsedFontsDefinitions(inEmbedFonts);
 }
 
@@ -1326,6 +1492,21 @@ PDFUsedFont* DocumentContext::GetFontForFile(const std::string& inFontFilePath,c
 	return mUsedFontsRepository.GetFontForFile(inFontFilePath,inAdditionalMeticsFilePath,inFontIndex);
 }
 
+void DocumentContext::SetSharedFontsCache(SharedFontsCache* inSharedFontsCache)
+{
+	mUsedFontsRepository.SetSharedFontsCache(inSharedFontsCache);
+}
+
+void DocumentContext::SetFontSubsettingThreads(unsigned int inFontSubsettingThreads)
+{
+	mUsedFontsRepository.SetFontSubsettingThreads(inFontSubsettingThreads);
+}
+
+void DocumentContext::SetFontProgramsCache(FontProgramsCache* inFontProgramsCache)
+{
+	mUsedFontsRepository.SetFontProgramsCache(inFontProgramsCache);
+}
+
 EStatusCodeAndObjectIDTypeList DocumentContext::CreateFormXObjectsFromPDF(const std::string& inPDFFilePath,
 																			const PDFParsingOptions& inParsingOptions,
 																			const PDFPageRange& inPageRange,
@@ -1950,6 +2131,11 @@ ObjectIDTypeSet& DocumentContext::GetAnnotations()
 	return mAnnotations;
 }
 
+CopiedObjectsRegistry& DocumentContext::GetCopiedObjectsRegistry()
+{
+	return mCopiedObjectsRegistry;
+}
+
 EStatusCode DocumentContext::MergePDFPagesToPage(PDFPage* inPage,
 								const std::string& inPDFFilePath,
 								const PDFParsingOptions& inParsingOptions,
@@ -2048,6 +2234,7 @@ void DocumentContext::Cleanup()
 	mOutputFilePath.clear();
 	mExtenders.clear();
 	mAnnotations.clear();
+	mCopiedObjectsRegistry.Reset();
     PDFDocumentCopyingContextSet::iterator it = mCopyingContexts.begin();
 	for(; it != mCopyingContexts.end(); ++it)
 		(*it)->ReleaseDocumentContextReference();
@@ -2280,7 +2467,7 @@ EStatusCode	DocumentContext::FinalizeModifiedPDF(PDFParser* inModifiedFileParser
 		// write encryption dictionary, if encrypting
 		WriteEncryptionDictionary();
         
-        if(RequiresXrefStream(inModifiedFileParser))
+        if(RequiresXrefStream(inModifiedFileParser) || mObjectsContext->IsWritingObjectStreams())
         {
             status = WriteXrefStream(xrefTablePosition);
         }
@@ -2515,6 +2702,11 @@ EStatusCode DocumentContext::WriteXrefStream(LongFilePositionType& outXrefPositi
     
     do 
     {
+        // write the last object stream, if any, so it is registered in the xref
+        status = mObjectsContext->FlushObjectStream();
+        if(status != eSuccess)
+            break;
+
         // get the position by accessing the free context of the underlying objects stream
  
         // an Xref stream is a beast that is both trailer and the xref
@@ -2683,9 +2875,9 @@ DoubleAndDoublePair DocumentContext::GetImageDimensions(
 				PDFParser pdfParser;
                 
 				InputFile file;
-				if(file.OpenFile(inImageFile) != eSuccess)
+				if(file.OpenFile(inImageFile,inOptions.UseMemoryMapping) != eSuccess)
 					break;
-				if(pdfParser.StartPDFParsing(file.GetInputStream(), inOptions) != eSuccess)
+				if(pdfParser.StartPDFParsing(file.GetInputStream(), inOptions, file.GetInputStreamWindow()) != eSuccess)
 					break;
                 
 				PDFPageInput helper(&pdfParser,pdfParser.ParsePage(inImageIndex));
@@ -2713,7 +2905,7 @@ DoubleAndDoublePair DocumentContext::GetImageDimensions(
 				TIFFImageHandler hummusTiffHandler;
                 
 				InputFile file;
-				if(file.OpenFile(inImageFile) != eSuccess)
+				if(file.OpenFile(inImageFile,inOptions.UseMemoryMapping) != eSuccess)
 				{
 					break;
 				}
@@ -2810,9 +3002,9 @@ unsigned long DocumentContext::GetImagePagesCount(
 			PDFParser pdfParser;
 
 			InputFile file;
-			if (file.OpenFile(inImageFile) != eSuccess)
+			if (file.OpenFile(inImageFile,inOptions.UseMemoryMapping) != eSuccess)
 				break;
-			if (pdfParser.StartPDFParsing(file.GetInputStream(), inOptions) != eSuccess)
+			if (pdfParser.StartPDFParsing(file.GetInputStream(), inOptions, file.GetInputStreamWindow()) != eSuccess)
 				break;
 
 			result = pdfParser.GetPagesCount();
@@ -2828,7 +3020,7 @@ unsigned long DocumentContext::GetImagePagesCount(
 			TIFFImageHandler hummusTiffHandler;
 
 			InputFile file;
-			if (file.OpenFile(inImageFile) != eSuccess)
+			if (file.OpenFile(inImageFile,inOptions.UseMemoryMapping) != eSuccess)
 				break;
 
 			result = hummusTiffHandler.ReadImagePageCount(file.GetInputStream());
@@ -36,6 +36,7 @@
 #include "PDFParsingOptions.h"
 #include "EncryptionOptions.h"
 #include "EncryptionHelper.h"
+#include "CopiedObjectsRegistry.h"
 
 #include <string>
 #include <set>
@@ -55,6 +56,11 @@ class PageTree;
 class OutputFile;
 class IDocumentContextExtender;
 class PageContentContext;
+class DeferredPageContentContext;
+class DeferredFormXObjectContentContext;
+class ISharedResourcesLock;
+class SharedFontsCache;
+class FontProgramsCache;
 class ResourcesDictionary;
 class PDFFormXObject;
 class PDFTiledPattern;
@@ -110,6 +116,7 @@ namespace PDFHummus
 		~DocumentContext();
 
 		void SetObjectsContext(ObjectsContext* inObjectsContext);
+		ObjectsContext* GetObjectsContext();
 		void SetOutputFileInformation(OutputFile* inOutputFile);
 		PDFHummus::EStatusCode	WriteHeader(EPDFVersion inPDFVersion);
 		PDFHummus::EStatusCode	FinalizeNewPDF(bool inEmbedFonts);
@@ -147,6 +154,24 @@ namespace PDFHummus
 		EStatusCodeAndObjectIDType WritePage(PDFPage* inPage);
 		EStatusCodeAndObjectIDType WritePageAndRelease(PDFPage* inPage);
 
+		// Deferred page content (see DeferredPageContentContext.h).
+		// StartDeferredPageContentContext creates a content context for the page that writes to memory, and may be used from another thread.
+		// WriteDeferredPageAndRelease writes the context content as the page content stream, then writes the page, and releases both
+		// the context and the page. Deferred pages should be committed from a single thread, in the desired page order.
+		DeferredPageContentContext* StartDeferredPageContentContext(PDFPage* inPage);
+		EStatusCodeAndObjectIDType WriteDeferredPageAndRelease(DeferredPageContentContext* inPageContext);
+
+		// Deferred form xobjects (see DeferredFormXObjectContentContext.h), the form counterpart of deferred pages.
+		// The form ID is allocated on start, so the form may be placed before it is written. WriteDeferredFormXObjectAndRelease
+		// writes the form, its resources dictionary and its images, and releases the context. Commit from the same thread that commits pages.
+		DeferredFormXObjectContentContext* StartDeferredFormXObjectContentContext(const PDFRectangle& inBoundingBox,const double* inMatrix = NULL);
+		DeferredFormXObjectContentContext* StartDeferredFormXObjectContentContext(const PDFRectangle& inBoundingBox,ObjectIDType inFormXObjectID,const double* inMatrix = NULL);
+		PDFHummus::EStatusCode WriteDeferredFormXObjectAndRelease(DeferredFormXObjectContentContext* inFormContext);
+
+		// set a lock (not owned) to synchronize access to shared resources between deferred contexts written from multiple threads, and the committing thread.
+		// set before starting deferred contexts. pass NULL to stop locking
+		void SetSharedResourcesLock(ISharedResourcesLock* inSharedResourcesLock);
+
 		// Use this to add annotation references to a page. the references will be written on the next page write (see WritePage and WritePageAndRelease)
 		void RegisterAnnotationReferenceForNextPageWrite(ObjectIDType inAnnotationReference);
 
@@ -280,6 +305,12 @@ namespace PDFHummus
 		PDFUsedFont* GetFontForFile(const std::string& inFontFilePath,long inFontIndex);
 		// second overload is for type 1, when an additional metrics file is available
 		PDFUsedFont* GetFontForFile(const std::string& inFontFilePath,const std::string& inAdditionalMeticsFilePath,long inFontIndex);
+		// set a cache (not owned) of font data shared with other documents. set before getting fonts. see SharedFontsCache.h
+		void SetSharedFontsCache(SharedFontsCache* inSharedFontsCache);
+		// threads for creating the embedded fonts subsets at the end of the document. see UsedFontsRepository::SetFontSubsettingThreads
+		void SetFontSubsettingThreads(unsigned int inFontSubsettingThreads);
+		// set a cache (not owned) of embedded font programs shared with other documents. set before getting fonts. see FontProgramsCache.h
+		void SetFontProgramsCache(FontProgramsCache* inFontProgramsCache);
 
 		// URL should be encoded to be a valid URL, ain't gonna be checking that!
 		PDFHummus::EStatusCode AttachURLLinktoCurrentPage(const std::string& inURL,const PDFRectangle& inLinkClickArea);
@@ -347,6 +378,9 @@ namespace PDFHummus
 		// get annotations, for complex scenarios where writing a page can happen outside of document context
 		ObjectIDTypeSet& GetAnnotations();
 
+		// content based deduplication of objects copied from other PDFs, shared by all copying contexts. see CopiedObjectsRegistry.h
+		CopiedObjectsRegistry& GetCopiedObjectsRegistry();
+
 	private:
 		ObjectsContext* mObjectsContext;
 		TrailerInformation mTrailerInformation;
@@ -360,6 +394,7 @@ namespace PDFHummus
 		PDFDocumentHandler mPDFDocumentHandler;
 		UsedFontsRepository mUsedFontsRepository;
 		ObjectIDTypeSet mAnnotations;
+		CopiedObjectsRegistry mCopiedObjectsRegistry;
 		IPDFParserExtender* mParserExtender;
 		PDFDocumentCopyingContextSet mCopyingContexts;
         bool mModifiedDocumentIDExists;
@@ -372,6 +407,7 @@ namespace PDFHummus
 		PDFTiledPatternToITiledPatternEndWritingTaskListMap mTiledPatternEndTasks;
 	    StringAndULongPairToHummusImageInformationMap mImagesInformation;
 		EncryptionHelper mEncryptionHelper;
+		ISharedResourcesLock* mSharedResourcesLock;
 		
 		void WriteHeaderComment(EPDFVersion inPDFVersion);
 		void Write4BinaryBytes();
@@ -392,6 +428,8 @@ namespace PDFHummus
                                                        const std::string& inResourceDictionaryLabel,
                                                        MapIterator<ObjectIDTypeToStringMap> inMapping);
 		bool IsIdentityMatrix(const double* inMatrix);
+		// writes the form xobject object start and dictionary, up to the stream. returns NULL if an extender failed
+		DictionaryContext* StartFormXObjectDictionary(const PDFRectangle& inBoundingBox,ObjectIDType inFormXObjectID,const double* inMatrix,ObjectIDType& outResourcesDictionaryID);
 		PDFHummus::EStatusCode WriteUsedFontsDefinitions(bool inEmbedFonts);
 		EStatusCodeAndObjectIDType WriteAnnotationAndLinkForURL(const std::string& inURL,const PDFRectangle& inLinkClickArea);
 
@@ -0,0 +1,33 @@
+/*
+Source File : EStreamCategory.h
+
+
+Copyright 2013 Gal Kahana PDFWriter
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+#pragma once
+
+// classes of PDF streams, for selecting compression parameters (see FlateCompressionPolicy)
+enum EStreamCategory
+{
+	eStreamCategoryGeneric, // anything not listed below (patterns, function streams, embedded files, etc.)
+	eStreamCategoryPageContent,
+	eStreamCategoryFormXObject,
+	eStreamCategoryFont, // font programs, and font related streams (ToUnicode maps, CIDSets)
+	eStreamCategoryImage, // image data, and image related streams (palettes, ICC profiles)
+	eStreamCategoryXref, // xref streams, and object streams
+
+	eStreamCategoryCount
+};
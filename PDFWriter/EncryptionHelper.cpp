@@ -293,12 +293,19 @@ EStatusCode EncryptionHelper::Setup(const DecryptionHelper& inDecryptionSource)
 		return eSuccess;
 	}
 
+	// new objects are encrypted like the source streams, the strings method is assumed to be the same
+	EXCryptionMethod method = inDecryptionSource.GetStreamsXCryptionMethod();
+	if (eXCryptionMethodNone == method) {
+		SetupNoEncryption();
+		return eSuccess;
+	}
+
 	mIsDocumentEncrypted = false;
 	mSupportsEncryption = false;
 
 	do {
-		mUsingAES = false;
-		mXcryption.Setup(mUsingAES);
+		mUsingAES = (eXCryptionMethodAESV2 == method || eXCryptionMethodAESV3 == method);
+		mXcryption.Setup(method);
 		if (!mXcryption.CanXCrypt())
 			break;
 
@@ -408,6 +415,7 @@ PDFHummus::EStatusCode EncryptionHelper::ReadState(PDFParser* inStateReader, Obj
 	mU = mXcryption.stringToByteList(u->GetValue());
 
 	PDFObjectCastPtr<PDFLiteralString> InitialEncryptionKey = encryptionObjectState->QueryDirectObject("InitialEncryptionKey");
+	mXcryption.Setup(mUsingAES ? (mV >= 5 ? eXCryptionMethodAESV3 : eXCryptionMethodAESV2) : eXCryptionMethodRC4);
 	mXcryption.SetupInitialEncryptionKey(mXcryption.stringToByteList(InitialEncryptionKey->GetValue()));
 
 	return eSuccess;
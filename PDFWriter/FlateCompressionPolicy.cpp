@@ -0,0 +1,53 @@
+/*
+Source File : FlateCompressionPolicy.cpp
+
+
+Copyright 2016 Gal Kahana PDFWriter
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+*/
+#include "FlateCompressionPolicy.h"
+
+const FlateCompressionPolicy FlateCompressionPolicy::DefaultCompressionPolicy;
+const FlateCompressionPolicy FlateCompressionPolicy::FastCompressionPolicy(FlateCompressionParameters(1));
+const FlateCompressionPolicy FlateCompressionPolicy::BestCompressionPolicy(FlateCompressionParameters(9,0,9));
+
+FlateCompressionPolicy::FlateCompressionPolicy()
+{
+}
+
+FlateCompressionPolicy::FlateCompressionPolicy(const FlateCompressionParameters& inParameters)
+{
+	for(int i = 0; i < eStreamCategoryCount; ++i)
+		mParameters[i] = inParameters;
+}
+
+void FlateCompressionPolicy::SetParameters(EStreamCategory inCategory,const FlateCompressionParameters& inParameters)
+{
+	mParameters[inCategory] = inParameters;
+}
+
+const FlateCompressionParameters& FlateCompressionPolicy::GetParameters(EStreamCategory inCategory) const
+{
+	return mParameters[inCategory];
+}
+
+bool FlateCompressionPolicy::operator==(const FlateCompressionPolicy& inOther) const
+{
+	for(int i = 0; i < eStreamCategoryCount; ++i)
+		if(!(mParameters[i] == inOther.mParameters[i]))
+			return false;
+	return true;
+}
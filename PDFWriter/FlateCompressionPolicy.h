@@ -0,0 +1,76 @@
+/*
+Source File : FlateCompressionPolicy.h
+
+
+Copyright 2016 Gal Kahana PDFWriter
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+*/
+#pragma once
+
+/*
+	Flate compression parameters, per stream category. 
+	Values are passed as is to zlib deflateInit2, so they follow zlib definitions:
+	Level - 0 (no compression) to 9 (best compression), or -1 for zlib default (6)
+	Strategy - 0 default, 1 filtered, 2 huffman only, 3 RLE, 4 fixed
+	MemLevel - 1 to 9. 8 is zlib default, 9 is faster and compresses slightly better at the cost of more memory
+
+	Image data written from TIFF files is compressed by libtiff, which only supports setting the level.
+*/
+
+#include "EStreamCategory.h"
+
+struct FlateCompressionParameters
+{
+	int Level;
+	int Strategy;
+	int MemLevel;
+
+	FlateCompressionParameters(int inLevel = -1,int inStrategy = 0,int inMemLevel = 8)
+	{
+		Level = inLevel;
+		Strategy = inStrategy;
+		MemLevel = inMemLevel;
+	}
+
+	bool operator==(const FlateCompressionParameters& inOther) const
+	{
+		return Level == inOther.Level && Strategy == inOther.Strategy && MemLevel == inOther.MemLevel;
+	}
+};
+
+class FlateCompressionPolicy
+{
+public:
+	// all categories with zlib defaults
+	FlateCompressionPolicy();
+	// all categories with the same parameters
+	FlateCompressionPolicy(const FlateCompressionParameters& inParameters);
+
+	void SetParameters(EStreamCategory inCategory,const FlateCompressionParameters& inParameters);
+	const FlateCompressionParameters& GetParameters(EStreamCategory inCategory) const;
+
+	bool operator==(const FlateCompressionPolicy& inOther) const;
+
+	// zlib defaults everywhere
+	static const FlateCompressionPolicy DefaultCompressionPolicy;
+	// level 1, for when output latency matters more than size (e.g. online rendering)
+	static const FlateCompressionPolicy FastCompressionPolicy;
+	// level 9 with maximum memory, for smallest output (e.g. archival batch output)
+	static const FlateCompressionPolicy BestCompressionPolicy;
+
+private:
+	FlateCompressionParameters mParameters[eStreamCategoryCount];
+};
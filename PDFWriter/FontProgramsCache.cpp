@@ -0,0 +1,387 @@
+/*
+   Source File : FontProgramsCache.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "FontProgramsCache.h"
+#include "FreeTypeFaceWrapper.h"
+#include "ObjectsContext.h"
+#include "IObjectsContextExtender.h"
+#include "DictionaryContext.h"
+#include "PDFStream.h"
+#include "MyStringBuf.h"
+#include "InputStringBufferStream.h"
+#include "OutputStringBufferStream.h"
+#include "OutputFlateEncodeStream.h"
+#include "OutputStreamTraits.h"
+#include "InputFile.h"
+#include "OutputFile.h"
+#include "IByteReaderWithPosition.h"
+#include "Trace.h"
+#include "SafeBufferMacrosDefs.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdio.h>
+
+using namespace IOBasicTypes;
+using namespace PDFHummus;
+
+FontProgramsCache::FontProgramsCache(void)
+{
+	mMemoryLimit = FONT_PROGRAMS_CACHE_DEFAULT_MEMORY_LIMIT;
+	mMemoryBytes = 0;
+	mSpillFilesCount = 0;
+}
+
+FontProgramsCache::~FontProgramsCache(void)
+{
+	Purge();
+}
+
+void FontProgramsCache::SetMemoryLimit(LongBufferSizeType inMemoryLimit)
+{
+	mLock.Lock();
+	mMemoryLimit = inMemoryLimit;
+	FitMemoryLimit();
+	mLock.Unlock();
+}
+
+void FontProgramsCache::SetSpillDirectory(const std::string& inSpillDirectory)
+{
+	mLock.Lock();
+	mSpillDirectory = inSpillDirectory;
+	mLock.Unlock();
+}
+
+static void AppendNumber(std::string& ioKey,unsigned long long inNumber)
+{
+	// fixed size binary, so keys don't need separators
+	for(int i = 0; i < 8; ++i)
+		ioKey.push_back((char)((inNumber >> (8*i)) & 0xff));
+}
+
+static void AppendString(std::string& ioKey,const std::string& inString)
+{
+	AppendNumber(ioKey,inString.size());
+	ioKey.append(inString);
+}
+
+FontProgramsCache* FontProgramsCache::GetCacheForFont(FreeTypeFaceWrapper& inFontInfo,ObjectsContext* inObjectsContext)
+{
+	IObjectsContextExtender* extender = inObjectsContext->GetObjectsContextExtender();
+
+	if(inObjectsContext->IsCompressingStreams() && extender && extender->OverridesStreamCompression())
+		return NULL;
+	return inFontInfo.GetFontProgramsCache();
+}
+
+std::string FontProgramsCache::CreateKey(FreeTypeFaceWrapper& inFontInfo,
+										ObjectsContext* inObjectsContext,
+										const std::string& inProgramType,
+										const UIntVector& inSubsetGlyphIDs,
+										const UShortVector* inCIDMapping,
+										const std::string& inSubsetFontName)
+{
+	std::string key;
+	struct stat fileStatus;
+	bool compressed = inObjectsContext->IsCompressingStreams();
+	const FlateCompressionParameters& compressionParameters = inObjectsContext->GetCompressionPolicy().GetParameters(eStreamCategoryFont);
+
+	// file identity. size and modification time, so a replaced file is not taken for the old one
+	AppendString(key,inFontInfo.GetFontFilePath());
+	if(stat(inFontInfo.GetFontFilePath().c_str(),&fileStatus) == 0)
+	{
+		AppendNumber(key,(unsigned long long)fileStatus.st_size);
+		AppendNumber(key,(unsigned long long)fileStatus.st_mtime);
+	}
+	AppendNumber(key,(unsigned long long)inFontInfo.GetFontIndex());
+
+	AppendString(key,inProgramType);
+	AppendString(key,inSubsetFontName);
+
+	AppendNumber(key,compressed ? 1 : 0);
+	if(compressed)
+	{
+		AppendNumber(key,(unsigned long long)(compressionParameters.Level + 1));
+		AppendNumber(key,(unsigned long long)compressionParameters.Strategy);
+		AppendNumber(key,(unsigned long long)compressionParameters.MemLevel);
+	}
+
+	AppendNumber(key,inSubsetGlyphIDs.size());
+	for(UIntVector::const_iterator it = inSubsetGlyphIDs.begin(); it != inSubsetGlyphIDs.end(); ++it)
+		AppendNumber(key,*it);
+
+	AppendNumber(key,inCIDMapping ? inCIDMapping->size() + 1 : 0);
+	if(inCIDMapping)
+	{
+		for(UShortVector::const_iterator it = inCIDMapping->begin(); it != inCIDMapping->end(); ++it)
+			AppendNumber(key,*it);
+	}
+
+	return key;
+}
+
+bool FontProgramsCache::GetFontProgram(const std::string& inKey,CachedFontProgram& outProgram)
+{
+	bool found = false;
+
+	mLock.Lock();
+	StringToFontProgramsCacheEntryMap::iterator it = mPrograms.find(inKey);
+	if(it != mPrograms.end())
+	{
+		FontProgramsCacheEntry* entry = it->second;
+		if(entry->Spilled)
+		{
+			outProgram.NotEmbedded = entry->Program.NotEmbedded;
+			outProgram.Compressed = entry->Program.Compressed;
+			outProgram.DecodedLength = entry->Program.DecodedLength;
+			found = ReadSpilledEntry(entry,outProgram.Data);
+			if(!found)
+				RemoveEntry(it);
+		}
+		else
+		{
+			outProgram = entry->Program;
+			found = true;
+		}
+
+		if(found)
+			mRecentlyUsed.splice(mRecentlyUsed.begin(),mRecentlyUsed,entry->RecentlyUsedPosition);
+	}
+	if(found)
+		++mStatistics.Hits;
+	else
+		++mStatistics.Misses;
+	mLock.Unlock();
+
+	return found;
+}
+
+void FontProgramsCache::AddFontProgram(const std::string& inKey,const CachedFontProgram& inProgram)
+{
+	mLock.Lock();
+	if(mPrograms.find(inKey) == mPrograms.end())
+	{
+		FontProgramsCacheEntry* entry = new FontProgramsCacheEntry();
+
+		entry->Program = inProgram;
+		entry->Spilled = false;
+		entry->DataSize = inProgram.Data.size();
+		entry->RecentlyUsedPosition = mRecentlyUsed.insert(mRecentlyUsed.begin(),inKey);
+		mPrograms.insert(StringToFontProgramsCacheEntryMap::value_type(inKey,entry));
+		mMemoryBytes += entry->DataSize;
+
+		FitMemoryLimit();
+	}
+	mLock.Unlock();
+}
+
+void FontProgramsCache::FitMemoryLimit()
+{
+	// spill (or drop) least recently used programs, till in the limit
+	StringList::iterator it = mRecentlyUsed.end();
+
+	while(mMemoryBytes > mMemoryLimit && it != mRecentlyUsed.begin())
+	{
+		--it;
+		StringToFontProgramsCacheEntryMap::iterator itEntry = mPrograms.find(*it);
+		FontProgramsCacheEntry* entry = itEntry->second;
+
+		if(entry->Spilled || 0 == entry->DataSize)
+			continue;
+
+		if(SpillEntry(entry))
+		{
+			mMemoryBytes -= entry->DataSize;
+		}
+		else
+		{
+			// the entry goes, so continue from the next one
+			StringList::iterator itNext = it;
+			++itNext;
+			RemoveEntry(itEntry);
+			it = itNext;
+		}
+	}
+}
+
+bool FontProgramsCache::SpillEntry(FontProgramsCacheEntry* inEntry)
+{
+	if(mSpillDirectory.empty())
+		return false;
+
+	char fileName[64];
+	SAFE_SPRINTF_1(fileName,64,"/FontProgram%lu.bin",mSpillFilesCount++);
+	std::string filePath = mSpillDirectory + fileName;
+
+	OutputFile spillFile;
+	if(spillFile.OpenFile(filePath) != eSuccess)
+	{
+		TRACE_LOG1("FontProgramsCache::SpillEntry, cannot open spill file at %s",filePath.c_str());
+		return false;
+	}
+	LongBufferSizeType writtenBytes = spillFile.GetOutputStream()->Write((const Byte*)inEntry->Program.Data.c_str(),inEntry->DataSize);
+	spillFile.CloseFile();
+	if(writtenBytes != inEntry->DataSize)
+	{
+		TRACE_LOG1("FontProgramsCache::SpillEntry, failed to write spill file at %s",filePath.c_str());
+		remove(filePath.c_str());
+		return false;
+	}
+
+	inEntry->Spilled = true;
+	inEntry->SpillFilePath = filePath;
+	std::string().swap(inEntry->Program.Data);
+	return true;
+}
+
+bool FontProgramsCache::ReadSpilledEntry(FontProgramsCacheEntry* inEntry,std::string& outData)
+{
+	InputFile spillFile;
+	if(spillFile.OpenFile(inEntry->SpillFilePath) != eSuccess)
+	{
+		TRACE_LOG1("FontProgramsCache::ReadSpilledEntry, cannot open spill file at %s",inEntry->SpillFilePath.c_str());
+		return false;
+	}
+
+	outData.resize(inEntry->DataSize);
+	LongBufferSizeType readBytes = inEntry->DataSize > 0 ? spillFile.GetInputStream()->Read((Byte*)&(outData[0]),inEntry->DataSize) : 0;
+	spillFile.CloseFile();
+	if(readBytes != inEntry->DataSize)
+	{
+		TRACE_LOG1("FontProgramsCache::ReadSpilledEntry, failed to read spill file at %s",inEntry->SpillFilePath.c_str());
+		outData.clear();
+		return false;
+	}
+	return true;
+}
+
+void FontProgramsCache::RemoveEntry(StringToFontProgramsCacheEntryMap::iterator inEntry)
+{
+	FontProgramsCacheEntry* entry = inEntry->second;
+
+	if(entry->Spilled)
+		remove(entry->SpillFilePath.c_str());
+	else
+		mMemoryBytes -= entry->DataSize;
+	mRecentlyUsed.erase(entry->RecentlyUsedPosition);
+	delete entry;
+	mPrograms.erase(inEntry);
+}
+
+void FontProgramsCache::Purge()
+{
+	mLock.Lock();
+	while(!mPrograms.empty())
+		RemoveEntry(mPrograms.begin());
+	mLock.Unlock();
+}
+
+FontProgramsCacheStatistics FontProgramsCache::GetStatistics()
+{
+	FontProgramsCacheStatistics result;
+
+	mLock.Lock();
+	result = mStatistics;
+	result.CachedPrograms = (unsigned long)mPrograms.size();
+	result.MemoryBytes = mMemoryBytes;
+	for(StringToFontProgramsCacheEntryMap::iterator it = mPrograms.begin(); it != mPrograms.end(); ++it)
+	{
+		if(it->second->Spilled)
+			++result.SpilledPrograms;
+	}
+	mLock.Unlock();
+
+	return result;
+}
+
+EStatusCode FontProgramsCache::CreateCachedFontProgram(MyStringBuf& inFontProgram,
+														ObjectsContext* inObjectsContext,
+														CachedFontProgram& outProgram)
+{
+	bool compress = inObjectsContext->IsCompressingStreams();
+	MyStringBuf encodedProgram;
+	OutputStringBufferStream encodedProgramStream(&encodedProgram);
+	OutputFlateEncodeStream flateEncodeStream;
+	IByteWriter* writeStream = &encodedProgramStream;
+	EStatusCode status = eSuccess;
+
+	if(compress)
+	{
+		flateEncodeStream.SetCompressionParameters(inObjectsContext->GetCompressionPolicy().GetParameters(eStreamCategoryFont));
+		flateEncodeStream.Assign(&encodedProgramStream);
+		writeStream = &flateEncodeStream;
+	}
+
+	inFontProgram.pubseekoff(0,std::ios_base::beg);
+	InputStringBufferStream fontProgramStream(&inFontProgram);
+	Byte buffer[4096];
+	LongBufferSizeType decodedLength = 0;
+
+	while(fontProgramStream.NotEnded() && eSuccess == status)
+	{
+		LongBufferSizeType readBytes = fontProgramStream.Read(buffer,4096);
+		if(writeStream->Write(buffer,readBytes) != readBytes)
+		{
+			TRACE_LOG("FontProgramsCache::CreateCachedFontProgram, failed to encode font program");
+			status = eFailure;
+		}
+		decodedLength += readBytes;
+	}
+
+	// finish compression, and let go of the target stream, which the flate stream does not own
+	if(compress)
+		flateEncodeStream.Assign(NULL);
+
+	if(eSuccess == status)
+	{
+		outProgram.NotEmbedded = false;
+		outProgram.Compressed = compress;
+		outProgram.DecodedLength = decodedLength;
+		outProgram.Data = encodedProgramStream.ToString();
+	}
+	return status;
+}
+
+static const std::string scFilter = "Filter";
+static const std::string scFlateDecode = "FlateDecode";
+
+EStatusCode FontProgramsCache::WriteCachedFontProgram(const CachedFontProgram& inProgram,
+														ObjectsContext* inObjectsContext,
+														DictionaryContext* inStreamDictionary)
+{
+	// the data is already encoded, so write it as is. encryption, if any, still happens in the stream
+	if(inProgram.Compressed)
+	{
+		inStreamDictionary->WriteKey(scFilter);
+		inStreamDictionary->WriteNameValue(scFlateDecode);
+	}
+
+	PDFStream* pdfStream = inObjectsContext->StartUnfilteredPDFStream(inStreamDictionary);
+	LongBufferSizeType writtenBytes = inProgram.Data.empty() ? 0 : pdfStream->GetWriteStream()->Write((const Byte*)inProgram.Data.c_str(),inProgram.Data.size());
+	inObjectsContext->EndPDFStream(pdfStream);
+	delete pdfStream;
+
+	if(writtenBytes != inProgram.Data.size())
+	{
+		TRACE_LOG("FontProgramsCache::WriteCachedFontProgram, failed to write font program");
+		return eFailure;
+	}
+	return eSuccess;
+}
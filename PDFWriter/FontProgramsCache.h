@@ -0,0 +1,154 @@
+/*
+   Source File : FontProgramsCache.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "EStatusCode.h"
+#include "IOBasicTypes.h"
+#include "FlateCompressionPolicy.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <list>
+
+#include "ThreadsLock.h"
+
+/*
+	Cache of embedded font programs (font subsets), to share between documents that embed the same fonts with the same glyphs.
+	Create one for the process (or for a group of writers), and set it to each writer with PDFWriter::SetFontProgramsCache, before
+	getting fonts. The cache is not owned by the writers, and should be destroyed only after all writers using it are done. It may be used
+	by writers on different threads.
+
+	Programs are kept as they are written to the document - subsetted and compressed (though not encrypted, which is per document),
+	so embedding a cached program is just copying it to the document stream. A program is identified by the font file (path, size and modification time),
+	face index, the subset glyphs (with their CIDs, for CID fonts) and the subset font name, which is part of CFF programs. Also, programs
+	compressed with different parameters are kept separately.
+
+	Programs are kept in memory up to a memory limit. Beyond it, the least recently used programs are spilled to files in the spill directory, and read
+	back from there when needed. Without a spill directory they are dropped instead. Spill files are deleted when the cache is purged or destroyed.
+*/
+
+#define FONT_PROGRAMS_CACHE_DEFAULT_MEMORY_LIMIT 64*1024*1024
+
+class FreeTypeFaceWrapper;
+class ObjectsContext;
+class DictionaryContext;
+class MyStringBuf;
+
+typedef std::vector<unsigned int> UIntVector;
+typedef std::vector<unsigned short> UShortVector;
+
+struct CachedFontProgram
+{
+	// the font may not be embedded due to its embedding restrictions. in that case there's no data
+	bool NotEmbedded;
+	// whether the data is flate compressed
+	bool Compressed;
+	// length of the program before compression
+	IOBasicTypes::LongBufferSizeType DecodedLength;
+	std::string Data;
+
+	CachedFontProgram(){NotEmbedded = false;Compressed = false;DecodedLength = 0;}
+};
+
+struct FontProgramsCacheStatistics
+{
+	// programs in the cache, and how many of them are spilled to files
+	unsigned long CachedPrograms;
+	unsigned long SpilledPrograms;
+	// size of programs data kept in memory
+	IOBasicTypes::LongBufferSizeType MemoryBytes;
+	// lookups that found a cached program, and ones that did not
+	unsigned long Hits;
+	unsigned long Misses;
+
+	FontProgramsCacheStatistics(){CachedPrograms = 0;SpilledPrograms = 0;MemoryBytes = 0;Hits = 0;Misses = 0;}
+};
+
+struct FontProgramsCacheEntry
+{
+	CachedFontProgram Program;
+	// when spilled, the data is in the spill file, and Program.Data is empty
+	bool Spilled;
+	std::string SpillFilePath;
+	IOBasicTypes::LongBufferSizeType DataSize;
+	std::list<std::string>::iterator RecentlyUsedPosition;
+};
+
+typedef std::map<std::string,FontProgramsCacheEntry*> StringToFontProgramsCacheEntryMap;
+typedef std::list<std::string> StringList;
+
+class FontProgramsCache
+{
+public:
+	FontProgramsCache(void);
+	~FontProgramsCache(void);
+
+	void SetMemoryLimit(IOBasicTypes::LongBufferSizeType inMemoryLimit);
+	// directory for spill files. must exist, and should not be shared with other caches. empty (default) for no spilling
+	void SetSpillDirectory(const std::string& inSpillDirectory);
+
+	// the cache to use for embedding a font in a document, if any. programs are not cached when an objects context extender does the compression
+	static FontProgramsCache* GetCacheForFont(FreeTypeFaceWrapper& inFontInfo,ObjectsContext* inObjectsContext);
+
+	// key for a font program, to use with Get/AddFontProgram. inProgramType distinguishes different program formats of the same font
+	static std::string CreateKey(FreeTypeFaceWrapper& inFontInfo,
+								ObjectsContext* inObjectsContext,
+								const std::string& inProgramType,
+								const UIntVector& inSubsetGlyphIDs,
+								const UShortVector* inCIDMapping,
+								const std::string& inSubsetFontName);
+
+	// get a copy of a cached program. returns false if there isn't one
+	bool GetFontProgram(const std::string& inKey,CachedFontProgram& outProgram);
+	// add a program. if there's already one with this key, it is kept
+	void AddFontProgram(const std::string& inKey,const CachedFontProgram& inProgram);
+
+	// drop all programs
+	void Purge();
+
+	FontProgramsCacheStatistics GetStatistics();
+
+	// helpers for the embedded font writers. create a cached program from a font program, compressed the way the objects context would
+	// compress a font stream, and write a cached program as a stream. the stream dictionary should already have the program specific keys
+	static PDFHummus::EStatusCode CreateCachedFontProgram(MyStringBuf& inFontProgram,
+														ObjectsContext* inObjectsContext,
+														CachedFontProgram& outProgram);
+	static PDFHummus::EStatusCode WriteCachedFontProgram(const CachedFontProgram& inProgram,
+														ObjectsContext* inObjectsContext,
+														DictionaryContext* inStreamDictionary);
+
+private:
+	StringToFontProgramsCacheEntryMap mPrograms;
+	// keys by use, most recent first
+	StringList mRecentlyUsed;
+	IOBasicTypes::LongBufferSizeType mMemoryLimit;
+	IOBasicTypes::LongBufferSizeType mMemoryBytes;
+	std::string mSpillDirectory;
+	unsigned long mSpillFilesCount;
+	FontProgramsCacheStatistics mStatistics;
+	ThreadsLock mLock;
+
+	void FitMemoryLimit();
+	bool SpillEntry(FontProgramsCacheEntry* inEntry);
+	bool ReadSpilledEntry(FontProgramsCacheEntry* inEntry,std::string& outData);
+	void RemoveEntry(StringToFontProgramsCacheEntryMap::iterator inEntry);
+};
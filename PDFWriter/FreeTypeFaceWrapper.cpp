@@ -26,12 +26,18 @@
 #include "BetweenIncluding.h"
 #include "WrittenFontCFF.h"
 #include "WrittenFontTrueType.h"
+#include "SharedFontsCache.h"
 
 #include <math.h>
+#include <algorithm>
 
 #include FT_XFREE86_H 
 #include FT_CID_H 
 #include FT_OUTLINE_H
+#include FT_ADVANCES_H
+
+// glyphs widths are read from the font this many at a time
+#define GLYPHS_WIDTHS_BLOCK_SIZE 128
 
 
 using namespace PDFHummus;
@@ -44,6 +50,11 @@ FreeTypeFaceWrapper::FreeTypeFaceWrapper(FT_Face inFace,const std::string& inFon
     SetupFormatSpecificExtender(inFontFilePath,"");
 	mDoesOwn = inDoOwn;
 	mGlyphIsLoaded = false;
+	mSharedFontsCache = NULL;
+	mParallelFontSubsetter = NULL;
+	mFontProgramsCache = NULL;
+	mSharedFontFile = NULL;
+	mSharedGlyphsWidths = NULL;
 }
 
 FreeTypeFaceWrapper::FreeTypeFaceWrapper(FT_Face inFace,const std::string& inFontFilePath,const std::string& inPFMFilePath,long inFontIndex, bool inDoOwn)
@@ -58,6 +69,11 @@ FreeTypeFaceWrapper::FreeTypeFaceWrapper(FT_Face inFace,const std::string& inFon
 		SetupFormatSpecificExtender(inFontFilePath,"");
 	mDoesOwn = inDoOwn;
 	mGlyphIsLoaded = false;
+	mSharedFontsCache = NULL;
+	mParallelFontSubsetter = NULL;
+	mFontProgramsCache = NULL;
+	mSharedFontFile = NULL;
+	mSharedGlyphsWidths = NULL;
 }
 
 std::string FreeTypeFaceWrapper::NotDefGlyphName()
@@ -99,6 +115,8 @@ FreeTypeFaceWrapper::~FreeTypeFaceWrapper(void)
 	if(mDoesOwn)
 		DoneFace();
 	delete mFormatParticularWrapper;
+	if(mSharedFontFile)
+		mSharedFontsCache->ReleaseFontFile(mSharedFontFile);
 }
 
 static const char* scType1 = "Type 1";
@@ -700,10 +718,102 @@ FT_Pos FreeTypeFaceWrapper::GetInPDFMeasurements(FT_Pos inFontMeasurement)
 
 FT_Pos FreeTypeFaceWrapper::GetGlyphWidth(unsigned int inGlyphIndex)
 {
-	if (LoadGlyph(inGlyphIndex))
+	if(!mFace)
+		return 0;
+
+	unsigned int glyphIndex = GetGlyphIndexInFreeTypeIndexes(inGlyphIndex);
+	if(glyphIndex >= (unsigned int)mFace->num_glyphs)
 		return 0;
+
+	if(mSharedFontFile)
+	{
+		if(!mSharedGlyphsWidths)
+			SetupSharedGlyphsWidths();
+		return (*mSharedGlyphsWidths)[glyphIndex];
+	}
+
+	SetupGlyphsWidthsTable();
+	unsigned int blockIndex = glyphIndex / GLYPHS_WIDTHS_BLOCK_SIZE;
+	if(!mGlyphsWidthsBlocksRead[blockIndex])
+		ReadGlyphsWidthsBlock(blockIndex);
+	return mGlyphsWidths[glyphIndex];
+}
+
+void FreeTypeFaceWrapper::SetupGlyphsWidthsTable()
+{
+	if(mGlyphsWidths.empty())
+	{
+		mGlyphsWidths.resize(mFace->num_glyphs,0);
+		mGlyphsWidthsBlocksRead.resize((mFace->num_glyphs + GLYPHS_WIDTHS_BLOCK_SIZE - 1) / GLYPHS_WIDTHS_BLOCK_SIZE,false);
+	}
+}
+
+void FreeTypeFaceWrapper::SetupSharedGlyphsWidths()
+{
+	mSharedGlyphsWidths = mSharedFontsCache->GetGlyphsWidths(mSharedFontFile,mFontIndex);
+	if(mSharedGlyphsWidths)
+		return;
+
+	// first to use the face, so compute the complete table and share it
+	SetupGlyphsWidthsTable();
+	for(unsigned int i = 0; i < mGlyphsWidthsBlocksRead.size(); ++i)
+		if(!mGlyphsWidthsBlocksRead[i])
+			ReadGlyphsWidthsBlock(i);
+	mSharedGlyphsWidths = mSharedFontsCache->ShareGlyphsWidths(mSharedFontFile,mFontIndex,mGlyphsWidths);
+	FTPosVector().swap(mGlyphsWidths);
+	BoolVector().swap(mGlyphsWidthsBlocksRead);
+}
+
+void FreeTypeFaceWrapper::SetSharedFontFile(SharedFontsCache* inSharedFontsCache,SharedFontFile* inSharedFontFile)
+{
+	mSharedFontsCache = inSharedFontsCache;
+	mSharedFontFile = inSharedFontFile;
+	mSharedGlyphsWidths = NULL;
+}
+
+void FreeTypeFaceWrapper::SetParallelFontSubsetter(ParallelFontSubsetter* inParallelFontSubsetter)
+{
+	mParallelFontSubsetter = inParallelFontSubsetter;
+}
+
+ParallelFontSubsetter* FreeTypeFaceWrapper::GetParallelFontSubsetter()
+{
+	return mParallelFontSubsetter;
+}
+
+void FreeTypeFaceWrapper::SetFontProgramsCache(FontProgramsCache* inFontProgramsCache)
+{
+	mFontProgramsCache = inFontProgramsCache;
+}
+
+FontProgramsCache* FreeTypeFaceWrapper::GetFontProgramsCache()
+{
+	return mFontProgramsCache;
+}
+
+void FreeTypeFaceWrapper::ReadGlyphsWidthsBlock(unsigned int inBlockIndex)
+{
+	FT_UInt start = inBlockIndex * GLYPHS_WIDTHS_BLOCK_SIZE;
+	FT_UInt count = std::min<FT_UInt>(GLYPHS_WIDTHS_BLOCK_SIZE,(FT_UInt)mFace->num_glyphs - start);
+	FT_Fixed advances[GLYPHS_WIDTHS_BLOCK_SIZE];
+	FT_Int32 flags = FT_LOAD_NO_HINTING | FT_LOAD_NO_AUTOHINT | FT_LOAD_NO_SCALE;
+
+	// fast only, as the freetype fallback for formats with no direct access to advances does not return unscaled values.
+	// in that case load the glyphs, which is what measuring a glyph used to do
+	if(FT_Get_Advances(mFace,start,count,flags | FT_ADVANCE_FLAG_FAST_ONLY,advances) == 0)
+	{
+		for(FT_UInt i = 0; i < count; ++i)
+			mGlyphsWidths[start + i] = GetInPDFMeasurements((FT_Pos)advances[i]);
+	}
 	else
-		return GetInPDFMeasurements(mFace->glyph->metrics.horiAdvance);
+	{
+		for(FT_UInt i = 0; i < count; ++i)
+			mGlyphsWidths[start + i] = FT_Load_Glyph(mFace,start + i,flags) == 0 ? GetInPDFMeasurements(mFace->glyph->metrics.horiAdvance) : 0;
+	}
+
+	// the glyph slot may now hold another glyph than the last one loaded by LoadGlyph
+	mGlyphIsLoaded = false;
+	mGlyphsWidthsBlocksRead[inBlockIndex] = true;
 }
 
 unsigned int FreeTypeFaceWrapper::GetGlyphIndexInFreeTypeIndexes(unsigned int inGlyphIndex)
@@ -34,6 +34,10 @@
 class IFreeTypeFaceExtender;
 class IWrittenFont;
 class ObjectsContext;
+class SharedFontsCache;
+class SharedFontFile;
+class ParallelFontSubsetter;
+class FontProgramsCache;
 
 
 
@@ -43,6 +47,8 @@ typedef std::list<UIntList> UIntListList;
 typedef std::list<std::string> StringList;
 typedef std::list<unsigned long> ULongList;
 typedef std::list<ULongList> ULongListList;
+typedef std::vector<FT_Pos> FTPosVector;
+typedef std::vector<bool> BoolVector;
 
 class FreeTypeFaceWrapper
 {
@@ -82,7 +88,19 @@ public:
 	unsigned int GetFontFlags();
 	const char* GetTypeString();
     std::string GetGlyphName(unsigned int inGlyphIndex);
+    // glyph advance, aligned to pdf metrics. served from a per face table of advances, which is filled
+    // a block of glyphs at a time from the font metrics (hmtx, or the format equivalent), so calls are cheap
     FT_Pos GetGlyphWidth(unsigned int inGlyphIndex);
+
+	// when the face is opened from a file mapped by a shared fonts cache, set the file here. the wrapper then takes over
+	// the file reference (releasing it when destroyed, after the face is done), and uses the widths table shared for the face
+	void SetSharedFontFile(SharedFontsCache* inSharedFontsCache,SharedFontFile* inSharedFontFile);
+	// font programs created ahead of writing the font, for the embedded font writers to use. not owned. see ParallelFontSubsetter.h
+	void SetParallelFontSubsetter(ParallelFontSubsetter* inParallelFontSubsetter);
+	ParallelFontSubsetter* GetParallelFontSubsetter();
+	// finished font programs shared with other documents, for the embedded font writers to use. not owned. see FontProgramsCache.h
+	void SetFontProgramsCache(FontProgramsCache* inFontProgramsCache);
+	FontProgramsCache* GetFontProgramsCache();
 	bool GetGlyphOutline(unsigned int inGlyphIndex, IOutlineEnumerator& inEnumerator);
 
 	// Create the written font object, matching to write this font in the best way.
@@ -130,6 +148,14 @@ private:
 	bool mGlyphIsLoaded;
 	unsigned int mCurrentGlyph;
 	bool mDoesOwn;
+	// glyph widths by freetype glyph index, and which blocks of them were already read
+	FTPosVector mGlyphsWidths;
+	BoolVector mGlyphsWidthsBlocksRead;
+	SharedFontsCache* mSharedFontsCache;
+	SharedFontFile* mSharedFontFile;
+	const FTPosVector* mSharedGlyphsWidths;
+	ParallelFontSubsetter* mParallelFontSubsetter;
+	FontProgramsCache* mFontProgramsCache;
 
 	BoolAndFTShort GetCapHeightInternal(); 
 	BoolAndFTShort GetxHeightInternal(); 
@@ -146,6 +172,9 @@ private:
 	bool IsSymbolic();
 	bool IsDefiningCharsNotInAdobeStandardLatin();
 	std::string NotDefGlyphName();
+	void ReadGlyphsWidthsBlock(unsigned int inBlockIndex);
+	void SetupGlyphsWidthsTable();
+	void SetupSharedGlyphsWidths();
 
 public:
 	class IOutlineEnumerator {
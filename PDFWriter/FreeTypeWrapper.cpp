@@ -98,6 +98,20 @@ FT_Face FreeTypeWrapper::NewFace(const std::string& inFilePath,FT_Long inFontInd
 	return face;
 }
 
+FT_Face FreeTypeWrapper::NewFace(const FT_Byte* inFontData,FT_Long inFontDataSize,FT_Long inFontIndex)
+{
+	FT_Face face;
+
+	FT_Error ftStatus = FT_New_Memory_Face(mFreeType,inFontData,inFontDataSize,inFontIndex,&face);
+	if(ftStatus)
+	{
+		TRACE_LOG1("FreeTypeWrapper::NewFace, unable to load font from memory with index %ld",inFontIndex);
+		TRACE_LOG2("FreeTypeWrapper::NewFace, Free Type Error, Code = %d, Message = %s",ft_errors[ftStatus].err_code,ft_errors[ftStatus].err_msg);
+		face = NULL;
+	}
+	return face;
+}
+
 EStatusCode FreeTypeWrapper::FillOpenFaceArgumentsForUTF8String(const std::string& inFilePath, FT_Open_Args& ioArgs)
 {
 	ioArgs.flags = FT_OPEN_STREAM;
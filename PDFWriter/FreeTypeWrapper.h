@@ -42,6 +42,8 @@ public:
 
 	FT_Face NewFace(const std::string& inFilePath,FT_Long inFontIndex);
 	FT_Face NewFace(const std::string& inFilePath,const std::string& inSecondaryFilePath,FT_Long inFontIndex);
+	// face from font data in memory. the data is not copied, so it has to stay available for as long as the face is used
+	FT_Face NewFace(const FT_Byte* inFontData,FT_Long inFontDataSize,FT_Long inFontIndex);
 	FT_Error DoneFace(FT_Face ioFace);
 
 	FT_Library operator->();
@@ -0,0 +1,47 @@
+/*
+   Source File : IReadWindowProvider.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "IOBasicTypes.h"
+
+/*
+	IReadWindowProvider. optional companion interface for input streams that hold their content
+	(or a part of it) in a contiguous memory block. readers that scan a lot of small pieces (like the tokenizer)
+	can use it to go over memory directly, instead of reading byte by byte through the stream.
+*/
+class IReadWindowProvider
+{
+public:
+
+	virtual ~IReadWindowProvider(){}
+
+	/*
+		Get the contiguous block of bytes available for reading from the current read position, filling
+		internal buffers if required. the stream position is not moved.
+		outWindowSize is set to 0 when the stream ended. the window is valid till the next call to any method of the stream.
+	*/
+	virtual const IOBasicTypes::Byte* GetReadWindow(IOBasicTypes::LongBufferSizeType& outWindowSize) = 0;
+
+	/*
+		Move the read position forward by inSize bytes of the recently provided window (inSize should not be larger than the window size)
+	*/
+	virtual void ConsumeReadWindow(IOBasicTypes::LongBufferSizeType inSize) = 0;
+};
@@ -0,0 +1,38 @@
+/*
+ Source File : ISharedResourcesLock.h
+ 
+ 
+ Copyright 2012 Gal Kahana PDFWriter
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ 
+ */
+#pragma once
+
+/*
+	Lock interface for generating content from multiple threads. The library does not carry a threading implementation of its own,
+	so when writing deferred page content from worker threads, implement this interface with the platform mutex of your choice
+	and pass it to PDFWriter::SetSharedResourcesLock. 
+	The lock is taken by deferred content contexts whenever they access document level resources (used fonts, image registry), and by
+	the document when committing deferred pages. it is never taken recursively.
+*/
+
+class ISharedResourcesLock
+{
+public:
+	virtual ~ISharedResourcesLock(){}
+
+	virtual void Lock() = 0;
+	virtual void Unlock() = 0;
+};
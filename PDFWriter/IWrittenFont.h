@@ -36,6 +36,8 @@ typedef std::list<GlyphUnicodeMappingList> GlyphUnicodeMappingListList;
 class FreeTypeFaceWrapper;
 class ObjectsContext;
 class PDFParser;
+class UppercaseSequance;
+class ParallelFontSubsetter;
 
 class IWrittenFont
 {
@@ -63,6 +65,13 @@ public:
 	*/
 	virtual PDFHummus::EStatusCode WriteFontDefinition(FreeTypeFaceWrapper& inFontInfo,bool inEmbedFont) = 0;
 
+	/*
+		Add the font subsets that WriteFontDefinition is going to create to ioSubsetter, so they can be created ahead of it,
+		in parallel with other fonts. ioSubsetFontsNames should advance the same way that the subset fonts prefixes are
+		generated by WriteFontDefinition, so that the subset names match.
+	*/
+	virtual void AddFontSubsets(FreeTypeFaceWrapper& inFontInfo,bool inEmbedFont,UppercaseSequance& ioSubsetFontsNames,ParallelFontSubsetter* ioSubsetter) = 0;
+
 	// state read and write
 	virtual PDFHummus::EStatusCode WriteState(ObjectsContext* inStateWriter,ObjectIDType inObjectID) = 0;
 	virtual PDFHummus::EStatusCode ReadState(PDFParser* inStateReader,ObjectIDType inObjectID) = 0;
@@ -48,6 +48,8 @@ void IndirectObjectsReferenceRegistry::SetupInitialFreeObject()
     singleFreeObjectInformation.mIsDirty = true;
     singleFreeObjectInformation.mGenerationNumber = 65535;
     singleFreeObjectInformation.mWritePosition = 0;
+    singleFreeObjectInformation.mObjectStreamID = 0;
+    singleFreeObjectInformation.mObjectStreamIndex = 0;
 	mObjectsWritesRegistry.push_back(singleFreeObjectInformation);
 }
 
@@ -65,6 +67,8 @@ ObjectIDType IndirectObjectsReferenceRegistry::AllocateNewObjectID()
 	newObjectInformation.mObjectReferenceType = ObjectWriteInformation::Used;
     newObjectInformation.mGenerationNumber = 0;
     newObjectInformation.mIsDirty = true;
+    newObjectInformation.mObjectStreamID = 0;
+    newObjectInformation.mObjectStreamIndex = 0;
 	
 	mObjectsWritesRegistry.push_back(newObjectInformation);
 	return newObjectID;
@@ -95,6 +99,30 @@ EStatusCode IndirectObjectsReferenceRegistry::MarkObjectAsWritten(ObjectIDType i
     mObjectsWritesRegistry[inObjectID].mIsDirty = true;
 	mObjectsWritesRegistry[inObjectID].mWritePosition = inWritePosition;
 	mObjectsWritesRegistry[inObjectID].mObjectWritten = true;
+	mObjectsWritesRegistry[inObjectID].mObjectStreamID = 0;
+	mObjectsWritesRegistry[inObjectID].mObjectStreamIndex = 0;
+	return PDFHummus::eSuccess;
+}
+
+EStatusCode IndirectObjectsReferenceRegistry::MarkObjectAsWrittenInObjectStream(ObjectIDType inObjectID,ObjectIDType inObjectStreamID,unsigned long inObjectStreamIndex)
+{
+	if(mObjectsWritesRegistry.size() <= inObjectID)
+	{
+		TRACE_LOG1("IndirectObjectsReferenceRegistry::MarkObjectAsWrittenInObjectStream, Out of range failure. An Object ID is marked as written, which was not allocated before. ID = %ld",inObjectID);
+		return PDFHummus::eFailure; 
+	}
+
+	if(mObjectsWritesRegistry[inObjectID].mObjectWritten)
+	{
+		TRACE_LOG1("IndirectObjectsReferenceRegistry::MarkObjectAsWrittenInObjectStream, Object rewrite failure. The object %ld was already marked as written",inObjectID);
+		return PDFHummus::eFailure;
+	}
+
+    mObjectsWritesRegistry[inObjectID].mIsDirty = true;
+	mObjectsWritesRegistry[inObjectID].mWritePosition = 0;
+	mObjectsWritesRegistry[inObjectID].mObjectWritten = true;
+	mObjectsWritesRegistry[inObjectID].mObjectStreamID = inObjectStreamID;
+	mObjectsWritesRegistry[inObjectID].mObjectStreamIndex = inObjectStreamIndex;
 	return PDFHummus::eSuccess;
 }
 
@@ -165,6 +193,25 @@ PDFHummus::EStatusCode IndirectObjectsReferenceRegistry::MarkObjectAsUpdated(Obj
     mObjectsWritesRegistry[inObjectID].mIsDirty = true;
     mObjectsWritesRegistry[inObjectID].mWritePosition = inNewWritePosition;
     mObjectsWritesRegistry[inObjectID].mObjectReferenceType = ObjectWriteInformation::Used;
+    mObjectsWritesRegistry[inObjectID].mObjectStreamID = 0;
+    mObjectsWritesRegistry[inObjectID].mObjectStreamIndex = 0;
+
+    return PDFHummus::eSuccess;
+}
+
+EStatusCode IndirectObjectsReferenceRegistry::MarkObjectAsUpdatedInObjectStream(ObjectIDType inObjectID,ObjectIDType inObjectStreamID,unsigned long inObjectStreamIndex)
+{
+ 	if(mObjectsWritesRegistry.size() <= inObjectID)
+	{
+		TRACE_LOG1("IndirectObjectsReferenceRegistry::MarkObjectAsUpdatedInObjectStream, Out of range failure. An Object ID is marked for update,but there's no such object. ID = %ld",inObjectID);
+		return PDFHummus::eFailure; 
+	}
+
+    mObjectsWritesRegistry[inObjectID].mIsDirty = true;
+    mObjectsWritesRegistry[inObjectID].mWritePosition = 0;
+    mObjectsWritesRegistry[inObjectID].mObjectReferenceType = ObjectWriteInformation::Used;
+    mObjectsWritesRegistry[inObjectID].mObjectStreamID = inObjectStreamID;
+    mObjectsWritesRegistry[inObjectID].mObjectStreamIndex = inObjectStreamIndex;
 
     return PDFHummus::eSuccess;
 }
@@ -229,6 +276,15 @@ EStatusCode IndirectObjectsReferenceRegistry::WriteState(ObjectsContext* inState
         
 		registryDictionary->WriteKey("mGenerationNumber");
 		registryDictionary->WriteIntegerValue(it->mGenerationNumber);
+
+		if(it->mObjectStreamID != 0)
+		{
+			registryDictionary->WriteKey("mObjectStreamID");
+			registryDictionary->WriteIntegerValue(it->mObjectStreamID);
+
+			registryDictionary->WriteKey("mObjectStreamIndex");
+			registryDictionary->WriteIntegerValue(it->mObjectStreamIndex);
+		}
         
         
 		inStateWriter->EndDictionary(registryDictionary);
@@ -272,6 +328,11 @@ EStatusCode IndirectObjectsReferenceRegistry::ReadState(PDFParser* inStateReader
         PDFObjectCastPtr<PDFInteger> generationNumber(objectWriteInformationDictionary->QueryDirectObject("mGenerationNumber"));
         newObjectInformation.mGenerationNumber = (unsigned long)generationNumber->GetValue();
 
+		PDFObjectCastPtr<PDFInteger> objectStreamID(objectWriteInformationDictionary->QueryDirectObject("mObjectStreamID"));
+		PDFObjectCastPtr<PDFInteger> objectStreamIndex(objectWriteInformationDictionary->QueryDirectObject("mObjectStreamIndex"));
+		newObjectInformation.mObjectStreamID = objectStreamID.GetPtr() ? (ObjectIDType)objectStreamID->GetValue() : 0;
+		newObjectInformation.mObjectStreamIndex = objectStreamIndex.GetPtr() ? (unsigned long)objectStreamIndex->GetValue() : 0;
+
 		mObjectsWritesRegistry.push_back(newObjectInformation);
 	}
 
@@ -298,6 +359,8 @@ void IndirectObjectsReferenceRegistry::AppendExistingItem(
     newObjectInformation.mGenerationNumber = inGenerationNumber;
     newObjectInformation.mIsDirty = false;
     newObjectInformation.mWritePosition = (inObjectReferenceType == ObjectWriteInformation::Used) ? inWritePosition:0;
+    newObjectInformation.mObjectStreamID = 0;
+    newObjectInformation.mObjectStreamIndex = 0;
 	
 	mObjectsWritesRegistry.push_back(newObjectInformation);
     
@@ -56,6 +56,9 @@ struct ObjectWriteInformation
 	EObjectReferenceType mObjectReferenceType;
     // object generation number
     unsigned long mGenerationNumber;
+    // for objects written into an object stream - the object stream ID and the object index in it. 0 object stream ID for objects written directly
+    ObjectIDType mObjectStreamID;
+    unsigned long mObjectStreamIndex;
 };
 
 typedef std::pair<bool,ObjectWriteInformation> GetObjectWriteInformationResult;
@@ -70,6 +73,8 @@ public:
 	ObjectIDType AllocateNewObjectID();
 	
 	PDFHummus::EStatusCode MarkObjectAsWritten(ObjectIDType inObjectID,LongFilePositionType inWritePosition);
+	// mark object as written, as the nth object of an object stream (where object stream is itself an indirect object)
+	PDFHummus::EStatusCode MarkObjectAsWrittenInObjectStream(ObjectIDType inObjectID,ObjectIDType inObjectStreamID,unsigned long inObjectStreamIndex);
 	GetObjectWriteInformationResult GetObjectWriteInformation(ObjectIDType inObjectID) const;
 
 	ObjectIDType GetObjectsCount() const;
@@ -80,6 +85,7 @@ public:
     // modified PDF methods
     PDFHummus::EStatusCode DeleteObject(ObjectIDType inObjectID);
 	PDFHummus::EStatusCode MarkObjectAsUpdated(ObjectIDType inObjectID,LongFilePositionType inNewWritePosition);
+	PDFHummus::EStatusCode MarkObjectAsUpdatedInObjectStream(ObjectIDType inObjectID,ObjectIDType inObjectStreamID,unsigned long inObjectStreamIndex);
     
     
     
@@ -0,0 +1,169 @@
+/*
+	Source File : InputAESDecodeStream.cpp
+
+
+	Copyright 2016 Gal Kahana PDFWriter
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+#include "InputAESDecodeStream.h"
+#include "Trace.h"
+
+#include <string.h>
+
+using namespace IOBasicTypes;
+
+InputAESDecodeStream::InputAESDecodeStream(void)
+{
+	mSourceStream = NULL;
+	mReadIV = false;
+	mInSize = 0;
+	mOutIndex = mOutEnd = mOut;
+}
+
+InputAESDecodeStream::~InputAESDecodeStream(void)
+{
+	if(mSourceStream)
+		delete mSourceStream;
+}
+
+InputAESDecodeStream::InputAESDecodeStream(IByteReader* inSourceReader,const ByteList& inKey)
+{
+	mSourceStream = NULL;
+	Assign(inSourceReader,inKey);
+}
+
+void InputAESDecodeStream::Assign(IByteReader* inSourceReader,const ByteList& inKey)
+{
+	mSourceStream = inSourceReader;
+	mReadIV = false;
+	mInSize = 0;
+	mOutIndex = mOutEnd = mOut;
+
+	if(inKey.size() > 0)
+	{
+		unsigned char key[32];
+		size_t keyLength = 0;
+		ByteList::const_iterator it = inKey.begin();
+		for(; it != inKey.end() && keyLength < sizeof(key); ++it,++keyLength)
+			key[keyLength] = *it;
+		mDecrypt.key(key,(int)keyLength);
+	}
+}
+
+LongBufferSizeType InputAESDecodeStream::Read(Byte* inBuffer,LongBufferSizeType inBufferSize)
+{
+	LongBufferSizeType readBytes = 0;
+
+	while(readBytes < inBufferSize)
+	{
+		if(mOutIndex == mOutEnd && !DecryptNextChunk())
+			break;
+
+		LongBufferSizeType copyAmount = (LongBufferSizeType)(mOutEnd - mOutIndex);
+		if(copyAmount > inBufferSize - readBytes)
+			copyAmount = inBufferSize - readBytes;
+		memcpy(inBuffer + readBytes,mOutIndex,copyAmount);
+		mOutIndex += copyAmount;
+		readBytes += copyAmount;
+	}
+	return readBytes;
+}
+
+bool InputAESDecodeStream::NotEnded()
+{
+	if(mOutIndex < mOutEnd)
+		return true;
+	if(!mSourceStream)
+		return false;
+	return mSourceStream->NotEnded() || mInSize >= AES_BLOCK_SIZE;
+}
+
+bool InputAESDecodeStream::ReadIV()
+{
+	LongBufferSizeType ivSize = 0;
+
+	while(ivSize < AES_BLOCK_SIZE && mSourceStream->NotEnded())
+	{
+		LongBufferSizeType readAmount = mSourceStream->Read(mIV + ivSize,AES_BLOCK_SIZE - ivSize);
+		if(0 == readAmount)
+			break;
+		ivSize += readAmount;
+	}
+	mReadIV = true;
+
+	if(ivSize < AES_BLOCK_SIZE)
+	{
+		TRACE_LOG("InputAESDecodeStream::ReadIV, input is too short to contain the initialization vector");
+		return false;
+	}
+	return true;
+}
+
+bool InputAESDecodeStream::DecryptNextChunk()
+{
+	if(!mSourceStream)
+		return false;
+
+	if(!mReadIV && !ReadIV())
+		return false;
+
+	while(true)
+	{
+		// fill the input buffer as much as possible
+		bool sourceEnded = !mSourceStream->NotEnded();
+		while(!sourceEnded && mInSize < AES_DECODE_BUFFER_SIZE)
+		{
+			LongBufferSizeType readAmount = mSourceStream->Read(mIn + mInSize,AES_DECODE_BUFFER_SIZE - mInSize);
+			mInSize += readAmount;
+			sourceEnded = (0 == readAmount) || !mSourceStream->NotEnded();
+		}
+
+		// decrypt whole blocks. till the source ends, hold back the last block, as it may be the padded one
+		LongBufferSizeType blocksSize = (mInSize / AES_BLOCK_SIZE) * AES_BLOCK_SIZE;
+		if(!sourceEnded)
+			blocksSize = blocksSize > AES_BLOCK_SIZE ? blocksSize - AES_BLOCK_SIZE : 0;
+
+		if(0 == blocksSize)
+		{
+			if(mInSize > 0)
+				TRACE_LOG1("InputAESDecodeStream::DecryptNextChunk, input ends with a partial block of %ld bytes, ignoring",(long)mInSize);
+			mInSize = 0;
+			return false;
+		}
+
+		mDecrypt.cbc_decrypt(mIn,mOut,(int)blocksSize,mIV);
+		mOutIndex = mOut;
+		mOutEnd = mOut + blocksSize;
+		memmove(mIn,mIn + blocksSize,mInSize - blocksSize);
+		mInSize -= blocksSize;
+
+		if(sourceEnded && mInSize < AES_BLOCK_SIZE)
+		{
+			// that was the last block. remove padding
+			Byte padding = mOutEnd[-1];
+			if(padding >= 1 && padding <= AES_BLOCK_SIZE)
+				mOutEnd -= padding;
+			else
+				TRACE_LOG1("InputAESDecodeStream::DecryptNextChunk, invalid padding value %d, keeping last block as is",padding);
+			if(mInSize > 0)
+				TRACE_LOG1("InputAESDecodeStream::DecryptNextChunk, input ends with a partial block of %ld bytes, ignoring",(long)mInSize);
+			mInSize = 0;
+		}
+
+		if(mOutEnd > mOutIndex)
+			return true;
+		if(sourceEnded && 0 == mInSize)
+			return false;
+	}
+}
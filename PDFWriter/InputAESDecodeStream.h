@@ -0,0 +1,72 @@
+/*
+	Source File : InputAESDecodeStream.h
+
+
+	Copyright 2016 Gal Kahana PDFWriter
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+#pragma once
+
+#include "EStatusCode.h"
+#include "IByteReader.h"
+#include "aescpp.h"
+
+#include <list>
+
+typedef std::list<IOBasicTypes::Byte> ByteList;
+
+// encrypted data is read and decrypted in chunks of this size
+#define AES_DECODE_BUFFER_SIZE (4*1024)
+
+/*
+	AES CBC decryption of PDF streams and strings (AESV2 and AESV3 crypt filters).
+	The first block of the input is the IV, and the last block is padded per PKCS#5. The padding is removed.
+	The key is 16 bytes for AESV2 and 32 bytes for AESV3.
+*/
+class InputAESDecodeStream : public IByteReader
+{
+public:
+	InputAESDecodeStream(void);
+	~InputAESDecodeStream(void);
+
+	// Note that assigning passes ownership on the stream, use Assign(NULL) to remove ownership
+	InputAESDecodeStream(IByteReader* inSourceReader,const ByteList& inKey);
+
+	// Assigning passes ownership of the input stream to the decoder stream. 
+	// if you don't care for that, then after finishing with the decode, Assign(NULL).
+	void Assign(IByteReader* inSourceReader, const ByteList& inKey=ByteList());
+
+	// IByteReader implementation
+	virtual IOBasicTypes::LongBufferSizeType Read(IOBasicTypes::Byte* inBuffer, IOBasicTypes::LongBufferSizeType inBufferSize);
+
+	virtual bool NotEnded();
+
+private:
+	IByteReader *mSourceStream;
+	AESdecrypt mDecrypt;
+	unsigned char mIV[AES_BLOCK_SIZE];
+	bool mReadIV;
+
+	// encrypted data not yet decrypted. the last full block is held back till the source ends, as it may contain the padding
+	unsigned char mIn[AES_DECODE_BUFFER_SIZE];
+	IOBasicTypes::LongBufferSizeType mInSize;
+
+	// decrypted data not yet read
+	unsigned char mOut[AES_DECODE_BUFFER_SIZE];
+	unsigned char* mOutIndex;
+	unsigned char* mOutEnd;
+
+	bool DecryptNextChunk();
+	bool ReadIV();
+};
@@ -159,4 +159,20 @@ LongFilePositionType InputBufferedStream::GetCurrentPosition()
 	// when reading the current position is the current stream position minus how much is left
 	// to read from the buffer
 	return mSourceStream->GetCurrentPosition() - (mLastAvailableIndex - mCurrentBufferIndex);
-}
\ No newline at end of file
+}
+const Byte* InputBufferedStream::GetReadWindow(LongBufferSizeType& outWindowSize)
+{
+	if(mCurrentBufferIndex == mLastAvailableIndex && mSourceStream && mSourceStream->NotEnded())
+	{
+		mLastAvailableIndex = mBuffer + mSourceStream->Read(mBuffer,mBufferSize);
+		mCurrentBufferIndex = mBuffer;
+	}
+
+	outWindowSize = (LongBufferSizeType)(mLastAvailableIndex - mCurrentBufferIndex);
+	return mCurrentBufferIndex;
+}
+
+void InputBufferedStream::ConsumeReadWindow(LongBufferSizeType inSize)
+{
+	mCurrentBufferIndex+=inSize;
+}
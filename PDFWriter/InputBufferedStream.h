@@ -22,10 +22,11 @@
 
 #include "EStatusCode.h"
 #include "IByteReaderWithPosition.h"
+#include "IReadWindowProvider.h"
 
 #define DEFAULT_BUFFER_SIZE 256*1024
 
-class InputBufferedStream : public IByteReaderWithPosition
+class InputBufferedStream : public IByteReaderWithPosition, public IReadWindowProvider
 {
 public:
 	/*
@@ -63,6 +64,10 @@ public:
 	virtual void SetPositionFromEnd(LongFilePositionType inOffsetFromEnd);
 	virtual LongFilePositionType GetCurrentPosition();
 
+	// IReadWindowProvider implementation. the window is what's left to read in the buffer, refilled when exhausted
+	virtual const Byte* GetReadWindow(LongBufferSizeType& outWindowSize);
+	virtual void ConsumeReadWindow(LongBufferSizeType inSize);
+
 	IByteReaderWithPosition* GetSourceStream();
 
 private:
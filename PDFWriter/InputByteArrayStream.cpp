@@ -85,3 +85,20 @@ LongFilePositionType InputByteArrayStream::GetCurrentPosition()
 {
 	return mCurrentPosition;
 }
+
+const Byte* InputByteArrayStream::GetReadWindow(LongBufferSizeType& outWindowSize)
+{
+	if(!mByteArray)
+	{
+		outWindowSize = 0;
+		return NULL;
+	}
+
+	outWindowSize = (LongBufferSizeType)(mArrayLength-mCurrentPosition);
+	return mByteArray+mCurrentPosition;
+}
+
+void InputByteArrayStream::ConsumeReadWindow(LongBufferSizeType inSize)
+{
+	Skip(inSize);
+}
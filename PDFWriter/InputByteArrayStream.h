@@ -21,8 +21,9 @@
 #pragma once
 
 #include "IByteReaderWithPosition.h"
+#include "IReadWindowProvider.h"
 
-class InputByteArrayStream : public IByteReaderWithPosition
+class InputByteArrayStream : public IByteReaderWithPosition, public IReadWindowProvider
 {
 public:
 	InputByteArrayStream();
@@ -39,6 +40,10 @@ public:
 	virtual void SetPositionFromEnd(LongFilePositionType inOffsetFromEnd);
 	virtual LongFilePositionType GetCurrentPosition();
 
+	// IReadWindowProvider implementation
+	virtual const IOBasicTypes::Byte* GetReadWindow(IOBasicTypes::LongBufferSizeType& outWindowSize);
+	virtual void ConsumeReadWindow(IOBasicTypes::LongBufferSizeType inSize);
+
 private:
 
 	IOBasicTypes::Byte* mByteArray;
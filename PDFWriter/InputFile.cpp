@@ -21,6 +21,7 @@
 #include "InputFile.h"
 #include "InputBufferedStream.h"
 #include "InputFileStream.h"
+#include "InputMemoryMappedFileStream.h"
 #include "Trace.h"
 
 using namespace PDFHummus;
@@ -29,6 +30,7 @@ InputFile::InputFile(void)
 {
 	mInputStream = NULL;
 	mFileStream = NULL;
+	mMappedFileStream = NULL;
 }
 
 InputFile::~InputFile(void)
@@ -36,7 +38,7 @@ InputFile::~InputFile(void)
 	CloseFile();
 }
 
-EStatusCode InputFile::OpenFile(const std::string& inFilePath)
+EStatusCode InputFile::OpenFile(const std::string& inFilePath,bool inUseMemoryMapping)
 {
 	EStatusCode status;
 	do
@@ -47,6 +49,19 @@ EStatusCode InputFile::OpenFile(const std::string& inFilePath)
 			TRACE_LOG1("InputFile::OpenFile, Unexpected Failure. Couldn't close previously open file - %s",mFilePath.c_str());
 			break;
 		}
+
+		if(inUseMemoryMapping)
+		{
+			InputMemoryMappedFileStream* mappedFileStream = new InputMemoryMappedFileStream();
+			if(mappedFileStream->Open(inFilePath) == PDFHummus::eSuccess)
+			{
+				mMappedFileStream = mappedFileStream;
+				mFilePath = inFilePath;
+				break;
+			}
+			TRACE_LOG1("InputFile::OpenFile, Unable to map file to memory, falling back on regular reading - %s",inFilePath.c_str());
+			delete mappedFileStream;
+		}
 	
 		InputFileStream* inputFileStream = new InputFileStream();
 		status = inputFileStream->Open(inFilePath); // explicitly open, so status may be retrieved
@@ -66,7 +81,15 @@ EStatusCode InputFile::OpenFile(const std::string& inFilePath)
 
 EStatusCode InputFile::CloseFile()
 {
-	if(NULL == mInputStream)
+	if(mMappedFileStream)
+	{
+		EStatusCode status = mMappedFileStream->Close();
+
+		delete mMappedFileStream;
+		mMappedFileStream = NULL;
+		return status;
+	}
+	else if(NULL == mInputStream)
 	{
 		return PDFHummus::eSuccess;
 	}
@@ -84,7 +107,23 @@ EStatusCode InputFile::CloseFile()
 
 IByteReaderWithPosition* InputFile::GetInputStream()
 {
-	return mInputStream;
+	if(mMappedFileStream)
+		return mMappedFileStream;
+	else
+		return mInputStream;
+}
+
+IReadWindowProvider* InputFile::GetInputStreamWindow()
+{
+	if(mMappedFileStream)
+		return mMappedFileStream;
+	else
+		return mInputStream;
+}
+
+bool InputFile::IsMemoryMapped()
+{
+	return mMappedFileStream != NULL;
 }
 
 const std::string& InputFile::GetFilePath()
@@ -94,7 +133,11 @@ const std::string& InputFile::GetFilePath()
 
 LongFilePositionType InputFile::GetFileSize()
 {
-	if(mInputStream)
+	if(mMappedFileStream)
+	{
+		return mMappedFileStream->GetFileSize();
+	}
+	else if(mInputStream)
 	{
 		InputFileStream* inputFileStream = (InputFileStream*)mInputStream->GetSourceStream();
 
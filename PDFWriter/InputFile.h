@@ -22,10 +22,12 @@
 
 #include "EStatusCode.h"
 #include "IByteReaderWithPosition.h"
+#include "IReadWindowProvider.h"
 #include <string>
 
 class InputBufferedStream;
 class InputFileStream;
+class InputMemoryMappedFileStream;
 
 
 
@@ -35,10 +37,15 @@ public:
 	InputFile(void);
 	~InputFile(void);
 
-	PDFHummus::EStatusCode OpenFile(const std::string& inFilePath);
+	// open the file for reading. by default the file is read through a buffered stream. 
+	// pass inUseMemoryMapping to have the file mapped to memory instead, which is better for random access reading of large files (like parsing PDFs does).
+	// if mapping fails, falls back on buffered reading
+	PDFHummus::EStatusCode OpenFile(const std::string& inFilePath,bool inUseMemoryMapping = false);
 	PDFHummus::EStatusCode CloseFile();
 
-	IByteReaderWithPosition* GetInputStream(); // returns buffered input stream
+	IByteReaderWithPosition* GetInputStream(); // returns buffered input stream (or the memory mapped stream, if used)
+	IReadWindowProvider* GetInputStreamWindow(); // returns the same input stream, as read window provider (see PDFParser::StartPDFParsing)
+	bool IsMemoryMapped();
 	const std::string& GetFilePath();
 	
 	LongFilePositionType GetFileSize();
@@ -47,4 +54,5 @@ private:
 	std::string mFilePath;
 	InputBufferedStream* mInputStream;
 	InputFileStream* mFileStream;
+	InputMemoryMappedFileStream* mMappedFileStream;
 };
@@ -21,6 +21,7 @@
 #include "InputFlateDecodeStream.h"
 
 #include "Trace.h"
+#include "PDFMetrics.h"
 #include "zlib.h"
 
 
@@ -29,6 +30,7 @@ InputFlateDecodeStream::InputFlateDecodeStream(void)
 	mZLibState = new z_stream;
 	mSourceStream = NULL;
 	mCurrentlyEncoding = false;
+	mMetrics = NULL;
 	mEndOfCompressionEoncountered = false;
 }
 
@@ -53,6 +55,7 @@ InputFlateDecodeStream::InputFlateDecodeStream(IByteReader* inSourceReader)
 	mZLibState = new z_stream;
 	mSourceStream = NULL;
 	mCurrentlyEncoding = false;
+	mMetrics = NULL;
 
 	Assign(inSourceReader);
 }
@@ -84,7 +87,12 @@ void InputFlateDecodeStream::StartEncoding()
 IOBasicTypes::LongBufferSizeType InputFlateDecodeStream::Read(IOBasicTypes::Byte* inBuffer,IOBasicTypes::LongBufferSizeType inBufferSize)
 {
 	if(mCurrentlyEncoding)
-		return DecodeBufferAndRead(inBuffer,inBufferSize);
+	{
+		IOBasicTypes::LongBufferSizeType readBytes = DecodeBufferAndRead(inBuffer,inBufferSize);
+		if(mMetrics)
+			mMetrics->GetCounters().BytesInflated += readBytes;
+		return readBytes;
+	}
 	else if(mSourceStream)
 		return mSourceStream->Read(inBuffer,inBufferSize);
 	else
@@ -167,4 +175,8 @@ bool InputFlateDecodeStream::NotEnded()
 		return (mSourceStream->NotEnded() || mZLibState->avail_in != 0) && !mEndOfCompressionEoncountered;
 	else
 		return mZLibState->avail_in != 0 && mEndOfCompressionEoncountered;
-}
\ No newline at end of file
+}
+void InputFlateDecodeStream::SetMetrics(PDFMetrics* inMetrics)
+{
+	mMetrics = inMetrics;
+}
@@ -26,6 +26,8 @@
 struct z_stream_s;
 typedef z_stream_s z_stream;
 
+class PDFMetrics;
+
 class InputFlateDecodeStream : public IByteReader
 {
 public:
@@ -46,12 +48,16 @@ public:
 
 	virtual bool NotEnded();
 
+	// count the decoded bytes read into the metrics BytesInflated counter. pass NULL to stop counting
+	void SetMetrics(PDFMetrics* inMetrics);
+
 private:
 	IOBasicTypes::Byte mBuffer;
 	IByteReader* mSourceStream;
 	z_stream* mZLibState;
 	bool mCurrentlyEncoding;
 	bool mEndOfCompressionEoncountered;
+	PDFMetrics* mMetrics;
 
 	void FinalizeEncoding();
 	IOBasicTypes::LongBufferSizeType DecodeBufferAndRead(const IOBasicTypes::Byte* inBuffer,IOBasicTypes::LongBufferSizeType inSize);
@@ -0,0 +1,216 @@
+/*
+   Source File : InputMemoryMappedFileStream.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "InputMemoryMappedFileStream.h"
+#include "SafeBufferMacrosDefs.h"
+#include "Trace.h"
+
+#include <memory.h>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace PDFHummus;
+
+InputMemoryMappedFileStream::InputMemoryMappedFileStream(void)
+{
+	mData = NULL;
+	mFileSize = 0;
+	mCurrentPosition = 0;
+	mIsOpen = false;
+#ifdef WIN32
+	mFileHandle = INVALID_HANDLE_VALUE;
+	mMappingHandle = NULL;
+#endif
+}
+
+InputMemoryMappedFileStream::~InputMemoryMappedFileStream(void)
+{
+	if(mIsOpen)
+		Close();
+}
+
+EStatusCode InputMemoryMappedFileStream::Open(const std::string& inFilePath)
+{
+	if(mIsOpen)
+		Close();
+
+#ifdef WIN32
+	mFileHandle = CreateFileW(UTF8ToUTF16Wide(inFilePath).c_str(),GENERIC_READ,FILE_SHARE_READ | FILE_SHARE_WRITE,NULL,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+	if(INVALID_HANDLE_VALUE == mFileHandle)
+	{
+		TRACE_LOG1("InputMemoryMappedFileStream::Open, cannot open file for reading - %s",inFilePath.c_str());
+		return eFailure;
+	}
+
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(mFileHandle,&fileSize))
+	{
+		TRACE_LOG1("InputMemoryMappedFileStream::Open, cannot get file size - %s",inFilePath.c_str());
+		CloseHandle(mFileHandle);
+		mFileHandle = INVALID_HANDLE_VALUE;
+		return eFailure;
+	}
+	mFileSize = fileSize.QuadPart;
+
+	// empty files can't be mapped, and there's nothing to read from them anyways
+	if(mFileSize > 0)
+	{
+		mMappingHandle = CreateFileMappingW(mFileHandle,NULL,PAGE_READONLY,0,0,NULL);
+		if(mMappingHandle)
+			mData = (Byte*)MapViewOfFile(mMappingHandle,FILE_MAP_READ,0,0,0);
+		if(!mData)
+		{
+			TRACE_LOG1("InputMemoryMappedFileStream::Open, cannot map file to memory - %s",inFilePath.c_str());
+			if(mMappingHandle)
+				CloseHandle(mMappingHandle);
+			mMappingHandle = NULL;
+			CloseHandle(mFileHandle);
+			mFileHandle = INVALID_HANDLE_VALUE;
+			return eFailure;
+		}
+	}
+#else
+	int fileDescriptor = open(inFilePath.c_str(),O_RDONLY);
+	if(-1 == fileDescriptor)
+	{
+		TRACE_LOG1("InputMemoryMappedFileStream::Open, cannot open file for reading - %s",inFilePath.c_str());
+		return eFailure;
+	}
+
+	struct stat fileStatus;
+	if(fstat(fileDescriptor,&fileStatus) != 0)
+	{
+		TRACE_LOG1("InputMemoryMappedFileStream::Open, cannot get file size - %s",inFilePath.c_str());
+		close(fileDescriptor);
+		return eFailure;
+	}
+	mFileSize = fileStatus.st_size;
+
+	// empty files can't be mapped, and there's nothing to read from them anyways
+	if(mFileSize > 0)
+	{
+		void* mappedData = mmap(NULL,(size_t)mFileSize,PROT_READ,MAP_PRIVATE,fileDescriptor,0);
+		if(MAP_FAILED == mappedData)
+		{
+			TRACE_LOG1("InputMemoryMappedFileStream::Open, cannot map file to memory - %s",inFilePath.c_str());
+			close(fileDescriptor);
+			return eFailure;
+		}
+		mData = (Byte*)mappedData;
+	}
+
+	// the mapping stays valid after closing the descriptor
+	close(fileDescriptor);
+#endif
+
+	mCurrentPosition = 0;
+	mIsOpen = true;
+	return eSuccess;
+}
+
+EStatusCode InputMemoryMappedFileStream::Close()
+{
+	EStatusCode status = eSuccess;
+
+#ifdef WIN32
+	if(mData && !UnmapViewOfFile(mData))
+		status = eFailure;
+	if(mMappingHandle)
+		CloseHandle(mMappingHandle);
+	if(mFileHandle != INVALID_HANDLE_VALUE && !CloseHandle(mFileHandle))
+		status = eFailure;
+	mMappingHandle = NULL;
+	mFileHandle = INVALID_HANDLE_VALUE;
+#else
+	if(mData && munmap(mData,(size_t)mFileSize) != 0)
+		status = eFailure;
+#endif
+
+	mData = NULL;
+	mFileSize = 0;
+	mCurrentPosition = 0;
+	mIsOpen = false;
+	return status;
+}
+
+LongBufferSizeType InputMemoryMappedFileStream::Read(Byte* inBuffer,LongBufferSizeType inBufferSize)
+{
+	LongBufferSizeType amountToRead = 
+		inBufferSize < (LongBufferSizeType)(mFileSize-mCurrentPosition) ? 
+		inBufferSize : 
+		(LongBufferSizeType)(mFileSize-mCurrentPosition);
+
+	if(amountToRead>0)
+		memcpy(inBuffer,mData+mCurrentPosition,amountToRead);
+	mCurrentPosition+= amountToRead;
+	return amountToRead;
+}
+
+bool InputMemoryMappedFileStream::NotEnded()
+{
+	return mCurrentPosition < mFileSize;
+}
+
+void InputMemoryMappedFileStream::Skip(LongBufferSizeType inSkipSize)
+{
+	mCurrentPosition+= inSkipSize < (LongBufferSizeType)(mFileSize-mCurrentPosition) ? inSkipSize : mFileSize-mCurrentPosition;
+}
+
+void InputMemoryMappedFileStream::SetPosition(LongFilePositionType inOffsetFromStart)
+{
+	mCurrentPosition = inOffsetFromStart > mFileSize ? mFileSize:inOffsetFromStart;
+}
+
+void InputMemoryMappedFileStream::SetPositionFromEnd(LongFilePositionType inOffsetFromEnd)
+{
+	// if seeks too much, place at file begin
+	mCurrentPosition = inOffsetFromEnd > mFileSize ? 0:(mFileSize-inOffsetFromEnd);
+}
+
+LongFilePositionType InputMemoryMappedFileStream::GetCurrentPosition()
+{
+	return mCurrentPosition;
+}
+
+const Byte* InputMemoryMappedFileStream::GetReadWindow(LongBufferSizeType& outWindowSize)
+{
+	outWindowSize = (LongBufferSizeType)(mFileSize-mCurrentPosition);
+	return mData ? mData+mCurrentPosition : NULL;
+}
+
+void InputMemoryMappedFileStream::ConsumeReadWindow(LongBufferSizeType inSize)
+{
+	Skip(inSize);
+}
+
+LongFilePositionType InputMemoryMappedFileStream::GetFileSize()
+{
+	return mFileSize;
+}
+
+const Byte* InputMemoryMappedFileStream::GetData()
+{
+	return mData;
+}
@@ -0,0 +1,76 @@
+/*
+   Source File : InputMemoryMappedFileStream.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "EStatusCode.h"
+#include "IByteReaderWithPosition.h"
+#include "IReadWindowProvider.h"
+
+#include <string>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+/*
+	InputMemoryMappedFileStream. reads a file by mapping it to memory, as a whole.
+	seeking is just moving an index, and the file content is available directly (GetData, or as a read window), so there's
+	no need for an extra buffering layer on top of it. good for random access to large files, like PDF parsing does.
+	note that the file is mapped as it is when opened, so content appended to it later is not visible.
+*/
+class InputMemoryMappedFileStream : public IByteReaderWithPosition, public IReadWindowProvider
+{
+public:
+	InputMemoryMappedFileStream(void);
+	virtual ~InputMemoryMappedFileStream(void);
+
+	// input file path is in UTF8
+	PDFHummus::EStatusCode Open(const std::string& inFilePath);
+	PDFHummus::EStatusCode Close();
+
+	// IByteReaderWithPosition implementation
+	virtual LongBufferSizeType Read(Byte* inBuffer,LongBufferSizeType inBufferSize);
+	virtual bool NotEnded();
+	virtual void Skip(LongBufferSizeType inSkipSize);
+	virtual void SetPosition(LongFilePositionType inOffsetFromStart);
+	virtual void SetPositionFromEnd(LongFilePositionType inOffsetFromEnd);
+	virtual LongFilePositionType GetCurrentPosition();
+
+	// IReadWindowProvider implementation. the window is the rest of the file
+	virtual const Byte* GetReadWindow(LongBufferSizeType& outWindowSize);
+	virtual void ConsumeReadWindow(LongBufferSizeType inSize);
+
+	LongFilePositionType GetFileSize();
+
+	// direct access to the whole file content (GetFileSize bytes). NULL if not open or if the file is empty
+	const Byte* GetData();
+
+private:
+
+	Byte* mData;
+	LongFilePositionType mFileSize;
+	LongFilePositionType mCurrentPosition;
+	bool mIsOpen;
+#ifdef WIN32
+	HANDLE mFileHandle;
+	HANDLE mMappingHandle;
+#endif
+};
@@ -8,7 +8,7 @@
    you may not use this file except in compliance with the License.
    You may obtain a copy of the License at
 
-       http://www.apache.org/licenses/LICENSE-2.0
+	   http://www.apache.org/licenses/LICENSE-2.0
 
    Unless required by applicable law or agreed to in writing, software
    distributed under the License is distributed on an "AS IS" BASIS,
@@ -20,30 +20,22 @@
 */
 #pragma once
 
-#include "IByteReader.h"
+#include "InputPredictorPNGStream.h"
 
-class InputPredictorPNGAverageStream : public IByteReader
+class InputPredictorPNGAverageStream : public InputPredictorPNGStream
 {
 public:
 	InputPredictorPNGAverageStream(void);
 	// Takes ownership (use Assign(NULL,0) to unassign)
-	InputPredictorPNGAverageStream(IByteReader* inSourceStream,IOBasicTypes::LongBufferSizeType inColumns);
+	InputPredictorPNGAverageStream(IByteReader* inSourceStream,
+								   IOBasicTypes::LongBufferSizeType inColumns,
+								   IOBasicTypes::LongBufferSizeType inColors = 1,
+								   IOBasicTypes::LongBufferSizeType inBitsPerComponent = 8);
 	virtual ~InputPredictorPNGAverageStream(void);
 
-	virtual IOBasicTypes::LongBufferSizeType Read(IOBasicTypes::Byte* inBuffer,IOBasicTypes::LongBufferSizeType inBufferSize);
-
-	virtual bool NotEnded();
-
 	// Takes ownership (use Assign(NULL,0) to unassign)
-	void Assign(IByteReader* inSourceStream,IOBasicTypes::LongBufferSizeType inColumns);
-
-private:
-	IByteReader* mSourceStream;
-	IOBasicTypes::Byte* mBuffer;
-	IOBasicTypes::LongBufferSizeType mBufferSize;
-	IOBasicTypes::Byte* mIndex;
-
-	IOBasicTypes::Byte* mUpValues;
-
-	void DecodeNextByte(IOBasicTypes::Byte& outDecodedByte);
+	void Assign(IByteReader* inSourceStream,
+				IOBasicTypes::LongBufferSizeType inColumns,
+				IOBasicTypes::LongBufferSizeType inColors = 1,
+				IOBasicTypes::LongBufferSizeType inBitsPerComponent = 8);
 };
@@ -8,7 +8,7 @@
    you may not use this file except in compliance with the License.
    You may obtain a copy of the License at
 
-       http://www.apache.org/licenses/LICENSE-2.0
+	   http://www.apache.org/licenses/LICENSE-2.0
 
    Unless required by applicable law or agreed to in writing, software
    distributed under the License is distributed on an "AS IS" BASIS,
@@ -19,88 +19,30 @@
    
 */
 #include "InputPredictorPNGNoneStream.h"
-
-#include "Trace.h"
-
+#include "PNGPredictorKernels.h"
 
 using namespace IOBasicTypes;
 
 InputPredictorPNGNoneStream::InputPredictorPNGNoneStream(void)
 {
-	mSourceStream = NULL;
-	mBuffer = NULL;
-	mIndex = NULL;
-	mBufferSize = 0;
-}
-
-InputPredictorPNGNoneStream::~InputPredictorPNGNoneStream(void)
-{
-	delete[] mBuffer;
-	delete mSourceStream;
-}
-
-InputPredictorPNGNoneStream::InputPredictorPNGNoneStream(IByteReader* inSourceStream,IOBasicTypes::LongBufferSizeType inColumns)
-{	
-	mSourceStream = NULL;
-	mBuffer = NULL;
-	mIndex = NULL;
-	mBufferSize = 0;
-
-	Assign(inSourceStream,inColumns);
-}
-
-
-LongBufferSizeType InputPredictorPNGNoneStream::Read(Byte* inBuffer,LongBufferSizeType inBufferSize)
-{
-	LongBufferSizeType readBytes = 0;
-	
-
-	// exhaust what's in the buffer currently
-	while(mBufferSize > (LongBufferSizeType)(mIndex - mBuffer) && readBytes < inBufferSize)
-	{
-		DecodeNextByte(inBuffer[readBytes]);
-		++readBytes;
-	}
-
-	// now repeatedly read bytes from the input stream, and decode
-	while(readBytes < inBufferSize && mSourceStream->NotEnded())
-	{
-		if(mSourceStream->Read(mBuffer,mBufferSize) != mBufferSize)
-		{
-			TRACE_LOG("InputPredictorPNGNoneStream::Read, problem, expected columns number read. didn't make it");
-			readBytes = 0;
-			break;
-		}
-		mIndex = mBuffer+1; // skip the first tag
-
-		while(mBufferSize > (LongBufferSizeType)(mIndex - mBuffer) && readBytes < inBufferSize)
-		{
-			DecodeNextByte(inBuffer[readBytes]);
-			++readBytes;
-		}
-	}
-	return readBytes;
 }
 
-bool InputPredictorPNGNoneStream::NotEnded()
+InputPredictorPNGNoneStream::InputPredictorPNGNoneStream(IByteReader* inSourceStream,
+														 LongBufferSizeType inColumns,
+														 LongBufferSizeType inColors,
+														 LongBufferSizeType inBitsPerComponent) :
+	InputPredictorPNGStream(inSourceStream,PNG_FILTER_NONE,inColumns,inColors,inBitsPerComponent)
 {
-	return mSourceStream->NotEnded() || (LongBufferSizeType)(mIndex - mBuffer) < mBufferSize;
 }
 
-void InputPredictorPNGNoneStream::DecodeNextByte(Byte& outDecodedByte)
+InputPredictorPNGNoneStream::~InputPredictorPNGNoneStream(void)
 {
-	outDecodedByte = *mIndex;
-
-	++mIndex;
 }
 
-void InputPredictorPNGNoneStream::Assign(IByteReader* inSourceStream,IOBasicTypes::LongBufferSizeType inColumns)
+void InputPredictorPNGNoneStream::Assign(IByteReader* inSourceStream,
+										 LongBufferSizeType inColumns,
+										 LongBufferSizeType inColors,
+										 LongBufferSizeType inBitsPerComponent)
 {
-	mSourceStream = inSourceStream;
-
-	delete[] mBuffer;
-	mBufferSize = inColumns + 1;
-	mBuffer = new Byte[mBufferSize];
-	mIndex = mBuffer + mBufferSize;
-
+	InputPredictorPNGStream::Assign(inSourceStream,PNG_FILTER_NONE,inColumns,inColors,inBitsPerComponent);
 }
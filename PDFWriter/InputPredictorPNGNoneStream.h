@@ -8,7 +8,7 @@
    you may not use this file except in compliance with the License.
    You may obtain a copy of the License at
 
-       http://www.apache.org/licenses/LICENSE-2.0
+	   http://www.apache.org/licenses/LICENSE-2.0
 
    Unless required by applicable law or agreed to in writing, software
    distributed under the License is distributed on an "AS IS" BASIS,
@@ -20,28 +20,22 @@
 */
 #pragma once
 
-#include "IByteReader.h"
+#include "InputPredictorPNGStream.h"
 
-class InputPredictorPNGNoneStream : public IByteReader
+class InputPredictorPNGNoneStream : public InputPredictorPNGStream
 {
 public:
 	InputPredictorPNGNoneStream(void);
 	// Takes ownership (use Assign(NULL,0) to unassign)
-	InputPredictorPNGNoneStream(IByteReader* inSourceStream,IOBasicTypes::LongBufferSizeType inColumns);
+	InputPredictorPNGNoneStream(IByteReader* inSourceStream,
+								IOBasicTypes::LongBufferSizeType inColumns,
+								IOBasicTypes::LongBufferSizeType inColors = 1,
+								IOBasicTypes::LongBufferSizeType inBitsPerComponent = 8);
 	virtual ~InputPredictorPNGNoneStream(void);
 
-	virtual IOBasicTypes::LongBufferSizeType Read(IOBasicTypes::Byte* inBuffer,IOBasicTypes::LongBufferSizeType inBufferSize);
-
-	virtual bool NotEnded();
-
 	// Takes ownership (use Assign(NULL,0) to unassign)
-	void Assign(IByteReader* inSourceStream,IOBasicTypes::LongBufferSizeType inColumns);
-
-private:
-	IByteReader* mSourceStream;
-	IOBasicTypes::Byte* mBuffer;
-	IOBasicTypes::LongBufferSizeType mBufferSize;
-	IOBasicTypes::Byte* mIndex;
-
-	void DecodeNextByte(IOBasicTypes::Byte& outDecodedByte);
+	void Assign(IByteReader* inSourceStream,
+				IOBasicTypes::LongBufferSizeType inColumns,
+				IOBasicTypes::LongBufferSizeType inColors = 1,
+				IOBasicTypes::LongBufferSizeType inBitsPerComponent = 8);
 };
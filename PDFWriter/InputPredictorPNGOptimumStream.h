@@ -8,7 +8,7 @@
    you may not use this file except in compliance with the License.
    You may obtain a copy of the License at
 
-       http://www.apache.org/licenses/LICENSE-2.0
+	   http://www.apache.org/licenses/LICENSE-2.0
 
    Unless required by applicable law or agreed to in writing, software
    distributed under the License is distributed on an "AS IS" BASIS,
@@ -20,32 +20,22 @@
 */
 #pragma once
 
-#include "IByteReader.h"
+#include "InputPredictorPNGStream.h"
 
-class InputPredictorPNGOptimumStream : public IByteReader
+class InputPredictorPNGOptimumStream : public InputPredictorPNGStream
 {
 public:
 	InputPredictorPNGOptimumStream(void);
 	// Takes ownership (use Assign(NULL,0) to unassign)
-	InputPredictorPNGOptimumStream(IByteReader* inSourceStream,IOBasicTypes::LongBufferSizeType inColumns);
+	InputPredictorPNGOptimumStream(IByteReader* inSourceStream,
+								   IOBasicTypes::LongBufferSizeType inColumns,
+								   IOBasicTypes::LongBufferSizeType inColors = 1,
+								   IOBasicTypes::LongBufferSizeType inBitsPerComponent = 8);
 	virtual ~InputPredictorPNGOptimumStream(void);
 
-	virtual IOBasicTypes::LongBufferSizeType Read(IOBasicTypes::Byte* inBuffer,IOBasicTypes::LongBufferSizeType inBufferSize);
-
-	virtual bool NotEnded();
-
 	// Takes ownership (use Assign(NULL,0) to unassign)
-	void Assign(IByteReader* inSourceStream,IOBasicTypes::LongBufferSizeType inColumns);
-
-private:
-	IByteReader* mSourceStream;
-	IOBasicTypes::Byte* mBuffer;
-	IOBasicTypes::LongBufferSizeType mBufferSize;
-	IOBasicTypes::Byte* mIndex;
-	IOBasicTypes::Byte mFunctionType;
-
-	IOBasicTypes::Byte* mUpValues;
-
-	void DecodeNextByte(IOBasicTypes::Byte& outDecodedByte);
-	char PaethPredictor(char inLeft,char inUp,char inUpLeft);
+	void Assign(IByteReader* inSourceStream,
+				IOBasicTypes::LongBufferSizeType inColumns,
+				IOBasicTypes::LongBufferSizeType inColors = 1,
+				IOBasicTypes::LongBufferSizeType inBitsPerComponent = 8);
 };
@@ -0,0 +1,141 @@
+/*
+   Source File : InputPredictorPNGStream.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "InputPredictorPNGStream.h"
+#include "PNGPredictorKernels.h"
+#include "Trace.h"
+
+#include <string.h>
+
+using namespace IOBasicTypes;
+
+InputPredictorPNGStream::InputPredictorPNGStream(void)
+{
+	mSourceStream = NULL;
+	mFilterType = PNG_FILTER_NONE;
+	mRowSize = 0;
+	mBytesPerPixel = 1;
+	mRowsBuffer = NULL;
+	mRow = NULL;
+	mUpRow = NULL;
+	mIndex = NULL;
+	mRowEnd = NULL;
+}
+
+InputPredictorPNGStream::InputPredictorPNGStream(IByteReader* inSourceStream,
+												 Byte inFilterType,
+												 LongBufferSizeType inColumns,
+												 LongBufferSizeType inColors,
+												 LongBufferSizeType inBitsPerComponent)
+{
+	mSourceStream = NULL;
+	mRowsBuffer = NULL;
+
+	Assign(inSourceStream,inFilterType,inColumns,inColors,inBitsPerComponent);
+}
+
+InputPredictorPNGStream::~InputPredictorPNGStream(void)
+{
+	delete[] mRowsBuffer;
+	delete mSourceStream;
+}
+
+void InputPredictorPNGStream::Assign(IByteReader* inSourceStream,
+									 Byte inFilterType,
+									 LongBufferSizeType inColumns,
+									 LongBufferSizeType inColors,
+									 LongBufferSizeType inBitsPerComponent)
+{
+	mSourceStream = inSourceStream;
+	mFilterType = inFilterType;
+	mRowSize = (inColumns * inColors * inBitsPerComponent + 7) / 8;
+	mBytesPerPixel = (inColors * inBitsPerComponent + 7) / 8;
+	if(0 == mBytesPerPixel)
+		mBytesPerPixel = 1;
+
+	delete[] mRowsBuffer;
+	mRowsBuffer = new Byte[2 * (mRowSize + 1)];
+	memset(mRowsBuffer,0,2 * (mRowSize + 1)); // zero up row for the first row
+	mRow = mRowsBuffer;
+	mUpRow = mRowsBuffer + mRowSize + 1;
+	mRowEnd = mRow + 1 + mRowSize;
+	mIndex = mRowEnd;
+}
+
+LongBufferSizeType InputPredictorPNGStream::Read(Byte* inBuffer,LongBufferSizeType inBufferSize)
+{
+	LongBufferSizeType readBytes = 0;
+
+	while(readBytes < inBufferSize)
+	{
+		if(mIndex == mRowEnd)
+		{
+			if(!mSourceStream->NotEnded())
+				break;
+			if(!DecodeNextRow())
+			{
+				readBytes = 0;
+				break;
+			}
+		}
+
+		LongBufferSizeType copyAmount = (LongBufferSizeType)(mRowEnd - mIndex);
+		if(copyAmount > inBufferSize - readBytes)
+			copyAmount = inBufferSize - readBytes;
+		memcpy(inBuffer + readBytes,mIndex,copyAmount);
+		mIndex += copyAmount;
+		readBytes += copyAmount;
+	}
+	return readBytes;
+}
+
+bool InputPredictorPNGStream::DecodeNextRow()
+{
+	// the current row becomes the up row, and the next row is read over the previous up row
+	Byte* upRow = mRow;
+	mRow = mUpRow;
+	mUpRow = upRow;
+	mRowEnd = mRow + 1 + mRowSize;
+	mIndex = mRowEnd;
+
+	if(mSourceStream->Read(mRow,mRowSize + 1) != mRowSize + 1)
+	{
+		TRACE_LOG("InputPredictorPNGStream::DecodeNextRow, problem, expected columns number read. didn't make it");
+		return false;
+	}
+
+	if(!PNGPredictorKernels::UnfilterRow(PNG_FILTER_PER_ROW == mFilterType ? mRow[0] : mFilterType,
+										 mRow + 1,
+										 mUpRow + 1,
+										 mRowSize,
+										 mBytesPerPixel))
+	{
+		TRACE_LOG1("InputPredictorPNGStream::DecodeNextRow, unknown PNG filter type %d",mRow[0]);
+		return false;
+	}
+
+	mIndex = mRow + 1; // skip the tag
+	return true;
+}
+
+bool InputPredictorPNGStream::NotEnded()
+{
+	return mSourceStream->NotEnded() || mIndex < mRowEnd;
+}
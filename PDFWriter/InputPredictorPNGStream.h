@@ -0,0 +1,70 @@
+/*
+   Source File : InputPredictorPNGStream.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "IByteReader.h"
+
+// use as the filter type to decode each row according to its own tag byte (predictor 15)
+#define PNG_FILTER_PER_ROW 0xff
+
+/*
+	Common implementation for the PNG predictor streams. Reads a whole row at a time from the source stream,
+	decodes it with the row kernels from PNGPredictorKernels, and copies decoded rows to the reader buffer.
+	Either uses a fixed filter type for all rows, or PNG_FILTER_PER_ROW to use the tag byte of each row.
+*/
+class InputPredictorPNGStream : public IByteReader
+{
+public:
+	InputPredictorPNGStream(void);
+	// Takes ownership (use Assign(NULL,0,0) to unassign)
+	InputPredictorPNGStream(IByteReader* inSourceStream,
+							IOBasicTypes::Byte inFilterType,
+							IOBasicTypes::LongBufferSizeType inColumns,
+							IOBasicTypes::LongBufferSizeType inColors = 1,
+							IOBasicTypes::LongBufferSizeType inBitsPerComponent = 8);
+	virtual ~InputPredictorPNGStream(void);
+
+	virtual IOBasicTypes::LongBufferSizeType Read(IOBasicTypes::Byte* inBuffer,IOBasicTypes::LongBufferSizeType inBufferSize);
+
+	virtual bool NotEnded();
+
+	// Takes ownership (use Assign(NULL,0,0) to unassign)
+	void Assign(IByteReader* inSourceStream,
+				IOBasicTypes::Byte inFilterType,
+				IOBasicTypes::LongBufferSizeType inColumns,
+				IOBasicTypes::LongBufferSizeType inColors = 1,
+				IOBasicTypes::LongBufferSizeType inBitsPerComponent = 8);
+
+private:
+	IByteReader* mSourceStream;
+	IOBasicTypes::Byte mFilterType;
+	IOBasicTypes::LongBufferSizeType mRowSize;
+	IOBasicTypes::LongBufferSizeType mBytesPerPixel;
+
+	// two rows, each prefixed by its tag byte. mRow is the current row, mUpRow the previous one
+	IOBasicTypes::Byte* mRowsBuffer;
+	IOBasicTypes::Byte* mRow;
+	IOBasicTypes::Byte* mUpRow;
+	IOBasicTypes::Byte* mIndex;
+	IOBasicTypes::Byte* mRowEnd;
+
+	bool DecodeNextRow();
+};
@@ -19,16 +19,19 @@
    
 */
 #include "InputPredictorTIFFSubStream.h"
+#include "PNGPredictorKernels.h"
 #include "Trace.h"
 
+#include <string.h>
+
 using namespace IOBasicTypes;
 
 InputPredictorTIFFSubStream::InputPredictorTIFFSubStream(void)
 {
 	mSourceStream = NULL;
 	mRowBuffer = NULL;
-	mReadColors = NULL;
-	mReadColorsCount = 0;
+	mRowSize = 0;
+	mIndex = NULL;
 }
 
 InputPredictorTIFFSubStream::InputPredictorTIFFSubStream(IByteReader* inSourceStream,
@@ -38,7 +41,6 @@ InputPredictorTIFFSubStream::InputPredictorTIFFSubStream(IByteReader* inSourceSt
 {
 	mSourceStream = NULL;
 	mRowBuffer = NULL;
-	mReadColors = NULL;
 
 	Assign(inSourceStream,inColors,inBitsPerComponent,inColumns);
 }
@@ -47,44 +49,41 @@ InputPredictorTIFFSubStream::~InputPredictorTIFFSubStream(void)
 {
 	delete mSourceStream;
 	delete[] mRowBuffer;
-	delete[] mReadColors;
 }
 
 LongBufferSizeType InputPredictorTIFFSubStream::Read(Byte* inBuffer,LongBufferSizeType inBufferSize)
 {
 	LongBufferSizeType readBytes = 0;
-	
-
-	// exhaust what's in the buffer currently
-	while(mReadColorsCount > (LongBufferSizeType)(mReadColorsIndex - mColors) && readBytes < inBufferSize)
-	{
-		ReadByteFromColorsArray(inBuffer[readBytes]);
-		++readBytes;
-	}
 
-	// now repeatedly read bytes from the input stream, and decode
-	while(readBytes < inBufferSize && mSourceStream->NotEnded())
+	while(readBytes < inBufferSize)
 	{
-		if(mSourceStream->Read(mRowBuffer,(mColumns*mColors*mBitsPerComponent)/8) != (mColumns*mColors*mBitsPerComponent)/8)
+		if(mIndex == mRowBuffer + mRowSize)
 		{
-			TRACE_LOG("InputPredictorPNGSubStream::Read, problem, expected columns*colors*bitspercomponent/8 number read. didn't make it");
-			readBytes = 0;
-			break;
+			if(!mSourceStream->NotEnded())
+				break;
+			if(mSourceStream->Read(mRowBuffer,mRowSize) != mRowSize)
+			{
+				TRACE_LOG("InputPredictorTIFFSubStream::Read, problem, expected columns*colors*bitspercomponent/8 number read. didn't make it");
+				readBytes = 0;
+				break;
+			}
+			DecodeRow();
+			mIndex = mRowBuffer;
 		}
-		DecodeBufferToColors();
 
-		while(mReadColorsCount > (LongBufferSizeType)(mReadColorsIndex - mColors) && readBytes < inBufferSize)
-		{
-			ReadByteFromColorsArray(inBuffer[readBytes]);
-			++readBytes;
-		}
+		LongBufferSizeType copyAmount = (LongBufferSizeType)(mRowBuffer + mRowSize - mIndex);
+		if(copyAmount > inBufferSize - readBytes)
+			copyAmount = inBufferSize - readBytes;
+		memcpy(inBuffer + readBytes,mIndex,copyAmount);
+		mIndex += copyAmount;
+		readBytes += copyAmount;
 	}
 	return readBytes;	
 }
 
 bool InputPredictorTIFFSubStream::NotEnded()
 {
-	return mSourceStream->NotEnded() || (LongBufferSizeType)(mReadColorsIndex - mReadColors) < mReadColorsCount;
+	return mSourceStream->NotEnded() || mIndex < mRowBuffer + mRowSize;
 }
 
 void InputPredictorTIFFSubStream::Assign(IByteReader* inSourceStream,
@@ -97,86 +96,46 @@ void InputPredictorTIFFSubStream::Assign(IByteReader* inSourceStream,
 	mBitsPerComponent = inBitsPerComponent;
 	mColumns = inColumns;
 	
-	delete mRowBuffer;
-	mRowBuffer = new Byte[(inColumns*inColors*inBitsPerComponent)/8];
-
-	mReadColorsCount = inColumns * inColors;
-	mReadColors = new unsigned short[mReadColorsCount];
-	mReadColorsIndex = mReadColors + mReadColorsCount;
-	mIndexInColor = 0;
-
-	mBitMask = 0;
-	for(Byte i=0;i<inBitsPerComponent;++i)
-		mBitMask = (mBitMask<<1) + 1;
-}
-
-void InputPredictorTIFFSubStream::ReadByteFromColorsArray(Byte& outBuffer)
-{
-	if(8 == mBitsPerComponent)
-	{
-		outBuffer = (Byte)(*mReadColorsIndex);
-		++mReadColorsIndex;
-	}
-	else if(8 > mBitsPerComponent)
-	{
-		outBuffer = 0;
-		for(Byte i=0;i<(8/mBitsPerComponent);++i)
-		{
-			outBuffer = (outBuffer<<mBitsPerComponent) + (Byte)(*mReadColorsIndex);
-			++mReadColorsIndex;
-		}
-	}
-	else // 8 < mBitsPerComponent [which is just 16 for now]
-	{
-		outBuffer =(Byte)(((*mReadColorsIndex)>>(mBitsPerComponent - mIndexInColor*8)) & 0xff);
-		++mIndexInColor;
-		if(mBitsPerComponent/8 == mIndexInColor)
-		{
-			++mReadColorsIndex;
-			mIndexInColor = 0;
-		}
-	}
+	delete[] mRowBuffer;
+	mRowSize = (inColumns*inColors*inBitsPerComponent + 7)/8;
+	mRowBuffer = new Byte[mRowSize];
+	mIndex = mRowBuffer + mRowSize;
 }
 
-void InputPredictorTIFFSubStream::DecodeBufferToColors()
+void InputPredictorTIFFSubStream::DecodeRow()
 {	
-	//1. Split to colors. Use array of colors (should be columns * colors). Each time take BitsPerComponent of the buffer
-	//2. Once you got the "colors", loop the array, setting values after diffs (use modulo of bit mask for "sign" computing)
-	//3. Now you have the colors array. 
-	LongBufferSizeType i = 0;
-
-	// read the colors differences according to bits per component
+	// each color component is a difference from the same component of the pixel to its left. decode in place.
 	if(8 == mBitsPerComponent)
 	{
-		for(; i < mReadColorsCount;++i)
-			mReadColors[i] = mRowBuffer[i];
+		// that's just the PNG sub filter, with a pixel per colors bytes
+		PNGPredictorKernels::UnfilterSubRow(mRowBuffer,mRowSize,mColors);
 	}
-	else if(8 > mBitsPerComponent)
+	else if(16 == mBitsPerComponent)
 	{
-		for(; i < (mReadColorsCount*mBitsPerComponent/8);++i)
+		// big endian 16 bit components
+		for(LongBufferSizeType i = mColors*2; i + 1 < mRowSize; i+=2)
 		{
-			for(LongBufferSizeType j=0; j < (LongBufferSizeType)(8/mBitsPerComponent); ++j)
-			{
-				mReadColors[(i+1)*8/mBitsPerComponent - j - 1] = mRowBuffer[i] & mBitMask;
-				mRowBuffer[i] = mRowBuffer[i]>>mBitsPerComponent;
-			}
+			unsigned short value = (unsigned short)(((mRowBuffer[i]<<8) | mRowBuffer[i+1]) + 
+													((mRowBuffer[i - mColors*2]<<8) | mRowBuffer[i - mColors*2 + 1]));
+			mRowBuffer[i] = (Byte)(value>>8);
+			mRowBuffer[i+1] = (Byte)(value & 0xff);
 		}
 	}
-	else // mBitesPerComponent > 8
+	else if(mBitsPerComponent > 0 && mBitsPerComponent < 8)
 	{
-		for(; i < mReadColorsCount;++i)
+		// 1, 2 or 4 bits components, packed from the most significant bit
+		Byte bitMask = (Byte)((1<<mBitsPerComponent) - 1);
+		LongBufferSizeType componentsCount = mColumns*mColors;
+
+		for(LongBufferSizeType i = mColors; i < componentsCount; ++i)
 		{
-			mReadColors[i] = 0;
-			for(Byte j=0;j<mBitsPerComponent/8;++j)
-				mReadColors[i] = (mReadColors[i]<<mBitsPerComponent) + mRowBuffer[i*mBitsPerComponent/8 + j];
+			LongBufferSizeType bitOffset = i*mBitsPerComponent;
+			LongBufferSizeType leftBitOffset = (i - mColors)*mBitsPerComponent;
+			Byte shift = (Byte)(8 - mBitsPerComponent - bitOffset%8);
+			Byte leftShift = (Byte)(8 - mBitsPerComponent - leftBitOffset%8);
+
+			Byte value = (Byte)(((mRowBuffer[bitOffset/8]>>shift) + (mRowBuffer[leftBitOffset/8]>>leftShift)) & bitMask);
+			mRowBuffer[bitOffset/8] = (Byte)((mRowBuffer[bitOffset/8] & ~(bitMask<<shift)) | (value<<shift));
 		}
 	}
-
-	// calculate color values according to diffs
-	for(i = mColors; i < mReadColorsCount; ++i)
-		mReadColors[i] = (mReadColors[i] + mReadColors[i-mColors]) & mBitMask;
-
-	mReadColorsIndex = mReadColors;
-	mIndexInColor = 0;
-
-}
\ No newline at end of file
+}
@@ -51,14 +51,8 @@ private:
 	IOBasicTypes::LongBufferSizeType mColumns;
 	
 	IOBasicTypes::Byte* mRowBuffer;
-	IOBasicTypes::LongBufferSizeType mReadColorsCount;
-	unsigned short* mReadColors;
-	unsigned short* mReadColorsIndex;
-	IOBasicTypes::Byte mIndexInColor;
-	unsigned short mBitMask;
-
-	void ReadByteFromColorsArray(IOBasicTypes::Byte& outBuffer);
-	void DecodeBufferToColors();
-
+	IOBasicTypes::LongBufferSizeType mRowSize;
+	IOBasicTypes::Byte* mIndex;
 
+	void DecodeRow();
 };
@@ -0,0 +1,131 @@
+/*
+   Source File : InputRetainingStream.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "InputRetainingStream.h"
+
+#include <memory.h>
+#include <algorithm>
+
+using namespace IOBasicTypes;
+
+InputRetainingStream::InputRetainingStream(IByteReader* inSourceStream,LongBufferSizeType inChunkSize)
+{
+	mSourceStream = inSourceStream;
+	mChunkSize = inChunkSize;
+	mBufferCapacity = inChunkSize;
+	mBuffer = new Byte[mBufferCapacity];
+	mRetainedStart = mReadIndex = mDataEnd = 0;
+	mBufferStartPosition = 0;
+}
+
+InputRetainingStream::~InputRetainingStream(void)
+{
+	delete[] mBuffer;
+}
+
+bool InputRetainingStream::FillBuffer()
+{
+	if(!mSourceStream || !mSourceStream->NotEnded())
+		return false;
+
+	// drop released bytes from the buffer start
+	if(mRetainedStart > 0)
+	{
+		memmove(mBuffer,mBuffer + mRetainedStart,mDataEnd - mRetainedStart);
+		mBufferStartPosition += mRetainedStart;
+		mReadIndex -= mRetainedStart;
+		mDataEnd -= mRetainedStart;
+		mRetainedStart = 0;
+	}
+
+	// make room for a full chunk, growing if retained bytes take up too much of the buffer
+	if(mBufferCapacity - mDataEnd < mChunkSize)
+	{
+		LongBufferSizeType newCapacity = std::max<LongBufferSizeType>(mBufferCapacity * 2,mDataEnd + mChunkSize);
+		Byte* newBuffer = new Byte[newCapacity];
+		memcpy(newBuffer,mBuffer,mDataEnd);
+		delete[] mBuffer;
+		mBuffer = newBuffer;
+		mBufferCapacity = newCapacity;
+	}
+
+	LongBufferSizeType readAmount = mSourceStream->Read(mBuffer + mDataEnd,mBufferCapacity - mDataEnd);
+	mDataEnd += readAmount;
+	return readAmount > 0;
+}
+
+LongBufferSizeType InputRetainingStream::Read(Byte* inBuffer,LongBufferSizeType inBufferSize)
+{
+	LongBufferSizeType bytesRead = 0;
+
+	while(bytesRead < inBufferSize)
+	{
+		if(mReadIndex == mDataEnd && !FillBuffer())
+			break;
+		LongBufferSizeType toCopy = std::min<LongBufferSizeType>(inBufferSize - bytesRead,mDataEnd - mReadIndex);
+		memcpy(inBuffer + bytesRead,mBuffer + mReadIndex,toCopy);
+		mReadIndex += toCopy;
+		bytesRead += toCopy;
+	}
+
+	return bytesRead;
+}
+
+bool InputRetainingStream::NotEnded()
+{
+	return mReadIndex < mDataEnd || (mSourceStream && mSourceStream->NotEnded());
+}
+
+const Byte* InputRetainingStream::GetReadWindow(LongBufferSizeType& outWindowSize)
+{
+	if(mReadIndex == mDataEnd)
+		FillBuffer();
+
+	outWindowSize = mDataEnd - mReadIndex;
+	return outWindowSize > 0 ? mBuffer + mReadIndex : NULL;
+}
+
+void InputRetainingStream::ConsumeReadWindow(LongBufferSizeType inSize)
+{
+	mReadIndex += std::min<LongBufferSizeType>(inSize,mDataEnd - mReadIndex);
+}
+
+LongFilePositionType InputRetainingStream::GetCurrentPosition()
+{
+	return mBufferStartPosition + mReadIndex;
+}
+
+LongFilePositionType InputRetainingStream::GetRetainedStartPosition()
+{
+	return mBufferStartPosition + mRetainedStart;
+}
+
+const Byte* InputRetainingStream::GetRetainedBytes(LongBufferSizeType& outSize)
+{
+	outSize = mReadIndex - mRetainedStart;
+	return mBuffer + mRetainedStart;
+}
+
+void InputRetainingStream::ReleaseTill(LongFilePositionType inPosition)
+{
+	if(inPosition <= GetRetainedStartPosition())
+		return;
+	mRetainedStart = (LongBufferSizeType)std::min<LongFilePositionType>(inPosition - mBufferStartPosition,mReadIndex);
+}
@@ -0,0 +1,72 @@
+/*
+   Source File : InputRetainingStream.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "IByteReader.h"
+#include "IReadWindowProvider.h"
+
+#define DEFAULT_RETAINING_STREAM_CHUNK_SIZE (64*1024)
+
+/*
+	InputRetainingStream is a read window provider over another stream, that keeps the bytes read from it
+	until they are released. This allows scanning a stream (say, with the tokenizer) and later copying
+	parts of what was scanned to an output, without reading the source stream again.
+	Memory use is the amount of retained bytes, plus the read chunk size, so release often.
+	The source stream is not owned.
+*/
+class InputRetainingStream : public IByteReader, public IReadWindowProvider
+{
+public:
+	InputRetainingStream(IByteReader* inSourceStream,IOBasicTypes::LongBufferSizeType inChunkSize = DEFAULT_RETAINING_STREAM_CHUNK_SIZE);
+	virtual ~InputRetainingStream(void);
+
+	// IByteReader implementation
+	virtual IOBasicTypes::LongBufferSizeType Read(IOBasicTypes::Byte* inBuffer,IOBasicTypes::LongBufferSizeType inBufferSize);
+	virtual bool NotEnded();
+
+	// IReadWindowProvider implementation
+	virtual const IOBasicTypes::Byte* GetReadWindow(IOBasicTypes::LongBufferSizeType& outWindowSize);
+	virtual void ConsumeReadWindow(IOBasicTypes::LongBufferSizeType inSize);
+
+	// position of the next byte to read, from the start of the source stream (well, from when it was assigned)
+	IOBasicTypes::LongFilePositionType GetCurrentPosition();
+
+	// the retained bytes, from the last release position to the current position. valid till the next read
+	IOBasicTypes::LongFilePositionType GetRetainedStartPosition();
+	const IOBasicTypes::Byte* GetRetainedBytes(IOBasicTypes::LongBufferSizeType& outSize);
+
+	// stop retaining the bytes that come before inPosition. inPosition should be between the retained start position and the current position
+	void ReleaseTill(IOBasicTypes::LongFilePositionType inPosition);
+
+private:
+	IByteReader* mSourceStream;
+	IOBasicTypes::LongBufferSizeType mChunkSize;
+	IOBasicTypes::Byte* mBuffer;
+	IOBasicTypes::LongBufferSizeType mBufferCapacity;
+	// offsets in buffer - retained start <= read <= data end
+	IOBasicTypes::LongBufferSizeType mRetainedStart;
+	IOBasicTypes::LongBufferSizeType mReadIndex;
+	IOBasicTypes::LongBufferSizeType mDataEnd;
+	// source stream position of the first byte in the buffer
+	IOBasicTypes::LongFilePositionType mBufferStartPosition;
+
+	bool FillBuffer();
+};
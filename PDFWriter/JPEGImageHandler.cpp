@@ -223,6 +223,7 @@ PDFImageXObject* JPEGImageHandler::CreateAndWriteImageXObjectFromJPGInformation(
 		delete imageStream;
 
 		imageXObject = new PDFImageXObject(inImageXObjectID,1 == inJPGImageInformation.ColorComponentsCount ? KProcsetImageB:KProcsetImageC);
+		++mObjectsContext->GetMetrics().GetCounters().ImagesWritten;
 	}while(false);
 	
 
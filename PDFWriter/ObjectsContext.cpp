@@ -31,6 +31,8 @@
 #include "PDFDictionary.h"
 #include "PDFIndirectObjectReference.h"
 #include "PDFBoolean.h"
+#include "PDFInteger.h"
+#include "PDFArray.h"
 #include "PDFLiteralString.h"
 #include "EncryptionHelper.h"
 #include "PDFObjectParser.h"
@@ -40,9 +42,16 @@ using namespace PDFHummus;
 ObjectsContext::ObjectsContext(void)
 {
 	mOutputStream = NULL;
+	mDocumentOutputStream = NULL;
 	mCompressStreams = true;
+	mFlateEncodingThreads = 1;
 	mExtender = NULL;
 	mEncryptionHelper = NULL;
+	mWriteObjectStreams = false;
+	mWritingObjectToObjectStream = false;
+	mCurrentObjectID = 0;
+	mCurrentObjectIsModified = false;
+	mObjectStreamID = 0;
 }
 
 ObjectsContext::~ObjectsContext(void)
@@ -55,6 +64,7 @@ ObjectsContext::~ObjectsContext(void)
 void ObjectsContext::SetOutputStream(IByteWriterWithPosition* inOutputStream)
 {
 	mOutputStream = inOutputStream;
+	mDocumentOutputStream = inOutputStream;
 	mPrimitiveWriter.SetStreamForWriting(inOutputStream);
 }
 
@@ -145,10 +155,10 @@ void ObjectsContext::EndFreeContext()
 }
 
 LongFilePositionType ObjectsContext::GetCurrentPosition() {
-	if (!mOutputStream) // in case somebody gets smart and ask before the stream is set
+	if (!mDocumentOutputStream) // in case somebody gets smart and ask before the stream is set
 		return 0;
 
-	return mOutputStream->GetCurrentPosition();
+	return mDocumentOutputStream->GetCurrentPosition();
 }
 
 
@@ -181,7 +191,8 @@ EStatusCode ObjectsContext::WriteXrefTable(LongFilePositionType& outWritePositio
     
         // write section header
         mPrimitiveWriter.WriteInteger(startID);
-        mPrimitiveWriter.WriteInteger(firstIDNotInRange - startID,eTokenSeparatorEndLine);
+        mPrimitiveWriter.WriteInteger(firstIDNotInRange - startID,eTokenSepratorNone);
+        mPrimitiveWriter.EndLine();
         
         // write used/free objects
         char entryBuffer[21];
@@ -193,7 +204,13 @@ EStatusCode ObjectsContext::WriteXrefTable(LongFilePositionType& outWritePositio
             {
                 // used object
                 
-                if(objectReference.mObjectWritten)
+                if(objectReference.mObjectStreamID != 0)
+                {
+                    // object streams require an xref stream
+                    status = PDFHummus::eFailure;
+                    TRACE_LOG1("ObjectsContext::WriteXrefTable, Unexpected Failure. Object of ID = %ld was written to an object stream, which cannot be referenced from an xref table",i);
+                }
+                else if(objectReference.mObjectWritten)
                 {
                     SAFE_SPRINTF_2(entryBuffer,21,"%010lld %05ld n\r\n",objectReference.mWritePosition,objectReference.mGenerationNumber);
                     mOutputStream->Write((const IOBasicTypes::Byte *)entryBuffer,20);
@@ -317,50 +334,161 @@ static const std::string scObj = "obj";
 ObjectIDType ObjectsContext::StartNewIndirectObject()
 {
 	ObjectIDType newObjectID = mReferencesRegistry.AllocateNewObjectID();
-	mReferencesRegistry.MarkObjectAsWritten(newObjectID,mOutputStream->GetCurrentPosition());
-	mPrimitiveWriter.WriteInteger(newObjectID);
-	mPrimitiveWriter.WriteInteger(0);
-	mPrimitiveWriter.WriteKeyword(scObj);
-
-	if(IsEncrypting()) {
-		mEncryptionHelper->OnObjectStart((long long)newObjectID, 0);
-	}
-
+	StartIndirectObject(newObjectID,false);
 	return newObjectID;
 }
 
 void ObjectsContext::StartNewIndirectObject(ObjectIDType inObjectID)
 {
-	mReferencesRegistry.MarkObjectAsWritten(inObjectID,mOutputStream->GetCurrentPosition());
-	mPrimitiveWriter.WriteInteger(inObjectID);
-	mPrimitiveWriter.WriteInteger(0);
-	mPrimitiveWriter.WriteKeyword(scObj);
+	StartIndirectObject(inObjectID,false);
+}
 
-	if (IsEncrypting()) {
-		mEncryptionHelper->OnObjectStart((long long)inObjectID, 0);
+void ObjectsContext::StartModifiedIndirectObject(ObjectIDType inObjectID)
+{
+	StartIndirectObject(inObjectID,true);
+}
+
+void ObjectsContext::StartIndirectObject(ObjectIDType inObjectID,bool inIsModified)
+{
+	++mMetrics.GetCounters().ObjectsWritten;
+	if(IsWritingObjectStreams())
+	{
+		// buffer the object content. it'll go to an object stream when ended, or be written directly if it turns out to be a stream
+		mWritingObjectToObjectStream = true;
+		mCurrentObjectID = inObjectID;
+		mCurrentObjectIsModified = inIsModified;
+		mCurrentObjectBuffer.Reset();
+		mOutputStream = &mCurrentObjectBuffer;
+		mPrimitiveWriter.SetStreamForWriting(mOutputStream);
 	}
+	else
+		WriteIndirectObjectHeader(inObjectID,inIsModified);
 }
 
-void ObjectsContext::StartModifiedIndirectObject(ObjectIDType inObjectID)
+void ObjectsContext::WriteIndirectObjectHeader(ObjectIDType inObjectID,bool inIsModified)
 {
-	mReferencesRegistry.MarkObjectAsUpdated(inObjectID,mOutputStream->GetCurrentPosition());
+	if(inIsModified)
+		mReferencesRegistry.MarkObjectAsUpdated(inObjectID,mOutputStream->GetCurrentPosition());
+	else
+		mReferencesRegistry.MarkObjectAsWritten(inObjectID,mOutputStream->GetCurrentPosition());
 	mPrimitiveWriter.WriteInteger(inObjectID);
 	mPrimitiveWriter.WriteInteger(0);
-	mPrimitiveWriter.WriteKeyword(scObj);    
+	mPrimitiveWriter.WriteKeyword(scObj);
 
 	if (IsEncrypting()) {
 		mEncryptionHelper->OnObjectStart((long long)inObjectID, 0);
 	}
 }
 
+void ObjectsContext::WriteCurrentObjectDirectly()
+{
+	// the object that was buffered for an object stream cannot go there (it's a stream). write it directly to the document stream
+	mWritingObjectToObjectStream = false;
+	mOutputStream = mDocumentOutputStream;
+	mPrimitiveWriter.SetStreamForWriting(mOutputStream);
+
+	WriteIndirectObjectHeader(mCurrentObjectID,mCurrentObjectIsModified);
+	std::string objectContent = mCurrentObjectBuffer.ToString();
+	mOutputStream->Write((const IOBasicTypes::Byte*)objectContent.c_str(),objectContent.size());
+	mCurrentObjectBuffer.Reset();
+}
+
 static const std::string scEndObj = "endobj";
 void ObjectsContext::EndIndirectObject()
 {
-	mPrimitiveWriter.WriteKeyword(scEndObj);
+	if(mWritingObjectToObjectStream)
+	{
+		mWritingObjectToObjectStream = false;
+		mOutputStream = mDocumentOutputStream;
+		mPrimitiveWriter.SetStreamForWriting(mOutputStream);
+
+		// add the object to the current object stream, allocating one if required
+		if(0 == mObjectStreamID)
+			mObjectStreamID = mReferencesRegistry.AllocateNewObjectID();
+
+		unsigned long objectStreamIndex = (unsigned long)mObjectStreamEntries.size();
+		if(mCurrentObjectIsModified)
+			mReferencesRegistry.MarkObjectAsUpdatedInObjectStream(mCurrentObjectID,mObjectStreamID,objectStreamIndex);
+		else
+			mReferencesRegistry.MarkObjectAsWrittenInObjectStream(mCurrentObjectID,mObjectStreamID,objectStreamIndex);
+		mObjectStreamEntries.push_back(ObjectIDTypeAndLongFilePositionType(mCurrentObjectID,mObjectStreamBuffer.GetCurrentPosition()));
+
+		std::string objectContent = mCurrentObjectBuffer.ToString();
+		mObjectStreamBuffer.Write((const IOBasicTypes::Byte*)objectContent.c_str(),objectContent.size());
+		mCurrentObjectBuffer.Reset();
+
+		if(mObjectStreamEntries.size() >= MAX_OBJECTS_IN_OBJECT_STREAM)
+			FlushObjectStream();
+	}
+	else
+	{
+		mPrimitiveWriter.WriteKeyword(scEndObj);
+
+		if (IsEncrypting()) {
+			mEncryptionHelper->OnObjectEnd();
+		}
+	}
+}
+
+void ObjectsContext::SetWriteObjectStreams(bool inWriteObjectStreams)
+{
+	mWriteObjectStreams = inWriteObjectStreams;
+}
 
-	if (IsEncrypting()) {
-		mEncryptionHelper->OnObjectEnd();
+bool ObjectsContext::IsWritingObjectStreams()
+{
+	return mWriteObjectStreams && !(mEncryptionHelper && mEncryptionHelper->IsDocumentEncrypted());
+}
+
+static const std::string scType = "Type";
+static const std::string scObjStm = "ObjStm";
+static const std::string scN = "N";
+static const std::string scFirst = "First";
+EStatusCode ObjectsContext::FlushObjectStream()
+{
+	if(0 == mObjectStreamID)
+		return eSuccess;
+
+	// header is made of pairs of object ID and offset (relative to the first object)
+	PrimitiveObjectsWriter headerWriter;
+	OutputStringBufferStream headerStream;
+	headerWriter.SetStreamForWriting(&headerStream);
+
+	ObjectIDTypeAndLongFilePositionTypeList::iterator it = mObjectStreamEntries.begin();
+	for(; it != mObjectStreamEntries.end(); ++it)
+	{
+		headerWriter.WriteInteger(it->first);
+		headerWriter.WriteInteger(it->second);
 	}
+	headerWriter.EndLine();
+	std::string header = headerStream.ToString();
+
+	WriteIndirectObjectHeader(mObjectStreamID,false);
+	DictionaryContext* objectStreamDictionary = StartDictionary();
+	objectStreamDictionary->WriteKey(scType);
+	objectStreamDictionary->WriteNameValue(scObjStm);
+	objectStreamDictionary->WriteKey(scN);
+	objectStreamDictionary->WriteIntegerValue(mObjectStreamEntries.size());
+	objectStreamDictionary->WriteKey(scFirst);
+	objectStreamDictionary->WriteIntegerValue(header.size());
+
+	// object streams are always compressed. that's their point
+	bool compressStreams = mCompressStreams;
+	mCompressStreams = true;
+	PDFStream* objectStream = StartPDFStream(objectStreamDictionary,true,eStreamCategoryXref);
+	mCompressStreams = compressStreams;
+
+	std::string objectsContent = mObjectStreamBuffer.ToString();
+	objectStream->GetWriteStream()->Write((const IOBasicTypes::Byte*)header.c_str(),header.size());
+	objectStream->GetWriteStream()->Write((const IOBasicTypes::Byte*)objectsContent.c_str(),objectsContent.size());
+	EndPDFStream(objectStream);
+	delete objectStream;
+
+	mObjectStreamID = 0;
+	mObjectStreamEntries.clear();
+	mObjectStreamBuffer.Reset();
+
+	return eSuccess;
 }
 
 void ObjectsContext::StartArray()
@@ -378,14 +506,63 @@ void ObjectsContext::SetCompressStreams(bool inCompressStreams)
 	mCompressStreams = inCompressStreams;
 }
 
+bool ObjectsContext::IsCompressingStreams()
+{
+	return mCompressStreams;
+}
+
+void ObjectsContext::SetFlateEncodingThreads(unsigned int inFlateEncodingThreads)
+{
+	mFlateEncodingThreads = inFlateEncodingThreads > 0 ? inFlateEncodingThreads : 1;
+}
+
+unsigned int ObjectsContext::GetFlateEncodingThreads()
+{
+	return mFlateEncodingThreads;
+}
+
+void ObjectsContext::SetDoublePrecision(unsigned int inDoublePrecision)
+{
+	mPrimitiveWriter.SetDoublePrecision(inDoublePrecision);
+}
+
+unsigned int ObjectsContext::GetDoublePrecision()
+{
+	return mPrimitiveWriter.GetDoublePrecision();
+}
+
+void ObjectsContext::SetCompactSerialization(bool inCompactSerialization)
+{
+	mPrimitiveWriter.SetCompactSerialization(inCompactSerialization);
+}
+
+bool ObjectsContext::IsCompactSerialization()
+{
+	return mPrimitiveWriter.IsCompactSerialization();
+}
+
+void ObjectsContext::SetCompressionPolicy(const FlateCompressionPolicy& inCompressionPolicy)
+{
+	mCompressionPolicy = inCompressionPolicy;
+}
+
+const FlateCompressionPolicy& ObjectsContext::GetCompressionPolicy()
+{
+	return mCompressionPolicy;
+}
+
 static const std::string scLength = "Length";
 static const std::string scStream = "stream";
 static const std::string scEndStream = "endstream";
 static const std::string scFilter = "Filter";
 static const std::string scFlateDecode = "FlateDecode";
 
-PDFStream* ObjectsContext::StartPDFStream(DictionaryContext* inStreamDictionary,bool inForceDirectExtentObject)
+PDFStream* ObjectsContext::StartPDFStream(DictionaryContext* inStreamDictionary,bool inForceDirectExtentObject,EStreamCategory inCategory)
 {
+	// streams cannot be placed in object streams
+	if(mWritingObjectToObjectStream)
+		WriteCurrentObjectDirectly();
+
 	// write stream header and allocate PDF stream.
 	// PDF stream will take care of maintaining state for the stream till writing is finished
 
@@ -414,15 +591,18 @@ PDFStream* ObjectsContext::StartPDFStream(DictionaryContext* inStreamDictionary,
         // Write Stream Content
         WriteKeyword(scStream);
         
-        return new PDFStream(mCompressStreams,mOutputStream, mEncryptionHelper,lengthObjectID,mExtender);
+        return new PDFStream(mCompressStreams,mOutputStream, mEncryptionHelper,lengthObjectID,mExtender,mFlateEncodingThreads,mCompressionPolicy.GetParameters(inCategory));
     }
     else
-        return new PDFStream(mCompressStreams,mOutputStream, mEncryptionHelper,streamDictionaryContext,mExtender);
+        return new PDFStream(mCompressStreams,mOutputStream, mEncryptionHelper,streamDictionaryContext,mExtender,mFlateEncodingThreads,mCompressionPolicy.GetParameters(inCategory));
 	
 }
 
 PDFStream* ObjectsContext::StartUnfilteredPDFStream(DictionaryContext* inStreamDictionary)
 {
+	if(mWritingObjectToObjectStream)
+		WriteCurrentObjectDirectly();
+
 	// write stream header and allocate PDF stream.
 	// PDF stream will take care of maintaining state for the stream till writing is finished
 
@@ -448,6 +628,7 @@ void ObjectsContext::EndPDFStream(PDFStream* inStream)
 {
 	// finalize the stream write to end stream context and calculate length
 	inStream->FinalizeStreamWrite();
+	mMetrics.GetCounters().BytesDeflated += inStream->GetDeflatedBytesCount();
 
 	if(inStream->GetExtentObjectID() == 0)
     {
@@ -497,17 +678,37 @@ void ObjectsContext::SetObjectsContextExtender(IObjectsContextExtender* inExtend
 	mExtender = inExtender;
 }
 
+IObjectsContextExtender* ObjectsContext::GetObjectsContextExtender()
+{
+	return mExtender;
+}
+
+PDFMetrics& ObjectsContext::GetMetrics()
+{
+	return mMetrics;
+}
+
 std::string ObjectsContext::GenerateSubsetFontPrefix()
 {
 	return mSubsetFontsNamesSequance.GetNextValue();
 }
 
+const UppercaseSequance& ObjectsContext::GetSubsetFontsNamesSequance()
+{
+	return mSubsetFontsNamesSequance;
+}
+
 EStatusCode ObjectsContext::WriteState(ObjectsContext* inStateWriter,ObjectIDType inObjectID)
 {
 	EStatusCode status;
 		
 	do
 	{
+		// pending object stream objects are not kept in the state. write them now, so the registry is complete
+		status = FlushObjectStream();
+		if(status != PDFHummus::eSuccess)
+			break;
+
 		inStateWriter->StartNewIndirectObject(inObjectID);
 
 		ObjectIDType referencesRegistryObjectID = inStateWriter->GetInDirectObjectsRegistry().AllocateNewObjectID();
@@ -524,6 +725,30 @@ EStatusCode ObjectsContext::WriteState(ObjectsContext* inStateWriter,ObjectIDTyp
 		objectsContextDict->WriteKey("mCompressStreams");
 		objectsContextDict->WriteBooleanValue(mCompressStreams);
 
+		objectsContextDict->WriteKey("mWriteObjectStreams");
+		objectsContextDict->WriteBooleanValue(mWriteObjectStreams);
+
+		objectsContextDict->WriteKey("mFlateEncodingThreads");
+		objectsContextDict->WriteIntegerValue(mFlateEncodingThreads);
+
+		objectsContextDict->WriteKey("mDoublePrecision");
+		objectsContextDict->WriteIntegerValue(mPrimitiveWriter.GetDoublePrecision());
+
+		objectsContextDict->WriteKey("mCompactSerialization");
+		objectsContextDict->WriteBooleanValue(mPrimitiveWriter.IsCompactSerialization());
+
+		// compression policy, as level, strategy and memory level per stream category
+		objectsContextDict->WriteKey("mCompressionPolicy");
+		inStateWriter->StartArray();
+		for(int i = 0; i < eStreamCategoryCount; ++i)
+		{
+			const FlateCompressionParameters& parameters = mCompressionPolicy.GetParameters((EStreamCategory)i);
+			inStateWriter->WriteInteger(parameters.Level);
+			inStateWriter->WriteInteger(parameters.Strategy);
+			inStateWriter->WriteInteger(parameters.MemLevel);
+		}
+		inStateWriter->EndArray(eTokenSeparatorEndLine);
+
 		objectsContextDict->WriteKey("mSubsetFontsNamesSequance");
 		objectsContextDict->WriteNewObjectReferenceValue(subsetFontsNameSequanceID);
 
@@ -562,6 +787,32 @@ EStatusCode ObjectsContext::ReadState(PDFParser* inStateReader,ObjectIDType inOb
 	PDFObjectCastPtr<PDFBoolean> compressStreams(objectsContext->QueryDirectObject("mCompressStreams"));
 	mCompressStreams = compressStreams->GetValue();
 
+	PDFObjectCastPtr<PDFBoolean> writeObjectStreams(objectsContext->QueryDirectObject("mWriteObjectStreams"));
+	mWriteObjectStreams = writeObjectStreams.GetPtr() ? writeObjectStreams->GetValue() : false;
+
+	PDFObjectCastPtr<PDFInteger> flateEncodingThreads(objectsContext->QueryDirectObject("mFlateEncodingThreads"));
+	mFlateEncodingThreads = (flateEncodingThreads.GetPtr() && flateEncodingThreads->GetValue() > 0) ? (unsigned int)flateEncodingThreads->GetValue() : 1;
+
+	PDFObjectCastPtr<PDFInteger> doublePrecision(objectsContext->QueryDirectObject("mDoublePrecision"));
+	mPrimitiveWriter.SetDoublePrecision((doublePrecision.GetPtr() && doublePrecision->GetValue() >= 0) ? (unsigned int)doublePrecision->GetValue() : DEFAULT_DOUBLE_PRECISION);
+
+	PDFObjectCastPtr<PDFBoolean> compactSerialization(objectsContext->QueryDirectObject("mCompactSerialization"));
+	mPrimitiveWriter.SetCompactSerialization(compactSerialization.GetPtr() ? compactSerialization->GetValue() : false);
+
+	mCompressionPolicy = FlateCompressionPolicy();
+	PDFObjectCastPtr<PDFArray> compressionPolicy(objectsContext->QueryDirectObject("mCompressionPolicy"));
+	if(compressionPolicy.GetPtr() && compressionPolicy->GetLength() == eStreamCategoryCount*3)
+	{
+		for(int i = 0; i < eStreamCategoryCount; ++i)
+		{
+			PDFObjectCastPtr<PDFInteger> level(compressionPolicy->QueryObject(i*3));
+			PDFObjectCastPtr<PDFInteger> strategy(compressionPolicy->QueryObject(i*3 + 1));
+			PDFObjectCastPtr<PDFInteger> memLevel(compressionPolicy->QueryObject(i*3 + 2));
+			if(level.GetPtr() && strategy.GetPtr() && memLevel.GetPtr())
+				mCompressionPolicy.SetParameters((EStreamCategory)i,FlateCompressionParameters((int)level->GetValue(),(int)strategy->GetValue(),(int)memLevel->GetValue()));
+		}
+	}
+
 	PDFObjectCastPtr<PDFDictionary> subsetFontsNamesSequance(inStateReader->QueryDictionaryObject(objectsContext.GetPtr(),"mSubsetFontsNamesSequance"));
 	PDFObjectCastPtr<PDFLiteralString> sequanceString(subsetFontsNamesSequance->QueryDirectObject("mSequanceString"));
 	mSubsetFontsNamesSequance.SetSequanceString(sequanceString->GetValue());
@@ -575,7 +826,18 @@ EStatusCode ObjectsContext::ReadState(PDFParser* inStateReader,ObjectIDType inOb
 void ObjectsContext::Cleanup()
 {
 	mOutputStream = NULL;
+	mDocumentOutputStream = NULL;
 	mCompressStreams = true;
+	mFlateEncodingThreads = 1;
+	mPrimitiveWriter.SetDoublePrecision(DEFAULT_DOUBLE_PRECISION);
+	mPrimitiveWriter.SetCompactSerialization(false);
+	mCompressionPolicy = FlateCompressionPolicy();
+	mWriteObjectStreams = false;
+	mWritingObjectToObjectStream = false;
+	mCurrentObjectBuffer.Reset();
+	mObjectStreamID = 0;
+	mObjectStreamEntries.clear();
+	mObjectStreamBuffer.Reset();
 	mExtender = NULL;
 	mEncryptionHelper = NULL;
 
@@ -639,7 +901,7 @@ EStatusCode ObjectsContext::WriteXrefStream(DictionaryContext* inDictionaryConte
     EndLine();
     
     // start the xref stream itself
-    PDFStream* aStream = StartPDFStream(inDictionaryContext,true);
+    PDFStream* aStream = StartPDFStream(inDictionaryContext,true,eStreamCategoryXref);
     
     // now write the table data itself
     EStatusCode status = eSuccess;
@@ -658,7 +920,14 @@ EStatusCode ObjectsContext::WriteXrefStream(DictionaryContext* inDictionaryConte
             {
                 // used object
                 
-                if(objectReference.mObjectWritten)
+                if(objectReference.mObjectWritten && objectReference.mObjectStreamID != 0)
+                {
+                    // compressed object
+                    WriteXrefNumber(aStream->GetWriteStream(),2,typeSize);
+                    WriteXrefNumber(aStream->GetWriteStream(),objectReference.mObjectStreamID,locationSize);
+                    WriteXrefNumber(aStream->GetWriteStream(),objectReference.mObjectStreamIndex,generationSize);
+                }
+                else if(objectReference.mObjectWritten)
                 {
                     WriteXrefNumber(aStream->GetWriteStream(),1,typeSize);
                     WriteXrefNumber(aStream->GetWriteStream(),objectReference.mWritePosition,locationSize);
@@ -703,6 +972,7 @@ EStatusCode ObjectsContext::WriteXrefStream(DictionaryContext* inDictionaryConte
     } 
     while (false);
 
+    delete aStream;
     return status;
 }
 
@@ -25,8 +25,12 @@
 #include "ETokenSeparator.h"
 #include "PrimitiveObjectsWriter.h"
 #include "UppercaseSequance.h"
+#include "OutputStringBufferStream.h"
+#include "FlateCompressionPolicy.h"
+#include "PDFMetrics.h"
 #include <string>
 #include <list>
+#include <utility>
 
 
 
@@ -39,6 +43,11 @@ class PDFParser;
 class EncryptionHelper;
 
 typedef std::list<DictionaryContext*> DictionaryContextList;
+typedef std::pair<ObjectIDType,LongFilePositionType> ObjectIDTypeAndLongFilePositionType;
+typedef std::list<ObjectIDTypeAndLongFilePositionType> ObjectIDTypeAndLongFilePositionTypeList;
+
+// maximum number of objects packed into a single object stream
+#define MAX_OBJECTS_IN_OBJECT_STREAM 100
 
 class ObjectsContext
 {
@@ -55,7 +64,7 @@ public:
 
 	// pre 1.5 xref writing
 	PDFHummus::EStatusCode WriteXrefTable(LongFilePositionType& outWritePosition);
-    // post 1.5 xref writing (only used now for modified files)
+    // post 1.5 xref writing (used for modified files that use xref streams, or when writing object streams)
     PDFHummus::EStatusCode WriteXrefStream(DictionaryContext* inDictionaryContext);
     
 	// Free Context, for direct writing to output stream
@@ -114,22 +123,58 @@ public:
 
 	// Sets whether streams created by the objects context will be compressed (with flate) or not
 	void SetCompressStreams(bool inCompressStreams);
+	bool IsCompressingStreams();
+
+	// Sets the number of threads used for flate compressing streams. 1 (the default) compresses on the calling thread. 
+	// with more, streams larger than PARALLEL_FLATE_CHUNK_SIZE are split to chunks that are compressed in parallel (see OutputParallelFlateEncodeStream)
+	void SetFlateEncodingThreads(unsigned int inFlateEncodingThreads);
+	unsigned int GetFlateEncodingThreads();
+
+	// Sets the number of decimal places for real numbers written by the objects context [and content contexts started afterwards].
+	// default is DEFAULT_DOUBLE_PRECISION. see PrimitiveObjectsWriter::SetDoublePrecision
+	void SetDoublePrecision(unsigned int inDoublePrecision);
+	unsigned int GetDoublePrecision();
+
+	// Sets compact serialization for objects written by the objects context [and content contexts started afterwards]. dictionaries
+	// are written without indentation and values without line ends. see PrimitiveObjectsWriter::SetCompactSerialization
+	void SetCompactSerialization(bool inCompactSerialization);
+	bool IsCompactSerialization();
+
+	// Sets flate compression parameters per stream category. see FlateCompressionPolicy
+	void SetCompressionPolicy(const FlateCompressionPolicy& inCompressionPolicy);
+	const FlateCompressionPolicy& GetCompressionPolicy();
+
+	// Sets whether indirect objects that are not streams will be packed into object streams (PDF 1.5 and up), 
+	// instead of being written as top level objects. when set, the xref must be written as an xref stream.
+	// objects are not packed into object streams in encrypted documents.
+	void SetWriteObjectStreams(bool inWriteObjectStreams);
+	bool IsWritingObjectStreams();
+	// Write the object stream currently being filled, if any. happens automatically when an object stream is full. 
+	// call this prior to writing the xref
+	PDFHummus::EStatusCode FlushObjectStream();
 
 	// Create PDF stream and write it's header. note that stream are written with indirect object for Length, to allow one pass writing.
 	// inStreamDictionary can be passed in order to include stream generic information in an already written stream dictionary
 	// that is type specific. [the method will take care of closing the dictionary.
-	PDFStream* StartPDFStream(DictionaryContext* inStreamDictionary=NULL,bool inForceDirectExtentObject = false);
+	// inCategory selects the compression parameters for the stream, from the compression policy (see SetCompressionPolicy)
+	PDFStream* StartPDFStream(DictionaryContext* inStreamDictionary=NULL,bool inForceDirectExtentObject = false,EStreamCategory inCategory = eStreamCategoryGeneric);
 	// same as StartPDFStream but forces the stream to create an unfiltered stream
 	PDFStream* StartUnfilteredPDFStream(DictionaryContext* inStreamDictionary=NULL);
 	void EndPDFStream(PDFStream* inStream);
 
+	// counters and phase timings of the document written. see PDFMetrics.h. not reset by Cleanup, so they can be read after the document ends
+	PDFMetrics& GetMetrics();
+
 	// Extensibility
 	void SetObjectsContextExtender(IObjectsContextExtender* inExtender);
+	IObjectsContextExtender* GetObjectsContextExtender();
 	
 
 	// as the obly common context around...i'm using the objects context to create
 	// subset fonts prefixes. might want to consider a more relevant object...
 	std::string GenerateSubsetFontPrefix();
+	// the subset fonts prefixes sequance. GenerateSubsetFontPrefix returns the value following its current value
+	const UppercaseSequance& GetSubsetFontsNamesSequance();
 
     // setup for modified file workflow
     void SetupModifiedFile(PDFParser* inModifiedFileParser);
@@ -140,14 +185,32 @@ public:
 private:
 	IObjectsContextExtender* mExtender;
 	IByteWriterWithPosition* mOutputStream;
+	// the document output stream. same as mOutputStream, unless currently writing an object that goes to an object stream 
+	IByteWriterWithPosition* mDocumentOutputStream;
 	IndirectObjectsReferenceRegistry mReferencesRegistry;
 	PrimitiveObjectsWriter mPrimitiveWriter;
 	bool mCompressStreams;
+	unsigned int mFlateEncodingThreads;
+	FlateCompressionPolicy mCompressionPolicy;
 	UppercaseSequance mSubsetFontsNamesSequance;
 	EncryptionHelper* mEncryptionHelper;
+	PDFMetrics mMetrics;
 
 	DictionaryContextList mDictionaryStack;
 
+	// object streams writing
+	bool mWriteObjectStreams;
+	bool mWritingObjectToObjectStream;
+	ObjectIDType mCurrentObjectID;
+	bool mCurrentObjectIsModified;
+	OutputStringBufferStream mCurrentObjectBuffer;
+	ObjectIDType mObjectStreamID;
+	ObjectIDTypeAndLongFilePositionTypeList mObjectStreamEntries;
+	OutputStringBufferStream mObjectStreamBuffer;
+
+	void StartIndirectObject(ObjectIDType inObjectID,bool inIsModified);
+	void WriteIndirectObjectHeader(ObjectIDType inObjectID,bool inIsModified);
+	void WriteCurrentObjectDirectly();
 	void WritePDFStreamEndWithoutExtent();
 	void WritePDFStreamExtent(PDFStream* inStream);
     void WriteXrefNumber(IByteWriter* inStream,LongFilePositionType inElement, size_t inElementSize);
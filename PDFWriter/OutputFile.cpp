@@ -22,6 +22,9 @@
 #include "OutputBufferedStream.h"
 #include "OutputFileStream.h"
 #include "Trace.h"
+#include "SafeBufferMacrosDefs.h"
+
+#include <errno.h>
 
 using namespace PDFHummus;
 
@@ -64,6 +67,47 @@ EStatusCode OutputFile::OpenFile(const std::string& inFilePath,bool inAppend)
 	return status;
 }
 
+EStatusCode OutputFile::OpenUniqueFile(const std::string& inFilePathPrefix)
+{
+	// shared between writers, so that files created by this process are not retried. exclusive creation
+	// keeps it correct when writers (or other processes) race on a name
+	static unsigned long sUniqueFileIndex = 0;
+	const unsigned long cMaxAttempts = 1000;
+
+	EStatusCode status = CloseFile();
+	if(status != PDFHummus::eSuccess)
+	{
+		TRACE_LOG1("OutputFile::OpenUniqueFile, Unexpected Failure. Couldn't close previously open file - %s",mFilePath.c_str());
+		return status;
+	}
+
+	OutputFileStream* outputFileStream = new OutputFileStream();
+	std::string filePath;
+	status = PDFHummus::eFailure;
+	for(unsigned long i = 0; i < cMaxAttempts && status != PDFHummus::eSuccess; ++i)
+	{
+		char buffer[32];
+		SAFE_SPRINTF_1(buffer,32,".%lu",sUniqueFileIndex++);
+		filePath = inFilePathPrefix + buffer;
+		errno = 0;
+		status = outputFileStream->OpenNew(filePath);
+		if(status != PDFHummus::eSuccess && errno != EEXIST)
+			break;
+	}
+
+	if(status != PDFHummus::eSuccess)
+	{
+		TRACE_LOG1("OutputFile::OpenUniqueFile, Unexpected Failure. Cannot create a new file for writing - %s",filePath.c_str());
+		delete outputFileStream;
+		return status;
+	}
+
+	mOutputStream = new OutputBufferedStream(outputFileStream);
+	mFileStream = outputFileStream;
+	mFilePath = filePath;
+	return status;
+}
+
 EStatusCode OutputFile::CloseFile()
 {
 	if(NULL == mOutputStream)
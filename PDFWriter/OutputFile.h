@@ -36,6 +36,9 @@ public:
 	~OutputFile(void);
 
 	PDFHummus::EStatusCode OpenFile(const std::string& inFilePath, bool inAppend = false);
+	// creates a new file whose path starts with inFilePathPrefix and that did not exist before, for temporary files.
+	// the chosen path is available through GetFilePath
+	PDFHummus::EStatusCode OpenUniqueFile(const std::string& inFilePathPrefix);
 	PDFHummus::EStatusCode CloseFile();
 
 	IByteWriterWithPosition* GetOutputStream(); // returns buffered output stream
@@ -55,6 +55,14 @@ EStatusCode OutputFileStream::Open(const std::string& inFilePath,bool inAppend)
 	return PDFHummus::eSuccess;
 };
 
+EStatusCode OutputFileStream::OpenNew(const std::string& inFilePath)
+{
+	// "x" makes the creation exclusive, so an existing file is never truncated
+	SAFE_FOPEN(mStream,inFilePath.c_str(),"wbx")
+
+	return mStream ? PDFHummus::eSuccess:PDFHummus::eFailure;
+}
+
 EStatusCode OutputFileStream::Close()
 {
 	EStatusCode result = fclose(mStream) == 0 ? PDFHummus::eSuccess:PDFHummus::eFailure;
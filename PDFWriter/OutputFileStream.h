@@ -42,6 +42,8 @@ public:
 
 	// input file path is in UTF8
 	PDFHummus::EStatusCode Open(const std::string& inFilePath,bool inAppend = false);
+	// input file path is in UTF8. creates a new file, failing if a file by this path already exists
+	PDFHummus::EStatusCode OpenNew(const std::string& inFilePath);
 	PDFHummus::EStatusCode Close();
 
 	// IByteWriter implementation
@@ -32,6 +32,7 @@ OutputFlateEncodeStream::OutputFlateEncodeStream(void)
 	mZLibState = new z_stream;
 	mTargetStream = NULL;
 	mCurrentlyEncoding = false;
+	mEncodedBytesCount = 0;
 }
 
 OutputFlateEncodeStream::~OutputFlateEncodeStream(void)
@@ -84,6 +85,7 @@ OutputFlateEncodeStream::OutputFlateEncodeStream(IByteWriterWithPosition* inTarg
 	mZLibState = new z_stream;
 	mTargetStream = NULL;
 	mCurrentlyEncoding = false;
+	mEncodedBytesCount = 0;
 
 	Assign(inTargetWriter,inInitiallyOn);
 }
@@ -94,7 +96,12 @@ void OutputFlateEncodeStream::StartEncoding()
     mZLibState->zfree = Z_NULL;
     mZLibState->opaque = Z_NULL;
 
-    int deflateStatus = deflateInit(mZLibState, Z_DEFAULT_COMPRESSION);
+    int deflateStatus = deflateInit2(mZLibState,
+									mCompressionParameters.Level,
+									Z_DEFLATED,
+									MAX_WBITS,
+									mCompressionParameters.MemLevel,
+									mCompressionParameters.Strategy);
     if (deflateStatus != Z_OK)
 		TRACE_LOG1("OutputFlateEncodeStream::StartEncoding, Unexpected failure in initializating flate library. status code = %d",deflateStatus);
 	else
@@ -102,11 +109,18 @@ void OutputFlateEncodeStream::StartEncoding()
 }
 
 
+void OutputFlateEncodeStream::SetCompressionParameters(const FlateCompressionParameters& inParameters)
+{
+	mCompressionParameters = inParameters;
+}
+
 void OutputFlateEncodeStream::Assign(IByteWriterWithPosition* inWriter,bool inInitiallyOn)
 {	
 	if(mCurrentlyEncoding)
 		FinalizeEncoding();
 	mTargetStream = inWriter;
+	if(mTargetStream)
+		mEncodedBytesCount = 0;
 	if(inInitiallyOn && mTargetStream)
 		StartEncoding();
 
@@ -157,11 +171,19 @@ LongBufferSizeType OutputFlateEncodeStream::EncodeBufferAndWrite(const IOBasicTy
 	}while(mZLibState->avail_out == 0); // waiting for either no more writes
 
 	if(Z_OK == deflateResult)
+	{
+		mEncodedBytesCount += inSize;
 		return inSize;
+	}
 	else
 		return 0;
 }
 
+LongFilePositionType OutputFlateEncodeStream::GetEncodedBytesCount()
+{
+	return mEncodedBytesCount;
+}
+
 LongFilePositionType OutputFlateEncodeStream::GetCurrentPosition()
 {
 	if(mTargetStream)
@@ -20,6 +20,7 @@
 */
 #pragma once
 #include "IByteWriterWithPosition.h"
+#include "FlateCompressionPolicy.h"
 
 struct z_stream_s;
 typedef z_stream_s z_stream;
@@ -42,11 +43,19 @@ public:
 	void TurnOnEncoding();
 	void TurnOffEncoding();
 
+	// compression level, strategy and memory level. takes effect from the next time encoding starts (Assign, or TurnOnEncoding)
+	void SetCompressionParameters(const FlateCompressionParameters& inParameters);
+
+	// number of bytes encoded since last assigned a writer. still available after Assign(NULL)
+	IOBasicTypes::LongFilePositionType GetEncodedBytesCount();
+
 private:
 	IOBasicTypes::Byte* mBuffer;
 	IByteWriterWithPosition* mTargetStream;
 	bool mCurrentlyEncoding;
 	z_stream* mZLibState;
+	FlateCompressionParameters mCompressionParameters;
+	IOBasicTypes::LongFilePositionType mEncodedBytesCount;
 
 	void FinalizeEncoding();
 	void StartEncoding();
@@ -0,0 +1,493 @@
+/*
+   Source File : OutputParallelFlateEncodeStream.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "OutputParallelFlateEncodeStream.h"
+#include "Trace.h"
+#include "ThreadsLock.h"
+#include "ThreadsCondition.h"
+#include "WorkerThread.h"
+#include "zlib.h"
+
+#include <vector>
+#include <memory.h>
+
+using namespace IOBasicTypes;
+using namespace PDFHummus;
+
+struct ParallelFlateChunkTask
+{
+	const FlateCompressionParameters* mParameters;
+	const Byte* mInput;
+	LongBufferSizeType mInputSize;
+	const Byte* mDictionary;
+	LongBufferSizeType mDictionarySize;
+	bool mIsLast;
+
+	std::vector<Byte> mOutput;
+	LongBufferSizeType mOutputSize;
+	unsigned long mAdler32;
+	bool mSucceeded;
+};
+
+// compress a chunk as raw deflate data. runs on worker threads, so no logging here
+static void EncodeChunk(ParallelFlateChunkTask* inTask)
+{
+	z_stream zlibState;
+	int flush = inTask->mIsLast ? Z_FINISH : Z_SYNC_FLUSH;
+	int deflateResult;
+
+	inTask->mSucceeded = false;
+	inTask->mOutputSize = 0;
+	inTask->mAdler32 = adler32(adler32(0L,Z_NULL,0),inTask->mInput,(uInt)inTask->mInputSize);
+
+	zlibState.zalloc = Z_NULL;
+	zlibState.zfree = Z_NULL;
+	zlibState.opaque = Z_NULL;
+
+	if(deflateInit2(&zlibState,inTask->mParameters->Level,Z_DEFLATED,-MAX_WBITS,inTask->mParameters->MemLevel,inTask->mParameters->Strategy) != Z_OK)
+		return;
+
+	do
+	{
+		if(inTask->mDictionarySize > 0 && 
+			deflateSetDictionary(&zlibState,inTask->mDictionary,(uInt)inTask->mDictionarySize) != Z_OK)
+			break;
+
+		// deflateBound covers the compressed data. add some room for the flush markers
+		inTask->mOutput.resize(deflateBound(&zlibState,(uLong)inTask->mInputSize) + 64);
+
+		zlibState.next_in = (Bytef*)inTask->mInput;
+		zlibState.avail_in = (uInt)inTask->mInputSize;
+
+		do
+		{
+			if(inTask->mOutputSize == inTask->mOutput.size())
+				inTask->mOutput.resize(inTask->mOutput.size()*2);
+			zlibState.next_out = &(inTask->mOutput[0]) + inTask->mOutputSize;
+			zlibState.avail_out = (uInt)(inTask->mOutput.size() - inTask->mOutputSize);
+			deflateResult = deflate(&zlibState,flush);
+			inTask->mOutputSize = inTask->mOutput.size() - zlibState.avail_out;
+		}while(Z_OK == deflateResult && (Z_FINISH == flush || 0 == zlibState.avail_out));
+
+		// sync flush is done when output space is left. finish is done when reaching the stream end
+		inTask->mSucceeded = (Z_FINISH == flush) ? (Z_STREAM_END == deflateResult) : (Z_OK == deflateResult || Z_BUF_ERROR == deflateResult);
+	}while(false);
+
+	deflateEnd(&zlibState);
+}
+
+class ParallelFlateWorkers;
+
+struct ParallelFlateWorkerStart
+{
+	ParallelFlateWorkers* mWorkers;
+	size_t mWorkerIndex;
+};
+
+/*
+	Worker threads for compressing chunks. started on the first parallel batch, and kept for the life of the stream, 
+	so that batches (and streams reusing the encoder) don't pay for creating threads. each worker runs at most one task per batch.
+*/
+class ParallelFlateWorkers
+{
+public:
+	ParallelFlateWorkers(size_t inWorkersCount);
+	~ParallelFlateWorkers(void);
+
+	// number of workers requested on construction. actual workers may be less, if threads could not be created
+	size_t GetRequestedWorkersCount();
+
+	// run the tasks, the first ones on the workers, and the rest on the calling thread. returns when all tasks are done
+	void Run(std::vector<ParallelFlateChunkTask>& inTasks);
+
+	// worker threads loop
+	void WorkerLoop(size_t inWorkerIndex);
+
+private:
+	size_t mRequestedWorkersCount;
+	size_t mStartedWorkersCount;
+	std::vector<ParallelFlateChunkTask*> mAssignedTasks; // per worker, NULL when idle
+	size_t mPendingTasksCount;
+	bool mQuit;
+
+	ThreadsLock mLock;
+	ThreadsCondition mWorkReady;
+	ThreadsCondition mWorkDone;
+	std::vector<ParallelFlateWorkerStart> mStarts;
+	WorkerThread* mThreads;
+};
+
+static void ParallelFlateWorkerThreadProc(void* inStart)
+{
+	ParallelFlateWorkerStart* start = (ParallelFlateWorkerStart*)inStart;
+	start->mWorkers->WorkerLoop(start->mWorkerIndex);
+}
+
+ParallelFlateWorkers::ParallelFlateWorkers(size_t inWorkersCount)
+{
+	mRequestedWorkersCount = inWorkersCount;
+	mStartedWorkersCount = 0;
+	mAssignedTasks.resize(inWorkersCount,NULL);
+	mPendingTasksCount = 0;
+	mQuit = false;
+	mStarts.resize(inWorkersCount);
+	mThreads = inWorkersCount > 0 ? new WorkerThread[inWorkersCount] : NULL;
+
+	// workers are started in order, so the started ones are always the first. on failure just use less workers
+	for(size_t i = 0; i < inWorkersCount; ++i)
+	{
+		mStarts[i].mWorkers = this;
+		mStarts[i].mWorkerIndex = i;
+		if(!mThreads[i].Start(ParallelFlateWorkerThreadProc,&(mStarts[i])))
+			break;
+		++mStartedWorkersCount;
+	}
+}
+
+ParallelFlateWorkers::~ParallelFlateWorkers(void)
+{
+	mLock.Lock();
+	mQuit = true;
+	mWorkReady.NotifyAll();
+	mLock.Unlock();
+
+	// deleting the threads joins them
+	delete[] mThreads;
+}
+
+size_t ParallelFlateWorkers::GetRequestedWorkersCount()
+{
+	return mRequestedWorkersCount;
+}
+
+void ParallelFlateWorkers::Run(std::vector<ParallelFlateChunkTask>& inTasks)
+{
+	// keep at least one task for the calling thread
+	size_t workerTasksCount = inTasks.size() - 1;
+	if(workerTasksCount > mStartedWorkersCount)
+		workerTasksCount = mStartedWorkersCount;
+
+	if(workerTasksCount > 0)
+	{
+		mLock.Lock();
+		for(size_t i = 0; i < workerTasksCount; ++i)
+			mAssignedTasks[i] = &(inTasks[i]);
+		mPendingTasksCount = workerTasksCount;
+		mWorkReady.NotifyAll();
+		mLock.Unlock();
+	}
+
+	for(size_t i = workerTasksCount; i < inTasks.size(); ++i)
+		EncodeChunk(&(inTasks[i]));
+
+	if(workerTasksCount > 0)
+	{
+		mLock.Lock();
+		while(mPendingTasksCount > 0)
+			mWorkDone.Wait(mLock);
+		mLock.Unlock();
+	}
+}
+
+void ParallelFlateWorkers::WorkerLoop(size_t inWorkerIndex)
+{
+	mLock.Lock();
+	for(;;)
+	{
+		while(!mQuit && !mAssignedTasks[inWorkerIndex])
+			mWorkReady.Wait(mLock);
+		if(!mAssignedTasks[inWorkerIndex])
+			break;
+
+		ParallelFlateChunkTask* task = mAssignedTasks[inWorkerIndex];
+		mLock.Unlock();
+		EncodeChunk(task);
+		mLock.Lock();
+
+		mAssignedTasks[inWorkerIndex] = NULL;
+		if(0 == --mPendingTasksCount)
+			mWorkDone.NotifyOne();
+	}
+	mLock.Unlock();
+}
+
+OutputParallelFlateEncodeStream::OutputParallelFlateEncodeStream(void)
+{
+	mTargetStream = NULL;
+	mThreadsCount = 1;
+	mBatchBuffer = NULL;
+	mBatchBufferSize = 0;
+	mBatchSize = 0;
+	mDictionary = NULL;
+	mDictionarySize = 0;
+	mStartedChunkedEncoding = false;
+	mAdler32 = 0;
+	mFailed = false;
+	mEncodedBytesCount = 0;
+	mWorkers = NULL;
+}
+
+OutputParallelFlateEncodeStream::~OutputParallelFlateEncodeStream(void)
+{
+	if(mTargetStream)
+	{
+		FinalizeEncoding();
+		delete mTargetStream;
+	}
+	Cleanup();
+	delete mWorkers;
+}
+
+void OutputParallelFlateEncodeStream::Cleanup()
+{
+	delete[] mBatchBuffer;
+	mBatchBuffer = NULL;
+	mBatchBufferSize = 0;
+	mBatchSize = 0;
+	delete[] mDictionary;
+	mDictionary = NULL;
+	mDictionarySize = 0;
+	mStartedChunkedEncoding = false;
+	mFailed = false;
+}
+
+void OutputParallelFlateEncodeStream::Assign(IByteWriterWithPosition* inWriter,unsigned int inThreadsCount,const FlateCompressionParameters& inParameters)
+{
+	if(mTargetStream)
+		FinalizeEncoding();
+	Cleanup();
+
+	mTargetStream = inWriter;
+	mThreadsCount = inThreadsCount > 0 ? inThreadsCount : 1;
+	mCompressionParameters = inParameters;
+	if(mTargetStream)
+	{
+		mBatchBufferSize = mThreadsCount * PARALLEL_FLATE_CHUNK_SIZE;
+		mBatchBuffer = new Byte[mBatchBufferSize];
+		mAdler32 = adler32(0L,Z_NULL,0);
+		mEncodedBytesCount = 0;
+	}
+}
+
+LongBufferSizeType OutputParallelFlateEncodeStream::Write(const Byte* inBuffer,LongBufferSizeType inSize)
+{
+	if(!mTargetStream || mFailed)
+		return 0;
+
+	LongBufferSizeType written = 0;
+
+	while(written < inSize)
+	{
+		LongBufferSizeType amountToCopy = mBatchBufferSize - mBatchSize;
+		if(amountToCopy > inSize - written)
+			amountToCopy = inSize - written;
+		memcpy(mBatchBuffer + mBatchSize,inBuffer + written,amountToCopy);
+		mBatchSize += amountToCopy;
+		written += amountToCopy;
+		mEncodedBytesCount += amountToCopy;
+
+		// compress only when there's more input, so the last batch is always encoded by FinalizeEncoding
+		if(mBatchSize == mBatchBufferSize && written < inSize)
+		{
+			if(EncodeBatch(false) != eSuccess)
+				return written;
+		}
+	}
+
+	return written;
+}
+
+LongFilePositionType OutputParallelFlateEncodeStream::GetEncodedBytesCount()
+{
+	return mEncodedBytesCount;
+}
+
+LongFilePositionType OutputParallelFlateEncodeStream::GetCurrentPosition()
+{
+	if(mTargetStream)
+		return mTargetStream->GetCurrentPosition();
+	else
+		return 0;
+}
+
+void OutputParallelFlateEncodeStream::FinalizeEncoding()
+{
+	if(mFailed)
+		return;
+
+	if(mStartedChunkedEncoding || mBatchSize > PARALLEL_FLATE_CHUNK_SIZE)
+		EncodeBatch(true);
+	else
+		EncodeSingleChunk();
+}
+
+EStatusCode OutputParallelFlateEncodeStream::EncodeSingleChunk()
+{
+	// small stream. regular zlib encoding
+	z_stream zlibState;
+	std::vector<Byte> output;
+	EStatusCode status = eSuccess;
+
+	zlibState.zalloc = Z_NULL;
+	zlibState.zfree = Z_NULL;
+	zlibState.opaque = Z_NULL;
+
+	int deflateResult = deflateInit2(&zlibState,mCompressionParameters.Level,Z_DEFLATED,MAX_WBITS,mCompressionParameters.MemLevel,mCompressionParameters.Strategy);
+	if(deflateResult != Z_OK)
+	{
+		TRACE_LOG1("OutputParallelFlateEncodeStream::EncodeSingleChunk, Unexpected failure in initializating flate library. status code = %d",deflateResult);
+		mFailed = true;
+		return eFailure;
+	}
+
+	output.resize(deflateBound(&zlibState,(uLong)mBatchSize));
+	zlibState.next_in = mBatchBuffer;
+	zlibState.avail_in = (uInt)mBatchSize;
+	zlibState.next_out = &(output[0]);
+	zlibState.avail_out = (uInt)output.size();
+
+	deflateResult = deflate(&zlibState,Z_FINISH);
+	if(deflateResult != Z_STREAM_END)
+	{
+		TRACE_LOG1("OutputParallelFlateEncodeStream::EncodeSingleChunk, failed to encode. returned error code = %d",deflateResult);
+		status = eFailure;
+	}
+	else
+		status = WriteBytes(&(output[0]),output.size() - zlibState.avail_out);
+
+	deflateEnd(&zlibState);
+	mBatchSize = 0;
+	if(status != eSuccess)
+		mFailed = true;
+	return status;
+}
+
+EStatusCode OutputParallelFlateEncodeStream::EncodeBatch(bool inIsLast)
+{
+	EStatusCode status = eSuccess;
+
+	do
+	{
+		if(!mStartedChunkedEncoding)
+		{
+			// zlib header, same as deflate writes it for a 32K window and the compression parameters
+			int level = Z_DEFAULT_COMPRESSION == mCompressionParameters.Level ? 6 : mCompressionParameters.Level;
+			int levelFlags = (mCompressionParameters.Strategy >= Z_HUFFMAN_ONLY || level < 2) ? 0 : (level < 6 ? 1 : (6 == level ? 2 : 3));
+			unsigned int header = ((Z_DEFLATED + ((MAX_WBITS - 8) << 4)) << 8) | (levelFlags << 6);
+			header += 31 - (header % 31);
+			Byte headerBytes[2] = {(Byte)(header >> 8),(Byte)(header & 0xff)};
+
+			status = WriteBytes(headerBytes,2);
+			if(status != eSuccess)
+				break;
+			mStartedChunkedEncoding = true;
+		}
+
+		// split to chunks. there's always at least one chunk, so the last batch gets to finish the deflate stream even if empty
+		size_t chunksCount = (size_t)((mBatchSize + PARALLEL_FLATE_CHUNK_SIZE - 1) / PARALLEL_FLATE_CHUNK_SIZE);
+		if(0 == chunksCount)
+			chunksCount = 1;
+		std::vector<ParallelFlateChunkTask> tasks(chunksCount);
+
+		for(size_t i = 0; i < chunksCount; ++i)
+		{
+			LongBufferSizeType chunkStart = i * PARALLEL_FLATE_CHUNK_SIZE;
+
+			tasks[i].mParameters = &mCompressionParameters;
+			tasks[i].mInput = mBatchBuffer + chunkStart;
+			tasks[i].mInputSize = (mBatchSize - chunkStart) < PARALLEL_FLATE_CHUNK_SIZE ? (mBatchSize - chunkStart) : PARALLEL_FLATE_CHUNK_SIZE;
+			tasks[i].mIsLast = inIsLast && (i == chunksCount - 1);
+			if(0 == i)
+			{
+				tasks[i].mDictionary = mDictionary;
+				tasks[i].mDictionarySize = mDictionarySize;
+			}
+			else
+			{
+				// chunks are larger than the dictionary, so the previous chunk has it all
+				tasks[i].mDictionary = mBatchBuffer + chunkStart - PARALLEL_FLATE_DICTIONARY_SIZE;
+				tasks[i].mDictionarySize = PARALLEL_FLATE_DICTIONARY_SIZE;
+			}
+		}
+
+		if(chunksCount > 1)
+		{
+			// workers are kept across batches and assignments, and only replaced if the threads count changed
+			if(mWorkers && mWorkers->GetRequestedWorkersCount() != mThreadsCount - 1)
+			{
+				delete mWorkers;
+				mWorkers = NULL;
+			}
+			if(!mWorkers)
+				mWorkers = new ParallelFlateWorkers(mThreadsCount - 1);
+			mWorkers->Run(tasks);
+		}
+		else
+			EncodeChunk(&(tasks[0]));
+
+		for(size_t i = 0; i < chunksCount && eSuccess == status; ++i)
+		{
+			if(!tasks[i].mSucceeded)
+			{
+				TRACE_LOG1("OutputParallelFlateEncodeStream::EncodeBatch, failed to encode chunk %ld",i);
+				status = eFailure;
+				break;
+			}
+			status = WriteBytes(&(tasks[i].mOutput[0]),tasks[i].mOutputSize);
+			mAdler32 = adler32_combine(mAdler32,tasks[i].mAdler32,(z_off_t)tasks[i].mInputSize);
+		}
+		if(status != eSuccess)
+			break;
+
+		if(inIsLast)
+		{
+			Byte trailer[4] = {(Byte)((mAdler32 >> 24) & 0xff),(Byte)((mAdler32 >> 16) & 0xff),(Byte)((mAdler32 >> 8) & 0xff),(Byte)(mAdler32 & 0xff)};
+			status = WriteBytes(trailer,4);
+		}
+		else
+		{
+			// keep the batch tail for priming the next batch. non last batches are always full, so larger than the dictionary
+			if(!mDictionary)
+				mDictionary = new Byte[PARALLEL_FLATE_DICTIONARY_SIZE];
+			memcpy(mDictionary,mBatchBuffer + mBatchSize - PARALLEL_FLATE_DICTIONARY_SIZE,PARALLEL_FLATE_DICTIONARY_SIZE);
+			mDictionarySize = PARALLEL_FLATE_DICTIONARY_SIZE;
+		}
+		mBatchSize = 0;
+	}while(false);
+
+	if(status != eSuccess)
+		mFailed = true;
+	return status;
+}
+
+EStatusCode OutputParallelFlateEncodeStream::WriteBytes(const Byte* inBuffer,LongBufferSizeType inSize)
+{
+	if(0 == inSize)
+		return eSuccess;
+
+	LongBufferSizeType writtenBytes = mTargetStream->Write(inBuffer,inSize);
+	if(writtenBytes != inSize)
+	{
+		TRACE_LOG2("OutputParallelFlateEncodeStream::WriteBytes, Failed to write the desired amount of bytes to underlying stream. supposed to write %lld, wrote %lld",
+						inSize,writtenBytes);
+		return eFailure;
+	}
+	return eSuccess;
+}
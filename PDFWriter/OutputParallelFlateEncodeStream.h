@@ -0,0 +1,88 @@
+/*
+   Source File : OutputParallelFlateEncodeStream.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+/*
+	Flate encoding stream that compresses on multiple threads (pigz style).
+	Input is split into fixed size chunks, each compressed independently as raw deflate data, primed with the 32KB of input preceding it,
+	and ending on a byte boundary (sync flush). The chunks are then concatenated in order, within a single zlib header and an adler32 trailer
+	combined from the chunks checksums. The result is a regular zlib stream, decodable by any flate decoder.
+
+	Input is accumulated till there's a chunk per thread, and then the chunks are compressed in parallel. 
+	The compressing threads are started on the first parallel batch, and kept till the stream is destroyed, serving later batches 
+	and later assignments with the same threads count.
+	Streams that fit in a single chunk are compressed on the calling thread, exactly as OutputFlateEncodeStream would.
+*/
+
+#include "EStatusCode.h"
+#include "IByteWriterWithPosition.h"
+#include "FlateCompressionPolicy.h"
+
+// chunk size. streams larger than this are compressed in parallel
+#define PARALLEL_FLATE_CHUNK_SIZE (128*1024)
+// amount of preceding input used to prime each chunk (deflate window size)
+#define PARALLEL_FLATE_DICTIONARY_SIZE (32*1024)
+
+class ParallelFlateWorkers;
+
+class OutputParallelFlateEncodeStream : public IByteWriterWithPosition
+{
+public:
+	OutputParallelFlateEncodeStream(void);
+	virtual ~OutputParallelFlateEncodeStream(void);
+
+	// Assign makes OutputParallelFlateEncodeStream the owner of inWriter, so if you don't want the class to delete it upon destructions - use Assign(NULL).
+	// Assign(NULL) also finishes encoding, writing any left input to the current writer.
+	// inThreadsCount is the number of threads to use for compressing (including the calling thread)
+	void Assign(IByteWriterWithPosition* inWriter,unsigned int inThreadsCount,const FlateCompressionParameters& inParameters = FlateCompressionParameters());
+
+	virtual IOBasicTypes::LongBufferSizeType Write(const IOBasicTypes::Byte* inBuffer,IOBasicTypes::LongBufferSizeType inSize);
+	virtual IOBasicTypes::LongFilePositionType GetCurrentPosition();
+
+	// number of bytes encoded since last assigned a writer. still available after Assign(NULL)
+	IOBasicTypes::LongFilePositionType GetEncodedBytesCount();
+
+private:
+	IByteWriterWithPosition* mTargetStream;
+	unsigned int mThreadsCount;
+	FlateCompressionParameters mCompressionParameters;
+
+	// input waiting to be compressed, up to mThreadsCount chunks
+	IOBasicTypes::Byte* mBatchBuffer;
+	IOBasicTypes::LongBufferSizeType mBatchBufferSize;
+	IOBasicTypes::LongBufferSizeType mBatchSize;
+
+	// trailing input of the previous batch, priming the first chunk of the next batch
+	IOBasicTypes::Byte* mDictionary;
+	IOBasicTypes::LongBufferSizeType mDictionarySize;
+
+	bool mStartedChunkedEncoding;
+	unsigned long mAdler32;
+	bool mFailed;
+	IOBasicTypes::LongFilePositionType mEncodedBytesCount;
+	ParallelFlateWorkers* mWorkers;
+
+	void FinalizeEncoding();
+	void Cleanup();
+	PDFHummus::EStatusCode EncodeBatch(bool inIsLast);
+	PDFHummus::EStatusCode EncodeSingleChunk();
+	PDFHummus::EStatusCode WriteBytes(const IOBasicTypes::Byte* inBuffer,IOBasicTypes::LongBufferSizeType inSize);
+};
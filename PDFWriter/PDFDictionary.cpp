@@ -20,6 +20,50 @@
 */
 #include "PDFDictionary.h"
 
+PDFNameToPDFObjectMap::iterator PDFNameToPDFObjectMap::LowerBound(const std::string& inKey)
+{
+	ValueTypeVector::iterator first = mEntries.begin();
+	ValueTypeVector::difference_type count = mEntries.end() - first;
+
+	while(count > 0)
+	{
+		ValueTypeVector::difference_type step = count / 2;
+		ValueTypeVector::iterator middle = first + step;
+		if(middle->first->GetValue() < inKey)
+		{
+			first = middle + 1;
+			count -= step + 1;
+		}
+		else
+			count = step;
+	}
+	return first;
+}
+
+PDFNameToPDFObjectMap::iterator PDFNameToPDFObjectMap::find(const std::string& inKey)
+{
+	iterator it = LowerBound(inKey);
+	return (it != mEntries.end() && it->first->GetValue() == inKey) ? it : mEntries.end();
+}
+
+bool PDFNameToPDFObjectMap::insert(const value_type& inEntry)
+{
+	const std::string& key = inEntry.first->GetValue();
+
+	// common case of keys arriving in order
+	if(mEntries.empty() || mEntries.back().first->GetValue() < key)
+	{
+		mEntries.push_back(inEntry);
+		return true;
+	}
+
+	iterator it = LowerBound(key);
+	if(it != mEntries.end() && it->first->GetValue() == key)
+		return false;
+	mEntries.insert(it,inEntry);
+	return true;
+}
+
 PDFDictionary::PDFDictionary(void) : PDFObject(eType)
 { 
 }
@@ -37,8 +81,7 @@ PDFDictionary::~PDFDictionary(void)
 
 PDFObject* PDFDictionary::QueryDirectObject(std::string inName)
 {
-	PDFName key(inName);
-	PDFNameToPDFObjectMap::iterator it = mValues.find(&key);
+	PDFNameToPDFObjectMap::iterator it = mValues.find(inName);
 
 	if(it == mValues.end())
 	{
@@ -53,17 +96,18 @@ PDFObject* PDFDictionary::QueryDirectObject(std::string inName)
 
 void PDFDictionary::Insert(PDFName* inKeyObject, PDFObject* inValueObject)
 {
-	inKeyObject->AddRef();
-	inValueObject->AddRef();
-
-	mValues.insert(PDFNameToPDFObjectMap::value_type(inKeyObject,inValueObject));
+	// a repeated key is ignored (first one wins), in which case no reference is taken
+	if(mValues.insert(PDFNameToPDFObjectMap::value_type(inKeyObject,inValueObject)))
+	{
+		inKeyObject->AddRef();
+		inValueObject->AddRef();
+	}
 }
 
 
 bool PDFDictionary::Exists(std::string inName)
 {
-	PDFName key(inName);
-	return mValues.find(&key) != mValues.end();
+	return mValues.find(inName) != mValues.end();
 }
 
 MapIterator<PDFNameToPDFObjectMap> PDFDictionary::GetIterator()
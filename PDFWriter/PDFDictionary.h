@@ -23,21 +23,39 @@
 #include "PDFName.h"
 #include "MapIterator.h"
 
-#include <map>
+#include <vector>
+#include <utility>
 
-
-
-class PDFNameLess : public std::binary_function<const PDFName*,const PDFName*,bool>
+/*
+	Dictionary entries storage. entries are held in a vector sorted by key name, rather than in a map. this makes
+	a dictionary a single allocation, instead of an allocation per entry, and lookup a binary search over contiguous memory.
+	provides the map interface that MapIterator needs, so iterating a dictionary works as before (and in the same order).
+*/
+class PDFNameToPDFObjectMap
 {
 public:
-	bool operator( ) (const PDFName* left, 
-						const PDFName* right ) const
-	{
-		return left->GetValue() < right->GetValue();
-	}
-};
+	typedef PDFName* key_type;
+	typedef PDFObject* mapped_type;
+	typedef std::pair<PDFName*,PDFObject*> value_type;
+	typedef std::vector<value_type> ValueTypeVector;
+	typedef ValueTypeVector::iterator iterator;
+	typedef ValueTypeVector::const_iterator const_iterator;
+
+	iterator begin() {return mEntries.begin();}
+	iterator end() {return mEntries.end();}
+	const_iterator begin() const {return mEntries.begin();}
+	const_iterator end() const {return mEntries.end();}
+	size_t size() const {return mEntries.size();}
+
+	iterator find(const std::string& inKey);
+	// like std::map, an existing key is not replaced. returns false in this case
+	bool insert(const value_type& inEntry);
+
+private:
+	ValueTypeVector mEntries;
 
-typedef std::map<PDFName*,PDFObject*,PDFNameLess> PDFNameToPDFObjectMap;
+	iterator LowerBound(const std::string& inKey);
+};
 
 class PDFDictionary : public PDFObject
 {
@@ -43,13 +43,21 @@
 #include "PageContentContext.h"
 #include "PDFPage.h"
 #include "PDFParserTokenizer.h"
-#include "InputStreamSkipperStream.h"
+#include "InputRetainingStream.h"
 #include "IResourceWritingTask.h"
 #include "IFormEndWritingTask.h"
 #include "PDFPageInput.h"
+#include "SHA2Generator.h"
+#include "CopiedObjectsRegistry.h"
+#include "BoxingBase.h"
 
 using namespace PDFHummus;
 
+typedef BoxingBaseWithRW<unsigned long> ULong;
+typedef BoxingBaseWithRW<long long> LongLong;
+
+#define DIGEST_READ_BUFFER_SIZE (64*1024)
+
 PDFDocumentHandler::PDFDocumentHandler(void)
 {
 	mObjectsContext = NULL;
@@ -273,6 +281,7 @@ PDFFormXObject* PDFDocumentHandler::CreatePDFFormXObjectForPage(PDFDictionary* i
 																const PDFRectangle& inFormBox,
 																const double* inTransformationMatrix)
 {
+	PDFMetricsPhaseScope phaseScope(mObjectsContext->GetMetrics(),ePDFMetricsPhaseCopyPages);
 	PDFFormXObject* result = NULL;
 	EStatusCode status = PDFHummus::eSuccess;
 
@@ -499,14 +508,16 @@ EStatusCode PDFDocumentHandler::WriteNewObjects(const ObjectIDTypeList& inSource
 		// copied, so make sure to check that these objects are still required for copying
 		if(ioCopiedObjects.find(*itNewObjects) == ioCopiedObjects.end())
 		{
+			ObjectIDType targetObjectID;
+			bool requiresCopying = true;
 			ObjectIDTypeToObjectIDTypeMap::iterator it = mSourceToTarget.find(*itNewObjects);
 			if(it == mSourceToTarget.end())
-			{
-				ObjectIDType newObjectID = mObjectsContext->GetInDirectObjectsRegistry().AllocateNewObjectID();
-				it = mSourceToTarget.insert(ObjectIDTypeToObjectIDTypeMap::value_type(*itNewObjects,newObjectID)).first;
-			}
+				targetObjectID = AllocateTargetObjectID(*itNewObjects,requiresCopying);
+			else
+				targetObjectID = it->second;
 			ioCopiedObjects.insert(*itNewObjects);
-			status = CopyInDirectObject(*itNewObjects,it->second,ioCopiedObjects);
+			if(requiresCopying)
+				status = CopyInDirectObject(*itNewObjects,targetObjectID,ioCopiedObjects);
 		}
 	}
 	return status;
@@ -590,10 +601,11 @@ EStatusCode PDFDocumentHandler::CopyInDirectObject(ObjectIDType inSourceObjectID
 	{
 		if (sourceObject->GetType() != PDFObject::ePDFObjectStream) // write indirect object end for non streams only...cause they take care of writing their own
 			mObjectsContext->EndIndirectObject();
-		return WriteNewObjects(newObjectsToWrite,ioCopiedObjects);
+		status = WriteNewObjects(newObjectsToWrite,ioCopiedObjects);
+		if(PDFHummus::eSuccess == status)
+			RegisterWrittenTargetObject(inTargetObjectID);
 	}
-	else
-		return status;
+	return status;
 }
 
 EStatusCode PDFDocumentHandler::OnResourcesWrite(
@@ -733,6 +745,7 @@ EStatusCodeAndObjectIDTypeList PDFDocumentHandler::AppendPDFPagesFromPDFInContex
 
 EStatusCodeAndObjectIDType PDFDocumentHandler::CreatePDFPageForPage(unsigned long inPageIndex)
 {
+	PDFMetricsPhaseScope phaseScope(mObjectsContext->GetMetrics(),ePDFMetricsPhaseCopyPages);
 	RefCountPtr<PDFDictionary> pageObject = mParser->ParsePage(inPageIndex);
 	EStatusCodeAndObjectIDType result;
 	result.first = PDFHummus::eFailure;
@@ -937,13 +950,13 @@ EStatusCode PDFDocumentHandler::WritePDFStreamInputToContentContext(PageContentC
 
 EStatusCode PDFDocumentHandler::StartFileCopyingContext(const std::string& inPDFFilePath, const PDFParsingOptions& inOptions)
 {
-	if(mPDFFile.OpenFile(inPDFFilePath) != PDFHummus::eSuccess)
+	if(mPDFFile.OpenFile(inPDFFilePath,inOptions.UseMemoryMapping) != PDFHummus::eSuccess)
 	{
 		TRACE_LOG1("PDFDocumentHandler::StartFileCopyingContext, unable to open file for reading in %s",inPDFFilePath.c_str());
 		return PDFHummus::eFailure;
 	}
 
-	return StartCopyingContext(mPDFFile.GetInputStream(), inOptions);
+	return StartCopyingContext(mPDFFile.GetInputStream(), inOptions, mPDFFile.GetInputStreamWindow());
 }
 
 EStatusCode PDFDocumentHandler::StartCopyingContext(PDFParser* inPDFParser)
@@ -970,7 +983,7 @@ EStatusCode PDFDocumentHandler::StartCopyingContext(PDFParser* inPDFParser)
 	return status;    
 }
 
-EStatusCode PDFDocumentHandler::StartCopyingContext(IByteReaderWithPosition* inPDFStream, const PDFParsingOptions& inOptions)
+EStatusCode PDFDocumentHandler::StartCopyingContext(IByteReaderWithPosition* inPDFStream, const PDFParsingOptions& inOptions, IReadWindowProvider* inPDFStreamWindow)
 {
 	EStatusCode status;
 
@@ -980,8 +993,11 @@ EStatusCode PDFDocumentHandler::StartCopyingContext(IByteReaderWithPosition* inP
             mParser = new PDFParser();
 		mPDFStream = inPDFStream;
         mParserOwned = true;
+		// parsing the copied document is part of the work on the written one
+		if(mObjectsContext)
+			mParser->SetMetrics(&(mObjectsContext->GetMetrics()));
 
-		status = mParser->StartPDFParsing(inPDFStream, inOptions);
+		status = mParser->StartPDFParsing(inPDFStream, inOptions, inPDFStreamWindow);
 		if(status != PDFHummus::eSuccess)
 		{
 			TRACE_LOG("PDFDocumentHandler::StartCopyingContext, failure occured while parsing PDF file.");
@@ -1141,6 +1157,9 @@ void PDFDocumentHandler::StopCopyingContext()
 	mPDFStream = NULL;
 	// clearing the source to target mapping here. note that copying enjoyed sharing of objects between them
 	mSourceToTarget.clear();
+	mSourceObjectsDigests.clear();
+	mPendingDigestToTarget.clear();
+	mPendingTargetToDigest.clear();
 	if(mParserOwned)
     {
         if(mParser)
@@ -1258,6 +1277,7 @@ EStatusCode PDFDocumentHandler::MergePDFPagesToPageInContext(PDFPage* inPage,
 
 EStatusCode PDFDocumentHandler::MergePDFPageForPage(PDFPage* inTargetPage,unsigned long inSourcePageIndex)
 {
+	PDFMetricsPhaseScope phaseScope(mObjectsContext->GetMetrics(),ePDFMetricsPhaseCopyPages);
 	RefCountPtr<PDFDictionary> pageObject = mParser->ParsePage(inSourcePageIndex);
 	EStatusCode status  = PDFHummus::eSuccess;
 
@@ -1510,9 +1530,9 @@ EStatusCodeAndObjectIDType PDFDocumentHandler::CopyObjectToIndirectObject(PDFObj
 		ObjectIDTypeToObjectIDTypeMap::iterator	itObjects = mSourceToTarget.find(((PDFIndirectObjectReference*)inObject)->mObjectID);
 		if(itObjects == mSourceToTarget.end())
 		{
-			result.second = mObjectsContext->GetInDirectObjectsRegistry().AllocateNewObjectID();
-			mSourceToTarget.insert(ObjectIDTypeToObjectIDTypeMap::value_type(((PDFIndirectObjectReference*)inObject)->mObjectID,result.second));
-			result.first = CopyInDirectObject(((PDFIndirectObjectReference*)inObject)->mObjectID,result.second);
+			bool requiresCopying;
+			result.second = AllocateTargetObjectID(((PDFIndirectObjectReference*)inObject)->mObjectID,requiresCopying);
+			result.first = requiresCopying ? CopyInDirectObject(((PDFIndirectObjectReference*)inObject)->mObjectID,result.second) : PDFHummus::eSuccess;
 		}
 		else
 		{
@@ -1616,6 +1636,10 @@ EStatusCode PDFDocumentHandler::WritePDFStreamInputToContentContext(PageContentC
 	return status;
 }
 
+// amount of unchanged content to accumulate before copying it to the target, when renaming resources
+#define RESOURCES_RENAMING_COPY_THRESHOLD (16*1024)
+
+static const char scSlash = '/';
 EStatusCode PDFDocumentHandler::WritePDFStreamInputToStream(IByteWriter* inTargetStream,PDFStreamInput* inSourceStream,const StringToStringMap& inMappedResourcesNames)
 {
 	// as oppose to regular copying, this copying has to replace name references that refer to mapped resources.
@@ -1623,25 +1647,10 @@ EStatusCode PDFDocumentHandler::WritePDFStreamInputToStream(IByteWriter* inTarge
 	// the current assumption, somewhere between speed and safety compromise, is that the any name token that has a resource name is in fact a relevant
 	// resource reference. 
 
+	// this is done in a single pass over the decoded stream. the tokenizer reads through a retaining stream, which keeps the bytes read
+	// till they are copied to the target. on a resource name token, the bytes preceding it are copied as is, then the replacement name is written
+	// instead of the token. content between tokens is never re-created from the tokens, so it's copied exactly as in the source.
 
-	// in order to have minimal interferences with the stream content i'm going for two passes here.
-	// the first pass will scan the stream for tokens to replace providing the tokens and their positions.
-	// a second pass is then repeatedly copies the content between tokens that are to be replaced. this might be wasteful,
-	// but is the safest method to get the content right.
-
-	ResourceTokenMarkerList resourcesPositions;
-
-	EStatusCode status = ScanStreamForResourcesTokens(inSourceStream,inMappedResourcesNames,resourcesPositions);
-	if(status != PDFHummus::eSuccess)
-		return status;
-
-	return MergeAndReplaceResourcesTokens(inTargetStream,inSourceStream,inMappedResourcesNames,resourcesPositions);
-}
-
-
-static const char scSlash = '/';
-EStatusCode PDFDocumentHandler::ScanStreamForResourcesTokens(PDFStreamInput* inSourceStream,const StringToStringMap& inMappedResourcesNames,ResourceTokenMarkerList& outResourceMarkers)
-{
 	IByteReader* streamReader = mParser->CreateInputStreamReader(inSourceStream);
 
 	if(!streamReader)
@@ -1649,68 +1658,75 @@ EStatusCode PDFDocumentHandler::ScanStreamForResourcesTokens(PDFStreamInput* inS
 
 	mPDFStream->SetPosition(inSourceStream->GetStreamContentStart());
 
+	EStatusCode status = PDFHummus::eSuccess;
+	InputRetainingStream retainingStream(streamReader);
 	PDFParserTokenizer tokenizer;
-	tokenizer.SetReadStream(streamReader);
+	PrimitiveObjectsWriter primitivesWriter;
+	std::string token;
+	StringToStringMap::const_iterator itMapped;
 
-	BoolAndString tokenizerResult;
+	tokenizer.SetReadStream(&retainingStream,&retainingStream);
+	primitivesWriter.SetStreamForWriting(inTargetStream);
 
-	while(streamReader->NotEnded())
+	while(PDFHummus::eSuccess == status && tokenizer.GetNextToken(token))
 	{
-		BoolAndString tokenizerResult = tokenizer.GetNextToken();
-
-		if(!tokenizerResult.first)
-			break;
+		LongFilePositionType tokenPosition = tokenizer.GetRecentTokenPosition();
 
 		// check if this is a token that will need replacement - 1. verify that it's a name 2. verify that it's a name in the input map
 		// note that here i don't have to take care of name space chars encoding, as the names are alrady encoded in the map [the new names are never containing space chars]
-		if(tokenizerResult.second.at(0) == scSlash && 
-			(inMappedResourcesNames.find(tokenizerResult.second.substr(1)) != inMappedResourcesNames.end()))
-				outResourceMarkers.push_back(ResourceTokenMarker(tokenizerResult.second.substr(1),tokenizer.GetRecentTokenPosition()));
+		if(token.size() > 1 && token.at(0) == scSlash &&
+			(itMapped = inMappedResourcesNames.find(token.substr(1))) != inMappedResourcesNames.end())
+		{
+			status = CopyRetainedBytes(inTargetStream,retainingStream,tokenPosition);
+			if(status != PDFHummus::eSuccess)
+				break;
+			primitivesWriter.WriteName(itMapped->second,eTokenSepratorNone);
+			retainingStream.ReleaseTill(tokenPosition + token.size());
+		}
+		else if(tokenPosition - retainingStream.GetRetainedStartPosition() >= RESOURCES_RENAMING_COPY_THRESHOLD)
+		{
+			// everything before the current token is final, so flush it once enough accumulated, to keep memory use down
+			status = CopyRetainedBytes(inTargetStream,retainingStream,tokenPosition);
+		}
+	}
+
+	// copy what's left, including anything after the last token
+	if(PDFHummus::eSuccess == status)
+	{
+		while(retainingStream.NotEnded())
+		{
+			LongBufferSizeType windowSize;
+			if(!retainingStream.GetReadWindow(windowSize))
+				break;
+			retainingStream.ConsumeReadWindow(windowSize);
+			status = CopyRetainedBytes(inTargetStream,retainingStream,retainingStream.GetCurrentPosition());
+			if(status != PDFHummus::eSuccess)
+				break;
+		}
+		if(PDFHummus::eSuccess == status)
+			status = CopyRetainedBytes(inTargetStream,retainingStream,retainingStream.GetCurrentPosition());
 	}
 
 	delete streamReader;
-	return PDFHummus::eSuccess;
+	return status;
 }
 
-EStatusCode PDFDocumentHandler::MergeAndReplaceResourcesTokens(	IByteWriter* inTargetStream,
-																PDFStreamInput* inSourceStream,
-																const StringToStringMap& inMappedResourcesNames,
-																const ResourceTokenMarkerList& inResourceMarkers)
+EStatusCode PDFDocumentHandler::CopyRetainedBytes(IByteWriter* inTargetStream,InputRetainingStream& inRetainingStream,LongFilePositionType inCopyTill)
 {
-	IByteReader* streamReader = mParser->CreateInputStreamReader(inSourceStream);
-
-	if(!streamReader)
-		return PDFHummus::eFailure;
-
-	mPDFStream->SetPosition(inSourceStream->GetStreamContentStart());
+	LongBufferSizeType retainedSize;
+	const Byte* retainedBytes = inRetainingStream.GetRetainedBytes(retainedSize);
+	LongBufferSizeType copySize = (LongBufferSizeType)(inCopyTill - inRetainingStream.GetRetainedStartPosition());
 
-	OutputStreamTraits traits(inTargetStream);
-	PrimitiveObjectsWriter primitivesWriter;
-	primitivesWriter.SetStreamForWriting(inTargetStream);
-	EStatusCode status = PDFHummus::eSuccess;
-	InputStreamSkipperStream skipper(streamReader);
-	ResourceTokenMarkerList::const_iterator it = inResourceMarkers.begin();
-	LongFilePositionType previousContentPosition = 0;
-
-	for(; it != inResourceMarkers.end() && PDFHummus::eSuccess == status; ++it)
+	if(copySize > retainedSize)
 	{
-		status = traits.CopyToOutputStream(streamReader,(LongBufferSizeType)(it->ResourceTokenPosition - previousContentPosition));
-		if(status != PDFHummus::eSuccess)
-			break;
-		primitivesWriter.WriteName(inMappedResourcesNames.find(it->ResourceToken)->second,eTokenSepratorNone);
-		// note that i'm using SkipBy here. if i want to use SkipTo, i have to user the skipper stream as input stream for the rest
-		// of the reader objects here, as SkipTo relies on information on how many bytes were read
-		skipper.SkipBy(it->ResourceToken.size() + 1); // skip the resource name in the read stream [include +1 for slash]
-		previousContentPosition = it->ResourceTokenPosition + it->ResourceToken.size() + 1;
+		TRACE_LOG("PDFDocumentHandler::CopyRetainedBytes, unexpected failure. requested to copy bytes that are not retained");
+		return PDFHummus::eFailure;
 	}
 
-	// copy from last marker (or in case there are none - from the beginning), till end
-	if(PDFHummus::eSuccess == status)
-		status = traits.CopyToOutputStream(streamReader);
-	
-	skipper.Assign(NULL);
-	delete streamReader;
-	return status;
+	if(copySize > 0 && inTargetStream->Write(retainedBytes,copySize) != copySize)
+		return PDFHummus::eFailure;
+	inRetainingStream.ReleaseTill(inCopyTill);
+	return PDFHummus::eSuccess;
 }
 
 
@@ -1855,13 +1871,17 @@ void InWritingPolicy::WriteReference(PDFIndirectObjectReference* inReference, ET
 void OutWritingPolicy::WriteReference(PDFIndirectObjectReference* inReference, ETokenSeparator inSeparator) {
 	ObjectIDType sourceObjectID = inReference->mObjectID;
 	ObjectIDTypeToObjectIDTypeMap::iterator	itObjects = mDocumentHandler->mSourceToTarget.find(sourceObjectID);
+	ObjectIDType targetObjectID;
 	if (itObjects == mDocumentHandler->mSourceToTarget.end())
 	{
-		ObjectIDType newObjectID = mDocumentHandler->mObjectsContext->GetInDirectObjectsRegistry().AllocateNewObjectID();
-		itObjects = mDocumentHandler->mSourceToTarget.insert(ObjectIDTypeToObjectIDTypeMap::value_type(sourceObjectID, newObjectID)).first;
-		mSourceObjectsToAdd.push_back(sourceObjectID);
+		bool requiresCopying;
+		targetObjectID = mDocumentHandler->AllocateTargetObjectID(sourceObjectID, requiresCopying);
+		if (requiresCopying)
+			mSourceObjectsToAdd.push_back(sourceObjectID);
 	}
-	mDocumentHandler->mObjectsContext->WriteNewIndirectObjectReference(itObjects->second, inSeparator);
+	else
+		targetObjectID = itObjects->second;
+	mDocumentHandler->mObjectsContext->WriteNewIndirectObjectReference(targetObjectID, inSeparator);
 }
 
 
@@ -2305,9 +2325,10 @@ void PDFDocumentHandler::RegisterResourcesForResourcesCategory(PDFFormXObject* i
                 ObjectIDType targetObjectID;
                 if(itObjects == mSourceToTarget.end())
                 {
-                    targetObjectID = mObjectsContext->GetInDirectObjectsRegistry().AllocateNewObjectID();
-                    mSourceToTarget.insert(ObjectIDTypeToObjectIDTypeMap::value_type(indirectReference->mObjectID,targetObjectID));
-                    ioObjectsToLaterCopy.push_back(indirectReference->mObjectID);
+                    bool requiresCopying;
+                    targetObjectID = AllocateTargetObjectID(indirectReference->mObjectID,requiresCopying);
+                    if(requiresCopying)
+                        ioObjectsToLaterCopy.push_back(indirectReference->mObjectID);
                 }
                 else
                 {
@@ -2407,3 +2428,232 @@ void PDFDocumentHandler::RegisterFormRelatedObjects(PDFFormXObject* inFormXObjec
 {
     mDocumentContext->RegisterFormEndWritingTask(inFormXObject,new ObjectsCopyingTask(this,inObjectsToWrite));
 }
+
+ObjectIDType PDFDocumentHandler::AllocateTargetObjectID(ObjectIDType inSourceObjectID,bool& outRequiresCopying)
+{
+	ObjectIDType targetObjectID;
+	CopiedObjectsRegistry* registry = (mDocumentContext && mDocumentContext->GetCopiedObjectsRegistry().IsEnabled()) ? 
+												&(mDocumentContext->GetCopiedObjectsRegistry()) : NULL;
+
+	outRequiresCopying = true;
+	if(registry)
+	{
+		const CopiedObjectDigest& digest = GetSourceObjectDigest(inSourceObjectID);
+		if(digest.IsDeduplicable)
+		{
+			StringToObjectIDTypeMap::iterator itPending = mPendingDigestToTarget.find(digest.Digest);
+			if(registry->FindObject(digest.Digest,targetObjectID))
+			{
+				// an equivalent object was already written. use it instead of copying again
+				registry->RecordDeduplication(digest.StreamBytes);
+				outRequiresCopying = false;
+			}
+			else if(itPending != mPendingDigestToTarget.end())
+			{
+				// an equivalent object is about to be written by this context
+				targetObjectID = itPending->second;
+				registry->RecordDeduplication(digest.StreamBytes);
+				outRequiresCopying = false;
+			}
+			else
+			{
+				targetObjectID = mObjectsContext->GetInDirectObjectsRegistry().AllocateNewObjectID();
+				mPendingDigestToTarget.insert(StringToObjectIDTypeMap::value_type(digest.Digest,targetObjectID));
+				mPendingTargetToDigest.insert(ObjectIDTypeToStringMap::value_type(targetObjectID,digest.Digest));
+			}
+			mSourceToTarget.insert(ObjectIDTypeToObjectIDTypeMap::value_type(inSourceObjectID,targetObjectID));
+			return targetObjectID;
+		}
+	}
+
+	targetObjectID = mObjectsContext->GetInDirectObjectsRegistry().AllocateNewObjectID();
+	mSourceToTarget.insert(ObjectIDTypeToObjectIDTypeMap::value_type(inSourceObjectID,targetObjectID));
+	return targetObjectID;
+}
+
+void PDFDocumentHandler::RegisterWrittenTargetObject(ObjectIDType inTargetObjectID)
+{
+	ObjectIDTypeToStringMap::iterator it = mPendingTargetToDigest.find(inTargetObjectID);
+	if(it == mPendingTargetToDigest.end())
+		return;
+
+	mDocumentContext->GetCopiedObjectsRegistry().RegisterObject(it->second,inTargetObjectID);
+	mPendingDigestToTarget.erase(it->second);
+	mPendingTargetToDigest.erase(it);
+}
+
+const CopiedObjectDigest& PDFDocumentHandler::GetSourceObjectDigest(ObjectIDType inSourceObjectID)
+{
+	ObjectIDTypeToCopiedObjectDigestMap::iterator it = mSourceObjectsDigests.find(inSourceObjectID);
+	if(it != mSourceObjectsDigests.end())
+		return it->second;
+
+	CopiedObjectDigest digest;
+
+	// an object that is already being digested refers to itself through other objects. cycles are not digested, 
+	// which also excludes their members (their digest is calculated while the cycle is open)
+	if(mSourceObjectsInDigest.find(inSourceObjectID) != mSourceObjectsInDigest.end())
+		return mSourceObjectsDigests.insert(ObjectIDTypeToCopiedObjectDigestMap::value_type(inSourceObjectID,digest)).first->second;
+
+	RefCountPtr<PDFObject> sourceObject = mParser->ParseNewObject(inSourceObjectID);
+	if(!!sourceObject)
+	{
+		SHA2Generator digestGenerator;
+
+		mSourceObjectsInDigest.insert(inSourceObjectID);
+		digest.IsDigestible = AccumulateObjectDigest(sourceObject.GetPtr(),digestGenerator,digest.StreamBytes);
+		mSourceObjectsInDigest.erase(inSourceObjectID);
+		if(digest.IsDigestible)
+		{
+			digest.Digest = digestGenerator.ToStringAsString();
+			digest.IsDeduplicable = IsDeduplicableObject(sourceObject.GetPtr());
+		}
+		else
+		{
+			digest.StreamBytes = 0;
+		}
+	}
+
+	// insert, rather than assign, as a cycle member may have been stored meanwhile
+	it = mSourceObjectsDigests.find(inSourceObjectID);
+	if(it == mSourceObjectsDigests.end())
+		it = mSourceObjectsDigests.insert(ObjectIDTypeToCopiedObjectDigestMap::value_type(inSourceObjectID,digest)).first;
+	return it->second;
+}
+
+static void AccumulateDigestToken(SHA2Generator& ioDigest,char inTag,const std::string& inValue)
+{
+	// tag and length prefix, so that token boundaries are unambiguous
+	ioDigest.Accumulate(std::string(1,inTag) + ULong(inValue.size()).ToString() + ":");
+	ioDigest.Accumulate(inValue);
+}
+
+bool PDFDocumentHandler::AccumulateObjectDigest(PDFObject* inObject,SHA2Generator& ioDigest,LongFilePositionType& ioStreamBytes)
+{
+	switch(inObject->GetType())
+	{
+		case PDFObject::ePDFObjectBoolean:
+			AccumulateDigestToken(ioDigest,'b',((PDFBoolean*)inObject)->GetValue() ? "true":"false");
+			return true;
+		case PDFObject::ePDFObjectLiteralString:
+			AccumulateDigestToken(ioDigest,'l',((PDFLiteralString*)inObject)->GetValue());
+			return true;
+		case PDFObject::ePDFObjectHexString:
+			AccumulateDigestToken(ioDigest,'h',((PDFHexString*)inObject)->GetValue());
+			return true;
+		case PDFObject::ePDFObjectNull:
+			AccumulateDigestToken(ioDigest,'n',"");
+			return true;
+		case PDFObject::ePDFObjectName:
+			AccumulateDigestToken(ioDigest,'N',((PDFName*)inObject)->GetValue());
+			return true;
+		case PDFObject::ePDFObjectInteger:
+			AccumulateDigestToken(ioDigest,'i',LongLong(((PDFInteger*)inObject)->GetValue()).ToString());
+			return true;
+		case PDFObject::ePDFObjectReal:
+		{
+			double value = ((PDFReal*)inObject)->GetValue();
+			AccumulateDigestToken(ioDigest,'r',std::string((const char*)&value,sizeof(double)));
+			return true;
+		}
+		case PDFObject::ePDFObjectSymbol:
+			AccumulateDigestToken(ioDigest,'s',((PDFSymbol*)inObject)->GetValue());
+			return true;
+		case PDFObject::ePDFObjectIndirectObjectReference:
+		{
+			// referenced objects take part by their own digest, so equivalent objects graphs have equal digests
+			const CopiedObjectDigest& referencedDigest = GetSourceObjectDigest(((PDFIndirectObjectReference*)inObject)->mObjectID);
+			if(!referencedDigest.IsDigestible)
+				return false;
+			AccumulateDigestToken(ioDigest,'R',referencedDigest.Digest);
+			ioStreamBytes += referencedDigest.StreamBytes;
+			return true;
+		}
+		case PDFObject::ePDFObjectArray:
+		{
+			PDFArray* anArray = (PDFArray*)inObject;
+			SingleValueContainerIterator<PDFObjectVector> it(anArray->GetIterator());
+
+			AccumulateDigestToken(ioDigest,'a',ULong(anArray->GetLength()).ToString());
+			while(it.MoveNext())
+				if(!AccumulateObjectDigest(it.GetItem(),ioDigest,ioStreamBytes))
+					return false;
+			AccumulateDigestToken(ioDigest,'e',"");
+			return true;
+		}
+		case PDFObject::ePDFObjectDictionary:
+		{
+			PDFDictionary* aDictionary = (PDFDictionary*)inObject;
+
+			// pages and other tree nodes are identified by their place in the document, not by their content
+			PDFObjectCastPtr<PDFName> typeObject(aDictionary->QueryDirectObject("Type"));
+			if(aDictionary->Exists("Parent") || 
+				(!!typeObject && (typeObject->GetValue() == "Page" || typeObject->GetValue() == "Pages" || typeObject->GetValue() == "Catalog")))
+				return false;
+
+			// keys are iterated in sorted order, so the digest does not depend on the order in the source file
+			MapIterator<PDFNameToPDFObjectMap> it(aDictionary->GetIterator());
+			AccumulateDigestToken(ioDigest,'d',"");
+			while(it.MoveNext())
+			{
+				AccumulateDigestToken(ioDigest,'N',it.GetKey()->GetValue());
+				if(!AccumulateObjectDigest(it.GetValue(),ioDigest,ioStreamBytes))
+					return false;
+			}
+			AccumulateDigestToken(ioDigest,'e',"");
+			return true;
+		}
+		case PDFObject::ePDFObjectStream:
+		{
+			// the stream dictionary without Length, and the stream data as it would be copied (still encoded)
+			PDFStreamInput* aStream = (PDFStreamInput*)inObject;
+			RefCountPtr<PDFDictionary> streamDictionary(aStream->QueryStreamDictionary());
+			MapIterator<PDFNameToPDFObjectMap> it(streamDictionary->GetIterator());
+
+			AccumulateDigestToken(ioDigest,'S',"");
+			while(it.MoveNext())
+			{
+				if(it.GetKey()->GetValue() == "Length")
+					continue;
+				AccumulateDigestToken(ioDigest,'N',it.GetKey()->GetValue());
+				if(!AccumulateObjectDigest(it.GetValue(),ioDigest,ioStreamBytes))
+					return false;
+			}
+			AccumulateDigestToken(ioDigest,'e',"");
+
+			IByteReader* streamReader = mParser->StartReadingFromStreamForPlainCopying(aStream);
+			if(!streamReader)
+				return false;
+
+			Byte* buffer = new Byte[DIGEST_READ_BUFFER_SIZE];
+			LongBufferSizeType readAmount;
+			LongFilePositionType streamLength = 0;
+			while(streamReader->NotEnded())
+			{
+				readAmount = streamReader->Read(buffer,DIGEST_READ_BUFFER_SIZE);
+				ioDigest.Accumulate(buffer,readAmount);
+				streamLength += readAmount;
+			}
+			delete[] buffer;
+			delete streamReader;
+			AccumulateDigestToken(ioDigest,'L',LongLong(streamLength).ToString());
+			ioStreamBytes += streamLength;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool PDFDocumentHandler::IsDeduplicableObject(PDFObject* inObject)
+{
+	// streams (images, font programs, ICC profiles, form xobjects, content) and font dictionaries are shared freely by PDF readers.
+	// other objects may carry identity (e.g. optional content groups, annotations), so they are always copied
+	if(inObject->GetType() == PDFObject::ePDFObjectStream)
+		return true;
+
+	if(inObject->GetType() != PDFObject::ePDFObjectDictionary)
+		return false;
+
+	PDFObjectCastPtr<PDFName> typeObject(((PDFDictionary*)inObject)->QueryDirectObject("Type"));
+	return !!typeObject && (typeObject->GetValue() == "Font" || typeObject->GetValue() == "FontDescriptor");
+}
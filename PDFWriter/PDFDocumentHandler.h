@@ -47,6 +47,8 @@ class IPageEmbedInFormCommand;
 class IPDFParserExtender;
 class ICategoryServicesCommand;
 class PDFIndirectObjectReference;
+class InputRetainingStream;
+class SHA2Generator;
 
 
 namespace PDFHummus
@@ -60,18 +62,24 @@ typedef std::map<std::string,std::string> StringToStringMap;
 typedef std::set<ObjectIDType> ObjectIDTypeSet;
 typedef std::set<IDocumentContextExtender*> IDocumentContextExtenderSet;
 
-struct ResourceTokenMarker
+// content digest of a source object, for deduplication of copied objects (see CopiedObjectsRegistry)
+struct CopiedObjectDigest
 {
-	ResourceTokenMarker(std::string inResourceToken,LongFilePositionType inResourceTokenPosition)
-	{
-		ResourceToken = inResourceToken;
-		ResourceTokenPosition = inResourceTokenPosition;
-	}
-
-	std::string ResourceToken;
-	LongFilePositionType ResourceTokenPosition;
+	// false if the object could not be digested, e.g. when it is part of a references cycle
+	bool IsDigestible;
+	// true if the object may be replaced by an equivalent copy. only streams and fonts are
+	bool IsDeduplicable;
+	std::string Digest;
+	// stream bytes of the object and the objects it refers to
+	LongFilePositionType StreamBytes;
+
+	CopiedObjectDigest(){IsDigestible = false;IsDeduplicable = false;StreamBytes = 0;}
 };
 
+typedef std::map<ObjectIDType,CopiedObjectDigest> ObjectIDTypeToCopiedObjectDigestMap;
+typedef std::map<std::string,ObjectIDType> StringToObjectIDTypeMap;
+typedef std::map<ObjectIDType,std::string> ObjectIDTypeToStringMap;
+
 class IObjectWritePolicy
 {
 public:
@@ -101,8 +109,6 @@ private:
 	ObjectIDTypeList& mSourceObjectsToAdd;
 };
 
-typedef std::list<ResourceTokenMarker> ResourceTokenMarkerList;
-
 class PDFDocumentHandler : public DocumentContextExtenderAdapter
 {
 	friend class InWritingPolicy;
@@ -231,6 +237,12 @@ private:
     bool mParserOwned;
 	ObjectIDTypeToObjectIDTypeMap mSourceToTarget;
 	PDFDictionary* mWrittenPage;
+	ObjectIDTypeToCopiedObjectDigestMap mSourceObjectsDigests;
+	ObjectIDTypeSet mSourceObjectsInDigest;
+	// deduplicable target objects allocated by this context and not written yet. they are registered with the document registry 
+	// only once written, so other contexts never refer to an object that failed to copy
+	StringToObjectIDTypeMap mPendingDigestToTarget;
+	ObjectIDTypeToStringMap mPendingTargetToDigest;
 	
 
 	PDFRectangle DeterminePageBox(PDFDictionary* inDictionary,EPDFPageBox inPageBoxType);
@@ -253,6 +265,15 @@ private:
 												const double* inTransformationMatrix);
 	PDFHummus::EStatusCode CopyInDirectObject(ObjectIDType inSourceObjectID,ObjectIDType inTargetObjectID);
 
+	// allocates a target object for a source object and maps it. with deduplication enabled, the target object
+	// may be an already written equivalent object, in which case outRequiresCopying is false
+	ObjectIDType AllocateTargetObjectID(ObjectIDType inSourceObjectID,bool& outRequiresCopying);
+	// register a written target object, that was allocated for deduplication, with the document registry
+	void RegisterWrittenTargetObject(ObjectIDType inTargetObjectID);
+	const CopiedObjectDigest& GetSourceObjectDigest(ObjectIDType inSourceObjectID);
+	bool AccumulateObjectDigest(PDFObject* inObject,SHA2Generator& ioDigest,LongFilePositionType& ioStreamBytes);
+	bool IsDeduplicableObject(PDFObject* inObject);
+
 	PDFHummus::EStatusCode WriteObjectByType(PDFObject* inObject, ETokenSeparator inSeparator,IObjectWritePolicy* inWritePolicy);
 	PDFHummus::EStatusCode WriteArrayObject(PDFArray* inArray, ETokenSeparator inSeparator, IObjectWritePolicy* inWritePolicy);
 	PDFHummus::EStatusCode WriteDictionaryObject(PDFDictionary* inDictionary, IObjectWritePolicy* inWritePolicy);
@@ -272,11 +293,7 @@ private:
 	PDFHummus::EStatusCode MergePageContentToTargetPage(PDFPage* inTargetPage,PDFDictionary* inSourcePage,const StringToStringMap& inMappedResourcesNames);
 	PDFHummus::EStatusCode WritePDFStreamInputToContentContext(PageContentContext* inContentContext,PDFStreamInput* inContentSource,const StringToStringMap& inMappedResourcesNames);
 	PDFHummus::EStatusCode WritePDFStreamInputToStream(IByteWriter* inTargetStream,PDFStreamInput* inSourceStream,const StringToStringMap& inMappedResourcesNames);
-	PDFHummus::EStatusCode ScanStreamForResourcesTokens(PDFStreamInput* inSourceStream,const StringToStringMap& inMappedResourcesNames,ResourceTokenMarkerList& outResourceMarkers);
-	PDFHummus::EStatusCode MergeAndReplaceResourcesTokens(	IByteWriter* inTargetStream,
-												PDFStreamInput* inSourceStream,
-												const StringToStringMap& inMappedResourcesNames,
-												const ResourceTokenMarkerList& inResourceMarkers);
+	PDFHummus::EStatusCode CopyRetainedBytes(IByteWriter* inTargetStream,InputRetainingStream& inRetainingStream,LongFilePositionType inCopyTill);
 
 	EStatusCodeAndObjectIDTypeList CreateFormXObjectsFromPDFInContext(
 																		const PDFPageRange& inPageRange,
@@ -294,7 +311,7 @@ private:
 	PDFHummus::EStatusCode MergePDFPagesToPageInContext(PDFPage* inPage,
 											const PDFPageRange& inPageRange,
 											const ObjectIDTypeList& inCopyAdditionalObjects);
-	PDFHummus::EStatusCode StartCopyingContext(IByteReaderWithPosition* inPDFStream,const PDFParsingOptions& inOptions);
+	PDFHummus::EStatusCode StartCopyingContext(IByteReaderWithPosition* inPDFStream,const PDFParsingOptions& inOptions,IReadWindowProvider* inPDFStreamWindow = NULL);
 	PDFHummus::EStatusCode StartCopyingContext(PDFParser* inPDFParser);
     EStatusCode MergePDFPageForXObject(PDFFormXObject* inTargetFormXObject,unsigned long inSourcePageIndex);
     EStatusCode RegisterResourcesForForm(PDFFormXObject* inTargetFormXObject,
@@ -0,0 +1,1126 @@
+/*
+   Source File : PDFLinearizer.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "PDFLinearizer.h"
+#include "PDFObject.h"
+#include "PDFObjectCast.h"
+#include "PDFArray.h"
+#include "PDFDictionary.h"
+#include "PDFIndirectObjectReference.h"
+#include "PDFStreamInput.h"
+#include "PDFBoolean.h"
+#include "PDFLiteralString.h"
+#include "PDFHexString.h"
+#include "PDFName.h"
+#include "PDFInteger.h"
+#include "PDFReal.h"
+#include "PDFSymbol.h"
+#include "DictionaryContext.h"
+#include "OutputFile.h"
+#include "OutputStringBufferStream.h"
+#include "OutputStreamTraits.h"
+#include "IByteWriterWithPosition.h"
+#include "IByteReaderWithPosition.h"
+#include "RefCountPtr.h"
+#include "Trace.h"
+#include "SafeBufferMacrosDefs.h"
+
+#include <stdio.h>
+
+using namespace PDFHummus;
+
+// usage marker for objects used by more than one page
+#define SHARED_OBJECT_USAGE -1
+// rounds of laying out the first part of the file. its size depends on the offsets it holds, which depend on its size
+#define MAX_FIRST_PART_LAYOUT_ROUNDS 10
+
+PDFLinearizer::PDFLinearizer(void)
+{
+	Reset();
+}
+
+PDFLinearizer::~PDFLinearizer(void)
+{
+}
+
+void PDFLinearizer::Reset()
+{
+	mCatalogID = 0;
+	mInfoID = 0;
+	mPageIDs.clear();
+	mPageTreeNodes.clear();
+	mPageTreeObjectIDs.clear();
+	mMissingObjectIDs.clear();
+	mObjectsReferences.clear();
+	mDocumentObjects.clear();
+	mPagesObjects.clear();
+	mSharedObjects.clear();
+	mOtherObjects.clear();
+	mPagesSharedObjects.clear();
+	mNewObjectIDs.clear();
+	mSourceObjectIDs.clear();
+	mMainSectionSize = 0;
+	mLinearizationDictionaryID = 0;
+	mHintStreamID = 0;
+	mBodyPositions.clear();
+	mBodyLengths.clear();
+	mDocumentObjectsEnd = 0;
+	mFirstPageEnd = 0;
+	mPagesEnd = 0;
+	mBodySize = 0;
+}
+
+EStatusCode PDFLinearizer::LinearizePDF(const std::string& inSourceFilePath,
+										const std::string& inTargetFilePath,
+										const PDFParsingOptions& inParsingOptions)
+{
+	EStatusCode status = eSuccess;
+	std::string bodyFilePath;
+	bool wroteBody = false;
+
+	Reset();
+
+	do
+	{
+		status = mSourceFile.OpenFile(inSourceFilePath);
+		if(status != eSuccess)
+		{
+			TRACE_LOG1("PDFLinearizer::LinearizePDF, cannot open source file %s",inSourceFilePath.c_str());
+			break;
+		}
+
+		status = mParser.StartPDFParsing(mSourceFile.GetInputStream(),inParsingOptions);
+		if(status != eSuccess)
+		{
+			TRACE_LOG1("PDFLinearizer::LinearizePDF, failed to parse source file %s",inSourceFilePath.c_str());
+			break;
+		}
+
+		if(mParser.IsEncrypted())
+		{
+			TRACE_LOG("PDFLinearizer::LinearizePDF, linearizing encrypted files is not supported");
+			status = eFailure;
+			break;
+		}
+
+		status = ReadDocumentStructure();
+		if(status != eSuccess)
+			break;
+
+		ArrangeObjects();
+		NumberObjects();
+
+		// write all objects but the hint stream to the body file, which gives their positions for the hint tables and the cross reference sections
+		OutputFile bodyFile;
+		status = bodyFile.OpenUniqueFile(inTargetFilePath + ".body");
+		if(status != eSuccess)
+		{
+			TRACE_LOG1("PDFLinearizer::LinearizePDF, cannot create a temporary file next to %s",inTargetFilePath.c_str());
+			break;
+		}
+		bodyFilePath = bodyFile.GetFilePath();
+		wroteBody = true;
+		status = WriteBody(bodyFile.GetOutputStream());
+		bodyFile.CloseFile();
+		if(status != eSuccess)
+			break;
+
+		// the hint stream size doesn't depend on the first part size, as the hint tables have fixed size fields for positions
+		LongFilePositionType hintStreamSize = (LongFilePositionType)CreateHintStream(0).size();
+
+		LongFilePositionType firstPartSize = 0;
+		LongFilePositionType firstPageXrefPosition = 0;
+		LongFilePositionType mainXrefFirstEntryPosition;
+		std::string firstPart,mainXref;
+		bool laidOut = false;
+
+		for(int i = 0; i < MAX_FIRST_PART_LAYOUT_ROUNDS && !laidOut; ++i)
+		{
+			LongFilePositionType newFirstPageXrefPosition;
+
+			mainXref = CreateMainXref(firstPartSize,hintStreamSize,firstPageXrefPosition,mainXrefFirstEntryPosition);
+			firstPart = CreateFirstPart(firstPartSize,hintStreamSize,(LongFilePositionType)mainXref.size(),mainXrefFirstEntryPosition,newFirstPageXrefPosition);
+
+			laidOut = (LongFilePositionType)firstPart.size() <= firstPartSize && newFirstPageXrefPosition == firstPageXrefPosition;
+			if((LongFilePositionType)firstPart.size() > firstPartSize)
+				firstPartSize = (LongFilePositionType)firstPart.size();
+			firstPageXrefPosition = newFirstPageXrefPosition;
+		}
+		if(!laidOut)
+		{
+			TRACE_LOG("PDFLinearizer::LinearizePDF, unexpected failure. could not lay out the first part of the file");
+			status = eFailure;
+			break;
+		}
+		// whitespace fills the gap, if the first part came out shorter than the space left for it
+		firstPart.append((size_t)(firstPartSize - firstPart.size()),' ');
+
+		std::string hintStream = CreateHintStream(firstPartSize);
+
+		// now write it all to the target file
+		OutputFile targetFile;
+		InputFile body;
+
+		status = targetFile.OpenFile(inTargetFilePath);
+		if(status != eSuccess)
+		{
+			TRACE_LOG1("PDFLinearizer::LinearizePDF, cannot open target file %s",inTargetFilePath.c_str());
+			break;
+		}
+		status = body.OpenFile(bodyFilePath);
+		if(status != eSuccess)
+		{
+			TRACE_LOG1("PDFLinearizer::LinearizePDF, cannot open temporary file %s",bodyFilePath.c_str());
+			targetFile.CloseFile();
+			break;
+		}
+
+		IByteWriterWithPosition* targetStream = targetFile.GetOutputStream();
+		OutputStreamTraits targetTraits(targetStream);
+
+		targetStream->Write((const Byte*)firstPart.c_str(),firstPart.size());
+		status = targetTraits.CopyToOutputStream(body.GetInputStream(),(LongBufferSizeType)mDocumentObjectsEnd);
+		if(eSuccess == status)
+		{
+			targetStream->Write((const Byte*)hintStream.c_str(),hintStream.size());
+			status = targetTraits.CopyToOutputStream(body.GetInputStream(),(LongBufferSizeType)(mBodySize - mDocumentObjectsEnd));
+		}
+		if(eSuccess == status)
+			targetStream->Write((const Byte*)mainXref.c_str(),mainXref.size());
+		body.CloseFile();
+		targetFile.CloseFile();
+		if(status != eSuccess)
+			TRACE_LOG("PDFLinearizer::LinearizePDF, failed to copy objects to target file");
+	}while(false);
+
+	if(wroteBody)
+		remove(bodyFilePath.c_str());
+	mParser.ResetParser();
+	mSourceFile.CloseFile();
+	mObjectsContext.Cleanup();
+
+	return status;
+}
+
+EStatusCode PDFLinearizer::ReadDocumentStructure()
+{
+	EStatusCode status = eSuccess;
+
+	do
+	{
+		PDFObjectCastPtr<PDFIndirectObjectReference> catalogReference(mParser.GetTrailer()->QueryDirectObject("Root"));
+		if(!catalogReference)
+		{
+			TRACE_LOG("PDFLinearizer::ReadDocumentStructure, failed to read catalog reference in trailer");
+			status = eFailure;
+			break;
+		}
+		mCatalogID = catalogReference->mObjectID;
+
+		PDFObjectCastPtr<PDFIndirectObjectReference> infoReference(mParser.GetTrailer()->QueryDirectObject("Info"));
+		if(!!infoReference)
+			mInfoID = infoReference->mObjectID;
+
+		PDFObjectCastPtr<PDFDictionary> catalog(mParser.ParseNewObject(mCatalogID));
+		if(!catalog)
+		{
+			TRACE_LOG("PDFLinearizer::ReadDocumentStructure, failed to read catalog");
+			status = eFailure;
+			break;
+		}
+
+		PDFObjectCastPtr<PDFIndirectObjectReference> pagesReference(catalog->QueryDirectObject("Pages"));
+		if(!pagesReference)
+		{
+			TRACE_LOG("PDFLinearizer::ReadDocumentStructure, failed to read pages reference in catalog");
+			status = eFailure;
+			break;
+		}
+
+		if(0 == mParser.GetPagesCount())
+		{
+			TRACE_LOG("PDFLinearizer::ReadDocumentStructure, document has no pages. nothing to linearize");
+			status = eFailure;
+			break;
+		}
+
+		for(unsigned long i = 0; i < mParser.GetPagesCount(); ++i)
+		{
+			ObjectIDType pageID = mParser.GetPageObjectID(i);
+			if(0 == pageID)
+			{
+				TRACE_LOG1("PDFLinearizer::ReadDocumentStructure, failed to find page %ld",i);
+				status = eFailure;
+				break;
+			}
+			mPageIDs.push_back(pageID);
+			mPageTreeObjectIDs.insert(pageID);
+		}
+		if(status != eSuccess)
+			break;
+
+		status = CollectPageTreeNodes(pagesReference->mObjectID);
+	}while(false);
+
+	return status;
+}
+
+EStatusCode PDFLinearizer::CollectPageTreeNodes(ObjectIDType inNodeID)
+{
+	// pages nodes, in tree order. pages are already known from the parser
+	if(mPageTreeObjectIDs.find(inNodeID) != mPageTreeObjectIDs.end())
+		return eSuccess;
+
+	PDFObjectCastPtr<PDFDictionary> node(mParser.ParseNewObject(inNodeID));
+	if(!node)
+	{
+		TRACE_LOG("PDFLinearizer::CollectPageTreeNodes, failed to read page tree node");
+		return eFailure;
+	}
+
+	mPageTreeNodes.push_back(inNodeID);
+	mPageTreeObjectIDs.insert(inNodeID);
+
+	PDFObjectCastPtr<PDFArray> kids(node->QueryDirectObject("Kids"));
+	if(!kids)
+		return eSuccess;
+
+	EStatusCode status = eSuccess;
+	SingleValueContainerIterator<PDFObjectVector> it = kids->GetIterator();
+	while(it.MoveNext() && eSuccess == status)
+	{
+		if(it.GetItem()->GetType() == PDFObject::ePDFObjectIndirectObjectReference)
+			status = CollectPageTreeNodes(((PDFIndirectObjectReference*)it.GetItem())->mObjectID);
+	}
+	return status;
+}
+
+void PDFLinearizer::CollectObjectReferences(PDFObject* inObject,ObjectIDTypeVector& ioReferences)
+{
+	switch(inObject->GetType())
+	{
+		case PDFObject::ePDFObjectIndirectObjectReference:
+		{
+			// references to the catalog and the page tree are not followed. they have their own place in the file
+			ObjectIDType objectID = ((PDFIndirectObjectReference*)inObject)->mObjectID;
+			if(objectID != mCatalogID && mPageTreeObjectIDs.find(objectID) == mPageTreeObjectIDs.end())
+				ioReferences.push_back(objectID);
+			break;
+		}
+		case PDFObject::ePDFObjectArray:
+		{
+			SingleValueContainerIterator<PDFObjectVector> it = ((PDFArray*)inObject)->GetIterator();
+			while(it.MoveNext())
+				CollectObjectReferences(it.GetItem(),ioReferences);
+			break;
+		}
+		case PDFObject::ePDFObjectDictionary:
+		{
+			MapIterator<PDFNameToPDFObjectMap> it = ((PDFDictionary*)inObject)->GetIterator();
+			while(it.MoveNext())
+				CollectObjectReferences(it.GetValue(),ioReferences);
+			break;
+		}
+		case PDFObject::ePDFObjectStream:
+		{
+			// stream lengths are written directly, so a length object is not needed
+			RefCountPtr<PDFDictionary> streamDictionary(((PDFStreamInput*)inObject)->QueryStreamDictionary());
+			MapIterator<PDFNameToPDFObjectMap> it = streamDictionary->GetIterator();
+			while(it.MoveNext())
+			{
+				if(it.GetKey()->GetValue() != "Length")
+					CollectObjectReferences(it.GetValue(),ioReferences);
+			}
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+const ObjectIDTypeVector& PDFLinearizer::GetObjectReferences(ObjectIDType inObjectID)
+{
+	ObjectIDTypeToObjectIDTypeVectorMap::iterator it = mObjectsReferences.find(inObjectID);
+	if(it != mObjectsReferences.end())
+		return it->second;
+
+	ObjectIDTypeVector references;
+	RefCountPtr<PDFObject> anObject(mParser.ParseNewObject(inObjectID));
+	if(!!anObject)
+		CollectObjectReferences(anObject.GetPtr(),references);
+	else
+		mMissingObjectIDs.insert(inObjectID);
+
+	return mObjectsReferences.insert(ObjectIDTypeToObjectIDTypeVectorMap::value_type(inObjectID,references)).first->second;
+}
+
+void PDFLinearizer::CollectReachableObjects(const ObjectIDTypeVector& inRoots,ObjectIDTypeSet& ioVisited,ObjectIDTypeVector& ioObjects)
+{
+	// depth first, in references order, so objects are placed near the objects that use them
+	ObjectIDTypeVector pending(inRoots.rbegin(),inRoots.rend());
+
+	while(!pending.empty())
+	{
+		ObjectIDType objectID = pending.back();
+		pending.pop_back();
+
+		if(!ioVisited.insert(objectID).second)
+			continue;
+
+		const ObjectIDTypeVector& references = GetObjectReferences(objectID);
+		if(mMissingObjectIDs.find(objectID) != mMissingObjectIDs.end())
+			continue;
+
+		ioObjects.push_back(objectID);
+		for(ObjectIDTypeVector::const_reverse_iterator it = references.rbegin(); it != references.rend(); ++it)
+		{
+			if(ioVisited.find(*it) == ioVisited.end())
+				pending.push_back(*it);
+		}
+	}
+}
+
+static const char* scInheritedPageKeys[] = {"Resources","MediaBox","CropBox","Rotate"};
+// catalog entries that a viewer uses when opening the document, before displaying the first page. outlines are added when the document opens showing them
+static const char* scDocumentLevelCatalogKeys[] = {"OpenAction","AcroForm","ViewerPreferences","Names"};
+
+void PDFLinearizer::CollectDocumentLevelReferences(ObjectIDTypeVector& ioReferences)
+{
+	PDFObjectCastPtr<PDFDictionary> catalog(mParser.ParseNewObject(mCatalogID));
+	if(!catalog)
+		return;
+
+	for(size_t i = 0; i < sizeof(scDocumentLevelCatalogKeys)/sizeof(const char*); ++i)
+	{
+		RefCountPtr<PDFObject> value(catalog->QueryDirectObject(scDocumentLevelCatalogKeys[i]));
+		if(!!value)
+			CollectObjectReferences(value.GetPtr(),ioReferences);
+	}
+
+	PDFObjectCastPtr<PDFName> pageMode(mParser.QueryDictionaryObject(catalog.GetPtr(),"PageMode"));
+	if(!!pageMode && pageMode->GetValue() == "UseOutlines")
+	{
+		RefCountPtr<PDFObject> outlines(catalog->QueryDirectObject("Outlines"));
+		if(!!outlines)
+			CollectObjectReferences(outlines.GetPtr(),ioReferences);
+	}
+}
+
+void PDFLinearizer::ArrangeObjects()
+{
+	ObjectIDTypeVectorVector pagesReachableObjects(mPageIDs.size());
+	ObjectIDTypeToLongMap objectsUsage;
+	ObjectIDTypeSet placedObjects;
+
+	// objects used by each page, including values that the page inherits from its ancestors
+	for(unsigned long i = 0; i < mPageIDs.size(); ++i)
+	{
+		ObjectIDTypeVector roots = GetObjectReferences(mPageIDs[i]);
+		ObjectIDTypeSet visited;
+		RefCountPtr<PDFDictionary> page(mParser.ParsePage(i));
+		PDFObjectCastPtr<PDFIndirectObjectReference> parentReference(!!page ? page->QueryDirectObject("Parent") : NULL);
+		ObjectIDType parentID = !parentReference ? 0 : parentReference->mObjectID;
+		ObjectIDTypeSet ancestors;
+
+		while(parentID != 0 && ancestors.insert(parentID).second)
+		{
+			PDFObjectCastPtr<PDFDictionary> parent(mParser.ParseNewObject(parentID));
+			if(!parent)
+				break;
+			for(size_t j = 0; j < sizeof(scInheritedPageKeys)/sizeof(const char*); ++j)
+			{
+				RefCountPtr<PDFObject> inheritedValue(parent->QueryDirectObject(scInheritedPageKeys[j]));
+				if(!!inheritedValue)
+					CollectObjectReferences(inheritedValue.GetPtr(),roots);
+			}
+			PDFObjectCastPtr<PDFIndirectObjectReference> grandParentReference(parent->QueryDirectObject("Parent"));
+			parentID = !grandParentReference ? 0 : grandParentReference->mObjectID;
+		}
+
+		visited.insert(mPageIDs[i]);
+		CollectReachableObjects(roots,visited,pagesReachableObjects[i]);
+
+		for(ObjectIDTypeVector::iterator it = pagesReachableObjects[i].begin(); it != pagesReachableObjects[i].end(); ++it)
+		{
+			ObjectIDTypeToLongMap::iterator itUsage = objectsUsage.find(*it);
+			if(itUsage == objectsUsage.end())
+				objectsUsage.insert(ObjectIDTypeToLongMap::value_type(*it,(long)i));
+			else if(itUsage->second != (long)i)
+				itUsage->second = SHARED_OBJECT_USAGE;
+		}
+	}
+
+	// catalog and page tree go first, with the document level objects. objects that pages use are left for the pages
+	mDocumentObjects.push_back(mCatalogID);
+	mDocumentObjects.insert(mDocumentObjects.end(),mPageTreeNodes.begin(),mPageTreeNodes.end());
+	placedObjects.insert(mDocumentObjects.begin(),mDocumentObjects.end());
+	placedObjects.insert(mPageIDs.begin(),mPageIDs.end());
+
+	ObjectIDTypeVector documentLevelRoots;
+	ObjectIDTypeSet documentLevelVisited(placedObjects);
+	CollectDocumentLevelReferences(documentLevelRoots);
+	for(ObjectIDTypeToLongMap::iterator it = objectsUsage.begin(); it != objectsUsage.end(); ++it)
+		documentLevelVisited.insert(it->first);
+	CollectReachableObjects(documentLevelRoots,documentLevelVisited,mDocumentObjects);
+	placedObjects.insert(mDocumentObjects.begin(),mDocumentObjects.end());
+
+	// the first page gets all objects it uses, shared or not. the others get only the objects that are just theirs
+	mPagesObjects.resize(mPageIDs.size());
+	mPagesObjects[0].push_back(mPageIDs[0]);
+	mPagesObjects[0].insert(mPagesObjects[0].end(),pagesReachableObjects[0].begin(),pagesReachableObjects[0].end());
+	placedObjects.insert(pagesReachableObjects[0].begin(),pagesReachableObjects[0].end());
+
+	for(unsigned long i = 1; i < mPageIDs.size(); ++i)
+	{
+		mPagesObjects[i].push_back(mPageIDs[i]);
+		for(ObjectIDTypeVector::iterator it = pagesReachableObjects[i].begin(); it != pagesReachableObjects[i].end(); ++it)
+		{
+			if(objectsUsage[*it] == (long)i)
+			{
+				mPagesObjects[i].push_back(*it);
+				placedObjects.insert(*it);
+			}
+		}
+	}
+
+	// shared objects are identified by their index in the shared objects hint table, which starts with the first page objects
+	ObjectIDTypeToLongMap sharedObjectsIndexes;
+	for(unsigned long i = 0; i < mPagesObjects[0].size(); ++i)
+		sharedObjectsIndexes.insert(ObjectIDTypeToLongMap::value_type(mPagesObjects[0][i],(long)i));
+
+	mPagesSharedObjects.resize(mPageIDs.size());
+	for(unsigned long i = 1; i < mPageIDs.size(); ++i)
+	{
+		for(ObjectIDTypeVector::iterator it = pagesReachableObjects[i].begin(); it != pagesReachableObjects[i].end(); ++it)
+		{
+			if(objectsUsage[*it] != SHARED_OBJECT_USAGE)
+				continue;
+
+			ObjectIDTypeToLongMap::iterator itIndex = sharedObjectsIndexes.find(*it);
+			if(itIndex == sharedObjectsIndexes.end())
+			{
+				itIndex = sharedObjectsIndexes.insert(ObjectIDTypeToLongMap::value_type(*it,(long)(mPagesObjects[0].size() + mSharedObjects.size()))).first;
+				mSharedObjects.push_back(*it);
+				placedObjects.insert(*it);
+			}
+			mPagesSharedObjects[i].push_back((unsigned long)itIndex->second);
+		}
+	}
+
+	// rest of the objects - used by the catalog, the page tree (other than inherited page values) or the info dictionary
+	ObjectIDTypeVector otherRoots;
+	for(ObjectIDTypeVector::iterator it = mDocumentObjects.begin(); it != mDocumentObjects.end(); ++it)
+	{
+		const ObjectIDTypeVector& references = GetObjectReferences(*it);
+		otherRoots.insert(otherRoots.end(),references.begin(),references.end());
+	}
+	if(mInfoID != 0)
+		otherRoots.push_back(mInfoID);
+	CollectReachableObjects(otherRoots,placedObjects,mOtherObjects);
+}
+
+void PDFLinearizer::NumberObjects()
+{
+	// objects after the first page are numbered first, and go to the main cross reference section at the end of the file.
+	// the first page cross reference section is for the objects that come before them
+	ObjectIDType objectID = 1;
+
+	mSourceObjectIDs.push_back(0);
+	for(unsigned long i = 1; i < mPagesObjects.size(); ++i)
+	{
+		for(ObjectIDTypeVector::iterator it = mPagesObjects[i].begin(); it != mPagesObjects[i].end(); ++it,++objectID)
+		{
+			mNewObjectIDs.insert(ObjectIDTypeToObjectIDTypeMap::value_type(*it,objectID));
+			mSourceObjectIDs.push_back(*it);
+		}
+	}
+	for(ObjectIDTypeVector::iterator it = mSharedObjects.begin(); it != mSharedObjects.end(); ++it,++objectID)
+	{
+		mNewObjectIDs.insert(ObjectIDTypeToObjectIDTypeMap::value_type(*it,objectID));
+		mSourceObjectIDs.push_back(*it);
+	}
+	for(ObjectIDTypeVector::iterator it = mOtherObjects.begin(); it != mOtherObjects.end(); ++it,++objectID)
+	{
+		mNewObjectIDs.insert(ObjectIDTypeToObjectIDTypeMap::value_type(*it,objectID));
+		mSourceObjectIDs.push_back(*it);
+	}
+	mMainSectionSize = objectID;
+
+	// linearization dictionary, document objects, hint stream and first page objects. the linearization dictionary and
+	// the hint stream have no source objects
+	mLinearizationDictionaryID = objectID++;
+	mSourceObjectIDs.push_back(0);
+	for(ObjectIDTypeVector::iterator it = mDocumentObjects.begin(); it != mDocumentObjects.end(); ++it,++objectID)
+	{
+		mNewObjectIDs.insert(ObjectIDTypeToObjectIDTypeMap::value_type(*it,objectID));
+		mSourceObjectIDs.push_back(*it);
+	}
+	mHintStreamID = objectID++;
+	mSourceObjectIDs.push_back(0);
+	for(ObjectIDTypeVector::iterator it = mPagesObjects[0].begin(); it != mPagesObjects[0].end(); ++it,++objectID)
+	{
+		mNewObjectIDs.insert(ObjectIDTypeToObjectIDTypeMap::value_type(*it,objectID));
+		mSourceObjectIDs.push_back(*it);
+	}
+}
+
+EStatusCode PDFLinearizer::WriteBody(IByteWriterWithPosition* inBodyStream)
+{
+	EStatusCode status;
+
+	mObjectsContext.SetOutputStream(inBodyStream);
+
+	do
+	{
+		status = WriteObjects(mDocumentObjects);
+		if(status != eSuccess)
+			break;
+		mDocumentObjectsEnd = mObjectsContext.GetCurrentPosition();
+
+		for(unsigned long i = 0; i < mPagesObjects.size() && eSuccess == status; ++i)
+		{
+			status = WriteObjects(mPagesObjects[i]);
+			if(0 == i)
+				mFirstPageEnd = mObjectsContext.GetCurrentPosition();
+		}
+		if(status != eSuccess)
+			break;
+		mPagesEnd = mObjectsContext.GetCurrentPosition();
+
+		status = WriteObjects(mSharedObjects);
+		if(status != eSuccess)
+			break;
+
+		status = WriteObjects(mOtherObjects);
+		if(status != eSuccess)
+			break;
+		mBodySize = mObjectsContext.GetCurrentPosition();
+	}while(false);
+
+	return status;
+}
+
+EStatusCode PDFLinearizer::WriteObjects(const ObjectIDTypeVector& inObjects)
+{
+	EStatusCode status = eSuccess;
+
+	for(ObjectIDTypeVector::const_iterator it = inObjects.begin(); it != inObjects.end() && eSuccess == status; ++it)
+		status = WriteObject(*it);
+	return status;
+}
+
+static const std::string scObj = "obj";
+static const std::string scEndObj = "endobj";
+static const std::string scStream = "stream";
+static const std::string scEndStream = "endstream";
+
+EStatusCode PDFLinearizer::WriteObject(ObjectIDType inSourceObjectID)
+{
+	RefCountPtr<PDFObject> anObject(mParser.ParseNewObject(inSourceObjectID));
+	if(!anObject)
+	{
+		TRACE_LOG1("PDFLinearizer::WriteObject, failed to parse object %ld",inSourceObjectID);
+		return eFailure;
+	}
+
+	LongFilePositionType position = mObjectsContext.GetCurrentPosition();
+
+	mObjectsContext.WriteInteger(mNewObjectIDs[inSourceObjectID]);
+	mObjectsContext.WriteInteger(0);
+	mObjectsContext.WriteKeyword(scObj);
+	EStatusCode status = WriteObjectByType(anObject.GetPtr(),eTokenSeparatorEndLine);
+	if(eSuccess == status)
+		mObjectsContext.WriteKeyword(scEndObj);
+
+	mBodyPositions.insert(ObjectIDTypeToLongFilePositionTypeMap::value_type(inSourceObjectID,position));
+	mBodyLengths.insert(ObjectIDTypeToLongFilePositionTypeMap::value_type(inSourceObjectID,mObjectsContext.GetCurrentPosition() - position));
+	return status;
+}
+
+EStatusCode PDFLinearizer::WriteObjectByType(PDFObject* inObject,ETokenSeparator inSeparator)
+{
+	EStatusCode status = eSuccess;
+
+	switch(inObject->GetType())
+	{
+		case PDFObject::ePDFObjectBoolean:
+			mObjectsContext.WriteBoolean(((PDFBoolean*)inObject)->GetValue(),inSeparator);
+			break;
+		case PDFObject::ePDFObjectLiteralString:
+			mObjectsContext.WriteLiteralString(((PDFLiteralString*)inObject)->GetValue(),inSeparator);
+			break;
+		case PDFObject::ePDFObjectHexString:
+			mObjectsContext.WriteHexString(((PDFHexString*)inObject)->GetValue(),inSeparator);
+			break;
+		case PDFObject::ePDFObjectNull:
+			mObjectsContext.WriteNull(inSeparator);
+			break;
+		case PDFObject::ePDFObjectName:
+			mObjectsContext.WriteName(((PDFName*)inObject)->GetValue(),inSeparator);
+			break;
+		case PDFObject::ePDFObjectInteger:
+			mObjectsContext.WriteInteger(((PDFInteger*)inObject)->GetValue(),inSeparator);
+			break;
+		case PDFObject::ePDFObjectReal:
+			mObjectsContext.WriteDouble(((PDFReal*)inObject)->GetValue(),inSeparator);
+			break;
+		case PDFObject::ePDFObjectSymbol:
+			mObjectsContext.WriteKeyword(((PDFSymbol*)inObject)->GetValue());
+			break;
+		case PDFObject::ePDFObjectIndirectObjectReference:
+		{
+			// references to objects that were dropped (or never existed) become nulls, which is what they'd be read as anyways
+			ObjectIDTypeToObjectIDTypeMap::iterator it = mNewObjectIDs.find(((PDFIndirectObjectReference*)inObject)->mObjectID);
+			if(it == mNewObjectIDs.end())
+				mObjectsContext.WriteNull(inSeparator);
+			else
+				mObjectsContext.WriteIndirectObjectReference(it->second,0,inSeparator);
+			break;
+		}
+		case PDFObject::ePDFObjectArray:
+			status = WriteArray((PDFArray*)inObject,inSeparator);
+			break;
+		case PDFObject::ePDFObjectDictionary:
+			status = WriteDictionary((PDFDictionary*)inObject);
+			break;
+		case PDFObject::ePDFObjectStream:
+			status = WriteStream((PDFStreamInput*)inObject);
+			break;
+	}
+	return status;
+}
+
+EStatusCode PDFLinearizer::WriteArray(PDFArray* inArray,ETokenSeparator inSeparator)
+{
+	SingleValueContainerIterator<PDFObjectVector> it(inArray->GetIterator());
+	EStatusCode status = eSuccess;
+
+	mObjectsContext.StartArray();
+	while(it.MoveNext() && eSuccess == status)
+		status = WriteObjectByType(it.GetItem(),eTokenSeparatorSpace);
+	if(eSuccess == status)
+		mObjectsContext.EndArray(inSeparator);
+	return status;
+}
+
+EStatusCode PDFLinearizer::WriteDictionary(PDFDictionary* inDictionary)
+{
+	MapIterator<PDFNameToPDFObjectMap> it(inDictionary->GetIterator());
+	EStatusCode status = eSuccess;
+	DictionaryContext* dictionary = mObjectsContext.StartDictionary();
+
+	while(it.MoveNext() && eSuccess == status)
+	{
+		status = dictionary->WriteKey(it.GetKey()->GetValue());
+		if(eSuccess == status)
+			status = WriteObjectByType(it.GetValue(),eTokenSeparatorEndLine);
+	}
+
+	EStatusCode endStatus = mObjectsContext.EndDictionary(dictionary);
+	return eSuccess == status ? endStatus : status;
+}
+
+EStatusCode PDFLinearizer::WriteStream(PDFStreamInput* inStream)
+{
+	// the stream data is copied as is, still encoded. it's read first, to write its length directly in the stream dictionary
+	OutputStringBufferStream streamData;
+	IByteReader* streamReader = mParser.StartReadingFromStreamForPlainCopying(inStream);
+	if(!streamReader)
+	{
+		TRACE_LOG("PDFLinearizer::WriteStream, failed to read stream");
+		return eFailure;
+	}
+	OutputStreamTraits streamDataTraits(&streamData);
+	EStatusCode status = streamDataTraits.CopyToOutputStream(streamReader);
+	delete streamReader;
+	if(status != eSuccess)
+	{
+		TRACE_LOG("PDFLinearizer::WriteStream, failed to read stream");
+		return status;
+	}
+
+	RefCountPtr<PDFDictionary> streamDictionary(inStream->QueryStreamDictionary());
+	MapIterator<PDFNameToPDFObjectMap> it(streamDictionary->GetIterator());
+	DictionaryContext* dictionary = mObjectsContext.StartDictionary();
+
+	while(it.MoveNext() && eSuccess == status)
+	{
+		if(it.GetKey()->GetValue() == "Length")
+			continue;
+		status = dictionary->WriteKey(it.GetKey()->GetValue());
+		if(eSuccess == status)
+			status = WriteObjectByType(it.GetValue(),eTokenSeparatorEndLine);
+	}
+	if(status != eSuccess)
+	{
+		mObjectsContext.EndDictionary(dictionary);
+		TRACE_LOG("PDFLinearizer::WriteStream, failed to write stream dictionary");
+		return status;
+	}
+
+	std::string data = streamData.ToString();
+	dictionary->WriteKey("Length");
+	dictionary->WriteIntegerValue((long long)data.size());
+	mObjectsContext.EndDictionary(dictionary);
+	mObjectsContext.WriteKeyword(scStream);
+	IByteWriterWithPosition* freeContextOutput = mObjectsContext.StartFreeContext();
+	freeContextOutput->Write((const Byte*)data.c_str(),data.size());
+	mObjectsContext.EndFreeContext();
+	mObjectsContext.EndLine();
+	mObjectsContext.WriteKeyword(scEndStream);
+	return eSuccess;
+}
+
+LongFilePositionType PDFLinearizer::GetBodyPosition(ObjectIDType inSourceObjectID)
+{
+	ObjectIDTypeToLongFilePositionTypeMap::iterator it = mBodyPositions.find(inSourceObjectID);
+	return it == mBodyPositions.end() ? 0 : it->second;
+}
+
+LongFilePositionType PDFLinearizer::GetFilePosition(ObjectIDType inSourceObjectID,LongFilePositionType inFirstPartSize,LongFilePositionType inHintStreamSize)
+{
+	// objects after the catalog and page tree are placed after the hint stream
+	LongFilePositionType bodyPosition = GetBodyPosition(inSourceObjectID);
+	return inFirstPartSize + bodyPosition + (bodyPosition < mDocumentObjectsEnd ? 0 : inHintStreamSize);
+}
+
+// writes hint tables values, as bit fields of given sizes
+class HintTableWriter
+{
+public:
+	HintTableWriter() {mCurrentByte = 0;mBitsInCurrentByte = 0;}
+
+	void WriteBits(unsigned long long inValue,unsigned int inBitsCount)
+	{
+		for(unsigned int i = inBitsCount; i > 0; --i)
+		{
+			mCurrentByte = (unsigned char)((mCurrentByte << 1) | ((inValue >> (i - 1)) & 1));
+			if(8 == ++mBitsInCurrentByte)
+				FlushByte();
+		}
+	}
+
+	// hint table items start at a byte boundary
+	void AlignToByte()
+	{
+		if(mBitsInCurrentByte > 0)
+		{
+			mCurrentByte = (unsigned char)(mCurrentByte << (8 - mBitsInCurrentByte));
+			FlushByte();
+		}
+	}
+
+	const std::string& GetData() {return mData;}
+
+private:
+	std::string mData;
+	unsigned char mCurrentByte;
+	unsigned int mBitsInCurrentByte;
+
+	void FlushByte()
+	{
+		mData.push_back((char)mCurrentByte);
+		mCurrentByte = 0;
+		mBitsInCurrentByte = 0;
+	}
+};
+
+static unsigned int BitsNeeded(unsigned long long inValue)
+{
+	unsigned int bits = 0;
+	while(inValue > 0)
+	{
+		++bits;
+		inValue >>= 1;
+	}
+	return bits;
+}
+
+std::string PDFLinearizer::CreateHintStreamData(LongFilePositionType inFirstPartSize,unsigned long& outSharedObjectsTablePosition)
+{
+	// positions in hint tables are as if the hint stream wasn't there
+	HintTableWriter writer;
+	unsigned long pagesCount = (unsigned long)mPagesObjects.size();
+	std::vector<unsigned long long> pagesLengths(pagesCount);
+	unsigned long long leastObjectsCount = 0,mostObjectsCount = 0,leastLength = 0,mostLength = 0;
+	unsigned long mostSharedObjects = 0;
+	unsigned long long mostSharedIdentifier = 0;
+
+	for(unsigned long i = 0; i < pagesCount; ++i)
+	{
+		LongFilePositionType pageStart = GetBodyPosition(mPageIDs[i]);
+		LongFilePositionType pageEnd = (0 == i) ? mFirstPageEnd : ((i + 1 < pagesCount) ? GetBodyPosition(mPageIDs[i + 1]) : mPagesEnd);
+		pagesLengths[i] = (unsigned long long)(pageEnd - pageStart);
+
+		if(0 == i || mPagesObjects[i].size() < leastObjectsCount)
+			leastObjectsCount = mPagesObjects[i].size();
+		if(0 == i || mPagesObjects[i].size() > mostObjectsCount)
+			mostObjectsCount = mPagesObjects[i].size();
+		if(0 == i || pagesLengths[i] < leastLength)
+			leastLength = pagesLengths[i];
+		if(0 == i || pagesLengths[i] > mostLength)
+			mostLength = pagesLengths[i];
+		if(mPagesSharedObjects[i].size() > mostSharedObjects)
+			mostSharedObjects = (unsigned long)mPagesSharedObjects[i].size();
+		for(std::vector<unsigned long>::iterator it = mPagesSharedObjects[i].begin(); it != mPagesSharedObjects[i].end(); ++it)
+			if(*it > mostSharedIdentifier)
+				mostSharedIdentifier = *it;
+	}
+
+	unsigned int objectsCountBits = BitsNeeded(mostObjectsCount - leastObjectsCount);
+	unsigned int lengthBits = BitsNeeded(mostLength - leastLength);
+	unsigned int sharedObjectsBits = BitsNeeded(mostSharedObjects);
+	unsigned int sharedIdentifierBits = BitsNeeded(mostSharedIdentifier);
+
+	// page offset hint table header. content stream offsets and lengths are given as the whole page
+	writer.WriteBits(leastObjectsCount,32);
+	writer.WriteBits((unsigned long long)(inFirstPartSize + GetBodyPosition(mPageIDs[0])),32);
+	writer.WriteBits(objectsCountBits,16);
+	writer.WriteBits(leastLength,32);
+	writer.WriteBits(lengthBits,16);
+	writer.WriteBits(0,32);
+	writer.WriteBits(0,16);
+	writer.WriteBits(leastLength,32);
+	writer.WriteBits(lengthBits,16);
+	writer.WriteBits(sharedObjectsBits,16);
+	writer.WriteBits(sharedIdentifierBits,16);
+	writer.WriteBits(0,16);
+	writer.WriteBits(1,16);
+
+	// page offset hint table entries, each item for all pages
+	for(unsigned long i = 0; i < pagesCount; ++i)
+		writer.WriteBits(mPagesObjects[i].size() - leastObjectsCount,objectsCountBits);
+	writer.AlignToByte();
+	for(unsigned long i = 0; i < pagesCount; ++i)
+		writer.WriteBits(pagesLengths[i] - leastLength,lengthBits);
+	writer.AlignToByte();
+	for(unsigned long i = 0; i < pagesCount; ++i)
+		writer.WriteBits(mPagesSharedObjects[i].size(),sharedObjectsBits);
+	writer.AlignToByte();
+	for(unsigned long i = 0; i < pagesCount; ++i)
+		for(std::vector<unsigned long>::iterator it = mPagesSharedObjects[i].begin(); it != mPagesSharedObjects[i].end(); ++it)
+			writer.WriteBits(*it,sharedIdentifierBits);
+	writer.AlignToByte();
+	// (no numerators, and no content stream offsets)
+	for(unsigned long i = 0; i < pagesCount; ++i)
+		writer.WriteBits(pagesLengths[i] - leastLength,lengthBits);
+	writer.AlignToByte();
+
+	outSharedObjectsTablePosition = (unsigned long)writer.GetData().size();
+
+	// shared objects hint table. first page objects, then the shared objects section, one object per group
+	ObjectIDTypeVector sharedObjects(mPagesObjects[0].begin(),mPagesObjects[0].end());
+	sharedObjects.insert(sharedObjects.end(),mSharedObjects.begin(),mSharedObjects.end());
+	unsigned long long leastGroupLength = 0,mostGroupLength = 0;
+
+	for(ObjectIDTypeVector::iterator it = sharedObjects.begin(); it != sharedObjects.end(); ++it)
+	{
+		unsigned long long groupLength = (unsigned long long)mBodyLengths[*it];
+		if(it == sharedObjects.begin() || groupLength < leastGroupLength)
+			leastGroupLength = groupLength;
+		if(it == sharedObjects.begin() || groupLength > mostGroupLength)
+			mostGroupLength = groupLength;
+	}
+	unsigned int groupLengthBits = BitsNeeded(mostGroupLength - leastGroupLength);
+
+	writer.WriteBits(mSharedObjects.empty() ? 0 : mNewObjectIDs[mSharedObjects[0]],32);
+	writer.WriteBits(mSharedObjects.empty() ? 0 : (unsigned long long)(inFirstPartSize + GetBodyPosition(mSharedObjects[0])),32);
+	writer.WriteBits(mPagesObjects[0].size(),32);
+	writer.WriteBits(sharedObjects.size(),32);
+	writer.WriteBits(0,16);
+	writer.WriteBits(leastGroupLength,32);
+	writer.WriteBits(groupLengthBits,16);
+
+	for(ObjectIDTypeVector::iterator it = sharedObjects.begin(); it != sharedObjects.end(); ++it)
+		writer.WriteBits((unsigned long long)mBodyLengths[*it] - leastGroupLength,groupLengthBits);
+	writer.AlignToByte();
+	// no signatures
+	for(size_t i = 0; i < sharedObjects.size(); ++i)
+		writer.WriteBits(0,1);
+	writer.AlignToByte();
+
+	return writer.GetData();
+}
+
+void PDFLinearizer::StartStringOutput(OutputStringBufferStream& inStream)
+{
+	mObjectsContext.SetOutputStream(&inStream);
+}
+
+std::string PDFLinearizer::CreateHintStream(LongFilePositionType inFirstPartSize)
+{
+	OutputStringBufferStream hintStream;
+	unsigned long sharedObjectsTablePosition;
+	std::string data = CreateHintStreamData(inFirstPartSize,sharedObjectsTablePosition);
+
+	StartStringOutput(hintStream);
+	mObjectsContext.WriteInteger(mHintStreamID);
+	mObjectsContext.WriteInteger(0);
+	mObjectsContext.WriteKeyword(scObj);
+	DictionaryContext* dictionary = mObjectsContext.StartDictionary();
+	dictionary->WriteKey("S");
+	dictionary->WriteIntegerValue(sharedObjectsTablePosition);
+	dictionary->WriteKey("Length");
+	dictionary->WriteIntegerValue((long long)data.size());
+	mObjectsContext.EndDictionary(dictionary);
+	mObjectsContext.WriteKeyword(scStream);
+	IByteWriterWithPosition* freeContextOutput = mObjectsContext.StartFreeContext();
+	freeContextOutput->Write((const Byte*)data.c_str(),data.size());
+	mObjectsContext.EndFreeContext();
+	mObjectsContext.EndLine();
+	mObjectsContext.WriteKeyword(scEndStream);
+	mObjectsContext.WriteKeyword(scEndObj);
+
+	return hintStream.ToString();
+}
+
+static const std::string scXref = "xref";
+static const std::string scTrailer = "trailer";
+static const std::string scStartXref = "startxref";
+static const IOBasicTypes::Byte scBinaryBytesArray[] = {'%',0xBD,0xBE,0xBC,'\r','\n'};
+static const IOBasicTypes::Byte scEOF[] = {'%','%','E','O','F','\r','\n'};
+
+void PDFLinearizer::WriteXrefEntry(LongFilePositionType inPosition)
+{
+	char entryBuffer[21];
+
+	SAFE_SPRINTF_1(entryBuffer,21,"%010lld 00000 n\r\n",inPosition);
+	IByteWriterWithPosition* freeContextOutput = mObjectsContext.StartFreeContext();
+	freeContextOutput->Write((const Byte*)entryBuffer,20);
+	mObjectsContext.EndFreeContext();
+}
+
+std::string PDFLinearizer::CreateMainXref(LongFilePositionType inFirstPartSize,
+										LongFilePositionType inHintStreamSize,
+										LongFilePositionType inFirstPageXrefPosition,
+										LongFilePositionType& outFirstEntryPosition)
+{
+	OutputStringBufferStream mainXref;
+
+	StartStringOutput(mainXref);
+	mObjectsContext.WriteKeyword(scXref);
+	mObjectsContext.WriteInteger(0);
+	mObjectsContext.WriteInteger(mMainSectionSize,eTokenSeparatorEndLine);
+	outFirstEntryPosition = mObjectsContext.GetCurrentPosition();
+
+	IByteWriterWithPosition* freeContextOutput = mObjectsContext.StartFreeContext();
+	freeContextOutput->Write((const Byte*)"0000000000 65535 f\r\n",20);
+	mObjectsContext.EndFreeContext();
+	for(ObjectIDType i = 1; i < mMainSectionSize; ++i)
+		WriteXrefEntry(GetFilePosition(mSourceObjectIDs[i],inFirstPartSize,inHintStreamSize));
+
+	mObjectsContext.WriteKeyword(scTrailer);
+	DictionaryContext* dictionary = mObjectsContext.StartDictionary();
+	dictionary->WriteKey("Size");
+	dictionary->WriteIntegerValue(mMainSectionSize);
+	mObjectsContext.EndDictionary(dictionary);
+	mObjectsContext.WriteKeyword(scStartXref);
+	mObjectsContext.WriteInteger(inFirstPageXrefPosition,eTokenSeparatorEndLine);
+	freeContextOutput = mObjectsContext.StartFreeContext();
+	freeContextOutput->Write(scEOF,5);
+	mObjectsContext.EndFreeContext();
+
+	return mainXref.ToString();
+}
+
+std::string PDFLinearizer::CreateFirstPart(LongFilePositionType inFirstPartSize,
+										LongFilePositionType inHintStreamSize,
+										LongFilePositionType inMainXrefSize,
+										LongFilePositionType inMainXrefFirstEntryPosition,
+										LongFilePositionType& outFirstPageXrefPosition)
+{
+	OutputStringBufferStream firstPart;
+	LongFilePositionType hintStreamPosition = inFirstPartSize + mDocumentObjectsEnd;
+	LongFilePositionType mainXrefPosition = inFirstPartSize + inHintStreamSize + mBodySize;
+	char versionBuffer[16];
+
+	StartStringOutput(firstPart);
+
+	// header
+	SAFE_SPRINTF_1(versionBuffer,16,"PDF-%.1f",mParser.GetPDFLevel());
+	mObjectsContext.WriteComment(versionBuffer);
+	IByteWriterWithPosition* freeContextOutput = mObjectsContext.StartFreeContext();
+	freeContextOutput->Write(scBinaryBytesArray,6);
+	mObjectsContext.EndFreeContext();
+
+	// linearization parameters
+	LongFilePositionType linearizationDictionaryPosition = mObjectsContext.GetCurrentPosition();
+	mObjectsContext.WriteInteger(mLinearizationDictionaryID);
+	mObjectsContext.WriteInteger(0);
+	mObjectsContext.WriteKeyword(scObj);
+	DictionaryContext* dictionary = mObjectsContext.StartDictionary();
+	dictionary->WriteKey("Linearized");
+	dictionary->WriteIntegerValue(1);
+	dictionary->WriteKey("L");
+	dictionary->WriteIntegerValue(mainXrefPosition + inMainXrefSize);
+	dictionary->WriteKey("H");
+	mObjectsContext.StartArray();
+	mObjectsContext.WriteInteger(hintStreamPosition);
+	mObjectsContext.WriteInteger(inHintStreamSize);
+	mObjectsContext.EndArray(eTokenSeparatorEndLine);
+	dictionary->WriteKey("O");
+	dictionary->WriteIntegerValue(mNewObjectIDs[mPageIDs[0]]);
+	dictionary->WriteKey("E");
+	dictionary->WriteIntegerValue(inFirstPartSize + inHintStreamSize + mFirstPageEnd);
+	dictionary->WriteKey("N");
+	dictionary->WriteIntegerValue(mPageIDs.size());
+	dictionary->WriteKey("T");
+	dictionary->WriteIntegerValue(mainXrefPosition + inMainXrefFirstEntryPosition - 1);
+	mObjectsContext.EndDictionary(dictionary);
+	mObjectsContext.WriteKeyword(scEndObj);
+
+	// first page cross reference section
+	outFirstPageXrefPosition = mObjectsContext.GetCurrentPosition();
+	mObjectsContext.WriteKeyword(scXref);
+	mObjectsContext.WriteInteger(mLinearizationDictionaryID);
+	mObjectsContext.WriteInteger(mSourceObjectIDs.size() - mLinearizationDictionaryID,eTokenSeparatorEndLine);
+	WriteXrefEntry(linearizationDictionaryPosition);
+	for(ObjectIDType i = mLinearizationDictionaryID + 1; i < mSourceObjectIDs.size(); ++i)
+		WriteXrefEntry(i == mHintStreamID ? hintStreamPosition : GetFilePosition(mSourceObjectIDs[i],inFirstPartSize,inHintStreamSize));
+
+	// trailer, with the main cross reference section as previous
+	mObjectsContext.WriteKeyword(scTrailer);
+	dictionary = mObjectsContext.StartDictionary();
+	dictionary->WriteKey("Size");
+	dictionary->WriteIntegerValue(mSourceObjectIDs.size());
+	dictionary->WriteKey("Prev");
+	dictionary->WriteIntegerValue(mainXrefPosition);
+	dictionary->WriteKey("Root");
+	dictionary->WriteObjectReferenceValue(mNewObjectIDs[mCatalogID]);
+	if(mInfoID != 0 && mNewObjectIDs.find(mInfoID) != mNewObjectIDs.end())
+	{
+		dictionary->WriteKey("Info");
+		dictionary->WriteObjectReferenceValue(mNewObjectIDs[mInfoID]);
+	}
+	RefCountPtr<PDFObject> documentID(mParser.GetTrailer()->QueryDirectObject("ID"));
+	if(!!documentID)
+	{
+		dictionary->WriteKey("ID");
+		WriteObjectByType(documentID.GetPtr(),eTokenSeparatorEndLine);
+	}
+	mObjectsContext.EndDictionary(dictionary);
+	mObjectsContext.WriteKeyword(scStartXref);
+	mObjectsContext.WriteInteger(0,eTokenSeparatorEndLine);
+	freeContextOutput = mObjectsContext.StartFreeContext();
+	freeContextOutput->Write(scEOF,7);
+	mObjectsContext.EndFreeContext();
+
+	return firstPart.ToString();
+}
@@ -0,0 +1,150 @@
+/*
+   Source File : PDFLinearizer.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "EStatusCode.h"
+#include "ObjectsBasicTypes.h"
+#include "ETokenSeparator.h"
+#include "PDFParser.h"
+#include "InputFile.h"
+#include "ObjectsContext.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+
+/*
+	Writes a linearized ("Fast Web View") copy of a PDF file, so viewers reading it over a slow link can show the first page
+	before the whole file arrives, and then get to any page without reading the ones before it.
+
+	The copy is laid out per the linearization appendix of the PDF reference: the linearization parameters dictionary and a cross
+	reference section for the first page come first, then the catalog and the page tree, the primary hint stream, the first page with
+	all the objects it uses, the other pages each with the objects used only by it, the objects shared between pages, and the rest of the
+	objects. The hint stream has the page offset and shared objects hint tables, each shared object being a group of its own.
+
+	Objects are copied as they are (streams are not decoded), with new object numbers. Objects not reachable from the catalog,
+	the info dictionary or the pages are dropped. Encrypted files, and files that the parser can't read the pages of, are not supported.
+	PDFWriter uses this when PDFCreationSettings::Linearize is set, to linearize the document when it ends.
+*/
+
+typedef std::vector<ObjectIDType> ObjectIDTypeVector;
+typedef std::set<ObjectIDType> ObjectIDTypeSet;
+typedef std::map<ObjectIDType,ObjectIDType> ObjectIDTypeToObjectIDTypeMap;
+typedef std::map<ObjectIDType,ObjectIDTypeVector> ObjectIDTypeToObjectIDTypeVectorMap;
+typedef std::map<ObjectIDType,long> ObjectIDTypeToLongMap;
+typedef std::vector<ObjectIDTypeVector> ObjectIDTypeVectorVector;
+typedef std::map<ObjectIDType,LongFilePositionType> ObjectIDTypeToLongFilePositionTypeMap;
+
+class PDFObject;
+class PDFArray;
+class PDFDictionary;
+class PDFStreamInput;
+class IByteWriterWithPosition;
+class OutputStringBufferStream;
+
+class PDFLinearizer
+{
+public:
+	PDFLinearizer(void);
+	~PDFLinearizer(void);
+
+	// write a linearized copy of the file at inSourceFilePath to inTargetFilePath. inTargetFilePath is used
+	// with a temporary file extension as well, for the body of the document while it is being laid out
+	PDFHummus::EStatusCode LinearizePDF(const std::string& inSourceFilePath,
+										const std::string& inTargetFilePath,
+										const PDFParsingOptions& inParsingOptions = PDFParsingOptions::DefaultPDFParsingOptions);
+
+private:
+	InputFile mSourceFile;
+	PDFParser mParser;
+	ObjectsContext mObjectsContext;
+
+	ObjectIDType mCatalogID;
+	ObjectIDType mInfoID;
+	ObjectIDTypeVector mPageIDs;
+	// page tree nodes other than pages, in tree order
+	ObjectIDTypeVector mPageTreeNodes;
+	// page tree nodes and pages
+	ObjectIDTypeSet mPageTreeObjectIDs;
+	ObjectIDTypeSet mMissingObjectIDs;
+	// references of objects, per object, without references to the catalog and the page tree
+	ObjectIDTypeToObjectIDTypeVectorMap mObjectsReferences;
+
+	// objects per part of the linearized file. document objects are the catalog, the page tree and the objects of catalog entries
+	// needed for opening the document (see CollectDocumentLevelReferences) that pages don't use
+	ObjectIDTypeVector mDocumentObjects;
+	// the first page entry has all objects the first page uses, the others only the objects used by just that page
+	ObjectIDTypeVectorVector mPagesObjects;
+	ObjectIDTypeVector mSharedObjects;
+	ObjectIDTypeVector mOtherObjects;
+	// shared objects used by each page, as indexes in the shared objects hint table
+	std::vector<std::vector<unsigned long> > mPagesSharedObjects;
+
+	ObjectIDTypeToObjectIDTypeMap mNewObjectIDs;
+	// source object IDs by new object IDs, 0 for objects that are not copied
+	ObjectIDTypeVector mSourceObjectIDs;
+	ObjectIDType mMainSectionSize;
+	ObjectIDType mLinearizationDictionaryID;
+	ObjectIDType mHintStreamID;
+
+	// positions of objects in the body, which is the file without its first part (till the end of the first page cross reference section) and without the hint stream
+	ObjectIDTypeToLongFilePositionTypeMap mBodyPositions;
+	ObjectIDTypeToLongFilePositionTypeMap mBodyLengths;
+	LongFilePositionType mDocumentObjectsEnd;
+	LongFilePositionType mFirstPageEnd;
+	LongFilePositionType mPagesEnd;
+	LongFilePositionType mBodySize;
+
+	void Reset();
+	PDFHummus::EStatusCode ReadDocumentStructure();
+	PDFHummus::EStatusCode CollectPageTreeNodes(ObjectIDType inNodeID);
+	const ObjectIDTypeVector& GetObjectReferences(ObjectIDType inObjectID);
+	void CollectObjectReferences(PDFObject* inObject,ObjectIDTypeVector& ioReferences);
+	void CollectReachableObjects(const ObjectIDTypeVector& inRoots,ObjectIDTypeSet& ioVisited,ObjectIDTypeVector& ioObjects);
+	void CollectDocumentLevelReferences(ObjectIDTypeVector& ioReferences);
+	void ArrangeObjects();
+	void NumberObjects();
+
+	PDFHummus::EStatusCode WriteBody(IByteWriterWithPosition* inBodyStream);
+	PDFHummus::EStatusCode WriteObjects(const ObjectIDTypeVector& inObjects);
+	PDFHummus::EStatusCode WriteObject(ObjectIDType inSourceObjectID);
+	PDFHummus::EStatusCode WriteObjectByType(PDFObject* inObject,ETokenSeparator inSeparator);
+	PDFHummus::EStatusCode WriteArray(PDFArray* inArray,ETokenSeparator inSeparator);
+	PDFHummus::EStatusCode WriteDictionary(PDFDictionary* inDictionary);
+	PDFHummus::EStatusCode WriteStream(PDFStreamInput* inStream);
+
+	std::string CreateHintStreamData(LongFilePositionType inFirstPartSize,unsigned long& outSharedObjectsTablePosition);
+	std::string CreateHintStream(LongFilePositionType inFirstPartSize);
+	std::string CreateFirstPart(LongFilePositionType inFirstPartSize,
+								LongFilePositionType inHintStreamSize,
+								LongFilePositionType inMainXrefSize,
+								LongFilePositionType inMainXrefFirstEntryPosition,
+								LongFilePositionType& outFirstPageXrefPosition);
+	std::string CreateMainXref(LongFilePositionType inFirstPartSize,
+								LongFilePositionType inHintStreamSize,
+								LongFilePositionType inFirstPageXrefPosition,
+								LongFilePositionType& outFirstEntryPosition);
+	void WriteXrefEntry(LongFilePositionType inPosition);
+	LongFilePositionType GetBodyPosition(ObjectIDType inSourceObjectID);
+	LongFilePositionType GetFilePosition(ObjectIDType inSourceObjectID,LongFilePositionType inFirstPartSize,LongFilePositionType inHintStreamSize);
+	void StartStringOutput(OutputStringBufferStream& inStream);
+};
@@ -0,0 +1,152 @@
+/*
+   Source File : PDFMetrics.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "PDFMetrics.h"
+
+#include <sstream>
+#include <locale>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+static const char* scPhaseNames[ePDFMetricsPhasesCount] = {"parseDirectory","copyPages","fontEmbedding","endPDF"};
+
+// phases are timed by the wall clock, as what matters is the latency of the document [clock() would count cpu time of all threads]
+static double GetWallClockMiliSeconds()
+{
+#ifdef WIN32
+	LARGE_INTEGER frequency,counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (double)counter.QuadPart * 1000 / (double)frequency.QuadPart;
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return (double)now.tv_sec * 1000 + (double)now.tv_nsec / 1000000;
+#endif
+}
+
+PDFMetricsCounters::PDFMetricsCounters()
+{
+	ObjectsParsed = 0;
+	ObjectsWritten = 0;
+	BytesInflated = 0;
+	BytesDeflated = 0;
+	ObjectStreamCacheHits = 0;
+	ObjectStreamCacheMisses = 0;
+	FontsSubset = 0;
+	GlyphsEmbedded = 0;
+	ImagesWritten = 0;
+}
+
+std::string PDFMetricsSnapshot::ToJSON() const
+{
+	std::stringstream json;
+	json.imbue(std::locale::classic());
+	json.setf(std::ios::fixed);
+	json.precision(3);
+
+	json<<"{\"counters\":{"<<
+			"\"objectsParsed\":"<<Counters.ObjectsParsed<<
+			",\"objectsWritten\":"<<Counters.ObjectsWritten<<
+			",\"bytesInflated\":"<<Counters.BytesInflated<<
+			",\"bytesDeflated\":"<<Counters.BytesDeflated<<
+			",\"objectStreamCacheHits\":"<<Counters.ObjectStreamCacheHits<<
+			",\"objectStreamCacheMisses\":"<<Counters.ObjectStreamCacheMisses<<
+			",\"fontsSubset\":"<<Counters.FontsSubset<<
+			",\"glyphsEmbedded\":"<<Counters.GlyphsEmbedded<<
+			",\"imagesWritten\":"<<Counters.ImagesWritten<<
+			"},\"phases\":{";
+	for(int i = 0; i < ePDFMetricsPhasesCount; ++i)
+	{
+		if(i > 0)
+			json<<",";
+		json<<"\""<<scPhaseNames[i]<<"\":{\"count\":"<<Phases[i].Count<<",\"milliseconds\":"<<Phases[i].MiliSeconds<<"}";
+	}
+	json<<"}}";
+
+	return json.str();
+}
+
+PDFMetrics::PDFMetrics(void)
+{
+	Reset();
+}
+
+PDFMetrics::~PDFMetrics(void)
+{
+}
+
+PDFMetricsCounters& PDFMetrics::GetCounters()
+{
+	return mSnapshot.Counters;
+}
+
+void PDFMetrics::StartPhase(EPDFMetricsPhase inPhase)
+{
+	if(0 == mPhaseDepth[inPhase]++)
+		mPhaseStartTime[inPhase] = GetWallClockMiliSeconds();
+}
+
+void PDFMetrics::EndPhase(EPDFMetricsPhase inPhase)
+{
+	if(0 == mPhaseDepth[inPhase])
+		return;
+
+	if(0 == --mPhaseDepth[inPhase])
+	{
+		++mSnapshot.Phases[inPhase].Count;
+		mSnapshot.Phases[inPhase].MiliSeconds += GetWallClockMiliSeconds() - mPhaseStartTime[inPhase];
+	}
+}
+
+PDFMetricsSnapshot PDFMetrics::GetSnapshot()
+{
+	return mSnapshot;
+}
+
+std::string PDFMetrics::ToJSON()
+{
+	return mSnapshot.ToJSON();
+}
+
+void PDFMetrics::Reset()
+{
+	mSnapshot = PDFMetricsSnapshot();
+	for(int i = 0; i < ePDFMetricsPhasesCount; ++i)
+	{
+		mPhaseDepth[i] = 0;
+		mPhaseStartTime[i] = 0;
+	}
+}
+
+PDFMetricsPhaseScope::PDFMetricsPhaseScope(PDFMetrics& inMetrics,EPDFMetricsPhase inPhase):mMetrics(inMetrics)
+{
+	mPhase = inPhase;
+	mMetrics.StartPhase(mPhase);
+}
+
+PDFMetricsPhaseScope::~PDFMetricsPhaseScope(void)
+{
+	mMetrics.EndPhase(mPhase);
+}
@@ -0,0 +1,112 @@
+/*
+   Source File : PDFMetrics.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include <string>
+
+/*
+	Counters and phase timings of the work done in writing or parsing a document, so the time spent on a document
+	can be attributed without a profiler. PDFWriter collects them per document (see PDFWriter::GetMetrics), and so does
+	PDFParser (see PDFParser::GetMetrics/SetMetrics). parsers used by a writer, e.g. for copying pages, count into the writer metrics.
+	metrics are updated by the thread working on the document, and are not synchronized.
+*/
+
+enum EPDFMetricsPhase
+{
+	ePDFMetricsPhaseParseDirectory, // parsing a file header, xref, trailer and pages list
+	ePDFMetricsPhaseCopyPages, // copying pages from other PDFs, as pages, forms or merged into pages
+	ePDFMetricsPhaseFontEmbedding, // writing the used fonts, including subsetting them
+	ePDFMetricsPhaseEndPDF, // ending the document, including fonts, xref and linearization
+	ePDFMetricsPhasesCount
+};
+
+struct PDFMetricsCounters
+{
+	unsigned long long ObjectsParsed;
+	unsigned long long ObjectsWritten;
+	// decoded bytes read from flate streams
+	unsigned long long BytesInflated;
+	// bytes compressed into flate streams
+	unsigned long long BytesDeflated;
+	unsigned long long ObjectStreamCacheHits;
+	unsigned long long ObjectStreamCacheMisses;
+	// embedded font programs written, and the glyphs in them
+	unsigned long long FontsSubset;
+	unsigned long long GlyphsEmbedded;
+	unsigned long long ImagesWritten;
+
+	PDFMetricsCounters();
+};
+
+struct PDFMetricsPhaseTiming
+{
+	// times the phase ran, and its total wall clock time
+	unsigned long Count;
+	double MiliSeconds;
+
+	PDFMetricsPhaseTiming(){Count = 0;MiliSeconds = 0;}
+};
+
+struct PDFMetricsSnapshot
+{
+	PDFMetricsCounters Counters;
+	PDFMetricsPhaseTiming Phases[ePDFMetricsPhasesCount];
+
+	// e.g. {"counters":{"objectsParsed":0,...},"phases":{"parseDirectory":{"count":0,"milliseconds":0.000},...}}
+	std::string ToJSON() const;
+};
+
+class PDFMetrics
+{
+public:
+	PDFMetrics(void);
+	~PDFMetrics(void);
+
+	// counters are updated directly, e.g. GetCounters().ObjectsWritten++
+	PDFMetricsCounters& GetCounters();
+
+	// phases may nest, or be started again while running, in which case they are timed from the outermost start to its end
+	void StartPhase(EPDFMetricsPhase inPhase);
+	void EndPhase(EPDFMetricsPhase inPhase);
+
+	// counters and timings of ended phases
+	PDFMetricsSnapshot GetSnapshot();
+	std::string ToJSON();
+
+	void Reset();
+
+private:
+	PDFMetricsSnapshot mSnapshot;
+	unsigned long mPhaseDepth[ePDFMetricsPhasesCount];
+	double mPhaseStartTime[ePDFMetricsPhasesCount];
+};
+
+// times a phase for the scope lifetime
+class PDFMetricsPhaseScope
+{
+public:
+	PDFMetricsPhaseScope(PDFMetrics& inMetrics,EPDFMetricsPhase inPhase);
+	~PDFMetricsPhaseScope(void);
+
+private:
+	PDFMetrics& mMetrics;
+	EPDFMetricsPhase mPhase;
+};
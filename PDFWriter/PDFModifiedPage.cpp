@@ -256,7 +256,7 @@ PDFHummus::EStatusCode PDFModifiedPage::WritePage()
 	if (newEncapsulatingObjectID != 0)
 	{
 		objectContext.StartNewIndirectObject(newEncapsulatingObjectID);
-		newStream = objectContext.StartPDFStream();
+		newStream = objectContext.StartPDFStream(NULL,false,eStreamCategoryPageContent);
 		primitivesWriter.SetStreamForWriting(newStream->GetWriteStream());
 		primitivesWriter.WriteKeyword("q");
 		objectContext.EndPDFStream(newStream);
@@ -265,7 +265,7 @@ PDFHummus::EStatusCode PDFModifiedPage::WritePage()
 
     // last but not least, create the actual content stream object, placing the form
 	objectContext.StartNewIndirectObject(newContentObjectID);
-	newStream = objectContext.StartPDFStream();
+	newStream = objectContext.StartPDFStream(NULL,false,eStreamCategoryPageContent);
 	primitivesWriter.SetStreamForWriting(newStream->GetWriteStream());
 
 	if (newEncapsulatingObjectID != 0) {
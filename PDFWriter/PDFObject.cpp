@@ -19,6 +19,10 @@
    
 */
 #include "PDFObject.h"
+#include "PDFObjectsArena.h"
+
+// allocation header, holding the arena that the object was allocated from. sized to keep the object aligned as the allocator would
+#define ALLOCATION_HEADER_SIZE 16
 
 const char* PDFObject::scPDFObjectTypeLabel[] = 
 {
@@ -93,3 +97,36 @@ void PDFObject::DeleteMetadata(const std::string& inKey) {
 	void* result = DetachMetadata(inKey);
 	delete result;
 }
+
+void* PDFObject::operator new(size_t inSize)
+{
+	return operator new(inSize,(PDFObjectsArena*)NULL);
+}
+
+void* PDFObject::operator new(size_t inSize,PDFObjectsArena* inArena)
+{
+	IOBasicTypes::Byte* memory = (IOBasicTypes::Byte*)(inArena ? inArena->Allocate(inSize + ALLOCATION_HEADER_SIZE) : ::operator new(inSize + ALLOCATION_HEADER_SIZE));
+
+	*((PDFObjectsArena**)memory) = inArena;
+	return memory + ALLOCATION_HEADER_SIZE;
+}
+
+void PDFObject::operator delete(void* inObject)
+{
+	if(!inObject)
+		return;
+
+	IOBasicTypes::Byte* memory = (IOBasicTypes::Byte*)inObject - ALLOCATION_HEADER_SIZE;
+	PDFObjectsArena* arena = *((PDFObjectsArena**)memory);
+
+	if(arena)
+		arena->Deallocate(memory);
+	else
+		::operator delete(memory);
+}
+
+void PDFObject::operator delete(void* inObject,PDFObjectsArena*)
+{
+	// matching delete for a constructor that threw
+	operator delete(inObject);
+}
@@ -22,9 +22,12 @@
 
 #include "RefCountObject.h"
 
+#include <stddef.h>
 #include <string>
 #include <map>
 
+class PDFObjectsArena;
+
 typedef std::map<std::string, void*> StringToVoidP;
 
 class PDFObject : public RefCountObject
@@ -64,6 +67,16 @@ public:
 	void* DetachMetadata(const std::string& inKey);
 	void DeleteMetadata(const std::string& inKey);
 
+	/*
+		allocation. objects may be allocated from a PDFObjectsArena with "new (arena) PDFXXX(...)". a NULL arena
+		(as well as plain new) allocates from the heap. each allocation records where it came from, so that
+		deleting (by the last Release) returns the memory to the right place.
+	*/
+	static void* operator new(size_t inSize);
+	static void* operator new(size_t inSize,PDFObjectsArena* inArena);
+	static void operator delete(void* inObject);
+	static void operator delete(void* inObject,PDFObjectsArena* inArena);
+
 
 private:
 	EPDFObjectType mType;
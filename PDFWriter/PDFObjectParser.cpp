@@ -42,6 +42,7 @@
 #include "DecryptionHelper.h"
 
 #include <sstream>
+#include <limits.h>
 
 using namespace PDFHummus;
 
@@ -49,6 +50,7 @@ PDFObjectParser::PDFObjectParser(void)
 {
 	mParserExtender = NULL;
 	mDecryptionHelper = NULL;
+	mObjectsArena = NULL;
 }
 
 PDFObjectParser::~PDFObjectParser(void)
@@ -56,10 +58,11 @@ PDFObjectParser::~PDFObjectParser(void)
 }
 
 void PDFObjectParser::SetReadStream(IByteReader* inSourceStream,
-									IReadPositionProvider* inCurrentPositionProvider)
+									IReadPositionProvider* inCurrentPositionProvider,
+									IReadWindowProvider* inSourceStreamWindow)
 {
 	mStream = inSourceStream;
-	mTokenizer.SetReadStream(inSourceStream);
+	mTokenizer.SetReadStream(inSourceStream,inSourceStreamWindow);
 	mCurrentPositionProvider = inCurrentPositionProvider;
 	ResetReadState();
 }
@@ -82,6 +85,9 @@ PDFObject* PDFObjectParser::ParseNewObject()
 {
 	PDFObject* pdfObject = NULL;
 	std::string token;
+	bool isReal;
+	long long integerValue;
+	double realValue;
 
 	do
 	{
@@ -112,7 +118,7 @@ PDFObject* PDFObjectParser::ParseNewObject()
 		// NULL
 		else if (IsNull(token))
 		{
-			pdfObject = new PDFNull();
+			pdfObject = new (mObjectsArena) PDFNull();
 			break;
 		}
 		// Name
@@ -122,64 +128,51 @@ PDFObject* PDFObjectParser::ParseNewObject()
 			break;
 		}
 		// Number (and possibly an indirect reference)
-		else if(IsNumber(token))
+		else if(ScanNumber(token,isReal,integerValue,realValue))
 		{	
-			pdfObject = ParseNumber(token);
+			if(isReal)
+			{
+				pdfObject = new (mObjectsArena) PDFReal(realValue);
+				break;
+			}
+
+			pdfObject = new (mObjectsArena) PDFInteger(integerValue);
 			
 			// this could be an indirect reference in case this is a positive integer
 			// and the next one is also, and then there's an "R" keyword
-			if(pdfObject && 
-				(pdfObject->GetType() == PDFObject::ePDFObjectInteger) && 
-				((PDFInteger*)pdfObject)->GetValue() > 0)
+			if(integerValue > 0)
 			{
 				// try parse version
 				std::string numberToken;
 				if(!GetNextToken(numberToken)) // k. no next token...cant be reference
 					break;
 
-				if(!IsNumber(numberToken)) // k. no number, cant be reference
+				bool isVersionReal;
+				long long versionValue;
+				double versionRealValue;
+				if(!ScanNumber(numberToken,isVersionReal,versionValue,versionRealValue) ||
+					isVersionReal || 
+					versionValue < 0) // k. no number, or not a non-negative integer, cant be reference
 				{
 					SaveTokenToBuffer(numberToken);
 					break;
 				}
 
-				PDFObject* versionObject = ParseNumber(numberToken); 
-				bool isReference = false;
-				do
-				{
-					if(!versionObject || 
-                       (versionObject->GetType() != PDFObject::ePDFObjectInteger) ||
-						((PDFInteger*)versionObject)->GetValue() < 0) // k. failure to parse number, or no non-negative, cant be reference
-					{
-						SaveTokenToBuffer(numberToken);
-						break;
-					}
-
-					// try parse R keyword
-					std::string keywordToken;
-					if(!GetNextToken(keywordToken)) // k. no next token...cant be reference
-						break;
-
-					if(keywordToken != scR) // k. not R...cant be reference
-					{
-						SaveTokenToBuffer(numberToken);
-						SaveTokenToBuffer(keywordToken);
-						break;
-					}
-
-					isReference = true;
-				}while(false);
+				// try parse R keyword
+				std::string keywordToken;
+				if(!GetNextToken(keywordToken)) // k. no next token...cant be reference
+					break;
 
-				// if passed all these, then this is a reference
-				if(isReference)
+				if(keywordToken != scR) // k. not R...cant be reference
 				{
-					PDFObject* referenceObject = new PDFIndirectObjectReference(
-														(ObjectIDType)((PDFInteger*)pdfObject)->GetValue(),
-														(unsigned long)((PDFInteger*)versionObject)->GetValue());
-					delete pdfObject;
-					pdfObject = referenceObject;
+					SaveTokenToBuffer(numberToken);
+					SaveTokenToBuffer(keywordToken);
+					break;
 				}
-				delete versionObject;
+
+				// if passed all these, then this is a reference
+				delete pdfObject;
+				pdfObject = new (mObjectsArena) PDFIndirectObjectReference((ObjectIDType)integerValue,(unsigned long)versionValue);
 			}
 			break;
 		}
@@ -204,7 +197,7 @@ PDFObject* PDFObjectParser::ParseNewObject()
 				{
 					// yes, found a stream. record current position as the position where the stream starts. 
 					// remove from the current stream position the size of the tokenizer buffer, which is "read", but not used
-					pdfObject = new PDFStreamInput((PDFDictionary*)pdfObject, mCurrentPositionProvider->GetCurrentPosition() - mTokenizer.GetReadBufferSize());
+					pdfObject = new (mObjectsArena) PDFStreamInput((PDFDictionary*)pdfObject, mCurrentPositionProvider->GetCurrentPosition() - mTokenizer.GetReadBufferSize());
 				}
 				else
 				{
@@ -216,7 +209,7 @@ PDFObject* PDFObjectParser::ParseNewObject()
 		}
 		// Symbol (legitimate keyword or error. determine if error based on semantics)
 		else
-			pdfObject = new PDFSymbol(token);
+			pdfObject = new (mObjectsArena) PDFSymbol(token);
 	}while(false);
 
 
@@ -235,18 +228,13 @@ bool PDFObjectParser::GetNextToken(std::string& outToken)
 	else
 	{
 		// skip comments
-		BoolAndString tokenizerResult;
+		bool gotToken;
 
 		do
 		{
-			tokenizerResult = mTokenizer.GetNextToken();
-			if(tokenizerResult.first && !IsComment(tokenizerResult.second))
-			{
-				outToken = tokenizerResult.second;
-				break;
-			}
-		}while(tokenizerResult.first);
-		return tokenizerResult.first;
+			gotToken = mTokenizer.GetNextToken(outToken);
+		}while(gotToken && IsComment(outToken));
+		return gotToken;
 	}
 }
 
@@ -259,7 +247,7 @@ bool PDFObjectParser::IsBoolean(const std::string& inToken)
 
 PDFObject* PDFObjectParser::ParseBoolean(const std::string& inToken)
 {
-	return new PDFBoolean(scTrue == inToken);
+	return new (mObjectsArena) PDFBoolean(scTrue == inToken);
 }
 
 static const char scLeftParanthesis = '(';
@@ -342,7 +330,7 @@ PDFObject* PDFObjectParser::ParseLiteralString(const std::string& inToken)
 		stringBuffer.sputn((const char*)&buffer,1);
 	}
 
-	return new PDFLiteralString(MaybeDecryptString(stringBuffer.str()));
+	return new (mObjectsArena) PDFLiteralString(MaybeDecryptString(stringBuffer.str()));
 }
 
 /*
@@ -386,7 +374,7 @@ PDFObject* PDFObjectParser::ParseHexadecimalString(const std::string& inToken)
 		return NULL;
 	}
 
-	return new PDFHexString(MaybeDecryptString(DecodeHexString(inToken.substr(1, inToken.size() - 2))));
+	return new (mObjectsArena) PDFHexString(MaybeDecryptString(DecodeHexString(inToken.substr(1, inToken.size() - 2))));
 }
 
 std::string PDFObjectParser::DecodeHexString(const std::string inStringToDecode) {
@@ -478,7 +466,7 @@ PDFObject* PDFObjectParser::ParseName(const std::string& inToken)
 	}
 	
 	if(PDFHummus::eSuccess == status)
-		return new PDFName(stringBuffer.str());
+		return new (mObjectsArena) PDFName(stringBuffer.str());
 	else
 		return NULL;
 }
@@ -489,47 +477,108 @@ static const char scNine = '9';
 static const char scZero = '0';
 static const char scDot = '.';
 bool PDFObjectParser::IsNumber(const std::string& inToken)
+{
+	bool isReal;
+	long long integerValue;
+	double realValue;
+
+	return ScanNumber(inToken,isReal,integerValue,realValue);
+}
+
+typedef BoxingBaseWithRW<long long> LongLong;
+
+PDFObject* PDFObjectParser::ParseNumber(const std::string& inToken)
+{
+	bool isReal;
+	long long integerValue;
+	double realValue;
+
+	if(!ScanNumber(inToken,isReal,integerValue,realValue))
+		return NULL;
+
+	if(isReal)
+		return new (mObjectsArena) PDFReal(realValue);
+	else
+		return new (mObjectsArena) PDFInteger(integerValue);
+}
+
+// exact powers of ten in double precision
+static const double scPowersOfTen[] = {	1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,
+										1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+#define MAX_EXACT_POWER_OF_TEN 22
+// largest integer for which all smaller integers are exactly representable in a double
+#define MAX_EXACT_MANTISSA (1ULL<<53)
+// largest mantissa that can take another digit without overflowing an unsigned long long
+#define MAX_MANTISSA_BEFORE_DIGIT ((~0ULL - 9)/10)
+
+bool PDFObjectParser::ScanNumber(const std::string& inToken,bool& outIsReal,long long& outIntegerValue,double& outRealValue)
 {
 	// it's a number if the first char is either a sign or digit, or an initial decimal dot, and the rest is 
 	// digits, with the exception of a dot which can appear just once.
+	// values are accumulated while validating, so there's no second pass [and no string streams] for the conversion.
+	// the rare values that can't be converted exactly here (too many digits) fall back on the standard conversion
 
-	if(inToken.at(0) != scPlus && inToken.at(0) != scMinus && inToken.at(0) != scDot && (inToken.at(0) > scNine || inToken.at(0) < scZero))
+	if(inToken.empty())
 		return false;
 
-	bool isNumber = true;
-	bool dotEncountered = (inToken.at(0) == scDot);
-	std::string::const_iterator it = inToken.begin();
-	++it; //verified the first char already
+	const char* it = inToken.c_str();
+	const char* end = it + inToken.size();
+	bool isNegative = false;
+	bool dotEncountered = false;
+	bool mantissaOverflow = false;
+	unsigned long long mantissa = 0;
+	unsigned long fractionDigits = 0;
 
-	// only sign is not a number
-	if((inToken.at(0) == scPlus || inToken.at(0) == scMinus) && it == inToken.end())
-		return false;
+	if(*it == scPlus || *it == scMinus)
+	{
+		isNegative = (*it == scMinus);
+		++it;
+		// only sign is not a number
+		if(it == end)
+			return false;
+	}
 
-	for(; it != inToken.end() && isNumber;++it)
+	for(; it != end; ++it)
 	{
 		if(*it == scDot)
 		{
 			if(dotEncountered)
+				return false;
+			dotEncountered = true;
+		}
+		else if(scZero <= *it && *it <= scNine)
+		{
+			if(mantissa > MAX_MANTISSA_BEFORE_DIGIT)
 			{
-				isNumber = false;
+				mantissaOverflow = true;
+			}
+			else
+			{
+				mantissa = mantissa*10 + (*it - scZero);
+				if(dotEncountered)
+					++fractionDigits;
 			}
-			dotEncountered = true;
 		}
 		else
-			isNumber = (scZero <= *it && *it <= scNine);
+			return false;
 	}
-	return isNumber;
-}
-
-typedef BoxingBaseWithRW<long long> LongLong;
 
-PDFObject* PDFObjectParser::ParseNumber(const std::string& inToken)
-{
-	// once we know this is a number, then parsing is easy. just determine if it's a real or integer, so as to separate classes for better accuracy
-	if(inToken.find(scDot) != inToken.npos)
-		return new PDFReal(Double(inToken));
+	outIsReal = dotEncountered;
+	if(outIsReal)
+	{
+		if(mantissaOverflow || mantissa > MAX_EXACT_MANTISSA || fractionDigits > MAX_EXACT_POWER_OF_TEN)
+			outRealValue = Double(inToken);
+		else
+			outRealValue = (isNegative ? -(double)mantissa : (double)mantissa) / scPowersOfTen[fractionDigits];
+	}
 	else
-		return new PDFInteger(LongLong(inToken));
+	{
+		if(mantissaOverflow || mantissa > (unsigned long long)LLONG_MAX + (isNegative ? 1:0))
+			outIntegerValue = LongLong(inToken);
+		else
+			outIntegerValue = isNegative ? (long long)(0 - mantissa) : (long long)mantissa;
+	}
+	return true;
 }
 
 static const std::string scLeftSquare = "[";
@@ -541,7 +590,7 @@ bool PDFObjectParser::IsArray(const std::string& inToken)
 static const std::string scRightSquare = "]";
 PDFObject* PDFObjectParser::ParseArray()
 {
-	PDFArray* anArray = new PDFArray();
+	PDFArray* anArray = new (mObjectsArena) PDFArray();
 	bool arrayEndEncountered = false;
 	std::string token;
 	EStatusCode status = PDFHummus::eSuccess;
@@ -597,7 +646,7 @@ bool PDFObjectParser::IsDictionary(const std::string& inToken)
 static const std::string scDoubleRightAngle = ">>";
 PDFObject* PDFObjectParser::ParseDictionary()
 {
-	PDFDictionary* aDictionary = new PDFDictionary();
+	PDFDictionary* aDictionary = new (mObjectsArena) PDFDictionary();
 	bool dictionaryEndEncountered = false;
 	std::string token;
 	EStatusCode status = PDFHummus::eSuccess;
@@ -680,4 +729,9 @@ void PDFObjectParser::SetDecryptionHelper(DecryptionHelper* inDecryptionHelper)
 void PDFObjectParser::SetParserExtender(IPDFParserExtender* inParserExtender)
 {
 	mParserExtender = inParserExtender;
+}
+
+void PDFObjectParser::SetObjectsArena(PDFObjectsArena* inObjectsArena)
+{
+	mObjectsArena = inObjectsArena;
 }
\ No newline at end of file
@@ -31,8 +31,10 @@
 
 class PDFObject;
 class IByteReader;
+class IReadWindowProvider;
 class IPDFParserExtender;
 class DecryptionHelper;
+class PDFObjectsArena;
 
 
 
@@ -46,8 +48,9 @@ public:
 	~PDFObjectParser(void);
 
 	
-	// Assign the stream to read from (does not take ownership of the stream)
-	void SetReadStream(IByteReader* inSourceStream,IReadPositionProvider* inCurrentPositionProvider);
+	// Assign the stream to read from (does not take ownership of the stream).
+	// optionally pass a read window provider for the stream, to allow the tokenizer to scan it directly in memory
+	void SetReadStream(IByteReader* inSourceStream,IReadPositionProvider* inCurrentPositionProvider,IReadWindowProvider* inSourceStreamWindow = NULL);
 
 	PDFObject* ParseNewObject();
 
@@ -60,6 +63,8 @@ public:
 
 	void SetDecryptionHelper(DecryptionHelper* inDecryptionHelper);
 	void SetParserExtender(IPDFParserExtender* inParserExtender);
+	// allocate parsed objects from this arena (not owning it). NULL (the default) allocates them from the heap
+	void SetObjectsArena(PDFObjectsArena* inObjectsArena);
 
 	// helper method for others who need to parse encoded pdf data
 	std::string DecodeHexString(const std::string inStringToDecode);
@@ -71,6 +76,7 @@ private:
 	IReadPositionProvider* mCurrentPositionProvider;
 	IPDFParserExtender* mParserExtender;
 	DecryptionHelper* mDecryptionHelper;
+	PDFObjectsArena* mObjectsArena;
 
 	bool GetNextToken(std::string& outToken);
 	void SaveTokenToBuffer(std::string& inToken);
@@ -92,6 +98,8 @@ private:
 
 	bool IsNumber(const std::string& inToken);
 	PDFObject* ParseNumber(const std::string& inToken);
+	// validates and converts a number token in a single pass over its bytes. returns false if the token is not a number
+	bool ScanNumber(const std::string& inToken,bool& outIsReal,long long& outIntegerValue,double& outRealValue);
 
 	bool IsArray(const std::string& inToken);
 	PDFObject* ParseArray();
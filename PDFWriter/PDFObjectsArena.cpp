@@ -0,0 +1,102 @@
+/*
+   Source File : PDFObjectsArena.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "PDFObjectsArena.h"
+
+using namespace IOBasicTypes;
+
+#define ARENA_BLOCK_SIZE 64*1024
+// allocations are aligned to this, which serves any of the pdf objects members
+#define ARENA_ALIGNMENT 16
+// allocations larger than this get a block of their own, so as not to waste the remainder of the current block
+#define ARENA_LARGE_ALLOCATION_SIZE (ARENA_BLOCK_SIZE/4)
+
+PDFObjectsArena::PDFObjectsArena(void)
+{
+	mCurrentPosition = NULL;
+	mRemainingInBlock = 0;
+	mReservedBytes = 0;
+	mLiveAllocations = 0;
+	mReleased = false;
+}
+
+PDFObjectsArena::~PDFObjectsArena(void)
+{
+	BytePointerVector::iterator it = mBlocks.begin();
+	for(; it != mBlocks.end(); ++it)
+		delete[] *it;
+}
+
+void* PDFObjectsArena::Allocate(size_t inSize)
+{
+	size_t alignedSize = (inSize + ARENA_ALIGNMENT - 1) & ~((size_t)ARENA_ALIGNMENT - 1);
+	Byte* result;
+
+	if(alignedSize > ARENA_LARGE_ALLOCATION_SIZE)
+	{
+		// new[] of Byte is aligned for any fundamental type, so ARENA_ALIGNMENT holds for the block start
+		result = new Byte[alignedSize];
+		mBlocks.push_back(result);
+		mReservedBytes += alignedSize;
+	}
+	else
+	{
+		if(alignedSize > mRemainingInBlock)
+		{
+			mCurrentPosition = new Byte[ARENA_BLOCK_SIZE];
+			mBlocks.push_back(mCurrentPosition);
+			mRemainingInBlock = ARENA_BLOCK_SIZE;
+			mReservedBytes += ARENA_BLOCK_SIZE;
+		}
+		result = mCurrentPosition;
+		mCurrentPosition += alignedSize;
+		mRemainingInBlock -= alignedSize;
+	}
+
+	++mLiveAllocations;
+	return result;
+}
+
+void PDFObjectsArena::Deallocate(void* inMemory)
+{
+	if(!inMemory || 0 == mLiveAllocations)
+		return;
+
+	--mLiveAllocations;
+	if(mReleased && 0 == mLiveAllocations)
+		delete this;
+}
+
+void PDFObjectsArena::ReleaseArena()
+{
+	mReleased = true;
+	if(0 == mLiveAllocations)
+		delete this;
+}
+
+unsigned long PDFObjectsArena::GetLiveAllocationsCount() const
+{
+	return mLiveAllocations;
+}
+
+size_t PDFObjectsArena::GetReservedBytes() const
+{
+	return mReservedBytes;
+}
@@ -0,0 +1,67 @@
+/*
+   Source File : PDFObjectsArena.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "IOBasicTypes.h"
+
+#include <stddef.h>
+#include <vector>
+
+/*
+	Arena for PDF objects created while parsing a PDF file.
+	Objects are carved out of large blocks, instead of a heap allocation per object, and the blocks are freed
+	all at once. Memory of an object that is released is not reused, it is reclaimed only when the whole arena goes.
+
+	The arena is owned by the parser for the duration of a parsing session (see PDFParsingOptions::UseObjectsArena),
+	and released by it when the parser is reset. Parsed objects may outlive the parser session (as refcounted objects normally do),
+	so the arena counts its live allocations, and deletes itself when released by its owner and no allocation is alive anymore.
+
+	Object allocations go through PDFObject operator new/delete, so usage is simply "new (arena) PDFInteger(...)".
+*/
+
+typedef std::vector<IOBasicTypes::Byte*> BytePointerVector;
+
+class PDFObjectsArena
+{
+public:
+	PDFObjectsArena(void);
+
+	// allocate memory from the arena. the arena keeps living as long as there are allocations that were not deallocated
+	void* Allocate(size_t inSize);
+	void Deallocate(void* inMemory);
+
+	// called by the owner when it is done with the arena. deletes the arena now, if it has no live allocations, or later
+	// when the last one is deallocated. don't use the arena pointer after calling this
+	void ReleaseArena();
+
+	unsigned long GetLiveAllocationsCount() const;
+	size_t GetReservedBytes() const;
+
+private:
+	~PDFObjectsArena(void);
+
+	BytePointerVector mBlocks;
+	IOBasicTypes::Byte* mCurrentPosition;
+	size_t mRemainingInBlock;
+	size_t mReservedBytes;
+	unsigned long mLiveAllocations;
+	bool mReleased;
+};
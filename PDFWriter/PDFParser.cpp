@@ -47,6 +47,10 @@
 #include "InputAscii85DecodeStream.h"
 #include "IPDFParserExtender.h"
 #include "InputDCTDecodeStream.h"
+#include "InputByteArrayStream.h"
+#include "PDFObjectsArena.h"
+#include "OutputStringBufferStream.h"
+#include "OutputStreamTraits.h"
 
 #include  <algorithm>
 using namespace PDFHummus;
@@ -54,14 +58,20 @@ using namespace PDFHummus;
 PDFParser::PDFParser(void)
 {
 	mStream = NULL;
+	mStreamWindow = NULL;
 	mTrailer = NULL;
 	mXrefTable = NULL;
 	mPagesObjectIDs = NULL;
+	mParsePagesOnDemand = false;
+	mPagesRootObjectID = 0;
 	mParserExtender = NULL;
+	mObjectsArena = NULL;
+	mMetrics = &mParserMetrics;
     mAllowExtendingSegments = true; // Gal 19.9.2013: here's some policy changer. basically i'm supposed to ignore all segments that declare objects past the trailer
                                     // declared size. but i would like to allow files that do extend. as this is incompatible with the specs, i'll make
                                     // this boolean dendent. i will sometimes make it public so ppl can actually modify this policy. for now, it's internal
 	mObjectParser.SetDecryptionHelper(&mDecryptionHelper);
+	mDecodedObjectStreamsCache.SetMaximumSize(DEFAULT_OBJECT_STREAMS_CACHE_SIZE);
 }
 
 PDFParser::~PDFParser(void)
@@ -76,26 +86,50 @@ void PDFParser::ResetParser()
 	mXrefTable = NULL;
 	delete[] mPagesObjectIDs;
 	mPagesObjectIDs = NULL;
+	mPagesRootObjectID = 0;
+	mPageTreeNodes.clear();
 	mStream = NULL;
+	mStreamWindow = NULL;
 	mCurrentPositionProvider.Assign(NULL);
 
 	ObjectIDTypeToObjectStreamHeaderEntryMap::iterator it = mObjectStreamsCache.begin();
 	for(; it != mObjectStreamsCache.end();++it)
 		delete[] it->second;
 	mObjectStreamsCache.clear();
+	mDecodedObjectStreamsCache.Reset();
+	mOversizedObjectStreams.clear();
 	mDecryptionHelper.Reset();
 
+	// objects parsed in the session may still be held by others, so release rather than delete. the arena goes with the last of them
+	mObjectParser.SetObjectsArena(NULL);
+	if(mObjectsArena)
+	{
+		mObjectsArena->ReleaseArena();
+		mObjectsArena = NULL;
+	}
 }
 
-EStatusCode PDFParser::StartPDFParsing(IByteReaderWithPosition* inSourceStream, const PDFParsingOptions& inOptions)
+EStatusCode PDFParser::StartPDFParsing(IByteReaderWithPosition* inSourceStream, const PDFParsingOptions& inOptions, IReadWindowProvider* inSourceStreamWindow)
 {
 	EStatusCode status;
 
 	ResetParser();
 
+	// own metrics are per parsed file. shared ones are someone else's to reset
+	if(mMetrics == &mParserMetrics)
+		mParserMetrics.Reset();
+	PDFMetricsPhaseScope phaseScope(*mMetrics,ePDFMetricsPhaseParseDirectory);
 	mStream = inSourceStream;
+	mStreamWindow = inSourceStreamWindow;
 	mCurrentPositionProvider.Assign(mStream);
-	mObjectParser.SetReadStream(inSourceStream,&mCurrentPositionProvider);
+	mObjectParser.SetReadStream(inSourceStream,&mCurrentPositionProvider,mStreamWindow);
+	mDecodedObjectStreamsCache.SetMaximumSize(inOptions.ObjectStreamsCacheSize);
+	mParsePagesOnDemand = inOptions.ParsePagesOnDemand;
+	if(inOptions.UseObjectsArena)
+	{
+		mObjectsArena = new PDFObjectsArena();
+		mObjectParser.SetObjectsArena(mObjectsArena);
+	}
 
 	do
 	{
@@ -150,16 +184,31 @@ PDFObjectParser& PDFParser::GetObjectParser()
 	return mObjectParser;
 }
 
+PDFObjectsArena* PDFParser::GetObjectsArena()
+{
+	return mObjectsArena;
+}
+
 DecryptionHelper& PDFParser::GetDecryptionHelper() {
 	return mDecryptionHelper;
 }
 
+void PDFParser::SetMetrics(PDFMetrics* inMetrics)
+{
+	mMetrics = inMetrics ? inMetrics : &mParserMetrics;
+}
+
+PDFMetrics& PDFParser::GetMetrics()
+{
+	return *mMetrics;
+}
+
 static const std::string scPDFMagic = "%PDF-";
 EStatusCode PDFParser::ParseHeaderLine()
 {
 	PDFParserTokenizer tokenizer;
 
-	tokenizer.SetReadStream(mStream);
+	tokenizer.SetReadStream(mStream,mStreamWindow);
 	BoolAndString tokenizerResult = tokenizer.GetNextToken();
 
 	if(!tokenizerResult.first)
@@ -192,7 +241,7 @@ EStatusCode PDFParser::ParseEOFLine()
 		mStream->SetPositionFromEnd(GetCurrentPositionFromEnd());
 
 		PDFParserTokenizer aTokenizer;
-		aTokenizer.SetReadStream(mStream);
+		aTokenizer.SetReadStream(mStream,mStreamWindow);
 		BoolAndString token = aTokenizer.GetNextToken();
 
 		if(token.first && (token.second.substr(0,scEOF.length()) == scEOF))
@@ -417,7 +466,7 @@ EStatusCode PDFParser::ParseTrailerDictionary()
 	do
 	{
 		PDFParserTokenizer aTokenizer;
-		aTokenizer.SetReadStream(mStream);
+		aTokenizer.SetReadStream(mStream,mStreamWindow);
 		
 		do
 		{
@@ -551,7 +600,7 @@ EStatusCode PDFParser::ParseXrefFromXrefTable(XrefEntryInput* inXrefTable,
 
     *outExtendedTable = NULL;
     
-	tokenizer.SetReadStream(mStream);
+	tokenizer.SetReadStream(mStream,mStreamWindow);
 	MovePositionInStream(inXrefPosition);
 
 	// Note that at times, the xref is being read "on empty". meaning - entries will be read but they will not affect the actual xref.
@@ -678,20 +727,26 @@ double PDFParser::GetPDFLevel()
 
 PDFObject* PDFParser::ParseNewObject(ObjectIDType inObjectId)
 {
+	PDFObject* anObject;
+
 	if(inObjectId >= mXrefSize)
 	{
 		return NULL;
 	}
 	else if(eXrefEntryExisting == mXrefTable[inObjectId].mType)
 	{
-		return ParseExistingInDirectObject(inObjectId);
+		anObject = ParseExistingInDirectObject(inObjectId);
 	}
 	else if(eXrefEntryStreamObject == mXrefTable[inObjectId].mType)
 	{
-		return ParseExistingInDirectStreamObject(inObjectId);
+		anObject = ParseExistingInDirectStreamObject(inObjectId);
 	}
 	else
 		return NULL;
+
+	if(anObject)
+		++mMetrics->GetCounters().ObjectsParsed;
+	return anObject;
 }
 
 ObjectIDType PDFParser::GetObjectsCount()
@@ -825,6 +880,14 @@ EStatusCode PDFParser::ParsePagesObjectIDs()
 		mPagesCount = (unsigned long)totalPagesCount->GetValue();
 		mPagesObjectIDs = new ObjectIDType[mPagesCount];
 
+		if(mParsePagesOnDemand)
+		{
+			// pages will be found when requested. see FindPageObjectID
+			std::fill(mPagesObjectIDs,mPagesObjectIDs + mPagesCount,0);
+			mPagesRootObjectID = pagesReference->mObjectID;
+			break;
+		}
+
 		// now iterate through pages objects, and fill up the IDs [don't really need the object ID for the root pages tree...but whatever
 		status = ParsePagesIDs(pages.GetPtr(),pagesReference->mObjectID);
 
@@ -927,16 +990,168 @@ ObjectIDType PDFParser::GetPageObjectID(unsigned long inPageIndex)
 	if(mPagesCount <= inPageIndex)
 		return 0;
 
+	if(0 == mPagesObjectIDs[inPageIndex] && mParsePagesOnDemand)
+		return FindPageObjectID(inPageIndex);
+
 	return mPagesObjectIDs[inPageIndex];
 }
 
+ObjectIDType PDFParser::FindPageObjectID(unsigned long inPageIndex)
+{
+	// descend from the root through the nodes holding the page, skipping kids by their pages count.
+	// a node kids are read in order only until they reach the page, so in a flat tree finding a page doesn't read the pages after it.
+	// pages read on the way are recorded, so their neighbours are found without reading them again
+	ObjectIDType nodeObjectID = mPagesRootObjectID;
+	unsigned long nodeFirstPageIndex = 0;
+	unsigned long depth = 0;
+
+	while(0 == mPagesObjectIDs[inPageIndex])
+	{
+		// a tree can't be deeper than its pages count. if it seems to be, there's a cycle
+		if(depth++ > mPagesCount)
+		{
+			TRACE_LOG1("PDFParser::FindPageObjectID, cycle in page tree when looking for page %ld",inPageIndex);
+			break;
+		}
+
+		PageTreeNode* node = GetPageTreeNode(nodeObjectID);
+		if(!node)
+			break;
+
+		unsigned long kidFirstPageIndex = nodeFirstPageIndex;
+		ObjectIDType kidNodeObjectID = 0;
+		bool readFailed = false;
+
+		for(size_t i = 0; i < node->mKidsObjectIDs.size() && 0 == kidNodeObjectID && 0 == mPagesObjectIDs[inPageIndex]; ++i)
+		{
+			if(i == node->mKids.size() && ReadNextPageTreeNodeKid(node,kidFirstPageIndex) != PDFHummus::eSuccess)
+			{
+				readFailed = true;
+				break;
+			}
+
+			const PageTreeNodeKid& kid = node->mKids[i];
+			if(kid.mIsPage)
+			{
+				++kidFirstPageIndex;
+			}
+			else if(inPageIndex < kidFirstPageIndex + kid.mPagesCount)
+			{
+				kidNodeObjectID = kid.mObjectID;
+				nodeFirstPageIndex = kidFirstPageIndex;
+			}
+			else
+			{
+				kidFirstPageIndex += kid.mPagesCount;
+			}
+		}
+
+		if(readFailed)
+			break;
+
+		if(0 == mPagesObjectIDs[inPageIndex] && 0 == kidNodeObjectID)
+		{
+			TRACE_LOG1("PDFParser::FindPageObjectID, page %ld is not in the page tree, though the pages count says it should be",inPageIndex);
+			break;
+		}
+		nodeObjectID = kidNodeObjectID;
+	}
+
+	return mPagesObjectIDs[inPageIndex];
+}
+
+PageTreeNode* PDFParser::GetPageTreeNode(ObjectIDType inNodeObjectID)
+{
+	ObjectIDTypeToPageTreeNodeMap::iterator itNode = mPageTreeNodes.find(inNodeObjectID);
+	if(itNode != mPageTreeNodes.end())
+		return &(itNode->second);
+
+	PDFObjectCastPtr<PDFDictionary> pageNode(ParseNewObject(inNodeObjectID));
+	if(!pageNode)
+	{
+		TRACE_LOG("PDFParser::GetPageTreeNode, unable to parse page tree node");
+		return NULL;
+	}
+
+	PDFObjectCastPtr<PDFArray> kidsObject(pageNode->QueryDirectObject("Kids"));
+	if(!kidsObject)
+	{
+		TRACE_LOG("PDFParser::GetPageTreeNode, unable to find page kids array");
+		return NULL;
+	}
+
+	// only the kids references are read here. the kids themselves are read when looking for pages in them
+	PageTreeNode node;
+	SingleValueContainerIterator<PDFObjectVector> it = kidsObject->GetIterator();
+	
+	while(it.MoveNext())
+	{
+		if(it.GetItem()->GetType() != PDFObject::ePDFObjectIndirectObjectReference)
+		{
+			TRACE_LOG1("PDFParser::GetPageTreeNode, unexpected type for a Kids array object, type = %s",PDFObject::scPDFObjectTypeLabel[it.GetItem()->GetType()]);
+			return NULL;
+		}
+		node.mKidsObjectIDs.push_back(((PDFIndirectObjectReference*)it.GetItem())->mObjectID);
+	}
+
+	return &(mPageTreeNodes.insert(ObjectIDTypeToPageTreeNodeMap::value_type(inNodeObjectID,node)).first->second);
+}
+
+EStatusCode PDFParser::ReadNextPageTreeNodeKid(PageTreeNode* inNode,unsigned long inKidFirstPageIndex)
+{
+	PageTreeNodeKid kid;
+	kid.mObjectID = inNode->mKidsObjectIDs[inNode->mKids.size()];
+
+	PDFObjectCastPtr<PDFDictionary> kidObject(ParseNewObject(kid.mObjectID));
+	if(!kidObject)
+	{
+		TRACE_LOG("PDFParser::ReadNextPageTreeNodeKid, unable to parse page node object from kids reference");
+		return PDFHummus::eFailure;
+	}
+
+	PDFObjectCastPtr<PDFName> objectType(kidObject->QueryDirectObject("Type"));
+	if(!objectType)
+	{
+		TRACE_LOG("PDFParser::ReadNextPageTreeNodeKid, can't read object type");
+		return PDFHummus::eFailure;
+	}
+
+	if(scPage == objectType->GetValue())
+	{
+		kid.mIsPage = true;
+		kid.mPagesCount = 0;
+		if(inKidFirstPageIndex < mPagesCount)
+			mPagesObjectIDs[inKidFirstPageIndex] = kid.mObjectID;
+	}
+	else if(scPages == objectType->GetValue())
+	{
+		PDFObjectCastPtr<PDFInteger> pagesCount(QueryDictionaryObject(kidObject.GetPtr(),"Count"));
+		if(!pagesCount)
+		{
+			TRACE_LOG("PDFParser::ReadNextPageTreeNodeKid, failed to read pages count");
+			return PDFHummus::eFailure;
+		}
+		kid.mIsPage = false;
+		kid.mPagesCount = pagesCount->GetValue() > 0 ? (unsigned long)pagesCount->GetValue() : 0;
+	}
+	else
+	{
+		TRACE_LOG1("PDFParser::ReadNextPageTreeNodeKid, unexpected object type. should be either Page or Pages, found %s",objectType->GetValue().c_str());
+		return PDFHummus::eFailure;
+	}
+
+	inNode->mKids.push_back(kid);
+	return PDFHummus::eSuccess;
+}
+
 
 PDFDictionary* PDFParser::ParsePage(unsigned long inPageIndex)
 {
-	if(mPagesCount <= inPageIndex)
+	ObjectIDType pageObjectID = GetPageObjectID(inPageIndex);
+	if(0 == pageObjectID)
 		return NULL;
 
-	PDFObjectCastPtr<PDFDictionary> pageObject(ParseNewObject(mPagesObjectIDs[inPageIndex]));
+	PDFObjectCastPtr<PDFDictionary> pageObject(ParseNewObject(pageObjectID));
 
 	if(!pageObject)
 	{
@@ -1619,6 +1834,35 @@ EStatusCode PDFParser::ReadXrefSegmentValue(IByteReader* inSource,int inEntrySiz
 
 PDFObject* PDFParser::ParseExistingInDirectStreamObject(ObjectIDType inObjectId)
 {
+	// when caching is enabled, object streams are decoded once to memory, and objects are parsed from the decoded data.
+	// streams too large for the cache are decoded just once, for the first object read from them, and then go through the skipping path below
+	if(mDecodedObjectStreamsCache.GetMaximumSize() > 0 && 
+		mOversizedObjectStreams.find((ObjectIDType)mXrefTable[inObjectId].mObjectPosition) == mOversizedObjectStreams.end())
+	{
+		ObjectIDType objectStreamID = (ObjectIDType)mXrefTable[inObjectId].mObjectPosition;
+		DecodedObjectStream* decodedObjectStream = mDecodedObjectStreamsCache.Get(objectStreamID);
+		bool ownsDecodedObjectStream = false;
+
+		if(decodedObjectStream)
+			++mMetrics->GetCounters().ObjectStreamCacheHits;
+		else
+		{
+			++mMetrics->GetCounters().ObjectStreamCacheMisses;
+			decodedObjectStream = DecodeObjectStream(objectStreamID);
+			if(!decodedObjectStream)
+				return NULL;
+			// streams larger than the whole cache are used once and discarded
+			ownsDecodedObjectStream = !mDecodedObjectStreamsCache.Add(objectStreamID,decodedObjectStream);
+			if(ownsDecodedObjectStream)
+				mOversizedObjectStreams.insert(objectStreamID);
+		}
+
+		PDFObject* anObject = ParseExistingInDirectStreamObjectFromDecodedStream(inObjectId,objectStreamID,decodedObjectStream);
+		if(ownsDecodedObjectStream)
+			delete decodedObjectStream;
+		return anObject;
+	}
+
 	// parsing an object in an object stream requires the following:
 	// 1. Setting the position to this object stream
 	// 2. Reading the stream First and N. store.
@@ -1659,7 +1903,7 @@ PDFObject* PDFParser::ParseExistingInDirectStreamObject(ObjectIDType inObjectId)
 		ObjectIDType objectsCount = (ObjectIDType)streamObjectsCount->GetValue();
 
 		PDFObjectCastPtr<PDFInteger> firstStreamObjectPosition(QueryDictionaryObject(streamDictionary.GetPtr(),"First"));
-		if(!streamObjectsCount)
+		if(!firstStreamObjectPosition)
 		{
 			TRACE_LOG1("PDFParser::ParseExistingInDirectStreamObject, no First key in stream dictionary %ld",objectStreamID);
 			status = PDFHummus::eFailure;
@@ -1714,7 +1958,120 @@ PDFObject* PDFParser::ParseExistingInDirectStreamObject(ObjectIDType inObjectId)
 
 	}while(false);
 
-	mObjectParser.SetReadStream(mStream,&mCurrentPositionProvider);
+	mObjectParser.SetReadStream(mStream,&mCurrentPositionProvider,mStreamWindow);
+
+	return anObject;
+}
+
+DecodedObjectStream* PDFParser::DecodeObjectStream(ObjectIDType inObjectStreamID)
+{
+	DecodedObjectStream* decodedObjectStream = NULL;
+	IByteReader* objectSource = NULL;
+
+	do
+	{
+		PDFObjectCastPtr<PDFStreamInput> objectStream(ParseNewObject(inObjectStreamID));
+		if(!objectStream)
+		{
+			TRACE_LOG1("PDFParser::DecodeObjectStream, failed to parse object stream %ld",inObjectStreamID);
+			break;
+		}
+
+		RefCountPtr<PDFDictionary> streamDictionary(objectStream->QueryStreamDictionary());
+
+		PDFObjectCastPtr<PDFInteger> streamObjectsCount(QueryDictionaryObject(streamDictionary.GetPtr(),"N"));
+		if(!streamObjectsCount)
+		{
+			TRACE_LOG1("PDFParser::DecodeObjectStream, no N key in stream dictionary %ld",inObjectStreamID);
+			break;
+		}
+
+		PDFObjectCastPtr<PDFInteger> firstStreamObjectPosition(QueryDictionaryObject(streamDictionary.GetPtr(),"First"));
+		if(!firstStreamObjectPosition)
+		{
+			TRACE_LOG1("PDFParser::DecodeObjectStream, no First key in stream dictionary %ld",inObjectStreamID);
+			break;
+		}
+
+		objectSource = CreateInputStreamReader(objectStream.GetPtr());
+		if(!objectSource)
+		{
+			TRACE_LOG1("PDFParser::DecodeObjectStream, unable to create reader for object stream %ld",inObjectStreamID);
+			break;
+		}
+		MovePositionInStream(objectStream->GetStreamContentStart());
+
+		OutputStringBufferStream decodedData;
+		OutputStreamTraits traits(&decodedData);
+		if(traits.CopyToOutputStream(objectSource) != PDFHummus::eSuccess)
+		{
+			TRACE_LOG1("PDFParser::DecodeObjectStream, failed to decode object stream %ld",inObjectStreamID);
+			break;
+		}
+
+		decodedObjectStream = new DecodedObjectStream();
+		decodedObjectStream->mObjectsCount = (ObjectIDType)streamObjectsCount->GetValue();
+		decodedObjectStream->mFirstObjectPosition = firstStreamObjectPosition->GetValue();
+		decodedObjectStream->mData = decodedData.ToString();
+	}while(false);
+
+	delete objectSource;
+	return decodedObjectStream;
+}
+
+ObjectStreamHeaderEntry* PDFParser::GetObjectStreamHeader(ObjectIDType inObjectStreamID,ObjectIDType inObjectsCount)
+{
+	// assumes that the object parser is set to read from the beginning of the decoded object stream
+	ObjectIDTypeToObjectStreamHeaderEntryMap::iterator it = mObjectStreamsCache.find(inObjectStreamID);
+	
+	if(it == mObjectStreamsCache.end())
+	{
+		ObjectStreamHeaderEntry* objectStreamHeader = new ObjectStreamHeaderEntry[inObjectsCount];
+		if(ParseObjectStreamHeader(objectStreamHeader,inObjectsCount) != PDFHummus::eSuccess)
+		{
+			delete[] objectStreamHeader;
+			return NULL;
+		}
+		it = mObjectStreamsCache.insert(ObjectIDTypeToObjectStreamHeaderEntryMap::value_type(inObjectStreamID,objectStreamHeader)).first;
+	}
+	return it->second;
+}
+
+PDFObject* PDFParser::ParseExistingInDirectStreamObjectFromDecodedStream(ObjectIDType inObjectId,ObjectIDType inObjectStreamID,DecodedObjectStream* inObjectStream)
+{
+	InputByteArrayStream objectSource((IOBasicTypes::Byte*)inObjectStream->mData.c_str(),inObjectStream->mData.size());
+	AdapterIByteReaderWithPositionToIReadPositionProvider objectSourcePositionProvider(&objectSource);
+	PDFObject* anObject = NULL;
+	ObjectIDType objectIndex = (ObjectIDType)mXrefTable[inObjectId].mRivision;
+
+	mObjectParser.SetReadStream(&objectSource,&objectSourcePositionProvider,&objectSource);
+
+	do
+	{
+		ObjectStreamHeaderEntry* objectStreamHeader = GetObjectStreamHeader(inObjectStreamID,inObjectStream->mObjectsCount);
+		if(!objectStreamHeader)
+			break;
+
+		// verify that i got the right object ID
+		if(inObjectStream->mObjectsCount <= objectIndex || objectStreamHeader[objectIndex].mObjectNumber != inObjectId)
+		{
+			TRACE_LOG2("PDFParser::ParseExistingInDirectStreamObjectFromDecodedStream, wrong object. expecting to find object ID %ld, and found %ld",
+						inObjectId,
+						inObjectStream->mObjectsCount <= objectIndex ? 
+							-1 :
+							objectStreamHeader[objectIndex].mObjectNumber);
+			break;
+		}
+
+		objectSource.SetPosition(objectStreamHeader[objectIndex].mObjectOffset + inObjectStream->mFirstObjectPosition);
+		mObjectParser.ResetReadState();
+
+		NotifyIndirectObjectStart(inObjectId,0);
+		anObject = mObjectParser.ParseNewObject();
+		NotifyIndirectObjectEnd(anObject);
+	}while(false);
+
+	mObjectParser.SetReadStream(mStream,&mCurrentPositionProvider,mStreamWindow);
 
 	return anObject;
 }
@@ -1893,6 +2250,7 @@ EStatusCodeAndIByteReader PDFParser::CreateFilterForStream(IByteReader* inStream
 		{
 			InputFlateDecodeStream* flateStream;
 			flateStream = new InputFlateDecodeStream(NULL); // assigning null, so later delete, if failure occurs won't delete the input stream
+			flateStream->SetMetrics(mMetrics);
 			result = flateStream;
 
 			// check for predictor n' such
@@ -1917,53 +2275,55 @@ EStatusCodeAndIByteReader PDFParser::CreateFilterForStream(IByteReader* inStream
 			LongBufferSizeType columnsValue = columns.GetPtr() ? 
 																(IOBasicTypes::LongBufferSizeType)columns->GetValue() :
 																1;
+			PDFObjectCastPtr<PDFInteger> colors(QueryDictionaryObject(inDecodeParams,"Colors"));
+			LongBufferSizeType colorsValue = colors.GetPtr() ? 
+																(IOBasicTypes::LongBufferSizeType)colors->GetValue() :
+																1;
+			PDFObjectCastPtr<PDFInteger> bitsPerComponent(QueryDictionaryObject(inDecodeParams,"BitsPerComponent"));
+			LongBufferSizeType bitsPerComponentValue = bitsPerComponent.GetPtr() ? 
+																(IOBasicTypes::LongBufferSizeType)bitsPerComponent->GetValue() :
+																8;
 
 			switch(predictor->GetValue())
 			{
 				case 2:
 				{
-					PDFObjectCastPtr<PDFInteger> colors(QueryDictionaryObject(inDecodeParams,"Colors"));
-					PDFObjectCastPtr<PDFInteger> bitsPerComponent(QueryDictionaryObject(inDecodeParams,"BitsPerComponent"));
 					result = new InputPredictorTIFFSubStream(result,
-															 colors.GetPtr() ? 
-																(IOBasicTypes::LongBufferSizeType)colors->GetValue() :
-																1,
-															 bitsPerComponent.GetPtr() ?
-																(IOBasicTypes::Byte)colors->GetValue() :
-																8,
-																columnsValue);
+															 colorsValue,
+															 (IOBasicTypes::Byte)bitsPerComponentValue,
+															 columnsValue);
 					break;
 				}
 				case 10:
 				{
-					result = new InputPredictorPNGNoneStream(result,columnsValue);
+					result = new InputPredictorPNGNoneStream(result,columnsValue,colorsValue,bitsPerComponentValue);
 					break;
 				}
 				case 11:
 				{
-					result = new InputPredictorPNGSubStream(result,columnsValue);
+					result = new InputPredictorPNGSubStream(result,columnsValue,colorsValue,bitsPerComponentValue);
 					break;
 				}
 				case 12:
 				{
 
-					result =  new InputPredictorPNGUpStream(result,columnsValue);
+					result =  new InputPredictorPNGUpStream(result,columnsValue,colorsValue,bitsPerComponentValue);
 					break;
 				}
 				case 13:
 				{
 
-					result =  new InputPredictorPNGAverageStream(result,columnsValue);
+					result =  new InputPredictorPNGAverageStream(result,columnsValue,colorsValue,bitsPerComponentValue);
 					break;
 				}
 				case 14:
 				{
-					result =  new InputPredictorPNGPaethStream(result,columnsValue);
+					result =  new InputPredictorPNGPaethStream(result,columnsValue,colorsValue,bitsPerComponentValue);
 					break;
 				}
 				case 15:
 				{
-					result =  new InputPredictorPNGOptimumStream(result,columnsValue);
+					result =  new InputPredictorPNGOptimumStream(result,columnsValue,colorsValue,bitsPerComponentValue);
 					break;
 				}
 				default:
@@ -2059,15 +2419,16 @@ IByteReader* PDFParser::StartReadingFromStreamForPlainCopying(PDFStreamInput* in
 	return result;
 }
 
-EStatusCode PDFParser::StartStateFileParsing(IByteReaderWithPosition* inSourceStream)
+EStatusCode PDFParser::StartStateFileParsing(IByteReaderWithPosition* inSourceStream,IReadWindowProvider* inSourceStreamWindow)
 {
 	EStatusCode status;
 
 	ResetParser();
 
 	mStream = inSourceStream;
+	mStreamWindow = inSourceStreamWindow;
 	mCurrentPositionProvider.Assign(mStream);
-	mObjectParser.SetReadStream(inSourceStream,&mCurrentPositionProvider);
+	mObjectParser.SetReadStream(inSourceStream,&mCurrentPositionProvider,mStreamWindow);
 
 	do
 	{
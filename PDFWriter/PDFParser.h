@@ -30,8 +30,12 @@
 #include "AdapterIByteReaderWithPositionToIReadPositionProvider.h"
 #include "DecryptionHelper.h"
 #include "PDFParsingOptions.h"
+#include "DecodedObjectStreamsCache.h"
+#include "PDFMetrics.h"
 
 #include <map>
+#include <set>
+#include <vector>
 #include <utility>
 
 
@@ -40,6 +44,8 @@ class PDFStreamInput;
 class PDFDictionary;
 class PDFName;
 class IPDFParserExtender;
+class IReadWindowProvider;
+class PDFObjectsArena;
 
 typedef std::pair<PDFHummus::EStatusCode,IByteReader*> EStatusCodeAndIByteReader;
 
@@ -71,6 +77,28 @@ struct ObjectStreamHeaderEntry
 };
 
 typedef std::map<ObjectIDType,ObjectStreamHeaderEntry*> ObjectIDTypeToObjectStreamHeaderEntryMap;
+typedef std::set<ObjectIDType> ObjectIDTypeSet;
+
+// a kid of a page tree node, as read when parsing pages on demand
+struct PageTreeNodeKid
+{
+	ObjectIDType mObjectID;
+	// 0 for a page, otherwise the pages count of the pages node
+	unsigned long mPagesCount;
+	bool mIsPage;
+};
+
+typedef std::vector<PageTreeNodeKid> PageTreeNodeKidVector;
+
+// a page tree node visited when parsing pages on demand. kids are read in order, only as far as needed to find the pages asked for
+struct PageTreeNode
+{
+	std::vector<ObjectIDType> mKidsObjectIDs;
+	// the kids read so far, which are the first ones in mKidsObjectIDs
+	PageTreeNodeKidVector mKids;
+};
+
+typedef std::map<ObjectIDType,PageTreeNode> ObjectIDTypeToPageTreeNodeMap;
 
 class PDFParser
 {
@@ -79,16 +107,27 @@ public:
 	virtual ~PDFParser(void);
 
 	// sets the stream to parse, then parses for enough information to be able
-	// to parse objects later
+	// to parse objects later.
+	// if the stream can provide read windows (see IReadWindowProvider, InputFile::GetInputStreamWindow) pass it as inSourceStreamWindow
+	// as well, for faster tokenizing.
 	PDFHummus::EStatusCode StartPDFParsing(IByteReaderWithPosition* inSourceStream, 
-											const PDFParsingOptions& inOptions = PDFParsingOptions::DefaultPDFParsingOptions);
+											const PDFParsingOptions& inOptions = PDFParsingOptions::DefaultPDFParsingOptions,
+											IReadWindowProvider* inSourceStreamWindow = NULL);
 
 	// get a parser that can parse objects
 	PDFObjectParser& GetObjectParser();
 
+	// the arena that objects are allocated from in this parsing session, if PDFParsingOptions::UseObjectsArena was set. NULL otherwise
+	PDFObjectsArena* GetObjectsArena();
+
 	// get decryption helper - useful to decrypt streams if not using standard operation
 	DecryptionHelper& GetDecryptionHelper();
 
+	// counters and phase timings of the parsing. see PDFMetrics.h. by default the parser has its own metrics,
+	// reset when parsing starts. SetMetrics makes it count into other metrics instead [e.g. those of a writer]. pass NULL to go back to its own
+	void SetMetrics(PDFMetrics* inMetrics);
+	PDFMetrics& GetMetrics();
+
 	// below become available after initial parsing [this level is from the header]
 	double GetPDFLevel();
 
@@ -142,7 +181,7 @@ public:
 	void ResetParser();
 
 	// using PDFParser also for state information reading. this is a specialized version of the StartParsing for reading state
-	PDFHummus::EStatusCode StartStateFileParsing(IByteReaderWithPosition* inSourceStream);
+	PDFHummus::EStatusCode StartStateFileParsing(IByteReaderWithPosition* inSourceStream,IReadWindowProvider* inSourceStreamWindow = NULL);
 
 	// check if this file is encrypted. considering that the library can't really handle these files, this shoud be handy.
 	bool IsEncrypted();
@@ -163,6 +202,7 @@ private:
 	PDFObjectParser mObjectParser;
 	DecryptionHelper mDecryptionHelper;
 	IByteReaderWithPosition* mStream;
+	IReadWindowProvider* mStreamWindow;
 	AdapterIByteReaderWithPositionToIReadPositionProvider mCurrentPositionProvider;
 	
 	// we'll use this items for bacwkards reading. might turns this into a proper stream object
@@ -172,6 +212,9 @@ private:
 	LongBufferSizeType mLastReadPositionFromEnd;
 	bool mEncounteredFileStart;
 	ObjectIDTypeToObjectStreamHeaderEntryMap mObjectStreamsCache;
+	DecodedObjectStreamsCache mDecodedObjectStreamsCache;
+	// object streams that decode to more than the whole cache. objects in them are parsed by skipping in the stream, instead of decoding it again per object
+	ObjectIDTypeSet mOversizedObjectStreams;
 
 	double mPDFLevel;
 	LongFilePositionType mLastXrefPosition;
@@ -179,9 +222,17 @@ private:
 	ObjectIDType mXrefSize;
 	XrefEntryInput* mXrefTable;
 	unsigned long mPagesCount;
+	// with pages parsed on demand, 0 marks a page that wasn't found yet
 	ObjectIDType* mPagesObjectIDs;
+	bool mParsePagesOnDemand;
+	ObjectIDType mPagesRootObjectID;
+	// page tree nodes visited when finding pages on demand
+	ObjectIDTypeToPageTreeNodeMap mPageTreeNodes;
 	IPDFParserExtender* mParserExtender;
+	PDFObjectsArena* mObjectsArena;
     bool mAllowExtendingSegments;
+	PDFMetrics mParserMetrics;
+	PDFMetrics* mMetrics;
 
 	PDFHummus::EStatusCode ParseHeaderLine();
 	PDFHummus::EStatusCode ParseEOFLine();
@@ -202,6 +253,9 @@ private:
 	PDFHummus::EStatusCode ParsePagesObjectIDs();
 	PDFHummus::EStatusCode ParsePagesIDs(PDFDictionary* inPageNode,ObjectIDType inNodeObjectID);
 	PDFHummus::EStatusCode ParsePagesIDs(PDFDictionary* inPageNode,ObjectIDType inNodeObjectID,unsigned long& ioCurrentPageIndex);
+	ObjectIDType FindPageObjectID(unsigned long inPageIndex);
+	PageTreeNode* GetPageTreeNode(ObjectIDType inNodeObjectID);
+	PDFHummus::EStatusCode ReadNextPageTreeNodeKid(PageTreeNode* inNode,unsigned long inKidFirstPageIndex);
 	PDFHummus::EStatusCode ParsePreviousXrefs(PDFDictionary* inTrailer);
 	void MergeXrefWithMainXref(XrefEntryInput* inTableToMerge,ObjectIDType inMergedTableSize);
 	PDFHummus::EStatusCode ParseFileDirectory();
@@ -233,6 +287,9 @@ private:
                                           XrefEntryInput** outExtendedTable,
                                           ObjectIDType* outExtendedTableSize);
 	PDFObject* ParseExistingInDirectStreamObject(ObjectIDType inObjectId);
+	PDFObject* ParseExistingInDirectStreamObjectFromDecodedStream(ObjectIDType inObjectId,ObjectIDType inObjectStreamID,DecodedObjectStream* inObjectStream);
+	DecodedObjectStream* DecodeObjectStream(ObjectIDType inObjectStreamID);
+	ObjectStreamHeaderEntry* GetObjectStreamHeader(ObjectIDType inObjectStreamID,ObjectIDType inObjectsCount);
 	PDFHummus::EStatusCode ParseObjectStreamHeader(ObjectStreamHeaderEntry* inHeaderInfo,ObjectIDType inObjectsCount);
 	void MovePositionInStream(LongFilePositionType inPosition);
 	EStatusCodeAndIByteReader CreateFilterForStream(IByteReader* inStream,PDFName* inFilterName,PDFDictionary* inDecodeParams);
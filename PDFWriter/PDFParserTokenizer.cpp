@@ -20,7 +20,7 @@
 */
 #include "PDFParserTokenizer.h"
 #include "IByteReader.h"
-#include "OutputStringBufferStream.h"
+#include "IReadWindowProvider.h"
 
 using namespace PDFHummus;
 using namespace IOBasicTypes;
@@ -28,6 +28,7 @@ using namespace IOBasicTypes;
 PDFParserTokenizer::PDFParserTokenizer(void)
 {
 	mStream = NULL;
+	mStreamWindow = NULL;
 	ResetReadState();
 }
 
@@ -35,9 +36,10 @@ PDFParserTokenizer::~PDFParserTokenizer(void)
 {
 }
 
-void PDFParserTokenizer::SetReadStream(IByteReader* inSourceStream)
+void PDFParserTokenizer::SetReadStream(IByteReader* inSourceStream,IReadWindowProvider* inSourceStreamWindow)
 {
 	mStream = inSourceStream;
+	mStreamWindow = inSourceStreamWindow;
 	ResetReadState();
 }
 
@@ -46,6 +48,7 @@ void PDFParserTokenizer::ResetReadState()
 	mHasTokenBuffer = false;
 	mStreamPositionTracker = 0;
 	mRecentTokenPosition = 0;
+	mWindowStart = mWindowCurrent = mWindowEnd = NULL;
 }
 
 
@@ -55,30 +58,77 @@ void PDFParserTokenizer::ResetReadState(const PDFParserTokenizer& inExternalToke
 	mHasTokenBuffer = inExternalTokenizer.mHasTokenBuffer;
 	mStreamPositionTracker = inExternalTokenizer.mStreamPositionTracker;
 	mRecentTokenPosition = inExternalTokenizer.mRecentTokenPosition;
+	mWindowStart = mWindowCurrent = mWindowEnd = NULL;
 }
 
-static const Byte scBackSlash[] = {'\\'};
+// character classes table, for quick classification of bytes
+enum ECharacterClass
+{
+	eCharacterClassWhiteSpace = 1,
+	eCharacterClassEntityBreaker = 2,
+	eCharacterClassEndOfLine = 4
+};
+
+static const Byte scCharacterClasses[256] =
+{
+	// 0x00 - 0x0F (0,tab,LF,FF,CR are white spaces. LF and CR are also end of line)
+	1,0,0,0,0,0,0,0,0,1,5,0,1,5,0,0,
+	// 0x10 - 0x1F
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	// 0x20 - 0x2F (space, '%', '(', ')', '/')
+	1,0,0,0,0,2,0,0,2,2,0,0,0,0,0,2,
+	// 0x30 - 0x3F ('<', '>')
+	0,0,0,0,0,0,0,0,0,0,0,0,2,0,2,0,
+	// 0x40 - 0x4F
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	// 0x50 - 0x5F ('[', ']')
+	0,0,0,0,0,0,0,0,0,0,0,2,0,2,0,0,
+	// 0x60 - 0x6F
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	// 0x70 - 0x7F ('{', '}')
+	0,0,0,0,0,0,0,0,0,0,0,2,0,2,0,0,
+	// 0x80 - 0xFF
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+};
+
 static const std::string scStream = "stream";
 static const char scCR = '\r';
 static const char scLF = '\n';
 BoolAndString PDFParserTokenizer::GetNextToken()
 {
 	BoolAndString result;
+	
+	result.first = GetNextToken(result.second);
+	return result;
+}
+
+bool PDFParserTokenizer::GetNextToken(std::string& outToken)
+{
+	bool result;
 	Byte buffer;
-	OutputStringBufferStream tokenBuffer;
+
+	outToken.clear();
 	
-	if(!mStream || (!mStream->NotEnded() && !mHasTokenBuffer))
+	if(!mStream || (!mHasTokenBuffer && !StreamNotEnded()))
 	{
-		result.first = false;
-		return result;
+		ReleaseReadWindow();
+		return false;
 	}
 
 	do
 	{
 		SkipTillToken();
-		if(!mStream->NotEnded())
+		// note that when reading from a window a byte saved in the token buffer still makes for a token, even if the stream ended
+		if(!StreamNotEnded() && !(mStreamWindow && mHasTokenBuffer))
 		{
-			result.first = false;
+			result = false;
 			break;
 		}
 
@@ -89,12 +139,12 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 		// get the first byte of the token
 		if(GetNextByteForToken(buffer) != PDFHummus::eSuccess)
 		{
-			result.first = false;
+			result = false;
 			break;
 		}
-		tokenBuffer.Write(&buffer,1);
+		outToken.push_back((char)buffer);
 
-		result.first = true; // will only be changed to false in case of read error
+		result = true; // will only be changed to false in case of read error
 
 		// now determine how to continue based on the first byte of the token (there are some special cases)
 		switch(buffer)
@@ -103,18 +153,27 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 			case '%':
 			{
 				// for a comment, the token goes on till the end of line marker [not including]
-				while(mStream->NotEnded())
+				while(StreamNotEnded())
 				{
+					if(mStreamWindow)
+					{
+						if(!ScanWindow(eCharacterClassEndOfLine,true,&outToken))
+							continue;
+						// skip the end of line marker
+						++mWindowCurrent;
+						++mStreamPositionTracker;
+						break;
+					}
+
 					if(GetNextByteForToken(buffer) != PDFHummus::eSuccess)
 					{	
-						result.first = false;
+						result = false;
 						break;
 					}
 					if(0xD == buffer|| 0xA == buffer)
 						break;
-					tokenBuffer.Write(&buffer,1);
+					outToken.push_back((char)buffer);
 				}
-				result.second = tokenBuffer.ToString();
 				break;
 			}
 
@@ -123,11 +182,11 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 				// for a literal string, the token goes on until the balanced-closing right paranthesis
 				int balanceLevel = 1;
 				bool backSlashEncountered = false;
-				while(balanceLevel > 0 && mStream->NotEnded())
+				while(balanceLevel > 0 && StreamNotEnded())
 				{
 					if(GetNextByteForToken(buffer) != PDFHummus::eSuccess)
 					{	
-						result.first = false;
+						result = false;
 						break;
 					}
 			
@@ -138,11 +197,11 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 						{
 							// ignore backslash and newline. might also need to read extra
 							// for cr-ln
-							if(0xD == buffer && mStream->NotEnded())
+							if(0xD == buffer && StreamNotEnded())
 							{
 								if(GetNextByteForToken(buffer) != PDFHummus::eSuccess)
 								{
-									result.first = false;
+									result = false;
 									break;
 								}
 								if(buffer != 0xA)
@@ -151,8 +210,8 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 						}
 						else
 						{
-							tokenBuffer.Write(scBackSlash,1);					
-							tokenBuffer.Write(&buffer,1);
+							outToken.push_back('\\');
+							outToken.push_back((char)buffer);
 						}
 					}
 					else
@@ -166,11 +225,9 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 							++balanceLevel;
 						else if(')' == buffer)
 							--balanceLevel;
-						tokenBuffer.Write(&buffer,1);
+						outToken.push_back((char)buffer);
 					}
 				}
-				if(result.first)
-					result.second = tokenBuffer.ToString();
 				break;
 			}
 
@@ -179,92 +236,88 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 				// k. this might be a dictionary start marker or a hax string start. depending on whether it has a < following it or not
 
 				// Hex string, read till end of hex string marker
-				if(!mStream->NotEnded())
-				{
-					result.second = tokenBuffer.ToString();
+				if(!StreamNotEnded())
 					break;
-				}
 
 				if(GetNextByteForToken(buffer) != PDFHummus::eSuccess)
 				{	
-						result.first = false;
+						result = false;
 						break;
 				}
 
 				if('<' == buffer)
 				{
 					// Dictionary start marker
-					tokenBuffer.Write(&buffer,1);
-					result.second = tokenBuffer.ToString();
+					outToken.push_back((char)buffer);
 					break;
 				}
 				else
 				{
 					// Hex string 
 
-					tokenBuffer.Write(&buffer,1);
+					outToken.push_back((char)buffer);
 
-					while(mStream->NotEnded())
+					while(StreamNotEnded())
 					{
 						if(GetNextByteForToken(buffer) != PDFHummus::eSuccess)
 						{	
-							result.first = false;
+							result = false;
 							break;
 						}
 
 						if(!IsPDFWhiteSpace(buffer))
-							tokenBuffer.Write(&buffer,1);
+							outToken.push_back((char)buffer);
 						if('>' == buffer)
 							break;
 					}
 				}
-				result.second = tokenBuffer.ToString();
 				break;
 			}
 			case '[': // for all array or executable tokanizers, the tokanizer is just the mark
 			case ']':
 			case '{':
 			case '}':
-				result.second = tokenBuffer.ToString();
 				break;
 			case '>': // parse end dictionary marker as a single entity or a hex string end marker
 			{
-				if(!mStream->NotEnded()) // this means a loose end string marker...wierd
-				{
-					result.second = tokenBuffer.ToString();
+				if(!StreamNotEnded()) // this means a loose end string marker...wierd
 					break;
-				}
 
 				if(GetNextByteForToken(buffer) != PDFHummus::eSuccess)
 				{	
-					result.first = false;
+					result = false;
 					break;
 				}
 
 				if('>' == buffer)
-				{
-					tokenBuffer.Write(&buffer,1);
-					result.second = tokenBuffer.ToString();
-					break;
-				}
+					outToken.push_back((char)buffer);
 				else
-				{
-					// hex string loose end
-					SaveTokenBuffer(buffer);
-					result.second = tokenBuffer.ToString();
-					break;
-				}
+					SaveTokenBuffer(buffer); // hex string loose end
 
 				break;
 			}
 
 			default: // regular token. read till next breaker or whitespace
 			{
-				while(mStream->NotEnded())
+				while(StreamNotEnded())
 				{
+					if(mStreamWindow)
+					{
+						if(!ScanWindow(eCharacterClassWhiteSpace | eCharacterClassEntityBreaker,true,&outToken))
+							continue;
+						buffer = *mWindowCurrent;
+						// a white space is consumed. a non-space breaker is left in the window for next token read
+						if(IsPDFWhiteSpace(buffer))
+						{
+							++mWindowCurrent;
+							++mStreamPositionTracker;
+						}
+						break;
+					}
+
 					if(GetNextByteForToken(buffer) != PDFHummus::eSuccess)
 					{	
-						result.first = false;
+						result = false;
 						break;
 					}
 					if(IsPDFWhiteSpace(buffer))
@@ -277,11 +330,10 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 						break;
 					}
 					else
-						tokenBuffer.Write(&buffer,1);
+						outToken.push_back((char)buffer);
 				}
-				result.second = tokenBuffer.ToString();
 				
-				if(result.first && mStream->NotEnded() && scStream == result.second)
+				if(result && StreamNotEnded() && scStream == outToken)
 				{
 					// k. a bit of a special case here for streams. the reading changes after the keyword "stream", 
 					// essentially forcing the next content to start after either CR, CR-LF or LF. so there might be a little
@@ -298,10 +350,10 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 							if(buffer != scLF)
 								SaveTokenBuffer(buffer);
 						}
-						result.first = true; 
+						result = true; 
 					}
 					else
-						result.first = (scLF == buffer); // otherwise must be LF
+						result = (scLF == buffer); // otherwise must be LF
 					
 				}
 				break;
@@ -311,7 +363,8 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 
 	}while(false);
 
-
+	// sync the stream with what was actually read, so it may be used directly from here
+	ReleaseReadWindow();
 
 	return result;
 }
@@ -323,6 +376,22 @@ void PDFParserTokenizer::SkipTillToken()
 	if(!mStream)
 		return;
 
+	if(mStreamWindow)
+	{
+		// a byte left in the token buffer [from an external tokenizer state] is first
+		if(mHasTokenBuffer)
+		{
+			if(!IsPDFWhiteSpace(mTokenBuffer))
+				return;
+			mHasTokenBuffer = false;
+			++mStreamPositionTracker;
+		}
+
+		// skip till hitting first non space, or stream end. the non space is left in the window for the token read
+		while(AcquireReadWindow() && !ScanWindow(eCharacterClassWhiteSpace,false,NULL));
+		return;
+	}
+
 	// skip till hitting first non space, or segment end
 	while(mStream->NotEnded())
 	{
@@ -346,24 +415,75 @@ EStatusCode PDFParserTokenizer::GetNextByteForToken(Byte& outByte)
 		mHasTokenBuffer = false;
 		return PDFHummus::eSuccess;
 	}
+	else if(mStreamWindow)
+	{
+		if(!AcquireReadWindow())
+			return PDFHummus::eFailure;
+		outByte = *mWindowCurrent;
+		++mWindowCurrent;
+		return PDFHummus::eSuccess;
+	}
 	else
 		return (mStream->Read(&outByte,1) != 1) ? PDFHummus::eFailure:PDFHummus::eSuccess;
 }
 
-static const Byte scWhiteSpaces[] = {0,0x9,0xA,0xC,0xD,0x20};
+bool PDFParserTokenizer::StreamNotEnded()
+{
+	return mStreamWindow ? AcquireReadWindow() : mStream->NotEnded();
+}
+
+bool PDFParserTokenizer::AcquireReadWindow()
+{
+	if(mWindowCurrent != mWindowEnd)
+		return true;
+
+	ReleaseReadWindow();
+
+	LongBufferSizeType windowSize;
+	mWindowStart = mWindowCurrent = mStreamWindow->GetReadWindow(windowSize);
+	mWindowEnd = mWindowStart ? mWindowStart + windowSize : NULL;
+	return windowSize > 0;
+}
+
+void PDFParserTokenizer::ReleaseReadWindow()
+{
+	if(mWindowCurrent != mWindowStart)
+		mStreamWindow->ConsumeReadWindow(mWindowCurrent - mWindowStart);
+	mWindowStart = mWindowCurrent = mWindowEnd = NULL;
+}
+
+bool PDFParserTokenizer::ScanWindow(Byte inCharacterClasses,bool inStopAtClass,std::string* outToken)
+{
+	const Byte* scanStart = mWindowCurrent;
+
+	while(mWindowCurrent != mWindowEnd && ((scCharacterClasses[*mWindowCurrent] & inCharacterClasses) != 0) != inStopAtClass)
+		++mWindowCurrent;
+
+	if(outToken)
+		outToken->append((const char*)scanStart,mWindowCurrent - scanStart);
+	mStreamPositionTracker+=(mWindowCurrent - scanStart);
+
+	return mWindowCurrent != mWindowEnd;
+}
+
 bool PDFParserTokenizer::IsPDFWhiteSpace(Byte inCharacter)
 {
-	bool isWhiteSpace = false;
-	for(int i=0; i < 6 && !isWhiteSpace; ++i)
-		isWhiteSpace =  (scWhiteSpaces[i] == inCharacter);
-	return isWhiteSpace;
+	return (scCharacterClasses[inCharacter] & eCharacterClassWhiteSpace) != 0;
 }
 
 void PDFParserTokenizer::SaveTokenBuffer(Byte inToSave)
 {
+	--mStreamPositionTracker; // decreasing position trakcer, because it is as if the byte is put back in the stream
+
+	// when reading from a window, the byte just read can simply be put back in it
+	if(mStreamWindow && mWindowCurrent != mWindowStart)
+	{
+		--mWindowCurrent;
+		return;
+	}
+
 	mHasTokenBuffer = true;
 	mTokenBuffer = inToSave;
-	--mStreamPositionTracker; // decreasing position trakcer, because it is as if the byte is put back in the stream
 }
 
 IOBasicTypes::LongFilePositionType PDFParserTokenizer::GetReadBufferSize()
@@ -371,16 +491,12 @@ IOBasicTypes::LongFilePositionType PDFParserTokenizer::GetReadBufferSize()
 	return mHasTokenBuffer ? 1 : 0;
 }
 
-static const Byte scEntityBreakers[] = {'(',')','<','>',']','[','{','}','/','%'};
 bool PDFParserTokenizer::IsPDFEntityBreaker(Byte inCharacter)
 {
-	bool isEntityBreak = false;
-	for(int i=0; i < 10 && !isEntityBreak; ++i)
-		isEntityBreak =  (scEntityBreakers[i] == inCharacter);
-	return isEntityBreak;
+	return (scCharacterClasses[inCharacter] & eCharacterClassEntityBreaker) != 0;
 }
 
 LongFilePositionType PDFParserTokenizer::GetRecentTokenPosition()
 {
 	return mRecentTokenPosition;
-}
\ No newline at end of file
+}
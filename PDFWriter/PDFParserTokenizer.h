@@ -29,6 +29,7 @@
 
 
 class IByteReader;
+class IReadWindowProvider;
 
 typedef std::pair<bool,std::string> BoolAndString;
 
@@ -40,8 +41,11 @@ public:
 	~PDFParserTokenizer(void);
 
 
-	// Assign the stream to read from (does not take ownership of the stream)
-	void SetReadStream(IByteReader* inSourceStream);
+	// Assign the stream to read from (does not take ownership of the stream).
+	// if the stream can provide contiguous read windows pass it also as inSourceStreamWindow (normally the same object), 
+	// and the tokenizer will scan directly over memory instead of reading byte by byte. the stream position is kept in sync
+	// with the tokenizer at the end of every token read, so it's still safe to read the stream directly between tokens.
+	void SetReadStream(IByteReader* inSourceStream,IReadWindowProvider* inSourceStreamWindow = NULL);
 
 	// Get the next avialable PDF token. return result returns whether
 	// token retreive was successful and the token. Token retrieval may be unsuccesful if
@@ -55,6 +59,10 @@ public:
 	// 6. Any othr entity separated from other by space or token delimeters (or eof)
 	BoolAndString GetNextToken();
 
+	// same as above, reading the token into outToken. outToken storage is reused, so this is the better choice
+	// when reading many tokens. returns false if no token was read (see above).
+	bool GetNextToken(std::string& outToken);
+
 	// calls this when changing underlying stream position
 	void ResetReadState();
 	// cll this when wanting to reset to another tokenizer state (it's a copycon, essentially)
@@ -75,6 +83,10 @@ public:
 private:
 
 	IByteReader* mStream;
+	IReadWindowProvider* mStreamWindow;
+	const IOBasicTypes::Byte* mWindowStart;
+	const IOBasicTypes::Byte* mWindowCurrent;
+	const IOBasicTypes::Byte* mWindowEnd;
 	bool mHasTokenBuffer;
 	IOBasicTypes::Byte mTokenBuffer;
 	IOBasicTypes::LongFilePositionType mStreamPositionTracker;
@@ -86,6 +98,18 @@ private:
 	// failure in GetNextByteForToken actually marks a true read failure, if you checked end of file before calling it...
 	PDFHummus::EStatusCode GetNextByteForToken(IOBasicTypes::Byte& outByte);
 
+	// whether the underlying stream has more to read (not including the token buffer)
+	bool StreamNotEnded();
+
+	// read window management. AcquireReadWindow gets a fresh window from the stream if the current one is exhausted, returning false if nothing is left.
+	// ReleaseReadWindow moves the stream forward by the amount of window consumed, and drops the window.
+	bool AcquireReadWindow();
+	void ReleaseReadWindow();
+
+	// window mode only - consume bytes from the current window, appending them to outToken if provided, till reaching a byte that is [inStopAtClass = true] or isn't [inStopAtClass = false]
+	// of one of the character classes in inCharacterClasses. returns true if stopped on such a byte (which is not consumed), false if the window got exhausted first.
+	bool ScanWindow(IOBasicTypes::Byte inCharacterClasses,bool inStopAtClass,std::string* outToken);
+
 	bool IsPDFWhiteSpace(IOBasicTypes::Byte inCharacter);
 	void SaveTokenBuffer(IOBasicTypes::Byte inToSave);
 	bool IsPDFEntityBreaker(IOBasicTypes::Byte inCharacter);
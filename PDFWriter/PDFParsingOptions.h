@@ -20,14 +20,34 @@ limitations under the License.
 */
 #pragma once
 
+#include "IOBasicTypes.h"
+
 #include <string>
 
+// default maximum size for decoded object streams kept in memory by the parser
+#define DEFAULT_OBJECT_STREAMS_CACHE_SIZE 16*1024*1024
+
 struct PDFParsingOptions
 {
 	std::string Password;
-
-	PDFParsingOptions() {}
-	PDFParsingOptions(std::string inPassword) { Password = inPassword; }
+	// maximum total size, in bytes, of decoded object streams that the parser keeps in memory, so that
+	// each object stream is decoded once and not per object read from it. least recently used streams are dropped first.
+	// 0 disables the cache, decoding the object stream each time an object is read from it
+	IOBasicTypes::LongBufferSizeType ObjectStreamsCacheSize;
+	// when the parsed file is opened by the library (e.g. copying context from a file path), map it to memory instead of reading it
+	// through a buffered file stream. faster for random access to large files
+	bool UseMemoryMapping;
+	// allocate the objects parsed in a parsing session from an arena (see PDFObjectsArena), instead of an allocation per object.
+	// faster parsing of large files, but memory of released objects is only reclaimed when the parser is reset (or destroyed)
+	// and all objects parsed in the session were released
+	bool UseObjectsArena;
+	// find pages in the page tree when they are requested, instead of walking the whole tree when parsing starts. the pages count is
+	// taken from the page tree root, and a page is found by descending only the branch that holds it, per the nodes pages counts.
+	// faster start and random page access for long documents, but a broken page tree is only detected when reaching the broken part
+	bool ParsePagesOnDemand;
+
+	PDFParsingOptions() { ObjectStreamsCacheSize = DEFAULT_OBJECT_STREAMS_CACHE_SIZE; UseMemoryMapping = false; UseObjectsArena = false; ParsePagesOnDemand = false; }
+	PDFParsingOptions(std::string inPassword) { Password = inPassword; ObjectStreamsCacheSize = DEFAULT_OBJECT_STREAMS_CACHE_SIZE; UseMemoryMapping = false; UseObjectsArena = false; ParsePagesOnDemand = false; }
 
 	static const PDFParsingOptions DefaultPDFParsingOptions;
 };
\ No newline at end of file
@@ -28,7 +28,9 @@ PDFStream::PDFStream(bool inCompressStream,
 					 IByteWriterWithPosition* inOutputStream,
 					 EncryptionHelper* inEncryptionHelper,
 					 ObjectIDType inExtentObjectID,
-					 IObjectsContextExtender* inObjectsContextExtender)
+					 IObjectsContextExtender* inObjectsContextExtender,
+					 unsigned int inFlateEncodingThreads,
+					 const FlateCompressionParameters& inCompressionParameters)
 {
 	mExtender = inObjectsContextExtender;
 	mCompressStream = inCompressStream;
@@ -43,6 +45,7 @@ PDFStream::PDFStream(bool inCompressStream,
 	}
 
 	mStreamLength = 0;
+	mDeflatedBytesCount = 0;
     mStreamDictionaryContextForDirectExtentStream = NULL;
 
 
@@ -52,8 +55,14 @@ PDFStream::PDFStream(bool inCompressStream,
 		{
 			mWriteStream = mExtender->GetCompressionWriteStream(mEncryptionStream ? mEncryptionStream:inOutputStream);
 		}
+		else if(inFlateEncodingThreads > 1)
+		{
+			mParallelFlateEncodingStream.Assign(mEncryptionStream ? mEncryptionStream : inOutputStream,inFlateEncodingThreads,inCompressionParameters);
+			mWriteStream = &mParallelFlateEncodingStream;
+		}
 		else
 		{
+			mFlateEncodingStream.SetCompressionParameters(inCompressionParameters);
 			mFlateEncodingStream.Assign(mEncryptionStream ? mEncryptionStream : inOutputStream);
 			mWriteStream = &mFlateEncodingStream;
 		}
@@ -68,7 +77,9 @@ PDFStream::PDFStream(
           IByteWriterWithPosition* inOutputStream,
 			EncryptionHelper* inEncryptionHelper,
 			DictionaryContext* inStreamDictionaryContextForDirectExtentStream,
-          IObjectsContextExtender* inObjectsContextExtender)
+          IObjectsContextExtender* inObjectsContextExtender,
+		  unsigned int inFlateEncodingThreads,
+		  const FlateCompressionParameters& inCompressionParameters)
 {
 	mExtender = inObjectsContextExtender;
 	mCompressStream = inCompressStream;
@@ -76,6 +87,7 @@ PDFStream::PDFStream(
 	mStreamStartPosition = 0;
 	mOutputStream = inOutputStream;
 	mStreamLength = 0;
+	mDeflatedBytesCount = 0;
     mStreamDictionaryContextForDirectExtentStream = inStreamDictionaryContextForDirectExtentStream;
     
     mTemporaryOutputStream.Assign(&mTemporaryStream);
@@ -94,8 +106,14 @@ PDFStream::PDFStream(
 		{
 			mWriteStream = mExtender->GetCompressionWriteStream(mEncryptionStream ? mEncryptionStream : &mTemporaryOutputStream);
 		}
+		else if(inFlateEncodingThreads > 1)
+		{
+			mParallelFlateEncodingStream.Assign(mEncryptionStream ? mEncryptionStream : &mTemporaryOutputStream,inFlateEncodingThreads,inCompressionParameters);
+			mWriteStream = &mParallelFlateEncodingStream;
+		}
 		else
 		{
+			mFlateEncodingStream.SetCompressionParameters(inCompressionParameters);
 			mFlateEncodingStream.Assign(mEncryptionStream ? mEncryptionStream : &mTemporaryOutputStream);
 			mWriteStream = &mFlateEncodingStream;
 		}
@@ -122,7 +140,12 @@ void PDFStream::FinalizeStreamWrite()
 		mExtender->FinalizeCompressedStreamWrite(mWriteStream);
 	mWriteStream = NULL;
 	if(mCompressStream)
+	{
 		mFlateEncodingStream.Assign(NULL);  // this both finished encoding any left buffers and releases ownership from mFlateEncodingStream
+		mParallelFlateEncodingStream.Assign(NULL,1);
+		// only the one used has a count
+		mDeflatedBytesCount = mFlateEncodingStream.GetEncodedBytesCount() + mParallelFlateEncodingStream.GetEncodedBytesCount();
+	}
 
 	if (mEncryptionStream) {
 		// safe to delete. encryption stream is not supposed to own the underlying stream in any case. make sure
@@ -148,6 +171,11 @@ LongFilePositionType PDFStream::GetLength()
 	return mStreamLength;
 }
 
+LongFilePositionType PDFStream::GetDeflatedBytesCount()
+{
+	return mDeflatedBytesCount;
+}
+
 bool PDFStream::IsStreamCompressed()
 {
 	return mCompressStream;
@@ -29,6 +29,7 @@
 #include "IOBasicTypes.h"
 #include "ObjectsBasicTypes.h"
 #include "OutputFlateEncodeStream.h"
+#include "OutputParallelFlateEncodeStream.h"
 #include "MyStringBuf.h"
 #include "OutputStringBufferStream.h"
 #include <sstream>
@@ -50,14 +51,18 @@ public:
 		IByteWriterWithPosition* inOutputStream,
 		EncryptionHelper* inEncryptionHelper,
 		ObjectIDType inExtentObjectID,
-		IObjectsContextExtender* inObjectsContextExtender);
+		IObjectsContextExtender* inObjectsContextExtender,
+		unsigned int inFlateEncodingThreads = 1,
+		const FlateCompressionParameters& inCompressionParameters = FlateCompressionParameters());
     
     PDFStream(
         bool inCompressStream,
         IByteWriterWithPosition* inOutputStream,
 		EncryptionHelper* inEncryptionHelper,
 		DictionaryContext* inStreamDictionaryContextForDirectExtentStream,
-        IObjectsContextExtender* inObjectsContextExtender);
+        IObjectsContextExtender* inObjectsContextExtender,
+		unsigned int inFlateEncodingThreads = 1,
+		const FlateCompressionParameters& inCompressionParameters = FlateCompressionParameters());
     
     
 	~PDFStream(void);
@@ -73,6 +78,7 @@ public:
 	ObjectIDType GetExtentObjectID();
 
 	LongFilePositionType GetLength(); // get the stream extent
+	LongFilePositionType GetDeflatedBytesCount(); // bytes compressed with flate into the stream, available after FinalizeStreamWrite
     
     // direct extent specific
     DictionaryContext* GetStreamDictionaryForDirectExtentStream();
@@ -81,10 +87,12 @@ public:
 private:
 	bool mCompressStream;
 	OutputFlateEncodeStream mFlateEncodingStream;
+	OutputParallelFlateEncodeStream mParallelFlateEncodingStream;
 	IByteWriterWithPosition* mOutputStream;
 	IByteWriterWithPosition* mEncryptionStream;
 	ObjectIDType mExtendObjectID;
 	LongFilePositionType mStreamLength;
+	LongFilePositionType mDeflatedBytesCount;
 	LongFilePositionType mStreamStartPosition;
 	IByteWriter* mWriteStream;
 	IObjectsContextExtender* mExtender;
@@ -121,6 +121,12 @@ EStatusCode PDFUsedFont::WriteFontDefinition(bool inEmbedFont)
         return mWrittenFont->WriteFontDefinition(mFaceWrapper,inEmbedFont);
 }
 
+void PDFUsedFont::AddFontSubsets(bool inEmbedFont,UppercaseSequance& ioSubsetFontsNames,ParallelFontSubsetter* ioSubsetter)
+{
+    if(mWrittenFont)
+        mWrittenFont->AddFontSubsets(mFaceWrapper,inEmbedFont,ioSubsetFontsNames,ioSubsetter);
+}
+
 EStatusCode PDFUsedFont::WriteState(ObjectsContext* inStateWriter,ObjectIDType inObjectID)
 {
 	inStateWriter->StartNewIndirectObject(inObjectID);
@@ -285,15 +291,7 @@ double PDFUsedFont::CalculateTextAdvance(const UIntList& inGlyphsList,double inF
     UIntList::const_iterator it = inGlyphsList.begin();
     for(; it != inGlyphsList.end();++it)
     {
-		FT_Pos adv;
-		if (mAdvanceCache.count(*it) > 0) 
-			adv = mAdvanceCache[*it];
-		else {
-			adv = mFaceWrapper.GetGlyphWidth(*it); //potentially very expensive!
-			if (mAdvanceCache.size() <= AdvanceCacheLimit) //dumb limit should cover typical usage, implement LRU if it's a problem
-				mAdvanceCache[*it] = adv;
-		}
-		pen += adv;
+		pen += mFaceWrapper.GetGlyphWidth(*it);
     }
 	return pen * inFontSize / 1000.0;
 }
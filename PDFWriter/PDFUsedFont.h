@@ -42,6 +42,8 @@ typedef std::list<unsigned int> UIntList;
 class IWrittenFont;
 class ObjectsContext;
 class PDFParser;
+class UppercaseSequance;
+class ParallelFontSubsetter;
 
 class PDFUsedFont
 {
@@ -111,6 +113,8 @@ public:
 										bool& outTreatCharactersAsCID);
 
 	PDFHummus::EStatusCode WriteFontDefinition(bool inEmbedFont);
+	// add the font subsets that WriteFontDefinition is going to create. see IWrittenFont::AddFontSubsets
+	void AddFontSubsets(bool inEmbedFont,UppercaseSequance& ioSubsetFontsNames,ParallelFontSubsetter* ioSubsetter);
 
 	// use this method to translate text to glyphs and unicode mapping, to be later used for EncodeStringForShowing
 	PDFHummus::EStatusCode TranslateStringToGlyphs(const std::string& inText,GlyphUnicodeMappingList& outGlyphsUnicodeMapping);
@@ -134,11 +138,9 @@ protected:
 	void GetUnicodeGlyphs(const std::string& inText, UIntList& glyphs);
 
 private:
-	static const unsigned int AdvanceCacheLimit = 200;
 	FreeTypeFaceWrapper mFaceWrapper;
     IWrittenFont* mWrittenFont;
 	ObjectsContext* mObjectsContext;
-	std::map<unsigned int, FT_Pos> mAdvanceCache;
 
 
 };
@@ -35,6 +35,9 @@
 #include "PDFInteger.h"
 #include "PDFPageInput.h"
 #include "PDFDocumentCopyingContext.h"
+#include "PDFLinearizer.h"
+
+#include <stdio.h>
 
 using namespace PDFHummus;
 
@@ -49,11 +52,16 @@ PDFWriter::PDFWriter(void)
 	// the first decision (level) about the PDF can be the result of parsing
 	mDocumentContext.SetObjectsContext(&mObjectsContext);
     mIsModified = false;
+	mUseMemoryMappingForModifiedFile = false;
 	mEmbedFonts = true;
+	mLinearize = false;
+	mLogTrace = NULL;
+	mModifiedFileParser.SetMetrics(&(mObjectsContext.GetMetrics()));
 }
 
 PDFWriter::~PDFWriter(void)
 {
+	ReleaseLog();
 }
 
 EStatusCode PDFWriter::StartPDF(
@@ -63,7 +71,10 @@ EStatusCode PDFWriter::StartPDF(
 							const PDFCreationSettings& inPDFCreationSettings)
 {
 	SetupLog(inLogConfiguration);
+	TraceScope traceScope(GetCallTrace());
 	SetupCreationSettings(inPDFCreationSettings);
+	SetupObjectStreams(inPDFCreationSettings,inPDFVersion);
+	SetupLinearization(inPDFCreationSettings,true);
 
 	EStatusCode status = mOutputFile.OpenFile(inOutputFilePath);
 	if(status != eSuccess)
@@ -87,7 +98,8 @@ EStatusCode PDFWriter::StartPDF(
 
 EStatusCode PDFWriter::EndPDF()
 {
-    
+	TraceScope traceScope(GetCallTrace());
+	PDFMetricsPhaseScope phaseScope(mObjectsContext.GetMetrics(),ePDFMetricsPhaseEndPDF);
 	EStatusCode status;
 	do
 	{
@@ -109,6 +121,15 @@ EStatusCode PDFWriter::EndPDF()
         }
         mModifiedFileParser.ResetParser();
         status = mModifiedFile.CloseFile();
+        if(status != eSuccess)
+            break;
+
+        if(mLinearize)
+        {
+            status = LinearizeOutputFile();
+            if(status != eSuccess)
+                TRACE_LOG("PDFWriter::EndPDF, Could not linearize output file");
+        }
 	}
 	while(false);
     
@@ -126,11 +147,12 @@ void PDFWriter::Cleanup()
 {
 	mObjectsContext.Cleanup();
 	mDocumentContext.Cleanup();
-	//ReleaseLog();
+	ReleaseLog();
 }
 
 void PDFWriter::Reset()
 {
+	TraceScope traceScope(GetCallTrace());
 	mOutputFile.CloseFile();
     mModifiedFileParser.ResetParser();
     mModifiedFile.CloseFile();
@@ -139,28 +161,35 @@ void PDFWriter::Reset()
 
 EStatusCodeAndObjectIDType PDFWriter::WritePageAndReturnPageID(PDFPage* inPage)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.WritePage(inPage);
 }
 
 EStatusCodeAndObjectIDType PDFWriter::WritePageReleaseAndReturnPageID(PDFPage* inPage)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.WritePageAndRelease(inPage);
 }
 
 EStatusCode PDFWriter::WritePage(PDFPage* inPage)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.WritePage(inPage).first;
 }
 
 EStatusCode PDFWriter::WritePageAndRelease(PDFPage* inPage)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.WritePageAndRelease(inPage).first;
 }
 
 
 void PDFWriter::SetupLog(const LogConfiguration& inLogConfiguration)
 {
-	if(inLogConfiguration.LogStream)
+	ReleaseLog();
+	if(inLogConfiguration.LogTrace)
+		mLogTrace = inLogConfiguration.LogTrace;
+	else if(inLogConfiguration.LogStream)
 		Trace::DefaultTrace.SetLogSettings(inLogConfiguration.LogStream,inLogConfiguration.ShouldLog);
 	else
 		Trace::DefaultTrace.SetLogSettings(inLogConfiguration.LogFileLocation,inLogConfiguration.ShouldLog,inLogConfiguration.StartWithBOM);
@@ -168,13 +197,91 @@ void PDFWriter::SetupLog(const LogConfiguration& inLogConfiguration)
 
 void PDFWriter::SetupCreationSettings(const PDFCreationSettings& inPDFCreationSettings)
 {
+	mObjectsContext.GetMetrics().Reset();
 	mObjectsContext.SetCompressStreams(inPDFCreationSettings.CompressStreams);
+	mObjectsContext.SetFlateEncodingThreads(inPDFCreationSettings.FlateEncodingThreads);
+	mObjectsContext.SetCompressionPolicy(inPDFCreationSettings.CompressionPolicy);
+	mObjectsContext.SetDoublePrecision(inPDFCreationSettings.DoublePrecision);
+	mObjectsContext.SetCompactSerialization(inPDFCreationSettings.CompactSerialization);
+	mDocumentContext.GetCopiedObjectsRegistry().SetEnabled(inPDFCreationSettings.DeduplicateCopiedObjects);
+	mDocumentContext.SetFontSubsettingThreads(inPDFCreationSettings.FontSubsettingThreads);
 	mEmbedFonts = inPDFCreationSettings.EmbedFonts;
 }
 
+void PDFWriter::SetupLinearization(const PDFCreationSettings& inPDFCreationSettings,bool inIsNewFile)
+{
+	// linearizing rewrites the file at its end, so it's only available for new files. it does not handle encryption
+	mLinearize = false;
+	if(!inPDFCreationSettings.Linearize)
+		return;
+
+	if(!inIsNewFile)
+		TRACE_LOG("PDFWriter::SetupLinearization, linearization is only available for new documents written to a file. the document will not be linearized");
+	else if(inPDFCreationSettings.DocumentEncryptionOptions.ShouldEncrypt)
+		TRACE_LOG("PDFWriter::SetupLinearization, linearization is not available for encrypted documents. the document will not be linearized");
+	else
+		mLinearize = true;
+}
+
+EStatusCode PDFWriter::LinearizeOutputFile()
+{
+	// write the linearized version to a new file of our own next to the written file, and move it in its place
+	std::string outputFilePath = mOutputFile.GetFilePath();
+	OutputFile linearizedFile;
+	PDFLinearizer linearizer;
+
+	if(linearizedFile.OpenUniqueFile(outputFilePath + ".linearized") != eSuccess)
+	{
+		TRACE_LOG1("PDFWriter::LinearizeOutputFile, could not create a temporary file next to output file %s",outputFilePath.c_str());
+		return eFailure;
+	}
+	std::string linearizedFilePath = linearizedFile.GetFilePath();
+	linearizedFile.CloseFile();
+
+	EStatusCode status = linearizer.LinearizePDF(outputFilePath,linearizedFilePath);
+	if(status != eSuccess)
+	{
+		// leave the document as it was written
+		remove(linearizedFilePath.c_str());
+		return status;
+	}
+
+	// rename does not replace an existing file on windows, in which case remove the written file first
+	if(rename(linearizedFilePath.c_str(),outputFilePath.c_str()) != 0)
+	{
+		remove(outputFilePath.c_str());
+		if(rename(linearizedFilePath.c_str(),outputFilePath.c_str()) != 0)
+		{
+			TRACE_LOG2("PDFWriter::LinearizeOutputFile, could not move linearized file %s to %s",linearizedFilePath.c_str(),outputFilePath.c_str());
+			status = eFailure;
+		}
+	}
+	return status;
+}
+
+void PDFWriter::SetupObjectStreams(const PDFCreationSettings& inPDFCreationSettings,EPDFVersion inPDFVersion)
+{
+	// object streams are only available from PDF 1.5
+	if(inPDFCreationSettings.UseObjectStreams && inPDFVersion < ePDFVersion15)
+		TRACE_LOG("PDFWriter::SetupObjectStreams, object streams require PDF 1.5 or higher. objects will be written directly");
+	mObjectsContext.SetWriteObjectStreams(inPDFCreationSettings.UseObjectStreams && inPDFVersion >= ePDFVersion15);
+}
+
 void PDFWriter::ReleaseLog()
 {
-	//Singleton<Trace>::Reset();
+	mLogTrace = NULL;
+}
+
+Trace* PDFWriter::GetCallTrace()
+{
+	// the log trace is only set as the thread trace for the duration of a call, so a document may be started and ended
+	// on different threads. with no log trace, calls log to whatever the calling thread logs to
+	return mLogTrace ? mLogTrace : Trace::GetThreadTrace();
+}
+
+PDFMetrics& PDFWriter::GetMetrics()
+{
+	return mObjectsContext.GetMetrics();
 }
 
 DocumentContext& PDFWriter::GetDocumentContext()
@@ -194,63 +301,116 @@ OutputFile& PDFWriter::GetOutputFile()
 
 PageContentContext* PDFWriter::StartPageContentContext(PDFPage* inPage)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.StartPageContentContext(inPage);
 }
 
 EStatusCode PDFWriter::PausePageContentContext(PageContentContext* inPageContext)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.PausePageContentContext(inPageContext);
 }
 
 EStatusCode PDFWriter::EndPageContentContext(PageContentContext* inPageContext)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.EndPageContentContext(inPageContext);
 }
 
+DeferredPageContentContext* PDFWriter::StartDeferredPageContentContext(PDFPage* inPage)
+{
+	TraceScope traceScope(GetCallTrace());
+	return mDocumentContext.StartDeferredPageContentContext(inPage);
+}
+
+EStatusCode PDFWriter::WriteDeferredPageAndRelease(DeferredPageContentContext* inPageContext)
+{
+	TraceScope traceScope(GetCallTrace());
+	return mDocumentContext.WriteDeferredPageAndRelease(inPageContext).first;
+}
+
+EStatusCodeAndObjectIDType PDFWriter::WriteDeferredPageReleaseAndReturnPageID(DeferredPageContentContext* inPageContext)
+{
+	TraceScope traceScope(GetCallTrace());
+	return mDocumentContext.WriteDeferredPageAndRelease(inPageContext);
+}
+
+DeferredFormXObjectContentContext* PDFWriter::StartDeferredFormXObjectContentContext(const PDFRectangle& inBoundingBox,const double* inMatrix)
+{
+	TraceScope traceScope(GetCallTrace());
+	return mDocumentContext.StartDeferredFormXObjectContentContext(inBoundingBox,inMatrix);
+}
+
+DeferredFormXObjectContentContext* PDFWriter::StartDeferredFormXObjectContentContext(const PDFRectangle& inBoundingBox,ObjectIDType inFormXObjectID,const double* inMatrix)
+{
+	TraceScope traceScope(GetCallTrace());
+	return mDocumentContext.StartDeferredFormXObjectContentContext(inBoundingBox,inFormXObjectID,inMatrix);
+}
+
+EStatusCode PDFWriter::WriteDeferredFormXObjectAndRelease(DeferredFormXObjectContentContext* inFormContext)
+{
+	TraceScope traceScope(GetCallTrace());
+	return mDocumentContext.WriteDeferredFormXObjectAndRelease(inFormContext);
+}
+
+void PDFWriter::SetSharedResourcesLock(ISharedResourcesLock* inSharedResourcesLock)
+{
+	mDocumentContext.SetSharedResourcesLock(inSharedResourcesLock);
+}
+
 PDFFormXObject* PDFWriter::StartFormXObject(const PDFRectangle& inBoundingBox,const double* inMatrix)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.StartFormXObject(inBoundingBox,inMatrix);
 }
 
 PDFFormXObject* PDFWriter::StartFormXObject(const PDFRectangle& inBoundingBox,ObjectIDType inFormXObjectID,const double* inMatrix)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.StartFormXObject(inBoundingBox,inFormXObjectID,inMatrix);
 }
 
 EStatusCode PDFWriter::EndFormXObject(PDFFormXObject* inFormXObject)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.EndFormXObject(inFormXObject);
 }
 
 EStatusCode PDFWriter::EndFormXObjectAndRelease(PDFFormXObject* inFormXObject)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.EndFormXObjectAndRelease(inFormXObject);
 }
 
 PDFImageXObject* PDFWriter::CreateImageXObjectFromJPGFile(const std::string& inJPGFilePath)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.CreateImageXObjectFromJPGFile(inJPGFilePath); 
 }
 
 PDFFormXObject* PDFWriter::CreateFormXObjectFromJPGFile(const std::string& inJPGFilePath)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.CreateFormXObjectFromJPGFile(inJPGFilePath); 
 }
 
 #ifndef PDFHUMMUS_NO_TIFF
 PDFFormXObject* PDFWriter::CreateFormXObjectFromTIFFFile(const std::string& inTIFFFilePath,const TIFFUsageParameters& inTIFFUsageParameters)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.CreateFormXObjectFromTIFFFile(inTIFFFilePath,inTIFFUsageParameters); 
 }
 
 PDFFormXObject* PDFWriter::CreateFormXObjectFromTIFFFile(const std::string& inTIFFFilePath,ObjectIDType inFormXObjectID, const TIFFUsageParameters& inTIFFUsageParameters)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.CreateFormXObjectFromTIFFFile(inTIFFFilePath,inFormXObjectID,inTIFFUsageParameters);
 }
 
 PDFFormXObject* PDFWriter::CreateFormXObjectFromTIFFStream(IByteReaderWithPosition* inTIFFStream,
                                                            const TIFFUsageParameters& inTIFFUsageParameters)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.CreateFormXObjectFromTIFFStream(inTIFFStream,inTIFFUsageParameters);
 }
 
@@ -258,6 +418,7 @@ PDFFormXObject* PDFWriter::CreateFormXObjectFromTIFFStream(IByteReaderWithPositi
                                                            ObjectIDType inFormXObjectID,
                                                            const TIFFUsageParameters& inTIFFUsageParameters)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.CreateFormXObjectFromTIFFStream(inTIFFStream,inFormXObjectID,inTIFFUsageParameters);
 }
 
@@ -265,25 +426,39 @@ PDFFormXObject* PDFWriter::CreateFormXObjectFromTIFFStream(IByteReaderWithPositi
 
 PDFImageXObject* PDFWriter::CreateImageXObjectFromJPGFile(const std::string& inJPGFilePath,ObjectIDType inImageXObjectID)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.CreateImageXObjectFromJPGFile(inJPGFilePath,inImageXObjectID); 
 }
 
 PDFFormXObject* PDFWriter::CreateFormXObjectFromJPGFile(const std::string& inJPGFilePath,ObjectIDType inImageXObjectID)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.CreateFormXObjectFromJPGFile(inJPGFilePath,inImageXObjectID); 
 }
 
 
 PDFUsedFont* PDFWriter::GetFontForFile(const std::string& inFontFilePath,long inFontIndex)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.GetFontForFile(inFontFilePath,inFontIndex);
 }
 
 PDFUsedFont* PDFWriter::GetFontForFile(const std::string& inFontFilePath,const std::string& inAdditionalMeticsFilePath,long inFontIndex)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.GetFontForFile(inFontFilePath,inAdditionalMeticsFilePath,inFontIndex);
 }
 
+void PDFWriter::SetSharedFontsCache(SharedFontsCache* inSharedFontsCache)
+{
+	mDocumentContext.SetSharedFontsCache(inSharedFontsCache);
+}
+
+void PDFWriter::SetFontProgramsCache(FontProgramsCache* inFontProgramsCache)
+{
+	mDocumentContext.SetFontProgramsCache(inFontProgramsCache);
+}
+
 EStatusCodeAndObjectIDTypeList PDFWriter::CreateFormXObjectsFromPDF(const std::string& inPDFFilePath,
 																	  const PDFPageRange& inPageRange,
 																	  EPDFPageBox inPageBoxToUseAsFormBox,
@@ -291,6 +466,7 @@ EStatusCodeAndObjectIDTypeList PDFWriter::CreateFormXObjectsFromPDF(const std::s
 																	  const ObjectIDTypeList& inCopyAdditionalObjects,
 																	  const PDFParsingOptions& inParsingOptions)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.CreateFormXObjectsFromPDF(inPDFFilePath,
 														inParsingOptions,
 														inPageRange,
@@ -306,6 +482,7 @@ EStatusCodeAndObjectIDTypeList PDFWriter::CreateFormXObjectsFromPDF(const std::s
 																	 const ObjectIDTypeList& inCopyAdditionalObjects,
 																	const PDFParsingOptions& inParsingOptions)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.CreateFormXObjectsFromPDF(inPDFFilePath,
 														inParsingOptions,
 														inPageRange,
@@ -319,6 +496,7 @@ EStatusCodeAndObjectIDTypeList PDFWriter::AppendPDFPagesFromPDF(const std::strin
 																const ObjectIDTypeList& inCopyAdditionalObjects,
 																const PDFParsingOptions& inParsingOptions)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.AppendPDFPagesFromPDF(inPDFFilePath,
 														inParsingOptions,
 														inPageRange,
@@ -327,6 +505,7 @@ EStatusCodeAndObjectIDTypeList PDFWriter::AppendPDFPagesFromPDF(const std::strin
 
 EStatusCode PDFWriter::Shutdown(const std::string& inStateFilePath)
 {
+	TraceScope traceScope(GetCallTrace());
 	EStatusCode status;
 
 	do
@@ -361,10 +540,16 @@ EStatusCode PDFWriter::Shutdown(const std::string& inStateFilePath)
 		pdfWriterDictionary->WriteKey("mEmbedFonts");
 		pdfWriterDictionary->WriteBooleanValue(mEmbedFonts);
 
+		pdfWriterDictionary->WriteKey("mLinearize");
+		pdfWriterDictionary->WriteBooleanValue(mLinearize);
+
         if(mIsModified)
         {
             pdfWriterDictionary->WriteKey("mModifiedFileVersion");
             pdfWriterDictionary->WriteIntegerValue(mModifiedFileVersion);
+
+            pdfWriterDictionary->WriteKey("mUseMemoryMappingForModifiedFile");
+            pdfWriterDictionary->WriteBooleanValue(mUseMemoryMappingForModifiedFile);
         }
         
 		writer.GetObjectsWriter()->EndDictionary(pdfWriterDictionary);
@@ -395,7 +580,7 @@ EStatusCode PDFWriter::Shutdown(const std::string& inStateFilePath)
 	}
 	else
 		status = mOutputFile.CloseFile();
-	//ReleaseLog();
+	ReleaseLog();
 	return status;
 }
 
@@ -407,28 +592,30 @@ EStatusCode PDFWriter::ContinuePDF(const std::string& inOutputFilePath,
 	
 
 	SetupLog(inLogConfiguration);
+	TraceScope traceScope(GetCallTrace());
+	mObjectsContext.GetMetrics().Reset();
 	EStatusCode status = mOutputFile.OpenFile(inOutputFilePath,true);
 	if(status != eSuccess)
 		return status;
 
+	mObjectsContext.SetOutputStream(mOutputFile.GetOutputStream());
+	mDocumentContext.SetOutputFileInformation(&mOutputFile);
+
+	status = SetupState(inStateFilePath);
+	if(status != eSuccess)
+		return status;
+
     if(inOptionalModifiedFile.size() != 0)
     {
-        // setup parser for reading modified file
-        status = mModifiedFile.OpenFile(inOptionalModifiedFile);
+        // setup parser for reading modified file. after reading the state, so the file is read the same way as in the original session
+        status = mModifiedFile.OpenFile(inOptionalModifiedFile,mUseMemoryMappingForModifiedFile);
         if(status != eSuccess)
             return status;
         
-        status = mModifiedFileParser.StartPDFParsing(mModifiedFile.GetInputStream());
-        if(status != eSuccess)
-            return status;
+        status = mModifiedFileParser.StartPDFParsing(mModifiedFile.GetInputStream(),PDFParsingOptions::DefaultPDFParsingOptions,mModifiedFile.GetInputStreamWindow());
     }
-    
-	mObjectsContext.SetOutputStream(mOutputFile.GetOutputStream());
-	mDocumentContext.SetOutputFileInformation(&mOutputFile);
-
-	return SetupState(inStateFilePath);
-
 
+	return status;
 }
 
 EStatusCode PDFWriter::SetupState(const std::string& inStateFilePath)
@@ -455,11 +642,17 @@ EStatusCode PDFWriter::SetupState(const std::string& inStateFilePath)
         {
             PDFObjectCastPtr<PDFInteger> isModifiedFileVersionObject(pdfWriterDictionary->QueryDirectObject("mModifiedFileVersion"));
             mModifiedFileVersion = (EPDFVersion)(isModifiedFileVersionObject->GetValue());
+
+            PDFObjectCastPtr<PDFBoolean> useMemoryMappingObject(pdfWriterDictionary->QueryDirectObject("mUseMemoryMappingForModifiedFile"));
+            mUseMemoryMappingForModifiedFile = !!useMemoryMappingObject && useMemoryMappingObject->GetValue();
         }
 
 		PDFObjectCastPtr<PDFBoolean> embedFontsObject(pdfWriterDictionary->QueryDirectObject("mEmbedFonts"));
 		mEmbedFonts = embedFontsObject->GetValue();
 
+		PDFObjectCastPtr<PDFBoolean> linearizeObject(pdfWriterDictionary->QueryDirectObject("mLinearize"));
+		mLinearize = !!linearizeObject && linearizeObject->GetValue();
+
 
 		PDFObjectCastPtr<PDFIndirectObjectReference> objectsContextObject(pdfWriterDictionary->QueryDirectObject("mObjectsContext"));
 		status = mObjectsContext.ReadState(reader.GetObjectsReader(),objectsContextObject->mObjectID);
@@ -485,6 +678,8 @@ EStatusCode PDFWriter::ContinuePDFForStream(IByteWriterWithPosition* inOutputStr
 			 								const LogConfiguration& inLogConfiguration)
 {
 	SetupLog(inLogConfiguration);
+	TraceScope traceScope(GetCallTrace());
+	mObjectsContext.GetMetrics().Reset();
     
     if(inModifiedSourceStream)
         if(mModifiedFileParser.StartPDFParsing(inModifiedSourceStream) != eSuccess)
@@ -499,11 +694,13 @@ EStatusCode PDFWriter::ContinuePDFForStream(IByteWriterWithPosition* inOutputStr
 
 PDFDocumentCopyingContext* PDFWriter::CreatePDFCopyingContext(const std::string& inPDFFilePath, const PDFParsingOptions& inOptions)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.CreatePDFCopyingContext(inPDFFilePath, inOptions);
 }
 
 EStatusCode PDFWriter::AttachURLLinktoCurrentPage(const std::string& inURL,const PDFRectangle& inLinkClickArea)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.AttachURLLinktoCurrentPage(inURL,inLinkClickArea);
 }
 
@@ -513,6 +710,7 @@ EStatusCode PDFWriter::MergePDFPagesToPage(PDFPage* inPage,
 								const ObjectIDTypeList& inCopyAdditionalObjects,
 								const PDFParsingOptions& inParsingOptions)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.MergePDFPagesToPage(inPage,
 												inPDFFilePath,
 												inParsingOptions,
@@ -527,7 +725,10 @@ EStatusCode PDFWriter::StartPDFForStream(IByteWriterWithPosition* inOutputStream
 										 const PDFCreationSettings& inPDFCreationSettings)
 {
 	SetupLog(inLogConfiguration);
+	TraceScope traceScope(GetCallTrace());
 	SetupCreationSettings(inPDFCreationSettings);
+	SetupObjectStreams(inPDFCreationSettings,inPDFVersion);
+	SetupLinearization(inPDFCreationSettings,false);
 	if (inPDFCreationSettings.DocumentEncryptionOptions.ShouldEncrypt) {
 		mDocumentContext.SetupEncryption(inPDFCreationSettings.DocumentEncryptionOptions, inPDFVersion);
 		if (!mDocumentContext.SupportsEncryption())
@@ -541,6 +742,8 @@ EStatusCode PDFWriter::StartPDFForStream(IByteWriterWithPosition* inOutputStream
 }
 EStatusCode PDFWriter::EndPDFForStream()
 {
+	TraceScope traceScope(GetCallTrace());
+	PDFMetricsPhaseScope phaseScope(mObjectsContext.GetMetrics(),ePDFMetricsPhaseEndPDF);
     EStatusCode status;
     
     if(mIsModified)
@@ -554,22 +757,26 @@ EStatusCode PDFWriter::EndPDFForStream()
 
 PDFImageXObject* PDFWriter::CreateImageXObjectFromJPGStream(IByteReaderWithPosition* inJPGStream)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.CreateImageXObjectFromJPGStream(inJPGStream);
 }
 
 PDFImageXObject* PDFWriter::CreateImageXObjectFromJPGStream(IByteReaderWithPosition* inJPGStream,ObjectIDType inImageXObjectID)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.CreateImageXObjectFromJPGStream(inJPGStream,inImageXObjectID);
 }
 
 PDFFormXObject* PDFWriter::CreateFormXObjectFromJPGStream(IByteReaderWithPosition* inJPGStream)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.CreateFormXObjectFromJPGStream(inJPGStream);
 
 }
 
 PDFFormXObject* PDFWriter::CreateFormXObjectFromJPGStream(IByteReaderWithPosition* inJPGStream,ObjectIDType inFormXObjectID)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.CreateFormXObjectFromJPGStream(inJPGStream,inFormXObjectID);
 }
 
@@ -580,6 +787,7 @@ EStatusCodeAndObjectIDTypeList PDFWriter::CreateFormXObjectsFromPDF(IByteReaderW
 																	const ObjectIDTypeList& inCopyAdditionalObjects,
 																	const PDFParsingOptions& inParsingOptions)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.CreateFormXObjectsFromPDF(inPDFStream,inParsingOptions,inPageRange,inPageBoxToUseAsFormBox,inTransformationMatrix,inCopyAdditionalObjects);
 }
 
@@ -590,6 +798,7 @@ EStatusCodeAndObjectIDTypeList PDFWriter::CreateFormXObjectsFromPDF(IByteReaderW
 																	const ObjectIDTypeList& inCopyAdditionalObjects,
 																	const PDFParsingOptions& inParsingOptions)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.CreateFormXObjectsFromPDF(inPDFStream,inParsingOptions,inPageRange,inCropBox,inTransformationMatrix,inCopyAdditionalObjects);
 }
 
@@ -598,6 +807,7 @@ EStatusCodeAndObjectIDTypeList PDFWriter::AppendPDFPagesFromPDF(IByteReaderWithP
 																const ObjectIDTypeList& inCopyAdditionalObjects,
 																const PDFParsingOptions& inParsingOptions)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.AppendPDFPagesFromPDF(inPDFStream,inParsingOptions,inPageRange,inCopyAdditionalObjects);
 }
 
@@ -607,11 +817,13 @@ EStatusCode PDFWriter::MergePDFPagesToPage(	PDFPage* inPage,
 											const ObjectIDTypeList& inCopyAdditionalObjects,
 											const PDFParsingOptions& inParsingOptions)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.MergePDFPagesToPage(inPage,inPDFStream, inParsingOptions,inPageRange,inCopyAdditionalObjects);
 }
 
 PDFDocumentCopyingContext* PDFWriter::CreatePDFCopyingContext(IByteReaderWithPosition* inPDFStream, const PDFParsingOptions& inOptions)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.CreatePDFCopyingContext(inPDFStream,inOptions);	
 }
 
@@ -624,7 +836,9 @@ EStatusCode PDFWriter::ModifyPDF(const std::string& inModifiedFile,
     EStatusCode status = eSuccess;
     
     SetupLog(inLogConfiguration);
+    TraceScope traceScope(GetCallTrace());
 	SetupCreationSettings(inPDFCreationSettings);
+	SetupLinearization(inPDFCreationSettings,false);
 	
     do 
     {
@@ -674,7 +888,9 @@ EStatusCode PDFWriter::ModifyPDFForStream(
                                       const PDFCreationSettings& inPDFCreationSettings)
 {    
     SetupLog(inLogConfiguration);
+    TraceScope traceScope(GetCallTrace());
 	SetupCreationSettings(inPDFCreationSettings);
+	SetupLinearization(inPDFCreationSettings,false);
     
     if(!inAppendOnly)
     {
@@ -695,7 +911,8 @@ EStatusCode PDFWriter::ModifyPDFForStream(
 
 EStatusCode PDFWriter::SetupStateFromModifiedStream(IByteReaderWithPosition* inModifiedSourceStream,
                                                     EPDFVersion inPDFVersion,
-													const PDFCreationSettings& inPDFCreationSettings)
+													const PDFCreationSettings& inPDFCreationSettings,
+													IReadWindowProvider* inModifiedSourceStreamWindow)
 {
     EStatusCode status;
 	PDFParsingOptions parsingOptions;
@@ -709,11 +926,15 @@ EStatusCode PDFWriter::SetupStateFromModifiedStream(IByteReaderWithPosition* inM
 
     do 
     {
-        status = mModifiedFileParser.StartPDFParsing(inModifiedSourceStream, parsingOptions);
+        status = mModifiedFileParser.StartPDFParsing(inModifiedSourceStream, parsingOptions, inModifiedSourceStreamWindow);
         if(status != eSuccess)
             break;    
         
         mObjectsContext.SetupModifiedFile(&mModifiedFileParser);
+
+        // final version is the higher of the original document version and the requested version
+        EPDFVersion originalPDFVersion = (EPDFVersion)((size_t)(mModifiedFileParser.GetPDFLevel() * 10));
+        SetupObjectStreams(inPDFCreationSettings,originalPDFVersion > inPDFVersion ? originalPDFVersion : inPDFVersion);
         
         status = mDocumentContext.SetupModifiedFile(&mModifiedFileParser);
         if(status != eSuccess)
@@ -740,11 +961,12 @@ EStatusCode PDFWriter::SetupStateFromModifiedFile(const std::string& inModifiedF
     
     do
     {
-        status = mModifiedFile.OpenFile(inModifiedFile);
+        mUseMemoryMappingForModifiedFile = inPDFCreationSettings.UseMemoryMappingForModifiedFile;
+        status = mModifiedFile.OpenFile(inModifiedFile,mUseMemoryMappingForModifiedFile);
         if(status != eSuccess)
             break;
         
-        status = SetupStateFromModifiedStream(mModifiedFile.GetInputStream(),inPDFVersion, inPDFCreationSettings);
+        status = SetupStateFromModifiedStream(mModifiedFile.GetInputStream(),inPDFVersion, inPDFCreationSettings, mModifiedFile.GetInputStreamWindow());
     }
     while(false);
     
@@ -763,21 +985,25 @@ InputFile& PDFWriter::GetModifiedInputFile()
 
 PDFDocumentCopyingContext* PDFWriter::CreatePDFCopyingContextForModifiedFile()
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.CreatePDFCopyingContext(&mModifiedFileParser);    
 }
 
 DoubleAndDoublePair PDFWriter::GetImageDimensions(const std::string& inImageFile,unsigned long inImageIndex, const PDFParsingOptions& inParsingOptions)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.GetImageDimensions(inImageFile,inImageIndex,inParsingOptions);
 }
 
 PDFHummus::EHummusImageType PDFWriter::GetImageType(const std::string& inImageFile,unsigned long inImageIndex)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.GetImageType(inImageFile,inImageIndex);
 }
 
 unsigned long PDFWriter::GetImagePagesCount(const std::string& inImageFile, const PDFParsingOptions& inOptions)
 {
+	TraceScope traceScope(GetCallTrace());
 	return mDocumentContext.GetImagePagesCount(inImageFile,inOptions);
 }
 
@@ -814,6 +1040,8 @@ PDFHummus::EStatusCode PDFWriter::RecryptPDF(
 	IByteWriterWithPosition* inNewPDFStream,
 	const LogConfiguration& inLogConfiguration,
 	const PDFCreationSettings& inPDFCreationSettings) {
+	// the copying context is used directly, so scope the log trace for the whole recryption
+	TraceScope traceScope(inLogConfiguration.LogTrace ? inLogConfiguration.LogTrace : Trace::GetThreadTrace());
 	PDFWriter pdfWriter;
 	EStatusCode status;
 	PDFDocumentCopyingContext* copyingContext = NULL;
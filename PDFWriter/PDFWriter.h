@@ -40,16 +40,24 @@
 
 typedef std::pair<double,double> DoubleAndDoublePair;
 
+class Trace;
+
 struct LogConfiguration
 {
 	bool ShouldLog;
 	bool StartWithBOM;
 	std::string LogFileLocation;
 	IByteWriter* LogStream;
+	// log to this trace instead of the default one. until the document ends, the writer sets it as the calling thread trace (see TraceScope)
+	// for the duration of each of its calls, so writers on different threads can log separately, and a document may be started and ended
+	// on different threads. calls made directly on contexts the writer returns (content contexts, copying contexts, the document context)
+	// log to the calling thread trace, so scope them with TraceScope to log them to this trace too. the trace own settings determine where and what to log
+	Trace* LogTrace;
 
 	LogConfiguration(bool inShouldLog,bool inStartWithBOM,const std::string& inLogFileLocation){ShouldLog=inShouldLog;StartWithBOM = inStartWithBOM;
-																							LogFileLocation=inLogFileLocation;LogStream = NULL;}
-	LogConfiguration(bool inShouldLog,IByteWriter* inLogStream){ShouldLog = inShouldLog;LogStream = inLogStream;StartWithBOM = false;}
+																							LogFileLocation=inLogFileLocation;LogStream = NULL;LogTrace = NULL;}
+	LogConfiguration(bool inShouldLog,IByteWriter* inLogStream){ShouldLog = inShouldLog;LogStream = inLogStream;StartWithBOM = false;LogTrace = NULL;}
+	LogConfiguration(Trace* inLogTrace){ShouldLog = true;LogStream = NULL;StartWithBOM = false;LogTrace = inLogTrace;}
 
 	static const LogConfiguration DefaultLogConfiguration;
 };
@@ -59,16 +67,54 @@ struct PDFCreationSettings
 	bool CompressStreams;
 	bool EmbedFonts;
 	EncryptionOptions DocumentEncryptionOptions;
-
-	PDFCreationSettings(bool inCompressStreams, bool inEmbedFonts,EncryptionOptions inDocumentEncryptionOptions = EncryptionOptions::DefaultEncryptionOptions):DocumentEncryptionOptions(inDocumentEncryptionOptions){ 
+	// pack non-stream objects into object streams, and write the xref as an xref stream. 
+	// requires PDF 1.5 and up, and ignored for encrypted documents
+	bool UseObjectStreams;
+	// when modifying a file (ModifyPDF), map it to memory for reading instead of reading it through a buffered file stream
+	bool UseMemoryMappingForModifiedFile;
+	// number of threads for compressing streams. with more than 1, large streams are compressed in parallel chunks
+	unsigned int FlateEncodingThreads;
+	// number of threads for creating the embedded fonts subsets when the document ends. with more than 1, the subsets of
+	// all fonts are created in parallel before writing the fonts. the written document is the same either way
+	unsigned int FontSubsettingThreads;
+	// flate compression level, strategy and memory level per stream category. see FlateCompressionPolicy.h
+	FlateCompressionPolicy CompressionPolicy;
+	// when copying from other PDFs, write equivalent copied objects (e.g. the same image, font program or ICC profile) only once,
+	// even when they come from different source documents. see CopiedObjectsRegistry.h
+	bool DeduplicateCopiedObjects;
+	// number of decimal places for real numbers (coordinates, matrices, colors etc.). trailing zeros are dropped.
+	// lower values make for smaller content streams. default is DEFAULT_DOUBLE_PRECISION (6), max is MAX_DOUBLE_PRECISION (15)
+	unsigned int DoublePrecision;
+	// write the document linearized ("Fast Web View"), so viewers can show the first page before reading the whole file.
+	// the document is written as usual, and then rewritten linearized when it ends (EndPDF). see PDFLinearizer.h.
+	// only for new documents written to a file (StartPDF), and ignored for encrypted documents
+	bool Linearize;
+	// write objects and content with minimal whitespace - no dictionary indentation, and no line ends between values.
+	// the document is the same, only smaller and quicker to write
+	bool CompactSerialization;
+
+	PDFCreationSettings(bool inCompressStreams, bool inEmbedFonts,EncryptionOptions inDocumentEncryptionOptions = EncryptionOptions::DefaultEncryptionOptions,bool inUseObjectStreams = false):DocumentEncryptionOptions(inDocumentEncryptionOptions){ 
 		CompressStreams = inCompressStreams; 
 		EmbedFonts = inEmbedFonts;
+		UseObjectStreams = inUseObjectStreams;
+		UseMemoryMappingForModifiedFile = false;
+		FlateEncodingThreads = 1;
+		FontSubsettingThreads = 1;
+		DeduplicateCopiedObjects = false;
+		DoublePrecision = DEFAULT_DOUBLE_PRECISION;
+		Linearize = false;
+		CompactSerialization = false;
 	}
 
 	static const PDFCreationSettings DefaultPDFCreationSettings;
 };
 
 class PageContentContext;
+class DeferredPageContentContext;
+class DeferredFormXObjectContentContext;
+class ISharedResourcesLock;
+class SharedFontsCache;
+class FontProgramsCache;
 class PDFFormXObject;
 class PDFImageXObject;
 class PDFUsedFont;
@@ -141,6 +187,20 @@ public:
 	EStatusCodeAndObjectIDType WritePageAndReturnPageID(PDFPage* inPage);
 	EStatusCodeAndObjectIDType WritePageReleaseAndReturnPageID(PDFPage* inPage);
 
+	// Deferred page content, for generating page content on multiple threads. see DeferredPageContentContext.h for the threading contract.
+	// start a deferred context per page, write to it from any thread, then commit the pages in order (from the PDFWriter thread) with WriteDeferredPageAndRelease.
+	// commit writes the page content and the page, and releases both the page and the context.
+	DeferredPageContentContext* StartDeferredPageContentContext(PDFPage* inPage);
+	PDFHummus::EStatusCode WriteDeferredPageAndRelease(DeferredPageContentContext* inPageContext);
+	EStatusCodeAndObjectIDType WriteDeferredPageReleaseAndReturnPageID(DeferredPageContentContext* inPageContext);
+	// Deferred form xobjects, the same for forms. see DeferredFormXObjectContentContext.h. the form ID is available right away (GetObjectID), for placing the form,
+	// and the form with its resources is written on commit, with WriteDeferredFormXObjectAndRelease (from the PDFWriter thread).
+	DeferredFormXObjectContentContext* StartDeferredFormXObjectContentContext(const PDFRectangle& inBoundingBox,const double* inMatrix = NULL);
+	DeferredFormXObjectContentContext* StartDeferredFormXObjectContentContext(const PDFRectangle& inBoundingBox,ObjectIDType inFormXObjectID,const double* inMatrix = NULL);
+	PDFHummus::EStatusCode WriteDeferredFormXObjectAndRelease(DeferredFormXObjectContentContext* inFormContext);
+	// lock for shared resources access, when writing deferred content from multiple threads. not owned. set prior to starting deferred contexts
+	void SetSharedResourcesLock(ISharedResourcesLock* inSharedResourcesLock);
+
 
 	// Form XObject creating and writing
 	PDFFormXObject* StartFormXObject(const PDFRectangle& inBoundingBox,const double* inMatrix = NULL);
@@ -264,11 +324,21 @@ public:
 	PDFUsedFont* GetFontForFile(const std::string& inFontFilePath,long inFontIndex = 0);
 	// second overload is for type 1, when an additional metrics file is available
 	PDFUsedFont* GetFontForFile(const std::string& inFontFilePath,const std::string& inAdditionalMeticsFilePath,long inFontIndex = 0);
+	// font data cache (not owned), shared with other writers, possibly on other threads. saves reading font files and measuring glyphs per document.
+	// set before getting fonts. see SharedFontsCache.h
+	void SetSharedFontsCache(SharedFontsCache* inSharedFontsCache);
+	// embedded font programs cache (not owned), shared with other writers, possibly on other threads. documents embedding the same subsets
+	// copy the finished programs instead of subsetting and compressing the fonts again. set before getting fonts. see FontProgramsCache.h
+	void SetFontProgramsCache(FontProgramsCache* inFontProgramsCache);
 
 	// URL links
 	// URL should be encoded to be a valid URL, ain't gonna be checking that!
 	PDFHummus::EStatusCode AttachURLLinktoCurrentPage(const std::string& inURL,const PDFRectangle& inLinkClickArea);
 
+	// counters and phase timings of the current document, including the parsing of copied and modified PDFs.
+	// reset when a document starts, and kept after it ends. use GetSnapshot or ToJSON to read. see PDFMetrics.h
+	PDFMetrics& GetMetrics();
+
 	// Extensibility, reaching to lower levels
 	PDFHummus::DocumentContext& GetDocumentContext();
 	ObjectsContext& GetObjectsContext();
@@ -302,6 +372,10 @@ private:
 
 	// options
 	bool mEmbedFonts;
+	bool mLinearize;
+
+	// log trace set by SetupLog, scoped as the thread trace for each call (see GetCallTrace)
+	Trace* mLogTrace;
 
 	// for output file workflow, this will be the valid output [stream workflow does not have a file]
 	OutputFile mOutputFile;
@@ -311,13 +385,19 @@ private:
     PDFParser mModifiedFileParser;
     EPDFVersion mModifiedFileVersion;
     bool mIsModified;
+    // kept in the state, so that a continued session reads the modified file the same way
+    bool mUseMemoryMappingForModifiedFile;
 
 	void SetupLog(const LogConfiguration& inLogConfiguration);
 	void SetupCreationSettings(const PDFCreationSettings& inPDFCreationSettings);
+	void SetupObjectStreams(const PDFCreationSettings& inPDFCreationSettings,EPDFVersion inPDFVersion);
+	void SetupLinearization(const PDFCreationSettings& inPDFCreationSettings,bool inIsNewFile);
+	PDFHummus::EStatusCode LinearizeOutputFile();
 	void ReleaseLog();
+	Trace* GetCallTrace();
 	PDFHummus::EStatusCode SetupState(const std::string& inStateFilePath);
 	void Cleanup();
     PDFHummus::EStatusCode SetupStateFromModifiedFile(const std::string& inModifiedFile,EPDFVersion inPDFVersion, const PDFCreationSettings& inPDFCreationSettings);
-    PDFHummus::EStatusCode SetupStateFromModifiedStream(IByteReaderWithPosition* inModifiedSourceStream,EPDFVersion inPDFVersion, const PDFCreationSettings& inPDFCreationSettings);
+    PDFHummus::EStatusCode SetupStateFromModifiedStream(IByteReaderWithPosition* inModifiedSourceStream,EPDFVersion inPDFVersion, const PDFCreationSettings& inPDFCreationSettings,IReadWindowProvider* inModifiedSourceStreamWindow = NULL);
 
 };
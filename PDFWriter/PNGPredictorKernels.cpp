@@ -0,0 +1,169 @@
+/*
+   Source File : PNGPredictorKernels.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "PNGPredictorKernels.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PNG_PREDICTOR_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace IOBasicTypes;
+
+bool PNGPredictorKernels::UnfilterRow(Byte inFilterType,
+									  Byte* ioRow,
+									  const Byte* inUpRow,
+									  LongBufferSizeType inRowSize,
+									  LongBufferSizeType inBytesPerPixel)
+{
+	switch(inFilterType)
+	{
+		case PNG_FILTER_NONE:
+			return true;
+		case PNG_FILTER_SUB:
+			UnfilterSubRow(ioRow,inRowSize,inBytesPerPixel);
+			return true;
+		case PNG_FILTER_UP:
+			UnfilterUpRow(ioRow,inUpRow,inRowSize);
+			return true;
+		case PNG_FILTER_AVERAGE:
+			UnfilterAverageRow(ioRow,inUpRow,inRowSize,inBytesPerPixel);
+			return true;
+		case PNG_FILTER_PAETH:
+			UnfilterPaethRow(ioRow,inUpRow,inRowSize,inBytesPerPixel);
+			return true;
+		default:
+			return false;
+	}
+}
+
+#ifdef PNG_PREDICTOR_USE_SSE2
+// load/store a single pixel of 3 or 4 bytes into the low bytes of an SSE register
+static __m128i LoadPixel(const Byte* inPixel,LongBufferSizeType inBytesPerPixel)
+{
+	int value = 0;
+	memcpy(&value,inPixel,inBytesPerPixel);
+	return _mm_cvtsi32_si128(value);
+}
+
+static void StorePixel(Byte* inPixel,__m128i inValue,LongBufferSizeType inBytesPerPixel)
+{
+	int value = _mm_cvtsi128_si32(inValue);
+	memcpy(inPixel,&value,inBytesPerPixel);
+}
+#endif
+
+void PNGPredictorKernels::UnfilterSubRow(Byte* ioRow,LongBufferSizeType inRowSize,LongBufferSizeType inBytesPerPixel)
+{
+	LongBufferSizeType i = inBytesPerPixel;
+
+#ifdef PNG_PREDICTOR_USE_SSE2
+	if(3 == inBytesPerPixel || 4 == inBytesPerPixel)
+	{
+		// a whole pixel at a time, carrying the left pixel in a register
+		__m128i left = _mm_setzero_si128();
+		for(i = 0; i + inBytesPerPixel <= inRowSize; i += inBytesPerPixel)
+		{
+			left = _mm_add_epi8(left,LoadPixel(ioRow + i,inBytesPerPixel));
+			StorePixel(ioRow + i,left,inBytesPerPixel);
+		}
+		if(i < inBytesPerPixel)
+			i = inBytesPerPixel;
+	}
+#endif
+
+	for(; i < inRowSize; ++i)
+		ioRow[i] = (Byte)(ioRow[i] + ioRow[i - inBytesPerPixel]);
+}
+
+void PNGPredictorKernels::UnfilterUpRow(Byte* ioRow,const Byte* inUpRow,LongBufferSizeType inRowSize)
+{
+	LongBufferSizeType i = 0;
+
+#ifdef PNG_PREDICTOR_USE_SSE2
+	for(; i + 16 <= inRowSize; i += 16)
+	{
+		__m128i row = _mm_loadu_si128((const __m128i*)(ioRow + i));
+		__m128i up = _mm_loadu_si128((const __m128i*)(inUpRow + i));
+		_mm_storeu_si128((__m128i*)(ioRow + i),_mm_add_epi8(row,up));
+	}
+#endif
+
+	for(; i < inRowSize; ++i)
+		ioRow[i] = (Byte)(ioRow[i] + inUpRow[i]);
+}
+
+void PNGPredictorKernels::UnfilterAverageRow(Byte* ioRow,const Byte* inUpRow,LongBufferSizeType inRowSize,LongBufferSizeType inBytesPerPixel)
+{
+	LongBufferSizeType i = 0;
+
+#ifdef PNG_PREDICTOR_USE_SSE2
+	if(3 == inBytesPerPixel || 4 == inBytesPerPixel)
+	{
+		// pavgb rounds up, so remove the rounding bit to get floor((left + up)/2)
+		__m128i left = _mm_setzero_si128();
+		__m128i ones = _mm_set1_epi8(1);
+		for(; i + inBytesPerPixel <= inRowSize; i += inBytesPerPixel)
+		{
+			__m128i up = LoadPixel(inUpRow + i,inBytesPerPixel);
+			__m128i average = _mm_sub_epi8(_mm_avg_epu8(left,up),_mm_and_si128(_mm_xor_si128(left,up),ones));
+			left = _mm_add_epi8(LoadPixel(ioRow + i,inBytesPerPixel),average);
+			StorePixel(ioRow + i,left,inBytesPerPixel);
+		}
+	}
+#endif
+
+	// first pixel has no left neighbour
+	for(; i < inBytesPerPixel && i < inRowSize; ++i)
+		ioRow[i] = (Byte)(ioRow[i] + (inUpRow[i] >> 1));
+
+	for(; i < inRowSize; ++i)
+		ioRow[i] = (Byte)(ioRow[i] + (((unsigned int)ioRow[i - inBytesPerPixel] + inUpRow[i]) >> 1));
+}
+
+void PNGPredictorKernels::UnfilterPaethRow(Byte* ioRow,const Byte* inUpRow,LongBufferSizeType inRowSize,LongBufferSizeType inBytesPerPixel)
+{
+	LongBufferSizeType i = 0;
+
+	// first pixel has no left and upper-left neighbours, which makes the predictor the up value
+	for(; i < inBytesPerPixel && i < inRowSize; ++i)
+		ioRow[i] = (Byte)(ioRow[i] + inUpRow[i]);
+
+	for(; i < inRowSize; ++i)
+	{
+		int left = ioRow[i - inBytesPerPixel];
+		int up = inUpRow[i];
+		int upLeft = inUpRow[i - inBytesPerPixel];
+
+		// distances of left, up and upLeft from left + up - upLeft, written to let the compiler use conditional moves
+		int pLeft = up - upLeft;
+		int pUp = left - upLeft;
+		int pUpLeft = pLeft + pUp;
+		pLeft = pLeft < 0 ? -pLeft : pLeft;
+		pUp = pUp < 0 ? -pUp : pUp;
+		pUpLeft = pUpLeft < 0 ? -pUpLeft : pUpLeft;
+
+		int predictor = (pUp <= pUpLeft) ? up : upLeft;
+		predictor = (pLeft <= pUp && pLeft <= pUpLeft) ? left : predictor;
+		ioRow[i] = (Byte)(ioRow[i] + predictor);
+	}
+}
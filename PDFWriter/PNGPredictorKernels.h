@@ -0,0 +1,65 @@
+/*
+   Source File : PNGPredictorKernels.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "IOBasicTypes.h"
+
+// PNG filter types, as recorded in the tag byte that starts each row of a PNG predicted stream.
+// PDF predictors 10-14 stand for these types + 10, and predictor 15 (optimum) means "use the row tag"
+#define PNG_FILTER_NONE 0
+#define PNG_FILTER_SUB 1
+#define PNG_FILTER_UP 2
+#define PNG_FILTER_AVERAGE 3
+#define PNG_FILTER_PAETH 4
+
+/*
+	Row kernels for reversing PNG filters (and the TIFF horizontal differencing, which is the PNG Sub filter for 8 bit components).
+	All kernels decode a whole row in place. The row does not include the tag byte. inUpRow is the previous decoded row,
+	which should be all zeros for the first row. inBytesPerPixel is the distance to the "left" byte, which is 
+	ceil(colors*bitspercomponent/8) [and never less than 1].
+	Up, and Sub and Average for 3 and 4 bytes per pixel, use SSE2 where the compiler provides it. 
+*/
+class PNGPredictorKernels
+{
+public:
+
+	// decode a row with the given filter type. returns false if the filter type is unknown, in which case the row is unchanged
+	static bool UnfilterRow(IOBasicTypes::Byte inFilterType,
+							IOBasicTypes::Byte* ioRow,
+							const IOBasicTypes::Byte* inUpRow,
+							IOBasicTypes::LongBufferSizeType inRowSize,
+							IOBasicTypes::LongBufferSizeType inBytesPerPixel);
+
+	static void UnfilterSubRow(IOBasicTypes::Byte* ioRow,
+								IOBasicTypes::LongBufferSizeType inRowSize,
+								IOBasicTypes::LongBufferSizeType inBytesPerPixel);
+	static void UnfilterUpRow(IOBasicTypes::Byte* ioRow,
+							  const IOBasicTypes::Byte* inUpRow,
+							  IOBasicTypes::LongBufferSizeType inRowSize);
+	static void UnfilterAverageRow(IOBasicTypes::Byte* ioRow,
+									const IOBasicTypes::Byte* inUpRow,
+									IOBasicTypes::LongBufferSizeType inRowSize,
+									IOBasicTypes::LongBufferSizeType inBytesPerPixel);
+	static void UnfilterPaethRow(IOBasicTypes::Byte* ioRow,
+								 const IOBasicTypes::Byte* inUpRow,
+								 IOBasicTypes::LongBufferSizeType inRowSize,
+								 IOBasicTypes::LongBufferSizeType inBytesPerPixel);
+};
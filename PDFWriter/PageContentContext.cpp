@@ -23,7 +23,7 @@
 #include "ObjectsContext.h"
 #include "PDFStream.h"
 #include "Trace.h"
-#include "IPageEndWritingTask.h"
+#include "PageImageWritingTask.h"
 #include "DocumentContext.h"
 
 using namespace PDFHummus;
@@ -45,7 +45,7 @@ void PageContentContext::StartAStreamIfRequired()
 	if(!mCurrentStream)
 	{
 		StartContentStreamDefinition();
-		mCurrentStream = mObjectsContext->StartPDFStream();
+		mCurrentStream = mObjectsContext->StartPDFStream(NULL,false,eStreamCategoryPageContent);
 		SetPDFStreamForWrite(mCurrentStream);
 	}
 }
@@ -94,28 +94,6 @@ void PageContentContext::RenewStreamConnection()
 	StartAStreamIfRequired();
 }
 
-class PageImageWritingTask : public IPageEndWritingTask
-{
-public:
-    PageImageWritingTask(const std::string& inImagePath,unsigned long inImageIndex,ObjectIDType inObjectID,const PDFParsingOptions& inPDFParsingOptions)
-    {mImagePath = inImagePath;mImageIndex = inImageIndex;mObjectID = inObjectID;mPDFParsingOptions = inPDFParsingOptions;}
-    
-    virtual ~PageImageWritingTask(){}
-    
-    virtual PDFHummus::EStatusCode Write(PDFPage* inPageObject,
-                                         ObjectsContext* inObjectsContext,
-                                         PDFHummus::DocumentContext* inDocumentContext)
-    {
-        return inDocumentContext->WriteFormForImage(mImagePath,mImageIndex,mObjectID,mPDFParsingOptions);
-    }
-    
-private:
-    std::string mImagePath;
-    unsigned long mImageIndex;
-    ObjectIDType mObjectID;
-	PDFParsingOptions mPDFParsingOptions;
-};
-
 void PageContentContext::ScheduleImageWrite(const std::string& inImagePath,unsigned long inImageIndex,ObjectIDType inObjectID, const PDFParsingOptions& inParsingOptions)
 {
     mDocumentContext->RegisterPageEndWritingTask(GetAssociatedPage(),
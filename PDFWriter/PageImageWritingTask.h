@@ -0,0 +1,53 @@
+/*
+ Source File : PageImageWritingTask.h
+ 
+ 
+ Copyright 2012 Gal Kahana PDFWriter
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ 
+ */
+#pragma once
+
+/*
+	page end task for writing images drawn with the high level DrawImage, used by page content contexts
+*/
+
+#include "IPageEndWritingTask.h"
+#include "DocumentContext.h"
+#include "PDFParsingOptions.h"
+
+#include <string>
+
+class PageImageWritingTask : public IPageEndWritingTask
+{
+public:
+    PageImageWritingTask(const std::string& inImagePath,unsigned long inImageIndex,ObjectIDType inObjectID,const PDFParsingOptions& inPDFParsingOptions)
+    {mImagePath = inImagePath;mImageIndex = inImageIndex;mObjectID = inObjectID;mPDFParsingOptions = inPDFParsingOptions;}
+    
+    virtual ~PageImageWritingTask(){}
+    
+    virtual PDFHummus::EStatusCode Write(PDFPage* inPageObject,
+                                         ObjectsContext* inObjectsContext,
+                                         PDFHummus::DocumentContext* inDocumentContext)
+    {
+        return inDocumentContext->WriteFormForImage(mImagePath,mImageIndex,mObjectID,mPDFParsingOptions);
+    }
+    
+private:
+    std::string mImagePath;
+    unsigned long mImageIndex;
+    ObjectIDType mObjectID;
+	PDFParsingOptions mPDFParsingOptions;
+};
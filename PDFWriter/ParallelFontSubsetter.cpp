@@ -0,0 +1,190 @@
+/*
+   Source File : ParallelFontSubsetter.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "ParallelFontSubsetter.h"
+#include "TrueTypeEmbeddedFontWriter.h"
+#include "CFFEmbeddedFontWriter.h"
+#include "Trace.h"
+#include "ThreadsLock.h"
+#include "WorkerThread.h"
+
+using namespace PDFHummus;
+
+// tasks are taken by the threads one at a time, so one large font doesn't hold back the fonts queued after it
+struct FontSubsetWorkQueue
+{
+	FontSubsetTaskVector* mTasks;
+	size_t mNextTask;
+	// the trace of the thread creating the subsets, for the worker threads to log to
+	Trace* mTrace;
+	ThreadsLock mLock;
+};
+
+static FontSubsetTask* TakeNextTask(FontSubsetWorkQueue* inQueue)
+{
+	FontSubsetTask* task = NULL;
+
+	inQueue->mLock.Lock();
+	if(inQueue->mNextTask < inQueue->mTasks->size())
+	{
+		task = (*(inQueue->mTasks))[inQueue->mNextTask];
+		++(inQueue->mNextTask);
+	}
+	inQueue->mLock.Unlock();
+
+	return task;
+}
+
+static void CreateSubset(FontSubsetTask* inTask)
+{
+	if(eFontSubsetTypeTrueType == inTask->mType)
+	{
+		TrueTypeEmbeddedFontWriter embeddedFontWriter;
+		inTask->mStatus = embeddedFontWriter.CreateTrueTypeSubset(*(inTask->mFontInfo),inTask->mSubsetGlyphIDs,inTask->mNotEmbedded,inTask->mFontProgram);
+	}
+	else
+	{
+		CFFEmbeddedFontWriter embeddedFontWriter;
+		inTask->mStatus = embeddedFontWriter.CreateCFFSubset(*(inTask->mFontInfo),
+															inTask->mSubsetGlyphIDs,
+															inTask->mHasCIDMapping ? &(inTask->mCIDMapping) : NULL,
+															inTask->mSubsetFontName,
+															inTask->mNotEmbedded,
+															inTask->mFontProgram);
+	}
+}
+
+static void CreateQueuedSubsets(void* inQueue)
+{
+	FontSubsetWorkQueue* queue = (FontSubsetWorkQueue*)inQueue;
+	TraceScope traceScope(queue->mTrace);
+	FontSubsetTask* task;
+	while((task = TakeNextTask(queue)) != NULL)
+		CreateSubset(task);
+}
+
+ParallelFontSubsetter::ParallelFontSubsetter(void)
+{
+}
+
+ParallelFontSubsetter::~ParallelFontSubsetter(void)
+{
+	Reset();
+}
+
+void ParallelFontSubsetter::AddTrueTypeSubset(FreeTypeFaceWrapper* inFontInfo,const UIntVector& inSubsetGlyphIDs)
+{
+	AddTask(eFontSubsetTypeTrueType,inFontInfo,inSubsetGlyphIDs,NULL,"");
+}
+
+void ParallelFontSubsetter::AddCFFSubset(FreeTypeFaceWrapper* inFontInfo,const UIntVector& inSubsetGlyphIDs,const UShortVector* inCIDMapping,const std::string& inSubsetFontName)
+{
+	AddTask(eFontSubsetTypeCFF,inFontInfo,inSubsetGlyphIDs,inCIDMapping,inSubsetFontName);
+}
+
+void ParallelFontSubsetter::AddTask(EFontSubsetType inType,FreeTypeFaceWrapper* inFontInfo,const UIntVector& inSubsetGlyphIDs,const UShortVector* inCIDMapping,const std::string& inSubsetFontName)
+{
+	FontSubsetTask* task = new FontSubsetTask();
+
+	task->mType = inType;
+	task->mFontInfo = inFontInfo;
+	task->mSubsetGlyphIDs = inSubsetGlyphIDs;
+	task->mHasCIDMapping = (inCIDMapping != NULL);
+	if(inCIDMapping)
+		task->mCIDMapping = *inCIDMapping;
+	task->mSubsetFontName = inSubsetFontName;
+	task->mStatus = eFailure;
+	task->mNotEmbedded = false;
+
+	mTasks.push_back(task);
+}
+
+void ParallelFontSubsetter::CreateSubsets(unsigned int inThreadsCount)
+{
+	if(mTasks.empty())
+		return;
+
+	FontSubsetWorkQueue queue;
+	queue.mTasks = &mTasks;
+	queue.mNextTask = 0;
+	queue.mTrace = Trace::GetThreadTrace();
+
+	// the calling thread works too, so start one thread less. no point in more threads than tasks
+	size_t threadsCount = (inThreadsCount > 0 ? inThreadsCount : 1) - 1;
+	if(threadsCount > mTasks.size() - 1)
+		threadsCount = mTasks.size() - 1;
+
+	// if a thread cannot be created, its share of the tasks is taken by the others
+	WorkerThread* threads = threadsCount > 0 ? new WorkerThread[threadsCount] : NULL;
+	for(size_t i = 0; i < threadsCount; ++i)
+		threads[i].Start(CreateQueuedSubsets,&queue);
+
+	CreateQueuedSubsets(&queue);
+
+	// deleting the threads joins them
+	delete[] threads;
+}
+
+MyStringBuf* ParallelFontSubsetter::GetTrueTypeSubset(FreeTypeFaceWrapper* inFontInfo,const UIntVector& inSubsetGlyphIDs,bool& outNotEmbedded)
+{
+	return GetSubset(eFontSubsetTypeTrueType,inFontInfo,inSubsetGlyphIDs,NULL,"",outNotEmbedded);
+}
+
+MyStringBuf* ParallelFontSubsetter::GetCFFSubset(FreeTypeFaceWrapper* inFontInfo,const UIntVector& inSubsetGlyphIDs,const UShortVector* inCIDMapping,const std::string& inSubsetFontName,bool& outNotEmbedded)
+{
+	return GetSubset(eFontSubsetTypeCFF,inFontInfo,inSubsetGlyphIDs,inCIDMapping,inSubsetFontName,outNotEmbedded);
+}
+
+MyStringBuf* ParallelFontSubsetter::GetSubset(EFontSubsetType inType,FreeTypeFaceWrapper* inFontInfo,const UIntVector& inSubsetGlyphIDs,const UShortVector* inCIDMapping,const std::string& inSubsetFontName,bool& outNotEmbedded)
+{
+	FontSubsetTaskVector::iterator it = mTasks.begin();
+
+	for(; it != mTasks.end(); ++it)
+	{
+		FontSubsetTask* task = *it;
+
+		if(task->mType == inType &&
+			task->mFontInfo == inFontInfo &&
+			task->mSubsetGlyphIDs == inSubsetGlyphIDs &&
+			task->mHasCIDMapping == (inCIDMapping != NULL) &&
+			(!inCIDMapping || task->mCIDMapping == *inCIDMapping) &&
+			task->mSubsetFontName == inSubsetFontName)
+		{
+			if(task->mStatus != eSuccess)
+				return NULL;
+			outNotEmbedded = task->mNotEmbedded;
+			return &(task->mFontProgram);
+		}
+	}
+	return NULL;
+}
+
+unsigned long ParallelFontSubsetter::GetSubsetsCount()
+{
+	return (unsigned long)mTasks.size();
+}
+
+void ParallelFontSubsetter::Reset()
+{
+	FontSubsetTaskVector::iterator it = mTasks.begin();
+	for(; it != mTasks.end(); ++it)
+		delete *it;
+	mTasks.clear();
+}
@@ -0,0 +1,95 @@
+/*
+   Source File : ParallelFontSubsetter.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "EStatusCode.h"
+#include "MyStringBuf.h"
+
+#include <string>
+#include <vector>
+
+class FreeTypeFaceWrapper;
+
+typedef std::vector<unsigned int> UIntVector;
+typedef std::vector<unsigned short> UShortVector;
+
+/*
+	Creates the embedded font programs (font subsets) of a document ahead of writing its fonts, and in parallel.
+
+	Subsetting a font (figuring out dependent glyphs, rebuilding the tables) only depends on the font file and the subset glyphs,
+	so it may run on worker threads. UsedFontsRepository adds the subsets that the fonts are about to create, creates them all
+	in parallel, and then writes the fonts in their regular order. The embedded font writers take their font program from here
+	when one was created for the exact same font, glyphs and subset name, and create it on their own otherwise.
+	This way the written document is the same as it would be without parallel subsetting.
+
+	TrueType and CFF based OpenType fonts are subsetted in parallel. Type 1 fonts are converted to CFF while writing, as before.
+*/
+
+enum EFontSubsetType
+{
+	eFontSubsetTypeTrueType,
+	eFontSubsetTypeCFF
+};
+
+struct FontSubsetTask
+{
+	EFontSubsetType mType;
+	FreeTypeFaceWrapper* mFontInfo;
+	UIntVector mSubsetGlyphIDs;
+	bool mHasCIDMapping;
+	UShortVector mCIDMapping;
+	std::string mSubsetFontName;
+
+	PDFHummus::EStatusCode mStatus;
+	bool mNotEmbedded;
+	MyStringBuf mFontProgram;
+};
+
+typedef std::vector<FontSubsetTask*> FontSubsetTaskVector;
+
+class ParallelFontSubsetter
+{
+public:
+	ParallelFontSubsetter(void);
+	~ParallelFontSubsetter(void);
+
+	// add subsets to create. the font info is used for its file path and index
+	void AddTrueTypeSubset(FreeTypeFaceWrapper* inFontInfo,const UIntVector& inSubsetGlyphIDs);
+	void AddCFFSubset(FreeTypeFaceWrapper* inFontInfo,const UIntVector& inSubsetGlyphIDs,const UShortVector* inCIDMapping,const std::string& inSubsetFontName);
+
+	// create all added subsets, using upto inThreadsCount threads (including the calling thread)
+	void CreateSubsets(unsigned int inThreadsCount);
+
+	// get a created font program. returns NULL if there isn't one for these arguments, or if its creation failed, in which
+	// case the caller should create it. the font program is owned by the subsetter, and is valid till Reset
+	MyStringBuf* GetTrueTypeSubset(FreeTypeFaceWrapper* inFontInfo,const UIntVector& inSubsetGlyphIDs,bool& outNotEmbedded);
+	MyStringBuf* GetCFFSubset(FreeTypeFaceWrapper* inFontInfo,const UIntVector& inSubsetGlyphIDs,const UShortVector* inCIDMapping,const std::string& inSubsetFontName,bool& outNotEmbedded);
+
+	unsigned long GetSubsetsCount();
+
+	void Reset();
+
+private:
+	FontSubsetTaskVector mTasks;
+
+	void AddTask(EFontSubsetType inType,FreeTypeFaceWrapper* inFontInfo,const UIntVector& inSubsetGlyphIDs,const UShortVector* inCIDMapping,const std::string& inSubsetFontName);
+	MyStringBuf* GetSubset(EFontSubsetType inType,FreeTypeFaceWrapper* inFontInfo,const UIntVector& inSubsetGlyphIDs,const UShortVector* inCIDMapping,const std::string& inSubsetFontName,bool& outNotEmbedded);
+};
@@ -22,11 +22,16 @@
 #include "SafeBufferMacrosDefs.h"
 #include "IByteWriter.h"
 
+#include <math.h>
+#include <float.h>
+
 using namespace IOBasicTypes;
 
 PrimitiveObjectsWriter::PrimitiveObjectsWriter(IByteWriter* inStreamForWriting)
 {
 	mStreamForWriting = inStreamForWriting;
+	mDoublePrecision = DEFAULT_DOUBLE_PRECISION;
+	mCompactSerialization = false;
 }
 
 PrimitiveObjectsWriter::~PrimitiveObjectsWriter(void)
@@ -36,22 +41,35 @@ PrimitiveObjectsWriter::~PrimitiveObjectsWriter(void)
 static const IOBasicTypes::Byte scSpace[] = {' '};
 void PrimitiveObjectsWriter::WriteTokenSeparator(ETokenSeparator inSeparate)
 {
-	if(eTokenSeparatorSpace == inSeparate)
+	if(eTokenSeparatorSpace == inSeparate || (mCompactSerialization && eTokenSeparatorEndLine == inSeparate))
 		mStreamForWriting->Write(scSpace,1);
 	else if(eTokenSeparatorEndLine == inSeparate)
 		EndLine();
 }
 
+void PrimitiveObjectsWriter::WriteSeparatorAfterDelimiter(ETokenSeparator inSeparate)
+{
+	// a token that ends with a delimiter is already separated from the next one
+	if(!mCompactSerialization)
+		WriteTokenSeparator(inSeparate);
+}
+
 static const IOBasicTypes::Byte scNewLine[2] = {'\r','\n'};
 void PrimitiveObjectsWriter::EndLine()
 {
-	mStreamForWriting->Write(scNewLine,2);
+	if(mCompactSerialization)
+		mStreamForWriting->Write(scNewLine + 1,1);
+	else
+		mStreamForWriting->Write(scNewLine,2);
 }
 
 void PrimitiveObjectsWriter::WriteKeyword(const std::string& inKeyword)
 {
 	mStreamForWriting->Write((const IOBasicTypes::Byte *)inKeyword.c_str(),inKeyword.size());
-	EndLine();
+	// compact serialization skips the line end only after a dictionary start. other keywords stay at line ends, as
+	// readers look for some (e.g. stream, endobj and startxref) at line starts
+	if(!mCompactSerialization || inKeyword.empty() || inKeyword[inKeyword.size() - 1] != '<')
+		EndLine();
 }
 
 static const IOBasicTypes::Byte scSlash[1] = {'/'};
@@ -87,12 +105,28 @@ it is recommended but not required for characters whose codes are outside the ra
 	WriteTokenSeparator(inSeparate);
 }
 
-void PrimitiveObjectsWriter::WriteInteger(long long inIntegerToken,ETokenSeparator inSeparate)
+// writes the decimal digits of inValue so that they end at inBufferEnd. returns where they start
+static char* FormatUnsignedBackwards(unsigned long long inValue,char* inBufferEnd)
 {
-	char buffer[512];
+	char* it = inBufferEnd;
+	do
+	{
+		*(--it) = (char)('0' + inValue % 10);
+		inValue /= 10;
+	} while(inValue != 0);
+	return it;
+}
 
-	SAFE_SPRINTF_1(buffer,512,"%lld",inIntegerToken);
-	mStreamForWriting->Write((const IOBasicTypes::Byte *)buffer,strlen(buffer));
+void PrimitiveObjectsWriter::WriteInteger(long long inIntegerToken,ETokenSeparator inSeparate)
+{
+	char buffer[24];
+	char* bufferEnd = buffer + 24;
+	unsigned long long magnitude = inIntegerToken < 0 ? (0ULL - (unsigned long long)inIntegerToken) : (unsigned long long)inIntegerToken;
+
+	char* start = FormatUnsignedBackwards(magnitude,bufferEnd);
+	if(inIntegerToken < 0)
+		*(--start) = '-';
+	mStreamForWriting->Write((const IOBasicTypes::Byte *)start,bufferEnd - start);
 	WriteTokenSeparator(inSeparate);
 }
 
@@ -104,7 +138,7 @@ void PrimitiveObjectsWriter::WriteUnsafeLiteralString(const std::string& inStrin
 	mStreamForWriting->Write(scLeftParanthesis,1);
 	mStreamForWriting->Write((const IOBasicTypes::Byte *)inString.c_str(),inString.size());
 	mStreamForWriting->Write(scRightParanthesis,1);
-	WriteTokenSeparator(inSeparate);
+	WriteSeparatorAfterDelimiter(inSeparate);
 }
 
 void PrimitiveObjectsWriter::WriteLiteralString(const std::string& inString,ETokenSeparator inSeparate)
@@ -135,25 +169,115 @@ void PrimitiveObjectsWriter::WriteLiteralString(const std::string& inString,ETok
 		
 	}
 	mStreamForWriting->Write(scRightParanthesis,1);
-	WriteTokenSeparator(inSeparate);
+	WriteSeparatorAfterDelimiter(inSeparate);
 }
 
 void PrimitiveObjectsWriter::WriteDouble(double inDoubleToken,ETokenSeparator inSeparate)
 {
 	char buffer[512];
 
-	SAFE_SPRINTF_1(buffer,512,"%f",inDoubleToken);
-
-	LongBufferSizeType sizeToWrite = DetermineDoubleTrimmedLength(buffer);
+	LongBufferSizeType sizeToWrite = FormatDouble(inDoubleToken,buffer);
 
 	mStreamForWriting->Write((const IOBasicTypes::Byte *)buffer,sizeToWrite);
 	WriteTokenSeparator(inSeparate);
 }
 
+static const double scPowersOfTen[MAX_DOUBLE_PRECISION + 1] = {1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,1e12,1e13,1e14,1e15};
+static const unsigned long long scIntegerPowersOfTen[MAX_DOUBLE_PRECISION + 1] = {	1ULL,10ULL,100ULL,1000ULL,10000ULL,100000ULL,1000000ULL,10000000ULL,100000000ULL,
+																					1000000000ULL,10000000000ULL,100000000000ULL,1000000000000ULL,
+																					10000000000000ULL,100000000000000ULL,1000000000000000ULL};
+// scaled values up to here are converted to integers directly
+#define MAX_FAST_SCALED_DOUBLE 4611686018427387904.0 // 2^62
+
+size_t PrimitiveObjectsWriter::FormatDouble(double inDoubleToken,char* outBuffer)
+{
+	// NaN and infinity have no representation in PDF
+	if(inDoubleToken != inDoubleToken || inDoubleToken > DBL_MAX || inDoubleToken < -DBL_MAX)
+	{
+		outBuffer[0] = '0';
+		return 1;
+	}
+
+	bool isNegative = inDoubleToken < 0;
+	double scaled = (isNegative ? -inDoubleToken : inDoubleToken) * scPowersOfTen[mDoublePrecision];
+
+	// fast path. round the scaled value to an integer, and write it with a decimal point inserted.
+	// the scaling multiplication is off by at most half a unit in the last place. when the scaled value is that close
+	// to a half, the exact value may round the other way, so leave it to the slow path, that rounds the exact value like "%f" does
+	if(scaled < MAX_FAST_SCALED_DOUBLE)
+	{
+		double integral = floor(scaled);
+		double fraction = scaled - integral;
+
+		if(fabs(fraction - 0.5) > scaled * DBL_EPSILON)
+		{
+			unsigned long long rounded = (unsigned long long)integral + (fraction > 0.5 ? 1 : 0);
+			if(0 == rounded)
+			{
+				outBuffer[0] = '0';
+				return 1;
+			}
+
+			char digits[48];
+			char* digitsEnd = digits + 48;
+			unsigned long long integerPart = rounded / scIntegerPowersOfTen[mDoublePrecision];
+			unsigned long long fractionPart = rounded % scIntegerPowersOfTen[mDoublePrecision];
+			char* it = digitsEnd;
+
+			if(fractionPart != 0)
+			{
+				// fraction digits without the trailing zeros, padded with leading zeros to the precision
+				unsigned int fractionDigits = mDoublePrecision;
+				while(fractionPart % 10 == 0)
+				{
+					fractionPart /= 10;
+					--fractionDigits;
+				}
+				char* fractionStart = FormatUnsignedBackwards(fractionPart,digitsEnd);
+				it = digitsEnd - fractionDigits;
+				while(fractionStart > it)
+					*(--fractionStart) = '0';
+				*(--it) = '.';
+			}
+			it = FormatUnsignedBackwards(integerPart,it);
+			if(isNegative)
+				*(--it) = '-';
+
+			size_t length = digitsEnd - it;
+			memcpy(outBuffer,it,length);
+			return length;
+		}
+	}
+
+	// slow path, for values too large for the fast path, and for near halves
+	SAFE_SPRINTF_2(outBuffer,512,"%.*f",(int)mDoublePrecision,inDoubleToken);
+
+	// the decimal separator is locale dependent, while PDF always uses a dot
+	for(char* it = outBuffer; *it != 0; ++it)
+	{
+		if(*it != '-' && (*it < '0' || *it > '9'))
+			*it = '.';
+	}
+
+	size_t length = DetermineDoubleTrimmedLength(outBuffer);
+
+	// negative values that round to zero
+	if(2 == length && '-' == outBuffer[0] && '0' == outBuffer[1])
+	{
+		outBuffer[0] = '0';
+		length = 1;
+	}
+	return length;
+}
+
 size_t PrimitiveObjectsWriter::DetermineDoubleTrimmedLength(const char* inBufferWithDouble)
 {
 	size_t result = strlen(inBufferWithDouble);
 
+	// no decimal point [zero precision], nothing to trim
+	if(strchr(inBufferWithDouble,'.') == NULL)
+		return result;
+
 	// remove all ending 0's
 	while(result > 0 && inBufferWithDouble[result-1] == '0')
 		--result;
@@ -189,17 +313,37 @@ void PrimitiveObjectsWriter::SetStreamForWriting(IByteWriter* inStreamForWriting
 	mStreamForWriting = inStreamForWriting;
 }
 
+void PrimitiveObjectsWriter::SetDoublePrecision(unsigned int inDoublePrecision)
+{
+	mDoublePrecision = inDoublePrecision > MAX_DOUBLE_PRECISION ? MAX_DOUBLE_PRECISION : inDoublePrecision;
+}
+
+unsigned int PrimitiveObjectsWriter::GetDoublePrecision()
+{
+	return mDoublePrecision;
+}
+
+void PrimitiveObjectsWriter::SetCompactSerialization(bool inCompactSerialization)
+{
+	mCompactSerialization = inCompactSerialization;
+}
+
+bool PrimitiveObjectsWriter::IsCompactSerialization()
+{
+	return mCompactSerialization;
+}
+
 static const IOBasicTypes::Byte scOpenBracketSpace[2] = {'[',' '};
 void PrimitiveObjectsWriter::StartArray()
 {
-	mStreamForWriting->Write(scOpenBracketSpace,2);
+	mStreamForWriting->Write(scOpenBracketSpace,mCompactSerialization ? 1 : 2);
 }
 
 static const IOBasicTypes::Byte scCloseBracket[1] = {']'};
 void PrimitiveObjectsWriter::EndArray(ETokenSeparator inSeparate)
 {
 	mStreamForWriting->Write(scCloseBracket,1);
-	WriteTokenSeparator(inSeparate);
+	WriteSeparatorAfterDelimiter(inSeparate);
 }
 
 static const IOBasicTypes::Byte scLeftAngle[1] = {'<'};
@@ -217,7 +361,7 @@ void PrimitiveObjectsWriter::WriteHexString(const std::string& inString,ETokenSe
 	}
 	
 	mStreamForWriting->Write(scRightAngle,1);
-	WriteTokenSeparator(inSeparate);
+	WriteSeparatorAfterDelimiter(inSeparate);
 }
 
 void PrimitiveObjectsWriter::WriteEncodedHexString(const std::string& inString, ETokenSeparator inSeparate)
@@ -232,7 +376,7 @@ void PrimitiveObjectsWriter::WriteEncodedHexString(const std::string& inString,
 	}
 
 	mStreamForWriting->Write(scRightAngle, 1);
-	WriteTokenSeparator(inSeparate);
+	WriteSeparatorAfterDelimiter(inSeparate);
 }
 
 IByteWriter* PrimitiveObjectsWriter::GetWritingStream()
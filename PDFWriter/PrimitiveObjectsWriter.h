@@ -28,6 +28,11 @@
 
 class IByteWriter;
 
+// default number of decimal places for doubles. matches the classic "%f" output, with trailing zeros removed
+#define DEFAULT_DOUBLE_PRECISION 6
+// beyond this, doubles don't have enough significant digits for the extra places to be meaningful
+#define MAX_DOUBLE_PRECISION 15
+
 class PrimitiveObjectsWriter
 {
 public:
@@ -56,8 +61,26 @@ public:
     
     IByteWriter* GetWritingStream();
 
+	// Sets the number of decimal places for doubles written with WriteDouble. trailing zeros are always removed.
+	// values higher than MAX_DOUBLE_PRECISION are treated as MAX_DOUBLE_PRECISION
+	void SetDoublePrecision(unsigned int inDoublePrecision);
+	unsigned int GetDoublePrecision();
+
+	// Compact serialization writes as few separators as possible. end line token separators become spaces, no separator is written
+	// after tokens that end with a delimiter (strings, arrays, dictionary start), and lines end with a line feed only.
+	// explicit EndLine calls still end the line, for where the syntax requires it (e.g. after the stream keyword)
+	void SetCompactSerialization(bool inCompactSerialization);
+	bool IsCompactSerialization();
+
+	// formats a double per the writer precision into outBuffer [which should be at least 512 bytes], returning the formatted length. 
+	// the output does not depend on the current locale
+	size_t FormatDouble(double inDoubleToken,char* outBuffer);
+
 private:
 	IByteWriter* mStreamForWriting;
+	unsigned int mDoublePrecision;
+	bool mCompactSerialization;
 
 	size_t DetermineDoubleTrimmedLength(const char* inBufferWithDouble);
+	void WriteSeparatorAfterDelimiter(ETokenSeparator inSeparate);
 };
@@ -0,0 +1,268 @@
+/*
+Source File : SHA2Generator.cpp
+
+
+Copyright 2016 Gal Kahana PDFWriter
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+*/
+#include "SHA2Generator.h"
+
+#include <string.h>
+
+using namespace IOBasicTypes;
+
+static const uint32_t scSHA256K[64] = {
+	0x428a2f98,0x71374491,0xb5c0fbcf,0xe9b5dba5,0x3956c25b,0x59f111f1,0x923f82a4,0xab1c5ed5,
+	0xd807aa98,0x12835b01,0x243185be,0x550c7dc3,0x72be5d74,0x80deb1fe,0x9bdc06a7,0xc19bf174,
+	0xe49b69c1,0xefbe4786,0x0fc19dc6,0x240ca1cc,0x2de92c6f,0x4a7484aa,0x5cb0a9dc,0x76f988da,
+	0x983e5152,0xa831c66d,0xb00327c8,0xbf597fc7,0xc6e00bf3,0xd5a79147,0x06ca6351,0x14292967,
+	0x27b70a85,0x2e1b2138,0x4d2c6dfc,0x53380d13,0x650a7354,0x766a0abb,0x81c2c92e,0x92722c85,
+	0xa2bfe8a1,0xa81a664b,0xc24b8b70,0xc76c51a3,0xd192e819,0xd6990624,0xf40e3585,0x106aa070,
+	0x19a4c116,0x1e376c08,0x2748774c,0x34b0bcb5,0x391c0cb3,0x4ed8aa4a,0x5b9cca4f,0x682e6ff3,
+	0x748f82ee,0x78a5636f,0x84c87814,0x8cc70208,0x90befffa,0xa4506ceb,0xbef9a3f7,0xc67178f2
+};
+
+static const uint64_t scSHA512K[80] = {
+	0x428a2f98d728ae22ULL,0x7137449123ef65cdULL,0xb5c0fbcfec4d3b2fULL,0xe9b5dba58189dbbcULL,0x3956c25bf348b538ULL,
+	0x59f111f1b605d019ULL,0x923f82a4af194f9bULL,0xab1c5ed5da6d8118ULL,0xd807aa98a3030242ULL,0x12835b0145706fbeULL,
+	0x243185be4ee4b28cULL,0x550c7dc3d5ffb4e2ULL,0x72be5d74f27b896fULL,0x80deb1fe3b1696b1ULL,0x9bdc06a725c71235ULL,
+	0xc19bf174cf692694ULL,0xe49b69c19ef14ad2ULL,0xefbe4786384f25e3ULL,0x0fc19dc68b8cd5b5ULL,0x240ca1cc77ac9c65ULL,
+	0x2de92c6f592b0275ULL,0x4a7484aa6ea6e483ULL,0x5cb0a9dcbd41fbd4ULL,0x76f988da831153b5ULL,0x983e5152ee66dfabULL,
+	0xa831c66d2db43210ULL,0xb00327c898fb213fULL,0xbf597fc7beef0ee4ULL,0xc6e00bf33da88fc2ULL,0xd5a79147930aa725ULL,
+	0x06ca6351e003826fULL,0x142929670a0e6e70ULL,0x27b70a8546d22ffcULL,0x2e1b21385c26c926ULL,0x4d2c6dfc5ac42aedULL,
+	0x53380d139d95b3dfULL,0x650a73548baf63deULL,0x766a0abb3c77b2a8ULL,0x81c2c92e47edaee6ULL,0x92722c851482353bULL,
+	0xa2bfe8a14cf10364ULL,0xa81a664bbc423001ULL,0xc24b8b70d0f89791ULL,0xc76c51a30654be30ULL,0xd192e819d6ef5218ULL,
+	0xd69906245565a910ULL,0xf40e35855771202aULL,0x106aa07032bbd1b8ULL,0x19a4c116b8d2d0c8ULL,0x1e376c085141ab53ULL,
+	0x2748774cdf8eeb99ULL,0x34b0bcb5e19b48a8ULL,0x391c0cb3c5c95a63ULL,0x4ed8aa4ae3418acbULL,0x5b9cca4f7763e373ULL,
+	0x682e6ff3d6b2b8a3ULL,0x748f82ee5defb2fcULL,0x78a5636f43172f60ULL,0x84c87814a1f0ab72ULL,0x8cc702081a6439ecULL,
+	0x90befffa23631e28ULL,0xa4506cebde82bde9ULL,0xbef9a3f7b2c67915ULL,0xc67178f2e372532bULL,0xca273eceea26619cULL,
+	0xd186b8c721c0c207ULL,0xeada7dd6cde0eb1eULL,0xf57d4f7fee6ed178ULL,0x06f067aa72176fbaULL,0x0a637dc5a2c898a6ULL,
+	0x113f9804bef90daeULL,0x1b710b35131c471bULL,0x28db77f523047d84ULL,0x32caab7b40c72493ULL,0x3c9ebe0a15c9bebcULL,
+	0x431d67c49c100d4cULL,0x4cc5d4becb3e42b6ULL,0x597f299cfc657e2aULL,0x5fcb6fab3ad6faecULL,0x6c44198c4a475817ULL
+};
+
+static const uint32_t scSHA256Initial[8] = {
+	0x6a09e667,0xbb67ae85,0x3c6ef372,0xa54ff53a,0x510e527f,0x9b05688c,0x1f83d9ab,0x5be0cd19
+};
+
+static const uint64_t scSHA384Initial[8] = {
+	0xcbbb9d5dc1059ed8ULL,0x629a292a367cd507ULL,0x9159015a3070dd17ULL,0x152fecd8f70e5939ULL,
+	0x67332667ffc00b31ULL,0x8eb44a8768581511ULL,0xdb0c2e0d64f98fa7ULL,0x47b5481dbefa4fa4ULL
+};
+
+static const uint64_t scSHA512Initial[8] = {
+	0x6a09e667f3bcc908ULL,0xbb67ae8584caa73bULL,0x3c6ef372fe94f82bULL,0xa54ff53a5f1d36f1ULL,
+	0x510e527fade682d1ULL,0x9b05688c2b3e6c1fULL,0x1f83d9abfb41bd6bULL,0x5be0cd19137e2179ULL
+};
+
+#define ROTR32(x,n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define ROTR64(x,n) (((x) >> (n)) | ((x) << (64 - (n))))
+
+SHA2Generator::SHA2Generator(unsigned int inDigestBits)
+{
+	mDigestBits = (384 == inDigestBits || 512 == inDigestBits) ? inDigestBits : 256;
+	mIsFinalized = false;
+	mTotalLength = 0;
+	mBufferSize = 0;
+
+	if(256 == mDigestBits)
+		memcpy(mState32,scSHA256Initial,sizeof(mState32));
+	else
+		memcpy(mState64,384 == mDigestBits ? scSHA384Initial : scSHA512Initial,sizeof(mState64));
+}
+
+SHA2Generator::~SHA2Generator(void)
+{
+}
+
+LongBufferSizeType SHA2Generator::GetBlockSize()
+{
+	return 256 == mDigestBits ? 64 : 128;
+}
+
+PDFHummus::EStatusCode SHA2Generator::Accumulate(const std::string& inString)
+{
+	return Accumulate((const Byte*)inString.c_str(),inString.size());
+}
+
+PDFHummus::EStatusCode SHA2Generator::Accumulate(const ByteList& inString)
+{
+	Byte buffer[128];
+	LongBufferSizeType bufferSize = 0;
+	ByteList::const_iterator it = inString.begin();
+
+	for(; it != inString.end(); ++it)
+	{
+		buffer[bufferSize++] = *it;
+		if(sizeof(buffer) == bufferSize)
+		{
+			Accumulate(buffer,bufferSize);
+			bufferSize = 0;
+		}
+	}
+	return Accumulate(buffer,bufferSize);
+}
+
+PDFHummus::EStatusCode SHA2Generator::Accumulate(const Byte* inArray, LongBufferSizeType inLength)
+{
+	if(mIsFinalized)
+		return PDFHummus::eFailure;
+
+	LongBufferSizeType blockSize = GetBlockSize();
+	mTotalLength += inLength;
+
+	// complete a pending block first
+	if(mBufferSize > 0)
+	{
+		LongBufferSizeType toCopy = blockSize - mBufferSize < inLength ? blockSize - mBufferSize : inLength;
+		memcpy(mBuffer + mBufferSize,inArray,toCopy);
+		mBufferSize += toCopy;
+		inArray += toCopy;
+		inLength -= toCopy;
+		if(mBufferSize < blockSize)
+			return PDFHummus::eSuccess;
+		Transform(mBuffer);
+		mBufferSize = 0;
+	}
+
+	// then whole blocks straight from the input, and keep the remainder
+	for(; inLength >= blockSize; inArray += blockSize, inLength -= blockSize)
+		Transform(inArray);
+
+	memcpy(mBuffer,inArray,inLength);
+	mBufferSize = inLength;
+	return PDFHummus::eSuccess;
+}
+
+void SHA2Generator::Transform(const Byte* inBlock)
+{
+	if(256 == mDigestBits)
+		Transform256(inBlock);
+	else
+		Transform512(inBlock);
+}
+
+void SHA2Generator::Transform256(const Byte* inBlock)
+{
+	uint32_t w[64];
+	uint32_t a,b,c,d,e,f,g,h;
+	int i;
+
+	for(i = 0; i < 16; ++i)
+		w[i] = ((uint32_t)inBlock[i*4] << 24) | ((uint32_t)inBlock[i*4 + 1] << 16) | ((uint32_t)inBlock[i*4 + 2] << 8) | inBlock[i*4 + 3];
+	for(; i < 64; ++i)
+	{
+		uint32_t s0 = ROTR32(w[i-15],7) ^ ROTR32(w[i-15],18) ^ (w[i-15] >> 3);
+		uint32_t s1 = ROTR32(w[i-2],17) ^ ROTR32(w[i-2],19) ^ (w[i-2] >> 10);
+		w[i] = w[i-16] + s0 + w[i-7] + s1;
+	}
+
+	a = mState32[0]; b = mState32[1]; c = mState32[2]; d = mState32[3];
+	e = mState32[4]; f = mState32[5]; g = mState32[6]; h = mState32[7];
+
+	for(i = 0; i < 64; ++i)
+	{
+		uint32_t t1 = h + (ROTR32(e,6) ^ ROTR32(e,11) ^ ROTR32(e,25)) + ((e & f) ^ (~e & g)) + scSHA256K[i] + w[i];
+		uint32_t t2 = (ROTR32(a,2) ^ ROTR32(a,13) ^ ROTR32(a,22)) + ((a & b) ^ (a & c) ^ (b & c));
+		h = g; g = f; f = e; e = d + t1;
+		d = c; c = b; b = a; a = t1 + t2;
+	}
+
+	mState32[0] += a; mState32[1] += b; mState32[2] += c; mState32[3] += d;
+	mState32[4] += e; mState32[5] += f; mState32[6] += g; mState32[7] += h;
+}
+
+void SHA2Generator::Transform512(const Byte* inBlock)
+{
+	uint64_t w[80];
+	uint64_t a,b,c,d,e,f,g,h;
+	int i;
+
+	for(i = 0; i < 16; ++i)
+	{
+		w[i] = 0;
+		for(int j = 0; j < 8; ++j)
+			w[i] = (w[i] << 8) | inBlock[i*8 + j];
+	}
+	for(; i < 80; ++i)
+	{
+		uint64_t s0 = ROTR64(w[i-15],1) ^ ROTR64(w[i-15],8) ^ (w[i-15] >> 7);
+		uint64_t s1 = ROTR64(w[i-2],19) ^ ROTR64(w[i-2],61) ^ (w[i-2] >> 6);
+		w[i] = w[i-16] + s0 + w[i-7] + s1;
+	}
+
+	a = mState64[0]; b = mState64[1]; c = mState64[2]; d = mState64[3];
+	e = mState64[4]; f = mState64[5]; g = mState64[6]; h = mState64[7];
+
+	for(i = 0; i < 80; ++i)
+	{
+		uint64_t t1 = h + (ROTR64(e,14) ^ ROTR64(e,18) ^ ROTR64(e,41)) + ((e & f) ^ (~e & g)) + scSHA512K[i] + w[i];
+		uint64_t t2 = (ROTR64(a,28) ^ ROTR64(a,34) ^ ROTR64(a,39)) + ((a & b) ^ (a & c) ^ (b & c));
+		h = g; g = f; f = e; e = d + t1;
+		d = c; c = b; b = a; a = t1 + t2;
+	}
+
+	mState64[0] += a; mState64[1] += b; mState64[2] += c; mState64[3] += d;
+	mState64[4] += e; mState64[5] += f; mState64[6] += g; mState64[7] += h;
+}
+
+void SHA2Generator::Finalize()
+{
+	if(mIsFinalized)
+		return;
+
+	LongBufferSizeType blockSize = GetBlockSize();
+	LongBufferSizeType lengthSize = 256 == mDigestBits ? 8 : 16;
+	uint64_t totalBits = mTotalLength * 8;
+
+	// pad with 0x80 and zeros, leaving room for the big endian bit length at the end of the last block
+	mBuffer[mBufferSize++] = 0x80;
+	if(mBufferSize > blockSize - lengthSize)
+	{
+		memset(mBuffer + mBufferSize,0,blockSize - mBufferSize);
+		Transform(mBuffer);
+		mBufferSize = 0;
+	}
+	memset(mBuffer + mBufferSize,0,blockSize - mBufferSize);
+	for(int i = 0; i < 8; ++i)
+		mBuffer[blockSize - 1 - i] = (Byte)((totalBits >> (i*8)) & 0xff);
+	Transform(mBuffer);
+
+	// digest, big endian
+	LongBufferSizeType digestSize = mDigestBits / 8;
+	for(LongBufferSizeType i = 0; i < digestSize; ++i)
+	{
+		Byte value = (256 == mDigestBits) ?
+						(Byte)((mState32[i/4] >> (24 - (i%4)*8)) & 0xff) :
+						(Byte)((mState64[i/8] >> (56 - (i%8)*8)) & 0xff);
+		mFinalString.push_back(value);
+		mFinalStringAsString.push_back((char)value);
+	}
+
+	mIsFinalized = true;
+}
+
+const ByteList& SHA2Generator::ToString()
+{
+	Finalize();
+	return mFinalString;
+}
+
+const std::string& SHA2Generator::ToStringAsString()
+{
+	Finalize();
+	return mFinalStringAsString;
+}
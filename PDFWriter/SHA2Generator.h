@@ -0,0 +1,71 @@
+/*
+Source File : SHA2Generator.h
+
+
+Copyright 2016 Gal Kahana PDFWriter
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+*/
+#pragma once
+
+#include "EStatusCode.h"
+#include "IOBasicTypes.h"
+
+#include <list>
+#include <string>
+#include <stdint.h>
+
+typedef std::list<IOBasicTypes::Byte> ByteList;
+
+/*
+	SHA-256, SHA-384 and SHA-512 hashing, per FIPS 180-4. Used for AES-256 (V 5) password verification.
+	Same usage as MD5Generator - accumulate, and then retrieve the digest. Digest retrieval finalizes the computation.
+*/
+class SHA2Generator
+{
+public:
+	// inDigestBits is 256, 384 or 512. other values are treated as 256
+	SHA2Generator(unsigned int inDigestBits = 256);
+	~SHA2Generator(void);
+
+	PDFHummus::EStatusCode Accumulate(const std::string& inString);
+	PDFHummus::EStatusCode Accumulate(const ByteList& inString);
+	PDFHummus::EStatusCode Accumulate(const IOBasicTypes::Byte* inArray, IOBasicTypes::LongBufferSizeType inLength);
+
+	const ByteList& ToString();
+	const std::string& ToStringAsString();
+
+private:
+	unsigned int mDigestBits;
+	bool mIsFinalized;
+	uint64_t mTotalLength; // in bytes
+
+	// SHA-256 state and block
+	uint32_t mState32[8];
+	// SHA-384/512 state and block
+	uint64_t mState64[8];
+
+	IOBasicTypes::Byte mBuffer[128];
+	IOBasicTypes::LongBufferSizeType mBufferSize;
+
+	ByteList mFinalString;
+	std::string mFinalStringAsString;
+
+	IOBasicTypes::LongBufferSizeType GetBlockSize();
+	void Transform(const IOBasicTypes::Byte* inBlock);
+	void Transform256(const IOBasicTypes::Byte* inBlock);
+	void Transform512(const IOBasicTypes::Byte* inBlock);
+	void Finalize();
+};
@@ -0,0 +1,153 @@
+/*
+   Source File : SharedFontsCache.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "SharedFontsCache.h"
+#include "Trace.h"
+
+using namespace IOBasicTypes;
+using namespace PDFHummus;
+
+SharedFontFile::SharedFontFile(void)
+{
+	mUsersCount = 0;
+}
+
+SharedFontFile::~SharedFontFile(void)
+{
+	mFile.Close();
+}
+
+const Byte* SharedFontFile::GetData()
+{
+	return mFile.GetData();
+}
+
+LongBufferSizeType SharedFontFile::GetSize()
+{
+	return (LongBufferSizeType)mFile.GetFileSize();
+}
+
+SharedFontsCache::SharedFontsCache(void)
+{
+}
+
+SharedFontsCache::~SharedFontsCache(void)
+{
+	StringToSharedFontFileMap::iterator it = mFontFiles.begin();
+	for(; it != mFontFiles.end(); ++it)
+		delete it->second;
+	mFontFiles.clear();
+}
+
+SharedFontFile* SharedFontsCache::AcquireFontFile(const std::string& inFontFilePath)
+{
+	SharedFontFile* result = NULL;
+
+	mLock.Lock();
+	StringToSharedFontFileMap::iterator it = mFontFiles.find(inFontFilePath);
+	if(it != mFontFiles.end())
+	{
+		result = it->second;
+		++mStatistics.Hits;
+	}
+	else
+	{
+		// mapping under the lock, so that concurrent requests for the same file map it just once
+		result = new SharedFontFile();
+		if(result->mFile.Open(inFontFilePath) != eSuccess || !result->GetData())
+		{
+			TRACE_LOG1("SharedFontsCache::AcquireFontFile, unable to map font file %s",inFontFilePath.c_str());
+			delete result;
+			result = NULL;
+		}
+		else
+		{
+			mFontFiles.insert(StringToSharedFontFileMap::value_type(inFontFilePath,result));
+			++mStatistics.Misses;
+		}
+	}
+	if(result)
+		++(result->mUsersCount);
+	mLock.Unlock();
+
+	return result;
+}
+
+void SharedFontsCache::ReleaseFontFile(SharedFontFile* inFontFile)
+{
+	mLock.Lock();
+	if(inFontFile->mUsersCount > 0)
+		--(inFontFile->mUsersCount);
+	mLock.Unlock();
+}
+
+const FTPosVector* SharedFontsCache::GetGlyphsWidths(SharedFontFile* inFontFile,long inFontIndex)
+{
+	const FTPosVector* result = NULL;
+
+	mLock.Lock();
+	LongToFTPosVectorMap::iterator it = inFontFile->mGlyphsWidths.find(inFontIndex);
+	if(it != inFontFile->mGlyphsWidths.end())
+		result = &(it->second);
+	mLock.Unlock();
+
+	return result;
+}
+
+const FTPosVector* SharedFontsCache::ShareGlyphsWidths(SharedFontFile* inFontFile,long inFontIndex,const FTPosVector& inGlyphsWidths)
+{
+	const FTPosVector* result;
+
+	mLock.Lock();
+	// map insert keeps an existing table, and map nodes don't move, so returned tables stay valid for as long as the file is cached
+	result = &(inFontFile->mGlyphsWidths.insert(LongToFTPosVectorMap::value_type(inFontIndex,inGlyphsWidths)).first->second);
+	mLock.Unlock();
+
+	return result;
+}
+
+void SharedFontsCache::Purge()
+{
+	mLock.Lock();
+	StringToSharedFontFileMap::iterator it = mFontFiles.begin();
+	while(it != mFontFiles.end())
+	{
+		if(0 == it->second->mUsersCount)
+		{
+			delete it->second;
+			mFontFiles.erase(it++);
+		}
+		else
+			++it;
+	}
+	mLock.Unlock();
+}
+
+SharedFontsCacheStatistics SharedFontsCache::GetStatistics()
+{
+	SharedFontsCacheStatistics result;
+
+	mLock.Lock();
+	result = mStatistics;
+	result.CachedFontFiles = (unsigned long)mFontFiles.size();
+	mLock.Unlock();
+
+	return result;
+}
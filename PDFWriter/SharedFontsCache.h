@@ -0,0 +1,105 @@
+/*
+   Source File : SharedFontsCache.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "IOBasicTypes.h"
+#include "InputMemoryMappedFileStream.h"
+#include "FreeTypeFaceWrapper.h"
+
+#include <string>
+#include <map>
+
+#include "ThreadsLock.h"
+
+/*
+	Cache of font data, to share between PDFWriter instances that use the same fonts, possibly from different threads.
+	Create one for the process (or for a group of writers), and set it to each writer with PDFWriter::SetSharedFontsCache, before
+	getting fonts. The cache is not owned by the writers, and should be destroyed only after all writers using it are done.
+
+	What's shared is what does not change per document:
+	- font files are mapped to memory once, and documents open their font faces from the mapped memory instead of reading the file
+	- glyph widths tables, which are computed once per face and then used by all documents
+
+	Anything that is written to the document (the used glyphs, encodings and font objects) stays with the document.
+	Font files stay mapped after the documents using them are done, so the next documents find them ready. use Purge to let go of
+	font files that are not currently in use.
+*/
+
+typedef std::map<long,FTPosVector> LongToFTPosVectorMap;
+
+class SharedFontFile
+{
+	friend class SharedFontsCache;
+public:
+	const IOBasicTypes::Byte* GetData();
+	IOBasicTypes::LongBufferSizeType GetSize();
+
+private:
+	SharedFontFile(void);
+	~SharedFontFile(void);
+
+	InputMemoryMappedFileStream mFile;
+	// documents currently using the file
+	unsigned long mUsersCount;
+	// widths tables of faces in the file, by face index
+	LongToFTPosVectorMap mGlyphsWidths;
+};
+
+struct SharedFontsCacheStatistics
+{
+	// font files currently mapped by the cache
+	unsigned long CachedFontFiles;
+	// font requests served by an already mapped file
+	unsigned long Hits;
+	// font requests that mapped the file
+	unsigned long Misses;
+
+	SharedFontsCacheStatistics(){CachedFontFiles = 0;Hits = 0;Misses = 0;}
+};
+
+typedef std::map<std::string,SharedFontFile*> StringToSharedFontFileMap;
+
+class SharedFontsCache
+{
+public:
+	SharedFontsCache(void);
+	~SharedFontsCache(void);
+
+	// get a font file, mapping it on first use. returns NULL if the file cannot be mapped. 
+	// match each successful call with ReleaseFontFile, when done with the file data
+	SharedFontFile* AcquireFontFile(const std::string& inFontFilePath);
+	void ReleaseFontFile(SharedFontFile* inFontFile);
+
+	// widths table of a face in a font file, if it was already shared. NULL if not
+	const FTPosVector* GetGlyphsWidths(SharedFontFile* inFontFile,long inFontIndex);
+	// share a complete widths table for a face. if one was already shared, it is kept instead. returns the shared table, which does not change from now on
+	const FTPosVector* ShareGlyphsWidths(SharedFontFile* inFontFile,long inFontIndex,const FTPosVector& inGlyphsWidths);
+
+	// unmap font files that are not in use
+	void Purge();
+
+	SharedFontsCacheStatistics GetStatistics();
+
+private:
+	StringToSharedFontFileMap mFontFiles;
+	SharedFontsCacheStatistics mStatistics;
+	ThreadsLock mLock;
+};
@@ -42,7 +42,7 @@ EStatusCode StateReader::Start(const std::string& inStateFilePath)
 		return PDFHummus::eFailure;
 	}
 	
-	if(mParser.StartStateFileParsing(mInputFile.GetInputStream()) != PDFHummus::eSuccess)
+	if(mParser.StartStateFileParsing(mInputFile.GetInputStream(),mInputFile.GetInputStreamWindow()) != PDFHummus::eSuccess)
 	{
 		TRACE_LOG("StateReader::Start, unable to start parsing for the state reader file");
 		return PDFHummus::eFailure;
@@ -94,6 +94,7 @@
 
 #include <stdlib.h> 
 #include <search.h>
+#include <algorithm>
 
 using namespace PDFHummus;
 
@@ -357,24 +358,30 @@ static const std::string scErrorString(": Error, ");
 
 void ReportWarning(const char* inModel, const char* inFormat, va_list inParametersList)
 {
+	if(!Trace::Current().IsLogging(eTraceSeverityWarning))
+		return;
+
 	char buffer[5001];
 	std::stringstream formatter;
 	formatter<<inModel<<scWarningString<<inFormat<<scDot;
 
 	SAFE_VSPRINTF(buffer,5001,formatter.str().c_str(),inParametersList);
 
-    Trace::DefaultTrace.TraceToLog(buffer);
+    TRACE_LOG_SEVERITY1(eTraceSeverityWarning,"%s",buffer);
 }
 
 void ReportError(const char* inModel, const char* inFormat, va_list inParametersList)
 {
+	if(!Trace::Current().IsLogging(eTraceSeverityError))
+		return;
+
 	char buffer[5001];
 	std::stringstream formatter;
 	formatter<<inModel<<scErrorString<<inFormat<<scDot;
 
 	SAFE_VSPRINTF(buffer,5001,formatter.str().c_str(),inParametersList);
 
-	Trace::DefaultTrace.TraceToLog(buffer);
+	TRACE_LOG1("%s",buffer);
 }
 
 TIFFImageHandler::TIFFImageHandler():mUserParameters(TIFFUsageParameters::DefaultTIFFUsageParameters)
@@ -436,6 +443,12 @@ void TIFFImageHandler::InitializeConversionState(){
 	mT2p->pdf_defaultyres=300.0;
 	// if does not have a compression that is either zip or ccit, this should cause it to compress in zip...like all other normal compression
 	mT2p->pdf_defaultcompression = T2P_COMPRESS_ZIP;
+	// zip compression level, from the image category of the compression policy (quality hundreds hold the level. strategy and memory level are not supported by libtiff)
+	int compressionLevel = mObjectsContext ? mObjectsContext->GetCompressionPolicy().GetParameters(eStreamCategoryImage).Level : -1;
+	if(0 == compressionLevel)
+		mT2p->pdf_defaultcompression = T2P_COMPRESS_NONE; // level 0 stores, as with other streams. images passed through in their original compression are not affected
+	else if(compressionLevel >= 1 && compressionLevel <= 9)
+		mT2p->pdf_defaultcompressionquality = (uint16)(compressionLevel * 100);
 }
 
 void TIFFImageHandler::DestroyConversionState()
@@ -1689,7 +1702,7 @@ ObjectIDType TIFFImageHandler::WriteTransferFunction(int i)
 	transferFunctionDictionary->WriteIntegerValue(1<<(mT2p->tiff_bitspersample+1));
 
 	// the stream
-	PDFStream* transferFunctionStream =  mObjectsContext->StartPDFStream(transferFunctionDictionary);
+	PDFStream* transferFunctionStream =  mObjectsContext->StartPDFStream(transferFunctionDictionary,false,eStreamCategoryImage);
 	transferFunctionStream->GetWriteStream()->Write(
 				(const IOBasicTypes::Byte*)mT2p->tiff_transferfunction[i],
 				(1<<(mT2p->tiff_bitspersample+1)));
@@ -1736,7 +1749,7 @@ ObjectIDType TIFFImageHandler::WriteTransferFunctionsExtGState(const ObjectIDTyp
 ObjectIDType TIFFImageHandler::WritePaletteCS()
 {
 	ObjectIDType palleteID = mObjectsContext->StartNewIndirectObject();
-	PDFStream* paletteStream =  mObjectsContext->StartPDFStream();
+	PDFStream* paletteStream =  mObjectsContext->StartPDFStream(NULL,false,eStreamCategoryImage);
 	paletteStream->GetWriteStream()->Write(
 			(const IOBasicTypes::Byte*)mT2p->pdf_palette,mT2p->pdf_palettesize);
 	mObjectsContext->EndPDFStream(paletteStream);
@@ -1765,7 +1778,7 @@ ObjectIDType TIFFImageHandler::WriteICCCS()
 	mT2p->pdf_colorspace = (t2p_cs_t)(mT2p->pdf_colorspace | T2P_CS_ICCBASED);
 
 	// the stream
-	PDFStream* ICCStream =  mObjectsContext->StartPDFStream(ICCDictionary);
+	PDFStream* ICCStream =  mObjectsContext->StartPDFStream(ICCDictionary,false,eStreamCategoryImage);
 	ICCStream->GetWriteStream()->Write(
 				(const IOBasicTypes::Byte*)mT2p->tiff_iccprofile,
 				mT2p->tiff_iccprofilelength);
@@ -2090,6 +2103,7 @@ PDFImageXObject* TIFFImageHandler::WriteTileImageXObject(int inTileIndex)
 		// container will be set externally.
 		imageXObject = new PDFImageXObject(imageXObjectID);
 		AddImagesProcsets(imageXObject);
+		++mObjectsContext->GetMetrics().GetCounters().ImagesWritten;
 	} while(false);
 
 
@@ -2618,7 +2632,7 @@ tsize_t TIFFImageHandler::SampleRGBAAToRGB(tdata_t inData, uint32 inSampleCount)
 	uint32 i;
 	
 	for(i = 0; i < inSampleCount; i++)
-		memcpy((uint8*)inData + i * 3, (uint8*)inData + i * 4, 3);
+		memmove((uint8*)inData + i * 3, (uint8*)inData + i * 4, 3);
 
 	return(i * 3);	
 }
@@ -2713,6 +2727,7 @@ PDFImageXObject* TIFFImageHandler::WriteUntiledImageXObject()
 		// container will be set externally.
 		imageXObject = new PDFImageXObject(imageXObjectID);
 		AddImagesProcsets(imageXObject);
+		++mObjectsContext->GetMetrics().GetCounters().ImagesWritten;
 	} while(false);
 
 
@@ -2793,15 +2808,23 @@ EStatusCode TIFFImageHandler::WriteImageData(PDFStream* inImageStream)
 {
 	unsigned char* buffer=NULL;
 	unsigned char* samplebuffer=NULL;
-	tsize_t bufferoffset=0;
 	tsize_t samplebufferoffset=0;
 	tsize_t read=0;
 	tstrip_t i=0;
 	tstrip_t j=0;
 	tstrip_t stripcount=0;
 	tsize_t stripsize=0;
-	tsize_t sepstripcount=0;
-	tsize_t sepstripsize=0;
+	tsize_t buffersize=0;
+	tsize_t rowsize=0;
+	uint32 rowsperstrip=0;
+	uint32 striprows=0;
+	uint32 row=0;
+	uint32 k=0;
+	bool separate=false;
+	bool encodingStarted=false;
+	bool rgbaImageStarted=false;
+	TIFFRGBAImage rgbaImage;
+	char rgbaError[1024];
 
 	EStatusCode status = PDFHummus::eSuccess;
 
@@ -2827,145 +2850,139 @@ EStatusCode TIFFImageHandler::WriteImageData(PDFStream* inImageStream)
 					TIFFReverseBits(buffer,mT2p->tiff_datasize);
 				inImageStream->GetWriteStream()->Write(
 										(const IOBasicTypes::Byte*)buffer,mT2p->tiff_datasize);
-				_TIFFfree(buffer);
 				break; // stop here if can write directly with no recompression
 			}
 		}
 
-		if(mT2p->pdf_sample==T2P_SAMPLE_NOTHING)
+		// decode, convert and encode one strip at a time, so that memory use is bound by the strip size
+		// and not by the image size. buffer holds a single converted strip, and samplebuffer the separate
+		// planes of a strip, prior to making them contiguous.
+		separate = (mT2p->pdf_sample & T2P_SAMPLE_PLANAR_SEPARATE_TO_CONTIG) != 0;
+
+		TIFFGetFieldDefaulted(mT2p->input, TIFFTAG_ROWSPERSTRIP, &rowsperstrip);
+		if(rowsperstrip == 0 || rowsperstrip > mT2p->tiff_length)
+			rowsperstrip = mT2p->tiff_length;
+		stripsize=TIFFStripSize(mT2p->input);
+		stripcount=TIFFNumberOfStrips(mT2p->input);
+		if(separate)
+			stripcount/=mT2p->tiff_samplesperpixel;
+
+		// YCbCr gets converted to RGB, so encode as RGB. this also keeps libtiff from computing subsampled row sizes for the output
+		status = StartImageStreamEncoding(inImageStream,
+										  mT2p->tiff_width,
+										  mT2p->tiff_length,
+										  GetEncodedSamplesPerPixel(),
+										  (!separate && (mT2p->pdf_sample & T2P_SAMPLE_YCBCR_TO_RGB)) ? PHOTOMETRIC_RGB : mT2p->tiff_photometric);
+		if(status != PDFHummus::eSuccess)
+			break;
+		encodingStarted = true;
+		rowsize = TIFFScanlineSize(mT2p->output);
+
+		// converted strips are at most the size of the read strips, except for palette realization, and the RGBA raster used for YCbCr
+		buffersize = stripsize;
+		if(separate || (mT2p->pdf_sample & T2P_SAMPLE_REALIZE_PALETTE))
+			buffersize = stripsize * mT2p->tiff_samplesperpixel;
+		if(!separate && (mT2p->pdf_sample & T2P_SAMPLE_YCBCR_TO_RGB))
+			buffersize = (tsize_t)mT2p->tiff_width * rowsperstrip * 4;
+		if(buffersize < rowsize * (tsize_t)rowsperstrip)
+			buffersize = rowsize * (tsize_t)rowsperstrip;
+
+		buffer = (unsigned char*) _TIFFmalloc(buffersize);
+		if(buffer==NULL)
+		{
+			TRACE_LOG2( 
+				"Can't allocate %u bytes of memory for t2p_readwrite_pdf_image, %s", 
+				buffersize, 
+				mT2p->inputFilePath.c_str());
+			status = PDFHummus::eFailure;
+			break;
+		}
+
+		if(separate)
 		{
-			buffer = (unsigned char*) _TIFFmalloc(mT2p->tiff_datasize);
-			if(buffer==NULL)
+			samplebuffer = (unsigned char*) _TIFFmalloc(stripsize * mT2p->tiff_samplesperpixel);
+			if(samplebuffer==NULL)
 			{
 				TRACE_LOG2( 
 					"Can't allocate %u bytes of memory for t2p_readwrite_pdf_image, %s", 
-					mT2p->tiff_datasize, 
+					stripsize * mT2p->tiff_samplesperpixel, 
 					mT2p->inputFilePath.c_str());
 				status = PDFHummus::eFailure;
 				break;
 			}
-			memset(buffer, 0, mT2p->tiff_datasize);
-			stripsize=TIFFStripSize(mT2p->input);
-			stripcount=TIFFNumberOfStrips(mT2p->input);
-			for(i=0;i<stripcount;i++)
+		}
+		else if(mT2p->pdf_sample & T2P_SAMPLE_YCBCR_TO_RGB)
+		{
+			if(!TIFFRGBAImageOK(mT2p->input, rgbaError) || 
+				!TIFFRGBAImageBegin(&rgbaImage, mT2p->input, 0, rgbaError))
 			{
-				read = 
-					TIFFReadEncodedStrip(mT2p->input, 
-					i, 
-					(tdata_t) &buffer[bufferoffset], 
-					stripsize);
-				if(read==-1)
-				{
-					TRACE_LOG2( 
-						"Error on decoding strip %u of %s", 
-						i, 
-						mT2p->inputFilePath.c_str());
-					_TIFFfree(buffer);
-					status = PDFHummus::eFailure;
-					break;
-				}
-				bufferoffset+=read;
-			}
-			if(status != PDFHummus::eSuccess)
+				TRACE_LOG2( 
+					"Can't use TIFFRGBAImage to extract RGB image from %s, %s", 
+					mT2p->inputFilePath.c_str(),
+					rgbaError);
+				status = PDFHummus::eFailure;
 				break;
-		} 
-		else 
+			}
+			rgbaImageStarted = true;
+			rgbaImage.req_orientation = ORIENTATION_TOPLEFT;
+		}
+
+		for(i=0;i<stripcount && row < mT2p->tiff_length;i++)
 		{
-			if(mT2p->pdf_sample & T2P_SAMPLE_PLANAR_SEPARATE_TO_CONTIG)
+			striprows = std::min<uint32>(rowsperstrip, mT2p->tiff_length - row);
+			memset(buffer, 0, buffersize);
+
+			if(separate)
 			{
-			
-				sepstripsize=TIFFStripSize(mT2p->input);
-				sepstripcount=TIFFNumberOfStrips(mT2p->input);
-			
-				stripsize=sepstripsize*mT2p->tiff_samplesperpixel;
-				stripcount=sepstripcount/mT2p->tiff_samplesperpixel;
-				
-				buffer = (unsigned char*) _TIFFmalloc(mT2p->tiff_datasize);
-				if(buffer==NULL)
+				samplebufferoffset=0;
+				for(j=0;j<mT2p->tiff_samplesperpixel;j++)
 				{
-					TRACE_LOG2( 
-						"Can't allocate %u bytes of memory for t2p_readwrite_pdf_image, %s", 
-						mT2p->tiff_datasize, 
-						mT2p->inputFilePath.c_str());
-					status = PDFHummus::eFailure;
-					break;
+					read = 
+						TIFFReadEncodedStrip(mT2p->input, 
+							i + j*stripcount, 
+							(tdata_t) &(samplebuffer[samplebufferoffset]), 
+							stripsize);
+					if(read==-1)
+					{
+						TRACE_LOG2( 
+							"Error on decoding strip %u of %s", 
+							i + j*stripcount, 
+							mT2p->inputFilePath.c_str());
+						status = PDFHummus::eFailure;
+						break;
+					}
+					samplebufferoffset+=read;
 				}
-				memset(buffer, 0, mT2p->tiff_datasize);
-				samplebuffer = (unsigned char*) _TIFFmalloc(stripsize);
-				if(samplebuffer==NULL)
+				if(status != PDFHummus::eSuccess)
+					break;
+				SamplePlanarSeparateToContig(
+					buffer,
+					samplebuffer, 
+					samplebufferoffset); 
+			}
+			else if(rgbaImageStarted)
+			{
+				rgbaImage.row_offset = row;
+				rgbaImage.col_offset = 0;
+				if(!TIFFRGBAImageGet(&rgbaImage, (uint32*)buffer, mT2p->tiff_width, striprows))
 				{
 					TRACE_LOG2( 
-						"Can't allocate %u bytes of memory for t2p_readwrite_pdf_image, %s", 
-						mT2p->tiff_datasize, 
+						"Can't use TIFFRGBAImageGet to extract RGB rows of strip %u of %s", 
+						i,
 						mT2p->inputFilePath.c_str());
 					status = PDFHummus::eFailure;
 					break;
 				}
-				for(i=0;i<stripcount;i++)
-				{
-					samplebufferoffset=0;
-					for(j=0;j<mT2p->tiff_samplesperpixel;j++)
-					{
-						read = 
-							TIFFReadEncodedStrip(mT2p->input, 
-								i + j*stripcount, 
-								(tdata_t) &(samplebuffer[samplebufferoffset]), 
-								sepstripsize);
-						if(read==-1)
-						{
-							TRACE_LOG2( 
-								"Error on decoding strip %u of %s", 
-								i + j*stripcount, 
-								mT2p->inputFilePath.c_str());
-								_TIFFfree(buffer);
-							status = PDFHummus::eFailure;
-							break;
-						}
-						samplebufferoffset+=read;
-					}
-					if(status != PDFHummus::eSuccess)
-						break;
-					SamplePlanarSeparateToContig(
-						&(buffer[bufferoffset]),
-						samplebuffer, 
-						samplebufferoffset); 
-					bufferoffset+=samplebufferoffset;
-				}
-				_TIFFfree(samplebuffer);
-				if(status!= PDFHummus::eSuccess)
-					break;
-				status = WriteImageBufferToStream(inImageStream,
-										 mT2p->tiff_width,
-										 mT2p->tiff_length,
-										 buffer,
-										 GetSizeFromTIFFDataSize);
-				if (buffer != NULL) 
-				{
-					_TIFFfree(buffer);
-					buffer=NULL;
-				}
-				break; // finish here, hopefully successfully
-			}
-
-			buffer = (unsigned char*) _TIFFmalloc(mT2p->tiff_datasize);
-			if(buffer==NULL)
-			{
-				TRACE_LOG2( 
-					"Can't allocate %u bytes of memory for t2p_readwrite_pdf_image, %s", 
-					mT2p->tiff_datasize, 
-					mT2p->inputFilePath.c_str());
-				status = PDFHummus::eFailure;
-				break;
+				SampleABGRToRGB(
+					(tdata_t) buffer, 
+					mT2p->tiff_width*striprows);
 			}
-			memset(buffer, 0, mT2p->tiff_datasize);
-			stripsize=TIFFStripSize(mT2p->input);
-			stripcount=TIFFNumberOfStrips(mT2p->input);
-			for(i=0;i<stripcount;i++)
+			else
 			{
 				read = 
 					TIFFReadEncodedStrip(mT2p->input, 
 					i, 
-					(tdata_t) &buffer[bufferoffset], 
+					(tdata_t) buffer, 
 					stripsize);
 				if(read==-1)
 				{
@@ -2973,114 +2990,88 @@ EStatusCode TIFFImageHandler::WriteImageData(PDFStream* inImageStream)
 						"Error on decoding strip %u of %s", 
 						i, 
 						mT2p->inputFilePath.c_str());
-					_TIFFfree(samplebuffer);
-					_TIFFfree(buffer);
 					status = PDFHummus::eFailure;
 					break;
 				}
-				bufferoffset+=read;
-			}
-			if(status != PDFHummus::eSuccess)
-				break;
 
-			if(mT2p->pdf_sample & T2P_SAMPLE_REALIZE_PALETTE)
-			{
-				samplebuffer=(unsigned char*)_TIFFrealloc( 
-					(tdata_t) buffer, 
-					mT2p->tiff_datasize * mT2p->tiff_samplesperpixel);
-				if(samplebuffer==NULL)
-				{
-					TRACE_LOG2( 
-						"Can't allocate %u bytes of memory for t2p_readwrite_pdf_image, %s", 
-						mT2p->tiff_datasize, 
-						mT2p->inputFilePath.c_str());
-					status = PDFHummus::eFailure;
-				  _TIFFfree(buffer);
-				} 
-				else 
+				if(mT2p->pdf_sample & T2P_SAMPLE_REALIZE_PALETTE)
+					SampleRealizePalette(buffer,mT2p->tiff_width*striprows);
+
+				if(mT2p->pdf_sample & T2P_SAMPLE_RGBA_TO_RGB)
 				{
-					buffer=samplebuffer;
-					mT2p->tiff_datasize *= mT2p->tiff_samplesperpixel;
+					SampleRGBAToRGB(
+						(tdata_t)buffer, 
+						mT2p->tiff_width*striprows);
 				}
-				SampleRealizePalette(buffer);
-			}
 
-			if(mT2p->pdf_sample & T2P_SAMPLE_RGBA_TO_RGB)
-			{
-				mT2p->tiff_datasize=SampleRGBAToRGB(
-					(tdata_t)buffer, 
-					mT2p->tiff_width*mT2p->tiff_length);
-			}
-
-			if(mT2p->pdf_sample & T2P_SAMPLE_RGBAA_TO_RGB)
-			{
-				mT2p->tiff_datasize=SampleRGBAAToRGB(
-					(tdata_t)buffer, 
-					mT2p->tiff_width*mT2p->tiff_length);
-			}
-
-			if(mT2p->pdf_sample & T2P_SAMPLE_YCBCR_TO_RGB)
-			{
-				samplebuffer=(unsigned char*)_TIFFrealloc(
-					(tdata_t)buffer, 
-					mT2p->tiff_width*mT2p->tiff_length*4);
-				if(samplebuffer==NULL)
+				if(mT2p->pdf_sample & T2P_SAMPLE_RGBAA_TO_RGB)
 				{
-					TRACE_LOG2( 
-						"Can't allocate %u bytes of memory for t2p_readwrite_pdf_image, %s", 
-						mT2p->tiff_datasize, 
-						mT2p->inputFilePath.c_str());
-					status = PDFHummus::eFailure;
-					_TIFFfree(buffer);
-					break;
-				} 
-				else 
-				{
-					buffer=samplebuffer;
+					SampleRGBAAToRGB(
+						(tdata_t)buffer, 
+						mT2p->tiff_width*striprows);
 				}
-				if(!TIFFReadRGBAImageOriented(
-					mT2p->input, 
-					mT2p->tiff_width, 
-					mT2p->tiff_length, 
-					(uint32*)buffer, 
-					ORIENTATION_TOPLEFT,
-					0))
+
+				if(mT2p->pdf_sample & T2P_SAMPLE_LAB_SIGNED_TO_UNSIGNED)
 				{
-					TRACE_LOG1( 
-						"Can't use TIFFReadRGBAImageOriented to extract RGB image from %s", 
-						mT2p->inputFilePath.c_str());
-					status = PDFHummus::eFailure;
-					break;
+					SampleLABSignedToUnsigned(
+						(tdata_t)buffer, 
+						mT2p->tiff_width*striprows);
 				}
-				mT2p->tiff_datasize=SampleABGRToRGB(
-					(tdata_t) buffer, 
-					mT2p->tiff_width*mT2p->tiff_length);
-
 			}
 
-			if(mT2p->pdf_sample & T2P_SAMPLE_LAB_SIGNED_TO_UNSIGNED)
+			for(k=0;k<striprows && status == PDFHummus::eSuccess;k++)
 			{
-				mT2p->tiff_datasize=SampleLABSignedToUnsigned(
-					(tdata_t)buffer, 
-					mT2p->tiff_width*mT2p->tiff_length);
+				if(TIFFWriteScanline(mT2p->output, (tdata_t)(buffer + k*rowsize), row + k, 0) == -1)
+				{
+					TRACE_LOG2("Error writing encoded row %u to output PDF %s",row + k,mT2p->inputFilePath.c_str());
+					status = PDFHummus::eFailure;
+				}
 			}
+			if(status != PDFHummus::eSuccess)
+				break;
+			row+=striprows;
 		}
+		if(status != PDFHummus::eSuccess)
+			break;
 
-		status = WriteImageBufferToStream(inImageStream,
-								 mT2p->tiff_width,
-								 mT2p->tiff_length,
-								 buffer,
-								 GetSizeFromTIFFDataSize);
-		if (buffer != NULL) 
+		// blank whatever rows the strips did not cover, so the stream has the size declared for the image
+		memset(buffer, 0, rowsize);
+		for(;row < mT2p->tiff_length && status == PDFHummus::eSuccess;row++)
 		{
-			_TIFFfree(buffer);
-			buffer=NULL;
+			if(TIFFWriteScanline(mT2p->output, (tdata_t)buffer, row, 0) == -1)
+			{
+				TRACE_LOG2("Error writing encoded row %u to output PDF %s",row,mT2p->inputFilePath.c_str());
+				status = PDFHummus::eFailure;
+			}
 		}
 	}while(false);
+
+	if(rgbaImageStarted)
+		TIFFRGBAImageEnd(&rgbaImage);
+	if(encodingStarted)
+	{
+		EStatusCode endStatus = EndImageStreamEncoding(status == PDFHummus::eSuccess);
+		if(status == PDFHummus::eSuccess)
+			status = endStatus;
+	}
+	if(samplebuffer != NULL)
+		_TIFFfree(samplebuffer);
+	if(buffer != NULL)
+		_TIFFfree(buffer);
 	return status;
 }
 
-void TIFFImageHandler::SampleRealizePalette(unsigned char* inBuffer)
+uint16 TIFFImageHandler::GetEncodedSamplesPerPixel()
+{
+	// the number of samples per pixel, after the sample conversions of the untiled image path
+	if(!(mT2p->pdf_sample & T2P_SAMPLE_PLANAR_SEPARATE_TO_CONTIG) &&
+		(mT2p->pdf_sample & (T2P_SAMPLE_RGBA_TO_RGB | T2P_SAMPLE_RGBAA_TO_RGB | T2P_SAMPLE_YCBCR_TO_RGB)))
+		return 3;
+	else
+		return mT2p->tiff_samplesperpixel;
+}
+
+void TIFFImageHandler::SampleRealizePalette(unsigned char* inBuffer, uint32 inSampleCount)
 {
 	uint32 sample_count=0;
 	uint16 component_count=0;
@@ -3088,7 +3079,7 @@ void TIFFImageHandler::SampleRealizePalette(unsigned char* inBuffer)
 	uint32 sample_offset=0;
 	uint32 i=0;
 	uint32 j=0;
-	sample_count=mT2p->tiff_width*mT2p->tiff_length;
+	sample_count=inSampleCount;
 	component_count=mT2p->tiff_samplesperpixel;
 	
 	for(i=sample_count;i>0;i--)
@@ -3125,58 +3116,13 @@ EStatusCode TIFFImageHandler::WriteImageBufferToStream(PDFStream* inPDFStream,
 	EStatusCode status = PDFHummus::eSuccess;
 	do
 	{
-		mT2p->pdfStream = NULL;
-
-		/* hopefully here is good enough, and that dummy is good. 
-			basically the only allowed action is to write */
-		TIFF* output = TIFFClientOpen("dummy.txt", "w", (thandle_t)mT2p,
-					t2p_readproc, t2p_writeproc, t2p_seekproc, 
-					t2p_closeproc, t2p_sizeproc, 
-					t2p_mapproc, t2p_unmapproc );
-
-		TIFFSetField(output, TIFFTAG_PHOTOMETRIC, mT2p->tiff_photometric);
-		TIFFSetField(output, TIFFTAG_BITSPERSAMPLE, mT2p->tiff_bitspersample);
-		TIFFSetField(output, TIFFTAG_SAMPLESPERPIXEL, mT2p->tiff_samplesperpixel);
-		TIFFSetField(output, TIFFTAG_IMAGEWIDTH, inImageWidth);
-		TIFFSetField(output, TIFFTAG_IMAGELENGTH, inImageLength);
-		TIFFSetField(output, TIFFTAG_ROWSPERSTRIP, inImageLength); // equal to image length in both usages...
-		TIFFSetField(output, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
-		TIFFSetField(output, TIFFTAG_FILLORDER, FILLORDER_MSB2LSB);
-
-		switch(mT2p->pdf_compression)
-		{
-		case T2P_COMPRESS_NONE:
-			TIFFSetField(output, TIFFTAG_COMPRESSION, COMPRESSION_NONE);
-			break;
-		case T2P_COMPRESS_G4:
-			TIFFSetField(output, TIFFTAG_COMPRESSION, COMPRESSION_CCITTFAX4);
-			break;
-		case T2P_COMPRESS_ZIP:
-			TIFFSetField(output, TIFFTAG_COMPRESSION, COMPRESSION_DEFLATE);
-			if(mT2p->pdf_defaultcompressionquality%100 != 0)
-			{
-				TIFFSetField(output, 
-					TIFFTAG_PREDICTOR, 
-					mT2p->pdf_defaultcompressionquality % 100);
-			}
-			if(mT2p->pdf_defaultcompressionquality/100 != 0)
-			{
-				TIFFSetField(output, 
-					TIFFTAG_ZIPQUALITY, 
-					(mT2p->pdf_defaultcompressionquality / 100));
-			}
+		status = StartImageStreamEncoding(inPDFStream,inImageWidth,inImageLength,mT2p->tiff_samplesperpixel,mT2p->tiff_photometric);
+		if(status != PDFHummus::eSuccess)
 			break;
-		}
 
-		mT2p->pdfStream = inPDFStream;
-		mT2p->output = output; // dirty trick so i can use the inBufferSizeFunction function by getting info from output (sometimes)
+		tsize_t bufferoffset = TIFFWriteEncodedStrip(mT2p->output, (tstrip_t)0,inBuffer,inBufferSizeFunction(mT2p)); 
 
-		tsize_t bufferoffset = TIFFWriteEncodedStrip(output, (tstrip_t)0,inBuffer,inBufferSizeFunction(mT2p)); 
-
-		mT2p->output = NULL;
-		mT2p->pdfStream = NULL;
-		if (output != NULL)
-			TIFFClose(output);
+		status = EndImageStreamEncoding(false);
 
 		if (bufferoffset == (tsize_t)-1) 
 		{
@@ -3189,6 +3135,86 @@ EStatusCode TIFFImageHandler::WriteImageBufferToStream(PDFStream* inPDFStream,
 	return status;
 }
 
+EStatusCode TIFFImageHandler::StartImageStreamEncoding(PDFStream* inPDFStream,
+														uint32 inImageWidth,
+														uint32 inImageLength,
+														uint16 inSamplesPerPixel,
+														uint16 inPhotometric)
+{
+	mT2p->pdfStream = NULL;
+
+	/* hopefully here is good enough, and that dummy is good. 
+		basically the only allowed action is to write */
+	TIFF* output = TIFFClientOpen("dummy.txt", "w", (thandle_t)mT2p,
+				t2p_readproc, t2p_writeproc, t2p_seekproc, 
+				t2p_closeproc, t2p_sizeproc, 
+				t2p_mapproc, t2p_unmapproc );
+	if(!output)
+	{
+		TRACE_LOG1("Can't start encoding image data to output PDF %s",mT2p->inputFilePath.c_str());
+		return PDFHummus::eFailure;
+	}
+
+	TIFFSetField(output, TIFFTAG_PHOTOMETRIC, inPhotometric);
+	TIFFSetField(output, TIFFTAG_BITSPERSAMPLE, mT2p->tiff_bitspersample);
+	TIFFSetField(output, TIFFTAG_SAMPLESPERPIXEL, inSamplesPerPixel);
+	TIFFSetField(output, TIFFTAG_IMAGEWIDTH, inImageWidth);
+	TIFFSetField(output, TIFFTAG_IMAGELENGTH, inImageLength);
+	TIFFSetField(output, TIFFTAG_ROWSPERSTRIP, inImageLength); // single strip, so that the output is one continuous encoded stream
+	TIFFSetField(output, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+	TIFFSetField(output, TIFFTAG_FILLORDER, FILLORDER_MSB2LSB);
+
+	switch(mT2p->pdf_compression)
+	{
+	case T2P_COMPRESS_NONE:
+		TIFFSetField(output, TIFFTAG_COMPRESSION, COMPRESSION_NONE);
+		break;
+	case T2P_COMPRESS_G4:
+		TIFFSetField(output, TIFFTAG_COMPRESSION, COMPRESSION_CCITTFAX4);
+		break;
+	case T2P_COMPRESS_ZIP:
+		TIFFSetField(output, TIFFTAG_COMPRESSION, COMPRESSION_DEFLATE);
+		if(mT2p->pdf_defaultcompressionquality%100 != 0)
+		{
+			TIFFSetField(output, 
+				TIFFTAG_PREDICTOR, 
+				mT2p->pdf_defaultcompressionquality % 100);
+		}
+		if(mT2p->pdf_defaultcompressionquality/100 != 0)
+		{
+			TIFFSetField(output, 
+				TIFFTAG_ZIPQUALITY, 
+				(mT2p->pdf_defaultcompressionquality / 100));
+		}
+		break;
+	}
+
+	mT2p->pdfStream = inPDFStream;
+	mT2p->output = output; // dirty trick so i can use the inBufferSizeFunction function by getting info from output (sometimes)
+	return PDFHummus::eSuccess;
+}
+
+EStatusCode TIFFImageHandler::EndImageStreamEncoding(bool inFlushData)
+{
+	EStatusCode status = PDFHummus::eSuccess;
+
+	// when writing by scanlines, the last of the encoded data is still pending. flush it while the PDF stream is still attached
+	if(inFlushData && mT2p->output && !TIFFFlushData(mT2p->output))
+	{
+		TRACE_LOG1("Error flushing encoded image data to output PDF %s",mT2p->inputFilePath.c_str());
+		status = PDFHummus::eFailure;
+	}
+
+	// detach the PDF stream prior to closing, so the tiff directory written on close does not make it to the PDF
+	TIFF* output = mT2p->output;
+	mT2p->output = NULL;
+	mT2p->pdfStream = NULL;
+	if (output != NULL)
+		TIFFClose(output);
+
+	return status;
+}
+
 PDFFormXObject* TIFFImageHandler::WriteImagesFormXObject(const PDFImageXObjectList& inImages,ObjectIDType inFormXObjectID)
 {
 	EStatusCode status = PDFHummus::eSuccess;
@@ -197,8 +197,17 @@ private:
 	void WriteCommonImageDictionaryProperties(DictionaryContext* inImageContext);
 	PDFHummus::EStatusCode WriteImageData(PDFStream* inImageStream);
 	void CalculateTiffSizeNoTiles();
-	void SampleRealizePalette(unsigned char* inBuffer);
+	void SampleRealizePalette(unsigned char* inBuffer, uint32 inSampleCount);
 	tsize_t SampleABGRToRGB(tdata_t inData, uint32 inSampleCount);
+	uint16 GetEncodedSamplesPerPixel();
+	// open/close the libtiff encoder that writes its encoded output to inPDFStream (through mT2p->output). 
+	// after opening, write with TIFFWriteEncodedStrip (whole image) or TIFFWriteScanline (row by row)
+	PDFHummus::EStatusCode StartImageStreamEncoding(PDFStream* inPDFStream,
+											uint32 inImageWidth,
+											uint32 inImageLength,
+											uint16 inSamplesPerPixel,
+											uint16 inPhotometric);
+	PDFHummus::EStatusCode EndImageStreamEncoding(bool inFlushData);
 	PDFHummus::EStatusCode WriteImageBufferToStream(	PDFStream* inPDFStream,
 											uint32 inImageWidth,
 											uint32 inImageLength,
@@ -0,0 +1,53 @@
+/*
+   Source File : ThreadsCondition.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "ThreadsLock.h"
+
+/*
+	Condition variable to go with ThreadsLock. Wait is called with the lock locked, and returns with it locked.
+	wake ups may be spurious, so wait in a loop that checks the awaited state
+*/
+class ThreadsCondition
+{
+public:
+#ifdef WIN32
+	ThreadsCondition(){InitializeConditionVariable(&mCondition);}
+	~ThreadsCondition(){}
+	void Wait(ThreadsLock& inLock){SleepConditionVariableCS(&mCondition,&(inLock.mLock),INFINITE);}
+	void NotifyOne(){WakeConditionVariable(&mCondition);}
+	void NotifyAll(){WakeAllConditionVariable(&mCondition);}
+private:
+	CONDITION_VARIABLE mCondition;
+#else
+	ThreadsCondition(){pthread_cond_init(&mCondition,NULL);}
+	~ThreadsCondition(){pthread_cond_destroy(&mCondition);}
+	void Wait(ThreadsLock& inLock){pthread_cond_wait(&mCondition,&(inLock.mLock));}
+	void NotifyOne(){pthread_cond_signal(&mCondition);}
+	void NotifyAll(){pthread_cond_broadcast(&mCondition);}
+private:
+	pthread_cond_t mCondition;
+#endif
+
+	// not copyable
+	ThreadsCondition(const ThreadsCondition&);
+	ThreadsCondition& operator=(const ThreadsCondition&);
+};
@@ -0,0 +1,58 @@
+/*
+   Source File : ThreadsLock.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+/*
+	Mutex for the library own multithreaded parts, such as caches shared between writers, parallel font subsetting and tracing.
+	it is not recursive. users that want to lock content generation from their own threads implement ISharedResourcesLock instead
+*/
+class ThreadsLock
+{
+public:
+#ifdef WIN32
+	ThreadsLock(){InitializeCriticalSection(&mLock);}
+	~ThreadsLock(){DeleteCriticalSection(&mLock);}
+	void Lock(){EnterCriticalSection(&mLock);}
+	void Unlock(){LeaveCriticalSection(&mLock);}
+private:
+	CRITICAL_SECTION mLock;
+#else
+	ThreadsLock(){pthread_mutex_init(&mLock,NULL);}
+	~ThreadsLock(){pthread_mutex_destroy(&mLock);}
+	void Lock(){pthread_mutex_lock(&mLock);}
+	void Unlock(){pthread_mutex_unlock(&mLock);}
+private:
+	pthread_mutex_t mLock;
+#endif
+
+	// ThreadsCondition waits on the native lock
+	friend class ThreadsCondition;
+
+	// not copyable
+	ThreadsLock(const ThreadsLock&);
+	ThreadsLock& operator=(const ThreadsLock&);
+};
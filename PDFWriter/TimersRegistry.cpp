@@ -72,6 +72,7 @@ void TimersRegistry::ReleaseAll()
 
 void TimersRegistry::TraceAll()
 {
+#ifndef PDFHUMMUS_NO_TRACE
 	StringToTimerMap::iterator it = mTimers.begin();
 	
 	TRACE_LOG("Start Tracing Timers");
@@ -85,6 +86,7 @@ void TimersRegistry::TraceAll()
 						it->first.c_str(),hours,minutes,seconds,miliseconds);
 	}
 	TRACE_LOG("End Tracing Timers");
+#endif
 }
 
 void TimersRegistry::TraceAndReleaseAll()
@@ -20,93 +20,149 @@
 */
 #include "Trace.h"
 #include "Log.h"
+#include "TraceRingBuffer.h"
+#include "ThreadsLock.h"
 #include "SafeBufferMacrosDefs.h"
 
 #include <stdio.h>
 #include <stdarg.h>
 
+#ifdef WIN32
+#define TRACE_THREAD_LOCAL __declspec(thread)
+#else
+#define TRACE_THREAD_LOCAL __thread
+#endif
+
 Trace Trace::DefaultTrace;
 
+static TRACE_THREAD_LOCAL Trace* sThreadTrace = NULL;
+
 Trace::Trace(void)
 {
 	mLog = NULL;
+	mLock = new ThreadsLock();
 	mLogFilePath = "Log.txt";
+	mLogStream = NULL;
+	mRingBuffer = NULL;
 	mShouldLog = false;
+	mPlaceUTF8Bom = false;
+	mSeverityLevel = eTraceSeverityDebug;
 }
 
 Trace::~Trace(void)
 {
 	delete mLog;
+	delete mLock;
+}
+
+void Trace::ReleaseLog()
+{
+	mLock->Lock();
+	delete mLog;
+	mLog = NULL;
+	mLock->Unlock();
 }
 
 void Trace::SetLogSettings(const std::string& inLogFilePath,bool inShouldLog,bool inPlaceUTF8Bom)
 {
+	ReleaseLog();
 	mShouldLog = inShouldLog;
 	mPlaceUTF8Bom = inPlaceUTF8Bom;
 	mLogFilePath = inLogFilePath;
 	mLogStream = NULL;
-	if(mLog != NULL)
-	{
-		delete mLog;
-		mLog = NULL;
-		//if(mShouldLog)
-		//	mLog = new Log(mLogFilePath,inPlaceUTF8Bom);
-	}
+	mRingBuffer = NULL;
 }
 
 void Trace::SetLogSettings(IByteWriter* inLogStream,bool inShouldLog)
 {
+	ReleaseLog();
 	mShouldLog = inShouldLog;
 	mLogStream = inLogStream;
+	mRingBuffer = NULL;
 	mPlaceUTF8Bom = false;
-	if(mLog != NULL)
-	{
-		delete mLog;
-		mLog = NULL;
-		if(mShouldLog)
-			mLog = new Log(mLogStream);
-	}
 }
 
+void Trace::SetLogSettings(TraceRingBuffer* inRingBuffer,bool inShouldLog)
+{
+	ReleaseLog();
+	mShouldLog = inShouldLog;
+	mLogStream = NULL;
+	mRingBuffer = inRingBuffer;
+	mPlaceUTF8Bom = false;
+}
+
+void Trace::SetSeverityLevel(ETraceSeverity inSeverityLevel)
+{
+	mSeverityLevel = inSeverityLevel;
+}
+
+ETraceSeverity Trace::GetSeverityLevel()
+{
+	return mSeverityLevel;
+}
 
 void Trace::TraceToLog(const char* inFormat,...)
 {
 	if(mShouldLog)
 	{
-		if(NULL == mLog)
-		{
-			if(mLogStream)
-				mLog = new Log(mLogStream);
-			else
-				mLog = new Log(mLogFilePath,mPlaceUTF8Bom);
-		}
-
 		va_list argptr;
 		va_start(argptr, inFormat);
-
-		SAFE_VSPRINTF(mBuffer,5001,inFormat,argptr);
+		LogEntry(inFormat,argptr);
 		va_end(argptr);
-
-		mLog->LogEntry(std::string(mBuffer));
 	}
 }
 
 void Trace::TraceToLog(const char* inFormat,va_list inList)
 {
 	if(mShouldLog)
-	{
-		if(NULL == mLog)
-		{
-			if(mLogStream)
-				mLog = new Log(mLogStream);
-			else
-				mLog = new Log(mLogFilePath,mPlaceUTF8Bom);
-		}
+		LogEntry(inFormat,inList);
+}
 
-		SAFE_VSPRINTF(mBuffer,5001,inFormat,inList);
+void Trace::LogEntry(const char* inFormat,va_list inList)
+{
+	if(mRingBuffer)
+	{
+		mRingBuffer->LogEntry(inFormat,inList);
+		return;
+	}
 
-		mLog->LogEntry(std::string(mBuffer));
+	mLock->Lock();
+	if(NULL == mLog)
+	{
+		if(mLogStream)
+			mLog = new Log(mLogStream);
+		else
+			mLog = new Log(mLogFilePath,mPlaceUTF8Bom);
 	}
 
+	SAFE_VSPRINTF(mBuffer,5001,inFormat,inList);
+
+	mLog->LogEntry((const Byte*)mBuffer,strlen(mBuffer));
+	mLock->Unlock();
 }
 
+Trace& Trace::Current()
+{
+	return sThreadTrace ? *sThreadTrace : DefaultTrace;
+}
+
+void Trace::SetThreadTrace(Trace* inTrace)
+{
+	sThreadTrace = inTrace;
+}
+
+Trace* Trace::GetThreadTrace()
+{
+	return sThreadTrace;
+}
+
+TraceScope::TraceScope(Trace* inTrace)
+{
+	mPreviousTrace = Trace::GetThreadTrace();
+	Trace::SetThreadTrace(inTrace);
+}
+
+TraceScope::~TraceScope(void)
+{
+	Trace::SetThreadTrace(mPreviousTrace);
+}
@@ -32,6 +32,17 @@
 
 class Log;
 class IByteWriter;
+class TraceRingBuffer;
+class ThreadsLock;
+
+// severity of a log entry. a trace logs entries up to its severity level (see Trace::SetSeverityLevel)
+enum ETraceSeverity
+{
+	eTraceSeverityError,
+	eTraceSeverityWarning,
+	eTraceSeverityInfo,
+	eTraceSeverityDebug
+};
 
 class Trace
 {
@@ -41,33 +52,82 @@ public:
 
 	void SetLogSettings(const std::string& inLogFilePath,bool inShouldLog,bool inPlaceUTF8Bom);
 	void SetLogSettings(IByteWriter* inLogStream,bool inShouldLog);
+	// log to an in memory ring buffer, keeping the latest entries. entries are formatted directly into the buffer, without locking
+	// the trace. see TraceRingBuffer.h
+	void SetLogSettings(TraceRingBuffer* inRingBuffer,bool inShouldLog);
+
+	// entries with severity above the level are not logged (nor formatted). default is eTraceSeverityDebug, which logs everything
+	void SetSeverityLevel(ETraceSeverity inSeverityLevel);
+	ETraceSeverity GetSeverityLevel();
+
+	// check prior to formatting an entry. the TRACE_LOG macros do that, so when logging is off they cost just this check
+	bool IsLogging(ETraceSeverity inSeverity) {return mShouldLog && inSeverity <= mSeverityLevel;}
 
 	void TraceToLog(const char* inFormat,...);
 	void TraceToLog(const char* inFormat,va_list inList);
 
+	// the trace used by the TRACE_LOG macros - the calling thread trace, if set, or the default trace.
+	static Trace& Current();
+	// set the calling thread trace, so different threads [e.g. each with its own PDFWriter] can log to different traces
+	// without sharing the default one. pass NULL to go back to the default trace. see also TraceScope
+	static void SetThreadTrace(Trace* inTrace);
+	static Trace* GetThreadTrace();
+
     static Trace DefaultTrace;
 
 private:
 	char mBuffer[5001];
 	Log* mLog;
+	// each trace has its own lock, so threads logging to different traces don't wait for each other
+	ThreadsLock* mLock;
 
 	std::string mLogFilePath;
 	IByteWriter* mLogStream;
+	TraceRingBuffer* mRingBuffer;
 	bool mShouldLog;
 	bool mPlaceUTF8Bom;
+	ETraceSeverity mSeverityLevel;
 
-	// use the log
-	// make it lock safe
+	void ReleaseLog();
+	void LogEntry(const char* inFormat,va_list inList);
+};
+
+// sets the calling thread trace for the scope lifetime, restoring the previous one when done
+class TraceScope
+{
+public:
+	TraceScope(Trace* inTrace);
+	~TraceScope(void);
+
+private:
+	Trace* mPreviousTrace;
 };
 
 
-// short cuts for logging formats strings
-#define TRACE_LOG(FORMAT) Trace::DefaultTrace.TraceToLog(FORMAT)
-#define TRACE_LOG1(FORMAT,ARG1) Trace::DefaultTrace.TraceToLog(FORMAT,ARG1)
-#define TRACE_LOG2(FORMAT,ARG1,ARG2) Trace::DefaultTrace.TraceToLog(FORMAT,ARG1,ARG2)
-#define TRACE_LOG3(FORMAT,ARG1,ARG2,ARG3) Trace::DefaultTrace.TraceToLog(FORMAT,ARG1,ARG2,ARG3)
-#define TRACE_LOG4(FORMAT,ARG1,ARG2,ARG3,ARG4) Trace::DefaultTrace.TraceToLog(FORMAT,ARG1,ARG2,ARG3,ARG4)
-#define TRACE_LOG5(FORMAT,ARG1,ARG2,ARG3,ARG4,ARG5) Trace::DefaultTrace.TraceToLog(FORMAT,ARG1,ARG2,ARG3,ARG4,ARG5)
+// short cuts for logging formats strings. the format arguments are evaluated only when the current trace logs the severity.
+// TRACE_LOG* log errors, TRACE_LOG_SEVERITY* log the given severity. define PDFHUMMUS_NO_TRACE to compile all logging out
+#ifdef PDFHUMMUS_NO_TRACE
+#define TRACE_LOG_SEVERITY(SEVERITY,FORMAT) do{}while(false)
+#define TRACE_LOG_SEVERITY1(SEVERITY,FORMAT,ARG1) do{}while(false)
+#define TRACE_LOG_SEVERITY2(SEVERITY,FORMAT,ARG1,ARG2) do{}while(false)
+#define TRACE_LOG_SEVERITY3(SEVERITY,FORMAT,ARG1,ARG2,ARG3) do{}while(false)
+#define TRACE_LOG_SEVERITY4(SEVERITY,FORMAT,ARG1,ARG2,ARG3,ARG4) do{}while(false)
+#define TRACE_LOG_SEVERITY5(SEVERITY,FORMAT,ARG1,ARG2,ARG3,ARG4,ARG5) do{}while(false)
+#else
+#define TRACE_LOG_SEVERITY(SEVERITY,FORMAT) do{Trace& currentTrace_ = Trace::Current(); if(currentTrace_.IsLogging(SEVERITY)) currentTrace_.TraceToLog(FORMAT);}while(false)
+#define TRACE_LOG_SEVERITY1(SEVERITY,FORMAT,ARG1) do{Trace& currentTrace_ = Trace::Current(); if(currentTrace_.IsLogging(SEVERITY)) currentTrace_.TraceToLog(FORMAT,ARG1);}while(false)
+#define TRACE_LOG_SEVERITY2(SEVERITY,FORMAT,ARG1,ARG2) do{Trace& currentTrace_ = Trace::Current(); if(currentTrace_.IsLogging(SEVERITY)) currentTrace_.TraceToLog(FORMAT,ARG1,ARG2);}while(false)
+#define TRACE_LOG_SEVERITY3(SEVERITY,FORMAT,ARG1,ARG2,ARG3) do{Trace& currentTrace_ = Trace::Current(); if(currentTrace_.IsLogging(SEVERITY)) currentTrace_.TraceToLog(FORMAT,ARG1,ARG2,ARG3);}while(false)
+#define TRACE_LOG_SEVERITY4(SEVERITY,FORMAT,ARG1,ARG2,ARG3,ARG4) do{Trace& currentTrace_ = Trace::Current(); if(currentTrace_.IsLogging(SEVERITY)) currentTrace_.TraceToLog(FORMAT,ARG1,ARG2,ARG3,ARG4);}while(false)
+#define TRACE_LOG_SEVERITY5(SEVERITY,FORMAT,ARG1,ARG2,ARG3,ARG4,ARG5) do{Trace& currentTrace_ = Trace::Current(); if(currentTrace_.IsLogging(SEVERITY)) currentTrace_.TraceToLog(FORMAT,ARG1,ARG2,ARG3,ARG4,ARG5);}while(false)
+#endif
+
+#define TRACE_LOG(FORMAT) TRACE_LOG_SEVERITY(eTraceSeverityError,FORMAT)
+#define TRACE_LOG1(FORMAT,ARG1) TRACE_LOG_SEVERITY1(eTraceSeverityError,FORMAT,ARG1)
+#define TRACE_LOG2(FORMAT,ARG1,ARG2) TRACE_LOG_SEVERITY2(eTraceSeverityError,FORMAT,ARG1,ARG2)
+#define TRACE_LOG3(FORMAT,ARG1,ARG2,ARG3) TRACE_LOG_SEVERITY3(eTraceSeverityError,FORMAT,ARG1,ARG2,ARG3)
+#define TRACE_LOG4(FORMAT,ARG1,ARG2,ARG3,ARG4) TRACE_LOG_SEVERITY4(eTraceSeverityError,FORMAT,ARG1,ARG2,ARG3,ARG4)
+#define TRACE_LOG5(FORMAT,ARG1,ARG2,ARG3,ARG4,ARG5) TRACE_LOG_SEVERITY5(eTraceSeverityError,FORMAT,ARG1,ARG2,ARG3,ARG4,ARG5)
 
 
 
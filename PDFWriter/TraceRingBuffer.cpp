@@ -0,0 +1,131 @@
+/*
+   Source File : TraceRingBuffer.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "TraceRingBuffer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+// entries are truncated to the slot size, rather than failing on long entries
+#if defined(WIN32) && !defined(__MINGW32__)
+#define TRUNCATING_VSPRINTF(BUFFER,BUFFER_SIZE,FORMAT,ARGLIST) _vsnprintf_s(BUFFER,BUFFER_SIZE,_TRUNCATE,FORMAT,ARGLIST)
+#else
+#define TRUNCATING_VSPRINTF(BUFFER,BUFFER_SIZE,FORMAT,ARGLIST) vsnprintf(BUFFER,BUFFER_SIZE,FORMAT,ARGLIST)
+#endif
+
+// returns the value prior to the increment
+static long AtomicIncrement(volatile long* inValue)
+{
+#ifdef WIN32
+	return InterlockedIncrement(inValue) - 1;
+#else
+	return __sync_fetch_and_add(inValue,1);
+#endif
+}
+
+// sets inValue to inNewValue if it equals inExpectedValue. returns true if it did
+static bool AtomicCompareAndSwap(volatile long* inValue,long inExpectedValue,long inNewValue)
+{
+#ifdef WIN32
+	return InterlockedCompareExchange(inValue,inNewValue,inExpectedValue) == inExpectedValue;
+#else
+	return __sync_bool_compare_and_swap(inValue,inExpectedValue,inNewValue);
+#endif
+}
+
+static void FullMemoryBarrier()
+{
+#ifdef WIN32
+	MemoryBarrier();
+#else
+	__sync_synchronize();
+#endif
+}
+
+TraceRingBuffer::TraceRingBuffer(size_t inEntriesCount)
+{
+	mEntriesCount = inEntriesCount > 0 ? inEntriesCount : 1;
+	mEntries = new TraceRingBufferEntry[mEntriesCount];
+	for(size_t i = 0; i < mEntriesCount; ++i)
+	{
+		mEntries[i].mSequence = TRACE_RING_BUFFER_EMPTY_ENTRY;
+		mEntries[i].mText[0] = 0;
+	}
+	mNextSequence = 0;
+}
+
+TraceRingBuffer::~TraceRingBuffer(void)
+{
+	delete[] mEntries;
+}
+
+void TraceRingBuffer::LogEntry(const char* inFormat,va_list inList)
+{
+	long sequence = AtomicIncrement(&mNextSequence);
+	TraceRingBufferEntry& entry = mEntries[(unsigned long)sequence % mEntriesCount];
+
+	// claim the slot. loggers a full ring apart may get the same slot, in which case only one writes it.
+	// drop the entry if the slot is being written, or already holds a later entry
+	long slotSequence;
+	do
+	{
+		slotSequence = entry.mSequence;
+		if(TRACE_RING_BUFFER_CLAIMED_ENTRY == slotSequence || slotSequence > sequence)
+			return;
+	}while(!AtomicCompareAndSwap(&entry.mSequence,slotSequence,TRACE_RING_BUFFER_CLAIMED_ENTRY));
+
+	FullMemoryBarrier();
+	TRUNCATING_VSPRINTF(entry.mText,TRACE_RING_BUFFER_ENTRY_SIZE,inFormat,inList);
+	FullMemoryBarrier();
+	entry.mSequence = sequence;
+}
+
+StringList TraceRingBuffer::GetEntries()
+{
+	StringList entries;
+	long lastSequence = mNextSequence;
+	long sequence = (unsigned long)lastSequence > mEntriesCount ? lastSequence - (long)mEntriesCount : 0;
+
+	for(; sequence < lastSequence; ++sequence)
+	{
+		TraceRingBufferEntry& entry = mEntries[(unsigned long)sequence % mEntriesCount];
+		if(entry.mSequence != sequence)
+			continue;
+
+		FullMemoryBarrier();
+		std::string text(entry.mText,strnlen(entry.mText,TRACE_RING_BUFFER_ENTRY_SIZE));
+		FullMemoryBarrier();
+
+		// drop the entry if it was overwritten while copying it
+		if(entry.mSequence == sequence)
+			entries.push_back(text);
+	}
+
+	return entries;
+}
+
+unsigned long TraceRingBuffer::GetEntriesLoggedCount()
+{
+	return (unsigned long)mNextSequence;
+}
@@ -0,0 +1,74 @@
+/*
+   Source File : TraceRingBuffer.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include <stdarg.h>
+
+#include <string>
+#include <list>
+
+typedef std::list<std::string> StringList;
+
+// maximum length of an entry, longer entries are truncated
+#define TRACE_RING_BUFFER_ENTRY_SIZE 1024
+#define DEFAULT_TRACE_RING_BUFFER_ENTRIES_COUNT 256
+
+// slot sequence values for a slot that was never written, and for a slot claimed by a logger that is writing it
+#define TRACE_RING_BUFFER_EMPTY_ENTRY -2
+#define TRACE_RING_BUFFER_CLAIMED_ENTRY -1
+
+/*
+	In memory log for production, keeping the latest entries logged (see Trace::SetLogSettings).
+	logging an entry takes the next sequence number with an atomic increment, claims its slot with a compare and swap,
+	and formats right into it, so concurrent loggers don't wait on each other. when the ring wraps around while an entry
+	is being written, the logger that finds its slot claimed drops its entry rather than mixing text into it.
+	an entry that is still being written, or was overwritten while being read, is skipped by GetEntries.
+*/
+class TraceRingBuffer
+{
+public:
+	TraceRingBuffer(size_t inEntriesCount = DEFAULT_TRACE_RING_BUFFER_ENTRIES_COUNT);
+	~TraceRingBuffer(void);
+
+	void LogEntry(const char* inFormat,va_list inList);
+
+	// the entries currently held, oldest first
+	StringList GetEntries();
+	// number of entries logged since creation, including those already overwritten
+	unsigned long GetEntriesLoggedCount();
+
+private:
+
+	struct TraceRingBufferEntry
+	{
+		// sequence number of the entry held, or TRACE_RING_BUFFER_EMPTY_ENTRY/TRACE_RING_BUFFER_CLAIMED_ENTRY
+		volatile long mSequence;
+		char mText[TRACE_RING_BUFFER_ENTRY_SIZE];
+	};
+
+	TraceRingBufferEntry* mEntries;
+	size_t mEntriesCount;
+	volatile long mNextSequence;
+
+	// not copyable
+	TraceRingBuffer(const TraceRingBuffer&);
+	TraceRingBuffer& operator=(const TraceRingBuffer&);
+};
@@ -19,6 +19,8 @@
    
 */
 #include "TrueTypeEmbeddedFontWriter.h"
+#include "ParallelFontSubsetter.h"
+#include "FontProgramsCache.h"
 #include "FreeTypeFaceWrapper.h"
 #include "ObjectsContext.h"
 #include "DictionaryContext.h"
@@ -44,6 +46,7 @@ TrueTypeEmbeddedFontWriter::~TrueTypeEmbeddedFontWriter(void)
 }
 
 static const std::string scLength1 = "Length1";
+static const std::string scTrueTypeProgramType = "TrueType";
 EStatusCode TrueTypeEmbeddedFontWriter::WriteEmbeddedFont(	
 								FreeTypeFaceWrapper& inFontInfo,
 								const UIntVector& inSubsetGlyphIDs,
@@ -51,19 +54,56 @@ EStatusCode TrueTypeEmbeddedFontWriter::WriteEmbeddedFont(
 								ObjectIDType& outEmbeddedFontObjectID)
 {
 	MyStringBuf rawFontProgram;
+	MyStringBuf* fontProgram = NULL;
 	bool notEmbedded;
-	EStatusCode status;
+	EStatusCode status = PDFHummus::eSuccess;
+	FontProgramsCache* fontProgramsCache = FontProgramsCache::GetCacheForFont(inFontInfo,inObjectsContext);
+	std::string cacheKey;
+	CachedFontProgram cachedProgram;
+	bool useCachedProgram = false;
 
 	do
 	{
-		status = CreateTrueTypeSubset(inFontInfo,inSubsetGlyphIDs,notEmbedded,rawFontProgram);
-		if(status != PDFHummus::eSuccess)
+		// another document may have already embedded this subset, in which case the finished program can be copied as is
+		if(fontProgramsCache)
 		{
-			TRACE_LOG("TrueTypeEmbeddedFontWriter::WriteEmbeddedFont, failed to write embedded font program");
-			break;
-		}	
+			cacheKey = FontProgramsCache::CreateKey(inFontInfo,inObjectsContext,scTrueTypeProgramType,inSubsetGlyphIDs,NULL,"");
+			useCachedProgram = fontProgramsCache->GetFontProgram(cacheKey,cachedProgram);
+		}
+
+		if(!useCachedProgram)
+		{
+			// use the font program if it was already created in parallel with the other fonts
+			if(inFontInfo.GetParallelFontSubsetter())
+				fontProgram = inFontInfo.GetParallelFontSubsetter()->GetTrueTypeSubset(&inFontInfo,inSubsetGlyphIDs,notEmbedded);
+
+			if(!fontProgram)
+			{
+				status = CreateTrueTypeSubset(inFontInfo,inSubsetGlyphIDs,notEmbedded,rawFontProgram);
+				if(status != PDFHummus::eSuccess)
+				{
+					TRACE_LOG("TrueTypeEmbeddedFontWriter::WriteEmbeddedFont, failed to write embedded font program");
+					break;
+				}	
+				fontProgram = &rawFontProgram;
+			}
+
+			if(fontProgramsCache)
+			{
+				if(notEmbedded)
+					cachedProgram.NotEmbedded = true;
+				else
+				{
+					status = FontProgramsCache::CreateCachedFontProgram(*fontProgram,inObjectsContext,cachedProgram);
+					if(status != PDFHummus::eSuccess)
+						break;
+				}
+				fontProgramsCache->AddFontProgram(cacheKey,cachedProgram);
+				useCachedProgram = true;
+			}
+		}
 
-		if(notEmbedded)
+		if(useCachedProgram ? cachedProgram.NotEmbedded : notEmbedded)
 		{
 			// can't embed. mark succesful, and go back empty
 			outEmbeddedFontObjectID = 0;
@@ -72,19 +112,27 @@ EStatusCode TrueTypeEmbeddedFontWriter::WriteEmbeddedFont(
 		}
 
 		outEmbeddedFontObjectID = inObjectsContext->StartNewIndirectObject();
+		++inObjectsContext->GetMetrics().GetCounters().FontsSubset;
+		inObjectsContext->GetMetrics().GetCounters().GlyphsEmbedded += inSubsetGlyphIDs.size();
 		
 		DictionaryContext* fontProgramDictionaryContext = inObjectsContext->StartDictionary();
 
 		// Length1 (decompressed true type program length)
 
 		fontProgramDictionaryContext->WriteKey(scLength1);
-		fontProgramDictionaryContext->WriteIntegerValue(rawFontProgram.GetCurrentWritePosition());
-		rawFontProgram.pubseekoff(0,std::ios_base::beg);
-		PDFStream* pdfStream = inObjectsContext->StartPDFStream(fontProgramDictionaryContext);
+		if(useCachedProgram)
+		{
+			fontProgramDictionaryContext->WriteIntegerValue(cachedProgram.DecodedLength);
+			status = FontProgramsCache::WriteCachedFontProgram(cachedProgram,inObjectsContext,fontProgramDictionaryContext);
+			break;
+		}
+		fontProgramDictionaryContext->WriteIntegerValue(fontProgram->GetCurrentWritePosition());
+		fontProgram->pubseekoff(0,std::ios_base::beg);
+		PDFStream* pdfStream = inObjectsContext->StartPDFStream(fontProgramDictionaryContext,false,eStreamCategoryFont);
 
 
 		// now copy the created font program to the output stream
-		InputStringBufferStream fontProgramStream(&rawFontProgram);
+		InputStringBufferStream fontProgramStream(fontProgram);
 		OutputStreamTraits streamCopier(pdfStream->GetWriteStream());
 		status = streamCopier.CopyToOutputStream(&fontProgramStream);
 		if(status != PDFHummus::eSuccess)
@@ -52,6 +52,12 @@ public:
 									ObjectsContext* inObjectsContext,
 									ObjectIDType& outEmbeddedFontObjectID);
 
+	// create the font program only. uses the font file path and index of inFontInfo, so may run on a worker thread. see ParallelFontSubsetter.h
+	PDFHummus::EStatusCode CreateTrueTypeSubset(	FreeTypeFaceWrapper& inFontInfo,
+										const UIntVector& inSubsetGlyphIDs,
+										bool& outNotEmbedded,
+										MyStringBuf& outFontProgram);
+
 private:
 	OpenTypeFileInput mTrueTypeInput;
 	InputFile mTrueTypeFile;
@@ -78,11 +84,6 @@ private:
 	LongFilePositionType mHeadCheckSumOffset;
 	
 
-	PDFHummus::EStatusCode CreateTrueTypeSubset(	FreeTypeFaceWrapper& inFontInfo,
-										const UIntVector& inSubsetGlyphIDs,
-										bool& outNotEmbedded,
-										MyStringBuf& outFontProgram);
-
 	void AddDependentGlyphs(UIntVector& ioSubsetGlyphIDs);
 	bool AddComponentGlyphs(unsigned int inGlyphID,UIntSet& ioComponents);
 
@@ -166,6 +166,8 @@ EStatusCode Type1ToCFFEmbeddedFontWriter::WriteEmbeddedFont(
 		}
 
 		outEmbeddedFontObjectID = inObjectsContext->StartNewIndirectObject();
+		++inObjectsContext->GetMetrics().GetCounters().FontsSubset;
+		inObjectsContext->GetMetrics().GetCounters().GlyphsEmbedded += inSubsetGlyphIDs.size();
 		
 		DictionaryContext* fontProgramDictionaryContext = inObjectsContext->StartDictionary();
 
@@ -173,7 +175,7 @@ EStatusCode Type1ToCFFEmbeddedFontWriter::WriteEmbeddedFont(
 
 		fontProgramDictionaryContext->WriteKey(scSubtype);
 		fontProgramDictionaryContext->WriteNameValue(inFontFile3SubType);
-		PDFStream* pdfStream = inObjectsContext->StartPDFStream(fontProgramDictionaryContext);
+		PDFStream* pdfStream = inObjectsContext->StartPDFStream(fontProgramDictionaryContext,false,eStreamCategoryFont);
 
 
 		// now copy the created font program to the output stream
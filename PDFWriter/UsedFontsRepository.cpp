@@ -32,6 +32,8 @@
 #include "PDFIndirectObjectReference.h"
 #include "PDFLiteralString.h"
 #include "PDFInteger.h"
+#include "SharedFontsCache.h"
+#include "ParallelFontSubsetter.h"
 
 
 #include <list>
@@ -45,6 +47,9 @@ UsedFontsRepository::UsedFontsRepository(void)
 {
 	mInputFontsInformation = NULL;
 	mObjectsContext = NULL;
+	mSharedFontsCache = NULL;
+	mFontSubsettingThreads = 1;
+	mFontProgramsCache = NULL;
 }
 
 UsedFontsRepository::~UsedFontsRepository(void)
@@ -57,6 +62,48 @@ void UsedFontsRepository::SetObjectsContext(ObjectsContext* inObjectsContext)
 	mObjectsContext = inObjectsContext;
 }
 
+void UsedFontsRepository::SetSharedFontsCache(SharedFontsCache* inSharedFontsCache)
+{
+	mSharedFontsCache = inSharedFontsCache;
+}
+
+void UsedFontsRepository::SetFontSubsettingThreads(unsigned int inFontSubsettingThreads)
+{
+	mFontSubsettingThreads = inFontSubsettingThreads > 0 ? inFontSubsettingThreads : 1;
+}
+
+void UsedFontsRepository::SetFontProgramsCache(FontProgramsCache* inFontProgramsCache)
+{
+	mFontProgramsCache = inFontProgramsCache;
+}
+
+FT_Face UsedFontsRepository::NewFace(const std::string& inFontFilePath,long inFontIndex,SharedFontFile*& outSharedFontFile)
+{
+	outSharedFontFile = mSharedFontsCache ? mSharedFontsCache->AcquireFontFile(inFontFilePath) : NULL;
+	if(!outSharedFontFile)
+		return mInputFontsInformation->NewFace(inFontFilePath,inFontIndex);
+
+	FT_Face face = mInputFontsInformation->NewFace(outSharedFontFile->GetData(),(FT_Long)outSharedFontFile->GetSize(),inFontIndex);
+	if(!face)
+	{
+		mSharedFontsCache->ReleaseFontFile(outSharedFontFile);
+		outSharedFontFile = NULL;
+	}
+	return face;
+}
+
+void UsedFontsRepository::SetSharedFontFile(PDFUsedFont* inUsedFont,SharedFontFile* inSharedFontFile)
+{
+	if(!inSharedFontFile)
+		return;
+
+	// the face wrapper keeps the file reference from now on, and releases it when the face is done
+	if(inUsedFont)
+		inUsedFont->GetFreeTypeFont()->SetSharedFontFile(mSharedFontsCache,inSharedFontFile);
+	else
+		mSharedFontsCache->ReleaseFontFile(inSharedFontFile);
+}
+
 PDFUsedFont* UsedFontsRepository::GetFontForFile(const std::string& inFontFilePath,const std::string& inOptionalMetricsFile,long inFontIndex)
 {
 	if(!mObjectsContext)
@@ -73,13 +120,14 @@ PDFUsedFont* UsedFontsRepository::GetFontForFile(const std::string& inFontFilePa
 
 
 		FT_Face face;
+		SharedFontFile* sharedFontFile = NULL;
 		if(inOptionalMetricsFile.size() > 0)
 		{
 			face = mInputFontsInformation->NewFace(inFontFilePath,inOptionalMetricsFile,inFontIndex);
 			mOptionaMetricsFiles.insert(StringToStringMap::value_type(inFontFilePath,inOptionalMetricsFile));
 		}
 		else
-			face = mInputFontsInformation->NewFace(inFontFilePath,inFontIndex);
+			face = NewFace(inFontFilePath,inFontIndex,sharedFontFile);
 		if(!face)
 		{
 			TRACE_LOG1("UsedFontsRepository::GetFontForFile, Failed to load font from %s",inFontFilePath.c_str());
@@ -90,6 +138,8 @@ PDFUsedFont* UsedFontsRepository::GetFontForFile(const std::string& inFontFilePa
 		{
 
 			PDFUsedFont* usedFont = new PDFUsedFont(face,inFontFilePath,inOptionalMetricsFile,inFontIndex,mObjectsContext);
+			SetSharedFontFile(usedFont,sharedFontFile);
+			usedFont->GetFreeTypeFont()->SetFontProgramsCache(mFontProgramsCache);
 			if(!usedFont->IsValid())
 			{
 				TRACE_LOG1("UsedFontsRepository::GetFontForFile, Unreckognized font format for font in %s",inFontFilePath.c_str());
@@ -107,15 +157,51 @@ EStatusCode UsedFontsRepository::WriteUsedFontsDefinitions(bool inEmbedFonts)
 {
 	StringAndLongToPDFUsedFontMap::iterator it = mUsedFonts.begin();
 	EStatusCode status = PDFHummus::eSuccess;
+	ParallelFontSubsetter subsetter;
+	bool createSubsetsAhead = inEmbedFonts && mFontSubsettingThreads > 1;
+
+	// create the subsets of all fonts in parallel first. writing the fonts then picks them up, in the regular order
+	if(createSubsetsAhead)
+		CreateFontSubsets(&subsetter);
 
 	for(; it != mUsedFonts.end() && PDFHummus::eSuccess == status; ++it)
 		status = it->second ?
                     it->second->WriteFontDefinition(inEmbedFonts):
                     eFailure;
 
+	if(createSubsetsAhead)
+		SetParallelFontSubsetter(NULL);
+
 	return status;
 }
 
+void UsedFontsRepository::CreateFontSubsets(ParallelFontSubsetter* inSubsetter)
+{
+	// follow the subset names the fonts are going to generate, so the CFF subsets, which contain their names, match
+	UppercaseSequance subsetFontsNames = mObjectsContext->GetSubsetFontsNamesSequance();
+	StringAndLongToPDFUsedFontMap::iterator it = mUsedFonts.begin();
+
+	for(; it != mUsedFonts.end(); ++it)
+	{
+		if(it->second)
+			it->second->AddFontSubsets(true,subsetFontsNames,inSubsetter);
+	}
+
+	inSubsetter->CreateSubsets(mFontSubsettingThreads);
+	SetParallelFontSubsetter(inSubsetter);
+}
+
+void UsedFontsRepository::SetParallelFontSubsetter(ParallelFontSubsetter* inSubsetter)
+{
+	StringAndLongToPDFUsedFontMap::iterator it = mUsedFonts.begin();
+
+	for(; it != mUsedFonts.end(); ++it)
+	{
+		if(it->second)
+			it->second->GetFreeTypeFont()->SetParallelFontSubsetter(inSubsetter);
+	}
+}
+
 PDFUsedFont* UsedFontsRepository::GetFontForFile(const std::string& inFontFilePath,long inFontIndex)
 {
 	return GetFontForFile(inFontFilePath,"",inFontIndex);
@@ -240,7 +326,12 @@ EStatusCode UsedFontsRepository::ReadState(PDFParser* inStateReader,ObjectIDType
         long fontIndex = (long)keyIndexItem->GetValue();
 
 		FT_Face face;
-		face = mInputFontsInformation->NewFace(filePath,fontIndex);
+		SharedFontFile* sharedFontFile = NULL;
+		StringToStringMap::iterator itOptionlMetricsFile = mOptionaMetricsFiles.find(filePath);
+		if(itOptionlMetricsFile != mOptionaMetricsFiles.end())
+			face = mInputFontsInformation->NewFace(filePath,fontIndex);
+		else
+			face = NewFace(filePath,fontIndex,sharedFontFile);
 		
 		if(!face)
 		{
@@ -252,11 +343,12 @@ EStatusCode UsedFontsRepository::ReadState(PDFParser* inStateReader,ObjectIDType
 
 		PDFUsedFont* usedFont;
 		
-		StringToStringMap::iterator itOptionlMetricsFile = mOptionaMetricsFiles.find(filePath);
 		if(itOptionlMetricsFile != mOptionaMetricsFiles.end())
 			usedFont = new PDFUsedFont(face,filePath,itOptionlMetricsFile->second,fontIndex,mObjectsContext);
 		else
 			usedFont = new PDFUsedFont(face,filePath,"",fontIndex,mObjectsContext);
+		SetSharedFontFile(usedFont,sharedFontFile);
+		usedFont->GetFreeTypeFont()->SetFontProgramsCache(mFontProgramsCache);
 		if(!usedFont->IsValid())
 		{
 			TRACE_LOG2("UsedFontsRepository::ReadState, Unreckognized font format for font in %s at index %ld",filePath.c_str(),fontIndex);
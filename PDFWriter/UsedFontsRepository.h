@@ -27,12 +27,19 @@
 #include <map>
 #include <utility>
 
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
 
 
 class FreeTypeWrapper;
 class PDFUsedFont;
 class ObjectsContext;
 class PDFParser;
+class SharedFontsCache;
+class SharedFontFile;
+class ParallelFontSubsetter;
+class FontProgramsCache;
 
 typedef std::pair<std::string,long> StringAndLong;
 typedef std::map<StringAndLong,PDFUsedFont*> StringAndLongToPDFUsedFontMap;
@@ -45,6 +52,14 @@ public:
 	~UsedFontsRepository(void);
 
 	void SetObjectsContext(ObjectsContext* inObjectsContext);
+	// cache (not owned) to get font data from, instead of opening the font files per document. see SharedFontsCache.h.
+	// fonts with an additional metrics file are not shared
+	void SetSharedFontsCache(SharedFontsCache* inSharedFontsCache);
+	// number of threads for creating the embedded fonts subsets when writing the fonts definitions. with more than 1,
+	// the subsets of all fonts are created in parallel, ahead of writing the fonts. see ParallelFontSubsetter.h
+	void SetFontSubsettingThreads(unsigned int inFontSubsettingThreads);
+	// cache (not owned) of embedded font programs shared with other documents. see FontProgramsCache.h
+	void SetFontProgramsCache(FontProgramsCache* inFontProgramsCache);
 
 	PDFUsedFont* GetFontForFile(const std::string& inFontFilePath,long inFontIndex);
 	// second overload is for type 1, when an additional metrics file is available
@@ -63,4 +78,12 @@ private:
 	FreeTypeWrapper* mInputFontsInformation;
 	StringAndLongToPDFUsedFontMap mUsedFonts;
 	StringToStringMap mOptionaMetricsFiles;
+	SharedFontsCache* mSharedFontsCache;
+	unsigned int mFontSubsettingThreads;
+	FontProgramsCache* mFontProgramsCache;
+
+	FT_Face NewFace(const std::string& inFontFilePath,long inFontIndex,SharedFontFile*& outSharedFontFile);
+	void SetSharedFontFile(PDFUsedFont* inUsedFont,SharedFontFile* inSharedFontFile);
+	void CreateFontSubsets(ParallelFontSubsetter* inSubsetter);
+	void SetParallelFontSubsetter(ParallelFontSubsetter* inSubsetter);
 };
@@ -0,0 +1,84 @@
+/*
+   Source File : WorkerThread.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "WorkerThread.h"
+
+WorkerThread::WorkerThread(void)
+{
+	mProc = NULL;
+	mContext = NULL;
+	mStarted = false;
+}
+
+WorkerThread::~WorkerThread(void)
+{
+	Join();
+}
+
+bool WorkerThread::Start(WorkerThreadProc inProc,void* inContext)
+{
+	if(mStarted)
+		return false;
+
+	mProc = inProc;
+	mContext = inContext;
+#ifdef WIN32
+	mThread = CreateThread(NULL,0,ThreadProc,this,0,NULL);
+	mStarted = (mThread != NULL);
+#else
+	mStarted = (pthread_create(&mThread,NULL,ThreadProc,this) == 0);
+#endif
+	return mStarted;
+}
+
+void WorkerThread::Join()
+{
+	if(!mStarted)
+		return;
+
+#ifdef WIN32
+	WaitForSingleObject(mThread,INFINITE);
+	CloseHandle(mThread);
+#else
+	pthread_join(mThread,NULL);
+#endif
+	mStarted = false;
+}
+
+bool WorkerThread::IsStarted()
+{
+	return mStarted;
+}
+
+#ifdef WIN32
+DWORD WINAPI WorkerThread::ThreadProc(LPVOID inWorkerThread)
+{
+	WorkerThread* workerThread = (WorkerThread*)inWorkerThread;
+	workerThread->mProc(workerThread->mContext);
+	return 0;
+}
+#else
+void* WorkerThread::ThreadProc(void* inWorkerThread)
+{
+	WorkerThread* workerThread = (WorkerThread*)inWorkerThread;
+	workerThread->mProc(workerThread->mContext);
+	return NULL;
+}
+#endif
@@ -0,0 +1,64 @@
+/*
+   Source File : WorkerThread.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+typedef void (*WorkerThreadProc)(void* inContext);
+
+/*
+	A thread for the library own multithreaded parts, such as parallel font subsetting and parallel flate encoding.
+	Start runs the procedure on a new thread, and Join waits for it to finish. a started thread is joined on destruction
+*/
+class WorkerThread
+{
+public:
+	WorkerThread(void);
+	~WorkerThread(void);
+
+	// returns false if the thread could not be created, in which case the caller should do the work in some other way
+	bool Start(WorkerThreadProc inProc,void* inContext);
+	void Join();
+
+	bool IsStarted();
+
+private:
+	WorkerThreadProc mProc;
+	void* mContext;
+	bool mStarted;
+#ifdef WIN32
+	HANDLE mThread;
+
+	static DWORD WINAPI ThreadProc(LPVOID inWorkerThread);
+#else
+	pthread_t mThread;
+
+	static void* ThreadProc(void* inWorkerThread);
+#endif
+
+	// not copyable
+	WorkerThread(const WorkerThread&);
+	WorkerThread& operator=(const WorkerThread&);
+};
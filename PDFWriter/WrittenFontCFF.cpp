@@ -31,6 +31,11 @@
 #include "PDFArray.h"
 #include "PDFInteger.h"
 #include "PDFBoolean.h"
+#include "ParallelFontSubsetter.h"
+#include "UppercaseSequance.h"
+#include "FreeTypeFaceWrapper.h"
+
+#include <string.h>
 
 using namespace PDFHummus;
 
@@ -196,6 +201,43 @@ EStatusCode WrittenFontCFF::WriteFontDefinition(FreeTypeFaceWrapper& inFontInfo,
 	return status;
 }
 
+static const char* scCFF = "CFF";
+static const std::string scPlus = "+";
+void WrittenFontCFF::AddFontSubsets(FreeTypeFaceWrapper& inFontInfo,bool inEmbedFont,UppercaseSequance& ioSubsetFontsNames,ParallelFontSubsetter* ioSubsetter)
+{
+	if(!inEmbedFont)
+		return;
+
+	// type 1 fonts are converted to CFF when written, so only CFF fonts are added. the subset names are generated for both
+	bool isCFF = strcmp(scCFF,inFontInfo.GetTypeString()) == 0;
+
+	if(mANSIRepresentation && !mANSIRepresentation->isEmpty() && mANSIRepresentation->mWrittenObjectID != 0)
+	{
+		std::string fontName = ioSubsetFontsNames.GetNextValue() + scPlus + inFontInfo.GetPostscriptName();
+		if(isCFF)
+			ioSubsetter->AddCFFSubset(&inFontInfo,mANSIRepresentation->GetGlyphIDsAsOrderedVector(),NULL,fontName);
+	}
+
+	if(mCIDRepresentation && !mCIDRepresentation->isEmpty()  && mCIDRepresentation->mWrittenObjectID != 0)
+	{
+		std::string fontName = ioSubsetFontsNames.GetNextValue() + scPlus + inFontInfo.GetPostscriptName();
+		if(isCFF)
+		{
+			// glyphs ordered by ID, with their CIDs in the same order. same as CFFDescendentFontWriter passes them
+			UIntVector orderedGlyphs;
+			UShortVector cidMapping;
+			UIntToGlyphEncodingInfoMap::iterator it = mCIDRepresentation->mGlyphIDToEncodedChar.begin();
+
+			for(; it != mCIDRepresentation->mGlyphIDToEncodedChar.end(); ++it)
+			{
+				orderedGlyphs.push_back(it->first);
+				cidMapping.push_back(it->second.mEncodedCharacter);
+			}
+			ioSubsetter->AddCFFSubset(&inFontInfo,orderedGlyphs,&cidMapping,fontName);
+		}
+	}
+}
+
 bool WrittenFontCFF::AddToANSIRepresentation(	const GlyphUnicodeMappingListList& inGlyphsList,
 												UShortListList& outEncodedCharacters)
 {
@@ -38,6 +38,7 @@ public:
 
 
 	virtual PDFHummus::EStatusCode WriteFontDefinition(FreeTypeFaceWrapper& inFontInfo, bool inEmbedFont);
+	virtual void AddFontSubsets(FreeTypeFaceWrapper& inFontInfo,bool inEmbedFont,UppercaseSequance& ioSubsetFontsNames,ParallelFontSubsetter* ioSubsetter);
 
 	virtual PDFHummus::EStatusCode WriteState(ObjectsContext* inStateWriter,ObjectIDType inObjectId);
 	virtual PDFHummus::EStatusCode ReadState(PDFParser* inStateReader,ObjectIDType inObjectID);
@@ -29,6 +29,8 @@
 #include "PDFObjectCast.h"
 #include "PDFParser.h"
 #include "PDFDictionary.h"
+#include "ParallelFontSubsetter.h"
+#include "UppercaseSequance.h"
 
 using namespace PDFHummus;
 
@@ -144,6 +146,25 @@ EStatusCode WrittenFontTrueType::WriteFontDefinition(FreeTypeFaceWrapper& inFont
 	return status;
 }
 
+void WrittenFontTrueType::AddFontSubsets(FreeTypeFaceWrapper& inFontInfo,bool inEmbedFont,UppercaseSequance& ioSubsetFontsNames,ParallelFontSubsetter* ioSubsetter)
+{
+	if(!inEmbedFont)
+		return;
+
+	// true type font programs don't contain the subset font name, but the names are still generated for both representations
+	if(mANSIRepresentation && !mANSIRepresentation->isEmpty() && mANSIRepresentation->mWrittenObjectID != 0)
+	{
+		ioSubsetFontsNames.GetNextValue();
+		ioSubsetter->AddTrueTypeSubset(&inFontInfo,mANSIRepresentation->GetGlyphIDsAsOrderedVector());
+	}
+
+	if(mCIDRepresentation && !mCIDRepresentation->isEmpty()  && mCIDRepresentation->mWrittenObjectID != 0)
+	{
+		ioSubsetFontsNames.GetNextValue();
+		ioSubsetter->AddTrueTypeSubset(&inFontInfo,mCIDRepresentation->GetGlyphIDsAsOrderedVector());
+	}
+}
+
 bool WrittenFontTrueType::AddToANSIRepresentation(	const GlyphUnicodeMappingListList& inGlyphsList,
 													UShortListList& outEncodedCharacters)
 {
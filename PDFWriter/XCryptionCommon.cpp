@@ -21,9 +21,12 @@ limitations under the License.
 #include "XCryptionCommon.h"
 #include "RC4.h"
 #include "MD5Generator.h"
+#include "SHA2Generator.h"
+#include "aescpp.h"
 
 #include <algorithm>
 #include <stdint.h>
+#include <string.h>
 
 using namespace std;
 using namespace IOBasicTypes;
@@ -33,6 +36,9 @@ XCryptionCommon::XCryptionCommon(void)
 {
 	for (int i = 0; i < 32; ++i)
 		mPaddingFiller.push_back(scPaddingFiller[i]);
+	mUsingAES = false;
+	mUsingEncryptionKeyForAllObjects = false;
+	mCanXCrypt = false;
 
 }
 
@@ -42,6 +48,14 @@ XCryptionCommon::~XCryptionCommon(void)
 
 bool XCryptionCommon::Setup(bool inUsingAES) {
 	mUsingAES = inUsingAES;
+	mUsingEncryptionKeyForAllObjects = false;
+	mCanXCrypt = true;
+	return CanXCrypt();
+}
+
+bool XCryptionCommon::Setup(EXCryptionMethod inMethod) {
+	mUsingAES = (eXCryptionMethodAESV2 == inMethod || eXCryptionMethodAESV3 == inMethod);
+	mUsingEncryptionKeyForAllObjects = (eXCryptionMethodAESV3 == inMethod);
 	mCanXCrypt = true;
 	return CanXCrypt();
 }
@@ -81,6 +95,8 @@ const ByteList& XCryptionCommon::OnObjectStart(long long inObjectID, long long i
 ByteList XCryptionCommon::ComputeEncryptionKeyForObject(
 	ObjectIDType inObjectNumber,
 	unsigned long inGenerationNumber) {
+	if (mUsingEncryptionKeyForAllObjects)
+		return mEncryptionKey;
 	return algorithm3_1(inObjectNumber, inGenerationNumber, mEncryptionKey, mUsingAES);
 }
 
@@ -143,7 +159,8 @@ std::string XCryptionCommon::ByteListToString(const ByteList& inByteList) {
 	return buffer;
 }
 
-const Byte scAESSuffix[] = { 0x73, 0x41, 0x63, 0x54 };
+// "sAlT"
+const Byte scAESSuffix[] = { 0x73, 0x41, 0x6C, 0x54 };
 ByteList XCryptionCommon::algorithm3_1(ObjectIDType inObjectNumber,
 	unsigned long inGenerationNumber,
 	const ByteList& inEncryptionKey,
@@ -377,3 +394,85 @@ bool XCryptionCommon::algorithm3_7(unsigned int inRevision,
 		inEncryptMetaData,
 		inU);
 }
+
+ByteList XCryptionCommon::algorithm2_B(unsigned int inRevision,
+	const ByteList& inPassword,
+	const ByteList& inSalt,
+	const ByteList& inUserKey) {
+	std::string password = ByteListToString(substr(inPassword, 0, 127));
+	std::string userKey = ByteListToString(inUserKey);
+	SHA2Generator sha256;
+
+	sha256.Accumulate(password);
+	sha256.Accumulate(inSalt);
+	sha256.Accumulate(userKey);
+	std::string hashResult = sha256.ToStringAsString();
+
+	// revision 5 stops at a single SHA-256 round
+	if (inRevision < 6)
+		return stringToByteList(hashResult);
+
+	// revision 6 hardens with at least 64 rounds of AES-128 encryption and SHA-2 hashing, hash size per the encrypted data
+	std::string input;
+	std::string encrypted;
+	for (int round = 0; ; ++round) {
+		std::string sequence = password + hashResult + userKey;
+		input.clear();
+		for (int i = 0; i < 64; ++i)
+			input.append(sequence);
+		encrypted.resize(input.size());
+
+		AESencrypt aes;
+		unsigned char iv[AES_BLOCK_SIZE];
+		aes.key((const unsigned char*)hashResult.c_str(), 16);
+		memcpy(iv, hashResult.c_str() + 16, AES_BLOCK_SIZE);
+		aes.cbc_encrypt((const unsigned char*)input.c_str(), (unsigned char*)&encrypted[0], (int)input.size(), iv);
+
+		// the first 16 bytes as a big endian number, mod 3, is the same as the sum of the bytes mod 3
+		unsigned int sum = 0;
+		for (int i = 0; i < 16; ++i)
+			sum += (Byte)encrypted[i];
+
+		SHA2Generator sha(sum % 3 == 0 ? 256 : (sum % 3 == 1 ? 384 : 512));
+		sha.Accumulate(encrypted);
+		hashResult = sha.ToStringAsString();
+
+		if (round >= 63 && (int)(Byte)encrypted[encrypted.size() - 1] <= round - 31)
+			break;
+	}
+
+	return stringToByteList(hashResult.substr(0, 32));
+}
+
+bool XCryptionCommon::algorithm2_A(unsigned int inRevision,
+	const ByteList& inPassword,
+	const ByteList& inO,
+	const ByteList& inU,
+	const ByteList& inOE,
+	const ByteList& inUE,
+	bool inAsOwner,
+	ByteList& outEncryptionKey) {
+	// O and U are a 32 bytes hash, 8 bytes validation salt and 8 bytes key salt. OE and UE are the file key encrypted with the respective password
+	const ByteList& passwordKey = inAsOwner ? inO : inU;
+	ByteList userKey = inAsOwner ? substr(inU, 0, 48) : ByteList();
+
+	if (passwordKey.size() < 48 || inOE.size() < 32 || inUE.size() < 32)
+		return false;
+
+	if (algorithm2_B(inRevision, inPassword, substr(passwordKey, 32, 8), userKey) != substr(passwordKey, 0, 32))
+		return false;
+
+	ByteList intermediateKey = algorithm2_B(inRevision, inPassword, substr(passwordKey, 40, 8), userKey);
+	std::string encryptedKey = ByteListToString(substr(inAsOwner ? inOE : inUE, 0, 32));
+	std::string key = ByteListToString(intermediateKey);
+	unsigned char iv[AES_BLOCK_SIZE];
+	unsigned char fileKey[32];
+	AESdecrypt aes;
+
+	memset(iv, 0, AES_BLOCK_SIZE);
+	aes.key((const unsigned char*)key.c_str(), 32);
+	aes.cbc_decrypt((const unsigned char*)encryptedKey.c_str(), fileKey, 32, iv);
+
+	outEncryptionKey = ByteList(fileKey, fileKey + 32);
+	return true;
+}
@@ -29,6 +29,15 @@ limitations under the License.
 typedef std::list<IOBasicTypes::Byte> ByteList;
 typedef std::list<ByteList> ByteListList;
 
+// encryption methods, per the crypt filter CFM values. RC4 is also the method for V 1 and 2, which have no crypt filters
+enum EXCryptionMethod
+{
+	eXCryptionMethodNone, // Identity, no encryption
+	eXCryptionMethodRC4, // V2
+	eXCryptionMethodAESV2, // AES-128
+	eXCryptionMethodAESV3 // AES-256
+};
+
 
 class XCryptionCommon {
 public:
@@ -49,6 +58,8 @@ public:
 
 	// call this whenever you first can. this sets some internal behavior based on the input elements
 	bool Setup(bool inUsingAES);
+	// same, by method. AESV3 uses the initial encryption key for all objects, rather than computing a key per object
+	bool Setup(EXCryptionMethod inMethod);
 
 	void SetupInitialEncryptionKey(const std::string& inUserPassword,
 		unsigned int inRevision,
@@ -127,11 +138,27 @@ public:
 		bool inEncryptMetaData,
 		const ByteList inU);
 
+	// PDF 2.0 xcryption algorithms, for revisions 5 and 6 (AES-256)
+	// computes a password hash. pass the 48 bytes of U as inUserKey when hashing the owner password, and an empty list when hashing the user password
+	ByteList algorithm2_B(unsigned int inRevision,
+		const ByteList& inPassword,
+		const ByteList& inSalt,
+		const ByteList& inUserKey);
+	// validates inPassword as owner [inAsOwner = true] or user password. if valid, returns true and places the file encryption key in outEncryptionKey
+	bool algorithm2_A(unsigned int inRevision,
+		const ByteList& inPassword,
+		const ByteList& inO,
+		const ByteList& inU,
+		const ByteList& inOE,
+		const ByteList& inUE,
+		bool inAsOwner,
+		ByteList& outEncryptionKey);
 
 private:
 	ByteList mPaddingFiller;
 	ByteListList mEncryptionKeysStack;
 	bool mUsingAES;
+	bool mUsingEncryptionKeyForAllObjects;
 	ByteList mEncryptionKey;
 	bool mCanXCrypt;
 
@@ -20,7 +20,7 @@
 */
 #include "XObjectContentContext.h"
 #include "PDFFormXObject.h"
-#include "IFormEndWritingTask.h"
+#include "FormImageWritingTask.h"
 #include "DocumentContext.h"
 
 using namespace PDFHummus;
@@ -40,30 +40,6 @@ ResourcesDictionary* XObjectContentContext::GetResourcesDictionary()
 	return &(mPDFFormXObjectOfContext->GetResourcesDictionary());
 }
 
-class FormImageWritingTask : public IFormEndWritingTask
- {
- public:
- FormImageWritingTask(const std::string& inImagePath,unsigned long inImageIndex,ObjectIDType inObjectID, const PDFParsingOptions& inPDFParsingOptions)
- {
-	 mImagePath = inImagePath; mImageIndex = inImageIndex; mObjectID = inObjectID; mPDFParsingOptions = inPDFParsingOptions;
- }
- 
- virtual ~FormImageWritingTask(){}
- 
-     virtual PDFHummus::EStatusCode Write(PDFFormXObject* inFormXObject,
-                                        ObjectsContext* inObjectsContext,
-                                        PDFHummus::DocumentContext* inDocumentContext)
-     {
-         return inDocumentContext->WriteFormForImage(mImagePath,mImageIndex,mObjectID, mPDFParsingOptions);
-     }
- 
- private:
-     std::string mImagePath;
-     unsigned long mImageIndex;
-     ObjectIDType mObjectID;
-	 PDFParsingOptions mPDFParsingOptions;
-};
-
 void XObjectContentContext::ScheduleImageWrite(const std::string& inImagePath,unsigned long inImageIndex,ObjectIDType inObjectID, const PDFParsingOptions& inParsingOptions)
 {
     mDocumentContext->RegisterFormEndWritingTask(
@@ -0,0 +1,158 @@
+/*
+   Source File : BenchmarkMeasurements.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "BenchmarkMeasurements.h"
+
+#include <stdlib.h>
+#include <new>
+
+#ifdef WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <time.h>
+#include <sys/resource.h>
+#endif
+
+static volatile long long sAllocationsCount = 0;
+
+static void CountAllocation()
+{
+#ifdef WIN32
+	InterlockedIncrement64(&sAllocationsCount);
+#else
+	__sync_fetch_and_add(&sAllocationsCount,1);
+#endif
+}
+
+static void* CountedAllocate(size_t inSize)
+{
+	CountAllocation();
+	return malloc(inSize > 0 ? inSize : 1);
+}
+
+void* operator new(size_t inSize)
+{
+	void* allocated = CountedAllocate(inSize);
+	if(!allocated)
+		throw std::bad_alloc();
+	return allocated;
+}
+
+void* operator new[](size_t inSize)
+{
+	void* allocated = CountedAllocate(inSize);
+	if(!allocated)
+		throw std::bad_alloc();
+	return allocated;
+}
+
+void* operator new(size_t inSize,const std::nothrow_t&)
+{
+	return CountedAllocate(inSize);
+}
+
+void* operator new[](size_t inSize,const std::nothrow_t&)
+{
+	return CountedAllocate(inSize);
+}
+
+void operator delete(void* inPointer)
+{
+	free(inPointer);
+}
+
+void operator delete[](void* inPointer)
+{
+	free(inPointer);
+}
+
+// sized deallocation [C++14] would otherwise go to the runtime default, which may not pair with malloc
+void operator delete(void* inPointer,size_t)
+{
+	free(inPointer);
+}
+
+void operator delete[](void* inPointer,size_t)
+{
+	free(inPointer);
+}
+
+void operator delete(void* inPointer,const std::nothrow_t&)
+{
+	free(inPointer);
+}
+
+void operator delete[](void* inPointer,const std::nothrow_t&)
+{
+	free(inPointer);
+}
+
+double BenchmarkMeasurements::GetWallClockMiliSeconds()
+{
+#ifdef WIN32
+	LARGE_INTEGER frequency,counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (double)counter.QuadPart * 1000 / (double)frequency.QuadPart;
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return (double)now.tv_sec * 1000 + (double)now.tv_nsec / 1000000;
+#endif
+}
+
+unsigned long long BenchmarkMeasurements::GetPeakResidentKiloBytes()
+{
+#ifdef WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if(!GetProcessMemoryInfo(GetCurrentProcess(),&counters,sizeof(counters)))
+		return 0;
+	return counters.PeakWorkingSetSize / 1024;
+#else
+	struct rusage usage;
+	if(getrusage(RUSAGE_SELF,&usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	// bytes on mac, kilobytes elsewhere
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+#endif
+}
+
+void BenchmarkMeasurements::ResetAllocationsCount()
+{
+#ifdef WIN32
+	InterlockedExchange64(&sAllocationsCount,0);
+#else
+	__sync_lock_test_and_set(&sAllocationsCount,0);
+#endif
+}
+
+unsigned long long BenchmarkMeasurements::GetAllocationsCount()
+{
+#ifdef WIN32
+	return InterlockedCompareExchange64(&sAllocationsCount,0,0);
+#else
+	return __sync_fetch_and_add(&sAllocationsCount,0);
+#endif
+}
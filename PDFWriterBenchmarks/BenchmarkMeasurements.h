@@ -0,0 +1,39 @@
+/*
+   Source File : BenchmarkMeasurements.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+/*
+	Process level measurements for the benchmarks. allocations are counted by replacing the global operator new
+	of the benchmarks executable, so only C++ allocations are counted [and not, e.g., zlib mallocs].
+*/
+
+class BenchmarkMeasurements
+{
+public:
+	static double GetWallClockMiliSeconds();
+
+	// process resident memory high water mark. 0 if not available on the platform
+	static unsigned long long GetPeakResidentKiloBytes();
+
+	// operator new calls, from all threads, since the last reset
+	static void ResetAllocationsCount();
+	static unsigned long long GetAllocationsCount();
+};
@@ -0,0 +1,260 @@
+/*
+   Source File : BenchmarksRunner.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "BenchmarksRunner.h"
+#include "IBenchmark.h"
+#include "BenchmarkMeasurements.h"
+#include "InputFile.h"
+#include "IByteReaderWithPosition.h"
+
+#include <iostream>
+#include <sstream>
+#include <locale>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+using namespace PDFHummus;
+
+unsigned long BenchmarkConfiguration::Scale(unsigned long inCount) const
+{
+	unsigned long scaled = (unsigned long)(inCount * mScale + 0.5);
+	return scaled > 0 ? scaled : 1;
+}
+
+string BenchmarkConfiguration::GetMaterialPath(const string& inMaterialPath) const
+{
+	return mMaterialsBase + "/TestMaterials/" + inMaterialPath;
+}
+
+EStatusCode BenchmarkConfiguration::ReadMaterial(const string& inMaterialPath,string& outData) const
+{
+	InputFile file;
+	EStatusCode status = file.OpenFile(GetMaterialPath(inMaterialPath));
+
+	do
+	{
+		if(status != eSuccess)
+		{
+			cout<<"failed to open material "<<GetMaterialPath(inMaterialPath)<<"\n";
+			break;
+		}
+
+		outData.clear();
+		outData.reserve((size_t)file.GetFileSize());
+		IOBasicTypes::Byte buffer[4096];
+		IByteReaderWithPosition* stream = file.GetInputStream();
+		while(stream->NotEnded())
+		{
+			LongBufferSizeType readAmount = stream->Read(buffer,sizeof(buffer));
+			outData.append((const char*)buffer,(size_t)readAmount);
+		}
+		file.CloseFile();
+	}while(false);
+
+	return status;
+}
+
+BenchmarkResult::BenchmarkResult()
+{
+	Status = eFailure;
+	Iterations = 0;
+	OperationsPerIteration = 0;
+	BytesPerIteration = 0;
+	MedianMiliSeconds = 0;
+	MinMiliSeconds = 0;
+	OperationsPerSecond = 0;
+	MegaBytesPerSecond = 0;
+	AllocationsPerOperation = 0;
+	PeakResidentKiloBytes = 0;
+}
+
+BenchmarksRunner::BenchmarksRunner(void)
+{
+}
+
+BenchmarksRunner::~BenchmarksRunner(void)
+{
+	StringToBenchmarkMap::iterator it = mBenchmarks.begin();
+	for(; it != mBenchmarks.end(); ++it)
+		delete it->second;
+}
+
+void BenchmarksRunner::AddBenchmark(const string& inBenchmarkName,IBenchmark* inBenchmark)
+{
+	mBenchmarks.insert(StringToBenchmarkMap::value_type(inBenchmarkName,inBenchmark));
+}
+
+EStatusCode BenchmarksRunner::Run(const BenchmarkConfiguration& inConfiguration,const StringList& inBenchmarksNames,BenchmarkResultList& outResults)
+{
+	EStatusCode status = eSuccess;
+
+	if(inBenchmarksNames.empty())
+	{
+		StringToBenchmarkMap::iterator it = mBenchmarks.begin();
+		for(; it != mBenchmarks.end(); ++it)
+		{
+			outResults.push_back(RunBenchmark(inConfiguration,it->first,it->second));
+			if(outResults.back().Status != eSuccess)
+				status = eFailure;
+		}
+	}
+	else
+	{
+		StringList::const_iterator itNames = inBenchmarksNames.begin();
+		for(; itNames != inBenchmarksNames.end(); ++itNames)
+		{
+			StringToBenchmarkMap::iterator it = mBenchmarks.find(*itNames);
+			if(it == mBenchmarks.end())
+			{
+				cout<<"Benchmark "<<*itNames<<" not found\n";
+				BenchmarkResult result;
+				result.Name = *itNames;
+				outResults.push_back(result);
+				status = eFailure;
+				continue;
+			}
+			outResults.push_back(RunBenchmark(inConfiguration,it->first,it->second));
+			if(outResults.back().Status != eSuccess)
+				status = eFailure;
+		}
+	}
+
+	return status;
+}
+
+BenchmarkResult BenchmarksRunner::RunBenchmark(const BenchmarkConfiguration& inConfiguration,const string& inBenchmarkName,IBenchmark* inBenchmark)
+{
+	BenchmarkResult result;
+	result.Name = inBenchmarkName;
+	result.OperationName = inBenchmark->GetOperationName();
+
+	cout<<"Running Benchmark "<<inBenchmarkName<<"\n";
+
+	do
+	{
+		result.Status = inBenchmark->Setup(inConfiguration);
+		if(result.Status != eSuccess)
+		{
+			cout<<"Benchmark "<<inBenchmarkName<<" failed to setup\n";
+			break;
+		}
+
+		// warm up caches [and verify that the workload runs], before measuring
+		result.Status = inBenchmark->RunIteration(result.OperationsPerIteration,result.BytesPerIteration);
+		if(result.Status != eSuccess)
+		{
+			cout<<"Benchmark "<<inBenchmarkName<<" failed in warm up iteration\n";
+			break;
+		}
+
+		vector<double> iterationsTimes;
+		unsigned long long allocationsCount = 0;
+		unsigned long long operations,bytes;
+		for(unsigned long i = 0; i < inConfiguration.mIterations && eSuccess == result.Status; ++i)
+		{
+			BenchmarkMeasurements::ResetAllocationsCount();
+			double startTime = BenchmarkMeasurements::GetWallClockMiliSeconds();
+			result.Status = inBenchmark->RunIteration(operations,bytes);
+			iterationsTimes.push_back(BenchmarkMeasurements::GetWallClockMiliSeconds() - startTime);
+			allocationsCount += BenchmarkMeasurements::GetAllocationsCount();
+
+			if(result.Status != eSuccess)
+				cout<<"Benchmark "<<inBenchmarkName<<" failed in iteration "<<i<<"\n";
+			else if(operations != result.OperationsPerIteration || bytes != result.BytesPerIteration)
+			{
+				cout<<"Benchmark "<<inBenchmarkName<<" is not deterministic. iteration "<<i<<" did "<<operations<<" "<<result.OperationName<<
+					" and "<<bytes<<" bytes, where warm up did "<<result.OperationsPerIteration<<" and "<<result.BytesPerIteration<<" bytes\n";
+				result.Status = eFailure;
+			}
+		}
+		if(result.Status != eSuccess || iterationsTimes.empty())
+			break;
+
+		sort(iterationsTimes.begin(),iterationsTimes.end());
+		result.Iterations = (unsigned long)iterationsTimes.size();
+		result.MinMiliSeconds = iterationsTimes.front();
+		result.MedianMiliSeconds = (iterationsTimes.size() % 2 == 1) ?
+										iterationsTimes[iterationsTimes.size() / 2] :
+										(iterationsTimes[iterationsTimes.size() / 2 - 1] + iterationsTimes[iterationsTimes.size() / 2]) / 2;
+		if(result.MedianMiliSeconds > 0)
+		{
+			result.OperationsPerSecond = result.OperationsPerIteration * 1000.0 / result.MedianMiliSeconds;
+			result.MegaBytesPerSecond = result.BytesPerIteration / (1024.0 * 1024.0) * 1000.0 / result.MedianMiliSeconds;
+		}
+		if(result.OperationsPerIteration > 0)
+			result.AllocationsPerOperation = (double)allocationsCount / (double)(result.OperationsPerIteration * result.Iterations);
+	}while(false);
+
+	inBenchmark->TearDown();
+	result.PeakResidentKiloBytes = BenchmarkMeasurements::GetPeakResidentKiloBytes();
+
+	if(eSuccess == result.Status)
+		cout<<"Benchmark "<<inBenchmarkName<<": "<<result.OperationsPerIteration<<" "<<result.OperationName<<" in "<<result.MedianMiliSeconds<<"ms (median of "<<
+			result.Iterations<<"), "<<result.OperationsPerSecond<<" "<<result.OperationName<<"/sec, "<<result.MegaBytesPerSecond<<" MB/sec, "<<
+			result.AllocationsPerOperation<<" allocations per operation, peak RSS "<<result.PeakResidentKiloBytes<<"KB\n\n";
+	else
+		cout<<"Benchmark "<<inBenchmarkName<<" Failed\n\n";
+
+	return result;
+}
+
+static string EscapeJSONString(const string& inString)
+{
+	string escaped;
+	for(string::const_iterator it = inString.begin(); it != inString.end(); ++it)
+	{
+		if('"' == *it || '\\' == *it)
+			escaped.push_back('\\');
+		escaped.push_back(*it);
+	}
+	return escaped;
+}
+
+string BenchmarksRunner::ToJSON(const BenchmarkConfiguration& inConfiguration,const BenchmarkResultList& inResults)
+{
+	stringstream json;
+	json.imbue(locale::classic());
+	json.setf(ios::fixed);
+	json.precision(3);
+
+	json<<"{\"scale\":"<<inConfiguration.mScale<<",\"iterations\":"<<inConfiguration.mIterations<<",\"benchmarks\":[";
+	BenchmarkResultList::const_iterator it = inResults.begin();
+	for(; it != inResults.end(); ++it)
+	{
+		if(it != inResults.begin())
+			json<<",";
+		json<<"{\"name\":\""<<EscapeJSONString(it->Name)<<"\""<<
+				",\"status\":\""<<(eSuccess == it->Status ? "success" : "failure")<<"\""<<
+				",\"operation\":\""<<EscapeJSONString(it->OperationName)<<"\""<<
+				",\"operationsPerIteration\":"<<it->OperationsPerIteration<<
+				",\"bytesPerIteration\":"<<it->BytesPerIteration<<
+				",\"medianMilliseconds\":"<<it->MedianMiliSeconds<<
+				",\"minMilliseconds\":"<<it->MinMiliSeconds<<
+				",\"operationsPerSecond\":"<<it->OperationsPerSecond<<
+				",\"megabytesPerSecond\":"<<it->MegaBytesPerSecond<<
+				",\"allocationsPerOperation\":"<<it->AllocationsPerOperation<<
+				",\"peakResidentKilobytes\":"<<it->PeakResidentKiloBytes<<
+				"}";
+	}
+	json<<"]}";
+
+	return json.str();
+}
@@ -0,0 +1,108 @@
+/*
+   Source File : BenchmarksRunner.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "EStatusCode.h"
+#include "Singleton.h"
+
+#include <string>
+#include <list>
+#include <map>
+
+class IBenchmark;
+
+#define DEFAULT_BENCHMARK_ITERATIONS 5
+
+struct BenchmarkConfiguration
+{
+	// folder holding the TestMaterials folder
+	std::string mMaterialsBase;
+	// workload sizes are multiplied by the scale. results are only comparable between runs of the same scale
+	double mScale;
+	// measured iterations, following a single warm up iteration
+	unsigned long mIterations;
+
+	BenchmarkConfiguration(){mScale = 1;mIterations = DEFAULT_BENCHMARK_ITERATIONS;}
+
+	// count scaled by mScale, and at least 1
+	unsigned long Scale(unsigned long inCount) const;
+	// read a file from TestMaterials, e.g. "fonts/arial.ttf", to memory
+	PDFHummus::EStatusCode ReadMaterial(const std::string& inMaterialPath,std::string& outData) const;
+	std::string GetMaterialPath(const std::string& inMaterialPath) const;
+};
+
+struct BenchmarkResult
+{
+	std::string Name;
+	std::string OperationName;
+	PDFHummus::EStatusCode Status;
+	unsigned long Iterations;
+	unsigned long long OperationsPerIteration;
+	unsigned long long BytesPerIteration;
+	double MedianMiliSeconds;
+	double MinMiliSeconds;
+	// rates are per the median iteration time
+	double OperationsPerSecond;
+	double MegaBytesPerSecond;
+	// C++ heap allocations [operator new] during the measured iterations
+	double AllocationsPerOperation;
+	// process high water mark after the benchmark. it includes whatever benchmarks ran before, so run a single benchmark for its own peak
+	unsigned long long PeakResidentKiloBytes;
+
+	BenchmarkResult();
+};
+
+typedef std::list<std::string> StringList;
+typedef std::list<BenchmarkResult> BenchmarkResultList;
+typedef std::map<std::string,IBenchmark*> StringToBenchmarkMap;
+
+class BenchmarksRunner
+{
+public:
+	BenchmarksRunner(void);
+	~BenchmarksRunner(void);
+
+	void AddBenchmark(const std::string& inBenchmarkName,IBenchmark* inBenchmark);
+
+	// runs the named benchmarks, or all of them when inBenchmarksNames is empty, in names order. 
+	// returns failure if a benchmark is not found or failed, in which case its result has the failure status
+	PDFHummus::EStatusCode Run(const BenchmarkConfiguration& inConfiguration,const StringList& inBenchmarksNames,BenchmarkResultList& outResults);
+
+	// machine readable report, for comparing runs. e.g.
+	// {"scale":1.000,"iterations":5,"benchmarks":[{"name":"TextDocument","status":"success","operation":"pages","operationsPerIteration":10000,...},...]}
+	static std::string ToJSON(const BenchmarkConfiguration& inConfiguration,const BenchmarkResultList& inResults);
+
+private:
+	StringToBenchmarkMap mBenchmarks;
+
+	BenchmarkResult RunBenchmark(const BenchmarkConfiguration& inConfiguration,const std::string& inBenchmarkName,IBenchmark* inBenchmark);
+};
+
+// use ADD_BENCHMARK for the benchmark class in its CPP file, to have it registered with the runner
+#define ADD_BENCHMARK(X) \
+template <class T> \
+class BenchmarkRegistrar { \
+	public:  \
+		BenchmarkRegistrar(){ \
+			Singleton<BenchmarksRunner>::GetInstance()->AddBenchmark(#X,new T); \
+		} \
+};  \
+static BenchmarkRegistrar<X> BenchmarkRegistrarInstance;
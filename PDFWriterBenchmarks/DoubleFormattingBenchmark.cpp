@@ -0,0 +1,79 @@
+/*
+   Source File : DoubleFormattingBenchmark.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "DoubleFormattingBenchmark.h"
+#include "BenchmarksRunner.h"
+#include "PrimitiveObjectsWriter.h"
+#include "OutputStringBufferStream.h"
+
+using namespace std;
+using namespace PDFHummus;
+
+#define DOUBLE_FORMATTING_DOUBLES 1000000
+#define DOUBLE_FORMATTING_SEED 20111
+
+DoubleFormattingBenchmark::DoubleFormattingBenchmark(void)
+{
+}
+
+DoubleFormattingBenchmark::~DoubleFormattingBenchmark(void)
+{
+}
+
+EStatusCode DoubleFormattingBenchmark::Setup(const BenchmarkConfiguration& inConfiguration)
+{
+	unsigned long valuesCount = inConfiguration.Scale(DOUBLE_FORMATTING_DOUBLES);
+	unsigned long seed = DOUBLE_FORMATTING_SEED;
+
+	mValues.reserve(valuesCount);
+	for(unsigned long i = 0; i < valuesCount; ++i)
+	{
+		// plain LCG, so values are the same on all platforms. alternate coordinates and unit values, like colors
+		seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+		double fraction = (double)seed / 0x7fffffff;
+		mValues.push_back(i % 2 == 0 ? fraction * 1200 - 200 : fraction);
+	}
+	return eSuccess;
+}
+
+EStatusCode DoubleFormattingBenchmark::RunIteration(unsigned long long& outOperations,unsigned long long& outBytes)
+{
+	OutputStringBufferStream stream;
+	PrimitiveObjectsWriter writer(&stream);
+
+	for(vector<double>::iterator it = mValues.begin(); it != mValues.end(); ++it)
+		writer.WriteDouble(*it);
+
+	outOperations = mValues.size();
+	outBytes = stream.GetCurrentPosition();
+	return eSuccess;
+}
+
+void DoubleFormattingBenchmark::TearDown()
+{
+	mValues.clear();
+}
+
+string DoubleFormattingBenchmark::GetOperationName()
+{
+	return "doubles";
+}
+
+ADD_BENCHMARK(DoubleFormattingBenchmark)
@@ -0,0 +1,108 @@
+/*
+   Source File : EncryptedCopyBenchmark.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "EncryptedCopyBenchmark.h"
+#include "BenchmarksRunner.h"
+#include "SyntheticDocument.h"
+#include "PDFWriter.h"
+#include "PDFUsedFont.h"
+#include "OutputStringBufferStream.h"
+#include "InputByteArrayStream.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+#define ENCRYPTED_COPY_DOCUMENT_PAGES 2000
+
+EncryptedCopyBenchmark::EncryptedCopyBenchmark(void)
+{
+	mPagesCount = 0;
+}
+
+EncryptedCopyBenchmark::~EncryptedCopyBenchmark(void)
+{
+}
+
+EStatusCode EncryptedCopyBenchmark::Setup(const BenchmarkConfiguration& inConfiguration)
+{
+	PDFWriter pdfWriter;
+	OutputStringBufferStream pdfStream;
+	EStatusCode status;
+
+	mPagesCount = inConfiguration.Scale(ENCRYPTED_COPY_DOCUMENT_PAGES);
+
+	do
+	{
+		status = pdfWriter.StartPDFForStream(&pdfStream,ePDFVersion16,LogConfiguration::DefaultLogConfiguration,
+												PDFCreationSettings(true,true,EncryptionOptions("user",4,"owner")));
+		if(status != eSuccess)
+			break;
+
+		PDFUsedFont* font = pdfWriter.GetFontForFile(inConfiguration.GetMaterialPath("fonts/arial.ttf"));
+		if(!font)
+		{
+			cout<<"failed to create font\n";
+			status = eFailure;
+			break;
+		}
+
+		status = SyntheticDocument::WriteTextPages(pdfWriter,font,mPagesCount);
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.EndPDFForStream();
+		if(status != eSuccess)
+			break;
+
+		mDocument = pdfStream.ToString();
+	}while(false);
+
+	return status;
+}
+
+EStatusCode EncryptedCopyBenchmark::RunIteration(unsigned long long& outOperations,unsigned long long& outBytes)
+{
+	InputByteArrayStream documentStream((IOBasicTypes::Byte*)mDocument.c_str(),mDocument.size());
+	OutputStringBufferStream pdfStream;
+
+	outOperations = mPagesCount;
+	outBytes = mDocument.size();
+
+	EStatusCode status = PDFWriter::RecryptPDF(&documentStream,"user",&pdfStream,LogConfiguration::DefaultLogConfiguration,
+												PDFCreationSettings(true,true,EncryptionOptions("user1",4,"owner1")));
+	if(status != eSuccess)
+		cout<<"failed to recrypt document\n";
+
+	return status;
+}
+
+void EncryptedCopyBenchmark::TearDown()
+{
+	mDocument.clear();
+}
+
+string EncryptedCopyBenchmark::GetOperationName()
+{
+	return "pages";
+}
+
+ADD_BENCHMARK(EncryptedCopyBenchmark)
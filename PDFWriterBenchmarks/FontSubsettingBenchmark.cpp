@@ -0,0 +1,142 @@
+/*
+   Source File : FontSubsettingBenchmark.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "FontSubsettingBenchmark.h"
+#include "BenchmarksRunner.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PageContentContext.h"
+#include "PDFUsedFont.h"
+#include "OutputStringBufferStream.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+#define FONT_SUBSETTING_DOCUMENTS 20
+
+struct BenchmarkFont
+{
+	const char* Path;
+	// extra text, beyond the printable ASCII characters, for fonts with more glyphs
+	const char* Text;
+};
+
+static const BenchmarkFont scFonts[] = {
+	{"fonts/arial.ttf",""}, // TrueType
+	{"fonts/BrushScriptStd.otf",""}, // CFF
+	{"fonts/KozGoPro-Regular.otf","\xE3\x81\x93\xE3\x82\x93\xE3\x81\xAB\xE3\x81\xA1\xE3\x81\xAF\xE4\xB8\x96\xE7\x95\x8C"} // CID keyed CFF
+};
+
+FontSubsettingBenchmark::FontSubsettingBenchmark(void)
+{
+	mDocumentsCount = 0;
+}
+
+FontSubsettingBenchmark::~FontSubsettingBenchmark(void)
+{
+}
+
+EStatusCode FontSubsettingBenchmark::Setup(const BenchmarkConfiguration& inConfiguration)
+{
+	for(size_t i = 0; i < sizeof(scFonts) / sizeof(scFonts[0]); ++i)
+		mFontsPaths.push_back(inConfiguration.GetMaterialPath(scFonts[i].Path));
+	mDocumentsCount = inConfiguration.Scale(FONT_SUBSETTING_DOCUMENTS);
+	return eSuccess;
+}
+
+EStatusCode FontSubsettingBenchmark::RunIteration(unsigned long long& outOperations,unsigned long long& outBytes)
+{
+	EStatusCode status = eSuccess;
+
+	string asciiText;
+	for(char c = ' '; c <= '~'; ++c)
+		asciiText.push_back(c);
+
+	outOperations = 0;
+	outBytes = 0;
+
+	for(unsigned long i = 0; i < mDocumentsCount && eSuccess == status; ++i)
+	{
+		PDFWriter pdfWriter;
+		OutputStringBufferStream pdfStream;
+
+		do
+		{
+			status = pdfWriter.StartPDFForStream(&pdfStream,ePDFVersion13);
+			if(status != eSuccess)
+				break;
+
+			PDFPage* page = new PDFPage();
+			page->SetMediaBox(PDFRectangle(0,0,595,842));
+			PageContentContext* contentContext = pdfWriter.StartPageContentContext(page);
+
+			for(size_t j = 0; j < mFontsPaths.size(); ++j)
+			{
+				PDFUsedFont* font = pdfWriter.GetFontForFile(mFontsPaths[j]);
+				if(!font)
+				{
+					cout<<"failed to create font for "<<mFontsPaths[j]<<"\n";
+					status = eFailure;
+					break;
+				}
+				AbstractContentContext::TextOptions textOptions(font,8,AbstractContentContext::eGray,0);
+				contentContext->WriteText(10,800 - j * 40,asciiText,textOptions);
+				contentContext->WriteText(10,780 - j * 40,scFonts[j].Text,textOptions);
+			}
+
+			EStatusCode contentStatus = pdfWriter.EndPageContentContext(contentContext);
+			if(eSuccess == status)
+				status = contentStatus;
+			if(status != eSuccess)
+			{
+				delete page;
+				break;
+			}
+
+			status = pdfWriter.WritePageAndRelease(page);
+			if(status != eSuccess)
+				break;
+
+			// fonts are subset and embedded when the document ends
+			status = pdfWriter.EndPDFForStream();
+			if(status != eSuccess)
+				break;
+
+			outOperations += pdfWriter.GetMetrics().GetCounters().GlyphsEmbedded;
+			outBytes += pdfStream.GetCurrentPosition();
+		}while(false);
+	}
+
+	return status;
+}
+
+void FontSubsettingBenchmark::TearDown()
+{
+	mFontsPaths.clear();
+}
+
+string FontSubsettingBenchmark::GetOperationName()
+{
+	return "glyphs";
+}
+
+ADD_BENCHMARK(FontSubsettingBenchmark)
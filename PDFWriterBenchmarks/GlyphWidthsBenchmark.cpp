@@ -0,0 +1,107 @@
+/*
+   Source File : GlyphWidthsBenchmark.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "GlyphWidthsBenchmark.h"
+#include "BenchmarksRunner.h"
+#include "FreeTypeFaceWrapper.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+#define GLYPH_WIDTHS_GLYPHS 1000000
+
+static const char* scFonts[] = {
+	"fonts/arial.ttf", // TrueType
+	"fonts/BrushScriptStd.otf", // CFF
+	"fonts/KozGoPro-Regular.otf" // CID keyed CFF
+};
+
+GlyphWidthsBenchmark::GlyphWidthsBenchmark(void)
+{
+	mFreeType = NULL;
+	mGlyphsCount = 0;
+}
+
+GlyphWidthsBenchmark::~GlyphWidthsBenchmark(void)
+{
+}
+
+EStatusCode GlyphWidthsBenchmark::Setup(const BenchmarkConfiguration& inConfiguration)
+{
+	mFreeType = new FreeTypeWrapper();
+	mGlyphsCount = inConfiguration.Scale(GLYPH_WIDTHS_GLYPHS);
+
+	for(size_t i = 0; i < sizeof(scFonts) / sizeof(scFonts[0]); ++i)
+	{
+		string fontPath = inConfiguration.GetMaterialPath(scFonts[i]);
+		FT_Face face = mFreeType->NewFace(fontPath,0);
+		if(!face)
+		{
+			cout<<"failed to load font from "<<fontPath<<"\n";
+			return eFailure;
+		}
+		mFaces.push_back(face);
+		mFontsPaths.push_back(fontPath);
+	}
+	return eSuccess;
+}
+
+EStatusCode GlyphWidthsBenchmark::RunIteration(unsigned long long& outOperations,unsigned long long& outBytes)
+{
+	FT_Pos widthsSum = 0;
+
+	outOperations = 0;
+	outBytes = 0;
+
+	for(size_t i = 0; i < mFaces.size(); ++i)
+	{
+		FreeTypeFaceWrapper wrapper(mFaces[i],mFontsPaths[i],0,false);
+
+		for(unsigned long j = 0; j < mGlyphsCount; ++j)
+			widthsSum += wrapper.GetGlyphWidth(3 + (j * 7) % 90);
+		outOperations += mGlyphsCount;
+	}
+
+	if(widthsSum <= 0)
+	{
+		cout<<"expected glyphs to have widths\n";
+		return eFailure;
+	}
+	return eSuccess;
+}
+
+void GlyphWidthsBenchmark::TearDown()
+{
+	for(size_t i = 0; i < mFaces.size(); ++i)
+		mFreeType->DoneFace(mFaces[i]);
+	mFaces.clear();
+	mFontsPaths.clear();
+	delete mFreeType;
+	mFreeType = NULL;
+}
+
+string GlyphWidthsBenchmark::GetOperationName()
+{
+	return "glyphs";
+}
+
+ADD_BENCHMARK(GlyphWidthsBenchmark)
@@ -0,0 +1,47 @@
+/*
+   Source File : GlyphWidthsBenchmark.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "IBenchmark.h"
+#include "FreeTypeWrapper.h"
+
+#include <string>
+#include <vector>
+
+// measures widths of text-like glyph sequences in TrueType and CFF fonts, as measuring text does.
+// faces are loaded once, the glyph widths of each face are read anew in every iteration
+class GlyphWidthsBenchmark : public IBenchmark
+{
+public:
+	GlyphWidthsBenchmark(void);
+	virtual ~GlyphWidthsBenchmark(void);
+
+	virtual PDFHummus::EStatusCode Setup(const BenchmarkConfiguration& inConfiguration);
+	virtual PDFHummus::EStatusCode RunIteration(unsigned long long& outOperations,unsigned long long& outBytes);
+	virtual void TearDown();
+	virtual std::string GetOperationName();
+
+private:
+	FreeTypeWrapper* mFreeType;
+	std::vector<FT_Face> mFaces;
+	std::vector<std::string> mFontsPaths;
+	unsigned long mGlyphsCount;
+};
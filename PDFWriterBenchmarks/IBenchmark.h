@@ -0,0 +1,46 @@
+/*
+   Source File : IBenchmark.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "EStatusCode.h"
+
+#include <string>
+
+struct BenchmarkConfiguration;
+
+class IBenchmark
+{
+public:
+	virtual ~IBenchmark(){}
+
+	// prepare the inputs of the workload, e.g. read materials or generate documents. not measured
+	virtual PDFHummus::EStatusCode Setup(const BenchmarkConfiguration& inConfiguration) = 0;
+
+	// run the workload once. this is what's measured. report the operations done [e.g. pages written] and bytes processed,
+	// so they can be turned to rates. workloads are deterministic, so all iterations should report the same
+	virtual PDFHummus::EStatusCode RunIteration(unsigned long long& outOperations,unsigned long long& outBytes) = 0;
+
+	// release whatever Setup prepared
+	virtual void TearDown() = 0;
+
+	// what an operation is, for the report. e.g. "pages"
+	virtual std::string GetOperationName() = 0;
+};
@@ -0,0 +1,167 @@
+/*
+   Source File : ImagesEmbeddingBenchmark.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "ImagesEmbeddingBenchmark.h"
+#include "BenchmarksRunner.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PageContentContext.h"
+#include "PDFFormXObject.h"
+#include "OutputStringBufferStream.h"
+#include "InputByteArrayStream.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+#define IMAGES_EMBEDDING_ROUNDS 10
+
+static const char* scJPEGImages[] = {
+	"images/soundcloud_logo.jpg",
+	"images/otherStage.JPG"
+};
+
+#ifndef PDFHUMMUS_NO_TIFF
+// bilevel fax encodings, color and LZW compressed images
+static const char* scTIFFImages[] = {
+	"images/tiff/CCITT_1.TIF",
+	"images/tiff/G4.TIF",
+	"images/tiff/FLAG_T24.TIF",
+	"images/tiff/MARBLES.TIF",
+	"images/tiff/quad-lzw.tif",
+	"images/tiff/ycbcr-cat.tif"
+};
+#endif
+
+ImagesEmbeddingBenchmark::ImagesEmbeddingBenchmark(void)
+{
+	mRoundsCount = 0;
+}
+
+ImagesEmbeddingBenchmark::~ImagesEmbeddingBenchmark(void)
+{
+}
+
+EStatusCode ImagesEmbeddingBenchmark::Setup(const BenchmarkConfiguration& inConfiguration)
+{
+	EStatusCode status = eSuccess;
+
+	for(size_t i = 0; i < sizeof(scJPEGImages) / sizeof(scJPEGImages[0]) && eSuccess == status; ++i)
+		status = AddImage(inConfiguration,scJPEGImages[i],false);
+#ifndef PDFHUMMUS_NO_TIFF
+	for(size_t i = 0; i < sizeof(scTIFFImages) / sizeof(scTIFFImages[0]) && eSuccess == status; ++i)
+		status = AddImage(inConfiguration,scTIFFImages[i],true);
+#endif
+	mRoundsCount = inConfiguration.Scale(IMAGES_EMBEDDING_ROUNDS);
+
+	return status;
+}
+
+EStatusCode ImagesEmbeddingBenchmark::AddImage(const BenchmarkConfiguration& inConfiguration,const string& inImagePath,bool inIsTIFF)
+{
+	BenchmarkImage image;
+	image.IsTIFF = inIsTIFF;
+	mImages.push_back(image);
+	return inConfiguration.ReadMaterial(inImagePath,mImages.back().Data);
+}
+
+EStatusCode ImagesEmbeddingBenchmark::RunIteration(unsigned long long& outOperations,unsigned long long& outBytes)
+{
+	PDFWriter pdfWriter;
+	OutputStringBufferStream pdfStream;
+	EStatusCode status;
+
+	outOperations = 0;
+	outBytes = 0;
+
+	do
+	{
+		status = pdfWriter.StartPDFForStream(&pdfStream,ePDFVersion13);
+		if(status != eSuccess)
+			break;
+
+		for(unsigned long i = 0; i < mRoundsCount && eSuccess == status; ++i)
+		{
+			ObjectIDTypeList formsIDs;
+
+			BenchmarkImageList::iterator it = mImages.begin();
+			for(; it != mImages.end(); ++it)
+			{
+				InputByteArrayStream imageStream((IOBasicTypes::Byte*)it->Data.c_str(),it->Data.size());
+				PDFFormXObject* form;
+#ifndef PDFHUMMUS_NO_TIFF
+				if(it->IsTIFF)
+					form = pdfWriter.CreateFormXObjectFromTIFFStream(&imageStream);
+				else
+#endif
+					form = pdfWriter.CreateFormXObjectFromJPGStream(&imageStream);
+				if(!form)
+				{
+					cout<<"failed to create image form\n";
+					status = eFailure;
+					break;
+				}
+				formsIDs.push_back(form->GetObjectID());
+				delete form;
+				++outOperations;
+				outBytes += it->Data.size();
+			}
+			if(status != eSuccess)
+				break;
+
+			PDFPage* page = new PDFPage();
+			page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+			PageContentContext* contentContext = pdfWriter.StartPageContentContext(page);
+			ObjectIDTypeList::iterator itForms = formsIDs.begin();
+			for(int j = 0; itForms != formsIDs.end(); ++itForms,++j)
+			{
+				contentContext->q();
+				contentContext->cm(0.1,0,0,0.1,10 + (j % 4) * 140,10 + (j / 4) * 200);
+				contentContext->Do(page->GetResourcesDictionary().AddFormXObjectMapping(*itForms));
+				contentContext->Q();
+			}
+			status = pdfWriter.EndPageContentContext(contentContext);
+			if(eSuccess == status)
+				status = pdfWriter.WritePageAndRelease(page);
+			else
+				delete page;
+		}
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.EndPDFForStream();
+	}while(false);
+
+	return status;
+}
+
+void ImagesEmbeddingBenchmark::TearDown()
+{
+	mImages.clear();
+}
+
+string ImagesEmbeddingBenchmark::GetOperationName()
+{
+	return "images";
+}
+
+ADD_BENCHMARK(ImagesEmbeddingBenchmark)
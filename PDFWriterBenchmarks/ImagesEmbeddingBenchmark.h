@@ -0,0 +1,53 @@
+/*
+   Source File : ImagesEmbeddingBenchmark.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "IBenchmark.h"
+
+#include <string>
+#include <list>
+
+struct BenchmarkImage
+{
+	bool IsTIFF;
+	std::string Data;
+};
+
+typedef std::list<BenchmarkImage> BenchmarkImageList;
+
+// embeds JPEG and TIFF images from TestMaterials, repeatedly, placing each round of them on a page
+class ImagesEmbeddingBenchmark : public IBenchmark
+{
+public:
+	ImagesEmbeddingBenchmark(void);
+	virtual ~ImagesEmbeddingBenchmark(void);
+
+	virtual PDFHummus::EStatusCode Setup(const BenchmarkConfiguration& inConfiguration);
+	virtual PDFHummus::EStatusCode RunIteration(unsigned long long& outOperations,unsigned long long& outBytes);
+	virtual void TearDown();
+	virtual std::string GetOperationName();
+
+private:
+	BenchmarkImageList mImages;
+	unsigned long mRoundsCount;
+
+	PDFHummus::EStatusCode AddImage(const BenchmarkConfiguration& inConfiguration,const std::string& inImagePath,bool inIsTIFF);
+};
@@ -0,0 +1,120 @@
+/*
+   Source File : MergePDFsBenchmark.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "MergePDFsBenchmark.h"
+#include "BenchmarksRunner.h"
+#include "PDFWriter.h"
+#include "OutputStringBufferStream.h"
+#include "InputByteArrayStream.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+#define MERGE_PDFS_ROUNDS 100
+
+static const char* scMergedDocuments[] = {
+	"AddedItem.pdf",
+	"AddedPage.pdf",
+	"Linearized.pdf",
+	"MultipleChange.pdf",
+	"ObjectStreams.pdf",
+	"ObjectStreamsModified.pdf",
+	"Original.pdf",
+	"RemovedItem.pdf",
+	"XObjectContent.PDF"
+};
+
+MergePDFsBenchmark::MergePDFsBenchmark(void)
+{
+	mRoundsCount = 0;
+}
+
+MergePDFsBenchmark::~MergePDFsBenchmark(void)
+{
+}
+
+EStatusCode MergePDFsBenchmark::Setup(const BenchmarkConfiguration& inConfiguration)
+{
+	EStatusCode status = eSuccess;
+
+	for(size_t i = 0; i < sizeof(scMergedDocuments) / sizeof(scMergedDocuments[0]) && eSuccess == status; ++i)
+	{
+		mDocuments.push_back(string());
+		status = inConfiguration.ReadMaterial(scMergedDocuments[i],mDocuments.back());
+	}
+	mRoundsCount = inConfiguration.Scale(MERGE_PDFS_ROUNDS);
+
+	return status;
+}
+
+EStatusCode MergePDFsBenchmark::RunIteration(unsigned long long& outOperations,unsigned long long& outBytes)
+{
+	PDFWriter pdfWriter;
+	OutputStringBufferStream pdfStream;
+	EStatusCode status;
+
+	outOperations = 0;
+	outBytes = 0;
+
+	do
+	{
+		status = pdfWriter.StartPDFForStream(&pdfStream,ePDFVersion13);
+		if(status != eSuccess)
+			break;
+
+		for(unsigned long i = 0; i < mRoundsCount && eSuccess == status; ++i)
+		{
+			StringList::iterator it = mDocuments.begin();
+			for(; it != mDocuments.end() && eSuccess == status; ++it)
+			{
+				InputByteArrayStream documentStream((IOBasicTypes::Byte*)it->c_str(),it->size());
+				EStatusCodeAndObjectIDTypeList result = pdfWriter.AppendPDFPagesFromPDF(&documentStream,PDFPageRange());
+				status = result.first;
+				if(status != eSuccess)
+				{
+					cout<<"failed to append pages\n";
+					break;
+				}
+				outOperations += result.second.size();
+				outBytes += it->size();
+			}
+		}
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.EndPDFForStream();
+	}while(false);
+
+	return status;
+}
+
+void MergePDFsBenchmark::TearDown()
+{
+	mDocuments.clear();
+}
+
+string MergePDFsBenchmark::GetOperationName()
+{
+	return "pages";
+}
+
+ADD_BENCHMARK(MergePDFsBenchmark)
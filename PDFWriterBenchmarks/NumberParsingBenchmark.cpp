@@ -0,0 +1,96 @@
+/*
+   Source File : NumberParsingBenchmark.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "NumberParsingBenchmark.h"
+#include "BenchmarksRunner.h"
+#include "PDFObjectParser.h"
+#include "PDFObject.h"
+#include "PDFArray.h"
+#include "RefCountPtr.h"
+#include "InputByteArrayStream.h"
+#include "AdapterIByteReaderWithPositionToIReadPositionProvider.h"
+
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+using namespace PDFHummus;
+
+#define NUMBER_PARSING_NUMBERS 1000000
+
+NumberParsingBenchmark::NumberParsingBenchmark(void)
+{
+	mNumbersCount = 0;
+}
+
+NumberParsingBenchmark::~NumberParsingBenchmark(void)
+{
+}
+
+EStatusCode NumberParsingBenchmark::Setup(const BenchmarkConfiguration& inConfiguration)
+{
+	stringstream source;
+
+	mNumbersCount = inConfiguration.Scale(NUMBER_PARSING_NUMBERS);
+	source<<"[";
+	for(unsigned long i = 0; i < mNumbersCount; ++i)
+	{
+		if(i % 2 == 0)
+			source<<i % 10000<<" ";
+		else
+			source<<(i % 1000)<<"."<<(i % 997)<<" ";
+	}
+	source<<"]";
+	mSource = source.str();
+	return eSuccess;
+}
+
+EStatusCode NumberParsingBenchmark::RunIteration(unsigned long long& outOperations,unsigned long long& outBytes)
+{
+	InputByteArrayStream stream((IOBasicTypes::Byte*)mSource.c_str(),mSource.size());
+	AdapterIByteReaderWithPositionToIReadPositionProvider positionProvider(&stream);
+	PDFObjectParser parser;
+
+	outOperations = 0;
+	outBytes = mSource.size();
+
+	parser.SetReadStream(&stream,&positionProvider,&stream);
+	RefCountPtr<PDFObject> anObject(parser.ParseNewObject());
+	if(!anObject || anObject->GetType() != PDFObject::ePDFObjectArray || ((PDFArray*)anObject.GetPtr())->GetLength() != mNumbersCount)
+	{
+		cout<<"failed to parse numbers array\n";
+		return eFailure;
+	}
+
+	outOperations = mNumbersCount;
+	return eSuccess;
+}
+
+void NumberParsingBenchmark::TearDown()
+{
+	mSource.clear();
+}
+
+string NumberParsingBenchmark::GetOperationName()
+{
+	return "numbers";
+}
+
+ADD_BENCHMARK(NumberParsingBenchmark)
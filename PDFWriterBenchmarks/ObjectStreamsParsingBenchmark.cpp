@@ -0,0 +1,126 @@
+/*
+   Source File : ObjectStreamsParsingBenchmark.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "ObjectStreamsParsingBenchmark.h"
+#include "BenchmarksRunner.h"
+#include "SyntheticDocument.h"
+#include "PDFWriter.h"
+#include "PDFUsedFont.h"
+#include "PDFParser.h"
+#include "PDFObject.h"
+#include "RefCountPtr.h"
+#include "OutputStringBufferStream.h"
+#include "InputByteArrayStream.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+#define OBJECT_STREAMS_DOCUMENT_PAGES 5000
+
+ObjectStreamsParsingBenchmark::ObjectStreamsParsingBenchmark(void)
+{
+}
+
+ObjectStreamsParsingBenchmark::~ObjectStreamsParsingBenchmark(void)
+{
+}
+
+EStatusCode ObjectStreamsParsingBenchmark::Setup(const BenchmarkConfiguration& inConfiguration)
+{
+	PDFWriter pdfWriter;
+	OutputStringBufferStream pdfStream;
+	PDFCreationSettings creationSettings(true,true,EncryptionOptions::DefaultEncryptionOptions,true);
+	EStatusCode status;
+
+	do
+	{
+		status = pdfWriter.StartPDFForStream(&pdfStream,ePDFVersion15,LogConfiguration::DefaultLogConfiguration,creationSettings);
+		if(status != eSuccess)
+			break;
+
+		PDFUsedFont* font = pdfWriter.GetFontForFile(inConfiguration.GetMaterialPath("fonts/arial.ttf"));
+		if(!font)
+		{
+			cout<<"failed to create font\n";
+			status = eFailure;
+			break;
+		}
+
+		status = SyntheticDocument::WriteTextPages(pdfWriter,font,inConfiguration.Scale(OBJECT_STREAMS_DOCUMENT_PAGES));
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.EndPDFForStream();
+		if(status != eSuccess)
+			break;
+
+		mDocument = pdfStream.ToString();
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ObjectStreamsParsingBenchmark::RunIteration(unsigned long long& outOperations,unsigned long long& outBytes)
+{
+	InputByteArrayStream documentStream((IOBasicTypes::Byte*)mDocument.c_str(),mDocument.size());
+	PDFParser parser;
+	EStatusCode status;
+
+	outOperations = 0;
+	outBytes = mDocument.size();
+
+	do
+	{
+		status = parser.StartPDFParsing(&documentStream,PDFParsingOptions::DefaultPDFParsingOptions,&documentStream);
+		if(status != eSuccess)
+		{
+			cout<<"failed to parse document\n";
+			break;
+		}
+
+		for(ObjectIDType i = 1; i < parser.GetObjectsCount(); ++i)
+		{
+			RefCountPtr<PDFObject> anObject(parser.ParseNewObject(i));
+			if(!anObject)
+			{
+				cout<<"failed to parse object "<<i<<"\n";
+				status = eFailure;
+				break;
+			}
+			++outOperations;
+		}
+	}while(false);
+
+	return status;
+}
+
+void ObjectStreamsParsingBenchmark::TearDown()
+{
+	mDocument.clear();
+}
+
+string ObjectStreamsParsingBenchmark::GetOperationName()
+{
+	return "objects";
+}
+
+ADD_BENCHMARK(ObjectStreamsParsingBenchmark)
@@ -0,0 +1,113 @@
+/*
+   Source File : ObjectsArenaBenchmark.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "ObjectsArenaBenchmark.h"
+#include "BenchmarksRunner.h"
+#include "PDFObjectParser.h"
+#include "PDFObjectsArena.h"
+#include "PDFObject.h"
+#include "InputByteArrayStream.h"
+#include "AdapterIByteReaderWithPositionToIReadPositionProvider.h"
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+using namespace PDFHummus;
+
+#define OBJECTS_ARENA_DICTIONARIES 20000
+
+typedef vector<PDFObject*> PDFObjectVector;
+
+ObjectsArenaBenchmark::ObjectsArenaBenchmark(void)
+{
+	mDictionariesCount = 0;
+}
+
+ObjectsArenaBenchmark::~ObjectsArenaBenchmark(void)
+{
+}
+
+EStatusCode ObjectsArenaBenchmark::Setup(const BenchmarkConfiguration& inConfiguration)
+{
+	stringstream source;
+
+	mDictionariesCount = inConfiguration.Scale(OBJECTS_ARENA_DICTIONARIES);
+	for(unsigned long i = 0; i < mDictionariesCount; ++i)
+	{
+		source<<"<< /Type /Font /Subtype /TrueType /BaseFont /F"<<i<<" /FirstChar 32 /LastChar 63 /FontDescriptor "<<i + 1<<" 0 R /Widths [";
+		for(unsigned long j = 0; j < 32; ++j)
+			source<<(j * 17 + i) % 1000<<" ";
+		source<<"] /Encoding /WinAnsiEncoding >>\n";
+	}
+	mSource = source.str();
+	return eSuccess;
+}
+
+EStatusCode ObjectsArenaBenchmark::RunIteration(unsigned long long& outOperations,unsigned long long& outBytes)
+{
+	InputByteArrayStream stream((IOBasicTypes::Byte*)mSource.c_str(),mSource.size());
+	AdapterIByteReaderWithPositionToIReadPositionProvider positionProvider(&stream);
+	PDFObjectParser parser;
+	PDFObjectsArena* arena = new PDFObjectsArena();
+	PDFObjectVector objects;
+	EStatusCode status = eSuccess;
+
+	outOperations = 0;
+	outBytes = mSource.size();
+
+	parser.SetReadStream(&stream,&positionProvider,&stream);
+	parser.SetObjectsArena(arena);
+	objects.reserve(mDictionariesCount);
+
+	// parse all, then release all, like objects of a parsing session
+	for(unsigned long i = 0; i < mDictionariesCount; ++i)
+	{
+		PDFObject* anObject = parser.ParseNewObject();
+		if(!anObject)
+		{
+			cout<<"failed to parse dictionary "<<i<<"\n";
+			status = eFailure;
+			break;
+		}
+		objects.push_back(anObject);
+	}
+
+	for(PDFObjectVector::iterator it = objects.begin(); it != objects.end(); ++it)
+		(*it)->Release();
+	arena->ReleaseArena();
+
+	if(eSuccess == status)
+		outOperations = mDictionariesCount;
+	return status;
+}
+
+void ObjectsArenaBenchmark::TearDown()
+{
+	mSource.clear();
+}
+
+string ObjectsArenaBenchmark::GetOperationName()
+{
+	return "dictionaries";
+}
+
+ADD_BENCHMARK(ObjectsArenaBenchmark)
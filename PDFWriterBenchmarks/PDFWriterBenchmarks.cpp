@@ -0,0 +1,103 @@
+/*
+   Source File : PDFWriterBenchmarks.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+// PDFWriterBenchmarks.cpp : Defines the entry point for the benchmarks console application.
+//
+#include "BenchmarksRunner.h"
+#include "Singleton.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <fstream>
+
+using namespace std;
+using namespace PDFHummus;
+
+static void PrintUsage()
+{
+	cout<<"Usage:\n"<<
+		"PDFWriterBenchmarks -b BasePath [-i iterations] [-s scale] [-o report.json] [-t benchmark1 benchmark2...]\n\n"<<
+		"PDFWriterBenchmarks runs benchmarks, and reports their rates in JSON, for comparing runs.\n"<<
+		"Use -b to designate the folder that has the TestMaterials folder, e.g. the source root.\n"<<
+		"Use -i to set the number of measured iterations per benchmark. default is "<<DEFAULT_BENCHMARK_ITERATIONS<<".\n"<<
+		"Use -s to scale the workloads. for example, -s 0.1 runs workloads at a tenth of their size. default is 1.\n"<<
+		"Use -o to write the JSON report to a file. otherwise it is written as the last line of the output.\n"<<
+		"Use -t to run only the named benchmarks. otherwise all benchmarks run.\n";
+}
+
+int main(int argc, char* argv[])
+{
+	BenchmarkConfiguration configuration;
+	StringList benchmarks;
+	string reportPath;
+	bool hasBase = false;
+	bool argumentsOK = true;
+
+	for(int i = 1; i < argc && argumentsOK; ++i)
+	{
+		if(strcmp(argv[i],"-t") == 0)
+		{
+			for(++i; i < argc; ++i)
+				benchmarks.push_back(argv[i]);
+		}
+		else if(i + 1 >= argc)
+			argumentsOK = false;
+		else if(strcmp(argv[i],"-b") == 0)
+		{
+			configuration.mMaterialsBase = argv[++i];
+			hasBase = true;
+		}
+		else if(strcmp(argv[i],"-i") == 0)
+			configuration.mIterations = strtoul(argv[++i],NULL,10);
+		else if(strcmp(argv[i],"-s") == 0)
+			configuration.mScale = strtod(argv[++i],NULL);
+		else if(strcmp(argv[i],"-o") == 0)
+			reportPath = argv[++i];
+		else
+			argumentsOK = false;
+	}
+
+	if(!argumentsOK || !hasBase || 0 == configuration.mIterations || configuration.mScale <= 0)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	BenchmarkResultList results;
+	EStatusCode status = Singleton<BenchmarksRunner>::GetInstance()->Run(configuration,benchmarks,results);
+	Singleton<BenchmarksRunner>::Reset();
+
+	string report = BenchmarksRunner::ToJSON(configuration,results);
+	if(reportPath.empty())
+		cout<<report<<"\n";
+	else
+	{
+		ofstream reportFile(reportPath.c_str());
+		reportFile<<report<<"\n";
+		if(!reportFile)
+		{
+			cout<<"failed to write report to "<<reportPath<<"\n";
+			status = eFailure;
+		}
+	}
+
+	return eSuccess == status ? 0 : 1;
+}
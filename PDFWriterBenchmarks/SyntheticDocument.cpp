@@ -0,0 +1,78 @@
+/*
+   Source File : SyntheticDocument.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "SyntheticDocument.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PageContentContext.h"
+#include "PDFUsedFont.h"
+
+using namespace std;
+using namespace PDFHummus;
+
+#define SYNTHETIC_DOCUMENT_SEED 20111
+
+static const char* scWords[] = {
+	"portable","document","format","page","object","stream","dictionary","array","font","glyph",
+	"image","content","resource","xref","trailer","catalog","the","of","and","a",
+	"to","in","is","with","for","on","text","write","parse","compress",
+	"Hummus","PDF"
+};
+static const unsigned long scWordsCount = sizeof(scWords) / sizeof(scWords[0]);
+
+string SyntheticDocument::GenerateLine(unsigned long& ioSeed)
+{
+	string line;
+
+	for(int i = 0; i < SYNTHETIC_DOCUMENT_WORDS_PER_LINE; ++i)
+	{
+		// plain LCG. its sequence is the same on all platforms, unlike rand()
+		ioSeed = (ioSeed * 1103515245 + 12345) & 0x7fffffff;
+		if(i > 0)
+			line.push_back(' ');
+		line.append(scWords[(ioSeed >> 16) % scWordsCount]);
+	}
+	return line;
+}
+
+EStatusCode SyntheticDocument::WriteTextPages(PDFWriter& inWriter,PDFUsedFont* inFont,unsigned long inPagesCount)
+{
+	EStatusCode status = eSuccess;
+	unsigned long seed = SYNTHETIC_DOCUMENT_SEED;
+	AbstractContentContext::TextOptions textOptions(inFont,10,AbstractContentContext::eGray,0);
+
+	for(unsigned long i = 0; i < inPagesCount && eSuccess == status; ++i)
+	{
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+		PageContentContext* contentContext = inWriter.StartPageContentContext(page);
+		for(int j = 0; j < SYNTHETIC_DOCUMENT_LINES_PER_PAGE; ++j)
+			contentContext->WriteText(40,800 - j * 19,GenerateLine(seed),textOptions);
+
+		status = inWriter.EndPageContentContext(contentContext);
+		if(eSuccess == status)
+			status = inWriter.WritePageAndRelease(page);
+		else
+			delete page;
+	}
+
+	return status;
+}
@@ -0,0 +1,42 @@
+/*
+   Source File : SyntheticDocument.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "EStatusCode.h"
+
+#include <string>
+
+class PDFWriter;
+class PDFUsedFont;
+
+#define SYNTHETIC_DOCUMENT_LINES_PER_PAGE 40
+#define SYNTHETIC_DOCUMENT_WORDS_PER_LINE 10
+
+// generated text documents for the benchmarks. the text is pseudo random with a fixed seed, so documents are the same between runs
+class SyntheticDocument
+{
+public:
+	// writes pages of text lines in inFont, starting from the same text every time
+	static PDFHummus::EStatusCode WriteTextPages(PDFWriter& inWriter,PDFUsedFont* inFont,unsigned long inPagesCount);
+
+	// next line of words, advancing ioSeed
+	static std::string GenerateLine(unsigned long& ioSeed);
+};
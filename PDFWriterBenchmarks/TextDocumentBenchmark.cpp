@@ -0,0 +1,92 @@
+/*
+   Source File : TextDocumentBenchmark.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "TextDocumentBenchmark.h"
+#include "BenchmarksRunner.h"
+#include "SyntheticDocument.h"
+#include "PDFWriter.h"
+#include "PDFUsedFont.h"
+#include "OutputStringBufferStream.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+#define TEXT_DOCUMENT_PAGES 10000
+
+TextDocumentBenchmark::TextDocumentBenchmark(void)
+{
+	mPagesCount = 0;
+}
+
+TextDocumentBenchmark::~TextDocumentBenchmark(void)
+{
+}
+
+EStatusCode TextDocumentBenchmark::Setup(const BenchmarkConfiguration& inConfiguration)
+{
+	mFontPath = inConfiguration.GetMaterialPath("fonts/arial.ttf");
+	mPagesCount = inConfiguration.Scale(TEXT_DOCUMENT_PAGES);
+	return eSuccess;
+}
+
+EStatusCode TextDocumentBenchmark::RunIteration(unsigned long long& outOperations,unsigned long long& outBytes)
+{
+	PDFWriter pdfWriter;
+	OutputStringBufferStream pdfStream;
+	EStatusCode status;
+
+	do
+	{
+		status = pdfWriter.StartPDFForStream(&pdfStream,ePDFVersion13);
+		if(status != eSuccess)
+			break;
+
+		PDFUsedFont* font = pdfWriter.GetFontForFile(mFontPath);
+		if(!font)
+		{
+			cout<<"failed to create font for "<<mFontPath<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		status = SyntheticDocument::WriteTextPages(pdfWriter,font,mPagesCount);
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.EndPDFForStream();
+	}while(false);
+
+	outOperations = mPagesCount;
+	outBytes = pdfStream.GetCurrentPosition();
+	return status;
+}
+
+void TextDocumentBenchmark::TearDown()
+{
+}
+
+string TextDocumentBenchmark::GetOperationName()
+{
+	return "pages";
+}
+
+ADD_BENCHMARK(TextDocumentBenchmark)
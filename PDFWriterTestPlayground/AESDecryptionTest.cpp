@@ -0,0 +1,222 @@
+/*
+Source File : AESDecryptionTest.cpp
+
+
+Copyright 2016 Gal Kahana PDFWriter
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+*/
+#include "AESDecryptionTest.h"
+#include "TestsRunner.h"
+#include "PDFParser.h"
+#include "InputFile.h"
+#include "PDFDictionary.h"
+#include "PDFStreamInput.h"
+#include "PDFLiteralString.h"
+#include "PDFHexString.h"
+#include "PDFObjectCast.h"
+#include "IByteReader.h"
+#include "DecryptionHelper.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+AESDecryptionTest::AESDecryptionTest(void)
+{
+}
+
+AESDecryptionTest::~AESDecryptionTest(void)
+{
+}
+
+EStatusCode AESDecryptionTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = eSuccess;
+	string aesV2Path = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/ProtectedAESV2.pdf");
+	string aesV3Path = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/ProtectedAESV3.pdf");
+
+	// AES-128 (V4/R4). note that owner password decryption for R <= 4 derives the key as if it was the user password, so just checking the user password here
+	if(TestDecryptingFile(aesV2Path,"user",false) != eSuccess)
+	{
+		cout<<"AESDecryptionTest, failed decrypting AESV2 file with user password\n";
+		status = eFailure;
+	}
+
+	if(TestWrongPassword(aesV2Path) != eSuccess)
+	{
+		cout<<"AESDecryptionTest, wrong password check failed for AESV2 file\n";
+		status = eFailure;
+	}
+
+	// AES-256 (V5/R6)
+	if(TestDecryptingFile(aesV3Path,"user",false) != eSuccess)
+	{
+		cout<<"AESDecryptionTest, failed decrypting AESV3 file with user password\n";
+		status = eFailure;
+	}
+
+	if(TestDecryptingFile(aesV3Path,"owner",true) != eSuccess)
+	{
+		cout<<"AESDecryptionTest, failed decrypting AESV3 file with owner password\n";
+		status = eFailure;
+	}
+
+	if(TestWrongPassword(aesV3Path) != eSuccess)
+	{
+		cout<<"AESDecryptionTest, wrong password check failed for AESV3 file\n";
+		status = eFailure;
+	}
+
+	return status;
+}
+
+EStatusCode AESDecryptionTest::TestDecryptingFile(const string& inFilePath,const string& inPassword,bool inExpectOwner)
+{
+	EStatusCode status = eSuccess;
+	InputFile pdfFile;
+	PDFParser parser;
+	IByteReader* streamReader = NULL;
+
+	do
+	{
+		status = pdfFile.OpenFile(inFilePath);
+		if(status != eSuccess)
+		{
+			cout<<"unable to open file "<<inFilePath.c_str()<<"\n";
+			break;
+		}
+
+		status = parser.StartPDFParsing(pdfFile.GetInputStream(),PDFParsingOptions(inPassword));
+		if(status != eSuccess)
+		{
+			cout<<"unable to parse "<<inFilePath.c_str()<<"\n";
+			break;
+		}
+
+		if(!parser.IsEncrypted() || !parser.GetDecryptionHelper().CanDecryptDocument())
+		{
+			cout<<"expected an encrypted document that can be decrypted\n";
+			status = eFailure;
+			break;
+		}
+
+		if(parser.GetDecryptionHelper().DidSucceedOwnerPasswordVerification() != inExpectOwner)
+		{
+			cout<<"unexpected owner password verification result\n";
+			status = eFailure;
+			break;
+		}
+
+		// page contents, long enough to be decrypted in multiple chunks
+		PDFObjectCastPtr<PDFDictionary> page(parser.ParsePage(0));
+		if(!page)
+		{
+			cout<<"failed to parse first page\n";
+			status = eFailure;
+			break;
+		}
+
+		PDFObjectCastPtr<PDFStreamInput> contents(parser.QueryDictionaryObject(page.GetPtr(),"Contents"));
+		if(!contents)
+		{
+			cout<<"failed to read page contents stream\n";
+			status = eFailure;
+			break;
+		}
+
+		streamReader = parser.StartReadingFromStream(contents.GetPtr());
+		if(!streamReader)
+		{
+			cout<<"failed to start reading page contents stream\n";
+			status = eFailure;
+			break;
+		}
+
+		string decrypted;
+		IOBasicTypes::Byte buffer[1000];
+		while(streamReader->NotEnded())
+		{
+			IOBasicTypes::LongBufferSizeType readAmount = streamReader->Read(buffer,1000);
+			decrypted.append((const char*)buffer,(size_t)readAmount);
+		}
+
+		if(decrypted.find("BT /F1 24 Tf 100 700 Td (Hello AES) Tj ET\n") != 0)
+		{
+			cout<<"unexpected page contents start after decryption\n";
+			status = eFailure;
+			break;
+		}
+
+		string expectedEnd = "99 599 m 193 397 l S\n";
+		if(decrypted.size() < expectedEnd.size() || decrypted.compare(decrypted.size() - expectedEnd.size(),expectedEnd.size(),expectedEnd) != 0)
+		{
+			cout<<"unexpected page contents end after decryption\n";
+			status = eFailure;
+			break;
+		}
+
+		// strings
+		PDFObjectCastPtr<PDFDictionary> info(parser.QueryDictionaryObject(parser.GetTrailer(),"Info"));
+		if(!info)
+		{
+			cout<<"failed to read info dictionary\n";
+			status = eFailure;
+			break;
+		}
+
+		PDFObjectCastPtr<PDFHexString> title(parser.QueryDictionaryObject(info.GetPtr(),"Title"));
+		if(!title || title->GetValue() != "AES Title")
+		{
+			cout<<"failed to decrypt title string\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	delete streamReader;
+	return status;
+}
+
+EStatusCode AESDecryptionTest::TestWrongPassword(const string& inFilePath)
+{
+	EStatusCode status = eSuccess;
+	InputFile pdfFile;
+	PDFParser parser;
+
+	do
+	{
+		status = pdfFile.OpenFile(inFilePath);
+		if(status != eSuccess)
+		{
+			cout<<"unable to open file "<<inFilePath.c_str()<<"\n";
+			break;
+		}
+
+		parser.StartPDFParsing(pdfFile.GetInputStream(),PDFParsingOptions("wrong"));
+
+		if(!parser.IsEncrypted() || parser.GetDecryptionHelper().CanDecryptDocument() || !parser.GetDecryptionHelper().DidFailPasswordVerification())
+		{
+			cout<<"expected password verification failure\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(AESDecryptionTest,"Xcryption")
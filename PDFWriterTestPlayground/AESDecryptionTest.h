@@ -0,0 +1,37 @@
+/*
+Source File : AESDecryptionTest.h
+
+
+Copyright 2016 Gal Kahana PDFWriter
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+*/
+#pragma once
+#include "ITestUnit.h"
+
+#include <string>
+
+class AESDecryptionTest : public ITestUnit
+{
+public:
+	AESDecryptionTest(void);
+	virtual ~AESDecryptionTest(void);
+
+	virtual PDFHummus::EStatusCode Run(const TestConfiguration& inTestConfiguration);
+
+private:
+	PDFHummus::EStatusCode TestDecryptingFile(const std::string& inFilePath,const std::string& inPassword,bool inExpectOwner);
+	PDFHummus::EStatusCode TestWrongPassword(const std::string& inFilePath);
+};
@@ -0,0 +1,448 @@
+/*
+   Source File : CompactSerializationTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "CompactSerializationTest.h"
+#include "TestsRunner.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PageContentContext.h"
+#include "XObjectContentContext.h"
+#include "PDFFormXObject.h"
+#include "PDFUsedFont.h"
+#include "DictionaryContext.h"
+#include "TrailerInformation.h"
+#include "InfoDictionary.h"
+#include "PDFParser.h"
+#include "PDFObjectParser.h"
+#include "DecryptionHelper.h"
+#include "PDFDictionary.h"
+#include "PDFArray.h"
+#include "PDFObjectCast.h"
+#include "PDFStreamInput.h"
+#include "PDFIndirectObjectReference.h"
+#include "PDFBoolean.h"
+#include "PDFInteger.h"
+#include "PDFReal.h"
+#include "PDFName.h"
+#include "PDFLiteralString.h"
+#include "PDFHexString.h"
+#include "PDFSymbol.h"
+#include "InputFile.h"
+#include "InputByteArrayStream.h"
+#include "AdapterIByteReaderWithPositionToIReadPositionProvider.h"
+#include "ObjectParsingHelper.h"
+#include "RefCountPtr.h"
+#include "Timer.h"
+
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+using namespace PDFHummus;
+
+#define DOCUMENT_PAGES 20
+
+CompactSerializationTest::CompactSerializationTest(void)
+{
+}
+
+CompactSerializationTest::~CompactSerializationTest(void)
+{
+}
+
+EStatusCode CompactSerializationTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = eSuccess;
+
+	do
+	{
+		// same document, regularly and compactly written, with and without object streams
+		for(int i = 0; i < 2 && eSuccess == status; ++i)
+		{
+			bool useObjectStreams = (1 == i);
+			string filePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,useObjectStreams ? "CompactSerializationTestObjectStreams.pdf" : "CompactSerializationTest.pdf");
+			string compactFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,useObjectStreams ? "CompactSerializationTestObjectStreamsCompact.pdf" : "CompactSerializationTestCompact.pdf");
+			Timer timer,compactTimer;
+
+			timer.StartMeasure();
+			status = WriteDocument(inTestConfiguration,filePath,false,useObjectStreams);
+			timer.StopMeasureAndAccumulate();
+			if(status != eSuccess)
+				break;
+
+			compactTimer.StartMeasure();
+			status = WriteDocument(inTestConfiguration,compactFilePath,true,useObjectStreams);
+			compactTimer.StopMeasureAndAccumulate();
+			if(status != eSuccess)
+				break;
+
+			InputFile file,compactFile;
+			file.OpenFile(filePath);
+			compactFile.OpenFile(compactFilePath);
+			LongFilePositionType fileSize = file.GetFileSize();
+			LongFilePositionType compactFileSize = compactFile.GetFileSize();
+			file.CloseFile();
+			compactFile.CloseFile();
+
+			cout<<(useObjectStreams ? "With object streams, w" : "W")<<"rote "<<fileSize<<" bytes in "<<timer.GetTotalMiliSeconds()<<"ms, and compactly "<<
+				compactFileSize<<" bytes in "<<compactTimer.GetTotalMiliSeconds()<<"ms\n";
+			if(compactFileSize >= fileSize)
+			{
+				cout<<"expected compact serialization to write less bytes\n";
+				status = eFailure;
+				break;
+			}
+
+			status = CompareDocuments(filePath,compactFilePath);
+		}
+		if(status != eSuccess)
+			break;
+
+		status = TestDuplicateKeys(inTestConfiguration);
+	}while(false);
+
+	return status;
+}
+
+EStatusCode CompactSerializationTest::WriteDocument(const TestConfiguration& inTestConfiguration,const string& inFilePath,bool inCompact,bool inUseObjectStreams)
+{
+	PDFWriter pdfWriter;
+	PDFCreationSettings creationSettings(true,true,EncryptionOptions::DefaultEncryptionOptions,inUseObjectStreams);
+	EStatusCode status;
+
+	do
+	{
+		creationSettings.CompactSerialization = inCompact;
+		status = pdfWriter.StartPDF(inFilePath,ePDFVersion15,LogConfiguration::DefaultLogConfiguration,creationSettings);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF\n";
+			break;
+		}
+
+		pdfWriter.GetDocumentContext().GetTrailerInformation().GetInfo().Title = "Compact (serialization) test";
+
+		PDFUsedFont* font = pdfWriter.GetFontForFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/arial.ttf"));
+		PDFUsedFont* cidFont = pdfWriter.GetFontForFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/KozGoPro-Regular.otf"));
+		if(!font || !cidFont)
+		{
+			cout<<"failed to create fonts\n";
+			status = eFailure;
+			break;
+		}
+		string imagePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/images/soundcloud_logo.jpg");
+
+		PDFFormXObject* form = pdfWriter.StartFormXObject(PDFRectangle(0,0,200,100));
+		XObjectContentContext* formContentContext = form->GetContentContext();
+		formContentContext->q();
+		formContentContext->k(0,100,100,0);
+		formContentContext->re(0,0,200,100);
+		formContentContext->f();
+		formContentContext->Q();
+		ObjectIDType formObjectID = form->GetObjectID();
+		status = pdfWriter.EndFormXObjectAndRelease(form);
+		if(status != eSuccess)
+		{
+			cout<<"failed to write form\n";
+			break;
+		}
+
+		for(int i = 0; i < DOCUMENT_PAGES && eSuccess == status; ++i)
+		{
+			PDFPage* page = new PDFPage();
+			page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+			PageContentContext* contentContext = pdfWriter.StartPageContentContext(page);
+			contentContext->WriteText(75,805,"Hello (compact) world",AbstractContentContext::TextOptions(font,14,AbstractContentContext::eGray,0));
+			contentContext->WriteText(75,705,"\xE3\x81\x93\xE3\x82\x93\xE3\x81\xAB\xE3\x81\xA1\xE3\x81\xAF",AbstractContentContext::TextOptions(cidFont,14,AbstractContentContext::eRGB,0xFF0000));
+			contentContext->q();
+			contentContext->cm(0.5,0,0,0.5,200,400);
+			contentContext->Do(page->GetResourcesDictionary().AddFormXObjectMapping(formObjectID));
+			contentContext->Q();
+			contentContext->DrawImage(10,100,imagePath);
+			status = pdfWriter.EndPageContentContext(contentContext);
+			if(eSuccess == status)
+				status = pdfWriter.WritePageAndRelease(page);
+		}
+		if(status != eSuccess)
+		{
+			cout<<"failed to write pages\n";
+			break;
+		}
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+			cout<<"failed to end PDF\n";
+	}while(false);
+
+	return status;
+}
+
+EStatusCode CompactSerializationTest::TestDuplicateKeys(const TestConfiguration& inTestConfiguration)
+{
+	PDFWriter pdfWriter;
+	PDFCreationSettings creationSettings(true,true);
+	EStatusCode status;
+
+	do
+	{
+		creationSettings.CompactSerialization = true;
+		status = pdfWriter.StartPDF(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"CompactSerializationTestKeys.pdf"),ePDFVersion13,LogConfiguration::DefaultLogConfiguration,creationSettings);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF\n";
+			break;
+		}
+
+		ObjectsContext& objectsContext = pdfWriter.GetObjectsContext();
+		objectsContext.StartNewIndirectObject();
+		DictionaryContext* dictionary = objectsContext.StartDictionary();
+
+		// keys that are prefixes of one another, to check that keys are matched whole
+		if(dictionary->WriteKey("AB") != eSuccess || dictionary->HasKey("A") || dictionary->HasKey("B"))
+			status = eFailure;
+		else
+			dictionary->WriteIntegerValue(1);
+		if(eSuccess == status && (dictionary->WriteKey("A") != eSuccess || !dictionary->HasKey("A") || !dictionary->HasKey("AB") || dictionary->HasKey("ABC")))
+			status = eFailure;
+		else
+			dictionary->WriteIntegerValue(2);
+		if(eSuccess == status && (dictionary->WriteKey("AB") == eSuccess || dictionary->WriteKey("A") == eSuccess))
+			status = eFailure;
+
+		// enough keys for a large dictionary, to check that keys written before and after it grows are all tracked
+		for(int i=0; i < 100 && eSuccess == status; ++i)
+		{
+			stringstream key;
+			key<<"K"<<i;
+			if(dictionary->WriteKey(key.str()) != eSuccess)
+				status = eFailure;
+			else
+				dictionary->WriteIntegerValue(i);
+		}
+		if(eSuccess == status && (!dictionary->HasKey("A") || !dictionary->HasKey("AB") || !dictionary->HasKey("K0") || !dictionary->HasKey("K99") ||
+									dictionary->HasKey("K100") || dictionary->WriteKey("K50") == eSuccess))
+			status = eFailure;
+
+		objectsContext.EndDictionary(dictionary);
+		objectsContext.EndIndirectObject();
+		if(status != eSuccess)
+		{
+			cout<<"dictionary keys are not tracked correctly\n";
+			break;
+		}
+
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,595,842));
+		status = pdfWriter.WritePageAndRelease(page);
+		if(eSuccess == status)
+			status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+			cout<<"failed to write PDF\n";
+	}while(false);
+
+	return status;
+}
+
+void CompactSerializationTest::CollectSerializationDependentObjects(PDFParser& inParser,set<ObjectIDType>& outObjects)
+{
+	// stream lengths are expected to differ, as compact content streams are shorter. object streams hold
+	// the objects serialized, and xref streams their positions, so they differ too [the objects in object streams are compared on their own]
+	for(ObjectIDType i = 1; i < inParser.GetObjectsCount(); ++i)
+	{
+		PDFObjectCastPtr<PDFStreamInput> stream(inParser.ParseNewObject(i));
+		if(!stream)
+			continue;
+
+		RefCountPtr<PDFDictionary> streamDictionary(stream->QueryStreamDictionary());
+		PDFObjectCastPtr<PDFIndirectObjectReference> length(streamDictionary->QueryDirectObject("Length"));
+		if(!!length)
+			outObjects.insert(length->mObjectID);
+
+		PDFObjectCastPtr<PDFName> type(streamDictionary->QueryDirectObject("Type"));
+		if(!!type && (type->GetValue() == "ObjStm" || type->GetValue() == "XRef"))
+			outObjects.insert(i);
+	}
+}
+
+EStatusCode CompactSerializationTest::CompareDocuments(const string& inFilePath,const string& inCompactFilePath)
+{
+	EStatusCode status = eSuccess;
+	InputFile pdfFile,compactPDFFile;
+	PDFParser parser,compactParser;
+
+	do
+	{
+		status = pdfFile.OpenFile(inFilePath);
+		if(status == eSuccess)
+			status = parser.StartPDFParsing(pdfFile.GetInputStream());
+		if(status == eSuccess)
+			status = compactPDFFile.OpenFile(inCompactFilePath);
+		if(status == eSuccess)
+			status = compactParser.StartPDFParsing(compactPDFFile.GetInputStream());
+		if(status != eSuccess)
+		{
+			cout<<"unable to parse "<<inFilePath<<" or its compact version\n";
+			break;
+		}
+
+		if(parser.GetObjectsCount() != compactParser.GetObjectsCount() || parser.GetPagesCount() != compactParser.GetPagesCount())
+		{
+			cout<<"objects or pages count differ between "<<inFilePath<<" and its compact version\n";
+			status = eFailure;
+			break;
+		}
+
+		set<ObjectIDType> skippedObjects;
+		CollectSerializationDependentObjects(parser,skippedObjects);
+
+		for(ObjectIDType i = 1; i < parser.GetObjectsCount() && eSuccess == status; ++i)
+		{
+			if(skippedObjects.find(i) != skippedObjects.end())
+				continue;
+
+			RefCountPtr<PDFObject> anObject(parser.ParseNewObject(i));
+			RefCountPtr<PDFObject> compactObject(compactParser.ParseNewObject(i));
+			if(!anObject && !compactObject)
+				continue;
+			if(!anObject || !compactObject || !CompareObjects(parser,anObject.GetPtr(),compactParser,compactObject.GetPtr()))
+			{
+				cout<<"object "<<i<<" differs between "<<inFilePath<<" and its compact version\n";
+				status = eFailure;
+			}
+		}
+	}while(false);
+
+	return status;
+}
+
+bool CompactSerializationTest::CompareObjects(PDFParser& inParser,PDFObject* inObject,PDFParser& inCompactParser,PDFObject* inCompactObject)
+{
+	if(inObject->GetType() != inCompactObject->GetType())
+		return false;
+
+	switch(inObject->GetType())
+	{
+		case PDFObject::ePDFObjectBoolean:
+			return ((PDFBoolean*)inObject)->GetValue() == ((PDFBoolean*)inCompactObject)->GetValue();
+		case PDFObject::ePDFObjectLiteralString:
+			return ((PDFLiteralString*)inObject)->GetValue() == ((PDFLiteralString*)inCompactObject)->GetValue();
+		case PDFObject::ePDFObjectHexString:
+			return ((PDFHexString*)inObject)->GetValue() == ((PDFHexString*)inCompactObject)->GetValue();
+		case PDFObject::ePDFObjectName:
+			return ((PDFName*)inObject)->GetValue() == ((PDFName*)inCompactObject)->GetValue();
+		case PDFObject::ePDFObjectInteger:
+			return ((PDFInteger*)inObject)->GetValue() == ((PDFInteger*)inCompactObject)->GetValue();
+		case PDFObject::ePDFObjectReal:
+			return ((PDFReal*)inObject)->GetValue() == ((PDFReal*)inCompactObject)->GetValue();
+		case PDFObject::ePDFObjectSymbol:
+			return ((PDFSymbol*)inObject)->GetValue() == ((PDFSymbol*)inCompactObject)->GetValue();
+		case PDFObject::ePDFObjectIndirectObjectReference:
+			return ((PDFIndirectObjectReference*)inObject)->mObjectID == ((PDFIndirectObjectReference*)inCompactObject)->mObjectID;
+		case PDFObject::ePDFObjectArray:
+		{
+			PDFArray* anArray = (PDFArray*)inObject;
+			PDFArray* compactArray = (PDFArray*)inCompactObject;
+			if(anArray->GetLength() != compactArray->GetLength())
+				return false;
+			for(unsigned long i = 0; i < anArray->GetLength(); ++i)
+			{
+				RefCountPtr<PDFObject> item(anArray->QueryObject(i));
+				RefCountPtr<PDFObject> compactItem(compactArray->QueryObject(i));
+				if(!CompareObjects(inParser,item.GetPtr(),inCompactParser,compactItem.GetPtr()))
+					return false;
+			}
+			return true;
+		}
+		case PDFObject::ePDFObjectDictionary:
+		{
+			PDFDictionary* aDictionary = (PDFDictionary*)inObject;
+			PDFDictionary* compactDictionary = (PDFDictionary*)inCompactObject;
+			MapIterator<PDFNameToPDFObjectMap> it = aDictionary->GetIterator();
+			unsigned long keysCount = 0;
+			while(it.MoveNext())
+			{
+				RefCountPtr<PDFObject> compactValue(compactDictionary->QueryDirectObject(it.GetKey()->GetValue()));
+				if(!compactValue || !CompareObjects(inParser,it.GetValue(),inCompactParser,compactValue.GetPtr()))
+					return false;
+				++keysCount;
+			}
+			MapIterator<PDFNameToPDFObjectMap> itCompact = compactDictionary->GetIterator();
+			while(itCompact.MoveNext())
+				--keysCount;
+			return 0 == keysCount;
+		}
+		case PDFObject::ePDFObjectStream:
+			return CompareStreams(inParser,(PDFStreamInput*)inObject,inCompactParser,(PDFStreamInput*)inCompactObject);
+		default:
+			return true;
+	}
+}
+
+bool CompactSerializationTest::CompareStreams(PDFParser& inParser,PDFStreamInput* inStream,PDFParser& inCompactParser,PDFStreamInput* inCompactStream)
+{
+	RefCountPtr<PDFDictionary> streamDictionary(inStream->QueryStreamDictionary());
+	RefCountPtr<PDFDictionary> compactStreamDictionary(inCompactStream->QueryStreamDictionary());
+	MapIterator<PDFNameToPDFObjectMap> it = streamDictionary->GetIterator();
+	while(it.MoveNext())
+	{
+		if(it.GetKey()->GetValue() == "Length")
+			continue;
+		RefCountPtr<PDFObject> compactValue(compactStreamDictionary->QueryDirectObject(it.GetKey()->GetValue()));
+		if(!compactValue || !CompareObjects(inParser,it.GetValue(),inCompactParser,compactValue.GetPtr()))
+			return false;
+	}
+
+	string data,compactData;
+	if(ObjectParsingHelper::ReadStream(inParser,inStream,data) != eSuccess ||
+		ObjectParsingHelper::ReadStream(inCompactParser,inCompactStream,compactData) != eSuccess)
+		return false;
+	if(data == compactData)
+		return true;
+
+	// content streams are written compactly too, so compare them by their operators and operands
+	InputByteArrayStream stream((IOBasicTypes::Byte*)data.c_str(),data.size());
+	AdapterIByteReaderWithPositionToIReadPositionProvider positionProvider(&stream);
+	PDFObjectParser contentParser;
+	InputByteArrayStream compactStream((IOBasicTypes::Byte*)compactData.c_str(),compactData.size());
+	AdapterIByteReaderWithPositionToIReadPositionProvider compactPositionProvider(&compactStream);
+	PDFObjectParser compactContentParser;
+
+	DecryptionHelper noDecryption;
+
+	contentParser.SetReadStream(&stream,&positionProvider,&stream);
+	contentParser.SetDecryptionHelper(&noDecryption);
+	compactContentParser.SetReadStream(&compactStream,&compactPositionProvider,&compactStream);
+	compactContentParser.SetDecryptionHelper(&noDecryption);
+
+	unsigned long tokensCount = 0;
+	while(true)
+	{
+		RefCountPtr<PDFObject> anObject(contentParser.ParseNewObject());
+		RefCountPtr<PDFObject> compactObject(compactContentParser.ParseNewObject());
+		if(!anObject || !compactObject)
+			return !anObject && !compactObject && tokensCount > 0;
+		if(!CompareObjects(inParser,anObject.GetPtr(),inCompactParser,compactObject.GetPtr()))
+			return false;
+		++tokensCount;
+	}
+}
+
+ADD_CATEGORIZED_TEST(CompactSerializationTest,"PDF")
@@ -0,0 +1,48 @@
+/*
+   Source File : CompactSerializationTest.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "ITestUnit.h"
+#include "ObjectsBasicTypes.h"
+
+#include <string>
+#include <set>
+
+class PDFParser;
+class PDFObject;
+class PDFStreamInput;
+
+class CompactSerializationTest : public ITestUnit
+{
+public:
+	CompactSerializationTest(void);
+	virtual ~CompactSerializationTest(void);
+
+	virtual PDFHummus::EStatusCode Run(const TestConfiguration& inTestConfiguration);
+
+private:
+	PDFHummus::EStatusCode WriteDocument(const TestConfiguration& inTestConfiguration,const std::string& inFilePath,bool inCompact,bool inUseObjectStreams);
+	PDFHummus::EStatusCode TestDuplicateKeys(const TestConfiguration& inTestConfiguration);
+	PDFHummus::EStatusCode CompareDocuments(const std::string& inFilePath,const std::string& inCompactFilePath);
+	bool CompareObjects(PDFParser& inParser,PDFObject* inObject,PDFParser& inCompactParser,PDFObject* inCompactObject);
+	bool CompareStreams(PDFParser& inParser,PDFStreamInput* inStream,PDFParser& inCompactParser,PDFStreamInput* inCompactStream);
+	void CollectSerializationDependentObjects(PDFParser& inParser,std::set<ObjectIDType>& outObjects);
+};
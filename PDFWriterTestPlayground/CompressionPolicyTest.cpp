@@ -0,0 +1,441 @@
+/*
+   Source File : CompressionPolicyTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "CompressionPolicyTest.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PDFRectangle.h"
+#include "PageContentContext.h"
+#include "PDFParser.h"
+#include "InputFile.h"
+#include "PDFObject.h"
+#include "PDFDictionary.h"
+#include "PDFInteger.h"
+#include "PDFName.h"
+#include "PDFStreamInput.h"
+#include "PDFObjectCast.h"
+#include "RefCountPtr.h"
+#include "PDFFormXObject.h"
+#include "IByteReader.h"
+#include "IByteReaderWithPosition.h"
+
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+using namespace IOBasicTypes;
+using namespace PDFHummus;
+
+#define RECTANGLES_COUNT 5000
+
+CompressionPolicyTest::CompressionPolicyTest(void)
+{
+}
+
+CompressionPolicyTest::~CompressionPolicyTest(void)
+{
+}
+
+EStatusCode CompressionPolicyTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+
+	do
+	{
+		// fast and best policies should both produce valid files, with the best one smaller
+		status = CreateFile(inTestConfiguration,"CompressionPolicyFast.pdf",FlateCompressionPolicy::FastCompressionPolicy);
+		if(status != eSuccess)
+			break;
+
+		status = CreateFile(inTestConfiguration,"CompressionPolicyBest.pdf",FlateCompressionPolicy::BestCompressionPolicy);
+		if(status != eSuccess)
+			break;
+
+		LongFilePositionType fastSize = GetFileSize(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"CompressionPolicyFast.pdf"));
+		LongFilePositionType bestSize = GetFileSize(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"CompressionPolicyBest.pdf"));
+		if(0 == fastSize || 0 == bestSize || bestSize >= fastSize)
+		{
+			cout<<"expected best compression to produce a smaller file than fast compression. best = "<<bestSize<<", fast = "<<fastSize<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		status = VerifyCategoryCompression(inTestConfiguration);
+		if(status != eSuccess)
+			break;
+
+		status = VerifyStateRecordsPolicy(inTestConfiguration);
+#ifndef PDFHUMMUS_NO_TIFF
+		if(status != eSuccess)
+			break;
+
+		status = VerifyTIFFImageCompression(inTestConfiguration);
+#endif
+	}while(false);
+
+	return status;
+}
+
+EStatusCode CompressionPolicyTest::CreateFile(const TestConfiguration& inTestConfiguration,
+											  const string& inFileName,
+											  const FlateCompressionPolicy& inCompressionPolicy)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+
+	do
+	{
+		PDFCreationSettings creationSettings(true,true);
+		creationSettings.CompressionPolicy = inCompressionPolicy;
+
+		status = pdfWriter.StartPDF(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileName),
+									ePDFVersion13,
+									LogConfiguration::DefaultLogConfiguration,
+									creationSettings);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF\n";
+			break;
+		}
+
+		PDFUsedFont* font = pdfWriter.GetFontForFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/arial.ttf"));
+		if(!font)
+		{
+			status = eFailure;
+			cout<<"failed to create font object for arial.ttf\n";
+			break;
+		}
+
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+		PageContentContext* contentContext = pdfWriter.StartPageContentContext(page);
+		contentContext->WriteText(75,805,"Compression Policy",AbstractContentContext::TextOptions(font,14,AbstractContentContext::eGray,0));
+		for(int i = 0; i < RECTANGLES_COUNT; ++i)
+			contentContext->re(i % 500,(i * 7) % 800,10,10);
+		contentContext->S();
+
+		status = pdfWriter.EndPageContentContext(contentContext);
+		if(status != eSuccess)
+		{
+			cout<<"failed to end content context\n";
+			delete page;
+			break;
+		}
+
+		status = pdfWriter.WritePageAndRelease(page);
+		if(status != eSuccess)
+		{
+			cout<<"failed to write page\n";
+			break;
+		}
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+			cout<<"failed in end PDF\n";
+	}while(false);
+
+	return status;
+}
+
+LongFilePositionType CompressionPolicyTest::GetFileSize(const string& inFilePath)
+{
+	InputFile file;
+	if(file.OpenFile(inFilePath) != eSuccess)
+		return 0;
+	return file.GetFileSize();
+}
+
+bool CompressionPolicyTest::GetStreamSizes(PDFParser& inParser,PDFStreamInput* inStream,long long& outEncodedSize,long long& outDecodedSize)
+{
+	RefCountPtr<PDFDictionary> streamDictionary(inStream->QueryStreamDictionary());
+	PDFObjectCastPtr<PDFInteger> length(inParser.QueryDictionaryObject(streamDictionary.GetPtr(),"Length"));
+	if(!length)
+		return false;
+	outEncodedSize = length->GetValue();
+
+	IByteReader* streamReader = inParser.StartReadingFromStream(inStream);
+	if(!streamReader)
+		return false;
+
+	Byte buffer[4096];
+	outDecodedSize = 0;
+	while(streamReader->NotEnded())
+	{
+		LongBufferSizeType readAmount = streamReader->Read(buffer,4096);
+		if(0 == readAmount)
+			break;
+		outDecodedSize += readAmount;
+	}
+	delete streamReader;
+	return true;
+}
+
+EStatusCode CompressionPolicyTest::VerifyCategoryCompression(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+	string filePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"CompressionPolicyCategories.pdf");
+
+	do
+	{
+		// store page content without compression (level 0), and compress the rest with best compression
+		FlateCompressionPolicy policy(FlateCompressionParameters(9));
+		policy.SetParameters(eStreamCategoryPageContent,FlateCompressionParameters(0));
+
+		status = CreateFile(inTestConfiguration,"CompressionPolicyCategories.pdf",policy);
+		if(status != eSuccess)
+			break;
+
+		InputFile pdfFile;
+		PDFParser parser;
+
+		status = pdfFile.OpenFile(filePath);
+		if(status != eSuccess)
+		{
+			cout<<"unable to open file for reading - "<<filePath<<"\n";
+			break;
+		}
+
+		status = parser.StartPDFParsing(pdfFile.GetInputStream());
+		if(status != eSuccess)
+		{
+			cout<<"unable to parse file - "<<filePath<<"\n";
+			break;
+		}
+
+		// page content is stored, so its encoded size is larger than its decoded size
+		RefCountPtr<PDFDictionary> page(parser.ParsePage(0));
+		PDFObjectCastPtr<PDFStreamInput> contents(page.GetPtr() ? parser.QueryDictionaryObject(page.GetPtr(),"Contents") : NULL);
+		long long encodedSize,decodedSize;
+		if(!contents || !GetStreamSizes(parser,contents.GetPtr(),encodedSize,decodedSize))
+		{
+			cout<<"failed to read page contents stream\n";
+			status = eFailure;
+			break;
+		}
+		if(encodedSize <= decodedSize)
+		{
+			cout<<"expected page contents to be stored without compression. encoded "<<encodedSize<<" bytes, decoded "<<decodedSize<<" bytes\n";
+			status = eFailure;
+			break;
+		}
+
+		// the embedded font program (FontFile2 stream, marked by Length1) is compressed
+		bool foundFontProgram = false;
+		for(ObjectIDType i = 1; i < parser.GetObjectsCount() && eSuccess == status; ++i)
+		{
+			PDFObjectCastPtr<PDFStreamInput> aStream(parser.ParseNewObject(i));
+			if(!aStream)
+				continue;
+			RefCountPtr<PDFDictionary> streamDictionary(aStream->QueryStreamDictionary());
+			if(!streamDictionary->Exists("Length1"))
+				continue;
+
+			foundFontProgram = true;
+			if(!GetStreamSizes(parser,aStream.GetPtr(),encodedSize,decodedSize))
+			{
+				cout<<"failed to read font program stream\n";
+				status = eFailure;
+			}
+			else if(encodedSize >= decodedSize)
+			{
+				cout<<"expected font program to be compressed. encoded "<<encodedSize<<" bytes, decoded "<<decodedSize<<" bytes\n";
+				status = eFailure;
+			}
+		}
+		if(status != eSuccess)
+			break;
+
+		if(!foundFontProgram)
+		{
+			cout<<"failed to find embedded font program\n";
+			status = eFailure;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode CompressionPolicyTest::VerifyStateRecordsPolicy(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+	string filePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"CompressionPolicyShutdownRestart.pdf");
+	string statePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"CompressionPolicyShutdownRestartState.txt");
+
+	FlateCompressionPolicy policy(FlateCompressionParameters(1));
+	policy.SetParameters(eStreamCategoryFont,FlateCompressionParameters(9,1,9));
+	policy.SetParameters(eStreamCategoryXref,FlateCompressionParameters(-1,3,8));
+
+	do
+	{
+		{
+			PDFWriter pdfWriter;
+			PDFCreationSettings creationSettings(true,true);
+			creationSettings.CompressionPolicy = policy;
+
+			status = pdfWriter.StartPDF(filePath,ePDFVersion13,LogConfiguration::DefaultLogConfiguration,creationSettings);
+			if(status != eSuccess)
+			{
+				cout<<"failed to start PDF\n";
+				break;
+			}
+
+			status = pdfWriter.Shutdown(statePath);
+			if(status != eSuccess)
+			{
+				cout<<"failed to shutdown PDF\n";
+				break;
+			}
+		}
+
+		{
+			PDFWriter pdfWriter;
+
+			status = pdfWriter.ContinuePDF(filePath,statePath);
+			if(status != eSuccess)
+			{
+				cout<<"failed to continue PDF\n";
+				break;
+			}
+
+			if(!(pdfWriter.GetObjectsContext().GetCompressionPolicy() == policy))
+			{
+				cout<<"compression policy was not restored from state\n";
+				status = eFailure;
+				break;
+			}
+
+			PDFPage* page = new PDFPage();
+			page->SetMediaBox(PDFRectangle(0,0,595,842));
+			status = pdfWriter.WritePageAndRelease(page);
+			if(status != eSuccess)
+			{
+				cout<<"failed to write page\n";
+				break;
+			}
+
+			status = pdfWriter.EndPDF();
+			if(status != eSuccess)
+				cout<<"failed in end PDF\n";
+		}
+	}while(false);
+
+	return status;
+}
+
+#ifndef PDFHUMMUS_NO_TIFF
+EStatusCode CompressionPolicyTest::VerifyTIFFImageCompression(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = eSuccess;
+
+	// an image that is re-encoded [not passed through]. with image level 0 it should be stored with no filter, like other level 0 streams
+	for(int level = 0; level <= 9 && eSuccess == status; level += 9)
+	{
+		string filePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,level == 0 ? "CompressionPolicyTIFFStored.pdf" : "CompressionPolicyTIFFBest.pdf");
+
+		do
+		{
+			FlateCompressionPolicy policy;
+			policy.SetParameters(eStreamCategoryImage,FlateCompressionParameters(level));
+			PDFCreationSettings creationSettings(true,true);
+			creationSettings.CompressionPolicy = policy;
+
+			PDFWriter pdfWriter;
+			status = pdfWriter.StartPDF(filePath,ePDFVersion13,LogConfiguration::DefaultLogConfiguration,creationSettings);
+			if(status != eSuccess)
+			{
+				cout<<"failed to start PDF\n";
+				break;
+			}
+
+			PDFFormXObject* imageForm = pdfWriter.CreateFormXObjectFromTIFFFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/images/tiff/FLAG_T24.TIF"));
+			if(!imageForm)
+			{
+				cout<<"failed to create form from TIFF image\n";
+				status = eFailure;
+				break;
+			}
+			ObjectIDType imageFormID = imageForm->GetObjectID();
+			delete imageForm;
+
+			PDFPage* page = new PDFPage();
+			page->SetMediaBox(PDFRectangle(0,0,595,842));
+			PageContentContext* contentContext = pdfWriter.StartPageContentContext(page);
+			contentContext->Do(page->GetResourcesDictionary().AddFormXObjectMapping(imageFormID));
+			status = pdfWriter.EndPageContentContext(contentContext);
+			if(eSuccess == status)
+				status = pdfWriter.WritePageAndRelease(page);
+			else
+				delete page;
+			if(status != eSuccess)
+			{
+				cout<<"failed to write page\n";
+				break;
+			}
+
+			status = pdfWriter.EndPDF();
+			if(status != eSuccess)
+			{
+				cout<<"failed in end PDF\n";
+				break;
+			}
+
+			InputFile pdfFile;
+			PDFParser parser;
+			status = pdfFile.OpenFile(filePath);
+			if(status == eSuccess)
+				status = parser.StartPDFParsing(pdfFile.GetInputStream());
+			if(status != eSuccess)
+			{
+				cout<<"unable to parse file - "<<filePath<<"\n";
+				break;
+			}
+
+			bool foundImage = false;
+			for(ObjectIDType i = 1; i < parser.GetObjectsCount() && !foundImage; ++i)
+			{
+				PDFObjectCastPtr<PDFStreamInput> aStream(parser.ParseNewObject(i));
+				if(!aStream)
+					continue;
+				RefCountPtr<PDFDictionary> streamDictionary(aStream->QueryStreamDictionary());
+				PDFObjectCastPtr<PDFName> subtype(streamDictionary->QueryDirectObject("Subtype"));
+				if(!subtype || subtype->GetValue() != "Image")
+					continue;
+
+				foundImage = true;
+				if(streamDictionary->Exists("Filter") != (level != 0))
+				{
+					cout<<"expected TIFF image with level "<<level<<" to be written "<<(level != 0 ? "with" : "without")<<" a filter\n";
+					status = eFailure;
+				}
+			}
+			if(eSuccess == status && !foundImage)
+			{
+				cout<<"failed to find TIFF image stream\n";
+				status = eFailure;
+			}
+		}while(false);
+	}
+
+	return status;
+}
+#endif
+
+ADD_CATEGORIZED_TEST(CompressionPolicyTest,"PDF")
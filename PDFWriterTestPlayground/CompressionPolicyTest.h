@@ -0,0 +1,51 @@
+/*
+   Source File : CompressionPolicyTest.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "TestsRunner.h"
+#include "FlateCompressionPolicy.h"
+#include "IOBasicTypes.h"
+
+#include <string>
+
+class PDFParser;
+class PDFStreamInput;
+
+class CompressionPolicyTest : public ITestUnit
+{
+public:
+	CompressionPolicyTest(void);
+	virtual ~CompressionPolicyTest(void);
+
+	virtual PDFHummus::EStatusCode Run(const TestConfiguration& inTestConfiguration);
+
+private:
+	PDFHummus::EStatusCode CreateFile(const TestConfiguration& inTestConfiguration,
+									  const std::string& inFileName,
+									  const FlateCompressionPolicy& inCompressionPolicy);
+	PDFHummus::EStatusCode VerifyCategoryCompression(const TestConfiguration& inTestConfiguration);
+	PDFHummus::EStatusCode VerifyStateRecordsPolicy(const TestConfiguration& inTestConfiguration);
+#ifndef PDFHUMMUS_NO_TIFF
+	PDFHummus::EStatusCode VerifyTIFFImageCompression(const TestConfiguration& inTestConfiguration);
+#endif
+	IOBasicTypes::LongFilePositionType GetFileSize(const std::string& inFilePath);
+	bool GetStreamSizes(PDFParser& inParser,PDFStreamInput* inStream,long long& outEncodedSize,long long& outDecodedSize);
+};
@@ -0,0 +1,407 @@
+/*
+   Source File : CopiedObjectsDeduplicationTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "CopiedObjectsDeduplicationTest.h"
+#include "TestsRunner.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PDFFormXObject.h"
+#include "PDFDocumentCopyingContext.h"
+#include "PageContentContext.h"
+#include "DocumentContext.h"
+#include "CopiedObjectsRegistry.h"
+#include "PDFParser.h"
+#include "InputFile.h"
+#include "PDFDictionary.h"
+#include "PDFIndirectObjectReference.h"
+#include "PDFObjectCast.h"
+#include "PDFStreamInput.h"
+#include "PDFName.h"
+#include "RefCountPtr.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+CopiedObjectsDeduplicationTest::CopiedObjectsDeduplicationTest(void)
+{
+}
+
+CopiedObjectsDeduplicationTest::~CopiedObjectsDeduplicationTest(void)
+{
+}
+
+EStatusCode CopiedObjectsDeduplicationTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+	string sourceAPath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"DeduplicationSourceA.pdf");
+	string sourceBPath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"DeduplicationSourceB.pdf");
+	string deduplicatedPath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"DeduplicatedCopy.pdf");
+	string plainPath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"NonDeduplicatedCopy.pdf");
+	string mergedOncePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"DeduplicatedMergeOnce.pdf");
+	string mergedTwicePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"DeduplicatedMergeTwice.pdf");
+	string formMergedOncePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"DeduplicatedFormMergeOnce.pdf");
+	string formMergedTwicePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"DeduplicatedFormMergeTwice.pdf");
+	unsigned long deduplicatedObjects;
+
+	do
+	{
+		// two separately generated files with the same image and font
+		status = CreateSourceFile(inTestConfiguration,sourceAPath);
+		if(status != eSuccess)
+		{
+			cout<<"failed to create first source file\n";
+			break;
+		}
+
+		status = CreateSourceFile(inTestConfiguration,sourceBPath);
+		if(status != eSuccess)
+		{
+			cout<<"failed to create second source file\n";
+			break;
+		}
+
+		status = AppendSourceFiles(plainPath,sourceAPath,sourceBPath,false,deduplicatedObjects);
+		if(status != eSuccess)
+		{
+			cout<<"failed to append source files without deduplication\n";
+			break;
+		}
+
+		if(deduplicatedObjects != 0)
+		{
+			cout<<"expected no deduplication when not enabled, got "<<deduplicatedObjects<<" deduplicated objects\n";
+			status = eFailure;
+			break;
+		}
+
+		status = AppendSourceFiles(deduplicatedPath,sourceAPath,sourceBPath,true,deduplicatedObjects);
+		if(status != eSuccess)
+		{
+			cout<<"failed to append source files with deduplication\n";
+			break;
+		}
+
+		if(deduplicatedObjects == 0)
+		{
+			cout<<"expected deduplicated objects when enabled\n";
+			status = eFailure;
+			break;
+		}
+
+		status = CheckSharedImage(deduplicatedPath);
+		if(status != eSuccess)
+			break;
+
+		InputFile deduplicatedFile;
+		InputFile plainFile;
+		if(deduplicatedFile.OpenFile(deduplicatedPath) != eSuccess || plainFile.OpenFile(plainPath) != eSuccess)
+		{
+			cout<<"failed to open result files\n";
+			status = eFailure;
+			break;
+		}
+
+		// the image makes most of the file size, and should be written once instead of 3 times
+		if(deduplicatedFile.GetFileSize()*2 > plainFile.GetFileSize())
+		{
+			cout<<"expected deduplicated file to be significantly smaller. deduplicated size = "<<
+				deduplicatedFile.GetFileSize()<<", plain size = "<<plainFile.GetFileSize()<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		// merging copies the page resources directly, and not through appending. merging the same page twice, each time in its own
+		// copying context, should write its xobjects once
+		status = MergeSourceFile(mergedOncePath,sourceAPath,1,false);
+		if(status != eSuccess)
+		{
+			cout<<"failed to merge source file once\n";
+			break;
+		}
+
+		status = MergeSourceFile(mergedTwicePath,sourceAPath,2,false);
+		if(status != eSuccess)
+		{
+			cout<<"failed to merge source file twice\n";
+			break;
+		}
+
+		unsigned long singleMergeXObjectsCount = CountXObjects(mergedOncePath);
+		unsigned long doubleMergeXObjectsCount = CountXObjects(mergedTwicePath);
+		if(0 == singleMergeXObjectsCount || singleMergeXObjectsCount != doubleMergeXObjectsCount)
+		{
+			cout<<"expected merged xobjects to be written once. single merge xobjects = "<<singleMergeXObjectsCount<<
+				", double merge xobjects = "<<doubleMergeXObjectsCount<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		// merging the page into a form xobject registers its resources directly in the form. each merge creates a new
+		// form, but the resources it refers to (the image wrapping form and the image) should be written once
+		status = MergeSourceFile(formMergedOncePath,sourceAPath,1,true);
+		if(status != eSuccess)
+		{
+			cout<<"failed to merge source page to form once\n";
+			break;
+		}
+
+		status = MergeSourceFile(formMergedTwicePath,sourceAPath,2,true);
+		if(status != eSuccess)
+		{
+			cout<<"failed to merge source page to form twice\n";
+			break;
+		}
+
+		unsigned long singleFormMergeXObjectsCount = CountXObjects(formMergedOncePath);
+		unsigned long doubleFormMergeXObjectsCount = CountXObjects(formMergedTwicePath);
+		if(0 == singleFormMergeXObjectsCount || singleFormMergeXObjectsCount + 1 != doubleFormMergeXObjectsCount)
+		{
+			cout<<"expected form merged resources to be written once. single merge xobjects = "<<singleFormMergeXObjectsCount<<
+				", double merge xobjects = "<<doubleFormMergeXObjectsCount<<"\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode CopiedObjectsDeduplicationTest::CreateSourceFile(const TestConfiguration& inTestConfiguration,const string& inSourcePath)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+
+	do
+	{
+		status = pdfWriter.StartPDF(inSourcePath,ePDFVersion13);
+		if(status != eSuccess)
+			break;
+
+		PDFUsedFont* font = pdfWriter.GetFontForFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/arial.ttf"));
+		if(!font)
+		{
+			status = eFailure;
+			break;
+		}
+
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+		PageContentContext* contentContext = pdfWriter.StartPageContentContext(page);
+		contentContext->DrawImage(10,100,RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/images/otherStage.JPG"));
+		contentContext->WriteText(10,50,"Hello deduplicated world",AbstractContentContext::TextOptions(font,14));
+
+		status = pdfWriter.EndPageContentContext(contentContext);
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.WritePageAndRelease(page);
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.EndPDF();
+	}while(false);
+
+	return status;
+}
+
+EStatusCode CopiedObjectsDeduplicationTest::AppendSourceFiles(const string& inTargetPath,
+															  const string& inSourceAPath,
+															  const string& inSourceBPath,
+															  bool inDeduplicate,
+															  unsigned long& outDeduplicatedObjects)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+	PDFCreationSettings creationSettings(true,true);
+	creationSettings.DeduplicateCopiedObjects = inDeduplicate;
+
+	do
+	{
+		status = pdfWriter.StartPDF(inTargetPath,ePDFVersion13,LogConfiguration::DefaultLogConfiguration,creationSettings);
+		if(status != eSuccess)
+			break;
+
+		// each append is a separate copying context. the same file twice, and then an equivalent file
+		if(pdfWriter.AppendPDFPagesFromPDF(inSourceAPath,PDFPageRange()).first != eSuccess ||
+			pdfWriter.AppendPDFPagesFromPDF(inSourceAPath,PDFPageRange()).first != eSuccess ||
+			pdfWriter.AppendPDFPagesFromPDF(inSourceBPath,PDFPageRange()).first != eSuccess)
+		{
+			status = eFailure;
+			break;
+		}
+
+		const CopiedObjectsDeduplicationStatistics& statistics = pdfWriter.GetDocumentContext().GetCopiedObjectsRegistry().GetStatistics();
+		outDeduplicatedObjects = statistics.DeduplicatedObjects;
+		if(inDeduplicate && statistics.SavedStreamBytes == 0)
+		{
+			cout<<"expected saved stream bytes to be counted\n";
+			status = eFailure;
+			break;
+		}
+
+		status = pdfWriter.EndPDF();
+	}while(false);
+
+	return status;
+}
+
+EStatusCode CopiedObjectsDeduplicationTest::MergeSourceFile(const string& inTargetPath,const string& inSourcePath,int inTimes,bool inAsFormXObjects)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+	PDFCreationSettings creationSettings(true,true);
+	creationSettings.DeduplicateCopiedObjects = true;
+
+	do
+	{
+		status = pdfWriter.StartPDF(inTargetPath,ePDFVersion13,LogConfiguration::DefaultLogConfiguration,creationSettings);
+		if(status != eSuccess)
+			break;
+
+		for(int i = 0; i < inTimes && eSuccess == status; ++i)
+		{
+			PDFPage* page = new PDFPage();
+			page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+			if(inAsFormXObjects)
+				status = MergeSourcePageToFormXObject(pdfWriter,inSourcePath);
+			else
+				status = pdfWriter.MergePDFPagesToPage(page,inSourcePath,PDFPageRange());
+			if(status != eSuccess)
+			{
+				delete page;
+				break;
+			}
+
+			status = pdfWriter.WritePageAndRelease(page);
+		}
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.EndPDF();
+	}while(false);
+
+	return status;
+}
+
+EStatusCode CopiedObjectsDeduplicationTest::MergeSourcePageToFormXObject(PDFWriter& inPDFWriter,const string& inSourcePath)
+{
+	EStatusCode status = eFailure;
+	PDFDocumentCopyingContext* copyingContext = inPDFWriter.CreatePDFCopyingContext(inSourcePath);
+	if(!copyingContext)
+		return eFailure;
+
+	PDFFormXObject* formXObject = inPDFWriter.StartFormXObject(PDFRectangle(0,0,595,842));
+	if(formXObject)
+	{
+		status = copyingContext->MergePDFPageToFormXObject(formXObject,0);
+		if(status == eSuccess)
+			status = inPDFWriter.EndFormXObjectAndRelease(formXObject);
+		else
+			delete formXObject;
+	}
+
+	delete copyingContext;
+	return status;
+}
+
+unsigned long CopiedObjectsDeduplicationTest::CountXObjects(const string& inPDFPath)
+{
+	InputFile pdfFile;
+	PDFParser parser;
+	unsigned long xobjectsCount = 0;
+
+	if(pdfFile.OpenFile(inPDFPath) != eSuccess || parser.StartPDFParsing(pdfFile.GetInputStream()) != eSuccess)
+	{
+		cout<<"failed to parse "<<inPDFPath<<"\n";
+		return 0;
+	}
+
+	for(ObjectIDType i = 1; i < parser.GetObjectsCount(); ++i)
+	{
+		PDFObjectCastPtr<PDFStreamInput> stream(parser.ParseNewObject(i));
+		if(!stream)
+			continue;
+
+		RefCountPtr<PDFDictionary> streamDictionary(stream->QueryStreamDictionary());
+		PDFObjectCastPtr<PDFName> subtype(streamDictionary->QueryDirectObject("Subtype"));
+		if(!!subtype && (subtype->GetValue() == "Image" || subtype->GetValue() == "Form"))
+			++xobjectsCount;
+	}
+
+	return xobjectsCount;
+}
+
+EStatusCode CopiedObjectsDeduplicationTest::CheckSharedImage(const string& inPDFPath)
+{
+	InputFile pdfFile;
+	PDFParser parser;
+
+	if(pdfFile.OpenFile(inPDFPath) != eSuccess || parser.StartPDFParsing(pdfFile.GetInputStream()) != eSuccess)
+	{
+		cout<<"failed to parse "<<inPDFPath<<"\n";
+		return eFailure;
+	}
+
+	if(parser.GetPagesCount() != 3)
+	{
+		cout<<"expected 3 pages, got "<<parser.GetPagesCount()<<"\n";
+		return eFailure;
+	}
+
+	ObjectIDType firstImageObjectID = 0;
+	for(unsigned long i = 0; i < parser.GetPagesCount(); ++i)
+	{
+		PDFObjectCastPtr<PDFDictionary> page(parser.ParsePage(i));
+		PDFObjectCastPtr<PDFDictionary> resources(parser.QueryDictionaryObject(page.GetPtr(),"Resources"));
+		PDFObjectCastPtr<PDFDictionary> xobjects(resources.GetPtr() ? parser.QueryDictionaryObject(resources.GetPtr(),"XObject") : NULL);
+		if(!xobjects)
+		{
+			cout<<"missing xobjects for page "<<i<<"\n";
+			return eFailure;
+		}
+
+		// the page draws a single image, through a form
+		MapIterator<PDFNameToPDFObjectMap> it(xobjects->GetIterator());
+		if(!it.MoveNext() || it.GetValue()->GetType() != PDFObject::ePDFObjectIndirectObjectReference)
+		{
+			cout<<"unexpected xobjects for page "<<i<<"\n";
+			return eFailure;
+		}
+
+		ObjectIDType imageObjectID = ((PDFIndirectObjectReference*)it.GetValue())->mObjectID;
+		if(0 == i)
+		{
+			firstImageObjectID = imageObjectID;
+		}
+		else if(imageObjectID != firstImageObjectID)
+		{
+			cout<<"expected all pages to share the same xobject, page "<<i<<" uses "<<imageObjectID<<" instead of "<<firstImageObjectID<<"\n";
+			return eFailure;
+		}
+	}
+
+	return eSuccess;
+}
+
+ADD_CATEGORIZED_TEST(CopiedObjectsDeduplicationTest,"PDFEmbedding")
@@ -0,0 +1,48 @@
+/*
+   Source File : CopiedObjectsDeduplicationTest.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "ITestUnit.h"
+
+#include <string>
+
+class PDFWriter;
+
+class CopiedObjectsDeduplicationTest : public ITestUnit
+{
+public:
+	CopiedObjectsDeduplicationTest(void);
+	virtual ~CopiedObjectsDeduplicationTest(void);
+
+	virtual PDFHummus::EStatusCode Run(const TestConfiguration& inTestConfiguration);
+
+private:
+	PDFHummus::EStatusCode CreateSourceFile(const TestConfiguration& inTestConfiguration,const std::string& inSourcePath);
+	PDFHummus::EStatusCode AppendSourceFiles(const std::string& inTargetPath,
+											const std::string& inSourceAPath,
+											const std::string& inSourceBPath,
+											bool inDeduplicate,
+											unsigned long& outDeduplicatedObjects);
+	PDFHummus::EStatusCode CheckSharedImage(const std::string& inPDFPath);
+	PDFHummus::EStatusCode MergeSourceFile(const std::string& inTargetPath,const std::string& inSourcePath,int inTimes,bool inAsFormXObjects);
+	PDFHummus::EStatusCode MergeSourcePageToFormXObject(PDFWriter& inPDFWriter,const std::string& inSourcePath);
+	unsigned long CountXObjects(const std::string& inPDFPath);
+};
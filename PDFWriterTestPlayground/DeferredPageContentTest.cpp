@@ -0,0 +1,397 @@
+/*
+   Source File : DeferredPageContentTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "DeferredPageContentTest.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PDFRectangle.h"
+#include "DeferredPageContentContext.h"
+#include "DeferredFormXObjectContentContext.h"
+#include "ISharedResourcesLock.h"
+#include "PDFParser.h"
+#include "InputFile.h"
+#include "PDFObject.h"
+#include "PDFDictionary.h"
+#include "PDFIndirectObjectReference.h"
+#include "PDFName.h"
+#include "PDFStreamInput.h"
+#include "PDFObjectCast.h"
+#include "RefCountPtr.h"
+#include "ObjectParsingHelper.h"
+
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+using namespace PDFHummus;
+
+#define PAGES_COUNT 4
+
+// lock implementation that verifies usage, instead of actually locking. pages are written interleaved on one thread in this test, 
+// simulating the way threads would write them
+class VerifyingSharedResourcesLock : public ISharedResourcesLock
+{
+public:
+	VerifyingSharedResourcesLock(){mLocked = false;mLocksCount = 0;mRecursiveLock = false;}
+
+	virtual void Lock()
+	{
+		if(mLocked)
+			mRecursiveLock = true;
+		mLocked = true;
+		++mLocksCount;
+	}
+
+	virtual void Unlock()
+	{
+		mLocked = false;
+	}
+
+	bool mLocked;
+	bool mRecursiveLock;
+	unsigned long mLocksCount;
+};
+
+DeferredPageContentTest::DeferredPageContentTest(void)
+{
+}
+
+DeferredPageContentTest::~DeferredPageContentTest(void)
+{
+}
+
+EStatusCode DeferredPageContentTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+
+	do
+	{
+		status = CreateFile(inTestConfiguration,"DeferredPageContent.pdf",true);
+		if(status != eSuccess)
+			break;
+
+		status = VerifyFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"DeferredPageContent.pdf"));
+		if(status != eSuccess)
+			break;
+
+		status = CreateFile(inTestConfiguration,"DeferredPageContentUncompressed.pdf",false);
+		if(status != eSuccess)
+			break;
+
+		status = VerifyFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"DeferredPageContentUncompressed.pdf"));
+	}while(false);
+
+	return status;
+}
+
+EStatusCode DeferredPageContentTest::CreateFile(const TestConfiguration& inTestConfiguration,
+												const string& inFileName,
+												bool inCompressStreams)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+	VerifyingSharedResourcesLock sharedResourcesLock;
+	DeferredPageContentContext* contexts[PAGES_COUNT];
+	int contextsCount = 0;
+	DeferredFormXObjectContentContext* formContext = NULL;
+
+	do
+	{
+		status = pdfWriter.StartPDF(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileName),
+									ePDFVersion13,
+									LogConfiguration::DefaultLogConfiguration,
+									PDFCreationSettings(inCompressStreams,true));
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF\n";
+			break;
+		}
+
+		PDFUsedFont* font = pdfWriter.GetFontForFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/arial.ttf"));
+		if(!font)
+		{
+			status = eFailure;
+			cout<<"failed to create font object for arial.ttf\n";
+			break;
+		}
+
+		pdfWriter.SetSharedResourcesLock(&sharedResourcesLock);
+
+		// a deferred form, placed on all pages. its ID is known at start, and it is committed between the pages
+		formContext = pdfWriter.StartDeferredFormXObjectContentContext(PDFRectangle(0,0,400,200));
+		ObjectIDType formID = formContext->GetObjectID();
+
+		for(; contextsCount < PAGES_COUNT; ++contextsCount)
+		{
+			PDFPage* page = new PDFPage();
+			page->SetMediaBox(PDFRectangle(0,0,595,842));
+			contexts[contextsCount] = pdfWriter.StartDeferredPageContentContext(page);
+		}
+
+		// write the pages content interleaved, and in reverse order, as concurrent writers would
+		AbstractContentContext::TextOptions textOptions(font,14,AbstractContentContext::eGray,0);
+		AbstractContentContext::GraphicOptions pathStrokeOptions(AbstractContentContext::eStroke,AbstractContentContext::eRGB,0xFF0000,1);
+
+		for(int i = PAGES_COUNT-1; i >= 0; --i)
+		{
+			// page marker, for verifying page order
+			contexts[i]->w(i+1);
+		}
+
+		for(int i = PAGES_COUNT-1; i >= 0; --i)
+		{
+			stringstream text;
+			text<<"Page "<<(i+1);
+			contexts[i]->WriteText(75,805,text.str(),textOptions);
+		}
+
+		formContext->WriteText(10,180,"Form",textOptions);
+		formContext->DrawImage(10,10,RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/images/soundcloud_logo.jpg"));
+		formContext->FinalizeContent();
+
+		for(int i = PAGES_COUNT-1; i >= 0; --i)
+		{
+			contexts[i]->DrawRectangle(75,700,100*(i+1),50,pathStrokeOptions);
+			string formName = contexts[i]->GetAssociatedPage()->GetResourcesDictionary().AddFormXObjectMapping(formID);
+			contexts[i]->q();
+			contexts[i]->cm(1,0,0,1,75,400);
+			contexts[i]->Do(formName);
+			contexts[i]->Q();
+			contexts[i]->FinalizeContent();
+		}
+
+		if(sharedResourcesLock.mLocked || sharedResourcesLock.mRecursiveLock || 0 == sharedResourcesLock.mLocksCount)
+		{
+			cout<<"unexpected shared resources lock usage while writing content\n";
+			status = eFailure;
+			break;
+		}
+
+		// commit in page order
+		for(int i = 0; i < PAGES_COUNT && eSuccess == status; ++i)
+		{
+			unsigned long locksCount = sharedResourcesLock.mLocksCount;
+			status = pdfWriter.WriteDeferredPageAndRelease(contexts[i]);
+			contexts[i] = NULL;
+			if(status != eSuccess)
+			{
+				cout<<"failed to commit deferred page "<<i<<"\n";
+				break;
+			}
+			if(sharedResourcesLock.mLocked || sharedResourcesLock.mRecursiveLock || locksCount == sharedResourcesLock.mLocksCount)
+			{
+				cout<<"unexpected shared resources lock usage while committing page "<<i<<"\n";
+				status = eFailure;
+				break;
+			}
+
+			if(0 == i)
+			{
+				locksCount = sharedResourcesLock.mLocksCount;
+				status = pdfWriter.WriteDeferredFormXObjectAndRelease(formContext);
+				formContext = NULL;
+				if(status != eSuccess)
+				{
+					cout<<"failed to commit deferred form\n";
+					break;
+				}
+				if(sharedResourcesLock.mLocked || sharedResourcesLock.mRecursiveLock || locksCount == sharedResourcesLock.mLocksCount)
+				{
+					cout<<"unexpected shared resources lock usage while committing form\n";
+					status = eFailure;
+				}
+			}
+		}
+		if(status != eSuccess)
+			break;
+
+		pdfWriter.SetSharedResourcesLock(NULL);
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+			cout<<"failed in end PDF\n";
+	}while(false);
+
+	// cleanup uncommitted pages on failure
+	for(int i = 0; i < contextsCount; ++i)
+	{
+		if(contexts[i])
+		{
+			delete contexts[i]->GetAssociatedPage();
+			delete contexts[i];
+		}
+	}
+	delete formContext;
+
+	return status;
+}
+
+EStatusCode DeferredPageContentTest::VerifyFile(const string& inFilePath)
+{
+	EStatusCode status;
+	InputFile pdfFile;
+	PDFParser parser;
+
+	do
+	{
+		status = pdfFile.OpenFile(inFilePath);
+		if(status != eSuccess)
+		{
+			cout<<"unable to open file for reading - "<<inFilePath<<"\n";
+			break;
+		}
+
+		status = parser.StartPDFParsing(pdfFile.GetInputStream());
+		if(status != eSuccess)
+		{
+			cout<<"unable to parse file - "<<inFilePath<<"\n";
+			break;
+		}
+
+		if(parser.GetPagesCount() != PAGES_COUNT)
+		{
+			cout<<"expected "<<PAGES_COUNT<<" pages in "<<inFilePath<<", found "<<parser.GetPagesCount()<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		for(unsigned long i = 0; i < PAGES_COUNT && eSuccess == status; ++i)
+		{
+			RefCountPtr<PDFDictionary> page(parser.ParsePage(i));
+			if(!page)
+			{
+				cout<<"failed to parse page "<<i<<" in "<<inFilePath<<"\n";
+				status = eFailure;
+				break;
+			}
+
+			PDFObjectCastPtr<PDFStreamInput> contents(parser.QueryDictionaryObject(page.GetPtr(),"Contents"));
+			if(!contents)
+			{
+				cout<<"failed to get contents stream of page "<<i<<" in "<<inFilePath<<"\n";
+				status = eFailure;
+				break;
+			}
+
+			string content;
+			if(ObjectParsingHelper::ReadStream(parser,contents.GetPtr(),content) != eSuccess)
+			{
+				cout<<"failed to read contents stream of page "<<i<<" in "<<inFilePath<<"\n";
+				status = eFailure;
+				break;
+			}
+
+			// content should start with the page marker, and contain the rest of the page content
+			stringstream marker;
+			marker<<(i+1)<<" w";
+			stringstream rectangle;
+			rectangle<<"75 700 "<<(100*(i+1))<<" 50 re";
+			if(content.compare(0,marker.str().size(),marker.str()) != 0 ||
+				content.find("Tj") == string::npos ||
+				content.find(rectangle.str()) == string::npos ||
+				content.find(" Do") == string::npos)
+			{
+				cout<<"unexpected content for page "<<i<<" in "<<inFilePath<<":\n"<<content<<"\n";
+				status = eFailure;
+				break;
+			}
+
+			// the page should place the deferred form
+			PDFObjectCastPtr<PDFDictionary> resources(parser.QueryDictionaryObject(page.GetPtr(),"Resources"));
+			PDFObjectCastPtr<PDFDictionary> xobjects(!resources ? NULL : parser.QueryDictionaryObject(resources.GetPtr(),"XObject"));
+			if(!xobjects)
+			{
+				cout<<"missing xobjects resources for page "<<i<<" in "<<inFilePath<<"\n";
+				status = eFailure;
+				break;
+			}
+			MapIterator<PDFNameToPDFObjectMap> itXObjects = xobjects->GetIterator();
+			if(!itXObjects.MoveNext())
+			{
+				cout<<"empty xobjects resources for page "<<i<<" in "<<inFilePath<<"\n";
+				status = eFailure;
+				break;
+			}
+			PDFObjectCastPtr<PDFStreamInput> form(parser.QueryDictionaryObject(xobjects.GetPtr(),itXObjects.GetKey()->GetValue()));
+			status = VerifyForm(parser,form.GetPtr());
+			if(status != eSuccess)
+				cout<<"unexpected form placed on page "<<i<<" in "<<inFilePath<<"\n";
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode DeferredPageContentTest::VerifyForm(PDFParser& inParser,PDFStreamInput* inForm)
+{
+	if(!inForm)
+	{
+		cout<<"form xobject is not a stream\n";
+		return eFailure;
+	}
+
+	RefCountPtr<PDFDictionary> formDictionary(inForm->QueryStreamDictionary());
+	PDFObjectCastPtr<PDFName> subtype(inParser.QueryDictionaryObject(formDictionary.GetPtr(),"Subtype"));
+	if(!subtype || subtype->GetValue() != "Form")
+	{
+		cout<<"form xobject has unexpected subtype\n";
+		return eFailure;
+	}
+
+	// the resources kept with the deferred context should be written with the form. text needs a font, and the image should be written as well
+	PDFObjectCastPtr<PDFDictionary> resources(inParser.QueryDictionaryObject(formDictionary.GetPtr(),"Resources"));
+	PDFObjectCastPtr<PDFDictionary> fonts(!resources ? NULL : inParser.QueryDictionaryObject(resources.GetPtr(),"Font"));
+	PDFObjectCastPtr<PDFDictionary> xobjects(!resources ? NULL : inParser.QueryDictionaryObject(resources.GetPtr(),"XObject"));
+	if(!fonts || !xobjects)
+	{
+		cout<<"form xobject resources are missing fonts or xobjects\n";
+		return eFailure;
+	}
+
+	// the image xobject (high level images of JPGs are placed via a form), is written by the form end task
+	MapIterator<PDFNameToPDFObjectMap> itXObjects = xobjects->GetIterator();
+	PDFObjectCastPtr<PDFStreamInput> image(itXObjects.MoveNext() ? inParser.QueryDictionaryObject(xobjects.GetPtr(),itXObjects.GetKey()->GetValue()) : NULL);
+	if(!image)
+	{
+		cout<<"form xobject image was not written\n";
+		return eFailure;
+	}
+
+	string content;
+	if(ObjectParsingHelper::ReadStream(inParser,inForm,content) != eSuccess)
+	{
+		cout<<"failed to read form xobject content\n";
+		return eFailure;
+	}
+	if(content.find("Tj") == string::npos)
+	{
+		cout<<"unexpected form xobject content:\n"<<content<<"\n";
+		return eFailure;
+	}
+	if(content.find(" Do") == string::npos)
+	{
+		cout<<"form xobject content does not place the image:\n"<<content<<"\n";
+		return eFailure;
+	}
+
+	return eSuccess;
+}
+
+ADD_CATEGORIZED_TEST(DeferredPageContentTest,"PDF")
@@ -0,0 +1,45 @@
+/*
+   Source File : DeferredPageContentTest.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "TestsRunner.h"
+
+#include <string>
+
+class PDFParser;
+class PDFStreamInput;
+
+class DeferredPageContentTest : public ITestUnit
+{
+public:
+	DeferredPageContentTest(void);
+	virtual ~DeferredPageContentTest(void);
+
+	virtual PDFHummus::EStatusCode Run(const TestConfiguration& inTestConfiguration);
+
+private:
+
+	PDFHummus::EStatusCode CreateFile(const TestConfiguration& inTestConfiguration,
+									  const std::string& inFileName,
+									  bool inCompressStreams);
+	PDFHummus::EStatusCode VerifyFile(const std::string& inFilePath);
+	PDFHummus::EStatusCode VerifyForm(PDFParser& inParser,PDFStreamInput* inForm);
+};
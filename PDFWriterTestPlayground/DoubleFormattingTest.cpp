@@ -0,0 +1,214 @@
+/*
+   Source File : DoubleFormattingTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "DoubleFormattingTest.h"
+#include "TestsRunner.h"
+#include "PrimitiveObjectsWriter.h"
+#include "OutputStringBufferStream.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PageContentContext.h"
+#include "InputFile.h"
+#include "OutputStreamTraits.h"
+
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+
+using namespace std;
+using namespace PDFHummus;
+
+DoubleFormattingTest::DoubleFormattingTest(void)
+{
+}
+
+DoubleFormattingTest::~DoubleFormattingTest(void)
+{
+}
+
+EStatusCode DoubleFormattingTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = TestIntegers();
+
+	if(eSuccess == status)
+		status = TestDoubles();
+
+	if(eSuccess == status)
+		status = TestDocumentPrecision(inTestConfiguration);
+
+	return status;
+}
+
+EStatusCode DoubleFormattingTest::TestIntegers()
+{
+	long long values[] = {0,1,-1,9,10,-10,123456789,LLONG_MAX,LLONG_MIN};
+	OutputStringBufferStream stream;
+	PrimitiveObjectsWriter writer(&stream);
+	string expected;
+
+	for(size_t i = 0; i < sizeof(values)/sizeof(long long); ++i)
+	{
+		char buffer[32];
+		sprintf(buffer,"%lld ",values[i]);
+		expected.append(buffer);
+		writer.WriteInteger(values[i]);
+	}
+
+	if(stream.ToString() != expected)
+	{
+		cout<<"integers formatting mismatch. expected "<<expected<<", got "<<stream.ToString()<<"\n";
+		return eFailure;
+	}
+	return eSuccess;
+}
+
+// the previous implementation, "%f" with trailing zeros removed. the only intended difference is negative zero, which is now written as 0
+static string FormatReference(double inValue,unsigned int inPrecision)
+{
+	char buffer[512];
+	sprintf(buffer,"%.*f",(int)inPrecision,inValue);
+	string result(buffer);
+
+	while(inPrecision > 0 && !result.empty() && result[result.size() - 1] == '0')
+		result.erase(result.size() - 1);
+	if(inPrecision > 0 && result[result.size() - 1] == '.')
+		result.erase(result.size() - 1);
+	if(result == "-0")
+		result = "0";
+	return result;
+}
+
+static double RandomDouble(int inKind)
+{
+	double fraction = (double)rand() / RAND_MAX;
+	switch(inKind % 6)
+	{
+		case 0: // coordinates
+			return fraction * 1200 - 200;
+		case 1: // unit values, like colors
+			return fraction;
+		case 2: // values that are exactly halves at 6 decimal places, before binary rounding
+			return (rand() % 2000000 + 0.5) / 1000000.0;
+		case 3: // short decimals
+			return (rand() % 100000) / 100.0 - 500;
+		case 4: // large values
+			return fraction * 1e17;
+		default: // small values
+			return (fraction - 0.5) * 1e-5;
+	}
+}
+
+EStatusCode DoubleFormattingTest::TestDoubles()
+{
+	double specialValues[] = {0,-0.0,1,-1,0.5,1.5,2.5,-2.5,0.0000005,0.0000015,-0.0000004,0.1,0.2,0.3,1.0/3,2.0/3,
+								123456.7890125,999999.9999995,1e15,1e18,1e19,1e300,-1e300,4503599627370496.5,72.00000049999999};
+	char buffer[512];
+
+	for(unsigned int precision = 0; precision <= MAX_DOUBLE_PRECISION; ++precision)
+	{
+		PrimitiveObjectsWriter writer;
+		writer.SetDoublePrecision(precision);
+
+		srand(precision + 1);
+		int randomCount = (DEFAULT_DOUBLE_PRECISION == precision) ? 200000 : 20000;
+		int specialCount = sizeof(specialValues)/sizeof(double);
+		for(int i = 0; i < specialCount + randomCount; ++i)
+		{
+			double value = i < specialCount ? specialValues[i] : RandomDouble(i);
+			string formatted(buffer,writer.FormatDouble(value,buffer));
+			string expected = FormatReference(value,precision);
+			if(formatted != expected)
+			{
+				printf("double formatting mismatch at precision %u for %.17g. expected %s, got %s\n",precision,value,expected.c_str(),formatted.c_str());
+				return eFailure;
+			}
+		}
+	}
+
+	// precision is limited
+	PrimitiveObjectsWriter writer;
+	writer.SetDoublePrecision(MAX_DOUBLE_PRECISION + 10);
+	if(writer.GetDoublePrecision() != MAX_DOUBLE_PRECISION)
+	{
+		cout<<"expected precision to be limited to "<<MAX_DOUBLE_PRECISION<<"\n";
+		return eFailure;
+	}
+
+	return eSuccess;
+}
+
+EStatusCode DoubleFormattingTest::TestDocumentPrecision(const TestConfiguration& inTestConfiguration)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+	string pdfPath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"DoublePrecisionTest.pdf");
+	PDFCreationSettings creationSettings(false,true);
+	creationSettings.DoublePrecision = 2;
+
+	do
+	{
+		status = pdfWriter.StartPDF(pdfPath,ePDFVersion13,LogConfiguration::DefaultLogConfiguration,creationSettings);
+		if(status != eSuccess)
+			break;
+
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,595.2756,841.8898));
+
+		PageContentContext* contentContext = pdfWriter.StartPageContentContext(page);
+		contentContext->re(0.123456,10.5,1.0/3,2);
+		contentContext->f();
+
+		status = pdfWriter.EndPageContentContext(contentContext);
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.WritePageAndRelease(page);
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+			break;
+
+		InputFile pdfFile;
+		OutputStringBufferStream pdfContent;
+		status = pdfFile.OpenFile(pdfPath);
+		if(status != eSuccess)
+			break;
+		OutputStreamTraits traits(&pdfContent);
+		status = traits.CopyToOutputStream(pdfFile.GetInputStream());
+		if(status != eSuccess)
+			break;
+
+		// both content and objects use the document precision
+		if(pdfContent.ToString().find("0.12 10.5 0.33 2 re") == string::npos ||
+			pdfContent.ToString().find("[ 0 0 595.28 841.89 ]") == string::npos)
+		{
+			cout<<"expected content and media box to be written with 2 decimal places\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(DoubleFormattingTest,"ObjectContext")
@@ -0,0 +1,185 @@
+/*
+   Source File : FontProgramsCacheTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "FontProgramsCacheTest.h"
+#include "TestsRunner.h"
+#include "SampleFontsDocument.h"
+#include "PDFWriter.h"
+#include "FontProgramsCache.h"
+#include "Timer.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+static const char* scSampleText = "Hello World, cached font programs";
+
+FontProgramsCacheTest::FontProgramsCacheTest(void)
+{
+}
+
+FontProgramsCacheTest::~FontProgramsCacheTest(void)
+{
+}
+
+EStatusCode FontProgramsCacheTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = eSuccess;
+	double uncachedTime,firstTime,secondTime;
+	FontProgramsCache fontProgramsCache;
+	FontProgramsCacheStatistics statistics;
+
+	do
+	{
+		status = WriteDocument(inTestConfiguration,"FontProgramsCacheNone.pdf",NULL,uncachedTime);
+		if(status != eSuccess)
+			break;
+
+		// first document fills the cache
+		status = WriteDocument(inTestConfiguration,"FontProgramsCacheFirst.pdf",&fontProgramsCache,firstTime);
+		if(status != eSuccess)
+			break;
+
+		statistics = fontProgramsCache.GetStatistics();
+		if(statistics.Hits != 0 || statistics.Misses == 0 || statistics.CachedPrograms != statistics.Misses)
+		{
+			cout<<"Expected only misses for the first document. hits "<<statistics.Hits<<" misses "<<statistics.Misses<<" programs "<<statistics.CachedPrograms<<"\n";
+			status = eFailure;
+			break;
+		}
+		unsigned long programsCount = statistics.CachedPrograms;
+
+		// second document should get all font programs from the cache
+		status = WriteDocument(inTestConfiguration,"FontProgramsCacheSecond.pdf",&fontProgramsCache,secondTime);
+		if(status != eSuccess)
+			break;
+
+		statistics = fontProgramsCache.GetStatistics();
+		if(statistics.Hits != programsCount || statistics.CachedPrograms != programsCount)
+		{
+			cout<<"Expected only hits for the second document. hits "<<statistics.Hits<<" misses "<<statistics.Misses<<" programs "<<statistics.CachedPrograms<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		status = CompareToFile(inTestConfiguration,"FontProgramsCacheNone.pdf","FontProgramsCacheFirst.pdf");
+		if(status != eSuccess)
+			break;
+		status = CompareToFile(inTestConfiguration,"FontProgramsCacheNone.pdf","FontProgramsCacheSecond.pdf");
+		if(status != eSuccess)
+			break;
+
+		cout<<"Wrote document without font programs cache in "<<uncachedTime<<"ms, filling the cache in "<<firstTime<<"ms, and from the cache in "<<secondTime<<"ms\n";
+
+		// now with a memory limit that requires spilling all programs to files
+		FontProgramsCache spillingCache;
+		double spillingTime;
+
+		spillingCache.SetMemoryLimit(1);
+		spillingCache.SetSpillDirectory(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"."));
+
+		status = WriteDocument(inTestConfiguration,"FontProgramsCacheSpillFirst.pdf",&spillingCache,spillingTime);
+		if(status != eSuccess)
+			break;
+
+		statistics = spillingCache.GetStatistics();
+		if(statistics.SpilledPrograms == 0 || statistics.MemoryBytes > 1)
+		{
+			cout<<"Expected font programs to be spilled. spilled "<<statistics.SpilledPrograms<<" memory bytes "<<statistics.MemoryBytes<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		status = WriteDocument(inTestConfiguration,"FontProgramsCacheSpillSecond.pdf",&spillingCache,spillingTime);
+		if(status != eSuccess)
+			break;
+
+		statistics = spillingCache.GetStatistics();
+		if(statistics.Hits != programsCount)
+		{
+			cout<<"Expected spilled font programs to be read back. hits "<<statistics.Hits<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		status = CompareToFile(inTestConfiguration,"FontProgramsCacheNone.pdf","FontProgramsCacheSpillSecond.pdf");
+		if(status != eSuccess)
+			break;
+
+		spillingCache.Purge();
+		statistics = spillingCache.GetStatistics();
+		if(statistics.CachedPrograms != 0 || statistics.SpilledPrograms != 0)
+		{
+			cout<<"Expected an empty cache after purging. programs "<<statistics.CachedPrograms<<"\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode FontProgramsCacheTest::WriteDocument(const TestConfiguration& inTestConfiguration,
+												const std::string& inFileName,
+												FontProgramsCache* inFontProgramsCache,
+												double& outMiliSeconds)
+{
+	EStatusCode status = eSuccess;
+	PDFWriter pdfWriter;
+	Timer timer;
+
+	do
+	{
+		timer.StartMeasure();
+		status = pdfWriter.StartPDF(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileName),ePDFVersion13);
+		if(status != eSuccess)
+		{
+			cout<<"Failed to start file\n";
+			break;
+		}
+		pdfWriter.SetFontProgramsCache(inFontProgramsCache);
+
+		status = SampleFontsDocument::WritePage(pdfWriter,inTestConfiguration,scSampleText);
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.EndPDF();
+		timer.StopMeasureAndAccumulate();
+		if(status != eSuccess)
+		{
+			cout<<"Failed to end file\n";
+			break;
+		}
+		outMiliSeconds = timer.GetTotalMiliSeconds();
+	}while(false);
+
+	return status;
+}
+
+EStatusCode FontProgramsCacheTest::CompareToFile(const TestConfiguration& inTestConfiguration,
+												const std::string& inExpectedFileName,
+												const std::string& inFileName)
+{
+	return SampleFontsDocument::CompareFiles(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inExpectedFileName),
+											RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileName));
+}
+
+ADD_CATEGORIZED_TEST(FontProgramsCacheTest,"Text")
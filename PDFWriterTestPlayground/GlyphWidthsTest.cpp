@@ -0,0 +1,99 @@
+/*
+   Source File : GlyphWidthsTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "GlyphWidthsTest.h"
+#include "TestsRunner.h"
+#include "FreeTypeWrapper.h"
+#include "FreeTypeFaceWrapper.h"
+
+#include <iostream>
+#include <string.h>
+
+using namespace std;
+using namespace PDFHummus;
+
+GlyphWidthsTest::GlyphWidthsTest(void)
+{
+}
+
+GlyphWidthsTest::~GlyphWidthsTest(void)
+{
+}
+
+EStatusCode GlyphWidthsTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = eSuccess;
+	FreeTypeWrapper ftWrapper;
+	// truetype, type 1, CFF and CID keyed CFF
+	const char* fonts[] = {"TestMaterials/fonts/arial.ttf","TestMaterials/fonts/couri.ttf","TestMaterials/fonts/HLB_____.PFB",
+							"TestMaterials/fonts/BrushScriptStd.otf","TestMaterials/fonts/KozGoPro-Regular.otf"};
+	const char* secondaryFonts[] = {"","","TestMaterials/fonts/HLB_____.PFM","",""};
+
+	for(int i = 0; i < 5 && eSuccess == status; ++i)
+		status = TestFontWidths(ftWrapper,
+								RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,fonts[i]),
+								strlen(secondaryFonts[i]) > 0 ? RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,secondaryFonts[i]) : "");
+
+	return status;
+}
+
+EStatusCode GlyphWidthsTest::TestFontWidths(FreeTypeWrapper& inFreeType,const string& inFontFilePath,const string& inSecondaryFontFilePath)
+{
+	FT_Face face = inSecondaryFontFilePath.length() > 0 ? 
+						inFreeType.NewFace(inFontFilePath,inSecondaryFontFilePath,0) :
+						inFreeType.NewFace(inFontFilePath,0);
+	if(!face)
+	{
+		cout<<"Failed to load font from "<<inFontFilePath<<"\n";
+		return eFailure;
+	}
+
+	EStatusCode status = eSuccess;
+	{
+		FreeTypeFaceWrapper tableWrapper(face,inFontFilePath,inSecondaryFontFilePath,0,false);
+		FreeTypeFaceWrapper loadingWrapper(face,inFontFilePath,inSecondaryFontFilePath,0,false);
+
+		// widths from the advances table are expected to match the advance of the loaded glyph, which is how widths used to be measured.
+		// allow a difference of a unit, for composite glyphs that take their metrics from a component, where font metrics may be off by
+		// one font unit (as with one glyph in arial). go backwards, so blocks are not read in order
+		for(long i = face->num_glyphs; i > 0 && eSuccess == status; --i)
+		{
+			unsigned int glyphIndex = (unsigned int)(i - 1);
+			FT_Pos expected = loadingWrapper.LoadGlyph(glyphIndex) == 0 ? loadingWrapper.GetInPDFMeasurements(face->glyph->metrics.horiAdvance) : 0;
+			FT_Pos width = tableWrapper.GetGlyphWidth(glyphIndex);
+			if(width < expected - 1 || width > expected + 1)
+			{
+				cout<<"Wrong width for glyph "<<glyphIndex<<" of "<<inFontFilePath<<". expected "<<expected<<" got "<<width<<"\n";
+				status = eFailure;
+			}
+		}
+
+		if(eSuccess == status && tableWrapper.GetGlyphWidth((unsigned int)face->num_glyphs) != 0)
+		{
+			cout<<"Expected 0 width for glyph out of range in "<<inFontFilePath<<"\n";
+			status = eFailure;
+		}
+	}
+
+	inFreeType.DoneFace(face);
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(GlyphWidthsTest,"Text")
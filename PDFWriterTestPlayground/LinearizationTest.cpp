@@ -0,0 +1,516 @@
+/*
+   Source File : LinearizationTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "LinearizationTest.h"
+#include "TestsRunner.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PageContentContext.h"
+#include "PDFUsedFont.h"
+#include "PDFLinearizer.h"
+#include "DocumentContextExtenderAdapter.h"
+#include "DictionaryContext.h"
+#include "ObjectsContext.h"
+#include "PDFParser.h"
+#include "PDFDictionary.h"
+#include "PDFArray.h"
+#include "PDFIndirectObjectReference.h"
+#include "PDFObjectCast.h"
+#include "PDFStreamInput.h"
+#include "InputFile.h"
+#include "OutputFile.h"
+#include "OutputStringBufferStream.h"
+#include "OutputStreamTraits.h"
+#include "IByteReader.h"
+#include "RefCountPtr.h"
+#include "Timer.h"
+
+#include <stdlib.h>
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+using namespace IOBasicTypes;
+
+#define DOCUMENT_PAGES 30
+// the linearization parameters dictionary should be within the first 1024 bytes of the file
+#define LINEARIZATION_HEADER_SIZE 1024
+// names that temporary files of linearization used, or may use, next to the target file. user files by these names should be left alone
+static const char* scSiblingFileSuffixes[] = {".unlinearized",".tmp",".linearized.0",".body.0"};
+#define SIBLING_FILES_COUNT 4
+static const string scSiblingFileContent = "user file, not to be touched by linearization";
+
+LinearizationTest::LinearizationTest(void)
+{
+}
+
+LinearizationTest::~LinearizationTest(void)
+{
+}
+
+EStatusCode LinearizationTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = eSuccess;
+	string documentPath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"LinearizationTest.pdf");
+	string linearizedDocumentPath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"LinearizationTestLinearized.pdf");
+	const char* files[] = {"TestMaterials/Original.pdf","TestMaterials/ObjectStreams.pdf","TestMaterials/Linearized.pdf","TestMaterials/AddedPage.pdf"};
+
+	do
+	{
+		status = WriteDocument(inTestConfiguration,documentPath,false);
+		if(status != eSuccess)
+			break;
+
+		status = WriteSiblingFiles(linearizedDocumentPath);
+		if(status != eSuccess)
+			break;
+
+		Timer timer;
+		timer.StartMeasure();
+		status = WriteDocument(inTestConfiguration,linearizedDocumentPath,true);
+		timer.StopMeasureAndAccumulate();
+		if(status != eSuccess)
+			break;
+		cout<<"Wrote linearized document of "<<DOCUMENT_PAGES<<" pages in "<<timer.GetTotalMiliSeconds()<<"ms\n";
+
+		status = CheckSiblingFiles(linearizedDocumentPath);
+		if(status != eSuccess)
+			break;
+
+		status = CheckLinearized(linearizedDocumentPath);
+		if(status != eSuccess)
+			break;
+
+		status = ComparePages(documentPath,linearizedDocumentPath);
+		if(status != eSuccess)
+			break;
+
+		for(int i=0; i < 4 && eSuccess == status; ++i)
+		{
+			string sourcePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,files[i]);
+			string targetPath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("LinearizationTest") + (char)('A' + i) + ".pdf");
+
+			status = WriteSiblingFiles(targetPath);
+			if(eSuccess == status)
+				status = LinearizeFile(sourcePath,targetPath);
+			if(eSuccess == status)
+				status = CheckSiblingFiles(targetPath);
+			if(eSuccess == status)
+				status = CheckLinearized(targetPath);
+			if(eSuccess == status)
+				status = ComparePages(sourcePath,targetPath);
+		}
+		if(status != eSuccess)
+			break;
+
+		status = CheckDocumentLevelObjects(inTestConfiguration);
+	}while(false);
+
+	return status;
+}
+
+EStatusCode LinearizationTest::WriteDocument(const TestConfiguration& inTestConfiguration,const string& inFilePath,bool inLinearize)
+{
+	PDFWriter pdfWriter;
+	PDFCreationSettings creationSettings(true,true);
+	EStatusCode status;
+
+	do
+	{
+		creationSettings.Linearize = inLinearize;
+		status = pdfWriter.StartPDF(inFilePath,ePDFVersion13,LogConfiguration::DefaultLogConfiguration,creationSettings);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF\n";
+			break;
+		}
+
+		// a font and an image shared by all pages, and an image used by just one page
+		PDFUsedFont* font = pdfWriter.GetFontForFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/arial.ttf"));
+		if(!font)
+		{
+			cout<<"failed to create font\n";
+			status = eFailure;
+			break;
+		}
+		string sharedImagePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/images/otherStage.JPG");
+		string pageImagePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/images/soundcloud_logo.jpg");
+
+		for(int i = 0; i < DOCUMENT_PAGES && eSuccess == status; ++i)
+		{
+			PDFPage* page = new PDFPage();
+			page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+			PageContentContext* contentContext = pdfWriter.StartPageContentContext(page);
+			char pageText[32];
+			sprintf(pageText,"Page %d",i + 1);
+			contentContext->WriteText(75,805,pageText,AbstractContentContext::TextOptions(font,14,AbstractContentContext::eGray,0));
+			if(i % 2 == 0)
+				contentContext->DrawImage(10,100,sharedImagePath);
+			if(DOCUMENT_PAGES/2 == i)
+				contentContext->DrawImage(10,500,pageImagePath);
+			status = pdfWriter.EndPageContentContext(contentContext);
+			if(eSuccess == status)
+				status = pdfWriter.WritePageAndRelease(page);
+		}
+		if(status != eSuccess)
+		{
+			cout<<"failed to write pages\n";
+			break;
+		}
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+			cout<<"failed to end PDF\n";
+	}while(false);
+
+	return status;
+}
+
+// adds an open action and outlines, shown when the document opens, to the catalog
+class DocumentLevelEntriesWriter : public DocumentContextExtenderAdapter
+{
+public:
+	ObjectIDType mOpenActionID;
+	ObjectIDType mOutlinesID;
+
+	virtual EStatusCode OnCatalogWrite(
+							CatalogInformation* inCatalogInformation,
+							DictionaryContext* inCatalogDictionaryContext,
+							ObjectsContext* inPDFWriterObjectContext,
+							DocumentContext* inDocumentContext)
+	{
+		inCatalogDictionaryContext->WriteKey("OpenAction");
+		inCatalogDictionaryContext->WriteObjectReferenceValue(mOpenActionID,0);
+		inCatalogDictionaryContext->WriteKey("PageMode");
+		inCatalogDictionaryContext->WriteNameValue("UseOutlines");
+		inCatalogDictionaryContext->WriteKey("Outlines");
+		inCatalogDictionaryContext->WriteObjectReferenceValue(mOutlinesID,0);
+		return eSuccess;
+	}
+};
+
+EStatusCode LinearizationTest::CheckDocumentLevelObjects(const TestConfiguration& inTestConfiguration)
+{
+	// objects of catalog entries used when opening the document should come before the first page
+	string filePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"LinearizationTestDocumentLevel.pdf");
+	EStatusCode status;
+	InputFile pdfFile;
+	PDFParser parser;
+
+	do
+	{
+		{
+			PDFWriter pdfWriter;
+			PDFCreationSettings creationSettings(true,true);
+			DocumentLevelEntriesWriter entriesWriter;
+
+			creationSettings.Linearize = true;
+			status = pdfWriter.StartPDF(filePath,ePDFVersion13,LogConfiguration::DefaultLogConfiguration,creationSettings);
+			for(int i = 0; i < 3 && eSuccess == status; ++i)
+			{
+				PDFPage* page = new PDFPage();
+				page->SetMediaBox(PDFRectangle(0,0,595,842));
+				status = pdfWriter.WritePageAndRelease(page);
+			}
+			if(status != eSuccess)
+			{
+				cout<<"failed to write document with document level objects\n";
+				break;
+			}
+
+			ObjectsContext& objectsContext = pdfWriter.GetObjectsContext();
+
+			entriesWriter.mOpenActionID = objectsContext.StartNewIndirectObject();
+			DictionaryContext* openAction = objectsContext.StartDictionary();
+			openAction->WriteKey("S");
+			openAction->WriteNameValue("JavaScript");
+			openAction->WriteKey("JS");
+			openAction->WriteLiteralStringValue("app.alert('opened');");
+			objectsContext.EndDictionary(openAction);
+			objectsContext.EndIndirectObject();
+
+			entriesWriter.mOutlinesID = objectsContext.StartNewIndirectObject();
+			DictionaryContext* outlines = objectsContext.StartDictionary();
+			outlines->WriteKey("Type");
+			outlines->WriteNameValue("Outlines");
+			outlines->WriteKey("Count");
+			outlines->WriteIntegerValue(0);
+			objectsContext.EndDictionary(outlines);
+			objectsContext.EndIndirectObject();
+
+			pdfWriter.GetDocumentContext().AddDocumentContextExtender(&entriesWriter);
+			status = pdfWriter.EndPDF();
+			pdfWriter.GetDocumentContext().RemoveDocumentContextExtender(&entriesWriter);
+			if(status != eSuccess)
+			{
+				cout<<"failed to end document with document level objects\n";
+				break;
+			}
+		}
+
+		status = CheckLinearized(filePath);
+		if(status != eSuccess)
+			break;
+
+		status = pdfFile.OpenFile(filePath);
+		if(status == eSuccess)
+			status = parser.StartPDFParsing(pdfFile.GetInputStream());
+		if(status != eSuccess)
+		{
+			cout<<"unable to parse linearized file - "<<filePath<<"\n";
+			break;
+		}
+
+		PDFObjectCastPtr<PDFDictionary> catalog(parser.QueryDictionaryObject(parser.GetTrailer(),"Root"));
+		PDFObjectCastPtr<PDFIndirectObjectReference> openActionReference(!catalog ? NULL : catalog->QueryDirectObject("OpenAction"));
+		PDFObjectCastPtr<PDFIndirectObjectReference> outlinesReference(!catalog ? NULL : catalog->QueryDirectObject("Outlines"));
+		if(!openActionReference || !outlinesReference)
+		{
+			cout<<"expected open action and outlines in the catalog of "<<filePath<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		LongFilePositionType firstPagePosition = parser.GetXrefEntry(parser.GetPageObjectID(0))->mObjectPosition;
+		if(parser.GetXrefEntry(openActionReference->mObjectID)->mObjectPosition > firstPagePosition ||
+			parser.GetXrefEntry(outlinesReference->mObjectID)->mObjectPosition > firstPagePosition)
+		{
+			cout<<"expected open action and outlines before the first page in "<<filePath<<"\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode LinearizationTest::WriteSiblingFiles(const string& inFilePath)
+{
+	EStatusCode status = eSuccess;
+
+	for(int i=0; i < SIBLING_FILES_COUNT && eSuccess == status; ++i)
+	{
+		OutputFile siblingFile;
+		status = siblingFile.OpenFile(inFilePath + scSiblingFileSuffixes[i]);
+		if(status != eSuccess)
+		{
+			cout<<"unable to write sibling file of "<<inFilePath<<"\n";
+			break;
+		}
+		siblingFile.GetOutputStream()->Write((const Byte*)scSiblingFileContent.c_str(),scSiblingFileContent.size());
+		status = siblingFile.CloseFile();
+	}
+	return status;
+}
+
+EStatusCode LinearizationTest::CheckSiblingFiles(const string& inFilePath)
+{
+	EStatusCode status = eSuccess;
+
+	for(int i=0; i < SIBLING_FILES_COUNT && eSuccess == status; ++i)
+	{
+		string siblingFilePath = inFilePath + scSiblingFileSuffixes[i];
+		InputFile siblingFile;
+		OutputStringBufferStream content;
+		OutputStreamTraits traits(&content);
+
+		if(siblingFile.OpenFile(siblingFilePath) == eSuccess)
+			traits.CopyToOutputStream(siblingFile.GetInputStream());
+		if(content.ToString() != scSiblingFileContent)
+		{
+			cout<<"linearization replaced or removed the existing file "<<siblingFilePath<<"\n";
+			status = eFailure;
+		}
+		siblingFile.CloseFile();
+		remove(siblingFilePath.c_str());
+	}
+	return status;
+}
+
+EStatusCode LinearizationTest::LinearizeFile(const string& inSourceFilePath,const string& inTargetFilePath)
+{
+	PDFLinearizer linearizer;
+	Timer timer;
+
+	timer.StartMeasure();
+	EStatusCode status = linearizer.LinearizePDF(inSourceFilePath,inTargetFilePath);
+	timer.StopMeasureAndAccumulate();
+	if(status != eSuccess)
+		cout<<"failed to linearize "<<inSourceFilePath<<"\n";
+	else
+		cout<<"Linearized "<<inSourceFilePath<<" in "<<timer.GetTotalMiliSeconds()<<"ms\n";
+	return status;
+}
+
+bool LinearizationTest::ReadLinearizationParameter(const string& inHeader,const string& inKey,LongFilePositionType& outValue)
+{
+	string::size_type keyPosition = inHeader.find("/" + inKey + " ");
+	if(string::npos == keyPosition)
+		return false;
+	outValue = atol(inHeader.c_str() + keyPosition + inKey.size() + 2);
+	return true;
+}
+
+EStatusCode LinearizationTest::CheckLinearized(const string& inFilePath)
+{
+	EStatusCode status = eSuccess;
+	InputFile pdfFile;
+	PDFParser parser;
+
+	do
+	{
+		status = pdfFile.OpenFile(inFilePath);
+		if(status != eSuccess)
+		{
+			cout<<"unable to open linearized file - "<<inFilePath<<"\n";
+			break;
+		}
+
+		Byte buffer[LINEARIZATION_HEADER_SIZE];
+		size_t readBytes = pdfFile.GetInputStream()->Read(buffer,LINEARIZATION_HEADER_SIZE);
+		string header((const char*)buffer,readBytes);
+		LongFilePositionType fileSize = pdfFile.GetFileSize();
+		LongFilePositionType length,firstPageEnd,pagesCount,firstPageObjectID;
+
+		if(header.find("/Linearized 1") == string::npos ||
+			!ReadLinearizationParameter(header,"L",length) ||
+			!ReadLinearizationParameter(header,"E",firstPageEnd) ||
+			!ReadLinearizationParameter(header,"N",pagesCount) ||
+			!ReadLinearizationParameter(header,"O",firstPageObjectID))
+		{
+			cout<<"no linearization parameters at the beginning of "<<inFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		if(length != fileSize)
+		{
+			cout<<"linearized file length should be "<<fileSize<<" but is "<<length<<" in "<<inFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		pdfFile.GetInputStream()->SetPosition(0);
+		status = parser.StartPDFParsing(pdfFile.GetInputStream());
+		if(status != eSuccess)
+		{
+			cout<<"unable to parse linearized file - "<<inFilePath<<"\n";
+			break;
+		}
+
+		if(parser.GetPagesCount() != (unsigned long)pagesCount || parser.GetPageObjectID(0) != (ObjectIDType)firstPageObjectID)
+		{
+			cout<<"linearization parameters don't match the pages of "<<inFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		cout<<"First page of "<<inFilePath<<" is complete at "<<firstPageEnd<<" bytes of "<<length<<"\n";
+	}while(false);
+
+	return status;
+}
+
+string LinearizationTest::ReadPageContents(PDFParser& inParser,unsigned long inPageIndex)
+{
+	// raw contents streams data, one after the other
+	RefCountPtr<PDFDictionary> page(inParser.ParsePage(inPageIndex));
+	if(!page)
+		return "";
+
+	RefCountPtr<PDFObject> contents(page->QueryDirectObject("Contents"));
+	if(!contents)
+		return "";
+
+	PDFObjectVector streams;
+	if(contents->GetType() == PDFObject::ePDFObjectArray)
+	{
+		SingleValueContainerIterator<PDFObjectVector> it = ((PDFArray*)contents.GetPtr())->GetIterator();
+		while(it.MoveNext())
+			streams.push_back(it.GetItem());
+	}
+	else
+		streams.push_back(contents.GetPtr());
+
+	OutputStringBufferStream data;
+	OutputStreamTraits traits(&data);
+	for(PDFObjectVector::iterator it = streams.begin(); it != streams.end(); ++it)
+	{
+		if((*it)->GetType() != PDFObject::ePDFObjectIndirectObjectReference)
+			continue;
+
+		RefCountPtr<PDFObject> stream(inParser.ParseNewObject(((PDFIndirectObjectReference*)*it)->mObjectID));
+		if(!stream || stream->GetType() != PDFObject::ePDFObjectStream)
+			continue;
+
+		IByteReader* reader = inParser.StartReadingFromStreamForPlainCopying((PDFStreamInput*)stream.GetPtr());
+		if(reader)
+		{
+			traits.CopyToOutputStream(reader);
+			delete reader;
+		}
+	}
+	return data.ToString();
+}
+
+EStatusCode LinearizationTest::ComparePages(const string& inFilePath,const string& inLinearizedFilePath)
+{
+	EStatusCode status = eSuccess;
+	InputFile pdfFile,linearizedPDFFile;
+	PDFParser parser,linearizedParser;
+
+	do
+	{
+		status = pdfFile.OpenFile(inFilePath);
+		if(status == eSuccess)
+			status = parser.StartPDFParsing(pdfFile.GetInputStream());
+		if(status == eSuccess)
+			status = linearizedPDFFile.OpenFile(inLinearizedFilePath);
+		if(status == eSuccess)
+			status = linearizedParser.StartPDFParsing(linearizedPDFFile.GetInputStream());
+		if(status != eSuccess)
+		{
+			cout<<"unable to parse "<<inFilePath<<" or its linearized version\n";
+			break;
+		}
+
+		if(parser.GetPagesCount() != linearizedParser.GetPagesCount())
+		{
+			cout<<"pages count differs between "<<inFilePath<<" and its linearized version. "<<parser.GetPagesCount()<<" vs "<<linearizedParser.GetPagesCount()<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		for(unsigned long i = 0; i < parser.GetPagesCount() && eSuccess == status; ++i)
+		{
+			string contents = ReadPageContents(parser,i);
+			if(contents.empty() || contents != ReadPageContents(linearizedParser,i))
+			{
+				cout<<"page "<<i<<" contents differ between "<<inFilePath<<" and its linearized version\n";
+				status = eFailure;
+			}
+		}
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(LinearizationTest,"PDFEmbedding")
@@ -0,0 +1,48 @@
+/*
+   Source File : LinearizationTest.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "ITestUnit.h"
+#include "IOBasicTypes.h"
+
+#include <string>
+
+class PDFParser;
+
+class LinearizationTest : public ITestUnit
+{
+public:
+	LinearizationTest(void);
+	virtual ~LinearizationTest(void);
+
+	virtual PDFHummus::EStatusCode Run(const TestConfiguration& inTestConfiguration);
+
+private:
+	PDFHummus::EStatusCode WriteDocument(const TestConfiguration& inTestConfiguration,const std::string& inFilePath,bool inLinearize);
+	PDFHummus::EStatusCode LinearizeFile(const std::string& inSourceFilePath,const std::string& inTargetFilePath);
+	PDFHummus::EStatusCode CheckLinearized(const std::string& inFilePath);
+	PDFHummus::EStatusCode ComparePages(const std::string& inFilePath,const std::string& inLinearizedFilePath);
+	PDFHummus::EStatusCode CheckDocumentLevelObjects(const TestConfiguration& inTestConfiguration);
+	PDFHummus::EStatusCode WriteSiblingFiles(const std::string& inFilePath);
+	PDFHummus::EStatusCode CheckSiblingFiles(const std::string& inFilePath);
+	std::string ReadPageContents(PDFParser& inParser,unsigned long inPageIndex);
+	bool ReadLinearizationParameter(const std::string& inHeader,const std::string& inKey,IOBasicTypes::LongFilePositionType& outValue);
+};
@@ -0,0 +1,298 @@
+/*
+   Source File : MemoryMappedInputFileTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "MemoryMappedInputFileTest.h"
+#include "InputFile.h"
+#include "OutputStringBufferStream.h"
+#include "OutputStreamTraits.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PDFRectangle.h"
+#include "PDFParser.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+MemoryMappedInputFileTest::MemoryMappedInputFileTest(void)
+{
+}
+
+MemoryMappedInputFileTest::~MemoryMappedInputFileTest(void)
+{
+}
+
+EStatusCode MemoryMappedInputFileTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+
+	do
+	{
+		status = CompareReading(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/XObjectContent.PDF"));
+		if(status != eSuccess)
+			break;
+
+		status = CompareReading(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/ObjectStreams.pdf"));
+		if(status != eSuccess)
+			break;
+
+		status = CreateAndModifyWithMapping(inTestConfiguration);
+	}while(false);
+
+	return status;
+}
+
+static string ReadSome(IByteReaderWithPosition* inStream,LongBufferSizeType inSize)
+{
+	OutputStringBufferStream content;
+	OutputStreamTraits traits(&content);
+
+	traits.CopyToOutputStream(inStream,inSize);
+	return content.ToString();
+}
+
+EStatusCode MemoryMappedInputFileTest::CompareReading(const string& inFilePath)
+{
+	EStatusCode status;
+	InputFile bufferedFile;
+	InputFile mappedFile;
+
+	do
+	{
+		status = bufferedFile.OpenFile(inFilePath);
+		if(status != eSuccess)
+		{
+			cout<<"unable to open file for reading - "<<inFilePath<<"\n";
+			break;
+		}
+
+		status = mappedFile.OpenFile(inFilePath,true);
+		if(status != eSuccess || !mappedFile.IsMemoryMapped())
+		{
+			cout<<"unable to open file for reading with memory mapping - "<<inFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		if(bufferedFile.GetFileSize() != mappedFile.GetFileSize())
+		{
+			cout<<"file size mismatch for "<<inFilePath<<", buffered = "<<bufferedFile.GetFileSize()<<" mapped = "<<mappedFile.GetFileSize()<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		IByteReaderWithPosition* bufferedStream = bufferedFile.GetInputStream();
+		IByteReaderWithPosition* mappedStream = mappedFile.GetInputStream();
+
+		// read all
+		if(ReadSome(bufferedStream,(LongBufferSizeType)bufferedFile.GetFileSize()) != ReadSome(mappedStream,(LongBufferSizeType)mappedFile.GetFileSize()) ||
+			mappedStream->NotEnded())
+		{
+			cout<<"content mismatch when reading whole file - "<<inFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		// from end, like the parser does when looking for the xref
+		bufferedStream->SetPositionFromEnd(100);
+		mappedStream->SetPositionFromEnd(100);
+		if(bufferedStream->GetCurrentPosition() != mappedStream->GetCurrentPosition() ||
+			ReadSome(bufferedStream,50) != ReadSome(mappedStream,50))
+		{
+			cout<<"content mismatch when reading from end - "<<inFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		// random access
+		bufferedStream->SetPosition(10);
+		mappedStream->SetPosition(10);
+		bufferedStream->Skip(5);
+		mappedStream->Skip(5);
+		if(bufferedStream->GetCurrentPosition() != mappedStream->GetCurrentPosition() ||
+			ReadSome(bufferedStream,20) != ReadSome(mappedStream,20))
+		{
+			cout<<"content mismatch when reading after seek - "<<inFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		// zero copy access through the read window
+		LongBufferSizeType windowSize;
+		mappedStream->SetPosition(35);
+		const IOBasicTypes::Byte* window = mappedFile.GetInputStreamWindow()->GetReadWindow(windowSize);
+		if(windowSize != (LongBufferSizeType)(mappedFile.GetFileSize() - 35) || 
+			string((const char*)window,10) != ReadSome(mappedStream,10))
+		{
+			cout<<"read window does not match file content - "<<inFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode MemoryMappedInputFileTest::CreateAndModifyWithMapping(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+	string appendedFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"MemoryMappedAppend.pdf");
+	string modifiedFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"MemoryMappedModify.pdf");
+	string statePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"MemoryMappedModifyState.txt");
+
+	do
+	{
+		// copy pages from a mapped file
+		{
+			PDFWriter pdfWriter;
+			PDFParsingOptions parsingOptions;
+
+			status = pdfWriter.StartPDF(appendedFilePath,ePDFVersion13);
+			if(status != eSuccess)
+			{
+				cout<<"failed to start PDF\n";
+				break;
+			}
+
+			parsingOptions.UseMemoryMapping = true;
+			EStatusCodeAndObjectIDTypeList result = pdfWriter.AppendPDFPagesFromPDF(
+				RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/XObjectContent.PDF"),
+				PDFPageRange(),
+				ObjectIDTypeList(),
+				parsingOptions);
+			if(result.first != eSuccess)
+			{
+				cout<<"failed to append pages from memory mapped file\n";
+				status = eFailure;
+				break;
+			}
+
+			status = pdfWriter.EndPDF();
+			if(status != eSuccess)
+			{
+				cout<<"failed in end PDF\n";
+				break;
+			}
+		}
+
+		// modify the result, reading it mapped
+		{
+			PDFWriter pdfWriter;
+			PDFCreationSettings creationSettings(true,true);
+
+			creationSettings.UseMemoryMappingForModifiedFile = true;
+			status = pdfWriter.ModifyPDF(appendedFilePath,ePDFVersion13,modifiedFilePath,LogConfiguration::DefaultLogConfiguration,creationSettings);
+			if(status != eSuccess)
+			{
+				cout<<"failed to start PDF modification\n";
+				break;
+			}
+
+			if(!pdfWriter.GetModifiedInputFile().IsMemoryMapped())
+			{
+				cout<<"expected modified file to be memory mapped\n";
+				status = eFailure;
+				break;
+			}
+
+			PDFPage* page = new PDFPage();
+			page->SetMediaBox(PDFRectangle(0,0,595,842));
+			status = pdfWriter.WritePageAndRelease(page);
+			if(status != eSuccess)
+			{
+				cout<<"failed to write added page\n";
+				break;
+			}
+
+			status = pdfWriter.Shutdown(statePath);
+			if(status != eSuccess)
+			{
+				cout<<"failed to shutdown PDF modification\n";
+				break;
+			}
+		}
+
+		// continue the modification. the modified file should be mapped again, as in the first session
+		{
+			PDFWriter pdfWriter;
+
+			status = pdfWriter.ContinuePDF(modifiedFilePath,statePath,appendedFilePath);
+			if(status != eSuccess)
+			{
+				cout<<"failed to continue PDF modification\n";
+				break;
+			}
+
+			if(!pdfWriter.GetModifiedInputFile().IsMemoryMapped())
+			{
+				cout<<"expected modified file to be memory mapped in continued session\n";
+				status = eFailure;
+				break;
+			}
+
+			PDFPage* page = new PDFPage();
+			page->SetMediaBox(PDFRectangle(0,0,595,842));
+			status = pdfWriter.WritePageAndRelease(page);
+			if(status != eSuccess)
+			{
+				cout<<"failed to write added page in continued session\n";
+				break;
+			}
+
+			status = pdfWriter.EndPDF();
+			if(status != eSuccess)
+			{
+				cout<<"failed in end PDF\n";
+				break;
+			}
+		}
+
+		// verify
+		InputFile resultFile;
+		PDFParser parser;
+		PDFParsingOptions parsingOptions;
+
+		status = resultFile.OpenFile(modifiedFilePath,true);
+		if(status != eSuccess)
+		{
+			cout<<"unable to open file for reading - "<<modifiedFilePath<<"\n";
+			break;
+		}
+
+		status = parser.StartPDFParsing(resultFile.GetInputStream(),parsingOptions,resultFile.GetInputStreamWindow());
+		if(status != eSuccess)
+		{
+			cout<<"unable to parse file - "<<modifiedFilePath<<"\n";
+			break;
+		}
+
+		if(parser.GetPagesCount() != 4)
+		{
+			cout<<"expected 4 pages in modified file, found "<<parser.GetPagesCount()<<"\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(MemoryMappedInputFileTest,"IO")
@@ -0,0 +1,267 @@
+/*
+   Source File : MetricsTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "MetricsTest.h"
+#include "TestsRunner.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PageContentContext.h"
+#include "PDFUsedFont.h"
+#include "PDFParser.h"
+#include "PDFObject.h"
+#include "PDFMetrics.h"
+#include "InputFile.h"
+#include "RefCountPtr.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+MetricsTest::MetricsTest(void)
+{
+}
+
+MetricsTest::~MetricsTest(void)
+{
+}
+
+EStatusCode MetricsTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+
+	do
+	{
+		status = TestWritingMetrics(inTestConfiguration);
+		if(status != eSuccess)
+			break;
+
+		status = TestCopyingMetrics(inTestConfiguration);
+		if(status != eSuccess)
+			break;
+
+		status = TestParserMetrics(inTestConfiguration);
+	}while(false);
+
+	return status;
+}
+
+EStatusCode MetricsTest::TestWritingMetrics(const TestConfiguration& inTestConfiguration)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+
+	do
+	{
+		status = pdfWriter.StartPDF(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"MetricsTest.pdf"),ePDFVersion13);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF\n";
+			break;
+		}
+
+		PDFUsedFont* font = pdfWriter.GetFontForFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/arial.ttf"));
+		if(!font)
+		{
+			cout<<"failed to create font\n";
+			status = eFailure;
+			break;
+		}
+
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,595,842));
+		PageContentContext* contentContext = pdfWriter.StartPageContentContext(page);
+		contentContext->WriteText(75,805,"Hello metrics",AbstractContentContext::TextOptions(font,14,AbstractContentContext::eGray,0));
+		contentContext->DrawImage(10,100,RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/images/soundcloud_logo.jpg"));
+		status = pdfWriter.EndPageContentContext(contentContext);
+		if(eSuccess == status)
+			status = pdfWriter.WritePageAndRelease(page);
+		if(status != eSuccess)
+		{
+			cout<<"failed to write page\n";
+			break;
+		}
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+		{
+			cout<<"failed to end PDF\n";
+			break;
+		}
+
+		// metrics remain available after the document ends
+		PDFMetricsSnapshot snapshot = pdfWriter.GetMetrics().GetSnapshot();
+		cout<<"Writing metrics: "<<snapshot.ToJSON()<<"\n";
+
+		if(0 == snapshot.Counters.ObjectsWritten || 0 == snapshot.Counters.BytesDeflated)
+		{
+			cout<<"expected objects to be written and streams to be deflated\n";
+			status = eFailure;
+			break;
+		}
+
+		if(snapshot.Counters.FontsSubset != 1 || 0 == snapshot.Counters.GlyphsEmbedded || snapshot.Counters.ImagesWritten != 1)
+		{
+			cout<<"expected 1 font subset with glyphs, and 1 image. got "<<snapshot.Counters.FontsSubset<<" fonts with "<<
+				snapshot.Counters.GlyphsEmbedded<<" glyphs, and "<<snapshot.Counters.ImagesWritten<<" images\n";
+			status = eFailure;
+			break;
+		}
+
+		if(snapshot.Counters.ObjectsParsed != 0 || snapshot.Phases[ePDFMetricsPhaseCopyPages].Count != 0)
+		{
+			cout<<"expected nothing to be parsed or copied\n";
+			status = eFailure;
+			break;
+		}
+
+		if(snapshot.Phases[ePDFMetricsPhaseEndPDF].Count != 1 || snapshot.Phases[ePDFMetricsPhaseFontEmbedding].Count != 1 ||
+			snapshot.Phases[ePDFMetricsPhaseEndPDF].MiliSeconds < snapshot.Phases[ePDFMetricsPhaseFontEmbedding].MiliSeconds)
+		{
+			cout<<"expected end PDF phase once, including font embedding phase once\n";
+			status = eFailure;
+			break;
+		}
+
+		string json = snapshot.ToJSON();
+		if(json.find("\"objectsWritten\":") == string::npos || json.find("\"fontEmbedding\":{\"count\":1,\"milliseconds\":") == string::npos)
+		{
+			cout<<"unexpected metrics JSON "<<json<<"\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode MetricsTest::TestCopyingMetrics(const TestConfiguration& inTestConfiguration)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+
+	do
+	{
+		status = pdfWriter.StartPDF(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"MetricsTestCopying.pdf"),ePDFVersion13);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF\n";
+			break;
+		}
+
+		EStatusCodeAndObjectIDTypeList result = pdfWriter.AppendPDFPagesFromPDF(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/ObjectStreams.pdf"),PDFPageRange());
+		if(result.first != eSuccess)
+		{
+			cout<<"failed to append pages from ObjectStreams.pdf\n";
+			status = result.first;
+			break;
+		}
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+		{
+			cout<<"failed to end PDF\n";
+			break;
+		}
+
+		// the copying parser counts into the writer metrics
+		PDFMetricsSnapshot snapshot = pdfWriter.GetMetrics().GetSnapshot();
+		cout<<"Copying metrics: "<<snapshot.ToJSON()<<"\n";
+
+		if(0 == snapshot.Counters.ObjectsParsed || 0 == snapshot.Counters.BytesInflated || 0 == snapshot.Counters.ObjectStreamCacheMisses)
+		{
+			cout<<"expected objects to be parsed, from object streams, and streams to be inflated\n";
+			status = eFailure;
+			break;
+		}
+
+		if(snapshot.Phases[ePDFMetricsPhaseParseDirectory].Count != 1 || snapshot.Phases[ePDFMetricsPhaseCopyPages].Count != result.second.size())
+		{
+			cout<<"expected directory to be parsed once, and copy phase per page. got "<<snapshot.Phases[ePDFMetricsPhaseParseDirectory].Count<<
+				" and "<<snapshot.Phases[ePDFMetricsPhaseCopyPages].Count<<"\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode MetricsTest::TestParserMetrics(const TestConfiguration& inTestConfiguration)
+{
+	PDFParser parser;
+	InputFile pdfFile;
+	EStatusCode status;
+
+	do
+	{
+		status = pdfFile.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/ObjectStreams.pdf"));
+		if(status != eSuccess)
+		{
+			cout<<"failed to open ObjectStreams.pdf\n";
+			break;
+		}
+
+		status = parser.StartPDFParsing(pdfFile.GetInputStream());
+		if(status != eSuccess)
+		{
+			cout<<"failed to parse ObjectStreams.pdf\n";
+			break;
+		}
+
+		unsigned long long parsedBefore = parser.GetMetrics().GetCounters().ObjectsParsed;
+		unsigned long long parsed = 0;
+		for(ObjectIDType i = 1; i < parser.GetObjectsCount(); ++i)
+		{
+			RefCountPtr<PDFObject> anObject(parser.ParseNewObject(i));
+			if(!!anObject)
+				++parsed;
+		}
+
+		PDFMetricsCounters& counters = parser.GetMetrics().GetCounters();
+		// objects parsed internally, e.g. stream lengths, count as well
+		if(counters.ObjectsParsed - parsedBefore < parsed || 0 == counters.ObjectStreamCacheHits || 0 == counters.ObjectStreamCacheMisses)
+		{
+			cout<<"unexpected parser counters. parsed "<<parsed<<" objects, counted "<<counters.ObjectsParsed - parsedBefore<<
+				", with "<<counters.ObjectStreamCacheHits<<" cache hits and "<<counters.ObjectStreamCacheMisses<<" misses\n";
+			status = eFailure;
+			break;
+		}
+
+		// parsing again starts counting from scratch
+		pdfFile.GetInputStream()->SetPosition(0);
+		status = parser.StartPDFParsing(pdfFile.GetInputStream());
+		if(status != eSuccess)
+		{
+			cout<<"failed to parse ObjectStreams.pdf again\n";
+			break;
+		}
+		if(parser.GetMetrics().GetCounters().ObjectsParsed != parsedBefore || parser.GetMetrics().GetSnapshot().Phases[ePDFMetricsPhaseParseDirectory].Count != 1)
+		{
+			cout<<"expected parser metrics to reset when parsing starts\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(MetricsTest,"IO")
@@ -0,0 +1,37 @@
+/*
+   Source File : MetricsTest.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "ITestUnit.h"
+
+class MetricsTest : public ITestUnit
+{
+public:
+	MetricsTest(void);
+	virtual ~MetricsTest(void);
+
+	virtual PDFHummus::EStatusCode Run(const TestConfiguration& inTestConfiguration);
+
+private:
+	PDFHummus::EStatusCode TestWritingMetrics(const TestConfiguration& inTestConfiguration);
+	PDFHummus::EStatusCode TestCopyingMetrics(const TestConfiguration& inTestConfiguration);
+	PDFHummus::EStatusCode TestParserMetrics(const TestConfiguration& inTestConfiguration);
+};
@@ -0,0 +1,168 @@
+/*
+   Source File : NumberParsingTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "NumberParsingTest.h"
+#include "TestsRunner.h"
+#include "ObjectParsingHelper.h"
+#include "PDFObject.h"
+#include "PDFInteger.h"
+#include "PDFReal.h"
+#include "PDFArray.h"
+#include "PDFIndirectObjectReference.h"
+#include "BoxingBase.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+typedef BoxingBaseWithRW<long long> LongLong;
+
+NumberParsingTest::NumberParsingTest(void)
+{
+}
+
+NumberParsingTest::~NumberParsingTest(void)
+{
+}
+
+EStatusCode NumberParsingTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = TestNumberTokens();
+	
+	if(eSuccess == status)
+		status = TestReferences();
+
+	return status;
+}
+
+EStatusCode NumberParsingTest::TestNumberTokens()
+{
+	// results are compared with the string streams conversion, which was the previous implementation
+	const char* integers[] = {"0","1","-1","+17","007","2147483648","-2147483649","9223372036854775807","-9223372036854775808","-0"};
+	const char* reals[] = {"0.0",".5","-.5","+.25","5.","-3.","1.1","0.1","-123.456","3.14159265358979","0.000001","1234567890.0987654321",
+							"0.00000000000000000000000123","1.7976931348623157","-0.0","100000000000000000000.5"};
+	const char* nonNumbers[] = {"+","-","1.2.3","1a","a1","--1","1-"};
+
+	for(size_t i = 0; i < sizeof(integers)/sizeof(const char*); ++i)
+	{
+		PDFObject* anObject = ObjectParsingHelper::ParseSingleObject(integers[i]);
+		long long expected = LongLong(string(integers[i]));
+		bool ok = anObject && anObject->GetType() == PDFObject::ePDFObjectInteger && ((PDFInteger*)anObject)->GetValue() == expected;
+		if(!ok)
+			cout<<"failed to parse integer "<<integers[i]<<"\n";
+		if(anObject)
+			anObject->Release();
+		if(!ok)
+			return eFailure;
+	}
+
+	for(size_t i = 0; i < sizeof(reals)/sizeof(const char*); ++i)
+	{
+		PDFObject* anObject = ObjectParsingHelper::ParseSingleObject(reals[i]);
+		double expected = Double(string(reals[i]));
+		bool ok = anObject && anObject->GetType() == PDFObject::ePDFObjectReal && ((PDFReal*)anObject)->GetValue() == expected;
+		if(!ok)
+			cout<<"failed to parse real "<<reals[i]<<"\n";
+		if(anObject)
+			anObject->Release();
+		if(!ok)
+			return eFailure;
+	}
+
+	for(size_t i = 0; i < sizeof(nonNumbers)/sizeof(const char*); ++i)
+	{
+		PDFObject* anObject = ObjectParsingHelper::ParseSingleObject(nonNumbers[i]);
+		bool ok = !anObject || (anObject->GetType() != PDFObject::ePDFObjectInteger && anObject->GetType() != PDFObject::ePDFObjectReal);
+		if(!ok)
+			cout<<"parsed non number token "<<nonNumbers[i]<<" as a number\n";
+		if(anObject)
+			anObject->Release();
+		if(!ok)
+			return eFailure;
+	}
+
+	return eSuccess;
+}
+
+EStatusCode NumberParsingTest::TestReferences()
+{
+	// references are parsed from numbers too. make sure near misses stay numbers
+	PDFObject* anObject = ObjectParsingHelper::ParseSingleObject("[12 0 R 12 0 13 1.0 R -5 0 R 7 R]");
+	EStatusCode status = eSuccess;
+
+	do
+	{
+		if(!anObject || anObject->GetType() != PDFObject::ePDFObjectArray)
+		{
+			cout<<"failed to parse references array\n";
+			status = eFailure;
+			break;
+		}
+
+		// expected: ref, 12, 0, 13, 1.0, R, -5, 0, R, 7, R
+		PDFArray* anArray = (PDFArray*)anObject;
+		PDFObject::EPDFObjectType expectedTypes[] = {	PDFObject::ePDFObjectIndirectObjectReference,
+														PDFObject::ePDFObjectInteger,
+														PDFObject::ePDFObjectInteger,
+														PDFObject::ePDFObjectInteger,
+														PDFObject::ePDFObjectReal,
+														PDFObject::ePDFObjectSymbol,
+														PDFObject::ePDFObjectInteger,
+														PDFObject::ePDFObjectInteger,
+														PDFObject::ePDFObjectSymbol,
+														PDFObject::ePDFObjectInteger,
+														PDFObject::ePDFObjectSymbol};
+		unsigned long expectedLength = sizeof(expectedTypes)/sizeof(PDFObject::EPDFObjectType);
+		if(anArray->GetLength() != expectedLength)
+		{
+			cout<<"expected "<<expectedLength<<" objects in references array, got "<<anArray->GetLength()<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		for(unsigned long i = 0; i < expectedLength && eSuccess == status; ++i)
+		{
+			PDFObject* item = anArray->QueryObject(i);
+			if(item->GetType() != expectedTypes[i])
+			{
+				cout<<"unexpected object type at index "<<i<<" of references array\n";
+				status = eFailure;
+			}
+			item->Release();
+		}
+		if(status != eSuccess)
+			break;
+
+		PDFIndirectObjectReference* reference = (PDFIndirectObjectReference*)anArray->QueryObject(0);
+		if(reference->mObjectID != 12 || reference->mVersion != 0)
+		{
+			cout<<"wrong reference parsed\n";
+			status = eFailure;
+		}
+		reference->Release();
+	}while(false);
+
+	if(anObject)
+		anObject->Release();
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(NumberParsingTest,"PDFEmbedding")
@@ -0,0 +1,56 @@
+/*
+   Source File : ObjectParsingHelper.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "ObjectParsingHelper.h"
+#include "PDFObjectParser.h"
+#include "InputByteArrayStream.h"
+#include "AdapterIByteReaderWithPositionToIReadPositionProvider.h"
+#include "PDFParser.h"
+#include "IByteReader.h"
+
+using namespace std;
+using namespace PDFHummus;
+
+PDFObject* ObjectParsingHelper::ParseSingleObject(const string& inSource,PDFObjectsArena* inObjectsArena)
+{
+	InputByteArrayStream stream((IOBasicTypes::Byte*)inSource.c_str(),inSource.size());
+	AdapterIByteReaderWithPositionToIReadPositionProvider positionProvider(&stream);
+	PDFObjectParser parser;
+
+	parser.SetReadStream(&stream,&positionProvider,&stream);
+	parser.SetObjectsArena(inObjectsArena);
+	return parser.ParseNewObject();
+}
+
+EStatusCode ObjectParsingHelper::ReadStream(PDFParser& inParser,PDFStreamInput* inStream,string& outContent)
+{
+	IByteReader* streamReader = inParser.StartReadingFromStream(inStream);
+	if(!streamReader)
+		return eFailure;
+
+	IOBasicTypes::Byte buffer[1024];
+	while(streamReader->NotEnded())
+	{
+		IOBasicTypes::LongBufferSizeType readAmount = streamReader->Read(buffer,1024);
+		outContent.append((const char*)buffer,readAmount);
+	}
+	delete streamReader;
+	return eSuccess;
+}
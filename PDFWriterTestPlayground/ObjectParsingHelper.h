@@ -0,0 +1,42 @@
+/*
+   Source File : ObjectParsingHelper.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "EStatusCode.h"
+
+#include <string>
+
+class PDFObject;
+class PDFObjectsArena;
+class PDFParser;
+class PDFStreamInput;
+
+// parsing of objects from PDF source snippets, for tests of the objects parser, and reading of parsed streams
+class ObjectParsingHelper
+{
+public:
+	// parses the first object in inSource. when inObjectsArena is provided, objects are allocated from it.
+	// returns NULL if parsing failed, otherwise the caller releases the object
+	static PDFObject* ParseSingleObject(const std::string& inSource,PDFObjectsArena* inObjectsArena = NULL);
+
+	// appends the decoded content of inStream to outContent. fails if the stream filters are not supported
+	static PDFHummus::EStatusCode ReadStream(PDFParser& inParser,PDFStreamInput* inStream,std::string& outContent);
+};
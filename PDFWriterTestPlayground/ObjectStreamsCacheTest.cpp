@@ -0,0 +1,236 @@
+/*
+   Source File : ObjectStreamsCacheTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "ObjectStreamsCacheTest.h"
+#include "PDFParser.h"
+#include "PDFParsingOptions.h"
+#include "InputFile.h"
+#include "PDFObject.h"
+#include "PDFDictionary.h"
+#include "PDFArray.h"
+#include "RefCountPtr.h"
+
+#include <iostream>
+#include <sstream>
+#include <set>
+
+using namespace std;
+using namespace PDFHummus;
+
+ObjectStreamsCacheTest::ObjectStreamsCacheTest(void)
+{
+}
+
+ObjectStreamsCacheTest::~ObjectStreamsCacheTest(void)
+{
+}
+
+EStatusCode ObjectStreamsCacheTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = eSuccess;
+	const char* files[] = {"TestMaterials/ObjectStreams.pdf","TestMaterials/ObjectStreamsModified.pdf"};
+
+	for(int i=0; i < 2 && eSuccess == status; ++i)
+	{
+		string filePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,files[i]);
+		string uncached,cached,cachedReverse,tinyCache;
+
+		// no cache - the old way of decoding the object stream per object
+		status = DescribeCompressedObjects(filePath,0,false,uncached);
+		if(status != eSuccess)
+			break;
+
+		status = DescribeCompressedObjects(filePath,DEFAULT_OBJECT_STREAMS_CACHE_SIZE,false,cached);
+		if(status != eSuccess)
+			break;
+
+		status = DescribeCompressedObjects(filePath,DEFAULT_OBJECT_STREAMS_CACHE_SIZE,true,cachedReverse);
+		if(status != eSuccess)
+			break;
+
+		// cache too small to hold any stream, so all decoded streams are used once and dropped
+		status = DescribeCompressedObjects(filePath,1,false,tinyCache);
+		if(status != eSuccess)
+			break;
+
+		if(uncached.size() == 0)
+		{
+			cout<<"expected compressed objects in "<<files[i]<<", found none\n";
+			status = eFailure;
+			break;
+		}
+
+		if(uncached != cached || uncached != cachedReverse || uncached != tinyCache)
+		{
+			cout<<"compressed objects parsed differently with object streams cache in "<<files[i]<<"\n"<<
+				"uncached:\n"<<uncached<<"\ncached:\n"<<cached<<"\ncached reverse:\n"<<cachedReverse<<"\ntiny cache:\n"<<tinyCache<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		status = TestOversizedObjectStreams(filePath);
+	}
+
+	return status;
+}
+
+EStatusCode ObjectStreamsCacheTest::TestOversizedObjectStreams(const string& inFilePath)
+{
+	// with a cache smaller than the object streams, each stream should be decoded fully only once - for the first object read from it.
+	// later objects are read by skipping in the stream, which doesn't go through the cache
+	EStatusCode status = eSuccess;
+	InputFile pdfFile;
+	PDFParser parser;
+	PDFParsingOptions options;
+	set<ObjectIDType> objectStreams;
+	unsigned long compressedObjectsCount = 0;
+
+	do
+	{
+		status = pdfFile.OpenFile(inFilePath);
+		if(status != eSuccess)
+		{
+			cout<<"unable to open file for reading - "<<inFilePath<<"\n";
+			break;
+		}
+
+		options.ObjectStreamsCacheSize = 1;
+		status = parser.StartPDFParsing(pdfFile.GetInputStream(),options);
+		if(status != eSuccess)
+		{
+			cout<<"unable to parse input file - "<<inFilePath<<"\n";
+			break;
+		}
+
+		// read each object twice, so repeated lookups are covered as well
+		for(int pass = 0; pass < 2 && eSuccess == status; ++pass)
+		{
+			for(ObjectIDType i = 0; i < parser.GetObjectsCount(); ++i)
+			{
+				if(parser.GetXrefEntry(i)->mType != eXrefEntryStreamObject)
+					continue;
+
+				RefCountPtr<PDFObject> anObject(parser.ParseNewObject(i));
+				if(!anObject)
+				{
+					cout<<"failed to parse compressed object "<<i<<" from an oversized object stream\n";
+					status = eFailure;
+					break;
+				}
+				objectStreams.insert((ObjectIDType)parser.GetXrefEntry(i)->mObjectPosition);
+				++compressedObjectsCount;
+			}
+		}
+		if(status != eSuccess)
+			break;
+
+		// parser metrics start with the parsing, so this includes streams decoded for reading the catalog
+		unsigned long long decodedStreamsCount = parser.GetMetrics().GetCounters().ObjectStreamCacheMisses;
+		if(compressedObjectsCount <= 2*objectStreams.size() || decodedStreamsCount != objectStreams.size())
+		{
+			cout<<"expected oversized object streams to be decoded once each. read "<<compressedObjectsCount<<" objects from "<<
+				objectStreams.size()<<" streams, decoding "<<decodedStreamsCount<<" times\n";
+			status = eFailure;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ObjectStreamsCacheTest::DescribeCompressedObjects(const string& inFilePath,
+															LongBufferSizeType inCacheSize,
+															bool inReverseOrder,
+															string& outDescription)
+{
+	EStatusCode status = eSuccess;
+	InputFile pdfFile;
+	PDFParser parser;
+	PDFParsingOptions options;
+	stringstream description;
+
+	do
+	{
+		status = pdfFile.OpenFile(inFilePath);
+		if(status != eSuccess)
+		{
+			cout<<"unable to open file for reading - "<<inFilePath<<"\n";
+			break;
+		}
+
+		options.ObjectStreamsCacheSize = inCacheSize;
+		status = parser.StartPDFParsing(pdfFile.GetInputStream(),options);
+		if(status != eSuccess)
+		{
+			cout<<"unable to parse input file - "<<inFilePath<<"\n";
+			break;
+		}
+
+		ObjectIDType objectsCount = parser.GetObjectsCount();
+		for(ObjectIDType i = 0; i < objectsCount && eSuccess == status; ++i)
+		{
+			ObjectIDType objectID = inReverseOrder ? objectsCount - 1 - i : i;
+			if(parser.GetXrefEntry(objectID)->mType != eXrefEntryStreamObject)
+				continue;
+
+			RefCountPtr<PDFObject> anObject(parser.ParseNewObject(objectID));
+			if(!anObject)
+			{
+				cout<<"failed to parse compressed object "<<objectID<<" with cache size "<<inCacheSize<<"\n";
+				status = eFailure;
+				break;
+			}
+
+			// describe the object by its type and keys/size, which is good enough for telling objects apart
+			description<<objectID<<" "<<PDFObject::scPDFObjectTypeLabel[anObject->GetType()];
+			if(anObject->GetType() == PDFObject::ePDFObjectDictionary)
+			{
+				MapIterator<PDFNameToPDFObjectMap> it = ((PDFDictionary*)anObject.GetPtr())->GetIterator();
+				while(it.MoveNext())
+					description<<" "<<it.GetKey()->GetValue();
+			}
+			else if(anObject->GetType() == PDFObject::ePDFObjectArray)
+				description<<" "<<((PDFArray*)anObject.GetPtr())->GetLength();
+			description<<"\n";
+		}
+
+	}while(false);
+
+	if(eSuccess == status)
+	{
+		// order the description by object ID, so that reverse iteration results can be compared
+		if(inReverseOrder)
+		{
+			string line;
+			StringList lines;
+			while(getline(description,line))
+				lines.push_front(line);
+			stringstream ordered;
+			for(StringList::iterator it = lines.begin(); it != lines.end(); ++it)
+				ordered<<*it<<"\n";
+			outDescription = ordered.str();
+		}
+		else
+			outDescription = description.str();
+	}
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(ObjectStreamsCacheTest,"PDFEmbedding")
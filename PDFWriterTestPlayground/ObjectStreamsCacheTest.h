@@ -0,0 +1,43 @@
+/*
+   Source File : ObjectStreamsCacheTest.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "TestsRunner.h"
+#include "IOBasicTypes.h"
+
+#include <string>
+
+class ObjectStreamsCacheTest : public ITestUnit
+{
+public:
+	ObjectStreamsCacheTest(void);
+	virtual ~ObjectStreamsCacheTest(void);
+
+	virtual PDFHummus::EStatusCode Run(const TestConfiguration& inTestConfiguration);
+
+private:
+
+	PDFHummus::EStatusCode DescribeCompressedObjects(const std::string& inFilePath,
+													IOBasicTypes::LongBufferSizeType inCacheSize,
+													bool inReverseOrder,
+													std::string& outDescription);
+	PDFHummus::EStatusCode TestOversizedObjectStreams(const std::string& inFilePath);
+};
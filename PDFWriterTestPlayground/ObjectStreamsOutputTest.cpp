@@ -0,0 +1,278 @@
+/*
+   Source File : ObjectStreamsOutputTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "ObjectStreamsOutputTest.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PDFRectangle.h"
+#include "PageContentContext.h"
+#include "PDFParser.h"
+#include "InputFile.h"
+#include "PDFObject.h"
+#include "PDFDictionary.h"
+#include "PDFName.h"
+#include "PDFObjectCast.h"
+#include "RefCountPtr.h"
+
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+using namespace PDFHummus;
+
+#define PAGES_COUNT 10
+
+ObjectStreamsOutputTest::ObjectStreamsOutputTest(void)
+{
+}
+
+ObjectStreamsOutputTest::~ObjectStreamsOutputTest(void)
+{
+}
+
+EStatusCode ObjectStreamsOutputTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+
+	do
+	{
+		status = CreateFile(inTestConfiguration,"ObjectStreamsOutput.pdf",true);
+		if(status != eSuccess)
+			break;
+
+		status = VerifyFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"ObjectStreamsOutput.pdf"),PAGES_COUNT,true);
+		if(status != eSuccess)
+			break;
+
+		// same content without object streams, for reference
+		status = CreateFile(inTestConfiguration,"ObjectStreamsOutputReference.pdf",false);
+		if(status != eSuccess)
+			break;
+
+		status = VerifyFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"ObjectStreamsOutputReference.pdf"),PAGES_COUNT,false);
+		if(status != eSuccess)
+			break;
+
+		// incremental update of a file written with object streams, adding objects in a new object stream
+		status = AddPageToFile(inTestConfiguration,"ObjectStreamsOutput.pdf","ObjectStreamsOutputModified.pdf");
+		if(status != eSuccess)
+			break;
+
+		status = VerifyFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"ObjectStreamsOutputModified.pdf"),PAGES_COUNT+1,true);
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ObjectStreamsOutputTest::CreateFile(const TestConfiguration& inTestConfiguration,
+												const string& inFileName,
+												bool inUseObjectStreams)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+
+	do
+	{
+		status = pdfWriter.StartPDF(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileName),
+									ePDFVersion15,
+									LogConfiguration::DefaultLogConfiguration,
+									PDFCreationSettings(true,true,EncryptionOptions::DefaultEncryptionOptions,inUseObjectStreams));
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF\n";
+			break;
+		}
+
+		PDFUsedFont* font = pdfWriter.GetFontForFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/arial.ttf"));
+		if(!font)
+		{
+			status = eFailure;
+			cout<<"failed to create font object for arial.ttf\n";
+			break;
+		}
+
+		AbstractContentContext::TextOptions textOptions(font,14,AbstractContentContext::eGray,0);
+
+		for(int i=0;i<PAGES_COUNT && eSuccess == status;++i)
+		{
+			PDFPage* page = new PDFPage();
+			page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+			PageContentContext* contentContext = pdfWriter.StartPageContentContext(page);
+			stringstream text;
+			text<<"Page "<<(i+1);
+			contentContext->WriteText(75,805,text.str(),textOptions);
+
+			status = pdfWriter.EndPageContentContext(contentContext);
+			if(status != eSuccess)
+			{
+				cout<<"failed to end content context for page "<<i<<"\n";
+				delete page;
+				break;
+			}
+
+			status = pdfWriter.WritePageAndRelease(page);
+			if(status != eSuccess)
+				cout<<"failed to write page "<<i<<"\n";
+		}
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+			cout<<"failed in end PDF\n";
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ObjectStreamsOutputTest::AddPageToFile(const TestConfiguration& inTestConfiguration,
+												   const string& inSourceFileName,
+												   const string& inTargetFileName)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+
+	do
+	{
+		status = pdfWriter.ModifyPDF(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inSourceFileName),
+									 ePDFVersion15,
+									 RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inTargetFileName),
+									 LogConfiguration::DefaultLogConfiguration,
+									 PDFCreationSettings(true,true,EncryptionOptions::DefaultEncryptionOptions,true));
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF modification\n";
+			break;
+		}
+
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+		PageContentContext* contentContext = pdfWriter.StartPageContentContext(page);
+		contentContext->WriteText(75,805,"Added Page",
+								  AbstractContentContext::TextOptions(pdfWriter.GetFontForFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/arial.ttf")),
+																	  14,AbstractContentContext::eGray,0));
+		status = pdfWriter.EndPageContentContext(contentContext);
+		if(status != eSuccess)
+		{
+			cout<<"failed to end content context for added page\n";
+			delete page;
+			break;
+		}
+
+		status = pdfWriter.WritePageAndRelease(page);
+		if(status != eSuccess)
+		{
+			cout<<"failed to write added page\n";
+			break;
+		}
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+			cout<<"failed in end PDF\n";
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ObjectStreamsOutputTest::VerifyFile(const string& inFilePath,
+												unsigned long inExpectedPagesCount,
+												bool inExpectCompressedObjects)
+{
+	EStatusCode status;
+	InputFile pdfFile;
+	PDFParser parser;
+
+	do
+	{
+		status = pdfFile.OpenFile(inFilePath);
+		if(status != eSuccess)
+		{
+			cout<<"unable to open file for reading - "<<inFilePath<<"\n";
+			break;
+		}
+
+		status = parser.StartPDFParsing(pdfFile.GetInputStream());
+		if(status != eSuccess)
+		{
+			cout<<"unable to parse file - "<<inFilePath<<"\n";
+			break;
+		}
+
+		if(parser.GetPagesCount() != inExpectedPagesCount)
+		{
+			cout<<"expected "<<inExpectedPagesCount<<" pages in "<<inFilePath<<", found "<<parser.GetPagesCount()<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		PDFObjectCastPtr<PDFName> trailerType(parser.GetTrailer()->QueryDirectObject("Type"));
+		bool hasXrefStream = trailerType.GetPtr() && trailerType->GetValue() == "XRef";
+		if(hasXrefStream != inExpectCompressedObjects)
+		{
+			cout<<"unexpected xref form in "<<inFilePath<<", expected "<<(inExpectCompressedObjects ? "xref stream":"xref table")<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		// all objects should be readable, and some of them compressed if object streams were used
+		unsigned long compressedObjectsCount = 0;
+		for(ObjectIDType i = 1; i < parser.GetObjectsCount() && eSuccess == status; ++i)
+		{
+			XrefEntryInput* entry = parser.GetXrefEntry(i);
+			if(entry->mType == eXrefEntryDelete)
+				continue;
+			if(entry->mType == eXrefEntryStreamObject)
+				++compressedObjectsCount;
+
+			RefCountPtr<PDFObject> anObject(parser.ParseNewObject(i));
+			if(!anObject)
+			{
+				cout<<"failed to parse object "<<i<<" in "<<inFilePath<<"\n";
+				status = eFailure;
+			}
+		}
+		if(status != eSuccess)
+			break;
+
+		if((compressedObjectsCount > 0) != inExpectCompressedObjects)
+		{
+			cout<<"found "<<compressedObjectsCount<<" compressed objects in "<<inFilePath<<", which is not what's expected\n";
+			status = eFailure;
+			break;
+		}
+
+		for(unsigned long i = 0; i < inExpectedPagesCount; ++i)
+		{
+			RefCountPtr<PDFDictionary> page(parser.ParsePage(i));
+			if(!page)
+			{
+				cout<<"failed to parse page "<<i<<" in "<<inFilePath<<"\n";
+				status = eFailure;
+				break;
+			}
+		}
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(ObjectStreamsOutputTest,"PDF")
@@ -0,0 +1,263 @@
+/*
+   Source File : ObjectsArenaTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "ObjectsArenaTest.h"
+#include "TestsRunner.h"
+#include "PDFParser.h"
+#include "PDFParsingOptions.h"
+#include "ObjectParsingHelper.h"
+#include "InputFile.h"
+#include "PDFObject.h"
+#include "PDFDictionary.h"
+#include "PDFArray.h"
+#include "PDFName.h"
+#include "PDFInteger.h"
+#include "PDFReal.h"
+#include "PDFIndirectObjectReference.h"
+#include "RefCountPtr.h"
+
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+using namespace PDFHummus;
+
+ObjectsArenaTest::ObjectsArenaTest(void)
+{
+}
+
+ObjectsArenaTest::~ObjectsArenaTest(void)
+{
+}
+
+EStatusCode ObjectsArenaTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = TestDictionaryEntries();
+	const char* files[] = {"TestMaterials/ObjectStreams.pdf","TestMaterials/Linearized.pdf","TestMaterials/Original.pdf"};
+
+	for(int i=0; i < 3 && eSuccess == status; ++i)
+		status = TestParsingWithArena(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,files[i]));
+
+	return status;
+}
+
+EStatusCode ObjectsArenaTest::TestDictionaryEntries()
+{
+	// keys out of order
+	RefCountPtr<PDFObject> anObject(ObjectParsingHelper::ParseSingleObject("<< /Width 10 /Type /XObject /Height 20 /BBox [0 0 1 1] >>"));
+	EStatusCode status = eSuccess;
+
+	do
+	{
+		if(!anObject || anObject->GetType() != PDFObject::ePDFObjectDictionary)
+		{
+			cout<<"failed to parse dictionary\n";
+			status = eFailure;
+			break;
+		}
+
+		// a repeated key is ignored, the first value is the one kept
+		PDFDictionary* aDictionary = (PDFDictionary*)anObject.GetPtr();
+		PDFName* repeatedKey = new PDFName("Width");
+		PDFInteger* repeatedValue = new PDFInteger(30);
+		aDictionary->Insert(repeatedKey,repeatedValue);
+		repeatedKey->Release();
+		repeatedValue->Release();
+
+		stringstream keys;
+		MapIterator<PDFNameToPDFObjectMap> it = aDictionary->GetIterator();
+		while(it.MoveNext())
+			keys<<"/"<<it.GetKey()->GetValue();
+		if(keys.str() != "/BBox/Height/Type/Width")
+		{
+			cout<<"unexpected dictionary keys iteration "<<keys.str()<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		RefCountPtr<PDFObject> width(aDictionary->QueryDirectObject("Width"));
+		if(!width || width->GetType() != PDFObject::ePDFObjectInteger || ((PDFInteger*)width.GetPtr())->GetValue() != 10)
+		{
+			cout<<"expected first Width entry to be kept\n";
+			status = eFailure;
+			break;
+		}
+
+		if(!aDictionary->Exists("Type") || aDictionary->Exists("Subtype") || aDictionary->Exists("Widt"))
+		{
+			cout<<"wrong dictionary keys existence\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+void ObjectsArenaTest::DescribeObject(PDFObject* inObject,ostream& outDescription)
+{
+	outDescription<<PDFObject::scPDFObjectTypeLabel[inObject->GetType()];
+	switch(inObject->GetType())
+	{
+		case PDFObject::ePDFObjectName:
+			outDescription<<" /"<<((PDFName*)inObject)->GetValue();
+			break;
+		case PDFObject::ePDFObjectInteger:
+			outDescription<<" "<<((PDFInteger*)inObject)->GetValue();
+			break;
+		case PDFObject::ePDFObjectReal:
+			outDescription<<" "<<((PDFReal*)inObject)->GetValue();
+			break;
+		case PDFObject::ePDFObjectIndirectObjectReference:
+			outDescription<<" "<<((PDFIndirectObjectReference*)inObject)->mObjectID<<" "<<((PDFIndirectObjectReference*)inObject)->mVersion;
+			break;
+		case PDFObject::ePDFObjectArray:
+		{
+			PDFArray* anArray = (PDFArray*)inObject;
+			outDescription<<" [";
+			for(unsigned long i = 0; i < anArray->GetLength(); ++i)
+			{
+				RefCountPtr<PDFObject> item(anArray->QueryObject(i));
+				outDescription<<" ";
+				DescribeObject(item.GetPtr(),outDescription);
+			}
+			outDescription<<" ]";
+			break;
+		}
+		case PDFObject::ePDFObjectDictionary:
+		{
+			MapIterator<PDFNameToPDFObjectMap> it = ((PDFDictionary*)inObject)->GetIterator();
+			outDescription<<" <<";
+			while(it.MoveNext())
+			{
+				outDescription<<" /"<<it.GetKey()->GetValue()<<" ";
+				DescribeObject(it.GetValue(),outDescription);
+			}
+			outDescription<<" >>";
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+EStatusCode ObjectsArenaTest::DescribeAllObjects(const string& inFilePath,bool inUseObjectsArena,string& outDescription)
+{
+	EStatusCode status = eSuccess;
+	InputFile pdfFile;
+	PDFParser parser;
+	PDFParsingOptions options;
+	stringstream description;
+
+	do
+	{
+		status = pdfFile.OpenFile(inFilePath);
+		if(status != eSuccess)
+		{
+			cout<<"unable to open file for reading - "<<inFilePath<<"\n";
+			break;
+		}
+
+		options.UseObjectsArena = inUseObjectsArena;
+		status = parser.StartPDFParsing(pdfFile.GetInputStream(),options);
+		if(status != eSuccess)
+		{
+			cout<<"unable to parse input file - "<<inFilePath<<"\n";
+			break;
+		}
+
+		if((parser.GetObjectsArena() != NULL) != inUseObjectsArena)
+		{
+			cout<<"parser objects arena does not match parsing options\n";
+			status = eFailure;
+			break;
+		}
+
+		for(ObjectIDType i = 0; i < parser.GetObjectsCount(); ++i)
+		{
+			RefCountPtr<PDFObject> anObject(parser.ParseNewObject(i));
+			if(!anObject)
+				continue;
+			description<<i<<" ";
+			DescribeObject(anObject.GetPtr(),description);
+			description<<"\n";
+		}
+
+	}while(false);
+
+	outDescription = description.str();
+	return status;
+}
+
+EStatusCode ObjectsArenaTest::TestParsingWithArena(const string& inFilePath)
+{
+	EStatusCode status = eSuccess;
+	string heapDescription,arenaDescription;
+
+	do
+	{
+		status = DescribeAllObjects(inFilePath,false,heapDescription);
+		if(status != eSuccess)
+			break;
+
+		status = DescribeAllObjects(inFilePath,true,arenaDescription);
+		if(status != eSuccess)
+			break;
+
+		if(heapDescription.size() == 0 || heapDescription != arenaDescription)
+		{
+			cout<<"objects parsed differently with objects arena in "<<inFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		// objects taken from a parsing session remain valid after the parser is reset and destroyed
+		InputFile pdfFile;
+		PDFParser* parser = new PDFParser();
+		PDFParsingOptions options;
+		RefCountPtr<PDFDictionary> trailer;
+
+		options.UseObjectsArena = true;
+		status = pdfFile.OpenFile(inFilePath);
+		if(status == eSuccess)
+			status = parser->StartPDFParsing(pdfFile.GetInputStream(),options);
+		if(status != eSuccess)
+		{
+			cout<<"unable to parse input file - "<<inFilePath<<"\n";
+			delete parser;
+			break;
+		}
+		trailer = parser->GetTrailer();
+		stringstream before,after;
+		DescribeObject(trailer.GetPtr(),before);
+		delete parser;
+		DescribeObject(trailer.GetPtr(),after);
+		if(before.str() != after.str())
+		{
+			cout<<"trailer changed after parser was destroyed in "<<inFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(ObjectsArenaTest,"PDFEmbedding")
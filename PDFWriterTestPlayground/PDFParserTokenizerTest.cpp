@@ -0,0 +1,109 @@
+/*
+   Source File : PDFParserTokenizerTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "PDFParserTokenizerTest.h"
+#include "PDFParserTokenizer.h"
+#include "InputFile.h"
+#include "InputStringStream.h"
+#include "InputByteArrayStream.h"
+#include "InputBufferedStream.h"
+#include "OutputStringBufferStream.h"
+#include "OutputStreamTraits.h"
+
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+using namespace PDFHummus;
+
+PDFParserTokenizerTest::PDFParserTokenizerTest(void)
+{
+}
+
+PDFParserTokenizerTest::~PDFParserTokenizerTest(void)
+{
+}
+
+EStatusCode PDFParserTokenizerTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = eSuccess;
+	const char* files[] = {"TestMaterials/XObjectContent.PDF","TestMaterials/ObjectStreams.pdf","TestMaterials/Linearized.pdf","TestMaterials/AddedPage.pdf"};
+
+	for(int i=0; i < 4 && eSuccess == status; ++i)
+	{
+		InputFile pdfFile;
+		OutputStringBufferStream fileContent;
+
+		status = pdfFile.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,files[i]));
+		if(status != eSuccess)
+		{
+			cout<<"unable to open file for reading - "<<files[i]<<"\n";
+			break;
+		}
+
+		OutputStreamTraits traits(&fileContent);
+		status = traits.CopyToOutputStream(pdfFile.GetInputStream());
+		if(status != eSuccess)
+		{
+			cout<<"unable to read file - "<<files[i]<<"\n";
+			break;
+		}
+		string content = fileContent.ToString();
+
+		// byte by byte reading, as reference
+		InputStringStream stringStream(content);
+		string reference = DescribeTokens(&stringStream,NULL);
+
+		// scanning the whole content as a single window
+		InputByteArrayStream arrayStream((IOBasicTypes::Byte*)content.c_str(),content.size());
+		string singleWindow = DescribeTokens(&arrayStream,&arrayStream);
+
+		// scanning small windows, to get tokens crossing window boundaries
+		InputByteArrayStream* sourceStream = new InputByteArrayStream((IOBasicTypes::Byte*)content.c_str(),content.size());
+		InputBufferedStream bufferedStream(sourceStream,7);
+		string smallWindows = DescribeTokens(&bufferedStream,&bufferedStream);
+
+		if(reference.size() == 0 || reference != singleWindow || reference != smallWindows)
+		{
+			cout<<"tokenizing with read windows provides different tokens than byte by byte reading for "<<files[i]<<"\n";
+			status = eFailure;
+		}
+	}
+
+	return status;
+}
+
+string PDFParserTokenizerTest::DescribeTokens(IByteReaderWithPosition* inStream,IReadWindowProvider* inStreamWindow)
+{
+	PDFParserTokenizer tokenizer;
+	stringstream description;
+	string token;
+
+	tokenizer.SetReadStream(inStream,inStreamWindow);
+	while(tokenizer.GetNextToken(token))
+	{
+		// the stream should be in sync with the tokenizer after each token, so compare what the tokenizer
+		// sees as the current position as well
+		description<<tokenizer.GetRecentTokenPosition()<<" "<<(inStream->GetCurrentPosition() - tokenizer.GetReadBufferSize())<<" "<<token<<"\n";
+	}
+	return description.str();
+}
+
+ADD_CATEGORIZED_TEST(PDFParserTokenizerTest,"PDFEmbedding")
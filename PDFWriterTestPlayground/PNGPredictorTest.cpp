@@ -0,0 +1,396 @@
+/*
+   Source File : PNGPredictorTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "PNGPredictorTest.h"
+#include "InputPredictorPNGNoneStream.h"
+#include "InputPredictorPNGSubStream.h"
+#include "InputPredictorPNGUpStream.h"
+#include "InputPredictorPNGAverageStream.h"
+#include "InputPredictorPNGPaethStream.h"
+#include "InputPredictorPNGOptimumStream.h"
+#include "InputPredictorTIFFSubStream.h"
+#include "InputByteArrayStream.h"
+#include "IByteReader.h"
+#include "Timer.h"
+
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+using namespace IOBasicTypes;
+using namespace PDFHummus;
+
+#define BENCHMARK_COLUMNS 4096
+#define BENCHMARK_ROWS 1024
+
+PNGPredictorTest::PNGPredictorTest(void)
+{
+}
+
+PNGPredictorTest::~PNGPredictorTest(void)
+{
+}
+
+static string CreateImageData(LongBufferSizeType inRowSize,LongBufferSizeType inRowsCount)
+{
+	// gradients with some noise, so all predictors have something to work with
+	string result;
+	unsigned long seed = 4321;
+
+	result.reserve(inRowSize*inRowsCount);
+	for(LongBufferSizeType row = 0; row < inRowsCount; ++row)
+	{
+		for(LongBufferSizeType i = 0; i < inRowSize; ++i)
+		{
+			seed = seed * 1103515245 + 12345;
+			result.push_back((char)(row*3 + i*5 + ((seed >> 16) & 0x1f)));
+		}
+	}
+	return result;
+}
+
+static Byte PaethPredictor(int inLeft,int inUp,int inUpLeft)
+{
+	int p = inLeft + inUp - inUpLeft;
+	int pLeft = abs(p - inLeft);
+	int pUp = abs(p - inUp);
+	int pUpLeft = abs(p - inUpLeft);
+
+	if(pLeft <= pUp && pLeft <= pUpLeft)
+		return (Byte)inLeft;
+	else if(pUp <= pUpLeft)
+		return (Byte)inUp;
+	else
+		return (Byte)inUpLeft;
+}
+
+// reference implementation of PNG prediction for a single byte, per the PNG specification
+static Byte PredictByte(Byte inFilterType,Byte inLeft,Byte inUp,Byte inUpLeft)
+{
+	switch(inFilterType)
+	{
+		case 1:
+			return inLeft;
+		case 2:
+			return inUp;
+		case 3:
+			return (Byte)(((int)inLeft + inUp) / 2);
+		case 4:
+			return PaethPredictor(inLeft,inUp,inUpLeft);
+		default:
+			return 0;
+	}
+}
+
+static string EncodePNG(const string& inData,LongBufferSizeType inRowSize,LongBufferSizeType inBytesPerPixel,Byte inPredictor)
+{
+	string result;
+	string zeroRow(inRowSize,'\0');
+	LongBufferSizeType rowsCount = inData.size() / inRowSize;
+
+	for(LongBufferSizeType row = 0; row < rowsCount; ++row)
+	{
+		const Byte* current = (const Byte*)inData.c_str() + row*inRowSize;
+		const Byte* up = row > 0 ? current - inRowSize : (const Byte*)zeroRow.c_str();
+
+		// optimum cycles through all filter types
+		Byte filterType = (15 == inPredictor) ? (Byte)(row % 5) : (Byte)(inPredictor - 10);
+		result.push_back((char)filterType);
+		for(LongBufferSizeType i = 0; i < inRowSize; ++i)
+		{
+			Byte left = i >= inBytesPerPixel ? current[i - inBytesPerPixel] : 0;
+			Byte upLeft = i >= inBytesPerPixel ? up[i - inBytesPerPixel] : 0;
+			result.push_back((char)(current[i] - PredictByte(filterType,left,up[i],upLeft)));
+		}
+	}
+	return result;
+}
+
+static IByteReader* CreatePNGDecoder(IByteReader* inSource,Byte inPredictor,LongBufferSizeType inColumns,LongBufferSizeType inColors,LongBufferSizeType inBitsPerComponent)
+{
+	switch(inPredictor)
+	{
+		case 10:
+			return new InputPredictorPNGNoneStream(inSource,inColumns,inColors,inBitsPerComponent);
+		case 11:
+			return new InputPredictorPNGSubStream(inSource,inColumns,inColors,inBitsPerComponent);
+		case 12:
+			return new InputPredictorPNGUpStream(inSource,inColumns,inColors,inBitsPerComponent);
+		case 13:
+			return new InputPredictorPNGAverageStream(inSource,inColumns,inColors,inBitsPerComponent);
+		case 14:
+			return new InputPredictorPNGPaethStream(inSource,inColumns,inColors,inBitsPerComponent);
+		default:
+			return new InputPredictorPNGOptimumStream(inSource,inColumns,inColors,inBitsPerComponent);
+	}
+}
+
+/*
+	byte at a time decoder, in the fashion of the predictor streams before they decoded whole rows. 
+	used as a baseline for the benchmark.
+*/
+class ByteLoopPNGDecoder : public IByteReader
+{
+public:
+	ByteLoopPNGDecoder(IByteReader* inSourceStream,LongBufferSizeType inRowSize,LongBufferSizeType inBytesPerPixel)
+	{
+		mSourceStream = inSourceStream;
+		mBytesPerPixel = inBytesPerPixel;
+		mBufferSize = inRowSize + 1;
+		mBuffer = new Byte[mBufferSize];
+		mUpValues = new Byte[mBufferSize];
+		memset(mBuffer,0,mBufferSize);
+		mIndex = mBuffer + mBufferSize;
+		mFunctionType = 0;
+	}
+
+	virtual ~ByteLoopPNGDecoder()
+	{
+		delete[] mBuffer;
+		delete[] mUpValues;
+		delete mSourceStream;
+	}
+
+	virtual LongBufferSizeType Read(Byte* inBuffer,LongBufferSizeType inBufferSize)
+	{
+		LongBufferSizeType readBytes = 0;
+
+		while(readBytes < inBufferSize)
+		{
+			if(mBufferSize == (LongBufferSizeType)(mIndex - mBuffer))
+			{
+				if(!mSourceStream->NotEnded())
+					break;
+				memcpy(mUpValues,mBuffer,mBufferSize);
+				if(mSourceStream->Read(mBuffer,mBufferSize) != mBufferSize)
+					return 0;
+				mFunctionType = *mBuffer;
+				mIndex = mBuffer + 1;
+			}
+			DecodeNextByte(inBuffer[readBytes]);
+			++readBytes;
+		}
+		return readBytes;
+	}
+
+	virtual bool NotEnded()
+	{
+		return mSourceStream->NotEnded() || (LongBufferSizeType)(mIndex - mBuffer) < mBufferSize;
+	}
+
+private:
+	IByteReader* mSourceStream;
+	LongBufferSizeType mBytesPerPixel;
+	Byte* mBuffer;
+	LongBufferSizeType mBufferSize;
+	Byte* mIndex;
+	Byte mFunctionType;
+	Byte* mUpValues;
+
+	void DecodeNextByte(Byte& outDecodedByte)
+	{
+		LongBufferSizeType position = mIndex - mBuffer;
+		bool hasLeft = position > mBytesPerPixel;
+		outDecodedByte = (Byte)(*mIndex + PredictByte(mFunctionType,
+													  hasLeft ? mBuffer[position - mBytesPerPixel] : 0,
+													  mUpValues[position],
+													  hasLeft ? mUpValues[position - mBytesPerPixel] : 0));
+		*mIndex = outDecodedByte;
+		++mIndex;
+	}
+};
+
+EStatusCode PNGPredictorTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = eSuccess;
+
+	// all PNG predictors, with pixels of 1, 3 and 4 bytes (to go through both the scalar and the SSE kernels), and sub-byte components
+	for(Byte predictor = 10; predictor <= 15 && eSuccess == status; ++predictor)
+	{
+		status = TestPNGPredictor(predictor,37,1,8);
+		if(status != eSuccess)
+			break;
+		status = TestPNGPredictor(predictor,37,3,8);
+		if(status != eSuccess)
+			break;
+		status = TestPNGPredictor(predictor,37,4,8);
+		if(status != eSuccess)
+			break;
+		status = TestPNGPredictor(predictor,37,2,16);
+		if(status != eSuccess)
+			break;
+		status = TestPNGPredictor(predictor,37,1,4);
+	}
+
+	// TIFF predictor, for all supported component sizes
+	if(eSuccess == status)
+		status = TestTIFFPredictor(37,3,8);
+	if(eSuccess == status)
+		status = TestTIFFPredictor(37,2,16);
+	if(eSuccess == status)
+		status = TestTIFFPredictor(37,1,4);
+	if(eSuccess == status)
+		status = TestTIFFPredictor(37,3,2);
+	if(eSuccess == status)
+		status = TestTIFFPredictor(37,1,1);
+
+	if(eSuccess == status)
+		RunBenchmark();
+
+	return status;
+}
+
+EStatusCode PNGPredictorTest::TestPNGPredictor(Byte inPredictor,LongBufferSizeType inColumns,LongBufferSizeType inColors,LongBufferSizeType inBitsPerComponent)
+{
+	LongBufferSizeType rowSize = (inColumns*inColors*inBitsPerComponent + 7)/8;
+	LongBufferSizeType bytesPerPixel = (inColors*inBitsPerComponent + 7)/8;
+	string data = CreateImageData(rowSize,23);
+	string encoded = EncodePNG(data,rowSize,bytesPerPixel,inPredictor);
+
+	IByteReader* decoder = CreatePNGDecoder(new InputByteArrayStream((Byte*)encoded.c_str(),encoded.size()),
+											inPredictor,
+											inColumns,
+											inColors,
+											inBitsPerComponent);
+
+	char description[100];
+	sprintf(description,"predictor %d, %ld colors, %ld bits per component",inPredictor,(long)inColors,(long)inBitsPerComponent);
+	EStatusCode status = CompareDecoded(decoder,data,description);
+	delete decoder;
+	return status;
+}
+
+EStatusCode PNGPredictorTest::TestTIFFPredictor(LongBufferSizeType inColumns,LongBufferSizeType inColors,LongBufferSizeType inBitsPerComponent)
+{
+	LongBufferSizeType rowSize = (inColumns*inColors*inBitsPerComponent + 7)/8;
+	LongBufferSizeType rowsCount = 23;
+	string data = CreateImageData(rowSize,rowsCount);
+	string encoded = data;
+	unsigned int mask = (1<<inBitsPerComponent) - 1;
+
+	// clear padding bits, which are not part of any component, and then difference each component from the one to its left
+	LongBufferSizeType usedBits = inColumns*inColors*inBitsPerComponent;
+	for(LongBufferSizeType row = 0; row < rowsCount; ++row)
+	{
+		Byte* rowData = (Byte*)data.c_str() + row*rowSize;
+		if(usedBits % 8 != 0)
+			rowData[rowSize - 1] &= (Byte)(0xff << (8 - usedBits % 8));
+
+		Byte* encodedRow = (Byte*)encoded.c_str() + row*rowSize;
+		memcpy(encodedRow,rowData,rowSize);
+		for(LongBufferSizeType i = inColors; i < inColumns*inColors; ++i)
+		{
+			unsigned int value = 0,left = 0;
+			for(LongBufferSizeType bit = 0; bit < inBitsPerComponent; ++bit)
+			{
+				LongBufferSizeType position = i*inBitsPerComponent + bit;
+				LongBufferSizeType leftPosition = (i - inColors)*inBitsPerComponent + bit;
+				value = (value<<1) | ((rowData[position/8] >> (7 - position%8)) & 1);
+				left = (left<<1) | ((rowData[leftPosition/8] >> (7 - leftPosition%8)) & 1);
+			}
+			unsigned int difference = (value - left) & mask;
+			for(LongBufferSizeType bit = 0; bit < inBitsPerComponent; ++bit)
+			{
+				LongBufferSizeType position = i*inBitsPerComponent + bit;
+				Byte bitValue = (Byte)((difference >> (inBitsPerComponent - bit - 1)) & 1);
+				encodedRow[position/8] = (Byte)((encodedRow[position/8] & ~(1 << (7 - position%8))) | (bitValue << (7 - position%8)));
+			}
+		}
+	}
+
+	InputPredictorTIFFSubStream decoder(new InputByteArrayStream((Byte*)encoded.c_str(),encoded.size()),
+										inColors,
+										(Byte)inBitsPerComponent,
+										inColumns);
+
+	char description[100];
+	sprintf(description,"TIFF predictor, %ld colors, %ld bits per component",(long)inColors,(long)inBitsPerComponent);
+	return CompareDecoded(&decoder,data,description);
+}
+
+EStatusCode PNGPredictorTest::CompareDecoded(IByteReader* inDecoder,const string& inExpected,const string& inDescription)
+{
+	// read in uneven pieces, so reads cross row boundaries
+	string decoded;
+	Byte buffer[7];
+
+	while(inDecoder->NotEnded())
+	{
+		LongBufferSizeType readAmount = inDecoder->Read(buffer,7);
+		if(0 == readAmount)
+			break;
+		decoded.append((const char*)buffer,readAmount);
+	}
+
+	if(decoded != inExpected)
+	{
+		cout<<"decoded data mismatch for "<<inDescription<<". expected "<<inExpected.size()<<" bytes, got "<<decoded.size()<<" bytes\n";
+		return eFailure;
+	}
+	return eSuccess;
+}
+
+static double DecodeAndMeasure(IByteReader* inDecoder)
+{
+	Byte buffer[4096];
+	Timer timer;
+
+	timer.StartMeasure();
+	while(inDecoder->NotEnded())
+	{
+		if(0 == inDecoder->Read(buffer,4096))
+			break;
+	}
+	timer.StopMeasureAndAccumulate();
+	delete inDecoder;
+
+	return timer.GetTotalMiliSeconds();
+}
+
+void PNGPredictorTest::RunBenchmark()
+{
+	// compare row decoding with the byte at a time loop. timing is informative only
+	const char* names[] = {"None","Sub","Up","Average","Paeth","Optimum"};
+	LongBufferSizeType bytesPerPixelOptions[] = {1,4};
+
+	for(int j = 0; j < 2; ++j)
+	{
+		LongBufferSizeType bytesPerPixel = bytesPerPixelOptions[j];
+		LongBufferSizeType columns = BENCHMARK_COLUMNS / bytesPerPixel;
+		string data = CreateImageData(BENCHMARK_COLUMNS,BENCHMARK_ROWS);
+
+		for(Byte predictor = 10; predictor <= 15; ++predictor)
+		{
+			string encoded = EncodePNG(data,BENCHMARK_COLUMNS,bytesPerPixel,predictor);
+
+			double rowsTime = DecodeAndMeasure(CreatePNGDecoder(new InputByteArrayStream((Byte*)encoded.c_str(),encoded.size()),
+																predictor,
+																columns,
+																bytesPerPixel,
+																8));
+			double byteLoopTime = DecodeAndMeasure(new ByteLoopPNGDecoder(new InputByteArrayStream((Byte*)encoded.c_str(),encoded.size()),
+																		  BENCHMARK_COLUMNS,
+																		  bytesPerPixel));
+			cout<<"PNG "<<names[predictor - 10]<<", "<<bytesPerPixel<<" bytes per pixel, "<<data.size()/1024<<"KB: rows "<<rowsTime<<"ms, byte loop "<<byteLoopTime<<"ms\n";
+		}
+	}
+}
+
+ADD_CATEGORIZED_TEST(PNGPredictorTest,"IO")
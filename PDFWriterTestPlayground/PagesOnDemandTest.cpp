@@ -0,0 +1,321 @@
+/*
+   Source File : PagesOnDemandTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "PagesOnDemandTest.h"
+#include "TestsRunner.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PDFParser.h"
+#include "PDFParsingOptions.h"
+#include "PDFDictionary.h"
+#include "InputFile.h"
+#include "OutputFile.h"
+#include "RefCountPtr.h"
+#include "Timer.h"
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+
+using namespace std;
+using namespace PDFHummus;
+
+// enough pages for a few levels of page tree
+#define LONG_DOCUMENT_PAGES 5000
+// pages of a document with all pages as kids of the root. PDFWriter writes trees with a limited number of kids per node, so this one is written by hand
+#define FLAT_DOCUMENT_PAGES 1000
+
+PagesOnDemandTest::PagesOnDemandTest(void)
+{
+}
+
+PagesOnDemandTest::~PagesOnDemandTest(void)
+{
+}
+
+EStatusCode PagesOnDemandTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = eSuccess;
+	string longDocumentPath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"PagesOnDemandLong.pdf");
+	string flatDocumentPath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"PagesOnDemandFlat.pdf");
+	const char* files[] = {"TestMaterials/Original.pdf","TestMaterials/ObjectStreams.pdf","TestMaterials/Linearized.pdf","TestMaterials/AddedPage.pdf"};
+
+	do
+	{
+		for(int i=0; i < 4 && eSuccess == status; ++i)
+			status = ComparePages(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,files[i]));
+		if(status != eSuccess)
+			break;
+
+		status = WriteLongDocument(longDocumentPath);
+		if(status != eSuccess)
+			break;
+
+		status = ComparePages(longDocumentPath);
+		if(status != eSuccess)
+			break;
+
+		status = WriteFlatDocument(flatDocumentPath);
+		if(status != eSuccess)
+			break;
+
+		status = ComparePages(flatDocumentPath);
+		if(status != eSuccess)
+			break;
+
+		status = VerifyFlatDocumentFirstPage(flatDocumentPath);
+		if(status != eSuccess)
+			break;
+
+		double allPagesTime,onDemandTime;
+		status = MeasureFirstPage(longDocumentPath,false,allPagesTime);
+		if(status != eSuccess)
+			break;
+		status = MeasureFirstPage(longDocumentPath,true,onDemandTime);
+		if(status != eSuccess)
+			break;
+
+		cout<<"Got first page of a "<<LONG_DOCUMENT_PAGES<<" pages document in "<<allPagesTime<<"ms, and with pages parsed on demand in "<<onDemandTime<<"ms\n";
+	}while(false);
+
+	return status;
+}
+
+EStatusCode PagesOnDemandTest::WriteLongDocument(const string& inFilePath)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status = pdfWriter.StartPDF(inFilePath,ePDFVersion13);
+
+	for(int i = 0; i < LONG_DOCUMENT_PAGES && eSuccess == status; ++i)
+	{
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,100 + i,100));
+		status = pdfWriter.WritePageAndRelease(page);
+	}
+
+	if(eSuccess == status)
+		status = pdfWriter.EndPDF();
+	if(status != eSuccess)
+		cout<<"failed to write long document\n";
+	return status;
+}
+
+EStatusCode PagesOnDemandTest::WriteFlatDocument(const string& inFilePath)
+{
+	// object 1 is the catalog, 2 the single page tree node and the pages follow
+	stringstream pdf;
+	vector<size_t> objectsPositions;
+
+	pdf<<"%PDF-1.3\n";
+	objectsPositions.push_back((size_t)pdf.tellp());
+	pdf<<"1 0 obj\n<< /Type /Catalog /Pages 2 0 R >>\nendobj\n";
+	objectsPositions.push_back((size_t)pdf.tellp());
+	pdf<<"2 0 obj\n<< /Type /Pages /Count "<<FLAT_DOCUMENT_PAGES<<" /Kids [";
+	for(int i = 0; i < FLAT_DOCUMENT_PAGES; ++i)
+		pdf<<" "<<(i + 3)<<" 0 R";
+	pdf<<" ] >>\nendobj\n";
+	for(int i = 0; i < FLAT_DOCUMENT_PAGES; ++i)
+	{
+		objectsPositions.push_back((size_t)pdf.tellp());
+		pdf<<(i + 3)<<" 0 obj\n<< /Type /Page /Parent 2 0 R /MediaBox [0 0 "<<(100 + i)<<" 100] >>\nendobj\n";
+	}
+
+	size_t xrefPosition = (size_t)pdf.tellp();
+	pdf<<"xref\n0 "<<(objectsPositions.size() + 1)<<"\n0000000000 65535 f\r\n";
+	for(vector<size_t>::iterator it = objectsPositions.begin(); it != objectsPositions.end(); ++it)
+		pdf<<setw(10)<<setfill('0')<<*it<<" 00000 n\r\n";
+	pdf<<"trailer\n<< /Size "<<(objectsPositions.size() + 1)<<" /Root 1 0 R >>\nstartxref\n"<<xrefPosition<<"\n%%EOF\n";
+
+	OutputFile pdfFile;
+	EStatusCode status = pdfFile.OpenFile(inFilePath);
+	if(eSuccess == status)
+	{
+		string pdfText = pdf.str();
+		if(pdfFile.GetOutputStream()->Write((const IOBasicTypes::Byte*)pdfText.c_str(),pdfText.size()) != pdfText.size())
+			status = eFailure;
+		if(pdfFile.CloseFile() != eSuccess)
+			status = eFailure;
+	}
+	if(status != eSuccess)
+		cout<<"failed to write flat document\n";
+	return status;
+}
+
+EStatusCode PagesOnDemandTest::VerifyFlatDocumentFirstPage(const string& inFilePath)
+{
+	// kids of the root should be read only as far as the page asked for, not all of them
+	EStatusCode status = eSuccess;
+	InputFile pdfFile;
+	PDFParser parser;
+	PDFParsingOptions options;
+
+	do
+	{
+		options.ParsePagesOnDemand = true;
+
+		status = pdfFile.OpenFile(inFilePath);
+		if(status == eSuccess)
+			status = parser.StartPDFParsing(pdfFile.GetInputStream(),options);
+		if(status != eSuccess)
+		{
+			cout<<"unable to parse input file - "<<inFilePath<<"\n";
+			break;
+		}
+
+		unsigned long long objectsParsedBefore = parser.GetMetrics().GetCounters().ObjectsParsed;
+		RefCountPtr<PDFDictionary> page(parser.ParsePage(0));
+		if(!page)
+		{
+			cout<<"unable to parse first page of "<<inFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		// the root node, the first kid, and the page itself when it is parsed for the caller
+		unsigned long long objectsParsed = parser.GetMetrics().GetCounters().ObjectsParsed - objectsParsedBefore;
+		if(objectsParsed > 3)
+		{
+			cout<<"expected the first page of a flat page tree to be found without reading the other kids. parsed "<<objectsParsed<<" objects\n";
+			status = eFailure;
+			break;
+		}
+
+		// a page further on continues reading the kids from where the first page stopped
+		objectsParsedBefore = parser.GetMetrics().GetCounters().ObjectsParsed;
+		if(parser.GetPageObjectID(9) != 12)
+		{
+			cout<<"unexpected object ID for page 9 of "<<inFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+		objectsParsed = parser.GetMetrics().GetCounters().ObjectsParsed - objectsParsedBefore;
+		if(objectsParsed > 9)
+		{
+			cout<<"expected only the kids between the first page and page 9 to be read. parsed "<<objectsParsed<<" objects\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode PagesOnDemandTest::ComparePages(const string& inFilePath)
+{
+	EStatusCode status = eSuccess;
+	InputFile pdfFile,onDemandPDFFile;
+	PDFParser parser,onDemandParser;
+	PDFParsingOptions onDemandOptions;
+
+	do
+	{
+		onDemandOptions.ParsePagesOnDemand = true;
+
+		status = pdfFile.OpenFile(inFilePath);
+		if(status == eSuccess)
+			status = parser.StartPDFParsing(pdfFile.GetInputStream());
+		if(status == eSuccess)
+			status = onDemandPDFFile.OpenFile(inFilePath);
+		if(status == eSuccess)
+			status = onDemandParser.StartPDFParsing(onDemandPDFFile.GetInputStream(),onDemandOptions);
+		if(status != eSuccess)
+		{
+			cout<<"unable to parse input file - "<<inFilePath<<"\n";
+			break;
+		}
+
+		if(parser.GetPagesCount() == 0 || parser.GetPagesCount() != onDemandParser.GetPagesCount())
+		{
+			cout<<"pages count differs when parsing pages on demand in "<<inFilePath<<". "<<parser.GetPagesCount()<<" vs "<<onDemandParser.GetPagesCount()<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		// backwards, so pages are found out of order
+		unsigned long pagesCount = parser.GetPagesCount();
+		for(unsigned long i = 0; i < pagesCount && eSuccess == status; ++i)
+		{
+			unsigned long pageIndex = pagesCount - 1 - i;
+			if(parser.GetPageObjectID(pageIndex) != onDemandParser.GetPageObjectID(pageIndex))
+			{
+				cout<<"page "<<pageIndex<<" object ID differs when parsing pages on demand in "<<inFilePath<<"\n";
+				status = eFailure;
+			}
+		}
+		if(status != eSuccess)
+			break;
+
+		RefCountPtr<PDFDictionary> page(onDemandParser.ParsePage(pagesCount/2));
+		if(!page)
+		{
+			cout<<"unable to parse page when parsing pages on demand in "<<inFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		if(onDemandParser.GetPageObjectID(pagesCount) != 0)
+		{
+			cout<<"expected no page past the pages count in "<<inFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode PagesOnDemandTest::MeasureFirstPage(const string& inFilePath,bool inParsePagesOnDemand,double& outMiliSeconds)
+{
+	EStatusCode status = eSuccess;
+	InputFile pdfFile;
+	PDFParser parser;
+	PDFParsingOptions options;
+	Timer timer;
+
+	do
+	{
+		options.ParsePagesOnDemand = inParsePagesOnDemand;
+
+		timer.StartMeasure();
+		status = pdfFile.OpenFile(inFilePath);
+		if(status == eSuccess)
+			status = parser.StartPDFParsing(pdfFile.GetInputStream(),options);
+		if(status != eSuccess)
+		{
+			cout<<"unable to parse input file - "<<inFilePath<<"\n";
+			break;
+		}
+
+		RefCountPtr<PDFDictionary> page(parser.ParsePage(0));
+		timer.StopMeasureAndAccumulate();
+		if(!page)
+		{
+			cout<<"unable to parse first page of "<<inFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+		outMiliSeconds = timer.GetTotalMiliSeconds();
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(PagesOnDemandTest,"PDFEmbedding")
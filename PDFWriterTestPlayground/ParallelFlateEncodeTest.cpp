@@ -0,0 +1,342 @@
+/*
+   Source File : ParallelFlateEncodeTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "ParallelFlateEncodeTest.h"
+#include "OutputParallelFlateEncodeStream.h"
+#include "OutputFlateEncodeStream.h"
+#include "OutputStringBufferStream.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PDFRectangle.h"
+#include "PageContentContext.h"
+#include "PDFParser.h"
+#include "InputFile.h"
+#include "PDFDictionary.h"
+#include "PDFStreamInput.h"
+#include "PDFObjectCast.h"
+#include "RefCountPtr.h"
+#include "IByteReader.h"
+#include "zlib.h"
+
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+using namespace IOBasicTypes;
+using namespace PDFHummus;
+
+#define RECTANGLES_COUNT 20000
+
+ParallelFlateEncodeTest::ParallelFlateEncodeTest(void)
+{
+}
+
+ParallelFlateEncodeTest::~ParallelFlateEncodeTest(void)
+{
+}
+
+static string CreateTestData(LongBufferSizeType inSize)
+{
+	// somewhat compressible data. text with varying numbers
+	string result;
+	unsigned long seed = 12345;
+
+	result.reserve(inSize);
+	while(result.size() < inSize)
+	{
+		seed = seed * 1103515245 + 12345;
+		stringstream line;
+		line<<"line "<<result.size()<<" value "<<((seed >> 16) & 0x7fff)<<"\n";
+		result.append(line.str());
+	}
+	result.resize(inSize);
+	return result;
+}
+
+EStatusCode ParallelFlateEncodeTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = eSuccess;
+
+	do
+	{
+		// small streams are encoded the same as the serial encoder
+		status = TestEncoding("",4,true);
+		if(status != eSuccess)
+			break;
+
+		status = TestEncoding(CreateTestData(1000),4,true);
+		if(status != eSuccess)
+			break;
+
+		status = TestEncoding(CreateTestData(PARALLEL_FLATE_CHUNK_SIZE),4,true);
+		if(status != eSuccess)
+			break;
+
+		// larger ones are chunked. check around chunk and batch boundaries, and multiple batches
+		status = TestEncoding(CreateTestData(PARALLEL_FLATE_CHUNK_SIZE + 1),4,false);
+		if(status != eSuccess)
+			break;
+
+		status = TestEncoding(CreateTestData(4*PARALLEL_FLATE_CHUNK_SIZE),4,false);
+		if(status != eSuccess)
+			break;
+
+		status = TestEncoding(CreateTestData(4*PARALLEL_FLATE_CHUNK_SIZE + 1),4,false);
+		if(status != eSuccess)
+			break;
+
+		status = TestEncoding(CreateTestData(3*1024*1024 + 17),3,false);
+		if(status != eSuccess)
+			break;
+
+		status = TestEncoding(CreateTestData(3*PARALLEL_FLATE_CHUNK_SIZE + 5),1,false);
+		if(status != eSuccess)
+			break;
+
+		status = TestEncoderReuse();
+		if(status != eSuccess)
+			break;
+
+		status = TestPDFStream(inTestConfiguration);
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ParallelFlateEncodeTest::TestEncoding(const string& inData,unsigned int inThreadsCount,bool inExpectSerialOutput)
+{
+	EStatusCode status = eSuccess;
+
+	do
+	{
+		OutputParallelFlateEncodeStream encoder;
+		string encoded;
+		status = EncodeAndVerify(encoder,inData,inThreadsCount,encoded);
+		if(status != eSuccess)
+			break;
+
+		// compare with serial encoding
+		MyStringBuf serialBuffer;
+		{
+			OutputFlateEncodeStream serialEncoder(new OutputStringBufferStream(&serialBuffer));
+			serialEncoder.Write((const Byte*)inData.c_str(),inData.size());
+		}
+		if((serialBuffer.str() == encoded) != inExpectSerialOutput)
+		{
+			cout<<"for data of size "<<inData.size()<<" expected parallel encoding "<<(inExpectSerialOutput ? "to":"not to")<<" match serial encoding\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ParallelFlateEncodeTest::EncodeAndVerify(OutputParallelFlateEncodeStream& inEncoder,const string& inData,unsigned int inThreadsCount,string& outEncoded)
+{
+	MyStringBuf encodedBuffer;
+	OutputStringBufferStream encodedStream(&encodedBuffer);
+	inEncoder.Assign(&encodedStream,inThreadsCount);
+
+	// write in uneven pieces
+	LongBufferSizeType written = 0;
+	LongBufferSizeType pieceSize = 1;
+	while(written < inData.size())
+	{
+		LongBufferSizeType toWrite = pieceSize < inData.size() - written ? pieceSize : inData.size() - written;
+		if(inEncoder.Write((const Byte*)inData.c_str() + written,toWrite) != toWrite)
+		{
+			cout<<"failed to write data of size "<<inData.size()<<" to parallel encoder\n";
+			inEncoder.Assign(NULL,1);
+			return eFailure;
+		}
+		written += toWrite;
+		pieceSize = pieceSize * 3 + 7;
+	}
+
+	inEncoder.Assign(NULL,1); // finalizes encoding, and releases the target stream
+	outEncoded = encodedBuffer.str();
+
+	// decode with zlib, which also verifies the adler32 trailer
+	vector<Bytef> decoded(inData.size() + 1);
+	uLongf decodedSize = (uLongf)decoded.size();
+	int result = uncompress(&(decoded[0]),&decodedSize,(const Bytef*)outEncoded.c_str(),(uLong)outEncoded.size());
+	if(result != Z_OK)
+	{
+		cout<<"failed to decode parallel encoded data of size "<<inData.size()<<", zlib error "<<result<<"\n";
+		return eFailure;
+	}
+
+	if(decodedSize != inData.size() || (decodedSize > 0 && memcmp(&(decoded[0]),inData.c_str(),decodedSize) != 0))
+	{
+		cout<<"decoded data is different from the original data, for data of size "<<inData.size()<<"\n";
+		return eFailure;
+	}
+
+	return eSuccess;
+}
+
+EStatusCode ParallelFlateEncodeTest::TestEncoderReuse()
+{
+	// one encoder, reassigned for multiple multi batch streams, and changing threads count in the middle. 
+	// its compressing threads live across batches and assignments, and the output should be the same as with a fresh encoder
+	OutputParallelFlateEncodeStream reusedEncoder;
+	unsigned int threadsCounts[] = {4,4,2,1,4};
+	EStatusCode status = eSuccess;
+
+	for(size_t i = 0; i < sizeof(threadsCounts)/sizeof(unsigned int) && eSuccess == status; ++i)
+	{
+		string data = CreateTestData(3*threadsCounts[i]*PARALLEL_FLATE_CHUNK_SIZE + 1000*i);
+		string reusedEncoded;
+		string freshEncoded;
+
+		status = EncodeAndVerify(reusedEncoder,data,threadsCounts[i],reusedEncoded);
+		if(status != eSuccess)
+			break;
+
+		OutputParallelFlateEncodeStream freshEncoder;
+		status = EncodeAndVerify(freshEncoder,data,threadsCounts[i],freshEncoded);
+		if(status != eSuccess)
+			break;
+
+		if(reusedEncoded != freshEncoded)
+		{
+			cout<<"reused parallel encoder output is different from a fresh encoder output, for assignment "<<i<<"\n";
+			status = eFailure;
+		}
+	}
+
+	return status;
+}
+
+EStatusCode ParallelFlateEncodeTest::TestPDFStream(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = eSuccess;
+	string filePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"ParallelFlateEncode.pdf");
+
+	do
+	{
+		// write a page with a large content stream
+		PDFWriter pdfWriter;
+		PDFCreationSettings creationSettings(true,true);
+		creationSettings.FlateEncodingThreads = 4;
+
+		status = pdfWriter.StartPDF(filePath,ePDFVersion13,LogConfiguration::DefaultLogConfiguration,creationSettings);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF\n";
+			break;
+		}
+
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+		PageContentContext* contentContext = pdfWriter.StartPageContentContext(page);
+		for(int i = 0; i < RECTANGLES_COUNT; ++i)
+			contentContext->re(i % 500,i % 800,10,10);
+		contentContext->S();
+		status = pdfWriter.EndPageContentContext(contentContext);
+		if(status != eSuccess)
+		{
+			cout<<"failed to end page content context\n";
+			delete page;
+			break;
+		}
+
+		status = pdfWriter.WritePageAndRelease(page);
+		if(status != eSuccess)
+		{
+			cout<<"failed to write page\n";
+			break;
+		}
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+		{
+			cout<<"failed in end PDF\n";
+			break;
+		}
+
+		// read it back
+		InputFile pdfFile;
+		PDFParser parser;
+
+		status = pdfFile.OpenFile(filePath);
+		if(status != eSuccess)
+		{
+			cout<<"unable to open file for reading - "<<filePath<<"\n";
+			break;
+		}
+
+		status = parser.StartPDFParsing(pdfFile.GetInputStream());
+		if(status != eSuccess)
+		{
+			cout<<"unable to parse file - "<<filePath<<"\n";
+			break;
+		}
+
+		RefCountPtr<PDFDictionary> parsedPage(parser.ParsePage(0));
+		PDFObjectCastPtr<PDFStreamInput> contents(parsedPage.GetPtr() ? parser.QueryDictionaryObject(parsedPage.GetPtr(),"Contents") : NULL);
+		if(!contents)
+		{
+			cout<<"failed to get page contents stream\n";
+			status = eFailure;
+			break;
+		}
+
+		IByteReader* streamReader = parser.StartReadingFromStream(contents.GetPtr());
+		if(!streamReader)
+		{
+			cout<<"failed to read page contents stream\n";
+			status = eFailure;
+			break;
+		}
+
+		string content;
+		Byte buffer[4096];
+		while(streamReader->NotEnded())
+		{
+			LongBufferSizeType readAmount = streamReader->Read(buffer,4096);
+			if(0 == readAmount)
+				break;
+			content.append((const char*)buffer,readAmount);
+		}
+		delete streamReader;
+
+		// count rectangles, and make sure the content is larger than a chunk, so it was indeed encoded in parallel
+		unsigned long rectanglesCount = 0;
+		string::size_type position = content.find(" re");
+		while(position != string::npos)
+		{
+			++rectanglesCount;
+			position = content.find(" re",position + 1);
+		}
+		if(content.size() <= PARALLEL_FLATE_CHUNK_SIZE || rectanglesCount != RECTANGLES_COUNT || content.rfind("S") < content.rfind(" re"))
+		{
+			cout<<"unexpected page content. size "<<content.size()<<", rectangles "<<rectanglesCount<<"\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(ParallelFlateEncodeTest,"IO")
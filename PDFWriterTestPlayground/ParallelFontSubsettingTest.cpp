@@ -0,0 +1,126 @@
+/*
+   Source File : ParallelFontSubsettingTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "ParallelFontSubsettingTest.h"
+#include "TestsRunner.h"
+#include "SampleFontsDocument.h"
+#include "PDFWriter.h"
+#include "Timer.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+#define SUBSETTING_THREADS 4
+
+static const char* scSampleText = "Hello World, parallel font subsetting";
+
+ParallelFontSubsettingTest::ParallelFontSubsettingTest(void)
+{
+}
+
+ParallelFontSubsettingTest::~ParallelFontSubsettingTest(void)
+{
+}
+
+EStatusCode ParallelFontSubsettingTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = eSuccess;
+	double serialTime,parallelTime;
+
+	do
+	{
+		status = WriteDocument(inTestConfiguration,"ParallelFontSubsettingSerial.pdf",1,serialTime);
+		if(status != eSuccess)
+			break;
+
+		status = WriteDocument(inTestConfiguration,"ParallelFontSubsettingParallel.pdf",SUBSETTING_THREADS,parallelTime);
+		if(status != eSuccess)
+			break;
+
+		status = SampleFontsDocument::CompareFiles(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"ParallelFontSubsettingSerial.pdf"),
+												RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"ParallelFontSubsettingParallel.pdf"));
+		if(status != eSuccess)
+		{
+			cout<<"Expected the same document with parallel font subsetting\n";
+			break;
+		}
+
+		std::string serialContent;
+		status = SampleFontsDocument::ReadFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"ParallelFontSubsettingSerial.pdf"),serialContent);
+		if(status != eSuccess)
+			break;
+
+		// make sure both kinds of font programs got there
+		if(serialContent.find("/FontFile2") == std::string::npos || serialContent.find("/FontFile3") == std::string::npos)
+		{
+			cout<<"Expected both true type and CFF embedded fonts\n";
+			status = eFailure;
+			break;
+		}
+
+		cout<<"Wrote document with fonts subsetted serially in "<<serialTime<<"ms, and with "<<SUBSETTING_THREADS<<" subsetting threads in "<<parallelTime<<"ms\n";
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ParallelFontSubsettingTest::WriteDocument(const TestConfiguration& inTestConfiguration,
+													const std::string& inFileName,
+													unsigned int inFontSubsettingThreads,
+													double& outMiliSeconds)
+{
+	EStatusCode status = eSuccess;
+	PDFWriter pdfWriter;
+	Timer timer;
+	PDFCreationSettings settings(true,true);
+
+	settings.FontSubsettingThreads = inFontSubsettingThreads;
+
+	do
+	{
+		status = pdfWriter.StartPDF(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileName),ePDFVersion13,LogConfiguration::DefaultLogConfiguration,settings);
+		if(status != eSuccess)
+		{
+			cout<<"Failed to start file\n";
+			break;
+		}
+
+		status = SampleFontsDocument::WritePage(pdfWriter,inTestConfiguration,scSampleText);
+		if(status != eSuccess)
+			break;
+
+		// font subsets are created when the document ends
+		timer.StartMeasure();
+		status = pdfWriter.EndPDF();
+		timer.StopMeasureAndAccumulate();
+		if(status != eSuccess)
+		{
+			cout<<"Failed to end file\n";
+			break;
+		}
+		outMiliSeconds = timer.GetTotalMiliSeconds();
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(ParallelFontSubsettingTest,"Text")
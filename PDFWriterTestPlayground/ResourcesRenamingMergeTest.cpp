@@ -0,0 +1,263 @@
+/*
+   Source File : ResourcesRenamingMergeTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "ResourcesRenamingMergeTest.h"
+#include "TestsRunner.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PageContentContext.h"
+#include "PDFFormXObject.h"
+#include "XObjectContentContext.h"
+#include "ResourcesDictionary.h"
+#include "PDFParser.h"
+#include "InputFile.h"
+#include "PDFDictionary.h"
+#include "PDFArray.h"
+#include "PDFStreamInput.h"
+#include "PDFObjectCast.h"
+#include "IByteReader.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+// enough placements to make the content span multiple read chunks of the renaming copier
+#define PLACEMENTS_COUNT 20000
+
+ResourcesRenamingMergeTest::ResourcesRenamingMergeTest(void)
+{
+}
+
+ResourcesRenamingMergeTest::~ResourcesRenamingMergeTest(void)
+{
+}
+
+static size_t CountOccurrences(const string& inText,const string& inPattern)
+{
+	size_t count = 0;
+	string::size_type position = inText.find(inPattern);
+	while(position != string::npos)
+	{
+		++count;
+		position = inText.find(inPattern,position + inPattern.size());
+	}
+	return count;
+}
+
+EStatusCode ResourcesRenamingMergeTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+	string sourcePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"ResourcesRenamingSource.pdf");
+	string targetPath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"ResourcesRenamingMerge.pdf");
+	string sourceFormName;
+	string takenFormName;
+	string contents;
+
+	do
+	{
+		status = CreateSourceFile(sourcePath,sourceFormName);
+		if(status != eSuccess)
+		{
+			cout<<"failed to create source file\n";
+			break;
+		}
+
+		status = MergeSourceFile(sourcePath,targetPath,takenFormName);
+		if(status != eSuccess)
+		{
+			cout<<"failed to merge source file\n";
+			break;
+		}
+
+		status = ReadPageContents(targetPath,contents);
+		if(status != eSuccess)
+		{
+			cout<<"failed to read merged page contents\n";
+			break;
+		}
+
+		// the source name is taken in the target page, so all placements should use a new name
+		if(sourceFormName != takenFormName)
+		{
+			cout<<"expected source form name and taken form name to be the same, test setup is wrong\n";
+			status = eFailure;
+			break;
+		}
+
+		if(CountOccurrences(contents,"/" + sourceFormName + " Do") != 0)
+		{
+			cout<<"found placements with the original form name, which should have been renamed\n";
+			status = eFailure;
+			break;
+		}
+
+		if(CountOccurrences(contents," Do") != PLACEMENTS_COUNT)
+		{
+			cout<<"expected "<<PLACEMENTS_COUNT<<" placements, found "<<CountOccurrences(contents," Do")<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		// comments and strings are not names, and should be left as is
+		if(contents.find("% placing /" + sourceFormName + " from here on") == string::npos ||
+			contents.find("(/" + sourceFormName + ")") == string::npos)
+		{
+			cout<<"comment or string content that looks like a resource name was modified\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ResourcesRenamingMergeTest::CreateSourceFile(const string& inSourcePath,string& outFormName)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+
+	do
+	{
+		status = pdfWriter.StartPDF(inSourcePath,ePDFVersion13);
+		if(status != eSuccess)
+			break;
+
+		PDFFormXObject* form = pdfWriter.StartFormXObject(PDFRectangle(0,0,10,10));
+		form->GetContentContext()->re(0,0,10,10);
+		form->GetContentContext()->f();
+		ObjectIDType formID = form->GetObjectID();
+		status = pdfWriter.EndFormXObjectAndRelease(form);
+		if(status != eSuccess)
+			break;
+
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,595,842));
+		outFormName = page->GetResourcesDictionary().AddFormXObjectMapping(formID);
+
+		PageContentContext* contentContext = pdfWriter.StartPageContentContext(page);
+		contentContext->WriteFreeCode("% placing /" + outFormName + " from here on\r\n");
+		contentContext->WriteFreeCode("/Span <</Alt (/" + outFormName + ")>> BDC EMC\r\n");
+		for(int i = 0; i < PLACEMENTS_COUNT; ++i)
+		{
+			contentContext->q();
+			contentContext->cm(1,0,0,1,i%500,i%700);
+			contentContext->Do(outFormName);
+			contentContext->Q();
+		}
+
+		status = pdfWriter.EndPageContentContext(contentContext);
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.WritePageAndRelease(page);
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.EndPDF();
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ResourcesRenamingMergeTest::MergeSourceFile(const string& inSourcePath,const string& inTargetPath,string& outTakenFormName)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+
+	do
+	{
+		status = pdfWriter.StartPDF(inTargetPath,ePDFVersion13);
+		if(status != eSuccess)
+			break;
+
+		PDFFormXObject* form = pdfWriter.StartFormXObject(PDFRectangle(0,0,10,10));
+		form->GetContentContext()->re(0,0,5,5);
+		form->GetContentContext()->f();
+		ObjectIDType formID = form->GetObjectID();
+		status = pdfWriter.EndFormXObjectAndRelease(form);
+		if(status != eSuccess)
+			break;
+
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+		// take the first form name, so the merged form gets renamed
+		outTakenFormName = page->GetResourcesDictionary().AddFormXObjectMapping(formID);
+
+		status = pdfWriter.MergePDFPagesToPage(page,inSourcePath,PDFPageRange());
+		if(status != eSuccess)
+		{
+			delete page;
+			break;
+		}
+
+		status = pdfWriter.WritePageAndRelease(page);
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.EndPDF();
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ResourcesRenamingMergeTest::ReadPageContents(const string& inPDFPath,string& outContents)
+{
+	InputFile pdfFile;
+	PDFParser parser;
+
+	if(pdfFile.OpenFile(inPDFPath) != eSuccess)
+		return eFailure;
+	if(parser.StartPDFParsing(pdfFile.GetInputStream()) != eSuccess)
+		return eFailure;
+
+	PDFObjectCastPtr<PDFDictionary> page(parser.ParsePage(0));
+	if(!page)
+		return eFailure;
+
+	PDFObjectCastPtr<PDFArray> contentsArray(parser.QueryDictionaryObject(page.GetPtr(),"Contents"));
+	unsigned long streamsCount = contentsArray.GetPtr() ? contentsArray->GetLength() : 1;
+
+	for(unsigned long i = 0; i < streamsCount; ++i)
+	{
+		PDFObjectCastPtr<PDFStreamInput> stream(contentsArray.GetPtr() ? 
+													parser.QueryArrayObject(contentsArray.GetPtr(),i) :
+													parser.QueryDictionaryObject(page.GetPtr(),"Contents"));
+		if(!stream)
+			return eFailure;
+
+		IByteReader* reader = parser.StartReadingFromStream(stream.GetPtr());
+		if(!reader)
+			return eFailure;
+
+		IOBasicTypes::Byte buffer[4096];
+		while(reader->NotEnded())
+		{
+			IOBasicTypes::LongBufferSizeType readAmount = reader->Read(buffer,4096);
+			outContents.append((const char*)buffer,(size_t)readAmount);
+		}
+		delete reader;
+	}
+
+	return eSuccess;
+}
+
+ADD_CATEGORIZED_TEST(ResourcesRenamingMergeTest,"PDFEmbedding")
@@ -0,0 +1,143 @@
+/*
+   Source File : SampleFontsDocument.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "SampleFontsDocument.h"
+#include "TestsRunner.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PageContentContext.h"
+#include "PDFUsedFont.h"
+#include "FreeTypeFaceWrapper.h"
+#include "InputFile.h"
+#include "IByteReaderWithPosition.h"
+
+#include <iostream>
+#include <string.h>
+
+using namespace std;
+using namespace PDFHummus;
+
+#define GLYPHS_PER_FONT 400
+
+EStatusCode SampleFontsDocument::WritePage(PDFWriter& inPDFWriter,const TestConfiguration& inTestConfiguration,const string& inSampleText)
+{
+	EStatusCode status = eSuccess;
+
+	PDFUsedFont* fonts[] = {
+		inPDFWriter.GetFontForFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/arial.ttf")),
+		inPDFWriter.GetFontForFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/couri.ttf")),
+		inPDFWriter.GetFontForFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/LucidaGrande.ttc"),1),
+		inPDFWriter.GetFontForFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/KozGoPro-Regular.otf")),
+		inPDFWriter.GetFontForFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/BrushScriptStd.otf")),
+		inPDFWriter.GetFontForFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/HLB_____.PFB"),
+									RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/HLB_____.PFM"))
+	};
+	size_t fontsCount = sizeof(fonts)/sizeof(PDFUsedFont*);
+
+	PDFPage* page = new PDFPage();
+	page->SetMediaBox(PDFRectangle(0,0,595,842));
+	PageContentContext* cxt = inPDFWriter.StartPageContentContext(page);
+
+	for(size_t i = 0; i < fontsCount && eSuccess == status; ++i)
+	{
+		if(!fonts[i])
+		{
+			cout<<"Failed to create font "<<i<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		cxt->WriteText(10,800 - 100*(double)i,inSampleText,AbstractContentContext::TextOptions(fonts[i],12,AbstractContentContext::eGray,0));
+
+		// type 1 fonts may only be used with simple encoding
+		if(strcmp(fonts[i]->GetFreeTypeFont()->GetTypeString(),"Type 1") == 0)
+			continue;
+
+		GlyphUnicodeMappingList glyphs;
+		long glyphsCount = (*(fonts[i]->GetFreeTypeFont()))->num_glyphs;
+		// private use area unicode values, so true type fonts can't use the simple encoding for them either
+		for(long j = 1; j < glyphsCount && j <= GLYPHS_PER_FONT; ++j)
+			glyphs.push_back(GlyphUnicodeMapping((unsigned short)j,0xE000 + j));
+
+		cxt->BT();
+		cxt->Tf(fonts[i],6);
+		cxt->Tm(1,0,0,1,10,760 - 100*(double)i);
+		status = cxt->Tj(glyphs);
+		cxt->ET();
+		if(status != eSuccess)
+			cout<<"Failed to write glyphs of font "<<i<<"\n";
+	}
+
+	EStatusCode contentStatus = inPDFWriter.EndPageContentContext(cxt);
+	if(contentStatus != eSuccess)
+	{
+		cout<<"Failed to end page content\n";
+		if(eSuccess == status)
+			status = contentStatus;
+	}
+	if(status != eSuccess)
+	{
+		delete page;
+		return status;
+	}
+
+	status = inPDFWriter.WritePageAndRelease(page);
+	if(status != eSuccess)
+		cout<<"Failed to write page\n";
+	return status;
+}
+
+EStatusCode SampleFontsDocument::ReadFile(const string& inFilePath,string& outContent)
+{
+	InputFile file;
+	
+	if(file.OpenFile(inFilePath) != eSuccess)
+	{
+		cout<<"Failed to open "<<inFilePath<<"\n";
+		return eFailure;
+	}
+
+	IByteReaderWithPosition* stream = file.GetInputStream();
+	Byte buffer[4096];
+	while(stream->NotEnded())
+	{
+		LongBufferSizeType readBytes = stream->Read(buffer,4096);
+		outContent.append((const char*)buffer,(size_t)readBytes);
+	}
+	return eSuccess;
+}
+
+EStatusCode SampleFontsDocument::CompareFiles(const string& inExpectedFilePath,const string& inFilePath)
+{
+	string expectedContent,content;
+
+	if(ReadFile(inExpectedFilePath,expectedContent) != eSuccess || ReadFile(inFilePath,content) != eSuccess)
+		return eFailure;
+
+	size_t trailerPosition = expectedContent.rfind("trailer");
+	if(expectedContent.size() != content.size() || 
+		string::npos == trailerPosition ||
+		expectedContent.compare(0,trailerPosition,content,0,trailerPosition) != 0)
+	{
+		cout<<"Expected "<<inFilePath<<" to be the same as "<<inExpectedFilePath<<". size "<<content.size()<<" expected "<<expectedContent.size()<<"\n";
+		return eFailure;
+	}
+	return eSuccess;
+}
@@ -0,0 +1,43 @@
+/*
+   Source File : SampleFontsDocument.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "EStatusCode.h"
+
+#include <string>
+
+class PDFWriter;
+class TestConfiguration;
+
+// a document page using the test fonts of all kinds, for tests of font embedding that compare documents written in different ways
+class SampleFontsDocument
+{
+public:
+	// writes a page with inSampleText in each of true type, true type collection, CFF based open type (one of them CID keyed)
+	// and type 1 fonts. non type 1 fonts also get enough glyphs to have both a simple (ANSI) and a CID representation
+	static PDFHummus::EStatusCode WritePage(PDFWriter& inPDFWriter,const TestConfiguration& inTestConfiguration,const std::string& inSampleText);
+
+	// reads a whole file to memory
+	static PDFHummus::EStatusCode ReadFile(const std::string& inFilePath,std::string& outContent);
+
+	// compares two written documents. they should be the same, except for the trailer ID, which is based on the time and file name
+	static PDFHummus::EStatusCode CompareFiles(const std::string& inExpectedFilePath,const std::string& inFilePath);
+};
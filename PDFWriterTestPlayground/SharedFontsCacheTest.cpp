@@ -0,0 +1,266 @@
+/*
+   Source File : SharedFontsCacheTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "SharedFontsCacheTest.h"
+#include "TestsRunner.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PageContentContext.h"
+#include "PDFUsedFont.h"
+#include "SharedFontsCache.h"
+#include "FreeTypeWrapper.h"
+#include "FreeTypeFaceWrapper.h"
+#include "InputFile.h"
+#include "Timer.h"
+#include "TestThreads.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+#define DOCUMENTS_COUNT 5
+#define THREADS_COUNT 4
+
+static const char* scSampleText = "Hello World, shared fonts";
+
+SharedFontsCacheTest::SharedFontsCacheTest(void)
+{
+}
+
+SharedFontsCacheTest::~SharedFontsCacheTest(void)
+{
+}
+
+EStatusCode SharedFontsCacheTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = eSuccess;
+	SharedFontsCache cache;
+	DoubleVector uncachedAdvances,cachedAdvances,secondRunAdvances;
+	double uncachedTime,cachedTime,secondRunTime;
+
+	do
+	{
+		status = WriteDocuments(inTestConfiguration,NULL,DOCUMENTS_COUNT,uncachedAdvances,uncachedTime);
+		if(status != eSuccess)
+			break;
+		InputFile uncachedFile;
+		uncachedFile.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"SharedFontsCacheTest.pdf"));
+		LongFilePositionType uncachedSize = uncachedFile.GetFileSize();
+		uncachedFile.CloseFile();
+
+		status = WriteDocuments(inTestConfiguration,&cache,DOCUMENTS_COUNT,cachedAdvances,cachedTime);
+		if(status != eSuccess)
+			break;
+		status = WriteDocuments(inTestConfiguration,&cache,DOCUMENTS_COUNT,secondRunAdvances,secondRunTime);
+		if(status != eSuccess)
+			break;
+		InputFile cachedFile;
+		cachedFile.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"SharedFontsCacheTest.pdf"));
+		LongFilePositionType cachedSize = cachedFile.GetFileSize();
+		cachedFile.CloseFile();
+
+		if(uncachedAdvances != cachedAdvances || uncachedAdvances != secondRunAdvances)
+		{
+			cout<<"Text measured differently with shared fonts cache\n";
+			status = eFailure;
+			break;
+		}
+
+		if(uncachedSize != cachedSize)
+		{
+			cout<<"Expected same output with shared fonts cache. size without "<<uncachedSize<<" with "<<cachedSize<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		// two fonts, mapped once, then used by all other documents
+		SharedFontsCacheStatistics statistics = cache.GetStatistics();
+		if(statistics.CachedFontFiles != 2 || statistics.Misses != 2 || statistics.Hits != 2 * (2 * DOCUMENTS_COUNT - 1))
+		{
+			cout<<"Unexpected shared fonts cache statistics. files "<<statistics.CachedFontFiles<<" misses "<<statistics.Misses<<" hits "<<statistics.Hits<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		status = TestConcurrentUse(inTestConfiguration,&cache,uncachedAdvances[0]);
+		if(status != eSuccess)
+			break;
+
+		// no documents are using the fonts now, so all can go
+		cache.Purge();
+		if(cache.GetStatistics().CachedFontFiles != 0)
+		{
+			cout<<"Expected no cached font files after purge\n";
+			status = eFailure;
+			break;
+		}
+
+		cout<<"Wrote "<<DOCUMENTS_COUNT<<" documents in "<<uncachedTime<<"ms. with shared fonts cache "<<cachedTime<<"ms, and "<<
+			secondRunTime<<"ms when fonts are already cached\n";
+	}while(false);
+
+	return status;
+}
+
+EStatusCode SharedFontsCacheTest::WriteDocuments(const TestConfiguration& inTestConfiguration,
+												SharedFontsCache* inSharedFontsCache,
+												int inDocumentsCount,
+												DoubleVector& outTextAdvances,
+												double& outMiliSeconds)
+{
+	EStatusCode status = eSuccess;
+	Timer timer;
+
+	timer.StartMeasure();
+	for(int i = 0; i < inDocumentsCount && eSuccess == status; ++i)
+	{
+		PDFWriter pdfWriter;
+
+		pdfWriter.SetSharedFontsCache(inSharedFontsCache);
+		status = pdfWriter.StartPDF(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"SharedFontsCacheTest.pdf"),ePDFVersion13);
+		if(status != eSuccess)
+		{
+			cout<<"Failed to start file\n";
+			break;
+		}
+
+		PDFUsedFont* arialFont = pdfWriter.GetFontForFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/arial.ttf"));
+		PDFUsedFont* kozukaFont = pdfWriter.GetFontForFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/KozGoPro-Regular.otf"));
+		if(!arialFont || !kozukaFont)
+		{
+			cout<<"Failed to create fonts\n";
+			status = eFailure;
+			break;
+		}
+
+		outTextAdvances.push_back(arialFont->CalculateTextAdvance(scSampleText,12));
+		outTextAdvances.push_back(kozukaFont->CalculateTextAdvance(scSampleText,12));
+
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,595,842));
+		PageContentContext* cxt = pdfWriter.StartPageContentContext(page);
+		cxt->WriteText(10,100,scSampleText,AbstractContentContext::TextOptions(arialFont,12,AbstractContentContext::eGray,0));
+		cxt->WriteText(10,200,scSampleText,AbstractContentContext::TextOptions(kozukaFont,12,AbstractContentContext::eGray,0));
+		status = pdfWriter.EndPageContentContext(cxt);
+		if(status != eSuccess)
+		{
+			cout<<"Failed to end content context\n";
+			delete page;
+			break;
+		}
+
+		status = pdfWriter.WritePageAndRelease(page);
+		if(status != eSuccess)
+		{
+			cout<<"Failed to write page\n";
+			break;
+		}
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+		{
+			cout<<"Failed to end pdf\n";
+			break;
+		}
+	}
+	timer.StopMeasureAndAccumulate();
+	outMiliSeconds = timer.GetTotalMiliSeconds();
+
+	return status;
+}
+
+struct SharedFontsCacheUser
+{
+	SharedFontsCache* mCache;
+	string mFontFilePath;
+	double mTextAdvance;
+};
+
+// what a document does with a shared font, minus the document. no logging here, as this runs on several threads
+static void UseSharedFont(SharedFontsCacheUser* inUser)
+{
+	FreeTypeWrapper freeType;
+	SharedFontFile* fontFile = inUser->mCache->AcquireFontFile(inUser->mFontFilePath);
+
+	inUser->mTextAdvance = -1;
+	if(!fontFile)
+		return;
+
+	FT_Face face = freeType.NewFace(fontFile->GetData(),(FT_Long)fontFile->GetSize(),0);
+	if(!face)
+	{
+		inUser->mCache->ReleaseFontFile(fontFile);
+		return;
+	}
+
+	FreeTypeFaceWrapper faceWrapper(face,inUser->mFontFilePath,0);
+	faceWrapper.SetSharedFontFile(inUser->mCache,fontFile);
+
+	ULongList text;
+	UIntList glyphs;
+	for(const char* it = scSampleText; *it != 0; ++it)
+		text.push_back((unsigned long)*it);
+	faceWrapper.GetGlyphsForUnicodeText(text,glyphs);
+
+	FT_Pos advance = 0;
+	for(UIntList::iterator it = glyphs.begin(); it != glyphs.end(); ++it)
+		advance += faceWrapper.GetGlyphWidth(*it);
+	inUser->mTextAdvance = advance * 12 / 1000.0;
+}
+
+EStatusCode SharedFontsCacheTest::TestConcurrentUse(const TestConfiguration& inTestConfiguration,SharedFontsCache* inSharedFontsCache,double inExpectedAdvance)
+{
+	// a fresh cache, so that the threads race on mapping the file and sharing the widths
+	SharedFontsCache freshCache;
+	SharedFontsCache* caches[2] = {inSharedFontsCache,&freshCache};
+	EStatusCode status = eSuccess;
+
+	for(int c = 0; c < 2 && eSuccess == status; ++c)
+	{
+		SharedFontsCacheUser users[THREADS_COUNT];
+
+		for(int i = 0; i < THREADS_COUNT; ++i)
+		{
+			users[i].mCache = caches[c];
+			users[i].mFontFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/arial.ttf");
+		}
+		TestThreads::Run(UseSharedFont,users,THREADS_COUNT);
+
+		for(int i = 0; i < THREADS_COUNT; ++i)
+		{
+			if(users[i].mTextAdvance != inExpectedAdvance)
+			{
+				cout<<"Wrong text advance measured with shared font on thread "<<i<<". expected "<<inExpectedAdvance<<" got "<<users[i].mTextAdvance<<"\n";
+				status = eFailure;
+			}
+		}
+	}
+
+	if(eSuccess == status && freshCache.GetStatistics().Misses != 1)
+	{
+		cout<<"Expected font file to be mapped once by concurrent users, mapped "<<freshCache.GetStatistics().Misses<<" times\n";
+		status = eFailure;
+	}
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(SharedFontsCacheTest,"Text")
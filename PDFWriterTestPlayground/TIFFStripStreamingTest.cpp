@@ -0,0 +1,304 @@
+/*
+   Source File : TIFFStripStreamingTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+
+#ifndef PDFHUMMUS_NO_TIFF
+
+#include "TIFFStripStreamingTest.h"
+#include "TestsRunner.h"
+#include "PDFWriter.h"
+#include "PDFFormXObject.h"
+#include "PDFPage.h"
+#include "PageContentContext.h"
+#include "PDFParser.h"
+#include "InputFile.h"
+#include "PDFStreamInput.h"
+#include "PDFDictionary.h"
+#include "PDFName.h"
+#include "PDFObjectCast.h"
+#include "RefCountPtr.h"
+#include "IByteReader.h"
+
+#include "tiffio.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace PDFHummus;
+
+TIFFStripStreamingTest::TIFFStripStreamingTest(void)
+{
+}
+
+TIFFStripStreamingTest::~TIFFStripStreamingTest(void)
+{
+}
+
+EStatusCode TIFFStripStreamingTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = eSuccess;
+
+	// both images are made of several strips, with a last strip that is shorter than the others.
+	// see that the strip by strip conversion produces the same pixels as converting the whole image would.
+
+	// RGBA, opaque, 33x50 with 7 rows per strip
+	string expectedRGB;
+	for(int y = 0; y < 50; ++y)
+	{
+		for(int x = 0; x < 33; ++x)
+		{
+			expectedRGB.push_back((char)((x*7 + y) % 256));
+			expectedRGB.push_back((char)((y*5) % 256));
+			expectedRGB.push_back((char)((x*y) % 256));
+		}
+	}
+	if(ConvertAndCompare(inTestConfiguration,"multistrip-rgba.tif",expectedRGB) != eSuccess)
+		status = eFailure;
+
+	// 8 bit palette, 17x23 with 5 rows per strip. written with an indexed color space, so expecting the indexes
+	string expectedIndexes;
+	for(int y = 0; y < 23; ++y)
+		for(int x = 0; x < 17; ++x)
+			expectedIndexes.push_back((char)((x + y*3) % 256));
+	if(ConvertAndCompare(inTestConfiguration,"multistrip-palette.tif",expectedIndexes) != eSuccess)
+		status = eFailure;
+
+	// conversions of the strip by strip path, compared with decoding the whole image at once - the way the handler used to do it.
+	// planar separate to contiguous
+	if(ConvertAndCompareWithWholeImage(inTestConfiguration,"flower-rgb-planar-8.tif") != eSuccess)
+		status = eFailure;
+
+	// YCbCr, 2x2 subsampled and LZW compressed, 10 rows per strip and a shorter last strip. converted to RGB through the RGBA interface
+	if(ConvertAndCompareWithWholeImage(inTestConfiguration,"ycbcr-cat.tif") != eSuccess)
+		status = eFailure;
+
+	// palettes, 8 bit and 4 bit (with padded rows). written as indexes, as the handler uses indexed color spaces for palettes
+	if(ConvertAndCompareWithWholeImage(inTestConfiguration,"flower-palette-8.tif") != eSuccess)
+		status = eFailure;
+	if(ConvertAndCompareWithWholeImage(inTestConfiguration,"flower-palette-4.tif") != eSuccess)
+		status = eFailure;
+
+	return status;
+}
+
+EStatusCode TIFFStripStreamingTest::ConvertAndCompareWithWholeImage(const TestConfiguration& inTestConfiguration,
+																	const string& inTiffFileName)
+{
+	string expectedData;
+	if(ReadWholeImage(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("TestMaterials/images/tiff/") + inTiffFileName),expectedData) != eSuccess)
+	{
+		cout<<"failed to decode whole image of "<<inTiffFileName.c_str()<<"\n";
+		return eFailure;
+	}
+	return ConvertAndCompare(inTestConfiguration,inTiffFileName,expectedData);
+}
+
+EStatusCode TIFFStripStreamingTest::ReadWholeImage(const string& inTiffFilePath,string& outImageData)
+{
+	EStatusCode status = eSuccess;
+	TIFF* input = TIFFOpen(inTiffFilePath.c_str(),"r");
+	if(!input)
+		return eFailure;
+
+	do
+	{
+		uint32 width = 0,height = 0;
+		uint16 photometric = 0,planarConfig = PLANARCONFIG_CONTIG,samplesPerPixel = 1,bitsPerSample = 1;
+
+		TIFFGetField(input,TIFFTAG_IMAGEWIDTH,&width);
+		TIFFGetField(input,TIFFTAG_IMAGELENGTH,&height);
+		TIFFGetField(input,TIFFTAG_PHOTOMETRIC,&photometric);
+		TIFFGetFieldDefaulted(input,TIFFTAG_PLANARCONFIG,&planarConfig);
+		TIFFGetFieldDefaulted(input,TIFFTAG_SAMPLESPERPIXEL,&samplesPerPixel);
+		TIFFGetFieldDefaulted(input,TIFFTAG_BITSPERSAMPLE,&bitsPerSample);
+
+		if(PHOTOMETRIC_YCBCR == photometric)
+		{
+			// whole image RGBA raster, dropping the alpha
+			vector<uint32> raster(width*height);
+			if(!TIFFReadRGBAImageOriented(input,width,height,&(raster[0]),ORIENTATION_TOPLEFT,0))
+			{
+				status = eFailure;
+				break;
+			}
+			for(size_t i = 0; i < raster.size(); ++i)
+			{
+				outImageData.push_back((char)TIFFGetR(raster[i]));
+				outImageData.push_back((char)TIFFGetG(raster[i]));
+				outImageData.push_back((char)TIFFGetB(raster[i]));
+			}
+			break;
+		}
+
+		// all strips into one buffer. with separate planes the strips are ordered by plane, so that's plane after plane
+		string decoded;
+		vector<unsigned char> stripBuffer(TIFFStripSize(input));
+		for(tstrip_t i = 0; i < TIFFNumberOfStrips(input); ++i)
+		{
+			tsize_t readAmount = TIFFReadEncodedStrip(input,i,&(stripBuffer[0]),(tsize_t)stripBuffer.size());
+			if(readAmount < 0)
+			{
+				status = eFailure;
+				break;
+			}
+			decoded.append((const char*)&(stripBuffer[0]),(size_t)readAmount);
+		}
+		if(status != eSuccess)
+			break;
+
+		if(PLANARCONFIG_SEPARATE == planarConfig && samplesPerPixel > 1)
+		{
+			if(bitsPerSample != 8)
+			{
+				status = eFailure;
+				break;
+			}
+			size_t planeSize = width*height;
+			for(size_t pixel = 0; pixel < planeSize; ++pixel)
+				for(uint16 sample = 0; sample < samplesPerPixel; ++sample)
+					outImageData.push_back(decoded[sample*planeSize + pixel]);
+		}
+		else
+			outImageData = decoded;
+	}while(false);
+
+	TIFFClose(input);
+	return status;
+}
+
+EStatusCode TIFFStripStreamingTest::ConvertAndCompare(const TestConfiguration& inTestConfiguration,
+													const string& inTiffFileName,
+													const string& inExpectedData)
+{
+	EStatusCode status = eSuccess;
+	PDFWriter pdfWriter;
+	string pdfFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("TIFFStripStreaming_") + inTiffFileName + ".pdf");
+
+	do
+	{
+		status = pdfWriter.StartPDF(pdfFilePath,ePDFVersion13);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF for "<<inTiffFileName.c_str()<<"\n";
+			break;
+		}
+
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+		PageContentContext* pageContentContext = pdfWriter.StartPageContentContext(page);
+
+		PDFFormXObject* imageFormXObject = pdfWriter.CreateFormXObjectFromTIFFFile(
+			RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("TestMaterials/images/tiff/") + inTiffFileName));
+		if(!imageFormXObject)
+		{
+			cout<<"failed to create image form XObject from "<<inTiffFileName.c_str()<<"\n";
+			delete page;
+			status = eFailure;
+			break;
+		}
+
+		string imageXObjectName = page->GetResourcesDictionary().AddFormXObjectMapping(imageFormXObject->GetObjectID());
+		pageContentContext->Do(imageXObjectName);
+		delete imageFormXObject;
+
+		status = pdfWriter.EndPageContentContext(pageContentContext);
+		if(status != eSuccess)
+		{
+			cout<<"failed to end page content context for "<<inTiffFileName.c_str()<<"\n";
+			break;
+		}
+
+		status = pdfWriter.WritePageAndRelease(page);
+		if(status != eSuccess)
+		{
+			cout<<"failed to write page for "<<inTiffFileName.c_str()<<"\n";
+			break;
+		}
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+		{
+			cout<<"failed to end PDF for "<<inTiffFileName.c_str()<<"\n";
+			break;
+		}
+
+		string imageData;
+		status = ReadImageStream(pdfFilePath,imageData);
+		if(status != eSuccess)
+		{
+			cout<<"failed to read back image stream for "<<inTiffFileName.c_str()<<"\n";
+			break;
+		}
+
+		if(imageData != inExpectedData)
+		{
+			cout<<"image data mismatch for "<<inTiffFileName.c_str()<<". expected "<<inExpectedData.size()<<" bytes, got "<<imageData.size()<<"\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode TIFFStripStreamingTest::ReadImageStream(const string& inPDFFilePath,string& outImageData)
+{
+	EStatusCode status = eFailure;
+	InputFile pdfFile;
+	PDFParser parser;
+
+	if(pdfFile.OpenFile(inPDFFilePath) != eSuccess)
+		return eFailure;
+	if(parser.StartPDFParsing(pdfFile.GetInputStream()) != eSuccess)
+		return eFailure;
+
+	for(ObjectIDType i = 1; i < parser.GetObjectsCount() && status != eSuccess; ++i)
+	{
+		PDFObjectCastPtr<PDFStreamInput> stream(parser.ParseNewObject(i));
+		if(!stream)
+			continue;
+
+		RefCountPtr<PDFDictionary> streamDictionary(stream->QueryStreamDictionary());
+		PDFObjectCastPtr<PDFName> subtype(streamDictionary->QueryDirectObject("Subtype"));
+		if(!subtype || subtype->GetValue() != "Image")
+			continue;
+
+		IByteReader* reader = parser.StartReadingFromStream(stream.GetPtr());
+		if(!reader)
+			break;
+
+		IOBasicTypes::Byte buffer[1024];
+		while(reader->NotEnded())
+		{
+			IOBasicTypes::LongBufferSizeType readAmount = reader->Read(buffer,1024);
+			outImageData.append((const char*)buffer,(size_t)readAmount);
+		}
+		delete reader;
+		status = eSuccess;
+	}
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(TIFFStripStreamingTest,"PDF Images")
+
+#endif
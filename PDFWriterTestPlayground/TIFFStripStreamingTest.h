@@ -0,0 +1,47 @@
+/*
+   Source File : TIFFStripStreamingTest.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "ITestUnit.h"
+#include "IOBasicTypes.h"
+
+#include <string>
+
+class PDFWriter;
+
+class TIFFStripStreamingTest : public ITestUnit
+{
+public:
+	TIFFStripStreamingTest(void);
+	virtual ~TIFFStripStreamingTest(void);
+
+	virtual PDFHummus::EStatusCode Run(const TestConfiguration& inTestConfiguration);
+
+private:
+	PDFHummus::EStatusCode ConvertAndCompare(const TestConfiguration& inTestConfiguration,
+											const std::string& inTiffFileName,
+											const std::string& inExpectedData);
+	PDFHummus::EStatusCode ConvertAndCompareWithWholeImage(const TestConfiguration& inTestConfiguration,
+														  const std::string& inTiffFileName);
+	PDFHummus::EStatusCode ReadImageStream(const std::string& inPDFFilePath,std::string& outImageData);
+	// decode the whole image at once with libtiff, converted to the samples the handler writes
+	PDFHummus::EStatusCode ReadWholeImage(const std::string& inTiffFilePath,std::string& outImageData);
+};
@@ -0,0 +1,112 @@
+/*
+   Source File : TestThreads.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include "WorkerThread.h"
+
+#include <stddef.h>
+
+/*
+	Runs a test procedure on several threads at once, for tests of concurrent use. Start runs the procedure once per
+	context, each on its own thread, and Join waits for them all. a context whose thread could not be created is run
+	on the calling thread, during Start. started threads are joined on destruction
+*/
+class TestThreads
+{
+public:
+	TestThreads(void);
+	~TestThreads(void);
+
+	template <class T>
+	void Start(void (*inProc)(T*),T* inContexts,size_t inCount);
+	void Join();
+
+	// starts and joins
+	template <class T>
+	static void Run(void (*inProc)(T*),T* inContexts,size_t inCount);
+
+private:
+	struct ThreadCall
+	{
+		void (*mProc)(void*);
+		void* mContext;
+	};
+
+	WorkerThread* mThreads;
+	ThreadCall* mCalls;
+
+	template <class T>
+	static void RunTypedCall(void* inThreadCall);
+
+	// not copyable
+	TestThreads(const TestThreads&);
+	TestThreads& operator=(const TestThreads&);
+};
+
+inline TestThreads::TestThreads(void)
+{
+	mThreads = NULL;
+	mCalls = NULL;
+}
+
+inline TestThreads::~TestThreads(void)
+{
+	Join();
+}
+
+inline void TestThreads::Join()
+{
+	delete[] mThreads; // joins the threads
+	mThreads = NULL;
+	delete[] mCalls;
+	mCalls = NULL;
+}
+
+template <class T>
+void TestThreads::Start(void (*inProc)(T*),T* inContexts,size_t inCount)
+{
+	Join();
+	mThreads = new WorkerThread[inCount];
+	mCalls = new ThreadCall[inCount];
+
+	for(size_t i = 0; i < inCount; ++i)
+	{
+		mCalls[i].mProc = (void (*)(void*))inProc;
+		mCalls[i].mContext = inContexts + i;
+		if(!mThreads[i].Start(RunTypedCall<T>,mCalls + i))
+			inProc(inContexts + i);
+	}
+}
+
+template <class T>
+void TestThreads::Run(void (*inProc)(T*),T* inContexts,size_t inCount)
+{
+	TestThreads threads;
+	threads.Start(inProc,inContexts,inCount);
+	threads.Join();
+}
+
+template <class T>
+void TestThreads::RunTypedCall(void* inThreadCall)
+{
+	ThreadCall* threadCall = (ThreadCall*)inThreadCall;
+	((void (*)(T*))threadCall->mProc)((T*)threadCall->mContext);
+}
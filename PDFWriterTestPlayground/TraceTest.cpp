@@ -0,0 +1,389 @@
+/*
+   Source File : TraceTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "TraceTest.h"
+#include "TestsRunner.h"
+#include "Trace.h"
+#include "TraceRingBuffer.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "OutputStringBufferStream.h"
+#include "TestThreads.h"
+
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+using namespace PDFHummus;
+
+#define THREADS_COUNT 4
+#define ENTRIES_PER_THREAD 50
+#define WRAP_AROUND_ENTRIES_PER_THREAD 2000
+
+TraceTest::TraceTest(void)
+{
+}
+
+TraceTest::~TraceTest(void)
+{
+}
+
+EStatusCode TraceTest::Run(const TestConfiguration& inTestConfiguration)
+{
+#ifdef PDFHUMMUS_NO_TRACE
+	cout<<"Logging is compiled out, nothing to test\n";
+	return eSuccess;
+#else
+	EStatusCode status;
+
+	do
+	{
+		status = TestSeverity();
+		if(status != eSuccess)
+			break;
+
+		status = TestRingBuffer();
+		if(status != eSuccess)
+			break;
+
+		status = TestRingBufferWrapAround();
+		if(status != eSuccess)
+			break;
+
+		status = TestConcurrentWriters();
+		if(status != eSuccess)
+			break;
+
+		status = TestEndOnAnotherThread();
+	}while(false);
+
+	return status;
+#endif
+}
+
+static int sEvaluationsCount = 0;
+
+static int CountEvaluation()
+{
+	return ++sEvaluationsCount;
+}
+
+EStatusCode TraceTest::TestSeverity()
+{
+	Trace trace;
+	TraceRingBuffer ringBuffer(8);
+	trace.SetLogSettings(&ringBuffer,true);
+	trace.SetSeverityLevel(eTraceSeverityWarning);
+	TraceScope traceScope(&trace);
+
+	sEvaluationsCount = 0;
+	TRACE_LOG1("error %d",CountEvaluation());
+	TRACE_LOG_SEVERITY1(eTraceSeverityWarning,"warning %d",CountEvaluation());
+	// above the severity level, so arguments should not even be evaluated
+	TRACE_LOG_SEVERITY1(eTraceSeverityInfo,"info %d",CountEvaluation());
+	TRACE_LOG_SEVERITY1(eTraceSeverityDebug,"debug %d",CountEvaluation());
+
+	if(sEvaluationsCount != 2)
+	{
+		cout<<"Expected arguments of entries above the severity level not to be evaluated. evaluated "<<sEvaluationsCount<<" times\n";
+		return eFailure;
+	}
+
+	StringList entries = ringBuffer.GetEntries();
+	if(entries.size() != 2 || entries.front() != "error 1" || entries.back() != "warning 2")
+	{
+		cout<<"Unexpected entries logged with severity level. got "<<entries.size()<<" entries\n";
+		return eFailure;
+	}
+
+	// when not logging, nothing is evaluated
+	trace.SetLogSettings(&ringBuffer,false);
+	TRACE_LOG1("error %d",CountEvaluation());
+	if(sEvaluationsCount != 2 || ringBuffer.GetEntriesLoggedCount() != 2)
+	{
+		cout<<"Expected nothing to be logged or evaluated when logging is off\n";
+		return eFailure;
+	}
+
+	return eSuccess;
+}
+
+EStatusCode TraceTest::TestRingBuffer()
+{
+	Trace trace;
+	TraceRingBuffer ringBuffer(8);
+	trace.SetLogSettings(&ringBuffer,true);
+	TraceScope traceScope(&trace);
+
+	for(int i = 0; i < 20; ++i)
+		TRACE_LOG1("entry %d",i);
+
+	// only the latest 8 remain, oldest first
+	StringList entries = ringBuffer.GetEntries();
+	if(entries.size() != 8 || ringBuffer.GetEntriesLoggedCount() != 20)
+	{
+		cout<<"Expected 8 entries out of 20 in ring buffer. got "<<entries.size()<<" out of "<<ringBuffer.GetEntriesLoggedCount()<<"\n";
+		return eFailure;
+	}
+	int expected = 12;
+	for(StringList::iterator it = entries.begin(); it != entries.end(); ++it,++expected)
+	{
+		stringstream expectedEntry;
+		expectedEntry<<"entry "<<expected;
+		if(*it != expectedEntry.str())
+		{
+			cout<<"Unexpected ring buffer entry. expected "<<expectedEntry.str()<<" got "<<*it<<"\n";
+			return eFailure;
+		}
+	}
+
+	// long entries are truncated
+	string longText(TRACE_RING_BUFFER_ENTRY_SIZE * 2,'a');
+	TRACE_LOG1("%s",longText.c_str());
+	if(ringBuffer.GetEntries().back() != longText.substr(0,TRACE_RING_BUFFER_ENTRY_SIZE - 1))
+	{
+		cout<<"Expected long entry to be truncated to ring buffer entry size\n";
+		return eFailure;
+	}
+
+	return eSuccess;
+}
+
+struct TraceTestRingBufferLogger
+{
+	int mIndex;
+	Trace* mTrace;
+};
+
+static void LogUniformEntries(TraceTestRingBufferLogger* inLogger)
+{
+	// each logger writes entries made of a single character, so mixed text shows as mixed characters
+	string text(TRACE_RING_BUFFER_ENTRY_SIZE - 1,(char)('a' + inLogger->mIndex));
+	TraceScope traceScope(inLogger->mTrace);
+	for(int i = 0; i < WRAP_AROUND_ENTRIES_PER_THREAD; ++i)
+		TRACE_LOG1("%s",text.c_str());
+}
+
+EStatusCode TraceTest::TestRingBufferWrapAround()
+{
+	// loggers on a small ring keep landing on the same slots. entries may be dropped, but never mixed
+	EStatusCode status = eSuccess;
+	Trace trace;
+	TraceRingBuffer ringBuffer(2);
+	trace.SetLogSettings(&ringBuffer,true);
+	TraceTestRingBufferLogger loggers[THREADS_COUNT];
+	TestThreads threads;
+
+	for(int i = 0; i < THREADS_COUNT; ++i)
+	{
+		loggers[i].mIndex = i;
+		loggers[i].mTrace = &trace;
+	}
+	threads.Start(LogUniformEntries,loggers,THREADS_COUNT);
+
+	for(int j = 0; j < WRAP_AROUND_ENTRIES_PER_THREAD && eSuccess == status; ++j)
+	{
+		StringList entries = ringBuffer.GetEntries();
+		for(StringList::iterator it = entries.begin(); it != entries.end(); ++it)
+		{
+			if(it->size() != TRACE_RING_BUFFER_ENTRY_SIZE - 1 || it->find_first_not_of((*it)[0]) != string::npos)
+			{
+				cout<<"Got mixed ring buffer entry when loggers wrap around\n";
+				status = eFailure;
+				break;
+			}
+		}
+	}
+
+	threads.Join();
+	return status;
+}
+
+struct TraceTestWriter
+{
+	int mIndex;
+	TraceRingBuffer* mRingBuffer;
+	EStatusCode mStatus;
+	bool mKeptThreadTrace;
+};
+
+static void WriteDocumentWithOwnTrace(TraceTestWriter* inWriter)
+{
+	Trace trace;
+	trace.SetLogSettings(inWriter->mRingBuffer,true);
+	inWriter->mStatus = eFailure;
+	inWriter->mKeptThreadTrace = true;
+
+	PDFWriter pdfWriter;
+	OutputStringBufferStream pdfStream;
+
+	// object streams with PDF 1.3 are ignored with a log entry, so the library logs once to the writer trace
+	PDFCreationSettings creationSettings(true,true);
+	creationSettings.UseObjectStreams = true;
+
+	do
+	{
+		if(pdfWriter.StartPDFForStream(&pdfStream,ePDFVersion13,LogConfiguration(&trace),creationSettings) != eSuccess)
+			break;
+
+		// the writer trace is the thread trace only during writer calls
+		inWriter->mKeptThreadTrace = (Trace::GetThreadTrace() == NULL);
+
+		for(int i = 0; i < ENTRIES_PER_THREAD; ++i)
+		{
+			{
+				TraceScope traceScope(&trace);
+				TRACE_LOG2("writer %d entry %d",inWriter->mIndex,i);
+			}
+			PDFPage* page = new PDFPage();
+			page->SetMediaBox(PDFRectangle(0,0,100,100));
+			if(pdfWriter.WritePageAndRelease(page) != eSuccess)
+				break;
+		}
+
+		inWriter->mStatus = pdfWriter.EndPDFForStream();
+	}while(false);
+
+	inWriter->mKeptThreadTrace = inWriter->mKeptThreadTrace && (Trace::GetThreadTrace() == NULL);
+}
+
+EStatusCode TraceTest::TestConcurrentWriters()
+{
+	EStatusCode status = eSuccess;
+	TraceRingBuffer ringBuffers[THREADS_COUNT];
+	TraceTestWriter writers[THREADS_COUNT];
+
+	for(int i = 0; i < THREADS_COUNT; ++i)
+	{
+		writers[i].mIndex = i;
+		writers[i].mRingBuffer = ringBuffers + i;
+	}
+	TestThreads::Run(WriteDocumentWithOwnTrace,writers,THREADS_COUNT);
+
+	for(int i = 0; i < THREADS_COUNT; ++i)
+	{
+		if(writers[i].mStatus != eSuccess)
+		{
+			cout<<"Failed to write document on thread "<<i<<"\n";
+			status = eFailure;
+			continue;
+		}
+
+		if(!writers[i].mKeptThreadTrace)
+		{
+			cout<<"Expected writer to set its trace as the thread trace only during its calls, on thread "<<i<<"\n";
+			status = eFailure;
+		}
+
+		// each writer trace should have the library entry and its own entries, and nothing from the other writers
+		StringList entries = ringBuffers[i].GetEntries();
+		if(entries.size() != ENTRIES_PER_THREAD + 1 || entries.front().find("PDFWriter::SetupObjectStreams") != 0)
+		{
+			cout<<"Unexpected entries for writer on thread "<<i<<". got "<<entries.size()<<" entries\n";
+			status = eFailure;
+			continue;
+		}
+		stringstream prefix;
+		prefix<<"writer "<<i<<" ";
+		for(StringList::iterator it = ++entries.begin(); it != entries.end(); ++it)
+		{
+			if(it->find(prefix.str()) != 0)
+			{
+				cout<<"Unexpected entry for writer on thread "<<i<<": "<<*it<<"\n";
+				status = eFailure;
+				break;
+			}
+		}
+	}
+
+	return status;
+}
+
+struct TraceTestStartedWriter
+{
+	PDFWriter* mPDFWriter;
+	OutputStringBufferStream* mPDFStream;
+	Trace* mTrace;
+	EStatusCode mStatus;
+};
+
+static void StartDocumentWithTrace(TraceTestStartedWriter* inWriter)
+{
+	PDFCreationSettings creationSettings(true,true);
+	creationSettings.UseObjectStreams = true;
+	inWriter->mStatus = inWriter->mPDFWriter->StartPDFForStream(inWriter->mPDFStream,ePDFVersion13,LogConfiguration(inWriter->mTrace),creationSettings);
+}
+
+EStatusCode TraceTest::TestEndOnAnotherThread()
+{
+	// start a document on one thread and continue it on this one. the writer should keep logging to its trace,
+	// and not leave it as the thread trace of either thread
+	EStatusCode status = eSuccess;
+	TraceRingBuffer ringBuffer(8);
+	Trace trace;
+	trace.SetLogSettings(&ringBuffer,true);
+	PDFWriter pdfWriter;
+	OutputStringBufferStream pdfStream;
+	TraceTestStartedWriter writer;
+	writer.mPDFWriter = &pdfWriter;
+	writer.mPDFStream = &pdfStream;
+	writer.mTrace = &trace;
+	writer.mStatus = eFailure;
+
+	TestThreads::Run(StartDocumentWithTrace,&writer,1);
+
+	do
+	{
+		if(writer.mStatus != eSuccess)
+		{
+			cout<<"Failed to start document on another thread\n";
+			status = eFailure;
+			break;
+		}
+
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,100,100));
+		if(pdfWriter.WritePageAndRelease(page) != eSuccess || pdfWriter.EndPDFForStream() != eSuccess)
+		{
+			cout<<"Failed to end document started on another thread\n";
+			status = eFailure;
+			break;
+		}
+
+		if(Trace::GetThreadTrace() != NULL)
+		{
+			cout<<"Expected writer to leave the thread trace as it was, after ending a document started on another thread\n";
+			status = eFailure;
+			break;
+		}
+
+		StringList entries = ringBuffer.GetEntries();
+		if(entries.size() != 1 || entries.front().find("PDFWriter::SetupObjectStreams") != 0)
+		{
+			cout<<"Expected the document start to log to the writer trace. got "<<entries.size()<<" entries\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(TraceTest,"IO")